@@ -34,18 +34,31 @@
 #include "aabb.h"
 #include "list.h"
 #include "map.h"
+#include "os/copymem.h"
 #include "print_string.h"
 #include "variant.h"
 #include "vector3.h"
 
 /**
 	@author Juan Linietsky <reduzio@gmail.com>
+
+	Loose octree: every element lives in exactly one octant, the deepest one
+	whose cell contains the element center and is at least as big as the
+	element. Octant bounds are twice the cell size, so moving elements rarely
+	change octant. Elements are placed with a grown AABB, as long as they move
+	inside it the tree is not touched and only the pairs they have are checked.
+	Octants, elements and pairs are pooled records addressed by index, nothing
+	is allocated per element or per pair once the pools are warm.
 */
 
 typedef uint32_t OctreeElementID;
 
 #define OCTREE_ELEMENT_INVALID_ID 0
 #define OCTREE_SIZE_LIMIT 1e15
+#define OCTREE_NO_INDEX 0xFFFFFFFF
+#define OCTREE_DIVISOR 4 // smallest cell is unit_size / OCTREE_DIVISOR
+#define OCTREE_CULL_PLANE_GROUPS 16 // planes tracked by the per octant plane mask, in groups of 4
+#define OCTREE_FAT_MARGIN 0.5 // elements are placed with their AABB grown by this much of its longest axis
 
 template <class T, bool use_pairs = false, class AL = DefaultAllocator>
 class Octree {
@@ -54,12 +67,6 @@ public:
 	typedef void (*UnpairCallback)(void *, OctreeElementID, T *, int, OctreeElementID, T *, int, void *);
 
 private:
-	enum {
-
-		NEG = 0,
-		POS = 1,
-	};
-
 	enum {
 		OCTANT_NX_NY_NZ,
 		OCTANT_PX_NY_NZ,
@@ -71,305 +78,375 @@ private:
 		OCTANT_PX_PY_PZ
 	};
 
-	struct PairKey {
+	// Records are stored in fixed size pages, so growing the pool never moves
+	// them and references stay valid. Freed slots are reused first.
+	template <class R>
+	class Pool {
 
-		union {
-			struct {
-				OctreeElementID A;
-				OctreeElementID B;
-			};
-			uint64_t key;
+		enum {
+			PAGE_BITS = 8,
+			PAGE_SIZE = 1 << PAGE_BITS,
+			PAGE_MASK = PAGE_SIZE - 1
 		};
 
-		_FORCE_INLINE_ bool operator<(const PairKey &p_pair) const {
+		struct Page {
+			R records[PAGE_SIZE];
+		};
 
-			return key < p_pair.key;
-		}
+		Page **pages;
+		uint32_t page_count;
+		uint32_t used;
 
-		_FORCE_INLINE_ PairKey(OctreeElementID p_A, OctreeElementID p_B) {
+		uint32_t *free_slots;
+		uint32_t free_count;
+		uint32_t free_capacity;
 
-			if (p_A < p_B) {
+	public:
+		_FORCE_INLINE_ R &operator[](uint32_t p_index) { return pages[p_index >> PAGE_BITS]->records[p_index & PAGE_MASK]; }
+		_FORCE_INLINE_ const R &operator[](uint32_t p_index) const { return pages[p_index >> PAGE_BITS]->records[p_index & PAGE_MASK]; }
+		_FORCE_INLINE_ uint32_t size() const { return used; }
 
-				A = p_A;
-				B = p_B;
-			} else {
+		uint32_t alloc() {
+
+			if (free_count)
+				return free_slots[--free_count];
 
-				B = p_A;
-				A = p_B;
+			if (used == page_count * PAGE_SIZE) {
+
+				Page **new_pages = (Page **)AL::alloc(sizeof(Page *) * (page_count + 1));
+				if (pages) {
+					copymem(new_pages, pages, sizeof(Page *) * page_count);
+					AL::free(pages);
+				}
+				pages = new_pages;
+				pages[page_count++] = memnew_allocator(Page, AL);
 			}
+
+			return used++;
 		}
 
-		_FORCE_INLINE_ PairKey() {}
-	};
+		void free(uint32_t p_index) {
+
+			if (free_count == free_capacity) {
+
+				free_capacity = MAX(64, free_capacity * 2);
+				uint32_t *new_slots = (uint32_t *)AL::alloc(sizeof(uint32_t) * free_capacity);
+				if (free_slots) {
+					copymem(new_slots, free_slots, sizeof(uint32_t) * free_count);
+					AL::free(free_slots);
+				}
+				free_slots = new_slots;
+			}
+
+			free_slots[free_count++] = p_index;
+		}
+
+		Pool() {
+			pages = NULL;
+			page_count = 0;
+			used = 0;
+			free_slots = NULL;
+			free_count = 0;
+			free_capacity = 0;
+		}
 
-	struct Element;
+		~Pool() {
+
+			for (uint32_t i = 0; i < page_count; i++)
+				memdelete_allocator<Page, AL>(pages[i]);
+			if (pages)
+				AL::free(pages);
+			if (free_slots)
+				AL::free(free_slots);
+		}
+	};
 
 	struct Octant {
 
-		// cached for FAST plane check
+		// loose bounds, cached for FAST plane check
 		AABB aabb;
 
-		uint64_t last_pass;
-		Octant *parent;
-		Octant *children[8];
+		Vector3 center;
+		real_t half_size; // of the cell, the loose bounds are twice as big
+
+		uint32_t parent;
+		uint32_t children[8];
 
 		int children_count; // cache for amount of childrens (fast check for removal)
 		int parent_index; // cache for parent index (fast check for removal)
 
-		List<Element *, AL> pairable_elements;
-		List<Element *, AL> elements;
+		uint32_t first_element;
+		int element_count;
 
 		Octant() {
+			half_size = 0;
+			parent = OCTREE_NO_INDEX;
+			for (int i = 0; i < 8; i++)
+				children[i] = OCTREE_NO_INDEX;
 			children_count = 0;
 			parent_index = -1;
-			last_pass = 0;
-			parent = NULL;
-			for (int i = 0; i < 8; i++)
-				children[i] = NULL;
-		}
-
-		~Octant() {
-
-			/*
-			for (int i=0;i<8;i++)
-				memdelete_notnull(children[i]);
-			*/
+			first_element = OCTREE_NO_INDEX;
+			element_count = 0;
 		}
 	};
 
-	struct PairData;
-
 	struct Element {
 
-		Octree *octree;
-
 		T *userdata;
 		int subindex;
 		bool pairable;
+		bool active;
 		uint32_t pairable_mask;
 		uint32_t pairable_type;
 
 		uint64_t last_pass;
-		OctreeElementID _id;
-		Octant *common_parent;
 
 		AABB aabb;
-		AABB container_aabb;
-
-		List<PairData *, AL> pair_list;
+		AABB fat_aabb; // used for placement and pair discovery
 
-		struct OctantOwner {
+		uint32_t octant; // OCTREE_NO_INDEX while the element has no surface
+		uint32_t prev; // siblings in the octant
+		uint32_t next;
 
-			Octant *octant;
-			typename List<Element *, AL>::Element *E;
-		}; // an element can be in max 8 octants
-
-		List<OctantOwner, AL> octant_owners;
+		uint32_t first_pair;
 
 		Element() {
-			last_pass = 0;
-			_id = 0;
-			pairable = false;
-			subindex = 0;
 			userdata = 0;
-			octree = 0;
+			subindex = 0;
+			pairable = false;
+			active = false;
 			pairable_mask = 0;
 			pairable_type = 0;
-			common_parent = NULL;
+			last_pass = 0;
+			octant = OCTREE_NO_INDEX;
+			prev = OCTREE_NO_INDEX;
+			next = OCTREE_NO_INDEX;
+			first_pair = OCTREE_NO_INDEX;
 		}
 	};
 
+	// a pair exists while the fat AABBs intersect, the callbacks only fire
+	// when the real ones do. It is linked in the pair lists of both elements:
+	// side 0 in A's list, side 1 in B's list
 	struct PairData {
 
-		int refcount;
+		uint32_t A, B;
 		bool intersect;
-		Element *A, *B;
 		void *ud;
-		typename List<PairData *, AL>::Element *eA, *eB;
+		uint32_t prev[2];
+		uint32_t next[2];
 	};
 
-	typedef Map<OctreeElementID, Element, Comparator<OctreeElementID>, AL> ElementMap;
-	typedef Map<PairKey, PairData, Comparator<PairKey>, AL> PairMap;
-	ElementMap element_map;
-	PairMap pair_map;
+	Pool<Octant> octants;
+	Pool<Element> elements;
+	Pool<PairData> pairs;
 
 	PairCallback pair_callback;
 	UnpairCallback unpair_callback;
 	void *pair_callback_userdata;
 	void *unpair_callback_userdata;
 
-	OctreeElementID last_element_id;
 	uint64_t pass;
 
 	real_t unit_size;
-	Octant *root;
+	uint32_t root;
 	int octant_count;
 	int pair_count;
 
-	_FORCE_INLINE_ void _pair_check(PairData *p_pair) {
+	_FORCE_INLINE_ Element *_get_element(OctreeElementID p_id) {
 
-		bool intersect = p_pair->A->aabb.intersects_inclusive(p_pair->B->aabb);
+		if (p_id == OCTREE_ELEMENT_INVALID_ID || p_id > elements.size())
+			return NULL;
+		Element *e = &elements[p_id - 1];
+		return e->active ? e : NULL;
+	}
 
-		if (intersect != p_pair->intersect) {
+	_FORCE_INLINE_ const Element *_get_element(OctreeElementID p_id) const {
 
-			if (intersect) {
+		if (p_id == OCTREE_ELEMENT_INVALID_ID || p_id > elements.size())
+			return NULL;
+		const Element *e = &elements[p_id - 1];
+		return e->active ? e : NULL;
+	}
 
-				if (pair_callback) {
-					p_pair->ud = pair_callback(pair_callback_userdata, p_pair->A->_id, p_pair->A->userdata, p_pair->A->subindex, p_pair->B->_id, p_pair->B->userdata, p_pair->B->subindex);
-				}
-				pair_count++;
-			} else {
+	_FORCE_INLINE_ static bool _fits(const Octant &p_octant, const Vector3 &p_center, real_t p_half_size) {
 
-				if (unpair_callback) {
-					unpair_callback(pair_callback_userdata, p_pair->A->_id, p_pair->A->userdata, p_pair->A->subindex, p_pair->B->_id, p_pair->B->userdata, p_pair->B->subindex, p_pair->ud);
-				}
-				pair_count--;
-			}
+		return p_half_size <= p_octant.half_size &&
+			   Math::abs(p_center.x - p_octant.center.x) <= p_octant.half_size &&
+			   Math::abs(p_center.y - p_octant.center.y) <= p_octant.half_size &&
+			   Math::abs(p_center.z - p_octant.center.z) <= p_octant.half_size;
+	}
 
-			p_pair->intersect = intersect;
-		}
+	_FORCE_INLINE_ bool _can_descend(const Octant &p_octant, real_t p_half_size) const {
+
+		real_t child_half = p_octant.half_size * 0.5;
+		return child_half >= p_half_size && child_half * 2.0 >= unit_size / OCTREE_DIVISOR;
 	}
 
-	_FORCE_INLINE_ void _pair_reference(Element *p_A, Element *p_B) {
+	_FORCE_INLINE_ static void _get_center(const AABB &p_aabb, Vector3 &r_center, real_t &r_half_size) {
 
-		if (p_A == p_B || (p_A->userdata == p_B->userdata && p_A->userdata))
-			return;
+		r_center = p_aabb.position + p_aabb.size * 0.5;
+		r_half_size = p_aabb.get_longest_axis_size() * 0.5;
+	}
 
-		if (!(p_A->pairable_type & p_B->pairable_mask) &&
-				!(p_B->pairable_type & p_A->pairable_mask))
-			return; // none can pair with none
+	_FORCE_INLINE_ static AABB _get_fat_aabb(const AABB &p_aabb) {
 
-		PairKey key(p_A->_id, p_B->_id);
-		typename PairMap::Element *E = pair_map.find(key);
+		return p_aabb.grow(p_aabb.get_longest_axis_size() * OCTREE_FAT_MARGIN);
+	}
 
-		if (!E) {
+	_FORCE_INLINE_ static int _pair_side(const PairData &p_pair, uint32_t p_element) {
 
-			PairData pdata;
-			pdata.refcount = 1;
-			pdata.A = p_A;
-			pdata.B = p_B;
-			pdata.intersect = false;
-			E = pair_map.insert(key, pdata);
-			E->get().eA = p_A->pair_list.push_back(&E->get());
-			E->get().eB = p_B->pair_list.push_back(&E->get());
+		return p_pair.A == p_element ? 0 : 1;
+	}
 
-			/*
-			if (pair_callback)
-				pair_callback(pair_callback_userdata,p_A->userdata,p_B->userdata);
-			*/
-		} else {
+	void _pair_link(uint32_t p_pair, uint32_t p_element) {
 
-			E->get().refcount++;
+		Element &e = elements[p_element];
+		PairData &p = pairs[p_pair];
+		int side = _pair_side(p, p_element);
+
+		p.prev[side] = OCTREE_NO_INDEX;
+		p.next[side] = e.first_pair;
+		if (e.first_pair != OCTREE_NO_INDEX) {
+			PairData &n = pairs[e.first_pair];
+			n.prev[_pair_side(n, p_element)] = p_pair;
 		}
+		e.first_pair = p_pair;
 	}
 
-	_FORCE_INLINE_ void _pair_unreference(Element *p_A, Element *p_B) {
+	void _pair_unlink(uint32_t p_pair, uint32_t p_element) {
 
-		if (p_A == p_B)
-			return;
+		PairData &p = pairs[p_pair];
+		int side = _pair_side(p, p_element);
 
-		PairKey key(p_A->_id, p_B->_id);
-		typename PairMap::Element *E = pair_map.find(key);
-		if (!E) {
-			return; // no pair
+		if (p.prev[side] != OCTREE_NO_INDEX) {
+			PairData &q = pairs[p.prev[side]];
+			q.next[_pair_side(q, p_element)] = p.next[side];
+		} else {
+			elements[p_element].first_pair = p.next[side];
 		}
 
-		E->get().refcount--;
+		if (p.next[side] != OCTREE_NO_INDEX) {
+			PairData &q = pairs[p.next[side]];
+			q.prev[_pair_side(q, p_element)] = p.prev[side];
+		}
+	}
 
-		if (E->get().refcount == 0) {
-			// bye pair
+	_FORCE_INLINE_ void _pair_check(uint32_t p_pair) {
 
-			if (E->get().intersect) {
-				if (unpair_callback) {
-					unpair_callback(pair_callback_userdata, p_A->_id, p_A->userdata, p_A->subindex, p_B->_id, p_B->userdata, p_B->subindex, E->get().ud);
+		PairData &p = pairs[p_pair];
+		const Element &a = elements[p.A];
+		const Element &b = elements[p.B];
+		bool intersect = a.aabb.intersects_inclusive(b.aabb);
+
+		if (intersect != p.intersect) {
+
+			if (intersect) {
+
+				if (pair_callback) {
+					p.ud = pair_callback(pair_callback_userdata, p.A + 1, a.userdata, a.subindex, p.B + 1, b.userdata, b.subindex);
 				}
+				pair_count++;
+			} else {
 
+				if (unpair_callback) {
+					unpair_callback(unpair_callback_userdata, p.A + 1, a.userdata, a.subindex, p.B + 1, b.userdata, b.subindex, p.ud);
+				}
 				pair_count--;
 			}
 
-			if (p_A == E->get().B) {
-				//may be reaching inverted
-				SWAP(p_A, p_B);
-			}
-
-			p_A->pair_list.erase(E->get().eA);
-			p_B->pair_list.erase(E->get().eB);
-			pair_map.erase(E);
+			p.intersect = intersect;
 		}
 	}
 
-	_FORCE_INLINE_ void _element_check_pairs(Element *p_element) {
+	void _pair_add(uint32_t p_A, uint32_t p_B) {
 
-		typename List<PairData *, AL>::Element *E = p_element->pair_list.front();
-		while (E) {
+		if (p_A > p_B)
+			SWAP(p_A, p_B);
 
-			_pair_check(E->get());
-			E = E->next();
-		}
-	}
+		uint32_t idx = pairs.alloc();
+		PairData &p = pairs[idx];
+		p.A = p_A;
+		p.B = p_B;
+		p.intersect = false;
+		p.ud = NULL;
+		_pair_link(idx, p_A);
+		_pair_link(idx, p_B);
 
-	_FORCE_INLINE_ void _optimize() {
+		_pair_check(idx);
+	}
 
-		while (root && root->children_count < 2 && !root->elements.size() && !(use_pairs && root->pairable_elements.size())) {
+	void _pair_remove(uint32_t p_pair) {
 
-			Octant *new_root = NULL;
-			if (root->children_count == 1) {
+		PairData &p = pairs[p_pair];
+		uint32_t A = p.A;
+		uint32_t B = p.B;
+		bool intersect = p.intersect;
+		void *ud = p.ud;
+		_pair_unlink(p_pair, A);
+		_pair_unlink(p_pair, B);
+		pairs.free(p_pair);
 
-				for (int i = 0; i < 8; i++) {
+		if (!intersect)
+			return;
 
-					if (root->children[i]) {
-						new_root = root->children[i];
-						root->children[i] = NULL;
-						break;
-					}
-				}
-				ERR_FAIL_COND(!new_root);
-				new_root->parent = NULL;
-				new_root->parent_index = -1;
-			}
+		pair_count--;
 
-			memdelete_allocator<Octant, AL>(root);
-			octant_count--;
-			root = new_root;
+		if (unpair_callback) {
+			Element &a = elements[A];
+			Element &b = elements[B];
+			unpair_callback(unpair_callback_userdata, A + 1, a.userdata, a.subindex, B + 1, b.userdata, b.subindex, ud);
 		}
 	}
 
-	void _insert_element(Element *p_element, Octant *p_octant);
-	void _ensure_valid_root(const AABB &p_aabb);
-	bool _remove_element_from_octant(Element *p_element, Octant *p_octant, Octant *p_limit = NULL);
-	void _remove_element(Element *p_element);
-	void _pair_element(Element *p_element, Octant *p_octant);
-	void _unpair_element(Element *p_element, Octant *p_octant);
+	void _element_clear_pairs(uint32_t p_element) {
+
+		while (elements[p_element].first_pair != OCTREE_NO_INDEX)
+			_pair_remove(elements[p_element].first_pair);
+	}
+
+	void _insert_element(uint32_t p_element, uint32_t p_octant);
+	void _remove_element(uint32_t p_element);
+	bool _ensure_valid_root(const Vector3 &p_center, real_t p_half_size);
+	uint32_t _create_octant(const Vector3 &p_center, real_t p_half_size, uint32_t p_parent, int p_parent_index);
+	void _cleanup_octant(uint32_t p_octant);
+	void _optimize();
+	void _element_check_pairs(uint32_t p_element);
+	void _element_update_pairs(uint32_t p_element);
+	void _pair_element(uint32_t p_element, uint32_t p_octant);
+
+	// four planes at a time, laid out so the same lane of every array is one plane
+	struct _CullPlaneGroup {
+
+		real_t nx[4];
+		real_t ny[4];
+		real_t nz[4];
+		real_t d[4];
+	};
 
 	struct _CullConvexData {
 
-		const Plane *planes;
-		int plane_count;
+		const _CullPlaneGroup *groups;
+		int group_count;
 		T **result_array;
 		int *result_idx;
 		int result_max;
 		uint32_t mask;
 	};
 
-	void _cull_convex(Octant *p_octant, _CullConvexData *p_cull);
-	void _cull_aabb(Octant *p_octant, const AABB &p_aabb, T **p_result_array, int *p_result_idx, int p_result_max, int *p_subindex_array, uint32_t p_mask);
-	void _cull_segment(Octant *p_octant, const Vector3 &p_from, const Vector3 &p_to, T **p_result_array, int *p_result_idx, int p_result_max, int *p_subindex_array, uint32_t p_mask);
-	void _cull_point(Octant *p_octant, const Vector3 &p_point, T **p_result_array, int *p_result_idx, int p_result_max, int *p_subindex_array, uint32_t p_mask);
-
-	void _remove_tree(Octant *p_octant) {
+	_FORCE_INLINE_ static bool _is_group_active(int p_group, uint64_t p_plane_mask) {
 
-		if (!p_octant)
-			return;
-
-		for (int i = 0; i < 8; i++) {
-
-			if (p_octant->children[i])
-				_remove_tree(p_octant->children[i]);
-		}
-
-		memdelete_allocator<Octant, AL>(p_octant);
+		return p_group >= OCTREE_CULL_PLANE_GROUPS || ((p_plane_mask >> (p_group * 4)) & 0xF);
 	}
 
+	_FORCE_INLINE_ static bool _intersects_convex(const AABB &p_aabb, const _CullConvexData *p_cull, uint64_t p_plane_mask);
+	bool _cull_convex_octant(const Octant &p_octant, const _CullConvexData *p_cull, uint64_t &r_plane_mask) const;
+	void _cull_convex(uint32_t p_octant, _CullConvexData *p_cull, uint64_t p_plane_mask);
+	void _cull_convex_all(uint32_t p_octant, _CullConvexData *p_cull);
+	void _cull_aabb(uint32_t p_octant, const AABB &p_aabb, T **p_result_array, int *p_result_idx, int p_result_max, int *p_subindex_array, uint32_t p_mask);
+	void _cull_segment(uint32_t p_octant, const Vector3 &p_from, const Vector3 &p_to, T **p_result_array, int *p_result_idx, int p_result_max, int *p_subindex_array, uint32_t p_mask);
+	void _cull_point(uint32_t p_octant, const Vector3 &p_point, T **p_result_array, int *p_result_idx, int p_result_max, int *p_subindex_array, uint32_t p_mask);
+
 public:
 	OctreeElementID create(T *p_userdata, const AABB &p_aabb = AABB(), int p_subindex = 0, bool p_pairable = false, uint32_t p_pairable_type = 0, uint32_t pairable_mask = 1);
 	void move(OctreeElementID p_id, const AABB &p_aabb);
@@ -392,405 +469,300 @@ public:
 	int get_octant_count() const { return octant_count; }
 	int get_pair_count() const { return pair_count; }
 	Octree(real_t p_unit_size = 1.0);
-	~Octree() { _remove_tree(root); }
 };
 
 /* PRIVATE FUNCTIONS */
 
 template <class T, bool use_pairs, class AL>
 T *Octree<T, use_pairs, AL>::get(OctreeElementID p_id) const {
-	const typename ElementMap::Element *E = element_map.find(p_id);
-	ERR_FAIL_COND_V(!E, NULL);
-	return E->get().userdata;
+
+	const Element *e = _get_element(p_id);
+	ERR_FAIL_COND_V(!e, NULL);
+	return e->userdata;
 }
 
 template <class T, bool use_pairs, class AL>
 bool Octree<T, use_pairs, AL>::is_pairable(OctreeElementID p_id) const {
 
-	const typename ElementMap::Element *E = element_map.find(p_id);
-	ERR_FAIL_COND_V(!E, false);
-	return E->get().pairable;
+	const Element *e = _get_element(p_id);
+	ERR_FAIL_COND_V(!e, false);
+	return e->pairable;
 }
 
 template <class T, bool use_pairs, class AL>
 int Octree<T, use_pairs, AL>::get_subindex(OctreeElementID p_id) const {
 
-	const typename ElementMap::Element *E = element_map.find(p_id);
-	ERR_FAIL_COND_V(!E, -1);
-	return E->get().subindex;
+	const Element *e = _get_element(p_id);
+	ERR_FAIL_COND_V(!e, -1);
+	return e->subindex;
 }
 
-#define OCTREE_DIVISOR 4
-
 template <class T, bool use_pairs, class AL>
-void Octree<T, use_pairs, AL>::_insert_element(Element *p_element, Octant *p_octant) {
+uint32_t Octree<T, use_pairs, AL>::_create_octant(const Vector3 &p_center, real_t p_half_size, uint32_t p_parent, int p_parent_index) {
+
+	uint32_t idx = octants.alloc();
+	Octant &o = octants[idx];
+	o = Octant();
+	o.center = p_center;
+	o.half_size = p_half_size;
+	o.aabb.position = p_center - Vector3(p_half_size, p_half_size, p_half_size) * 2.0;
+	o.aabb.size = Vector3(p_half_size, p_half_size, p_half_size) * 4.0;
+	o.parent = p_parent;
+	o.parent_index = p_parent_index;
+
+	if (p_parent != OCTREE_NO_INDEX) {
+		Octant &parent = octants[p_parent];
+		parent.children[p_parent_index] = idx;
+		parent.children_count++;
+	}
 
-	real_t element_size = p_element->aabb.get_longest_axis_size() * 1.01; // avoid precision issues
+	octant_count++;
+	return idx;
+}
 
-	if (p_octant->aabb.size.x / OCTREE_DIVISOR < element_size) {
-		//if (p_octant->aabb.size.x*0.5 < element_size) {
+template <class T, bool use_pairs, class AL>
+bool Octree<T, use_pairs, AL>::_ensure_valid_root(const Vector3 &p_center, real_t p_half_size) {
 
-		/* at smallest possible size for the element  */
-		typename Element::OctantOwner owner;
-		owner.octant = p_octant;
+	if (root == OCTREE_NO_INDEX) {
 
-		if (use_pairs && p_element->pairable) {
+		// cells are aligned to multiples of unit_size, like the old octree
+		real_t half = unit_size * 0.5;
+		while (half < p_half_size)
+			half *= 2.0;
 
-			p_octant->pairable_elements.push_back(p_element);
-			owner.E = p_octant->pairable_elements.back();
-		} else {
+		real_t size = half * 2.0;
+		Vector3 base(
+				Math::floor(p_center.x / size) * size,
+				Math::floor(p_center.y / size) * size,
+				Math::floor(p_center.z / size) * size);
+		root = _create_octant(base + Vector3(half, half, half), half, OCTREE_NO_INDEX, -1);
+	}
 
-			p_octant->elements.push_back(p_element);
-			owner.E = p_octant->elements.back();
-		}
+	while (!_fits(octants[root], p_center, p_half_size)) {
 
-		p_element->octant_owners.push_back(owner);
+		Octant &old_root = octants[root];
+		ERR_FAIL_COND_V(old_root.half_size > OCTREE_SIZE_LIMIT, false);
 
-		if (p_element->common_parent == NULL) {
-			p_element->common_parent = p_octant;
-			p_element->container_aabb = p_octant->aabb;
+		// grow towards the element, the old root becomes a child of the new one
+		Vector3 center = old_root.center;
+		int idx = 0;
+		if (p_center.x >= old_root.center.x) {
+			center.x += old_root.half_size;
 		} else {
-			p_element->container_aabb.merge_with(p_octant->aabb);
+			center.x -= old_root.half_size;
+			idx |= 1;
 		}
-
-		if (use_pairs && p_octant->children_count > 0) {
-
-			pass++; //elements below this only get ONE reference added
-
-			for (int i = 0; i < 8; i++) {
-
-				if (p_octant->children[i]) {
-					_pair_element(p_element, p_octant->children[i]);
-				}
-			}
+		if (p_center.y >= old_root.center.y) {
+			center.y += old_root.half_size;
+		} else {
+			center.y -= old_root.half_size;
+			idx |= 2;
 		}
-	} else {
-		/* not big enough, send it to subitems */
-		int splits = 0;
-		bool candidate = p_element->common_parent == NULL;
-
-		for (int i = 0; i < 8; i++) {
-
-			if (p_octant->children[i]) {
-				/* element exists, go straight to it */
-				if (p_octant->children[i]->aabb.intersects_inclusive(p_element->aabb)) {
-					_insert_element(p_element, p_octant->children[i]);
-					splits++;
-				}
-			} else {
-				/* check againt AABB where child should be */
-
-				AABB aabb = p_octant->aabb;
-				aabb.size *= 0.5;
-
-				if (i & 1)
-					aabb.position.x += aabb.size.x;
-				if (i & 2)
-					aabb.position.y += aabb.size.y;
-				if (i & 4)
-					aabb.position.z += aabb.size.z;
-
-				if (aabb.intersects_inclusive(p_element->aabb)) {
-					/* if actually intersects, create the child */
-
-					Octant *child = memnew_allocator(Octant, AL);
-					p_octant->children[i] = child;
-					child->parent = p_octant;
-					child->parent_index = i;
-
-					child->aabb = aabb;
-
-					p_octant->children_count++;
-
-					_insert_element(p_element, child);
-					octant_count++;
-					splits++;
-				}
-			}
+		if (p_center.z >= old_root.center.z) {
+			center.z += old_root.half_size;
+		} else {
+			center.z -= old_root.half_size;
+			idx |= 4;
 		}
 
-		if (candidate && splits > 1) {
-
-			p_element->common_parent = p_octant;
-		}
+		uint32_t new_root = _create_octant(center, old_root.half_size * 2.0, OCTREE_NO_INDEX, -1);
+		Octant &o = octants[new_root];
+		o.children[idx] = root;
+		o.children_count = 1;
+		old_root.parent = new_root;
+		old_root.parent_index = idx;
+		root = new_root;
 	}
 
-	if (use_pairs) {
-
-		typename List<Element *, AL>::Element *E = p_octant->pairable_elements.front();
-
-		while (E) {
-			_pair_reference(p_element, E->get());
-			E = E->next();
-		}
-
-		if (p_element->pairable) {
-			// and always test non-pairable if element is pairable
-			E = p_octant->elements.front();
-			while (E) {
-				_pair_reference(p_element, E->get());
-				E = E->next();
-			}
-		}
-	}
+	return true;
 }
 
 template <class T, bool use_pairs, class AL>
-void Octree<T, use_pairs, AL>::_ensure_valid_root(const AABB &p_aabb) {
-
-	if (!root) {
-		// octre is empty
-
-		AABB base(Vector3(), Vector3(1.0, 1.0, 1.0) * unit_size);
-
-		while (!base.encloses(p_aabb)) {
-
-			if (ABS(base.position.x + base.size.x) <= ABS(base.position.x)) {
-				/* grow towards positive */
-				base.size *= 2.0;
-			} else {
-				base.position -= base.size;
-				base.size *= 2.0;
-			}
-		}
-
-		root = memnew_allocator(Octant, AL);
-
-		root->parent = NULL;
-		root->parent_index = -1;
-		root->aabb = base;
-
-		octant_count++;
-
-	} else {
-
-		AABB base = root->aabb;
-
-		while (!base.encloses(p_aabb)) {
-
-			if (base.size.x > OCTREE_SIZE_LIMIT) {
-				ERR_EXPLAIN("Octree upper size limit reeached, does the AABB supplied contain NAN?");
-				ERR_FAIL();
-			}
-
-			Octant *gp = memnew_allocator(Octant, AL);
-			octant_count++;
-			root->parent = gp;
-
-			if (ABS(base.position.x + base.size.x) <= ABS(base.position.x)) {
-				/* grow towards positive */
-				base.size *= 2.0;
-				gp->aabb = base;
-				gp->children[0] = root;
-				root->parent_index = 0;
-			} else {
-				base.position -= base.size;
-				base.size *= 2.0;
-				gp->aabb = base;
-				gp->children[(1 << 0) | (1 << 1) | (1 << 2)] = root; // add at all-positive
-				root->parent_index = (1 << 0) | (1 << 1) | (1 << 2);
-			}
-
-			gp->children_count = 1;
-			root = gp;
+void Octree<T, use_pairs, AL>::_insert_element(uint32_t p_element, uint32_t p_octant) {
+
+	Element &e = elements[p_element];
+	Vector3 center;
+	real_t half_size;
+	_get_center(e.fat_aabb, center, half_size);
+
+	uint32_t idx = p_octant;
+
+	while (_can_descend(octants[idx], half_size)) {
+
+		const Octant &o = octants[idx];
+		int i = 0;
+		if (center.x >= o.center.x)
+			i |= 1;
+		if (center.y >= o.center.y)
+			i |= 2;
+		if (center.z >= o.center.z)
+			i |= 4;
+
+		uint32_t child = o.children[i];
+		if (child == OCTREE_NO_INDEX) {
+			real_t child_half = o.half_size * 0.5;
+			Vector3 child_center(
+					o.center.x + ((i & 1) ? child_half : -child_half),
+					o.center.y + ((i & 2) ? child_half : -child_half),
+					o.center.z + ((i & 4) ? child_half : -child_half));
+			child = _create_octant(child_center, child_half, idx, i);
 		}
+		idx = child;
 	}
+
+	Octant &o = octants[idx];
+	e.octant = idx;
+	e.prev = OCTREE_NO_INDEX;
+	e.next = o.first_element;
+	if (o.first_element != OCTREE_NO_INDEX)
+		elements[o.first_element].prev = p_element;
+	o.first_element = p_element;
+	o.element_count++;
 }
 
 template <class T, bool use_pairs, class AL>
-bool Octree<T, use_pairs, AL>::_remove_element_from_octant(Element *p_element, Octant *p_octant, Octant *p_limit) {
-
-	bool octant_removed = false;
-
-	while (true) {
-
-		// check all exit conditions
-
-		if (p_octant == p_limit) // reached limit, nothing to erase, exit
-			return octant_removed;
-
-		bool unpaired = false;
-
-		if (use_pairs && p_octant->last_pass != pass) {
-			// check whether we should unpair stuff
-			// always test pairable
-			typename List<Element *, AL>::Element *E = p_octant->pairable_elements.front();
-			while (E) {
-				_pair_unreference(p_element, E->get());
-				E = E->next();
-			}
-			if (p_element->pairable) {
-				// and always test non-pairable if element is pairable
-				E = p_octant->elements.front();
-				while (E) {
-					_pair_unreference(p_element, E->get());
-					E = E->next();
-				}
-			}
-			p_octant->last_pass = pass;
-			unpaired = true;
-		}
-
-		bool removed = false;
-
-		Octant *parent = p_octant->parent;
-
-		if (p_octant->children_count == 0 && p_octant->elements.empty() && p_octant->pairable_elements.empty()) {
+void Octree<T, use_pairs, AL>::_remove_element(uint32_t p_element) {
+
+	Element &e = elements[p_element];
+	Octant &o = octants[e.octant];
+
+	if (e.prev != OCTREE_NO_INDEX)
+		elements[e.prev].next = e.next;
+	else
+		o.first_element = e.next;
+	if (e.next != OCTREE_NO_INDEX)
+		elements[e.next].prev = e.prev;
+
+	o.element_count--;
+	e.octant = OCTREE_NO_INDEX;
+	e.prev = OCTREE_NO_INDEX;
+	e.next = OCTREE_NO_INDEX;
+}
 
-			// erase octant
+template <class T, bool use_pairs, class AL>
+void Octree<T, use_pairs, AL>::_cleanup_octant(uint32_t p_octant) {
 
-			if (p_octant == root) { // won't have a parent, just erase
+	uint32_t idx = p_octant;
 
-				root = NULL;
-			} else {
-				ERR_FAIL_INDEX_V(p_octant->parent_index, 8, octant_removed);
+	while (idx != OCTREE_NO_INDEX) {
 
-				parent->children[p_octant->parent_index] = NULL;
-				parent->children_count--;
-			}
+		Octant &o = octants[idx];
+		if (o.element_count || o.children_count)
+			break;
 
-			memdelete_allocator<Octant, AL>(p_octant);
-			octant_count--;
-			removed = true;
-			octant_removed = true;
+		uint32_t parent = o.parent;
+		if (parent != OCTREE_NO_INDEX) {
+			Octant &p = octants[parent];
+			p.children[o.parent_index] = OCTREE_NO_INDEX;
+			p.children_count--;
+		} else {
+			root = OCTREE_NO_INDEX;
 		}
 
-		if (!removed && !unpaired)
-			return octant_removed; // no reason to keep going up anymore! was already visited and was not removed
-
-		p_octant = parent;
+		octants.free(idx);
+		octant_count--;
+		idx = parent;
 	}
-
-	return octant_removed;
 }
 
 template <class T, bool use_pairs, class AL>
-void Octree<T, use_pairs, AL>::_unpair_element(Element *p_element, Octant *p_octant) {
-
-	// always test pairable
-	typename List<Element *, AL>::Element *E = p_octant->pairable_elements.front();
-	while (E) {
-		if (E->get()->last_pass != pass) { // only remove ONE reference
-			_pair_unreference(p_element, E->get());
-			E->get()->last_pass = pass;
-		}
-		E = E->next();
-	}
+void Octree<T, use_pairs, AL>::_optimize() {
 
-	if (p_element->pairable) {
-		// and always test non-pairable if element is pairable
-		E = p_octant->elements.front();
-		while (E) {
-			if (E->get()->last_pass != pass) { // only remove ONE reference
-				_pair_unreference(p_element, E->get());
-				E->get()->last_pass = pass;
+	while (root != OCTREE_NO_INDEX && octants[root].children_count == 1 && !octants[root].element_count) {
+
+		Octant &o = octants[root];
+		uint32_t new_root = OCTREE_NO_INDEX;
+		for (int i = 0; i < 8; i++) {
+			if (o.children[i] != OCTREE_NO_INDEX) {
+				new_root = o.children[i];
+				break;
 			}
-			E = E->next();
 		}
-	}
-
-	p_octant->last_pass = pass;
-
-	if (p_octant->children_count == 0)
-		return; // small optimization for leafs
-
-	for (int i = 0; i < 8; i++) {
+		ERR_FAIL_COND(new_root == OCTREE_NO_INDEX);
 
-		if (p_octant->children[i])
-			_unpair_element(p_element, p_octant->children[i]);
+		octants[new_root].parent = OCTREE_NO_INDEX;
+		octants[new_root].parent_index = -1;
+		octants.free(root);
+		octant_count--;
+		root = new_root;
 	}
 }
 
 template <class T, bool use_pairs, class AL>
-void Octree<T, use_pairs, AL>::_pair_element(Element *p_element, Octant *p_octant) {
+void Octree<T, use_pairs, AL>::_pair_element(uint32_t p_element, uint32_t p_octant) {
 
-	// always test pairable
+	const Octant &o = octants[p_octant];
+	const Element &e = elements[p_element];
 
-	typename List<Element *, AL>::Element *E = p_octant->pairable_elements.front();
+	if (!o.aabb.intersects_inclusive(e.fat_aabb))
+		return;
 
-	while (E) {
+	for (uint32_t idx = o.first_element; idx != OCTREE_NO_INDEX; idx = elements[idx].next) {
 
-		if (E->get()->last_pass != pass) { // only get ONE reference
-			_pair_reference(p_element, E->get());
-			E->get()->last_pass = pass;
-		}
-		E = E->next();
-	}
+		const Element &other = elements[idx];
 
-	if (p_element->pairable) {
-		// and always test non-pairable if element is pairable
-		E = p_octant->elements.front();
-		while (E) {
-			if (E->get()->last_pass != pass) { // only get ONE reference
-				_pair_reference(p_element, E->get());
-				E->get()->last_pass = pass;
-			}
-			E = E->next();
-		}
-	}
-	p_octant->last_pass = pass;
+		if (other.last_pass == pass) // itself, or already paired
+			continue;
+		if (!e.pairable && !other.pairable)
+			continue;
+		if (e.userdata == other.userdata && e.userdata)
+			continue;
+		if (!(e.pairable_type & other.pairable_mask) && !(other.pairable_type & e.pairable_mask))
+			continue; // none can pair with none
+		if (!e.fat_aabb.intersects_inclusive(other.fat_aabb))
+			continue;
 
-	if (p_octant->children_count == 0)
-		return; // small optimization for leafs
+		_pair_add(p_element, idx);
+	}
 
 	for (int i = 0; i < 8; i++) {
 
-		if (p_octant->children[i])
-			_pair_element(p_element, p_octant->children[i]);
+		if (o.children[i] != OCTREE_NO_INDEX)
+			_pair_element(p_element, o.children[i]);
 	}
 }
 
 template <class T, bool use_pairs, class AL>
-void Octree<T, use_pairs, AL>::_remove_element(Element *p_element) {
-
-	pass++; // will do a new pass for this
-
-	typename List<typename Element::OctantOwner, AL>::Element *I = p_element->octant_owners.front();
-
-	/* FIRST remove going up normally */
-	for (; I; I = I->next()) {
-
-		Octant *o = I->get().octant;
+void Octree<T, use_pairs, AL>::_element_check_pairs(uint32_t p_element) {
 
-		if (!use_pairs) // small speedup
-			o->elements.erase(I->get().E);
+	uint32_t idx = elements[p_element].first_pair;
+	while (idx != OCTREE_NO_INDEX) {
 
-		_remove_element_from_octant(p_element, o);
+		_pair_check(idx);
+		const PairData &p = pairs[idx];
+		idx = p.next[_pair_side(p, p_element)];
 	}
+}
 
-	/* THEN remove going down */
-
-	I = p_element->octant_owners.front();
-
-	if (use_pairs) {
+template <class T, bool use_pairs, class AL>
+void Octree<T, use_pairs, AL>::_element_update_pairs(uint32_t p_element) {
 
-		for (; I; I = I->next()) {
+	Element &e = elements[p_element];
 
-			Octant *o = I->get().octant;
+	// drop the pairs that got too far apart, mark the ones that remain
+	pass++;
+	e.last_pass = pass;
 
-			// erase children pairs, they are erased ONCE even if repeated
-			pass++;
-			for (int i = 0; i < 8; i++) {
+	uint32_t idx = e.first_pair;
+	while (idx != OCTREE_NO_INDEX) {
 
-				if (o->children[i])
-					_unpair_element(p_element, o->children[i]);
-			}
+		PairData &p = pairs[idx];
+		int side = _pair_side(p, p_element);
+		uint32_t next = p.next[side];
+		Element &other = elements[side == 0 ? p.B : p.A];
 
-			if (p_element->pairable)
-				o->pairable_elements.erase(I->get().E);
-			else
-				o->elements.erase(I->get().E);
+		if (e.fat_aabb.intersects_inclusive(other.fat_aabb)) {
+			other.last_pass = pass;
+			_pair_check(idx);
+		} else {
+			_pair_remove(idx);
 		}
-	}
-
-	p_element->octant_owners.clear();
-
-	if (use_pairs) {
 
-		int remaining = p_element->pair_list.size();
-		//p_element->pair_list.clear();
-		ERR_FAIL_COND(remaining);
+		idx = next;
 	}
+
+	if (root != OCTREE_NO_INDEX)
+		_pair_element(p_element, root);
 }
 
 template <class T, bool use_pairs, class AL>
@@ -809,28 +781,33 @@ OctreeElementID Octree<T, use_pairs, AL>::create(T *p_userdata, const AABB &p_aa
 	ERR_FAIL_COND_V(Math::is_nan(p_aabb.size.z), 0);
 
 #endif
-	typename ElementMap::Element *E = element_map.insert(last_element_id++,
-			Element());
-	Element &e = E->get();
+	uint32_t idx = elements.alloc();
+	Element &e = elements[idx];
+	e = Element();
 
 	e.aabb = p_aabb;
 	e.userdata = p_userdata;
 	e.subindex = p_subindex;
-	e.last_pass = 0;
-	e.octree = this;
+	e.active = true;
 	e.pairable = p_pairable;
 	e.pairable_type = p_pairable_type;
 	e.pairable_mask = p_pairable_mask;
-	e._id = last_element_id - 1;
 
 	if (!e.aabb.has_no_surface()) {
-		_ensure_valid_root(p_aabb);
-		_insert_element(&e, root);
-		if (use_pairs)
-			_element_check_pairs(&e);
+
+		Vector3 center;
+		real_t half_size;
+		e.fat_aabb = _get_fat_aabb(p_aabb);
+		_get_center(e.fat_aabb, center, half_size);
+
+		if (_ensure_valid_root(center, half_size)) {
+			_insert_element(idx, root);
+			if (use_pairs)
+				_element_update_pairs(idx);
+		}
 	}
 
-	return last_element_id - 1;
+	return idx + 1;
 }
 
 template <class T, bool use_pairs, class AL>
@@ -848,446 +825,363 @@ void Octree<T, use_pairs, AL>::move(OctreeElementID p_id, const AABB &p_aabb) {
 	ERR_FAIL_COND(Math::is_nan(p_aabb.size.y));
 	ERR_FAIL_COND(Math::is_nan(p_aabb.size.z));
 #endif
-	typename ElementMap::Element *E = element_map.find(p_id);
-	ERR_FAIL_COND(!E);
-	Element &e = E->get();
+	Element *e = _get_element(p_id);
+	ERR_FAIL_COND(!e);
+	uint32_t idx = p_id - 1;
+	uint32_t old_octant = e->octant;
 
-	bool old_has_surf = !e.aabb.has_no_surface();
-	bool new_has_surf = !p_aabb.has_no_surface();
+	if (p_aabb.has_no_surface()) {
 
-	if (old_has_surf != new_has_surf) {
-
-		if (old_has_surf) {
-			_remove_element(&e); // removing
-			e.common_parent = NULL;
-			e.aabb = AABB();
-			_optimize();
-		} else {
-			_ensure_valid_root(p_aabb); // inserting
-			e.common_parent = NULL;
-			e.aabb = p_aabb;
-			_insert_element(&e, root);
+		e->aabb = p_aabb;
+		if (old_octant != OCTREE_NO_INDEX) {
+			// removing
+			_remove_element(idx);
 			if (use_pairs)
-				_element_check_pairs(&e);
+				_element_clear_pairs(idx);
+			_cleanup_octant(old_octant);
+			_optimize();
 		}
-
 		return;
 	}
 
-	if (!old_has_surf) // doing nothing
-		return;
-
-	// it still is enclosed in the same AABB it was assigned to
-	if (e.container_aabb.encloses(p_aabb)) {
+	if (old_octant != OCTREE_NO_INDEX && e->fat_aabb.encloses(p_aabb)) {
 
-		e.aabb = p_aabb;
+		// the tree and the pair candidates stay as they are
+		e->aabb = p_aabb;
 		if (use_pairs)
-			_element_check_pairs(&e); // must check pairs anyway
-
+			_element_check_pairs(idx);
 		return;
 	}
 
-	AABB combined = e.aabb;
-	combined.merge_with(p_aabb);
-	_ensure_valid_root(combined);
-
-	ERR_FAIL_COND(e.octant_owners.front() == NULL);
-
-	/* FIND COMMON PARENT */
+	e->aabb = p_aabb;
+	e->fat_aabb = _get_fat_aabb(p_aabb);
 
-	List<typename Element::OctantOwner, AL> owners = e.octant_owners; // save the octant owners
-	Octant *common_parent = e.common_parent;
-	ERR_FAIL_COND(!common_parent);
+	Vector3 center;
+	real_t half_size;
+	_get_center(e->fat_aabb, center, half_size);
 
-	//src is now the place towards where insertion is going to happen
-	pass++;
-
-	while (common_parent && !common_parent->aabb.encloses(p_aabb))
-		common_parent = common_parent->parent;
-
-	ERR_FAIL_COND(!common_parent);
-
-	//prepare for reinsert
-	e.octant_owners.clear();
-	e.common_parent = NULL;
-	e.aabb = p_aabb;
+	if (old_octant == OCTREE_NO_INDEX) {
 
-	_insert_element(&e, common_parent); // reinsert from this point
-
-	pass++;
-
-	for (typename List<typename Element::OctantOwner, AL>::Element *E = owners.front(); E;) {
-
-		Octant *o = E->get().octant;
-		typename List<typename Element::OctantOwner, AL>::Element *N = E->next();
-
-		/*
-		if (!use_pairs)
-			o->elements.erase( E->get().E );
-		*/
-
-		if (use_pairs && e.pairable)
-			o->pairable_elements.erase(E->get().E);
-		else
-			o->elements.erase(E->get().E);
+		// inserting
+		if (!_ensure_valid_root(center, half_size))
+			return;
+		_insert_element(idx, root);
 
-		if (_remove_element_from_octant(&e, o, common_parent->parent)) {
+	} else if (_fits(octants[old_octant], center, half_size)) {
 
-			owners.erase(E);
+		// still inside the loose bounds, only go deeper if it shrank enough
+		if (_can_descend(octants[old_octant], half_size)) {
+			_remove_element(idx);
+			_insert_element(idx, old_octant);
 		}
 
-		E = N;
-	}
+	} else {
 
-	if (use_pairs) {
-		//unpair child elements in anything that survived
-		for (typename List<typename Element::OctantOwner, AL>::Element *E = owners.front(); E; E = E->next()) {
+		_remove_element(idx);
 
-			Octant *o = E->get().octant;
+		uint32_t from = octants[old_octant].parent;
+		while (from != OCTREE_NO_INDEX && !_fits(octants[from], center, half_size))
+			from = octants[from].parent;
 
-			// erase children pairs, unref ONCE
-			pass++;
-			for (int i = 0; i < 8; i++) {
+		if (from == OCTREE_NO_INDEX) {
 
-				if (o->children[i])
-					_unpair_element(&e, o->children[i]);
+			if (!_ensure_valid_root(center, half_size)) {
+				if (use_pairs)
+					_element_clear_pairs(idx);
+				_cleanup_octant(old_octant);
+				_optimize();
+				return;
 			}
+			from = root;
 		}
 
-		_element_check_pairs(&e);
+		_insert_element(idx, from);
+		_cleanup_octant(old_octant);
+		_optimize();
 	}
 
-	_optimize();
+	if (use_pairs)
+		_element_update_pairs(idx);
 }
 
 template <class T, bool use_pairs, class AL>
 void Octree<T, use_pairs, AL>::set_pairable(OctreeElementID p_id, bool p_pairable, uint32_t p_pairable_type, uint32_t p_pairable_mask) {
 
-	typename ElementMap::Element *E = element_map.find(p_id);
-	ERR_FAIL_COND(!E);
-
-	Element &e = E->get();
+	Element *e = _get_element(p_id);
+	ERR_FAIL_COND(!e);
 
-	if (p_pairable == e.pairable && e.pairable_type == p_pairable_type && e.pairable_mask == p_pairable_mask)
+	if (p_pairable == e->pairable && e->pairable_type == p_pairable_type && e->pairable_mask == p_pairable_mask)
 		return; // no changes, return
 
-	if (!e.aabb.has_no_surface()) {
-		_remove_element(&e);
-	}
+	uint32_t idx = p_id - 1;
 
-	e.pairable = p_pairable;
-	e.pairable_type = p_pairable_type;
-	e.pairable_mask = p_pairable_mask;
-	e.common_parent = NULL;
+	if (use_pairs)
+		_element_clear_pairs(idx);
 
-	if (!e.aabb.has_no_surface()) {
-		_ensure_valid_root(e.aabb);
-		_insert_element(&e, root);
-		if (use_pairs)
-			_element_check_pairs(&e);
-	}
+	e->pairable = p_pairable;
+	e->pairable_type = p_pairable_type;
+	e->pairable_mask = p_pairable_mask;
+
+	if (use_pairs && e->octant != OCTREE_NO_INDEX)
+		_element_update_pairs(idx);
 }
 
 template <class T, bool use_pairs, class AL>
 void Octree<T, use_pairs, AL>::erase(OctreeElementID p_id) {
 
-	typename ElementMap::Element *E = element_map.find(p_id);
-	ERR_FAIL_COND(!E);
-
-	Element &e = E->get();
+	Element *e = _get_element(p_id);
+	ERR_FAIL_COND(!e);
+	uint32_t idx = p_id - 1;
 
-	if (!e.aabb.has_no_surface()) {
+	if (e->octant != OCTREE_NO_INDEX) {
 
-		_remove_element(&e);
+		uint32_t octant = e->octant;
+		_remove_element(idx);
+		if (use_pairs)
+			_element_clear_pairs(idx);
+		_cleanup_octant(octant);
+		_optimize();
 	}
 
-	element_map.erase(p_id);
-	_optimize();
+	e->active = false;
+	e->userdata = NULL;
+	elements.free(idx);
 }
 
 template <class T, bool use_pairs, class AL>
-void Octree<T, use_pairs, AL>::_cull_convex(Octant *p_octant, _CullConvexData *p_cull) {
+bool Octree<T, use_pairs, AL>::_intersects_convex(const AABB &p_aabb, const _CullConvexData *p_cull, uint64_t p_plane_mask) {
 
-	if (*p_cull->result_idx == p_cull->result_max)
-		return; //pointless
+	// same arithmetic as AABB::intersects_convex_shape, four planes per step
+	Vector3 half_extents = p_aabb.size * 0.5;
+	Vector3 ofs = p_aabb.position + half_extents;
 
-	if (!p_octant->elements.empty()) {
+	for (int i = 0; i < p_cull->group_count; i++) {
 
-		typename List<Element *, AL>::Element *I;
-		I = p_octant->elements.front();
+		if (!_is_group_active(i, p_plane_mask))
+			continue;
 
-		for (; I; I = I->next()) {
+		const _CullPlaneGroup &g = p_cull->groups[i];
+		bool over = false;
+		for (int j = 0; j < 4; j++) {
+			real_t px = ((g.nx[j] > 0) ? -half_extents.x : half_extents.x) + ofs.x;
+			real_t py = ((g.ny[j] > 0) ? -half_extents.y : half_extents.y) + ofs.y;
+			real_t pz = ((g.nz[j] > 0) ? -half_extents.z : half_extents.z) + ofs.z;
+			over |= (g.nx[j] * px + g.ny[j] * py + g.nz[j] * pz) > g.d[j];
+		}
 
-			Element *e = I->get();
+		if (over)
+			return false;
+	}
 
-			if (e->last_pass == pass || (use_pairs && !(e->pairable_type & p_cull->mask)))
-				continue;
-			e->last_pass = pass;
+	return true;
+}
 
-			if (e->aabb.intersects_convex_shape(p_cull->planes, p_cull->plane_count)) {
+template <class T, bool use_pairs, class AL>
+bool Octree<T, use_pairs, AL>::_cull_convex_octant(const Octant &p_octant, const _CullConvexData *p_cull, uint64_t &r_plane_mask) const {
 
-				if (*p_cull->result_idx < p_cull->result_max) {
-					p_cull->result_array[*p_cull->result_idx] = e->userdata;
-					(*p_cull->result_idx)++;
-				} else {
+	// false if the loose bounds are outside any plane, planes that have the
+	// bounds fully behind them are dropped from the mask for the children
+	real_t h = p_octant.half_size * 2.0;
+	const Vector3 &c = p_octant.center;
 
-					return; // pointless to continue
-				}
-			}
-		}
-	}
+	for (int i = 0; i < p_cull->group_count; i++) {
 
-	if (use_pairs && !p_octant->pairable_elements.empty()) {
+		if (!_is_group_active(i, r_plane_mask))
+			continue;
 
-		typename List<Element *, AL>::Element *I;
-		I = p_octant->pairable_elements.front();
+		const _CullPlaneGroup &g = p_cull->groups[i];
+		for (int j = 0; j < 4; j++) {
 
-		for (; I; I = I->next()) {
+			real_t nx = g.nx[j], ny = g.ny[j], nz = g.nz[j];
+			real_t inner = nx * (((nx > 0) ? -h : h) + c.x) + ny * (((ny > 0) ? -h : h) + c.y) + nz * (((nz > 0) ? -h : h) + c.z);
+			if (inner > g.d[j])
+				return false;
 
-			Element *e = I->get();
+			real_t outer = nx * (((nx > 0) ? h : -h) + c.x) + ny * (((ny > 0) ? h : -h) + c.y) + nz * (((nz > 0) ? h : -h) + c.z);
+			if (outer <= g.d[j] && i < OCTREE_CULL_PLANE_GROUPS)
+				r_plane_mask &= ~(uint64_t(1) << (i * 4 + j));
+		}
+	}
+
+	return true;
+}
 
-			if (e->last_pass == pass || (use_pairs && !(e->pairable_type & p_cull->mask)))
-				continue;
-			e->last_pass = pass;
+template <class T, bool use_pairs, class AL>
+void Octree<T, use_pairs, AL>::_cull_convex_all(uint32_t p_octant, _CullConvexData *p_cull) {
 
-			if (e->aabb.intersects_convex_shape(p_cull->planes, p_cull->plane_count)) {
+	const Octant &o = octants[p_octant];
 
-				if (*p_cull->result_idx < p_cull->result_max) {
+	for (uint32_t idx = o.first_element; idx != OCTREE_NO_INDEX; idx = elements[idx].next) {
 
-					p_cull->result_array[*p_cull->result_idx] = e->userdata;
-					(*p_cull->result_idx)++;
-				} else {
+		const Element &e = elements[idx];
+		if (use_pairs && !(e.pairable_type & p_cull->mask))
+			continue;
 
-					return; // pointless to continue
-				}
-			}
-		}
+		if (*p_cull->result_idx == p_cull->result_max)
+			return; // pointless to continue
+		p_cull->result_array[*p_cull->result_idx] = e.userdata;
+		(*p_cull->result_idx)++;
 	}
 
 	for (int i = 0; i < 8; i++) {
 
-		if (p_octant->children[i] && p_octant->children[i]->aabb.intersects_convex_shape(p_cull->planes, p_cull->plane_count)) {
-			_cull_convex(p_octant->children[i], p_cull);
-		}
+		if (o.children[i] != OCTREE_NO_INDEX)
+			_cull_convex_all(o.children[i], p_cull);
 	}
 }
 
 template <class T, bool use_pairs, class AL>
-void Octree<T, use_pairs, AL>::_cull_aabb(Octant *p_octant, const AABB &p_aabb, T **p_result_array, int *p_result_idx, int p_result_max, int *p_subindex_array, uint32_t p_mask) {
+void Octree<T, use_pairs, AL>::_cull_convex(uint32_t p_octant, _CullConvexData *p_cull, uint64_t p_plane_mask) {
 
-	if (*p_result_idx == p_result_max)
+	if (*p_cull->result_idx == p_cull->result_max)
 		return; //pointless
 
-	if (!p_octant->elements.empty()) {
-
-		typename List<Element *, AL>::Element *I;
-		I = p_octant->elements.front();
-		for (; I; I = I->next()) {
-
-			Element *e = I->get();
-
-			if (e->last_pass == pass || (use_pairs && !(e->pairable_type & p_mask)))
-				continue;
-			e->last_pass = pass;
-
-			if (p_aabb.intersects_inclusive(e->aabb)) {
+	const Octant &o = octants[p_octant];
 
-				if (*p_result_idx < p_result_max) {
-
-					p_result_array[*p_result_idx] = e->userdata;
-					if (p_subindex_array)
-						p_subindex_array[*p_result_idx] = e->subindex;
-
-					(*p_result_idx)++;
-				} else {
+	if (!_cull_convex_octant(o, p_cull, p_plane_mask))
+		return;
 
-					return; // pointless to continue
-				}
-			}
-		}
+	if (!p_plane_mask && p_cull->group_count <= OCTREE_CULL_PLANE_GROUPS) {
+		// fully inside, no need to test anything below
+		_cull_convex_all(p_octant, p_cull);
+		return;
 	}
 
-	if (use_pairs && !p_octant->pairable_elements.empty()) {
-
-		typename List<Element *, AL>::Element *I;
-		I = p_octant->pairable_elements.front();
-		for (; I; I = I->next()) {
-
-			Element *e = I->get();
-
-			if (e->last_pass == pass || (use_pairs && !(e->pairable_type & p_mask)))
-				continue;
-			e->last_pass = pass;
+	for (uint32_t idx = o.first_element; idx != OCTREE_NO_INDEX; idx = elements[idx].next) {
 
-			if (p_aabb.intersects_inclusive(e->aabb)) {
+		const Element &e = elements[idx];
+		if (use_pairs && !(e.pairable_type & p_cull->mask))
+			continue;
 
-				if (*p_result_idx < p_result_max) {
+		if (_intersects_convex(e.aabb, p_cull, p_plane_mask)) {
 
-					p_result_array[*p_result_idx] = e->userdata;
-					if (p_subindex_array)
-						p_subindex_array[*p_result_idx] = e->subindex;
-					(*p_result_idx)++;
-				} else {
+			if (*p_cull->result_idx < p_cull->result_max) {
+				p_cull->result_array[*p_cull->result_idx] = e.userdata;
+				(*p_cull->result_idx)++;
+			} else {
 
-					return; // pointless to continue
-				}
+				return; // pointless to continue
 			}
 		}
 	}
 
 	for (int i = 0; i < 8; i++) {
 
-		if (p_octant->children[i] && p_octant->children[i]->aabb.intersects_inclusive(p_aabb)) {
-			_cull_aabb(p_octant->children[i], p_aabb, p_result_array, p_result_idx, p_result_max, p_subindex_array, p_mask);
-		}
+		if (o.children[i] != OCTREE_NO_INDEX)
+			_cull_convex(o.children[i], p_cull, p_plane_mask);
 	}
 }
 
 template <class T, bool use_pairs, class AL>
-void Octree<T, use_pairs, AL>::_cull_segment(Octant *p_octant, const Vector3 &p_from, const Vector3 &p_to, T **p_result_array, int *p_result_idx, int p_result_max, int *p_subindex_array, uint32_t p_mask) {
+void Octree<T, use_pairs, AL>::_cull_aabb(uint32_t p_octant, const AABB &p_aabb, T **p_result_array, int *p_result_idx, int p_result_max, int *p_subindex_array, uint32_t p_mask) {
 
 	if (*p_result_idx == p_result_max)
 		return; //pointless
 
-	if (!p_octant->elements.empty()) {
-
-		typename List<Element *, AL>::Element *I;
-		I = p_octant->elements.front();
-		for (; I; I = I->next()) {
-
-			Element *e = I->get();
+	const Octant &o = octants[p_octant];
 
-			if (e->last_pass == pass || (use_pairs && !(e->pairable_type & p_mask)))
-				continue;
-			e->last_pass = pass;
+	for (uint32_t idx = o.first_element; idx != OCTREE_NO_INDEX; idx = elements[idx].next) {
 
-			if (e->aabb.intersects_segment(p_from, p_to)) {
+		const Element &e = elements[idx];
+		if (use_pairs && !(e.pairable_type & p_mask))
+			continue;
 
-				if (*p_result_idx < p_result_max) {
+		if (p_aabb.intersects_inclusive(e.aabb)) {
 
-					p_result_array[*p_result_idx] = e->userdata;
-					if (p_subindex_array)
-						p_subindex_array[*p_result_idx] = e->subindex;
-					(*p_result_idx)++;
+			if (*p_result_idx < p_result_max) {
 
-				} else {
+				p_result_array[*p_result_idx] = e.userdata;
+				if (p_subindex_array)
+					p_subindex_array[*p_result_idx] = e.subindex;
 
-					return; // pointless to continue
-				}
-			}
-		}
-	}
-
-	if (use_pairs && !p_octant->pairable_elements.empty()) {
-
-		typename List<Element *, AL>::Element *I;
-		I = p_octant->pairable_elements.front();
-		for (; I; I = I->next()) {
-
-			Element *e = I->get();
-
-			if (e->last_pass == pass || (use_pairs && !(e->pairable_type & p_mask)))
-				continue;
-
-			e->last_pass = pass;
-
-			if (e->aabb.intersects_segment(p_from, p_to)) {
-
-				if (*p_result_idx < p_result_max) {
-
-					p_result_array[*p_result_idx] = e->userdata;
-					if (p_subindex_array)
-						p_subindex_array[*p_result_idx] = e->subindex;
-
-					(*p_result_idx)++;
-
-				} else {
+				(*p_result_idx)++;
+			} else {
 
-					return; // pointless to continue
-				}
+				return; // pointless to continue
 			}
 		}
 	}
 
 	for (int i = 0; i < 8; i++) {
 
-		if (p_octant->children[i] && p_octant->children[i]->aabb.intersects_segment(p_from, p_to)) {
-			_cull_segment(p_octant->children[i], p_from, p_to, p_result_array, p_result_idx, p_result_max, p_subindex_array, p_mask);
+		if (o.children[i] != OCTREE_NO_INDEX && octants[o.children[i]].aabb.intersects_inclusive(p_aabb)) {
+			_cull_aabb(o.children[i], p_aabb, p_result_array, p_result_idx, p_result_max, p_subindex_array, p_mask);
 		}
 	}
 }
 
 template <class T, bool use_pairs, class AL>
-void Octree<T, use_pairs, AL>::_cull_point(Octant *p_octant, const Vector3 &p_point, T **p_result_array, int *p_result_idx, int p_result_max, int *p_subindex_array, uint32_t p_mask) {
+void Octree<T, use_pairs, AL>::_cull_segment(uint32_t p_octant, const Vector3 &p_from, const Vector3 &p_to, T **p_result_array, int *p_result_idx, int p_result_max, int *p_subindex_array, uint32_t p_mask) {
 
 	if (*p_result_idx == p_result_max)
 		return; //pointless
 
-	if (!p_octant->elements.empty()) {
+	const Octant &o = octants[p_octant];
 
-		typename List<Element *, AL>::Element *I;
-		I = p_octant->elements.front();
-		for (; I; I = I->next()) {
+	for (uint32_t idx = o.first_element; idx != OCTREE_NO_INDEX; idx = elements[idx].next) {
 
-			Element *e = I->get();
+		const Element &e = elements[idx];
+		if (use_pairs && !(e.pairable_type & p_mask))
+			continue;
 
-			if (e->last_pass == pass || (use_pairs && !(e->pairable_type & p_mask)))
-				continue;
-			e->last_pass = pass;
+		if (e.aabb.intersects_segment(p_from, p_to)) {
 
-			if (e->aabb.has_point(p_point)) {
+			if (*p_result_idx < p_result_max) {
 
-				if (*p_result_idx < p_result_max) {
+				p_result_array[*p_result_idx] = e.userdata;
+				if (p_subindex_array)
+					p_subindex_array[*p_result_idx] = e.subindex;
+				(*p_result_idx)++;
 
-					p_result_array[*p_result_idx] = e->userdata;
-					if (p_subindex_array)
-						p_subindex_array[*p_result_idx] = e->subindex;
-					(*p_result_idx)++;
-
-				} else {
+			} else {
 
-					return; // pointless to continue
-				}
+				return; // pointless to continue
 			}
 		}
 	}
 
-	if (use_pairs && !p_octant->pairable_elements.empty()) {
+	for (int i = 0; i < 8; i++) {
 
-		typename List<Element *, AL>::Element *I;
-		I = p_octant->pairable_elements.front();
-		for (; I; I = I->next()) {
+		if (o.children[i] != OCTREE_NO_INDEX && octants[o.children[i]].aabb.intersects_segment(p_from, p_to)) {
+			_cull_segment(o.children[i], p_from, p_to, p_result_array, p_result_idx, p_result_max, p_subindex_array, p_mask);
+		}
+	}
+}
 
-			Element *e = I->get();
+template <class T, bool use_pairs, class AL>
+void Octree<T, use_pairs, AL>::_cull_point(uint32_t p_octant, const Vector3 &p_point, T **p_result_array, int *p_result_idx, int p_result_max, int *p_subindex_array, uint32_t p_mask) {
+
+	if (*p_result_idx == p_result_max)
+		return; //pointless
 
-			if (e->last_pass == pass || (use_pairs && !(e->pairable_type & p_mask)))
-				continue;
+	const Octant &o = octants[p_octant];
 
-			e->last_pass = pass;
+	for (uint32_t idx = o.first_element; idx != OCTREE_NO_INDEX; idx = elements[idx].next) {
 
-			if (e->aabb.has_point(p_point)) {
+		const Element &e = elements[idx];
+		if (use_pairs && !(e.pairable_type & p_mask))
+			continue;
 
-				if (*p_result_idx < p_result_max) {
+		if (e.aabb.has_point(p_point)) {
 
-					p_result_array[*p_result_idx] = e->userdata;
-					if (p_subindex_array)
-						p_subindex_array[*p_result_idx] = e->subindex;
+			if (*p_result_idx < p_result_max) {
 
-					(*p_result_idx)++;
+				p_result_array[*p_result_idx] = e.userdata;
+				if (p_subindex_array)
+					p_subindex_array[*p_result_idx] = e.subindex;
+				(*p_result_idx)++;
 
-				} else {
+			} else {
 
-					return; // pointless to continue
-				}
+				return; // pointless to continue
 			}
 		}
 	}
 
 	for (int i = 0; i < 8; i++) {
 
-		//could be optimized..
-		if (p_octant->children[i] && p_octant->children[i]->aabb.has_point(p_point)) {
-			_cull_point(p_octant->children[i], p_point, p_result_array, p_result_idx, p_result_max, p_subindex_array, p_mask);
+		if (o.children[i] != OCTREE_NO_INDEX && octants[o.children[i]].aabb.has_point(p_point)) {
+			_cull_point(o.children[i], p_point, p_result_array, p_result_idx, p_result_max, p_subindex_array, p_mask);
 		}
 	}
 }
@@ -1295,20 +1189,47 @@ void Octree<T, use_pairs, AL>::_cull_point(Octant *p_octant, const Vector3 &p_po
 template <class T, bool use_pairs, class AL>
 int Octree<T, use_pairs, AL>::cull_convex(const Vector<Plane> &p_convex, T **p_result_array, int p_result_max, uint32_t p_mask) {
 
-	if (!root)
+	if (root == OCTREE_NO_INDEX)
 		return 0;
 
+	int plane_count = p_convex.size();
+	int group_count = (plane_count + 3) / 4;
+
+	_CullPlaneGroup local_groups[OCTREE_CULL_PLANE_GROUPS];
+	_CullPlaneGroup *groups = group_count > OCTREE_CULL_PLANE_GROUPS ? memnew_arr(_CullPlaneGroup, group_count) : local_groups;
+
+	for (int i = 0; i < group_count * 4; i++) {
+
+		_CullPlaneGroup &g = groups[i / 4];
+		if (i < plane_count) {
+			const Plane &p = p_convex[i];
+			g.nx[i % 4] = p.normal.x;
+			g.ny[i % 4] = p.normal.y;
+			g.nz[i % 4] = p.normal.z;
+			g.d[i % 4] = p.d;
+		} else {
+			// padding, nothing is ever over it
+			g.nx[i % 4] = 0;
+			g.ny[i % 4] = 0;
+			g.nz[i % 4] = 0;
+			g.d[i % 4] = 0;
+		}
+	}
+
 	int result_count = 0;
-	pass++;
 	_CullConvexData cdata;
-	cdata.planes = &p_convex[0];
-	cdata.plane_count = p_convex.size();
+	cdata.groups = groups;
+	cdata.group_count = group_count;
 	cdata.result_array = p_result_array;
 	cdata.result_max = p_result_max;
 	cdata.result_idx = &result_count;
 	cdata.mask = p_mask;
 
-	_cull_convex(root, &cdata);
+	uint64_t plane_mask = plane_count >= 64 ? ~uint64_t(0) : (uint64_t(1) << plane_count) - 1;
+	_cull_convex(root, &cdata, plane_mask);
+
+	if (groups != local_groups)
+		memdelete_arr(groups);
 
 	return result_count;
 }
@@ -1316,11 +1237,10 @@ int Octree<T, use_pairs, AL>::cull_convex(const Vector<Plane> &p_convex, T **p_r
 template <class T, bool use_pairs, class AL>
 int Octree<T, use_pairs, AL>::cull_aabb(const AABB &p_aabb, T **p_result_array, int p_result_max, int *p_subindex_array, uint32_t p_mask) {
 
-	if (!root)
+	if (root == OCTREE_NO_INDEX || !octants[root].aabb.intersects_inclusive(p_aabb))
 		return 0;
 
 	int result_count = 0;
-	pass++;
 	_cull_aabb(root, p_aabb, p_result_array, &result_count, p_result_max, p_subindex_array, p_mask);
 
 	return result_count;
@@ -1329,11 +1249,10 @@ int Octree<T, use_pairs, AL>::cull_aabb(const AABB &p_aabb, T **p_result_array,
 template <class T, bool use_pairs, class AL>
 int Octree<T, use_pairs, AL>::cull_segment(const Vector3 &p_from, const Vector3 &p_to, T **p_result_array, int p_result_max, int *p_subindex_array, uint32_t p_mask) {
 
-	if (!root)
+	if (root == OCTREE_NO_INDEX || !octants[root].aabb.intersects_segment(p_from, p_to))
 		return 0;
 
 	int result_count = 0;
-	pass++;
 	_cull_segment(root, p_from, p_to, p_result_array, &result_count, p_result_max, p_subindex_array, p_mask);
 
 	return result_count;
@@ -1342,11 +1261,10 @@ int Octree<T, use_pairs, AL>::cull_segment(const Vector3 &p_from, const Vector3
 template <class T, bool use_pairs, class AL>
 int Octree<T, use_pairs, AL>::cull_point(const Vector3 &p_point, T **p_result_array, int p_result_max, int *p_subindex_array, uint32_t p_mask) {
 
-	if (!root)
+	if (root == OCTREE_NO_INDEX || !octants[root].aabb.has_point(p_point))
 		return 0;
 
 	int result_count = 0;
-	pass++;
 	_cull_point(root, p_point, p_result_array, &result_count, p_result_max, p_subindex_array, p_mask);
 
 	return result_count;
@@ -1368,10 +1286,9 @@ void Octree<T, use_pairs, AL>::set_unpair_callback(UnpairCallback p_callback, vo
 template <class T, bool use_pairs, class AL>
 Octree<T, use_pairs, AL>::Octree(real_t p_unit_size) {
 
-	last_element_id = 1;
 	pass = 1;
 	unit_size = p_unit_size;
-	root = NULL;
+	root = OCTREE_NO_INDEX;
 
 	octant_count = 0;
 	pair_count = 0;
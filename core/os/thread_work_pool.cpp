@@ -0,0 +1,132 @@
+/*************************************************************************/
+/*  thread_work_pool.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "thread_work_pool.h"
+
+#include "os/os.h"
+
+void ThreadWorkPool::_thread_function(void *p_thread_data) {
+
+	ThreadData *td = (ThreadData *)p_thread_data;
+
+	while (true) {
+
+		td->start->wait();
+		if (td->exit)
+			return;
+
+		td->work->work();
+		td->completed->post();
+	}
+}
+
+void ThreadWorkPool::init(int p_thread_count) {
+
+	ERR_FAIL_COND(threads != NULL);
+
+	if (p_thread_count <= 0)
+		p_thread_count = OS::get_singleton()->get_processor_count();
+
+	if (p_thread_count <= 1)
+		return;
+
+	threads = memnew_arr(ThreadData, p_thread_count - 1);
+
+	for (int i = 0; i < p_thread_count - 1; i++) {
+
+		threads[i].thread = NULL;
+		threads[i].start = NULL;
+		threads[i].completed = NULL;
+		threads[i].work = NULL;
+		threads[i].exit = false;
+	}
+
+	for (int i = 0; i < p_thread_count - 1; i++) {
+
+		ThreadData &td = threads[i];
+		td.start = Semaphore::create();
+		td.completed = Semaphore::create();
+
+		if (!td.start || !td.completed)
+			break; // no threading on this platform
+
+		td.thread = Thread::create(_thread_function, &td);
+		if (!td.thread)
+			break;
+
+		worker_count++;
+	}
+
+	// release whatever a failed creation left behind
+	for (int i = worker_count; i < p_thread_count - 1; i++) {
+
+		if (threads[i].start)
+			memdelete(threads[i].start);
+		if (threads[i].completed)
+			memdelete(threads[i].completed);
+	}
+}
+
+void ThreadWorkPool::finish() {
+
+	if (!threads)
+		return;
+
+	ERR_FAIL_COND(working != 0);
+
+	for (int i = 0; i < worker_count; i++) {
+		threads[i].exit = true;
+		threads[i].start->post();
+	}
+
+	for (int i = 0; i < worker_count; i++) {
+
+		Thread::wait_to_finish(threads[i].thread);
+		memdelete(threads[i].thread);
+		memdelete(threads[i].start);
+		memdelete(threads[i].completed);
+	}
+
+	memdelete_arr(threads);
+	threads = NULL;
+	worker_count = 0;
+}
+
+ThreadWorkPool::ThreadWorkPool() {
+
+	threads = NULL;
+	worker_count = 0;
+	working = 0;
+}
+
+ThreadWorkPool::~ThreadWorkPool() {
+
+	finish();
+}
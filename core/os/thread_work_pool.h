@@ -0,0 +1,139 @@
+/*************************************************************************/
+/*  thread_work_pool.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef THREAD_WORK_POOL_H
+#define THREAD_WORK_POOL_H
+
+#include "os/semaphore.h"
+#include "os/thread.h"
+#include "safe_refcount.h"
+
+/**
+ * Persistent pool of worker threads for data-parallel loops that run every frame, where
+ * thread_process_array() would pay for creating and joining threads on each call.
+ * The calling thread takes part in the work, so a pool of N threads keeps N - 1 workers.
+ */
+class ThreadWorkPool {
+
+	struct BaseWork {
+		uint32_t index;
+		uint32_t max_elements;
+
+		virtual void work() = 0;
+		virtual ~BaseWork() {}
+	};
+
+	template <class C, class M, class U>
+	struct Work : public BaseWork {
+
+		C *instance;
+		M method;
+		U userdata;
+
+		virtual void work() {
+
+			while (true) {
+				uint32_t work_index = atomic_increment(&this->index) - 1;
+				if (work_index >= this->max_elements)
+					break;
+				(instance->*method)(work_index, userdata);
+			}
+		}
+	};
+
+	struct ThreadData {
+		Thread *thread;
+		Semaphore *start;
+		Semaphore *completed;
+		BaseWork *work;
+		bool exit;
+	};
+
+	ThreadData *threads;
+	int worker_count;
+	uint32_t working; // claimed atomically by do_work()
+
+	static void _thread_function(void *p_thread_data);
+
+public:
+	/// Calls (p_instance->*p_method)(i, p_userdata) for every i in [0, p_elements), spread over the pool.
+	/// Returns when all elements are processed. Runs serially when the pool has no workers or is already busy.
+	/// Any thread may call it: a nested call from a work item, or a call made while another thread owns
+	/// the workers, runs all of its elements on the calling thread instead of waiting for the pool.
+	template <class C, class M, class U>
+	void do_work(uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
+
+		Work<C, M, U> w;
+		w.index = 0;
+		w.max_elements = p_elements;
+		w.instance = p_instance;
+		w.method = p_method;
+		w.userdata = p_userdata;
+
+		if (worker_count == 0 || p_elements < 2) {
+			w.work();
+			return;
+		}
+
+		if (atomic_increment(&working) != 1) {
+			// the workers belong to another do_work()
+			atomic_decrement(&working);
+			w.work();
+			return;
+		}
+
+		int wake = MIN(worker_count, (int)p_elements - 1);
+		for (int i = 0; i < wake; i++) {
+			threads[i].work = &w;
+			threads[i].start->post();
+		}
+
+		w.work();
+
+		for (int i = 0; i < wake; i++) {
+			threads[i].completed->wait();
+			threads[i].work = NULL;
+		}
+
+		atomic_decrement(&working);
+	}
+
+	/// Threads taking part in do_work(), including the caller.
+	int get_thread_count() const { return worker_count + 1; }
+
+	/// Starts the pool; p_thread_count includes the calling thread, and 0 or less uses one per processor.
+	void init(int p_thread_count = 0);
+	void finish();
+
+	ThreadWorkPool();
+	~ThreadWorkPool();
+};
+
+#endif // THREAD_WORK_POOL_H
@@ -304,4 +304,105 @@ public:
 	}
 };
 
+/**
+ * Stable LSD radix sort of items carrying an unsigned 64 bits key, one byte per pass.
+ * Passes where all keys share the same byte are skipped, so narrow keys only pay for the bytes they use.
+ */
+
+template <class T>
+class RadixSort {
+
+	enum {
+
+		INSERTION_SORT_THRESHOLD = 32
+	};
+
+public:
+	struct Item {
+		uint64_t key;
+		T value;
+	};
+
+	// maps the bits of a float so that unsigned order matches float order
+	static inline uint32_t float_key(float p_value) {
+
+		union {
+			float f;
+			uint32_t u;
+		} value;
+		value.f = p_value;
+		return (value.u & 0x80000000) ? ~value.u : (value.u | 0x80000000);
+	}
+
+	inline void insertion_sort(Item *p_items, int p_len) const {
+
+		for (int i = 1; i < p_len; i++) {
+
+			Item item = p_items[i];
+			int j = i;
+			while (j > 0 && item.key < p_items[j - 1].key) {
+				p_items[j] = p_items[j - 1];
+				j--;
+			}
+			p_items[j] = item;
+		}
+	}
+
+	// p_scratch must hold p_len items, the result is always left in p_items
+	inline void sort(Item *p_items, Item *p_scratch, int p_len) const {
+
+		if (p_len <= INSERTION_SORT_THRESHOLD) {
+			insertion_sort(p_items, p_len);
+			return;
+		}
+
+		uint32_t histograms[8][256];
+		for (int i = 0; i < 8; i++) {
+			for (int j = 0; j < 256; j++) {
+				histograms[i][j] = 0;
+			}
+		}
+
+		for (int i = 0; i < p_len; i++) {
+
+			uint64_t key = p_items[i].key;
+			for (int j = 0; j < 8; j++) {
+				histograms[j][(key >> (j * 8)) & 0xFF]++;
+			}
+		}
+
+		Item *src = p_items;
+		Item *dst = p_scratch;
+
+		for (int i = 0; i < 8; i++) {
+
+			int shift = i * 8;
+			uint32_t *histogram = histograms[i];
+
+			if (histogram[(src[0].key >> shift) & 0xFF] == (uint32_t)p_len) {
+				continue; //all keys share this byte
+			}
+
+			uint32_t offset = 0;
+			for (int j = 0; j < 256; j++) {
+				uint32_t count = histogram[j];
+				histogram[j] = offset;
+				offset += count;
+			}
+
+			for (int j = 0; j < p_len; j++) {
+				dst[histogram[(src[j].key >> shift) & 0xFF]++] = src[j];
+			}
+
+			SWAP(src, dst);
+		}
+
+		if (src != p_items) {
+			for (int i = 0; i < p_len; i++) {
+				p_items[i] = src[i];
+			}
+		}
+	}
+};
+
 #endif
@@ -416,6 +416,7 @@ public:
 	void multimesh_instance_set_transform(RID p_multimesh, int p_index, const Transform &p_transform) {}
 	void multimesh_instance_set_transform_2d(RID p_multimesh, int p_index, const Transform2D &p_transform) {}
 	void multimesh_instance_set_color(RID p_multimesh, int p_index, const Color &p_color) {}
+	void multimesh_set_instance_range(RID p_multimesh, int p_from, const PoolVector<float> &p_data) {}
 
 	RID multimesh_get_mesh(RID p_multimesh) const { return RID(); }
 
@@ -340,7 +340,7 @@ void RasterizerCanvasGLES3::_draw_polygon(const int *p_indices, int p_index_coun
 	//draw the triangles.
 	glDrawElements(GL_TRIANGLES, p_index_count, GL_UNSIGNED_INT, 0);
 
-	storage->frame.canvas_draw_commands++;
+	storage->info.render._2d_draw_call_count++;
 
 	glBindVertexArray(0);
 }
@@ -387,7 +387,7 @@ void RasterizerCanvasGLES3::_draw_generic(GLuint p_primitive, int p_vertex_count
 
 	glDrawArrays(p_primitive, 0, p_vertex_count);
 
-	storage->frame.canvas_draw_commands++;
+	storage->info.render._2d_draw_call_count++;
 
 	glBindVertexArray(0);
 }
@@ -447,7 +447,54 @@ void RasterizerCanvasGLES3::_draw_gui_primitive(int p_points, const Vector2 *p_v
 	glBindVertexArray(0);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-	storage->frame.canvas_draw_commands++;
+	storage->info.render._2d_draw_call_count++;
+}
+
+bool RasterizerCanvasGLES3::Batcher::_get_texture_info(const RID &p_texture, Size2 &r_size, bool &r_repeat) {
+
+	RasterizerStorageGLES3::Texture *texture = storage->texture_owner.getornull(p_texture);
+
+	if (!texture)
+		return false;
+
+	texture = texture->get_ptr();
+
+	r_size = Size2(texture->width, texture->height);
+	r_repeat = texture->flags & VS::TEXTURE_FLAG_REPEAT;
+	return true;
+}
+
+void RasterizerCanvasGLES3::_canvas_render_batch(const RasterizerCanvasBatcher::Batch &p_batch) {
+
+	//vertices are already in canvas space and modulated
+	_set_texture_rect_mode(false);
+
+	state.canvas_item_modulate = Color(1, 1, 1, 1);
+	state.final_transform = Transform2D();
+	state.extra_matrix = Transform2D();
+
+	state.canvas_shader.set_uniform(CanvasShaderGLES3::FINAL_MODULATE, state.canvas_item_modulate);
+	state.canvas_shader.set_uniform(CanvasShaderGLES3::MODELVIEW_MATRIX, state.final_transform);
+	state.canvas_shader.set_uniform(CanvasShaderGLES3::EXTRA_MATRIX, state.extra_matrix);
+
+	_bind_canvas_texture(p_batch.texture, RID());
+
+	glBindVertexArray(data.batch_vertex_array);
+	glBindBuffer(GL_ARRAY_BUFFER, data.batch_vertex_buffer);
+
+	uint8_t *ofs = ((uint8_t *)NULL) + p_batch.first_vertex * sizeof(RasterizerCanvasBatcher::Vertex);
+	int stride = sizeof(RasterizerCanvasBatcher::Vertex);
+
+	glVertexAttribPointer(VS::ARRAY_VERTEX, 2, GL_FLOAT, GL_FALSE, stride, ofs);
+	glVertexAttribPointer(VS::ARRAY_TEX_UV, 2, GL_FLOAT, GL_FALSE, stride, ofs + sizeof(float) * 2);
+	glVertexAttribPointer(VS::ARRAY_COLOR, 4, GL_FLOAT, GL_FALSE, stride, ofs + sizeof(float) * 4);
+
+	glDrawElements(GL_TRIANGLES, p_batch.index_count, GL_UNSIGNED_SHORT, ((uint8_t *)NULL) + p_batch.first_index * sizeof(uint16_t));
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	storage->info.render._2d_draw_call_count++;
 }
 
 void RasterizerCanvasGLES3::_canvas_item_render_commands(Item *p_item, Item *current_clip, bool &reclip) {
@@ -643,7 +690,7 @@ void RasterizerCanvasGLES3::_canvas_item_render_commands(Item *p_item, Item *cur
 					glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
 				}
 
-				storage->frame.canvas_draw_commands++;
+				storage->info.render._2d_draw_call_count++;
 
 			} break;
 
@@ -686,7 +733,7 @@ void RasterizerCanvasGLES3::_canvas_item_render_commands(Item *p_item, Item *cur
 
 				glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
 
-				storage->frame.canvas_draw_commands++;
+				storage->info.render._2d_draw_call_count++;
 			} break;
 
 			case Item::Command::TYPE_PRIMITIVE: {
@@ -1029,9 +1076,28 @@ void RasterizerCanvasGLES3::canvas_render_items(Item *p_item_list, int p_z, cons
 
 	bool prev_distance_field = false;
 
-	while (p_item_list) {
+	batcher.build(p_item_list, p_z, p_modulate, p_light);
+
+	if (batcher.get_vertex_count()) {
+
+		glBindVertexArray(data.batch_vertex_array);
+		glBindBuffer(GL_ARRAY_BUFFER, data.batch_vertex_buffer);
+		glBufferData(GL_ARRAY_BUFFER, batcher.get_vertex_count() * sizeof(RasterizerCanvasBatcher::Vertex), batcher.get_vertices(), GL_STREAM_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, data.batch_index_buffer);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, batcher.get_index_count() * sizeof(uint16_t), batcher.get_indices(), GL_STREAM_DRAW);
+		glBindVertexArray(state.using_texture_rect ? data.canvas_quad_array : 0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	const RasterizerCanvasBatcher::Batch *batches = batcher.get_batches();
+	int batch_count = batcher.get_batch_count();
 
-		Item *ci = p_item_list;
+	for (int i = 0; i < batch_count; i++) {
+
+		const RasterizerCanvasBatcher::Batch &batch = batches[i];
+		Item *ci = batch.item;
+
+		storage->info.render._2d_item_count += batch.item_count;
 
 		if (prev_distance_field != ci->distance_field) {
 
@@ -1219,6 +1285,12 @@ void RasterizerCanvasGLES3::canvas_render_items(Item *p_item_list, int p_z, cons
 			last_blend_mode = blend_mode;
 		}
 
+		if (batch.type == RasterizerCanvasBatcher::BATCH_GEOMETRY) {
+
+			_canvas_render_batch(batch);
+			continue;
+		}
+
 		state.canvas_item_modulate = unshaded ? ci->final_modulate : Color(ci->final_modulate.r * p_modulate.r, ci->final_modulate.g * p_modulate.g, ci->final_modulate.b * p_modulate.b, ci->final_modulate.a * p_modulate.a);
 
 		state.final_transform = ci->final_transform;
@@ -1378,8 +1450,6 @@ void RasterizerCanvasGLES3::canvas_render_items(Item *p_item_list, int p_z, cons
 			glEnable(GL_SCISSOR_TEST);
 			glScissor(current_clip->final_clip_rect.position.x, (rt_size.height - (current_clip->final_clip_rect.position.y + current_clip->final_clip_rect.size.height)), current_clip->final_clip_rect.size.width, current_clip->final_clip_rect.size.height);
 		}
-
-		p_item_list = p_item_list->next;
 	}
 
 	if (current_clip) {
@@ -1783,6 +1853,21 @@ void RasterizerCanvasGLES3::initialize() {
 
 		glGenVertexArrays(1, &data.polygon_buffer_pointer_array);
 
+		//batch buffers, refilled for every list of items drawn
+		glGenBuffers(1, &data.batch_vertex_buffer);
+		glGenBuffers(1, &data.batch_index_buffer);
+
+		glGenVertexArrays(1, &data.batch_vertex_array);
+		glBindVertexArray(data.batch_vertex_array);
+		glBindBuffer(GL_ARRAY_BUFFER, data.batch_vertex_buffer);
+		glEnableVertexAttribArray(VS::ARRAY_VERTEX);
+		glEnableVertexAttribArray(VS::ARRAY_TEX_UV);
+		glEnableVertexAttribArray(VS::ARRAY_COLOR);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, data.batch_index_buffer);
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
 		uint32_t index_size = GLOBAL_DEF("rendering/limits/buffers/canvas_polygon_index_buffer_size_kb", 128);
 		index_size *= 1024; //kb
 		glGenBuffers(1, &data.polygon_index_buffer);
@@ -1806,6 +1891,9 @@ void RasterizerCanvasGLES3::initialize() {
 	state.canvas_shadow_shader.set_conditional(CanvasShadowShaderGLES3::USE_RGBA_SHADOWS, storage->config.use_rgba_2d_shadows);
 
 	state.canvas_shader.set_conditional(CanvasShaderGLES3::USE_PIXEL_SNAP, GLOBAL_DEF("rendering/quality/2d/use_pixel_snap", false));
+
+	batcher.storage = storage;
+	batcher.set_enabled(GLOBAL_DEF("rendering/quality/2d/use_batching", true));
 }
 
 void RasterizerCanvasGLES3::finalize() {
@@ -1817,6 +1905,10 @@ void RasterizerCanvasGLES3::finalize() {
 	glDeleteVertexArrays(1, &data.canvas_quad_array);
 
 	glDeleteVertexArrays(1, &data.polygon_buffer_pointer_array);
+
+	glDeleteBuffers(1, &data.batch_vertex_buffer);
+	glDeleteBuffers(1, &data.batch_index_buffer);
+	glDeleteVertexArrays(1, &data.batch_vertex_array);
 }
 
 RasterizerCanvasGLES3::RasterizerCanvasGLES3() {
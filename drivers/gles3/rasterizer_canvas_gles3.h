@@ -33,6 +33,7 @@
 
 #include "rasterizer_storage_gles3.h"
 #include "servers/visual/rasterizer.h"
+#include "servers/visual/rasterizer_canvas_batcher.h"
 #include "shaders/canvas_shadow.glsl.gen.h"
 
 class RasterizerSceneGLES3;
@@ -61,6 +62,10 @@ public:
 		GLuint particle_quad_vertices;
 		GLuint particle_quad_array;
 
+		GLuint batch_vertex_buffer;
+		GLuint batch_index_buffer;
+		GLuint batch_vertex_array;
+
 		uint32_t polygon_buffer_size;
 
 	} data;
@@ -89,6 +94,13 @@ public:
 
 	RasterizerStorageGLES3 *storage;
 
+	struct Batcher : public RasterizerCanvasBatcher {
+
+		RasterizerStorageGLES3 *storage;
+
+		virtual bool _get_texture_info(const RID &p_texture, Size2 &r_size, bool &r_repeat);
+	} batcher;
+
 	struct LightInternal : public RID_Data {
 
 		struct UBOData {
@@ -127,6 +139,7 @@ public:
 	_FORCE_INLINE_ void _draw_generic(GLuint p_primitive, int p_vertex_count, const Vector2 *p_vertices, const Vector2 *p_uvs, const Color *p_colors, bool p_singlecolor);
 
 	_FORCE_INLINE_ void _canvas_item_render_commands(Item *p_item, Item *current_clip, bool &reclip);
+	_FORCE_INLINE_ void _canvas_render_batch(const RasterizerCanvasBatcher::Batch &p_batch);
 	_FORCE_INLINE_ void _copy_texscreen(const Rect2 &p_rect);
 
 	virtual void canvas_render_items(Item *p_item_list, int p_z, const Color &p_modulate, Light *p_light);
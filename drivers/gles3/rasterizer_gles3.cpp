@@ -187,6 +187,9 @@ void RasterizerGLES3::initialize() {
 
 	const GLubyte *renderer = glGetString(GL_RENDERER);
 	print_line("OpenGL ES 3.0 Renderer: " + String((const char *)renderer));
+
+	ShaderGLES3::init_cache(GLOBAL_GET("rendering/gles3/shader_cache/enabled"), GLOBAL_GET("rendering/gles3/shader_cache/warm_up_msec_per_frame"));
+
 	storage->initialize();
 	canvas->initialize();
 	scene->initialize();
@@ -227,6 +230,8 @@ void RasterizerGLES3::begin_frame() {
 	storage->info.render.reset();
 
 	scene->iteration();
+
+	ShaderGLES3::process_warm_up();
 }
 
 void RasterizerGLES3::set_current_render_target(RID p_render_target) {
@@ -392,6 +397,10 @@ void RasterizerGLES3::register_config() {
 	GLOBAL_DEF("rendering/quality/filters/anisotropic_filter_level", 4);
 	ProjectSettings::get_singleton()->set_custom_property_info("rendering/quality/filters/anisotropic_filter_level", PropertyInfo(Variant::INT, "rendering/quality/filters/anisotropic_filter_level", PROPERTY_HINT_RANGE, "1,16,1"));
 	GLOBAL_DEF("rendering/limits/time/time_rollover_secs", 3600);
+
+	GLOBAL_DEF("rendering/gles3/shader_cache/enabled", true);
+	GLOBAL_DEF("rendering/gles3/shader_cache/warm_up_msec_per_frame", 2);
+	ProjectSettings::get_singleton()->set_custom_property_info("rendering/gles3/shader_cache/warm_up_msec_per_frame", PropertyInfo(Variant::INT, "rendering/gles3/shader_cache/warm_up_msec_per_frame", PROPERTY_HINT_RANGE, "0,16,1"));
 }
 
 RasterizerGLES3::RasterizerGLES3() {
@@ -1476,6 +1476,16 @@ static const GLenum gl_primitive[] = {
 	GL_TRIANGLE_FAN
 };
 
+static _FORCE_INLINE_ uint32_t _get_triangle_count(VS::PrimitiveType p_primitive, int p_vertices, int p_instances) {
+
+	switch (p_primitive) {
+		case VS::PRIMITIVE_TRIANGLES: return p_vertices / 3 * p_instances;
+		case VS::PRIMITIVE_TRIANGLE_STRIP:
+		case VS::PRIMITIVE_TRIANGLE_FAN: return MAX(p_vertices - 2, 0) * p_instances;
+		default: return 0; //points and lines
+	}
+}
+
 void RasterizerSceneGLES3::_render_geometry(RenderList::Element *e) {
 
 	switch (e->instance->base_type) {
@@ -1497,12 +1507,14 @@ void RasterizerSceneGLES3::_render_geometry(RenderList::Element *e) {
 				glDrawElements(gl_primitive[s->primitive], s->index_array_len, (s->array_len >= (1 << 16)) ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT, 0);
 
 				storage->info.render.vertices_count += s->index_array_len;
+				storage->info.render.triangles_count += _get_triangle_count(s->primitive, s->index_array_len, 1);
 
 			} else {
 
 				glDrawArrays(gl_primitive[s->primitive], 0, s->array_len);
 
 				storage->info.render.vertices_count += s->array_len;
+				storage->info.render.triangles_count += _get_triangle_count(s->primitive, s->array_len, 1);
 			}
 
 		} break;
@@ -1526,12 +1538,14 @@ void RasterizerSceneGLES3::_render_geometry(RenderList::Element *e) {
 				glDrawElementsInstanced(gl_primitive[s->primitive], s->index_array_len, (s->array_len >= (1 << 16)) ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT, 0, amount);
 
 				storage->info.render.vertices_count += s->index_array_len * amount;
+				storage->info.render.triangles_count += _get_triangle_count(s->primitive, s->index_array_len, amount);
 
 			} else {
 
 				glDrawArraysInstanced(gl_primitive[s->primitive], 0, s->array_len, amount);
 
 				storage->info.render.vertices_count += s->array_len * amount;
+				storage->info.render.triangles_count += _get_triangle_count(s->primitive, s->array_len, amount);
 			}
 
 		} break;
@@ -1558,6 +1572,7 @@ void RasterizerSceneGLES3::_render_geometry(RenderList::Element *e) {
 				uint32_t buf_ofs = 0;
 
 				storage->info.render.vertices_count += vertices;
+				storage->info.render.triangles_count += _get_triangle_count(c.primitive, vertices, 1);
 
 				if (c.texture.is_valid() && storage->texture_owner.owns(c.texture)) {
 
@@ -1704,12 +1719,14 @@ void RasterizerSceneGLES3::_render_geometry(RenderList::Element *e) {
 						glDrawElementsInstanced(gl_primitive[s->primitive], s->index_array_len, (s->array_len >= (1 << 16)) ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT, 0, amount - split);
 
 						storage->info.render.vertices_count += s->index_array_len * (amount - split);
+						storage->info.render.triangles_count += _get_triangle_count(s->primitive, s->index_array_len, amount - split);
 
 					} else {
 
 						glDrawArraysInstanced(gl_primitive[s->primitive], 0, s->array_len, amount - split);
 
 						storage->info.render.vertices_count += s->array_len * (amount - split);
+						storage->info.render.triangles_count += _get_triangle_count(s->primitive, s->array_len, amount - split);
 					}
 				}
 
@@ -1742,12 +1759,14 @@ void RasterizerSceneGLES3::_render_geometry(RenderList::Element *e) {
 						glDrawElementsInstanced(gl_primitive[s->primitive], s->index_array_len, (s->array_len >= (1 << 16)) ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT, 0, split);
 
 						storage->info.render.vertices_count += s->index_array_len * split;
+						storage->info.render.triangles_count += _get_triangle_count(s->primitive, s->index_array_len, split);
 
 					} else {
 
 						glDrawArraysInstanced(gl_primitive[s->primitive], 0, s->array_len, split);
 
 						storage->info.render.vertices_count += s->array_len * split;
+						storage->info.render.triangles_count += _get_triangle_count(s->primitive, s->array_len, split);
 					}
 				}
 
@@ -1766,12 +1785,14 @@ void RasterizerSceneGLES3::_render_geometry(RenderList::Element *e) {
 					glDrawElementsInstanced(gl_primitive[s->primitive], s->index_array_len, (s->array_len >= (1 << 16)) ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT, 0, amount);
 
 					storage->info.render.vertices_count += s->index_array_len * amount;
+					storage->info.render.triangles_count += _get_triangle_count(s->primitive, s->index_array_len, amount);
 
 				} else {
 
 					glDrawArraysInstanced(gl_primitive[s->primitive], 0, s->array_len, amount);
 
 					storage->info.render.vertices_count += s->array_len * amount;
+					storage->info.render.triangles_count += _get_triangle_count(s->primitive, s->array_len, amount);
 				}
 			}
 
@@ -713,63 +713,66 @@ public:
 			alpha_element_count = 0;
 		}
 
-		//should eventually be replaced by radix
+		// sorting copies each element's key and pointer into a contiguous array, radix sorts it and writes the pointers back
 
-		struct SortByKey {
+		typedef RadixSort<Element *> ElementSort;
 
-			_FORCE_INLINE_ bool operator()(const Element *A, const Element *B) const {
-				return A->sort_key < B->sort_key;
-			}
-		};
+		ElementSort::Item *sort_items;
+		ElementSort::Item *sort_scratch;
 
-		void sort_by_key(bool p_alpha) {
+		_FORCE_INLINE_ Element **get_sort_range(bool p_alpha, int &r_count) {
 
-			SortArray<Element *, SortByKey> sorter;
 			if (p_alpha) {
-				sorter.sort(&elements[max_elements - alpha_element_count], alpha_element_count);
+				r_count = alpha_element_count;
+				return &elements[max_elements - alpha_element_count];
 			} else {
-				sorter.sort(elements, element_count);
+				r_count = element_count;
+				return elements;
 			}
 		}
 
-		struct SortByDepth {
+		void sort_items_and_apply(Element **p_elements, int p_count) {
 
-			_FORCE_INLINE_ bool operator()(const Element *A, const Element *B) const {
-				return A->instance->depth < B->instance->depth;
+			ElementSort sorter;
+			sorter.sort(sort_items, sort_scratch, p_count);
+			for (int i = 0; i < p_count; i++) {
+				p_elements[i] = sort_items[i].value;
 			}
-		};
+		}
 
-		void sort_by_depth(bool p_alpha) { //used for shadows
+		void sort_by_key(bool p_alpha) {
 
-			SortArray<Element *, SortByDepth> sorter;
-			if (p_alpha) {
-				sorter.sort(&elements[max_elements - alpha_element_count], alpha_element_count);
-			} else {
-				sorter.sort(elements, element_count);
+			int count;
+			Element **range = get_sort_range(p_alpha, count);
+			for (int i = 0; i < count; i++) {
+				sort_items[i].key = range[i]->sort_key;
+				sort_items[i].value = range[i];
 			}
+			sort_items_and_apply(range, count);
 		}
 
-		struct SortByReverseDepthAndPriority {
+		void sort_by_depth(bool p_alpha) { //used for shadows
 
-			_FORCE_INLINE_ bool operator()(const Element *A, const Element *B) const {
-				uint32_t layer_A = uint32_t(A->sort_key >> SORT_KEY_PRIORITY_SHIFT);
-				uint32_t layer_B = uint32_t(B->sort_key >> SORT_KEY_PRIORITY_SHIFT);
-				if (layer_A == layer_B) {
-					return A->instance->depth > B->instance->depth;
-				} else {
-					return layer_A < layer_B;
-				}
+			int count;
+			Element **range = get_sort_range(p_alpha, count);
+			for (int i = 0; i < count; i++) {
+				sort_items[i].key = ElementSort::float_key(range[i]->instance->depth);
+				sort_items[i].value = range[i];
 			}
-		};
+			sort_items_and_apply(range, count);
+		}
 
 		void sort_by_reverse_depth_and_priority(bool p_alpha) { //used for alpha
 
-			SortArray<Element *, SortByReverseDepthAndPriority> sorter;
-			if (p_alpha) {
-				sorter.sort(&elements[max_elements - alpha_element_count], alpha_element_count);
-			} else {
-				sorter.sort(elements, element_count);
+			int count;
+			Element **range = get_sort_range(p_alpha, count);
+			for (int i = 0; i < count; i++) {
+				//priority ascending, then depth descending
+				uint64_t priority = range[i]->sort_key >> SORT_KEY_PRIORITY_SHIFT;
+				sort_items[i].key = (priority << 32) | (0xFFFFFFFF - ElementSort::float_key(range[i]->instance->depth));
+				sort_items[i].value = range[i];
 			}
+			sort_items_and_apply(range, count);
 		}
 
 		_FORCE_INLINE_ Element *add_element() {
@@ -798,6 +801,8 @@ public:
 			base_elements = memnew_arr(Element, max_elements);
 			for (int i = 0; i < max_elements; i++)
 				elements[i] = &base_elements[i]; // assign elements
+			sort_items = memnew_arr(ElementSort::Item, max_elements);
+			sort_scratch = memnew_arr(ElementSort::Item, max_elements);
 		}
 
 		RenderList() {
@@ -808,6 +813,8 @@ public:
 		~RenderList() {
 			memdelete_arr(elements);
 			memdelete_arr(base_elements);
+			memdelete_arr(sort_items);
+			memdelete_arr(sort_scratch);
 		}
 	};
 
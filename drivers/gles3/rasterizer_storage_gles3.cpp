@@ -3882,6 +3882,8 @@ void RasterizerStorageGLES3::multimesh_allocate(RID p_multimesh, int p_instances
 	}
 
 	multimesh->dirty_data = true;
+	multimesh->dirty_from = 0;
+	multimesh->dirty_to = multimesh->size;
 	multimesh->dirty_aabb = true;
 
 	if (!multimesh->update_list.in_list()) {
@@ -3948,8 +3950,7 @@ void RasterizerStorageGLES3::multimesh_instance_set_transform(RID p_multimesh, i
 	dataptr[10] = p_transform.basis.elements[2][2];
 	dataptr[11] = p_transform.origin.z;
 
-	multimesh->dirty_data = true;
-	multimesh->dirty_aabb = true;
+	multimesh->set_dirty_range(p_index, p_index + 1);
 
 	if (!multimesh->update_list.in_list()) {
 		multimesh_update_list.add(&multimesh->update_list);
@@ -3975,8 +3976,7 @@ void RasterizerStorageGLES3::multimesh_instance_set_transform_2d(RID p_multimesh
 	dataptr[6] = 0;
 	dataptr[7] = p_transform.elements[2][1];
 
-	multimesh->dirty_data = true;
-	multimesh->dirty_aabb = true;
+	multimesh->set_dirty_range(p_index, p_index + 1);
 
 	if (!multimesh->update_list.in_list()) {
 		multimesh_update_list.add(&multimesh->update_list);
@@ -4007,8 +4007,32 @@ void RasterizerStorageGLES3::multimesh_instance_set_color(RID p_multimesh, int p
 		dataptr[3] = p_color.a;
 	}
 
-	multimesh->dirty_data = true;
-	multimesh->dirty_aabb = true;
+	multimesh->set_dirty_range(p_index, p_index + 1);
+
+	if (!multimesh->update_list.in_list()) {
+		multimesh_update_list.add(&multimesh->update_list);
+	}
+}
+
+void RasterizerStorageGLES3::multimesh_set_instance_range(RID p_multimesh, int p_from, const PoolVector<float> &p_data) {
+
+	MultiMesh *multimesh = multimesh_owner.getornull(p_multimesh);
+	ERR_FAIL_COND(!multimesh);
+
+	int stride = multimesh->color_floats + multimesh->xform_floats;
+	ERR_FAIL_COND(stride == 0);
+	ERR_FAIL_COND(p_data.size() % stride);
+
+	int count = p_data.size() / stride;
+	ERR_FAIL_COND(p_from < 0 || p_from + count > multimesh->size);
+
+	if (count == 0)
+		return;
+
+	PoolVector<float>::Read r = p_data.read();
+	copymem(&multimesh->data[stride * p_from], r.ptr(), p_data.size() * sizeof(float));
+
+	multimesh->set_dirty_range(p_from, p_from + count);
 
 	if (!multimesh->update_list.in_list()) {
 		multimesh_update_list.add(&multimesh->update_list);
@@ -4136,10 +4160,15 @@ void RasterizerStorageGLES3::update_dirty_multimeshes() {
 
 		MultiMesh *multimesh = multimesh_update_list.first()->self();
 
-		if (multimesh->size && multimesh->dirty_data) {
+		if (multimesh->size && multimesh->dirty_data && multimesh->dirty_from < multimesh->dirty_to) {
+
+			//only the instances changed since the last upload
+			int stride = multimesh->color_floats + multimesh->xform_floats;
+			int from = stride * multimesh->dirty_from;
+			int count = stride * (multimesh->dirty_to - multimesh->dirty_from);
 
 			glBindBuffer(GL_ARRAY_BUFFER, multimesh->buffer);
-			glBufferSubData(GL_ARRAY_BUFFER, 0, multimesh->data.size() * sizeof(float), multimesh->data.ptr());
+			glBufferSubData(GL_ARRAY_BUFFER, from * sizeof(float), count * sizeof(float), &multimesh->data.ptr()[from]);
 			glBindBuffer(GL_ARRAY_BUFFER, 0);
 		}
 
@@ -7083,6 +7112,7 @@ void RasterizerStorageGLES3::render_info_end_capture() {
 	info.snap.surface_switch_count = info.render.surface_switch_count - info.snap.surface_switch_count;
 	info.snap.shader_rebind_count = info.render.shader_rebind_count - info.snap.shader_rebind_count;
 	info.snap.vertices_count = info.render.vertices_count - info.snap.vertices_count;
+	info.snap.triangles_count = info.render.triangles_count - info.snap.triangles_count;
 }
 
 int RasterizerStorageGLES3::get_captured_render_info(VS::RenderInfo p_info) {
@@ -7096,6 +7126,10 @@ int RasterizerStorageGLES3::get_captured_render_info(VS::RenderInfo p_info) {
 
 			return info.snap.vertices_count;
 		} break;
+		case VS::INFO_TRIANGLES_IN_FRAME: {
+
+			return info.snap.triangles_count;
+		} break;
 		case VS::INFO_MATERIAL_CHANGES_IN_FRAME: {
 			return info.snap.material_switch_count;
 		} break;
@@ -7129,6 +7163,12 @@ int RasterizerStorageGLES3::get_render_info(VS::RenderInfo p_info) {
 			return info.render_final.surface_switch_count;
 		case VS::INFO_DRAW_CALLS_IN_FRAME:
 			return info.render_final.draw_call_count;
+		case VS::INFO_2D_ITEMS_IN_FRAME:
+			return info.render_final._2d_item_count;
+		case VS::INFO_2D_DRAW_CALLS_IN_FRAME:
+			return info.render_final._2d_draw_call_count;
+		case VS::INFO_TRIANGLES_IN_FRAME:
+			return info.render_final.triangles_count;
 		case VS::INFO_USAGE_VIDEO_MEM_TOTAL:
 			return 0; //no idea
 		case VS::INFO_VIDEO_MEM_USED:
@@ -7137,6 +7177,10 @@ int RasterizerStorageGLES3::get_render_info(VS::RenderInfo p_info) {
 			return info.texture_mem;
 		case VS::INFO_VERTEX_MEM_USED:
 			return info.vertex_mem;
+		case VS::INFO_SHADER_COMPILE_CACHE_HITS:
+			return shaders.compiler.get_cache_hits();
+		case VS::INFO_SHADER_COMPILE_CACHE_MISSES:
+			return shaders.compiler.get_cache_misses();
 		default:
 			return 0; //no idea either
 	}
@@ -148,6 +148,9 @@ public:
 			uint32_t surface_switch_count;
 			uint32_t shader_rebind_count;
 			uint32_t vertices_count;
+			uint32_t triangles_count;
+			uint32_t _2d_item_count;
+			uint32_t _2d_draw_call_count;
 
 			void reset() {
 				object_count = 0;
@@ -156,6 +159,9 @@ public:
 				surface_switch_count = 0;
 				shader_rebind_count = 0;
 				vertices_count = 0;
+				triangles_count = 0;
+				_2d_item_count = 0;
+				_2d_draw_call_count = 0;
 			}
 		} render, render_final, snap;
 
@@ -771,12 +777,29 @@ public:
 
 		bool dirty_aabb;
 		bool dirty_data;
+		int dirty_from; //instances to upload, the rest of the buffer is current
+		int dirty_to;
+
+		_FORCE_INLINE_ void set_dirty_range(int p_from, int p_to) {
+
+			if (dirty_data) {
+				dirty_from = MIN(dirty_from, p_from);
+				dirty_to = MAX(dirty_to, p_to);
+			} else {
+				dirty_from = p_from;
+				dirty_to = p_to;
+				dirty_data = true;
+			}
+			dirty_aabb = true;
+		}
 
 		MultiMesh() :
 				update_list(this),
 				mesh_list(this) {
 			dirty_aabb = true;
 			dirty_data = true;
+			dirty_from = 0;
+			dirty_to = 0;
 			xform_floats = 0;
 			color_floats = 0;
 			visible_instances = -1;
@@ -802,6 +825,7 @@ public:
 	virtual void multimesh_instance_set_transform(RID p_multimesh, int p_index, const Transform &p_transform);
 	virtual void multimesh_instance_set_transform_2d(RID p_multimesh, int p_index, const Transform2D &p_transform);
 	virtual void multimesh_instance_set_color(RID p_multimesh, int p_index, const Color &p_color);
+	virtual void multimesh_set_instance_range(RID p_multimesh, int p_from, const PoolVector<float> &p_data);
 
 	virtual RID multimesh_get_mesh(RID p_multimesh) const;
 
@@ -1415,7 +1439,6 @@ public:
 
 		bool clear_request;
 		Color clear_request_color;
-		int canvas_draw_commands;
 		float time[4];
 		float delta;
 		uint64_t prev_tick;
@@ -549,6 +549,7 @@ String ShaderCompilerGLES3::_dump_node_code(SL::Node *p_node, int p_level, Gener
 
 			if (p_assigning && p_actions.write_flag_pointers.has(vnode->name)) {
 				*p_actions.write_flag_pointers[vnode->name] = true;
+				used_write_flag_pointers.insert(vnode->name);
 			}
 
 			if (p_default_actions.usage_defines.has(vnode->name) && !used_name_defines.has(vnode->name)) {
@@ -721,8 +722,51 @@ String ShaderCompilerGLES3::_dump_node_code(SL::Node *p_node, int p_level, Gener
 	return code;
 }
 
+void ShaderCompilerGLES3::_apply_cached_code(const CachedCode &p_cached, IdentifierActions *p_actions, GeneratedCode &r_gen_code) {
+
+	r_gen_code = p_cached.gen_code;
+
+	for (const Map<StringName, SL::ShaderNode::Uniform>::Element *E = p_cached.uniforms.front(); E; E = E->next()) {
+		p_actions->uniforms->insert(E->key(), E->get());
+	}
+
+	//replay what code generation would have reported to the caller
+	for (int i = 0; i < p_cached.render_modes.size(); i++) {
+
+		if (p_actions->render_mode_flags.has(p_cached.render_modes[i])) {
+			*p_actions->render_mode_flags[p_cached.render_modes[i]] = true;
+		}
+
+		if (p_actions->render_mode_values.has(p_cached.render_modes[i])) {
+			Pair<int *, int> &p = p_actions->render_mode_values[p_cached.render_modes[i]];
+			*p.first = p.second;
+		}
+	}
+
+	for (const Set<StringName>::Element *E = p_cached.usage_flags.front(); E; E = E->next()) {
+		if (p_actions->usage_flag_pointers.has(E->get())) {
+			*p_actions->usage_flag_pointers[E->get()] = true;
+		}
+	}
+
+	for (const Set<StringName>::Element *E = p_cached.write_flags.front(); E; E = E->next()) {
+		if (p_actions->write_flag_pointers.has(E->get())) {
+			*p_actions->write_flag_pointers[E->get()] = true;
+		}
+	}
+}
+
 Error ShaderCompilerGLES3::compile(VS::ShaderMode p_mode, const String &p_code, IdentifierActions *p_actions, const String &p_path, GeneratedCode &r_gen_code) {
 
+	const CachedCode *cached = code_cache[p_mode].getptr(p_code);
+	if (cached) {
+		code_cache_hits++;
+		_apply_cached_code(*cached, p_actions, r_gen_code);
+		return OK;
+	}
+
+	code_cache_misses++;
+
 	Error err = parser.compile(p_code, ShaderTypes::get_singleton()->get_functions(p_mode), ShaderTypes::get_singleton()->get_modes(p_mode), ShaderTypes::get_singleton()->get_types());
 
 	if (err != OK) {
@@ -748,6 +792,7 @@ Error ShaderCompilerGLES3::compile(VS::ShaderMode p_mode, const String &p_code,
 	used_name_defines.clear();
 	used_rmode_defines.clear();
 	used_flag_pointers.clear();
+	used_write_flag_pointers.clear();
 
 	_dump_node_code(parser.get_shader(), 1, r_gen_code, *p_actions, actions[p_mode], false);
 
@@ -759,11 +804,35 @@ Error ShaderCompilerGLES3::compile(VS::ShaderMode p_mode, const String &p_code,
 		r_gen_code.uniform_total_size += md; //pad just in case
 	}
 
+	if (code_cache_size >= MAX_CACHED_CODE) {
+		clear_cache(); //shaders are rarely edited this much, just start over
+	}
+
+	CachedCode &cc = code_cache[p_mode][p_code];
+	cc.gen_code = r_gen_code;
+	cc.uniforms = parser.get_shader()->uniforms;
+	cc.render_modes = parser.get_shader()->render_modes;
+	cc.usage_flags = used_flag_pointers;
+	cc.write_flags = used_write_flag_pointers;
+	code_cache_size++;
+
 	return OK;
 }
 
+void ShaderCompilerGLES3::clear_cache() {
+
+	for (int i = 0; i < VS::SHADER_MAX; i++) {
+		code_cache[i].clear();
+	}
+	code_cache_size = 0;
+}
+
 ShaderCompilerGLES3::ShaderCompilerGLES3() {
 
+	code_cache_size = 0;
+	code_cache_hits = 0;
+	code_cache_misses = 0;
+
 	/** CANVAS ITEM SHADER **/
 
 	actions[VS::SHADER_CANVAS_ITEM].renames["VERTEX"] = "outvec.xy";
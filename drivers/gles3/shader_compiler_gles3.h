@@ -31,6 +31,7 @@
 #ifndef SHADERCOMPILERGLES3_H
 #define SHADERCOMPILERGLES3_H
 
+#include "hash_map.h"
 #include "pair.h"
 #include "servers/visual/shader_language.h"
 #include "servers/visual/shader_types.h"
@@ -88,14 +89,40 @@ private:
 
 	Set<StringName> used_name_defines;
 	Set<StringName> used_flag_pointers;
+	Set<StringName> used_write_flag_pointers;
 	Set<StringName> used_rmode_defines;
 	Set<StringName> internal_functions;
 
 	DefaultIdentifierActions actions[VS::SHADER_MAX];
 
+	//code generation only depends on the mode and the code, so materials with identical shaders reuse it
+	enum {
+		MAX_CACHED_CODE = 1024
+	};
+
+	struct CachedCode {
+
+		GeneratedCode gen_code;
+		Map<StringName, ShaderLanguage::ShaderNode::Uniform> uniforms;
+		Vector<StringName> render_modes;
+		Set<StringName> usage_flags;
+		Set<StringName> write_flags;
+	};
+
+	HashMap<String, CachedCode> code_cache[VS::SHADER_MAX];
+	int code_cache_size;
+	uint64_t code_cache_hits;
+	uint64_t code_cache_misses;
+
+	void _apply_cached_code(const CachedCode &p_cached, IdentifierActions *p_actions, GeneratedCode &r_gen_code);
+
 public:
 	Error compile(VS::ShaderMode p_mode, const String &p_code, IdentifierActions *p_actions, const String &p_path, GeneratedCode &r_gen_code);
 
+	void clear_cache();
+	uint64_t get_cache_hits() const { return code_cache_hits; }
+	uint64_t get_cache_misses() const { return code_cache_misses; }
+
 	ShaderCompilerGLES3();
 };
 
@@ -30,7 +30,11 @@
 
 #include "shader_gles3.h"
 
+#include "os/dir_access.h"
+#include "os/file_access.h"
+#include "os/os.h"
 #include "print_string.h"
+#include "thirdparty/misc/md5.h"
 
 //#define DEBUG_OPENGL
 
@@ -51,6 +55,17 @@
 
 ShaderGLES3 *ShaderGLES3::active = NULL;
 
+bool ShaderGLES3::cache_enabled = false;
+String ShaderGLES3::cache_driver;
+uint64_t ShaderGLES3::cache_warm_up_usec = 0;
+SelfList<ShaderGLES3>::List ShaderGLES3::cache_warm_up_list;
+SelfList<ShaderGLES3>::List ShaderGLES3::cache_record_list;
+uint64_t ShaderGLES3::cache_record_flush_tick = 0;
+
+#define SHADER_CACHE_MAGIC 0x42505347 //GSPB
+#define SHADER_CACHE_FORMAT_VERSION 1
+#define SHADER_CACHE_RECORD_FLUSH_USEC 5000000
+
 //#define DEBUG_SHADER
 
 #ifdef DEBUG_SHADER
@@ -235,6 +250,8 @@ ShaderGLES3::Version *ShaderGLES3::get_current_version() {
 	}
 
 	//keep them around during the function
+	CharString vertex_code_string;
+	CharString vertex_globals;
 	CharString code_string;
 	CharString code_string2;
 	CharString code_globals;
@@ -253,24 +270,20 @@ ShaderGLES3::Version *ShaderGLES3::get_current_version() {
 		define_line_ofs += 2;
 	}
 
-	/* CREATE PROGRAM */
-
-	v.id = glCreateProgram();
-
-	ERR_FAIL_COND_V(v.id == 0, NULL);
-
-	/* VERTEX SHADER */
-
 	if (cc) {
 		for (int i = 0; i < cc->custom_defines.size(); i++) {
 
 			strings.push_back(cc->custom_defines[i].get_data());
 			DEBUG_PRINT("CD #" + itos(i) + ": " + String(cc->custom_defines[i]));
 		}
+
+		material_string = cc->uniforms.ascii();
 	}
 
 	int strings_base_size = strings.size();
 
+	/* VERTEX SHADER CODE */
+
 	//vertex precision is high
 	strings.push_back("precision highp float;\n");
 	strings.push_back("precision highp int;\n");
@@ -283,80 +296,36 @@ ShaderGLES3::Version *ShaderGLES3::get_current_version() {
 	strings.push_back(vertex_code0.get_data());
 
 	if (cc) {
-		material_string = cc->uniforms.ascii();
 		strings.push_back(material_string.get_data());
 	}
 
 	strings.push_back(vertex_code1.get_data());
 
 	if (cc) {
-		code_globals = cc->vertex_globals.ascii();
-		strings.push_back(code_globals.get_data());
+		vertex_globals = cc->vertex_globals.ascii();
+		strings.push_back(vertex_globals.get_data());
 	}
 
 	strings.push_back(vertex_code2.get_data());
 
 	if (cc) {
-		code_string = cc->vertex.ascii();
-		strings.push_back(code_string.get_data());
+		vertex_code_string = cc->vertex.ascii();
+		strings.push_back(vertex_code_string.get_data());
 	}
 
 	strings.push_back(vertex_code3.get_data());
 #ifdef DEBUG_SHADER
 
-	DEBUG_PRINT("\nVertex Code:\n\n" + String(code_string.get_data()));
+	DEBUG_PRINT("\nVertex Code:\n\n" + String(vertex_code_string.get_data()));
 	for (int i = 0; i < strings.size(); i++) {
 
 		//print_line("vert strings "+itos(i)+":"+String(strings[i]));
 	}
 #endif
 
-	v.vert_id = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(v.vert_id, strings.size(), &strings[0], NULL);
-	glCompileShader(v.vert_id);
-
-	GLint status;
-
-	glGetShaderiv(v.vert_id, GL_COMPILE_STATUS, &status);
-	if (status == GL_FALSE) {
-		// error compiling
-		GLsizei iloglen;
-		glGetShaderiv(v.vert_id, GL_INFO_LOG_LENGTH, &iloglen);
-
-		if (iloglen < 0) {
-
-			glDeleteShader(v.vert_id);
-			glDeleteProgram(v.id);
-			v.id = 0;
-
-			ERR_PRINT("Vertex shader compilation failed with empty log");
-		} else {
-
-			if (iloglen == 0) {
-
-				iloglen = 4096; //buggy driver (Adreno 220+....)
-			}
-
-			char *ilogmem = (char *)memalloc(iloglen + 1);
-			ilogmem[iloglen] = 0;
-			glGetShaderInfoLog(v.vert_id, iloglen, &iloglen, ilogmem);
-
-			String err_string = get_shader_name() + ": Vertex Program Compilation Failed:\n";
-
-			err_string += ilogmem;
-			_display_error_with_code(err_string, strings);
-			memfree(ilogmem);
-			glDeleteShader(v.vert_id);
-			glDeleteProgram(v.id);
-			v.id = 0;
-		}
-
-		ERR_FAIL_V(NULL);
-	}
-
-	//_display_error_with_code("pepo", strings);
+	Vector<const char *> vertex_strings = strings;
 
-	/* FRAGMENT SHADER */
+	/* FRAGMENT SHADER CODE */
 
 	strings.resize(strings_base_size);
 	//fragment precision is medium
@@ -370,7 +339,6 @@ ShaderGLES3::Version *ShaderGLES3::get_current_version() {
 
 	strings.push_back(fragment_code0.get_data());
 	if (cc) {
-		material_string = cc->uniforms.ascii();
 		strings.push_back(material_string.get_data());
 	}
 
@@ -406,114 +374,188 @@ ShaderGLES3::Version *ShaderGLES3::get_current_version() {
 	}
 #endif
 
-	v.frag_id = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(v.frag_id, strings.size(), &strings[0], NULL);
-	glCompileShader(v.frag_id);
+	/* CREATE PROGRAM */
 
-	glGetShaderiv(v.frag_id, GL_COMPILE_STATUS, &status);
-	if (status == GL_FALSE) {
-		// error compiling
-		GLsizei iloglen;
-		glGetShaderiv(v.frag_id, GL_INFO_LOG_LENGTH, &iloglen);
+	v.id = glCreateProgram();
 
-		if (iloglen < 0) {
+	ERR_FAIL_COND_V(v.id == 0, NULL);
 
-			glDeleteShader(v.frag_id);
-			glDeleteShader(v.vert_id);
-			glDeleteProgram(v.id);
-			v.id = 0;
-			ERR_PRINT("Fragment shader compilation failed with empty log");
-		} else {
+	v.vert_id = 0;
+	v.frag_id = 0;
 
-			if (iloglen == 0) {
+	String cache_file;
+	if (cache_enabled) {
+		cache_file = _get_cache_file(vertex_strings, strings);
+	}
 
-				iloglen = 4096; //buggy driver (Adreno 220+....)
+	if (cache_file == String() || !_load_program_binary(v.id, cache_file)) {
+
+		/* VERTEX SHADER */
+
+		v.vert_id = glCreateShader(GL_VERTEX_SHADER);
+		glShaderSource(v.vert_id, vertex_strings.size(), &vertex_strings[0], NULL);
+		glCompileShader(v.vert_id);
+
+		GLint status;
+
+		glGetShaderiv(v.vert_id, GL_COMPILE_STATUS, &status);
+		if (status == GL_FALSE) {
+			// error compiling
+			GLsizei iloglen;
+			glGetShaderiv(v.vert_id, GL_INFO_LOG_LENGTH, &iloglen);
+
+			if (iloglen < 0) {
+
+				glDeleteShader(v.vert_id);
+				glDeleteProgram(v.id);
+				v.id = 0;
+
+				ERR_PRINT("Vertex shader compilation failed with empty log");
+			} else {
+
+				if (iloglen == 0) {
+
+					iloglen = 4096; //buggy driver (Adreno 220+....)
+				}
+
+				char *ilogmem = (char *)memalloc(iloglen + 1);
+				ilogmem[iloglen] = 0;
+				glGetShaderInfoLog(v.vert_id, iloglen, &iloglen, ilogmem);
+
+				String err_string = get_shader_name() + ": Vertex Program Compilation Failed:\n";
+
+				err_string += ilogmem;
+				_display_error_with_code(err_string, vertex_strings);
+				memfree(ilogmem);
+				glDeleteShader(v.vert_id);
+				glDeleteProgram(v.id);
+				v.id = 0;
 			}
 
-			char *ilogmem = (char *)memalloc(iloglen + 1);
-			ilogmem[iloglen] = 0;
-			glGetShaderInfoLog(v.frag_id, iloglen, &iloglen, ilogmem);
+			ERR_FAIL_V(NULL);
+		}
 
-			String err_string = get_shader_name() + ": Fragment Program Compilation Failed:\n";
+		//_display_error_with_code("pepo", strings);
 
-			err_string += ilogmem;
-			_display_error_with_code(err_string, strings);
-			ERR_PRINT(err_string.ascii().get_data());
-			memfree(ilogmem);
-			glDeleteShader(v.frag_id);
-			glDeleteShader(v.vert_id);
-			glDeleteProgram(v.id);
-			v.id = 0;
+		/* FRAGMENT SHADER */
+
+		v.frag_id = glCreateShader(GL_FRAGMENT_SHADER);
+		glShaderSource(v.frag_id, strings.size(), &strings[0], NULL);
+		glCompileShader(v.frag_id);
+
+		glGetShaderiv(v.frag_id, GL_COMPILE_STATUS, &status);
+		if (status == GL_FALSE) {
+			// error compiling
+			GLsizei iloglen;
+			glGetShaderiv(v.frag_id, GL_INFO_LOG_LENGTH, &iloglen);
+
+			if (iloglen < 0) {
+
+				glDeleteShader(v.frag_id);
+				glDeleteShader(v.vert_id);
+				glDeleteProgram(v.id);
+				v.id = 0;
+				ERR_PRINT("Fragment shader compilation failed with empty log");
+			} else {
+
+				if (iloglen == 0) {
+
+					iloglen = 4096; //buggy driver (Adreno 220+....)
+				}
+
+				char *ilogmem = (char *)memalloc(iloglen + 1);
+				ilogmem[iloglen] = 0;
+				glGetShaderInfoLog(v.frag_id, iloglen, &iloglen, ilogmem);
+
+				String err_string = get_shader_name() + ": Fragment Program Compilation Failed:\n";
+
+				err_string += ilogmem;
+				_display_error_with_code(err_string, strings);
+				ERR_PRINT(err_string.ascii().get_data());
+				memfree(ilogmem);
+				glDeleteShader(v.frag_id);
+				glDeleteShader(v.vert_id);
+				glDeleteProgram(v.id);
+				v.id = 0;
+			}
+
+			ERR_FAIL_V(NULL);
 		}
 
-		ERR_FAIL_V(NULL);
-	}
+		glAttachShader(v.id, v.frag_id);
+		glAttachShader(v.id, v.vert_id);
 
-	glAttachShader(v.id, v.frag_id);
-	glAttachShader(v.id, v.vert_id);
+		// bind attributes before linking
+		for (int i = 0; i < attribute_pair_count; i++) {
 
-	// bind attributes before linking
-	for (int i = 0; i < attribute_pair_count; i++) {
+			glBindAttribLocation(v.id, attribute_pairs[i].index, attribute_pairs[i].name);
+		}
 
-		glBindAttribLocation(v.id, attribute_pairs[i].index, attribute_pairs[i].name);
-	}
+		//if feedback exists, set it up
 
-	//if feedback exists, set it up
+		if (feedback_count) {
+			Vector<const char *> feedback;
+			for (int i = 0; i < feedback_count; i++) {
 
-	if (feedback_count) {
-		Vector<const char *> feedback;
-		for (int i = 0; i < feedback_count; i++) {
+				if (feedbacks[i].conditional == -1 || (1 << feedbacks[i].conditional) & conditional_version.version) {
+					//conditional for this feedback is enabled
+					feedback.push_back(feedbacks[i].name);
+				}
+			}
 
-			if (feedbacks[i].conditional == -1 || (1 << feedbacks[i].conditional) & conditional_version.version) {
-				//conditional for this feedback is enabled
-				feedback.push_back(feedbacks[i].name);
+			if (feedback.size()) {
+				glTransformFeedbackVaryings(v.id, feedback.size(), feedback.ptr(), GL_INTERLEAVED_ATTRIBS);
 			}
 		}
 
-		if (feedback.size()) {
-			glTransformFeedbackVaryings(v.id, feedback.size(), feedback.ptr(), GL_INTERLEAVED_ATTRIBS);
+		if (cache_file != String()) {
+			glProgramParameteri(v.id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 		}
-	}
 
-	glLinkProgram(v.id);
+		glLinkProgram(v.id);
+
+		glGetProgramiv(v.id, GL_LINK_STATUS, &status);
+
+		if (status == GL_FALSE) {
+			// error linking
+			GLsizei iloglen;
+			glGetProgramiv(v.id, GL_INFO_LOG_LENGTH, &iloglen);
 
-	glGetProgramiv(v.id, GL_LINK_STATUS, &status);
+			if (iloglen < 0) {
 
-	if (status == GL_FALSE) {
-		// error linking
-		GLsizei iloglen;
-		glGetProgramiv(v.id, GL_INFO_LOG_LENGTH, &iloglen);
+				glDeleteShader(v.frag_id);
+				glDeleteShader(v.vert_id);
+				glDeleteProgram(v.id);
+				v.id = 0;
+				ERR_FAIL_COND_V(iloglen <= 0, NULL);
+			}
 
-		if (iloglen < 0) {
+			if (iloglen == 0) {
 
+				iloglen = 4096; //buggy driver (Adreno 220+....)
+			}
+
+			char *ilogmem = (char *)Memory::alloc_static(iloglen + 1);
+			ilogmem[iloglen] = 0;
+			glGetProgramInfoLog(v.id, iloglen, &iloglen, ilogmem);
+
+			String err_string = get_shader_name() + ": Program LINK FAILED:\n";
+
+			err_string += ilogmem;
+			_display_error_with_code(err_string, strings);
+			ERR_PRINT(err_string.ascii().get_data());
+			Memory::free_static(ilogmem);
 			glDeleteShader(v.frag_id);
 			glDeleteShader(v.vert_id);
 			glDeleteProgram(v.id);
 			v.id = 0;
-			ERR_FAIL_COND_V(iloglen <= 0, NULL);
-		}
-
-		if (iloglen == 0) {
 
-			iloglen = 4096; //buggy driver (Adreno 220+....)
+			ERR_FAIL_V(NULL);
 		}
 
-		char *ilogmem = (char *)Memory::alloc_static(iloglen + 1);
-		ilogmem[iloglen] = 0;
-		glGetProgramInfoLog(v.id, iloglen, &iloglen, ilogmem);
-
-		String err_string = get_shader_name() + ": Program LINK FAILED:\n";
-
-		err_string += ilogmem;
-		_display_error_with_code(err_string, strings);
-		ERR_PRINT(err_string.ascii().get_data());
-		Memory::free_static(ilogmem);
-		glDeleteShader(v.frag_id);
-		glDeleteShader(v.vert_id);
-		glDeleteProgram(v.id);
-		v.id = 0;
-
-		ERR_FAIL_V(NULL);
+		if (cache_file != String()) {
+			_save_program_binary(v.id, cache_file);
+		}
 	}
 
 	/* UNIFORMS */
@@ -563,9 +605,273 @@ ShaderGLES3::Version *ShaderGLES3::get_current_version() {
 
 	v.ok = true;
 
+	if (cache_file != String()) {
+		_record_version(cc ? cc->hash : String("builtin"), conditional_version.version, cache_file);
+	}
+
 	return &v;
 }
 
+String ShaderGLES3::_get_cache_file(const Vector<const char *> &p_vertex_strings, const Vector<const char *> &p_fragment_strings) const {
+
+	if (cache_dir == String())
+		return String();
+
+	// the conditional and custom defines are part of the code
+	MD5_CTX ctx;
+	MD5Init(&ctx);
+	for (int i = 0; i < p_vertex_strings.size(); i++) {
+		MD5Update(&ctx, (unsigned char *)p_vertex_strings[i], strlen(p_vertex_strings[i]));
+	}
+	MD5Update(&ctx, (unsigned char *)"\0", 1);
+	for (int i = 0; i < p_fragment_strings.size(); i++) {
+		MD5Update(&ctx, (unsigned char *)p_fragment_strings[i], strlen(p_fragment_strings[i]));
+	}
+	MD5Final(&ctx);
+
+	return cache_dir + String::md5(ctx.digest) + ".bin";
+}
+
+bool ShaderGLES3::_load_program_binary(GLuint p_program, const String &p_file) {
+
+	FileAccess *f = FileAccess::open(p_file, FileAccess::READ);
+	if (!f)
+		return false;
+
+	bool loaded = false;
+
+	if (f->get_32() == SHADER_CACHE_MAGIC && f->get_32() == SHADER_CACHE_FORMAT_VERSION && f->get_pascal_string() == cache_driver) {
+
+		GLenum format = f->get_32();
+		uint32_t length = f->get_32();
+
+		if (length > 0 && length == f->get_len() - f->get_position()) {
+
+			Vector<uint8_t> binary;
+			binary.resize(length);
+
+			if (f->get_buffer(binary.ptrw(), length) == (int)length) {
+
+				glProgramBinary(p_program, format, binary.ptr(), length);
+
+				//the driver may still reject it, after an update for example
+				GLint status;
+				glGetProgramiv(p_program, GL_LINK_STATUS, &status);
+				loaded = status == GL_TRUE;
+			}
+		}
+	}
+
+	memdelete(f);
+
+	if (!loaded && OS::get_singleton()->is_stdout_verbose()) {
+		print_line(get_shader_name() + ": cached program rejected, compiling: " + p_file);
+	}
+
+	return loaded;
+}
+
+void ShaderGLES3::_save_program_binary(GLuint p_program, const String &p_file) {
+
+	GLint length = 0;
+	glGetProgramiv(p_program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+		return;
+
+	Vector<uint8_t> binary;
+	binary.resize(length);
+
+	GLenum format = 0;
+	GLsizei written = 0;
+	glGetProgramBinary(p_program, length, &written, &format, binary.ptrw());
+	if (written <= 0)
+		return;
+
+	FileAccess *f = FileAccess::open(p_file, FileAccess::WRITE);
+	ERR_FAIL_COND(!f);
+
+	f->store_32(SHADER_CACHE_MAGIC);
+	f->store_32(SHADER_CACHE_FORMAT_VERSION);
+	f->store_pascal_string(cache_driver);
+	f->store_32(format);
+	f->store_32(written);
+	f->store_buffer(binary.ptr(), written);
+
+	memdelete(f);
+}
+
+bool ShaderGLES3::_check_program_binary(const String &p_file) const {
+
+	FileAccess *f = FileAccess::open(p_file, FileAccess::READ);
+	if (!f)
+		return false;
+
+	bool valid = f->get_32() == SHADER_CACHE_MAGIC && f->get_32() == SHADER_CACHE_FORMAT_VERSION && f->get_pascal_string() == cache_driver;
+
+	memdelete(f);
+
+	return valid;
+}
+
+void ShaderGLES3::_record_version(const String &p_code_hash, uint32_t p_version, const String &p_cache_file) {
+
+	if (cache_dir == String() || p_code_hash == String())
+		return;
+
+	Set<uint32_t> &versions = cache_versions[p_code_hash];
+	if (versions.has(p_version))
+		return;
+
+	versions.insert(p_version);
+
+	//written later, file access here would stall the frame
+	cache_pending_records.push_back(p_code_hash + " " + itos(p_version) + " " + p_cache_file.get_file());
+	if (!record_item.in_list()) {
+		cache_record_list.add(&record_item);
+	}
+}
+
+void ShaderGLES3::_flush_records() {
+
+	if (record_item.in_list()) {
+		cache_record_list.remove(&record_item);
+	}
+
+	if (cache_pending_records.empty())
+		return;
+
+	String path = cache_dir + "versions.txt";
+	FileAccess *f = FileAccess::open(path, FileAccess::READ_WRITE);
+	if (!f) {
+		f = FileAccess::open(path, FileAccess::WRITE);
+	}
+
+	if (f) {
+
+		f->seek_end();
+		for (int i = 0; i < cache_pending_records.size(); i++) {
+			f->store_line(cache_pending_records[i]);
+		}
+		memdelete(f);
+	} else {
+		ERR_PRINTS("Can't write shader cache versions: " + path);
+	}
+
+	cache_pending_records.clear();
+}
+
+void ShaderGLES3::_queue_warm_up(const String &p_code_hash, uint32_t p_code_id) {
+
+	if (cache_warm_up_usec == 0)
+		return;
+
+	const Map<String, Set<uint32_t> >::Element *E = cache_versions.find(p_code_hash);
+	if (!E)
+		return;
+
+	uint32_t code_version = 0;
+	if (p_code_id) {
+		ERR_FAIL_COND(!custom_code_map.has(p_code_id));
+		code_version = custom_code_map[p_code_id].version;
+	}
+
+	for (Set<uint32_t>::Element *F = E->get().front(); F; F = F->next()) {
+
+		WarmUp w;
+		w.key.version = F->get();
+		w.key.code_version = p_code_id;
+		w.code_version = code_version;
+		warm_up_queue.push_back(w);
+	}
+
+	if (warm_up_queue.size() && !warm_up_item.in_list()) {
+		cache_warm_up_list.add(&warm_up_item);
+	}
+}
+
+bool ShaderGLES3::_warm_up_next() {
+
+	if (warm_up_queue.empty())
+		return false;
+
+	WarmUp w = warm_up_queue[warm_up_queue.size() - 1];
+	warm_up_queue.resize(warm_up_queue.size() - 1);
+
+	if (w.key.code_version) {
+		CustomCode *cc = custom_code_map.getptr(w.key.code_version);
+		if (!cc || cc->version != w.code_version)
+			return !warm_up_queue.empty(); //changed or freed since
+	}
+
+	Version *v = version_map.getptr(w.key);
+	if (!v || (w.key.code_version && v->code_version != w.code_version)) {
+
+		VersionKey prev_version = conditional_version;
+		conditional_version = w.key;
+		get_current_version();
+		conditional_version = prev_version;
+	}
+
+	return !warm_up_queue.empty();
+}
+
+void ShaderGLES3::init_cache(bool p_enabled, int p_warm_up_msec) {
+
+	cache_enabled = false;
+
+	if (!p_enabled)
+		return;
+
+#ifdef GLAD_ENABLED
+	if (!GLAD_GL_ARB_get_program_binary)
+		return;
+#endif
+
+	//some drivers support the calls, but no format to store programs in
+	GLint formats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	if (formats <= 0)
+		return;
+
+	cache_driver = String((const char *)glGetString(GL_VENDOR)) + " " + String((const char *)glGetString(GL_RENDERER)) + " " + String((const char *)glGetString(GL_VERSION));
+	cache_warm_up_usec = MAX(p_warm_up_msec, 0) * 1000;
+	cache_enabled = true;
+}
+
+void ShaderGLES3::process_warm_up() {
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+
+	if (!cache_warm_up_list.first()) {
+
+		//idle, append what was compiled since the last flush
+		if (cache_record_list.first() && from - cache_record_flush_tick >= SHADER_CACHE_RECORD_FLUSH_USEC) {
+
+			while (cache_record_list.first()) {
+				cache_record_list.first()->self()->_flush_records();
+			}
+			cache_record_flush_tick = from;
+		}
+		return;
+	}
+
+	while (cache_warm_up_list.first()) {
+
+		ShaderGLES3 *shader = cache_warm_up_list.first()->self();
+		if (!shader->_warm_up_next()) {
+			cache_warm_up_list.remove(&shader->warm_up_item);
+		}
+
+		if (OS::get_singleton()->get_ticks_usec() - from >= cache_warm_up_usec)
+			break;
+	}
+
+	//programs were switched behind the back of the bound shader
+	if (active) {
+		active->unbind();
+	}
+}
+
 GLint ShaderGLES3::get_uniform_location(const String &p_name) const {
 
 	ERR_FAIL_COND_V(!version, -1);
@@ -678,10 +984,74 @@ void ShaderGLES3::setup(const char **p_conditional_defines, int p_conditional_co
 	}
 
 	glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &max_image_units);
+
+	if (cache_enabled) {
+
+		cache_dir = "user://shader_cache/" + get_shader_name() + "/";
+
+		DirAccess *da = DirAccess::create(DirAccess::ACCESS_USERDATA);
+		Error err = da->make_dir_recursive(cache_dir);
+		memdelete(da);
+
+		if (err != OK) {
+			ERR_PRINTS("Can't create shader cache directory: " + cache_dir);
+			cache_dir = String();
+			return;
+		}
+
+		String path = cache_dir + "versions.txt";
+		Vector<String> valid_lines;
+		bool pruned = false;
+
+		FileAccess *f = FileAccess::open(path, FileAccess::READ);
+		if (f) {
+
+			while (!f->eof_reached()) {
+
+				String l = f->get_line();
+				if (l == String())
+					continue;
+
+				//drop versions whose program is gone or was linked by another driver
+				Vector<String> line = l.split(" ");
+				if (line.size() != 3 || !_check_program_binary(cache_dir + line[2])) {
+					pruned = true;
+					continue;
+				}
+
+				Set<uint32_t> &versions = cache_versions[line[0]];
+				uint32_t version = line[1].to_int64();
+				if (versions.has(version)) {
+					pruned = true;
+					continue;
+				}
+
+				versions.insert(version);
+				valid_lines.push_back(l);
+			}
+
+			memdelete(f);
+		}
+
+		if (pruned) {
+
+			f = FileAccess::open(path, FileAccess::WRITE);
+			if (f) {
+				for (int i = 0; i < valid_lines.size(); i++) {
+					f->store_line(valid_lines[i]);
+				}
+				memdelete(f);
+			}
+		}
+
+		_queue_warm_up("builtin", 0);
+	}
 }
 
 void ShaderGLES3::finish() {
 
+	_flush_records();
+
 	const VersionKey *V = NULL;
 	while ((V = version_map.next(V))) {
 
@@ -708,6 +1078,10 @@ void ShaderGLES3::clear_caches() {
 	version_map.clear();
 
 	custom_code_map.clear();
+	warm_up_queue.clear();
+	if (warm_up_item.in_list()) {
+		cache_warm_up_list.remove(&warm_up_item);
+	}
 	version = NULL;
 	last_custom_code = 1;
 	uniforms_dirty = true;
@@ -734,6 +1108,17 @@ void ShaderGLES3::set_custom_shader_code(uint32_t p_code_id, const String &p_ver
 	cc->uniforms = p_uniforms;
 	cc->custom_defines = p_custom_defines;
 	cc->version++;
+
+	if (cache_dir != String()) {
+
+		String code = p_vertex + "\n" + p_vertex_globals + "\n" + p_fragment + "\n" + p_fragment_globals + "\n" + p_light + "\n" + p_uniforms;
+		for (int i = 0; i < p_custom_defines.size(); i++) {
+			code += "\n" + String(p_custom_defines[i].get_data());
+		}
+
+		cc->hash = code.md5_text();
+		_queue_warm_up(cc->hash, p_code_id);
+	}
 }
 
 void ShaderGLES3::set_custom_shader(uint32_t p_code_id) {
@@ -762,7 +1147,9 @@ void ShaderGLES3::set_base_material_tex_index(int p_idx) {
 	base_material_tex_index = p_idx;
 }
 
-ShaderGLES3::ShaderGLES3() {
+ShaderGLES3::ShaderGLES3() :
+		warm_up_item(this),
+		record_item(this) {
 	version = NULL;
 	last_custom_code = 1;
 	uniforms_dirty = true;
@@ -43,6 +43,8 @@
 #include "camera_matrix.h"
 #include "hash_map.h"
 #include "map.h"
+#include "self_list.h"
+#include "set.h"
 #include "variant.h"
 
 /**
@@ -117,6 +119,7 @@ private:
 		uint32_t version;
 		Vector<StringName> texture_uniforms;
 		Vector<CharString> custom_defines;
+		String hash; //of the code, to find the versions recorded for it in the shader cache
 	};
 
 	struct Version {
@@ -191,6 +194,41 @@ private:
 
 	static ShaderGLES3 *active;
 
+	/* PROGRAM BINARY CACHE */
+
+	// linked programs are stored under the user data directory and reloaded on the next run,
+	// the versions used for each code are recorded so they can be loaded again a few per frame,
+	// new records are kept in memory and appended once warm up is idle or the shader is finished
+
+	struct WarmUp {
+
+		VersionKey key;
+		uint32_t code_version; //of the custom code when queued, skipped if it changed since
+	};
+
+	static bool cache_enabled;
+	static String cache_driver;
+	static uint64_t cache_warm_up_usec;
+	static SelfList<ShaderGLES3>::List cache_warm_up_list;
+	static SelfList<ShaderGLES3>::List cache_record_list;
+	static uint64_t cache_record_flush_tick;
+
+	String cache_dir;
+	Map<String, Set<uint32_t> > cache_versions;
+	Vector<WarmUp> warm_up_queue;
+	SelfList<ShaderGLES3> warm_up_item;
+	Vector<String> cache_pending_records;
+	SelfList<ShaderGLES3> record_item;
+
+	String _get_cache_file(const Vector<const char *> &p_vertex_strings, const Vector<const char *> &p_fragment_strings) const;
+	bool _load_program_binary(GLuint p_program, const String &p_file);
+	void _save_program_binary(GLuint p_program, const String &p_file);
+	bool _check_program_binary(const String &p_file) const;
+	void _record_version(const String &p_code_hash, uint32_t p_version, const String &p_cache_file);
+	void _flush_records();
+	void _queue_warm_up(const String &p_code_hash, uint32_t p_code_id);
+	bool _warm_up_next();
+
 	int max_image_units;
 
 	_FORCE_INLINE_ void _set_uniform_variant(GLint p_uniform, const Variant &p_value) {
@@ -310,6 +348,9 @@ public:
 	GLint get_uniform_location(int p_index) const;
 
 	static _FORCE_INLINE_ ShaderGLES3 *get_active() { return active; };
+
+	static void init_cache(bool p_enabled, int p_warm_up_msec);
+	static void process_warm_up();
 	bool bind();
 	void unbind();
 	void bind_uniforms();
@@ -52,6 +52,7 @@
 #include "servers/audio_server.h"
 #include "servers/physics_2d_server.h"
 #include "servers/physics_server.h"
+#include "servers/physics_work_pool.h"
 
 #include "io/resource_loader.h"
 #include "script_language.h"
@@ -139,6 +140,9 @@ bool Main::is_project_manager() {
 
 void initialize_physics() {
 
+	// the servers share a worker pool, and may init it from their own threads
+	PhysicsWorkPool::initialize();
+
 	/// 3D Physics Server
 	physics_server = PhysicsServerManager::new_server(ProjectSettings::get_singleton()->get(PhysicsServerManager::setting_property_name));
 	if (!physics_server) {
@@ -164,6 +168,8 @@ void finalize_physics() {
 
 	physics_2d_server->finish();
 	memdelete(physics_2d_server);
+
+	PhysicsWorkPool::finalize();
 }
 
 static String unescape_cmdline(const String &p_str) {
@@ -1785,6 +1791,7 @@ bool Main::iteration() {
 
 		message_queue->flush();
 
+		PhysicsServer::get_singleton()->end_sync();
 		PhysicsServer::get_singleton()->step(frame_slice * time_scale);
 
 		Physics2DServer::get_singleton()->end_sync();
@@ -68,6 +68,33 @@ void Performance::_bind_methods() {
 	BIND_ENUM_CONSTANT(PHYSICS_3D_ACTIVE_OBJECTS);
 	BIND_ENUM_CONSTANT(PHYSICS_3D_COLLISION_PAIRS);
 	BIND_ENUM_CONSTANT(PHYSICS_3D_ISLAND_COUNT);
+	BIND_ENUM_CONSTANT(PHYSICS_2D_STEP_TIME);
+	BIND_ENUM_CONSTANT(PHYSICS_2D_BROAD_PHASE_TIME);
+	BIND_ENUM_CONSTANT(PHYSICS_2D_ISLAND_TIME);
+	BIND_ENUM_CONSTANT(PHYSICS_2D_NARROW_PHASE_TIME);
+	BIND_ENUM_CONSTANT(PHYSICS_2D_SOLVER_TIME);
+	BIND_ENUM_CONSTANT(PHYSICS_2D_INTEGRATION_TIME);
+	BIND_ENUM_CONSTANT(PHYSICS_2D_AREA_QUERY_TIME);
+	BIND_ENUM_CONSTANT(PHYSICS_2D_PAIRS_TESTED);
+	BIND_ENUM_CONSTANT(PHYSICS_2D_CONTACT_COUNT);
+	BIND_ENUM_CONSTANT(PHYSICS_2D_CCD_SWEEPS);
+	BIND_ENUM_CONSTANT(PHYSICS_3D_STEP_TIME);
+	BIND_ENUM_CONSTANT(PHYSICS_3D_BROAD_PHASE_TIME);
+	BIND_ENUM_CONSTANT(PHYSICS_3D_ISLAND_TIME);
+	BIND_ENUM_CONSTANT(PHYSICS_3D_NARROW_PHASE_TIME);
+	BIND_ENUM_CONSTANT(PHYSICS_3D_SOLVER_TIME);
+	BIND_ENUM_CONSTANT(PHYSICS_3D_INTEGRATION_TIME);
+	BIND_ENUM_CONSTANT(PHYSICS_3D_AREA_QUERY_TIME);
+	BIND_ENUM_CONSTANT(PHYSICS_3D_PAIRS_TESTED);
+	BIND_ENUM_CONSTANT(PHYSICS_3D_CONTACT_COUNT);
+	BIND_ENUM_CONSTANT(PHYSICS_3D_CCD_SWEEPS);
+	BIND_ENUM_CONSTANT(RENDER_2D_ITEMS_IN_FRAME);
+	BIND_ENUM_CONSTANT(RENDER_2D_DRAW_CALLS_IN_FRAME);
+	BIND_ENUM_CONSTANT(RENDER_TRIANGLES_IN_FRAME);
+	BIND_ENUM_CONSTANT(RENDER_OCCLUDED_OBJECTS_IN_FRAME);
+	BIND_ENUM_CONSTANT(RENDER_DIRTY_INSTANCES_IN_FRAME);
+	BIND_ENUM_CONSTANT(RENDER_SHADER_COMPILE_CACHE_HITS);
+	BIND_ENUM_CONSTANT(RENDER_SHADER_COMPILE_CACHE_MISSES);
 
 	BIND_ENUM_CONSTANT(MONITOR_MAX);
 }
@@ -104,6 +131,33 @@ String Performance::get_monitor_name(Monitor p_monitor) const {
 		"physics_3d/active_objects",
 		"physics_3d/collision_pairs",
 		"physics_3d/islands",
+		"physics_2d/step_time",
+		"physics_2d/broad_phase_time",
+		"physics_2d/island_time",
+		"physics_2d/narrow_phase_time",
+		"physics_2d/solver_time",
+		"physics_2d/integration_time",
+		"physics_2d/area_query_time",
+		"physics_2d/pairs_tested",
+		"physics_2d/contacts",
+		"physics_2d/ccd_sweeps",
+		"physics_3d/step_time",
+		"physics_3d/broad_phase_time",
+		"physics_3d/island_time",
+		"physics_3d/narrow_phase_time",
+		"physics_3d/solver_time",
+		"physics_3d/integration_time",
+		"physics_3d/area_query_time",
+		"physics_3d/pairs_tested",
+		"physics_3d/contacts",
+		"physics_3d/ccd_sweeps",
+		"raster/2d_items_drawn",
+		"raster/2d_draw_calls",
+		"raster/triangles_drawn",
+		"raster/objects_occluded",
+		"raster/dirty_instances",
+		"raster/shader_cache_hits",
+		"raster/shader_cache_misses",
 
 	};
 
@@ -147,6 +201,33 @@ float Performance::get_monitor(Monitor p_monitor) const {
 		case PHYSICS_3D_ACTIVE_OBJECTS: return PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_ACTIVE_OBJECTS);
 		case PHYSICS_3D_COLLISION_PAIRS: return PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_COLLISION_PAIRS);
 		case PHYSICS_3D_ISLAND_COUNT: return PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_ISLAND_COUNT);
+		case PHYSICS_2D_STEP_TIME: return USEC_TO_SEC(Physics2DServer::get_singleton()->get_process_info(Physics2DServer::INFO_STEP_TIME));
+		case PHYSICS_2D_BROAD_PHASE_TIME: return USEC_TO_SEC(Physics2DServer::get_singleton()->get_process_info(Physics2DServer::INFO_BROAD_PHASE_TIME));
+		case PHYSICS_2D_ISLAND_TIME: return USEC_TO_SEC(Physics2DServer::get_singleton()->get_process_info(Physics2DServer::INFO_ISLAND_TIME));
+		case PHYSICS_2D_NARROW_PHASE_TIME: return USEC_TO_SEC(Physics2DServer::get_singleton()->get_process_info(Physics2DServer::INFO_NARROW_PHASE_TIME));
+		case PHYSICS_2D_SOLVER_TIME: return USEC_TO_SEC(Physics2DServer::get_singleton()->get_process_info(Physics2DServer::INFO_SOLVER_TIME));
+		case PHYSICS_2D_INTEGRATION_TIME: return USEC_TO_SEC(Physics2DServer::get_singleton()->get_process_info(Physics2DServer::INFO_INTEGRATION_TIME));
+		case PHYSICS_2D_AREA_QUERY_TIME: return USEC_TO_SEC(Physics2DServer::get_singleton()->get_process_info(Physics2DServer::INFO_AREA_QUERY_TIME));
+		case PHYSICS_2D_PAIRS_TESTED: return Physics2DServer::get_singleton()->get_process_info(Physics2DServer::INFO_PAIRS_TESTED);
+		case PHYSICS_2D_CONTACT_COUNT: return Physics2DServer::get_singleton()->get_process_info(Physics2DServer::INFO_CONTACT_COUNT);
+		case PHYSICS_2D_CCD_SWEEPS: return Physics2DServer::get_singleton()->get_process_info(Physics2DServer::INFO_CCD_SWEEPS);
+		case PHYSICS_3D_STEP_TIME: return USEC_TO_SEC(PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_STEP_TIME));
+		case PHYSICS_3D_BROAD_PHASE_TIME: return USEC_TO_SEC(PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_BROAD_PHASE_TIME));
+		case PHYSICS_3D_ISLAND_TIME: return USEC_TO_SEC(PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_ISLAND_TIME));
+		case PHYSICS_3D_NARROW_PHASE_TIME: return USEC_TO_SEC(PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_NARROW_PHASE_TIME));
+		case PHYSICS_3D_SOLVER_TIME: return USEC_TO_SEC(PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_SOLVER_TIME));
+		case PHYSICS_3D_INTEGRATION_TIME: return USEC_TO_SEC(PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_INTEGRATION_TIME));
+		case PHYSICS_3D_AREA_QUERY_TIME: return USEC_TO_SEC(PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_AREA_QUERY_TIME));
+		case PHYSICS_3D_PAIRS_TESTED: return PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_PAIRS_TESTED);
+		case PHYSICS_3D_CONTACT_COUNT: return PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_CONTACT_COUNT);
+		case PHYSICS_3D_CCD_SWEEPS: return PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_CCD_SWEEPS);
+		case RENDER_2D_ITEMS_IN_FRAME: return VS::get_singleton()->get_render_info(VS::INFO_2D_ITEMS_IN_FRAME);
+		case RENDER_2D_DRAW_CALLS_IN_FRAME: return VS::get_singleton()->get_render_info(VS::INFO_2D_DRAW_CALLS_IN_FRAME);
+		case RENDER_TRIANGLES_IN_FRAME: return VS::get_singleton()->get_render_info(VS::INFO_TRIANGLES_IN_FRAME);
+		case RENDER_OCCLUDED_OBJECTS_IN_FRAME: return VS::get_singleton()->get_render_info(VS::INFO_OCCLUDED_OBJECTS_IN_FRAME);
+		case RENDER_DIRTY_INSTANCES_IN_FRAME: return VS::get_singleton()->get_render_info(VS::INFO_DIRTY_INSTANCES_IN_FRAME);
+		case RENDER_SHADER_COMPILE_CACHE_HITS: return VS::get_singleton()->get_render_info(VS::INFO_SHADER_COMPILE_CACHE_HITS);
+		case RENDER_SHADER_COMPILE_CACHE_MISSES: return VS::get_singleton()->get_render_info(VS::INFO_SHADER_COMPILE_CACHE_MISSES);
 
 		default: {}
 	}
@@ -186,6 +267,33 @@ Performance::MonitorType Performance::get_monitor_type(Monitor p_monitor) const
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
 
 	};
 
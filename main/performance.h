@@ -76,6 +76,33 @@ public:
 		PHYSICS_3D_ACTIVE_OBJECTS,
 		PHYSICS_3D_COLLISION_PAIRS,
 		PHYSICS_3D_ISLAND_COUNT,
+		PHYSICS_2D_STEP_TIME,
+		PHYSICS_2D_BROAD_PHASE_TIME,
+		PHYSICS_2D_ISLAND_TIME,
+		PHYSICS_2D_NARROW_PHASE_TIME,
+		PHYSICS_2D_SOLVER_TIME,
+		PHYSICS_2D_INTEGRATION_TIME,
+		PHYSICS_2D_AREA_QUERY_TIME,
+		PHYSICS_2D_PAIRS_TESTED,
+		PHYSICS_2D_CONTACT_COUNT,
+		PHYSICS_2D_CCD_SWEEPS,
+		PHYSICS_3D_STEP_TIME,
+		PHYSICS_3D_BROAD_PHASE_TIME,
+		PHYSICS_3D_ISLAND_TIME,
+		PHYSICS_3D_NARROW_PHASE_TIME,
+		PHYSICS_3D_SOLVER_TIME,
+		PHYSICS_3D_INTEGRATION_TIME,
+		PHYSICS_3D_AREA_QUERY_TIME,
+		PHYSICS_3D_PAIRS_TESTED,
+		PHYSICS_3D_CONTACT_COUNT,
+		PHYSICS_3D_CCD_SWEEPS,
+		RENDER_2D_ITEMS_IN_FRAME,
+		RENDER_2D_DRAW_CALLS_IN_FRAME,
+		RENDER_TRIANGLES_IN_FRAME,
+		RENDER_OCCLUDED_OBJECTS_IN_FRAME,
+		RENDER_DIRTY_INSTANCES_IN_FRAME,
+		RENDER_SHADER_COMPILE_CACHE_HITS,
+		RENDER_SHADER_COMPILE_CACHE_MISSES,
 		//physics
 		MONITOR_MAX
 	};
@@ -42,7 +42,9 @@
 #include "test_ordered_hash_map.h"
 #include "test_physics.h"
 #include "test_physics_2d.h"
+#include "test_physics_bench.h"
 #include "test_render.h"
+#include "test_render_bench.h"
 #include "test_shader_lang.h"
 #include "test_string.h"
 
@@ -53,7 +55,9 @@ const char **tests_get_names() {
 		"math",
 		"physics",
 		"physics_2d",
+		"physics_bench",
 		"render",
+		"render_bench",
 		"oa_hash_map",
 		"gui",
 		"io",
@@ -92,11 +96,21 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestPhysics2D::test();
 	}
 
+	if (p_test == "physics_bench") {
+
+		return TestPhysicsBench::test();
+	}
+
 	if (p_test == "render") {
 
 		return TestRender::test();
 	}
 
+	if (p_test == "render_bench") {
+
+		return TestRenderBench::test();
+	}
+
 	if (p_test == "oa_hash_map") {
 
 		return TestOAHashMap::test();
@@ -56,6 +56,11 @@ class TestPhysics2DMainLoop : public MainLoop {
 
 	Vector2 ray_from, ray_to;
 
+	// timing of the stress scene, enabled by passing a body count as the last argument
+	int stress_body_count;
+	int stress_frames;
+	uint64_t stress_step_usec;
+
 	struct BodyShapeData {
 
 		RID image;
@@ -308,6 +313,43 @@ protected:
 		}
 	}
 
+	void _add_stress_bodies(int p_count) {
+
+		Physics2DServer *ps = Physics2DServer::get_singleton();
+
+		RID box = ps->rectangle_shape_create();
+		ps->shape_set_data(box, Vector2(4, 4));
+
+		RID shelf = ps->rectangle_shape_create();
+		ps->shape_set_data(shelf, Vector2(5000, 4));
+
+		// short towers far apart on wide shelves, so each tower stays its own island. bodies have no sprite or callback, so the timings are the step alone
+		const int tower_height = 5;
+		const int towers_per_shelf = 200;
+
+		for (int i = 0; i < p_count; i++) {
+
+			int tower = i / tower_height;
+			int level = i % tower_height;
+			int shelf_index = tower / towers_per_shelf;
+			real_t shelf_y = 600 + shelf_index * 100;
+
+			if (tower % towers_per_shelf == 0 && level == 0) {
+
+				RID shelf_body = ps->body_create();
+				ps->body_set_mode(shelf_body, Physics2DServer::BODY_MODE_STATIC);
+				ps->body_set_space(shelf_body, space);
+				ps->body_add_shape(shelf_body, shelf);
+				ps->body_set_state(shelf_body, Physics2DServer::BODY_STATE_TRANSFORM, Transform2D(0, Point2(5000, shelf_y)));
+			}
+
+			RID body = ps->body_create();
+			ps->body_add_shape(body, box);
+			ps->body_set_space(body, space);
+			ps->body_set_state(body, Physics2DServer::BODY_STATE_TRANSFORM, Transform2D(0, Point2(25 + (tower % towers_per_shelf) * 50, shelf_y - 9 - level * 9)));
+		}
+	}
+
 	void _body_moved(Object *p_state, RID p_sprite) {
 		Physics2DDirectBodyState *state = (Physics2DDirectBodyState *)p_state;
 		VisualServer::get_singleton()->canvas_item_set_transform(p_sprite, state->get_transform());
@@ -411,11 +453,38 @@ public:
 		}
 
 		_add_concave(parr);
+
+		List<String> cmdline = OS::get_singleton()->get_cmdline_args();
+		if (cmdline.size() > 0 && cmdline[cmdline.size() - 1].to_int() > 0) {
+			stress_body_count = cmdline[cmdline.size() - 1].to_int();
+			_add_stress_bodies(stress_body_count);
+		}
+
 		//_add_plane(Vector2(0.0,-1).normalized(),-300);
 		//_add_plane(Vector2(1,0).normalized(),50);
 		//_add_plane(Vector2(-1,0).normalized(),-600);
 	}
 
+	virtual bool iteration(float p_time) {
+
+		if (!stress_body_count)
+			return false;
+
+		Physics2DServer *ps = Physics2DServer::get_singleton();
+
+		stress_step_usec += ps->get_process_info(Physics2DServer::INFO_STEP_TIME);
+		stress_frames++;
+
+		if (stress_frames == 60) {
+
+			print_line(itos(stress_body_count) + " bodies, " + itos(ps->get_process_info(Physics2DServer::INFO_ACTIVE_OBJECTS)) + " active, " + itos(ps->get_process_info(Physics2DServer::INFO_ISLAND_COUNT)) + " islands: " + rtos(stress_step_usec / 60000.0) + " msec per step (solver " + rtos(ps->get_process_info(Physics2DServer::INFO_SOLVER_TIME) / 1000.0) + ", narrow phase " + rtos(ps->get_process_info(Physics2DServer::INFO_NARROW_PHASE_TIME) / 1000.0) + ", integration " + rtos(ps->get_process_info(Physics2DServer::INFO_INTEGRATION_TIME) / 1000.0) + ")");
+			stress_frames = 0;
+			stress_step_usec = 0;
+		}
+
+		return false;
+	}
+
 	virtual bool idle(float p_time) {
 
 		return false;
@@ -423,7 +492,12 @@ public:
 	virtual void finish() {
 	}
 
-	TestPhysics2DMainLoop() {}
+	TestPhysics2DMainLoop() {
+
+		stress_body_count = 0;
+		stress_frames = 0;
+		stress_step_usec = 0;
+	}
 };
 
 namespace TestPhysics2D {
@@ -0,0 +1,1247 @@
+/*************************************************************************/
+/*  test_physics_bench.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_physics_bench.h"
+
+#include "octree.h"
+#include "os/os.h"
+#include "print_string.h"
+#include "project_settings.h"
+#include "servers/physics/body_pair_sw.h"
+#include "servers/physics_2d/body_pair_2d_sw.h"
+#include "servers/physics_2d/broad_phase_2d_hash_grid.h"
+#include "servers/physics_2d/collision_solver_2d_sw.h"
+#include "servers/physics_2d_server.h"
+#include "servers/physics_area_monitor_events.h"
+#include "servers/physics_server.h"
+#include "servers/physics_work_pool.h"
+
+namespace TestPhysicsBench {
+
+#define BENCH_BODY_COUNT 1000
+#define BENCH_CYCLES 100
+#define BENCH_STEP (1.0 / 60.0)
+#define BENCH_BROAD_PHASE_ELEMENTS 10000
+#define BENCH_AREA_MONITOR_EVENTS 4096
+#define BENCH_SAT_PAIRS 20000
+#define BENCH_JOINT_ISLANDS 96
+
+static void _print_time(const char *p_what, uint64_t p_usec, int p_count) {
+
+	OS::get_singleton()->print("\t%s: %d usec total, %.2f usec avg\n", p_what, (int)p_usec, (double)p_usec / p_count);
+}
+
+// A header whose counts only match the blob size once summed in 32 bits must not restore.
+// Adds 2^30 records of 4 bytes to the active list count, the last uint32_t before the padding.
+template <class S>
+static bool _restore_rejects_wrapped_counts(S *p_server, RID p_space, const PoolVector<uint8_t> &p_state) {
+
+	PoolVector<uint8_t> state = p_state;
+	{
+		PoolVector<uint8_t>::Write w = state.write();
+		((uint32_t *)w.ptr())[6] += 0x40000000;
+	}
+	return p_server->space_restore_state(p_space, state) != OK;
+}
+
+// A body pair record claiming more contacts than a pair holds must not restore.
+// The test spaces have no area pairs, so the body pair records are the last ones before the active list.
+template <class P, class S>
+static bool _restore_rejects_bad_contact_count(S *p_server, RID p_space, const PoolVector<uint8_t> &p_state) {
+
+	PoolVector<uint8_t> state = p_state;
+	{
+		PoolVector<uint8_t>::Write w = state.write();
+		const uint32_t *counts = (const uint32_t *)w.ptr();
+		if (counts[3] == 0 || counts[4] != 0 || counts[5] != 0)
+			return false;
+
+		P *pairs = (P *)(w.ptr() + state.size() - counts[6] * sizeof(uint32_t) - counts[3] * sizeof(P));
+		pairs[counts[3] - 1].contact_count = 1000;
+	}
+	return p_server->space_restore_state(p_space, state) != OK;
+}
+
+static bool test_space_state() {
+
+	PhysicsServer *ps = PhysicsServer::get_singleton();
+
+	RID space = ps->space_create();
+	ps->space_set_active(space, true);
+
+	RID floor_shape = ps->shape_create(PhysicsServer::SHAPE_PLANE);
+	ps->shape_set_data(floor_shape, Plane(Vector3(0, 1, 0), 0));
+	RID floor = ps->body_create(PhysicsServer::BODY_MODE_STATIC);
+	ps->body_set_space(floor, space);
+	ps->body_add_shape(floor, floor_shape);
+
+	RID sphere = ps->shape_create(PhysicsServer::SHAPE_SPHERE);
+	ps->shape_set_data(sphere, 0.5);
+
+	Vector<RID> bodies;
+	for (int i = 0; i < BENCH_BODY_COUNT; i++) {
+
+		RID body = ps->body_create(PhysicsServer::BODY_MODE_RIGID);
+		ps->body_set_space(body, space);
+		ps->body_add_shape(body, sphere);
+		ps->body_set_state(body, PhysicsServer::BODY_STATE_TRANSFORM, Transform(Basis(), Vector3((i % 32) * 1.1, 1 + (i / 1024) * 1.1, ((i / 32) % 32) * 1.1)));
+		bodies.push_back(body);
+	}
+
+	// let the pile settle a bit so there are contacts to save
+	for (int i = 0; i < 30; i++) {
+		ps->flush_queries();
+		ps->step(BENCH_STEP);
+	}
+
+	OS::get_singleton()->print("PhysicsServer space state, %d bodies:\n", BENCH_BODY_COUNT);
+
+	uint64_t save_usec = 0;
+	uint64_t restore_usec = 0;
+	bool ok = true;
+	PoolVector<uint8_t> state;
+
+	for (int i = 0; i < BENCH_CYCLES; i++) {
+
+		uint64_t t = OS::get_singleton()->get_ticks_usec();
+		state = ps->space_save_state(space);
+		save_usec += OS::get_singleton()->get_ticks_usec() - t;
+
+		ps->flush_queries();
+		ps->step(BENCH_STEP);
+		Vector<Transform> expected;
+		for (int j = 0; j < bodies.size(); j++)
+			expected.push_back(ps->body_get_state(bodies[j], PhysicsServer::BODY_STATE_TRANSFORM));
+
+		t = OS::get_singleton()->get_ticks_usec();
+		Error err = ps->space_restore_state(space, state);
+		restore_usec += OS::get_singleton()->get_ticks_usec() - t;
+		if (err != OK) {
+			OS::get_singleton()->print("\trestore failed\n");
+			ok = false;
+			break;
+		}
+
+		// stepping again from the restored state must reproduce the same frame
+		ps->flush_queries();
+		ps->step(BENCH_STEP);
+		for (int j = 0; j < bodies.size(); j++) {
+			Transform xform = ps->body_get_state(bodies[j], PhysicsServer::BODY_STATE_TRANSFORM);
+			if (xform != expected[j]) {
+				OS::get_singleton()->print("\tbody %d diverged after restore\n", j);
+				ok = false;
+				break;
+			}
+		}
+		if (!ok)
+			break;
+	}
+
+	if (ok && !_restore_rejects_wrapped_counts(ps, space, state)) {
+		OS::get_singleton()->print("\tstate with wrapped around counts restored\n");
+		ok = false;
+	}
+
+	if (ok && !_restore_rejects_bad_contact_count<BodyPairSW::State>(ps, space, state)) {
+		OS::get_singleton()->print("\tstate with too many pair contacts restored\n");
+		ok = false;
+	}
+
+	OS::get_singleton()->print("\tstate size: %d bytes\n", state.size());
+	_print_time("save", save_usec, BENCH_CYCLES);
+	_print_time("restore", restore_usec, BENCH_CYCLES);
+
+	for (int i = 0; i < bodies.size(); i++)
+		ps->free(bodies[i]);
+	ps->free(floor);
+	ps->free(sphere);
+	ps->free(floor_shape);
+	ps->free(space);
+
+	return ok;
+}
+
+static bool test_active_transforms() {
+
+	PhysicsServer *ps = PhysicsServer::get_singleton();
+
+	RID space = ps->space_create();
+	ps->space_set_active(space, true);
+
+	RID sphere = ps->shape_create(PhysicsServer::SHAPE_SPHERE);
+	ps->shape_set_data(sphere, 0.5);
+
+	// only every tenth body is awake, the rest must never show up in the active transforms
+	Vector<RID> bodies;
+	int awake = 0;
+	for (int i = 0; i < BENCH_BODY_COUNT * 10; i++) {
+
+		RID body = ps->body_create(PhysicsServer::BODY_MODE_RIGID);
+		ps->body_set_space(body, space);
+		ps->body_add_shape(body, sphere);
+		ps->body_set_state(body, PhysicsServer::BODY_STATE_TRANSFORM, Transform(Basis(), Vector3((i % 100) * 2, (i / 10000) * 2, ((i / 100) % 100) * 2)));
+		if (i % 10) {
+			ps->body_set_state(body, PhysicsServer::BODY_STATE_SLEEPING, true);
+		} else {
+			awake++;
+		}
+		bodies.push_back(body);
+	}
+
+	ps->flush_queries();
+	ps->step(BENCH_STEP);
+
+	OS::get_singleton()->print("PhysicsServer active transforms, %d bodies, %d awake:\n", bodies.size(), awake);
+
+	uint64_t t = OS::get_singleton()->get_ticks_usec();
+	ps->flush_queries();
+	const PhysicsServer::ActiveTransform *transforms = NULL;
+	int count = ps->space_get_active_transforms(space, &transforms);
+	_print_time("flush", OS::get_singleton()->get_ticks_usec() - t, 1);
+
+	bool ok = count == awake;
+	for (int i = 0; i < count && ok; i++) {
+		Transform xform = ps->body_get_state(transforms[i].body, PhysicsServer::BODY_STATE_TRANSFORM);
+		ok = xform == transforms[i].transform && !ps->body_get_state(transforms[i].body, PhysicsServer::BODY_STATE_SLEEPING);
+	}
+
+	OS::get_singleton()->print("\tactive transforms: %d\n", count);
+
+	for (int i = 0; i < bodies.size(); i++)
+		ps->free(bodies[i]);
+	ps->free(sphere);
+	ps->free(space);
+
+	return ok;
+}
+
+static bool test_persistent_manifolds() {
+
+	PhysicsServer *ps = PhysicsServer::get_singleton();
+
+	RID space = ps->space_create();
+	ps->space_set_active(space, true);
+
+	RID floor_shape = ps->shape_create(PhysicsServer::SHAPE_BOX);
+	ps->shape_set_data(floor_shape, Vector3(100, 1, 100));
+	RID floor = ps->body_create(PhysicsServer::BODY_MODE_STATIC);
+	ps->body_set_space(floor, space);
+	ps->body_add_shape(floor, floor_shape);
+	ps->body_set_state(floor, PhysicsServer::BODY_STATE_TRANSFORM, Transform(Basis(), Vector3(0, -1, 0)));
+
+	RID box = ps->shape_create(PhysicsServer::SHAPE_BOX);
+	ps->shape_set_data(box, Vector3(0.5, 0.5, 0.5));
+
+	// two box high stacks that never sleep, so every pair stays in the narrow phase
+	Vector<RID> bodies;
+	for (int i = 0; i < BENCH_BODY_COUNT; i++) {
+
+		RID body = ps->body_create(PhysicsServer::BODY_MODE_RIGID);
+		ps->body_set_space(body, space);
+		ps->body_add_shape(body, box);
+		ps->body_set_state(body, PhysicsServer::BODY_STATE_CAN_SLEEP, false);
+		ps->body_set_state(body, PhysicsServer::BODY_STATE_TRANSFORM, Transform(Basis(Vector3(0, 1, 0), i * 0.3), Vector3(((i / 2) % 25) * 1.5 - 18, 0.5 + (i % 2), (i / 50) * 1.5 - 15)));
+		bodies.push_back(body);
+	}
+
+	for (int i = 0; i < 60; i++) {
+		ps->flush_queries();
+		ps->step(BENCH_STEP);
+	}
+
+	OS::get_singleton()->print("PhysicsServer persistent manifolds, %d resting boxes:\n", BENCH_BODY_COUNT);
+
+	uint64_t step_usec = 0;
+	int pairs = 0;
+	int pairs_tested = 0;
+
+	for (int i = 0; i < BENCH_CYCLES; i++) {
+
+		ps->flush_queries();
+		uint64_t t = OS::get_singleton()->get_ticks_usec();
+		ps->step(BENCH_STEP);
+		step_usec += OS::get_singleton()->get_ticks_usec() - t;
+		pairs += ps->get_process_info(PhysicsServer::INFO_COLLISION_PAIRS);
+		pairs_tested += ps->get_process_info(PhysicsServer::INFO_PAIRS_TESTED);
+	}
+
+	OS::get_singleton()->print("\tpairs: %d, narrow phase runs: %d\n", pairs / BENCH_CYCLES, pairs_tested / BENCH_CYCLES);
+	_print_time("step", step_usec, BENCH_CYCLES);
+
+	// reused manifolds must still hold the stacks up
+	bool ok = pairs_tested < pairs;
+	for (int i = 0; i < bodies.size() && ok; i++) {
+		Transform xform = ps->body_get_state(bodies[i], PhysicsServer::BODY_STATE_TRANSFORM);
+		if (Math::abs(xform.origin.y - (0.5 + (i % 2))) > 0.1) {
+			OS::get_singleton()->print("\tbox %d is not resting\n", i);
+			ok = false;
+		}
+	}
+
+	for (int i = 0; i < bodies.size(); i++)
+		ps->free(bodies[i]);
+	ps->free(floor);
+	ps->free(box);
+	ps->free(floor_shape);
+	ps->free(space);
+
+	return ok;
+}
+
+static bool test_heightmap_edit() {
+
+	PhysicsServer *ps = PhysicsServer::get_singleton();
+
+	RID space = ps->space_create();
+	ps->space_set_active(space, true);
+
+	// a flat 8x8 map whose opposite corners pin the bounds to [-2, 2], so edits in the middle keep the AABB
+	const int size = 8;
+	PoolVector<real_t> heights;
+	heights.resize(size * size);
+	for (int i = 0; i < heights.size(); i++)
+		heights.set(i, 0);
+	heights.set(0, 2);
+	heights.set(size * size - 1, -2);
+
+	Dictionary d;
+	d["width"] = size;
+	d["depth"] = size;
+	d["cell_size"] = 1.0;
+	d["heights"] = heights;
+
+	RID heightmap = ps->shape_create(PhysicsServer::SHAPE_HEIGHTMAP);
+	ps->shape_set_data(heightmap, d);
+	RID ground = ps->body_create(PhysicsServer::BODY_MODE_STATIC);
+	ps->body_set_space(ground, space);
+	ps->body_add_shape(ground, heightmap);
+
+	RID box = ps->shape_create(PhysicsServer::SHAPE_BOX);
+	ps->shape_set_data(box, Vector3(0.5, 0.5, 0.5));
+	RID body = ps->body_create(PhysicsServer::BODY_MODE_RIGID);
+	ps->body_set_space(body, space);
+	ps->body_add_shape(body, box);
+	ps->body_set_state(body, PhysicsServer::BODY_STATE_TRANSFORM, Transform(Basis(), Vector3(3.5, 1, 3.5)));
+
+	// let the box settle on the ground
+	for (int i = 0; i < 180; i++) {
+		ps->flush_queries();
+		ps->step(BENCH_STEP);
+	}
+
+	OS::get_singleton()->print("PhysicsServer heightmap edit under a resting box:\n");
+
+	Transform xform = ps->body_get_state(body, PhysicsServer::BODY_STATE_TRANSFORM);
+	bool ok = Math::abs(xform.origin.y - 0.5) < 0.05;
+	OS::get_singleton()->print("\tresting height: %f\n", xform.origin.y);
+
+	// raise the cells under the box without touching the bounds
+	PoolVector<real_t> raised;
+	raised.resize(4 * 4);
+	for (int i = 0; i < raised.size(); i++)
+		raised.set(i, 0.3);
+
+	Dictionary edit;
+	edit["region"] = Rect2(2, 2, 4, 4);
+	edit["heights"] = raised;
+	ps->shape_set_data(heightmap, edit);
+
+	for (int i = 0; i < 60; i++) {
+		ps->flush_queries();
+		ps->step(BENCH_STEP);
+	}
+
+	// the contacts must follow the new surface instead of the cached depth
+	xform = ps->body_get_state(body, PhysicsServer::BODY_STATE_TRANSFORM);
+	OS::get_singleton()->print("\theight after raising the ground by 0.3: %f\n", xform.origin.y);
+	ok = ok && Math::abs(xform.origin.y - 0.8) < 0.05;
+
+	ps->free(body);
+	ps->free(ground);
+	ps->free(box);
+	ps->free(heightmap);
+	ps->free(space);
+
+	return ok;
+}
+
+static int _octree_pair_count = 0;
+static int _octree_bad_unpairs = 0;
+
+static void *_octree_pair(void *p_self, OctreeElementID p_A, uint8_t *p_object_A, int p_subindex_A, OctreeElementID p_B, uint8_t *p_object_B, int p_subindex_B) {
+
+	_octree_pair_count++;
+	return p_object_A;
+}
+
+static void _octree_unpair(void *p_self, OctreeElementID p_A, uint8_t *p_object_A, int p_subindex_A, OctreeElementID p_B, uint8_t *p_object_B, int p_subindex_B, void *p_data) {
+
+	if (p_data != p_object_A)
+		_octree_bad_unpairs++;
+	_octree_pair_count--;
+}
+
+static bool test_octree() {
+
+	Octree<uint8_t, true> octree;
+	octree.set_pair_callback(_octree_pair, NULL);
+	octree.set_unpair_callback(_octree_unpair, NULL);
+	_octree_pair_count = 0;
+	_octree_bad_unpairs = 0;
+
+	// the octree only compares owners, so fake ones are enough here
+	Vector<uint8_t> owners;
+	owners.resize(BENCH_BROAD_PHASE_ELEMENTS);
+
+	// every fourth element is static, like in BroadPhaseOctree
+	uint64_t seed = 1;
+	Vector<OctreeElementID> ids;
+	Vector<AABB> aabbs;
+	for (int i = 0; i < BENCH_BROAD_PHASE_ELEMENTS; i++) {
+
+		Vector3 pos(Math::rand_from_seed(&seed) % 400, Math::rand_from_seed(&seed) % 400, Math::rand_from_seed(&seed) % 400);
+		Vector3 size(2 + Math::rand_from_seed(&seed) % 6, 2 + Math::rand_from_seed(&seed) % 6, 2 + Math::rand_from_seed(&seed) % 6);
+		bool pairable = i % 4 != 0;
+		OctreeElementID id = octree.create(&owners[i], AABB(pos, size), 0, pairable, 1, pairable ? 0xFFFFF : 0);
+		ids.push_back(id);
+		aabbs.push_back(AABB(pos, size));
+	}
+
+	OS::get_singleton()->print("Octree, %d elements:\n", BENCH_BROAD_PHASE_ELEMENTS);
+
+	uint64_t move_usec = 0;
+	for (int i = 0; i < BENCH_CYCLES; i++) {
+
+		uint64_t t = OS::get_singleton()->get_ticks_usec();
+		for (int j = 0; j < ids.size(); j++) {
+			if (j % 4 == 0)
+				continue;
+			AABB aabb = aabbs[j];
+			aabb.position += Vector3(int(Math::rand_from_seed(&seed) % 5) - 2, int(Math::rand_from_seed(&seed) % 5) - 2, int(Math::rand_from_seed(&seed) % 5) - 2) * 0.5;
+			octree.move(ids[j], aabb);
+			aabbs[j] = aabb;
+		}
+		move_usec += OS::get_singleton()->get_ticks_usec() - t;
+	}
+
+	// the pairs reported must match a brute force check
+	int expected = 0;
+	for (int i = 0; i < aabbs.size(); i++) {
+		for (int j = i + 1; j < aabbs.size(); j++) {
+			if ((i % 4 != 0 || j % 4 != 0) && aabbs[i].intersects_inclusive(aabbs[j]))
+				expected++;
+		}
+	}
+
+	OS::get_singleton()->print("\tpairs: %d, expected %d, octants: %d\n", _octree_pair_count, expected, octree.get_octant_count());
+	_print_time("move all", move_usec, BENCH_CYCLES);
+	bool ok = _octree_pair_count == expected && octree.get_pair_count() == expected;
+
+	// a view frustum like convex, and the same cull done by hand
+	Vector<Plane> planes;
+	planes.push_back(Plane(Vector3(-1, 0, 0), -50));
+	planes.push_back(Plane(Vector3(1, 0, 0), 250));
+	planes.push_back(Plane(Vector3(0, -1, 0), -20));
+	planes.push_back(Plane(Vector3(0, 1, 0), 300));
+	planes.push_back(Plane(Vector3(0, 0, -1), -100));
+	planes.push_back(Plane(Vector3(0.6, 0, 0.8), 280));
+
+	int expected_culled = 0;
+	for (int i = 0; i < aabbs.size(); i++) {
+		if (aabbs[i].intersects_convex_shape(&planes[0], planes.size()))
+			expected_culled++;
+	}
+
+	Vector<uint8_t *> culled;
+	culled.resize(BENCH_BROAD_PHASE_ELEMENTS);
+	int culled_count = 0;
+	uint64_t t = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < BENCH_CYCLES; i++)
+		culled_count = octree.cull_convex(planes, culled.ptrw(), culled.size());
+	_print_time("cull convex", OS::get_singleton()->get_ticks_usec() - t, BENCH_CYCLES);
+
+	Vector<bool> seen;
+	seen.resize(BENCH_BROAD_PHASE_ELEMENTS);
+	for (int i = 0; i < seen.size(); i++)
+		seen[i] = false;
+	for (int i = 0; i < culled_count; i++) {
+		int idx = culled[i] - &owners[0];
+		if (seen[idx] || !aabbs[idx].intersects_convex_shape(&planes[0], planes.size()))
+			ok = false;
+		seen[idx] = true;
+	}
+
+	OS::get_singleton()->print("\tculled: %d, expected %d\n", culled_count, expected_culled);
+	ok = ok && culled_count == expected_culled;
+
+	t = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < ids.size(); i++)
+		octree.erase(ids[i]);
+	_print_time("erase", OS::get_singleton()->get_ticks_usec() - t, ids.size());
+
+	// erasing everything must report every unpair and free every octant
+	ok = ok && _octree_pair_count == 0 && !_octree_bad_unpairs && octree.get_octant_count() == 0;
+
+	return ok;
+}
+
+static bool test_space_state_2d() {
+
+	Physics2DServer *ps = Physics2DServer::get_singleton();
+
+	RID space = ps->space_create();
+	ps->space_set_active(space, true);
+
+	RID floor_shape = ps->line_shape_create();
+	Array line;
+	line.push_back(Vector2(0, -1));
+	line.push_back(0);
+	ps->shape_set_data(floor_shape, line);
+	RID floor = ps->body_create();
+	ps->body_set_mode(floor, Physics2DServer::BODY_MODE_STATIC);
+	ps->body_set_space(floor, space);
+	ps->body_add_shape(floor, floor_shape);
+
+	RID circle = ps->circle_shape_create();
+	ps->shape_set_data(circle, 8);
+
+	Vector<RID> bodies;
+	for (int i = 0; i < BENCH_BODY_COUNT; i++) {
+
+		RID body = ps->body_create();
+		ps->body_set_space(body, space);
+		ps->body_add_shape(body, circle);
+		ps->body_set_state(body, Physics2DServer::BODY_STATE_TRANSFORM, Transform2D(0, Vector2((i % 32) * 17, -10 - (i / 32) * 17)));
+		bodies.push_back(body);
+	}
+
+	for (int i = 0; i < 30; i++) {
+		ps->flush_queries();
+		ps->step(BENCH_STEP);
+		ps->end_sync();
+	}
+
+	OS::get_singleton()->print("Physics2DServer space state, %d bodies:\n", BENCH_BODY_COUNT);
+
+	uint64_t save_usec = 0;
+	uint64_t restore_usec = 0;
+	bool ok = true;
+	PoolVector<uint8_t> state;
+
+	for (int i = 0; i < BENCH_CYCLES; i++) {
+
+		uint64_t t = OS::get_singleton()->get_ticks_usec();
+		state = ps->space_save_state(space);
+		save_usec += OS::get_singleton()->get_ticks_usec() - t;
+
+		ps->flush_queries();
+		ps->step(BENCH_STEP);
+		ps->end_sync();
+		Vector<Transform2D> expected;
+		for (int j = 0; j < bodies.size(); j++)
+			expected.push_back(ps->body_get_state(bodies[j], Physics2DServer::BODY_STATE_TRANSFORM));
+
+		t = OS::get_singleton()->get_ticks_usec();
+		Error err = ps->space_restore_state(space, state);
+		restore_usec += OS::get_singleton()->get_ticks_usec() - t;
+		if (err != OK) {
+			OS::get_singleton()->print("\trestore failed\n");
+			ok = false;
+			break;
+		}
+
+		ps->flush_queries();
+		ps->step(BENCH_STEP);
+		ps->end_sync();
+		for (int j = 0; j < bodies.size(); j++) {
+			Transform2D xform = ps->body_get_state(bodies[j], Physics2DServer::BODY_STATE_TRANSFORM);
+			if (xform != expected[j]) {
+				OS::get_singleton()->print("\tbody %d diverged after restore\n", j);
+				ok = false;
+				break;
+			}
+		}
+		if (!ok)
+			break;
+	}
+
+	if (ok && !_restore_rejects_wrapped_counts(ps, space, state)) {
+		OS::get_singleton()->print("\tstate with wrapped around counts restored\n");
+		ok = false;
+	}
+
+	if (ok && !_restore_rejects_bad_contact_count<BodyPair2DSW::State>(ps, space, state)) {
+		OS::get_singleton()->print("\tstate with too many pair contacts restored\n");
+		ok = false;
+	}
+
+	OS::get_singleton()->print("\tstate size: %d bytes\n", state.size());
+	_print_time("save", save_usec, BENCH_CYCLES);
+	_print_time("restore", restore_usec, BENCH_CYCLES);
+
+	for (int i = 0; i < bodies.size(); i++)
+		ps->free(bodies[i]);
+	ps->free(floor);
+	ps->free(circle);
+	ps->free(floor_shape);
+	ps->free(space);
+
+	return ok;
+}
+
+#ifdef DEBUG_ENABLED
+// Returns how far heap usage rose while calling p_method, including memory freed again before it returned.
+// Usage is first padded up to the recorded maximum, so anything allocated during the call raises the maximum.
+static uint64_t _call_heap_peak(Object *p_object, const StringName &p_method, const Variant &p_arg1, const Variant &p_arg2) {
+
+	void *pad = Memory::alloc_static(Memory::get_mem_max_usage() - Memory::get_mem_usage() + 1);
+	uint64_t base = Memory::get_mem_max_usage();
+	p_object->call(p_method, p_arg1, p_arg2);
+	uint64_t peak = Memory::get_mem_max_usage() - base;
+	Memory::free_static(pad);
+	return peak;
+}
+#endif
+
+static bool test_space_queries_2d() {
+
+	Physics2DServer *ps = Physics2DServer::get_singleton();
+
+	RID space = ps->space_create();
+	ps->space_set_active(space, true);
+
+	RID circle = ps->circle_shape_create();
+	ps->shape_set_data(circle, 8);
+
+	// a grid of static circles, 32 columns wide, rows 20 units apart
+	Vector<RID> bodies;
+	for (int i = 0; i < BENCH_BODY_COUNT; i++) {
+
+		RID body = ps->body_create();
+		ps->body_set_mode(body, Physics2DServer::BODY_MODE_STATIC);
+		ps->body_set_space(body, space);
+		ps->body_add_shape(body, circle);
+		ps->body_set_state(body, Physics2DServer::BODY_STATE_TRANSFORM, Transform2D(0, Vector2((i % 32) * 20, (i / 32) * 20)));
+		bodies.push_back(body);
+	}
+
+	ps->flush_queries();
+	ps->step(BENCH_STEP);
+	ps->end_sync();
+
+	Physics2DDirectSpaceState *dss = ps->space_get_direct_state(space);
+	ERR_FAIL_COND_V(!dss, false);
+
+	OS::get_singleton()->print("Physics2DServer space queries, %d bodies:\n", BENCH_BODY_COUNT);
+
+	const int queries = BENCH_CYCLES * 100;
+	const int excluded_rows = 4;
+	bool ok = true;
+
+	// cast down each column, excluding its top rows, so the ray must skip those and hit the next one
+	uint64_t t = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < queries; i++) {
+
+		int column = i % 32;
+		PhysicsQueryExclude exclude;
+		for (int j = 0; j < excluded_rows; j++)
+			exclude.insert(bodies[j * 32 + column]);
+
+		Physics2DDirectSpaceState::RayResult result;
+		bool hit = dss->intersect_ray(Vector2(column * 20, -100), Vector2(column * 20, 10000), result, exclude);
+		if (!hit || result.rid != bodies[excluded_rows * 32 + column]) {
+			OS::get_singleton()->print("\tray %d hit the wrong body\n", i);
+			ok = false;
+			break;
+		}
+	}
+	_print_time("intersect_ray", OS::get_singleton()->get_ticks_usec() - t, queries);
+
+	Physics2DDirectSpaceState::ShapeResult results[8];
+	t = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; ok && i < queries; i++) {
+
+		int body = i % bodies.size();
+		Vector2 pos = Vector2((body % 32) * 20, (body / 32) * 20);
+		int rc = dss->intersect_point(pos, results, 8);
+		int rc_excluded = dss->intersect_point(pos, results, 8, bodies[body]);
+		if (rc != 1 || rc_excluded != 0) {
+			OS::get_singleton()->print("\tpoint %d returned %d/%d results\n", i, rc, rc_excluded);
+			ok = false;
+		}
+	}
+	_print_time("intersect_point (x2)", OS::get_singleton()->get_ticks_usec() - t, queries);
+
+#ifdef DEBUG_ENABLED
+	// an empty spot returns an empty Array, so the result buffer is the only sizable allocation left;
+	// it must stay on the stack up to the default max_results and only move to the heap above it
+	const StringName intersect_point = "intersect_point";
+	const Vector2 empty_spot = Vector2(10, 10);
+	uint64_t stack_peak = _call_heap_peak(dss, intersect_point, empty_spot, 32);
+	uint64_t heap_peak = _call_heap_peak(dss, intersect_point, empty_spot, 64);
+	OS::get_singleton()->print("\tintersect_point heap peak: %d bytes (32 results), %d bytes (64 results)\n", int(stack_peak), int(heap_peak));
+	if (heap_peak < 64 * sizeof(Physics2DDirectSpaceState::ShapeResult)) {
+		OS::get_singleton()->print("\tthe heap peak missed the 64 result buffer\n");
+		ok = false;
+	} else if (stack_peak >= 32 * sizeof(Physics2DDirectSpaceState::ShapeResult)) {
+		OS::get_singleton()->print("\tintersect_point allocated a result buffer for 32 results\n");
+		ok = false;
+	}
+#endif
+
+	for (int i = 0; i < bodies.size(); i++)
+		ps->free(bodies[i]);
+	ps->free(circle);
+	ps->free(space);
+
+	return ok;
+}
+
+static bool test_move_and_slide_2d() {
+
+	Physics2DServer *ps = Physics2DServer::get_singleton();
+
+	RID space = ps->space_create();
+	ps->space_set_active(space, true);
+
+	// not a line, motion casts ignore line shapes
+	RID floor_shape = ps->rectangle_shape_create();
+	ps->shape_set_data(floor_shape, Vector2(BENCH_BODY_COUNT * 32 + 64, 8));
+	RID floor = ps->body_create();
+	ps->body_set_mode(floor, Physics2DServer::BODY_MODE_STATIC);
+	ps->body_set_space(floor, space);
+	ps->body_add_shape(floor, floor_shape);
+	ps->body_set_state(floor, Physics2DServer::BODY_STATE_TRANSFORM, Transform2D(0, Vector2(BENCH_BODY_COUNT * 32, 8)));
+
+	RID box = ps->rectangle_shape_create();
+	ps->shape_set_data(box, Vector2(8, 8));
+
+	// kinematic characters standing on the floor, walking into a row of static crates every 64 units
+	Vector<RID> bodies;
+	Vector<RID> crates;
+	for (int i = 0; i < BENCH_BODY_COUNT; i++) {
+
+		RID body = ps->body_create();
+		ps->body_set_mode(body, Physics2DServer::BODY_MODE_KINEMATIC);
+		ps->body_set_space(body, space);
+		ps->body_add_shape(body, box);
+		ps->body_set_state(body, Physics2DServer::BODY_STATE_TRANSFORM, Transform2D(0, Vector2(i * 64, -8)));
+		bodies.push_back(body);
+
+		RID crate = ps->body_create();
+		ps->body_set_mode(crate, Physics2DServer::BODY_MODE_STATIC);
+		ps->body_set_space(crate, space);
+		ps->body_add_shape(crate, box);
+		ps->body_set_state(crate, Physics2DServer::BODY_STATE_TRANSFORM, Transform2D(0, Vector2(i * 64 + 24 + (i % 8), -8)));
+		crates.push_back(crate);
+	}
+
+	ps->flush_queries();
+	ps->step(BENCH_STEP);
+	ps->end_sync();
+
+	Vector<Physics2DServer::MoveAndSlideParameters> params;
+	params.resize(bodies.size());
+	for (int i = 0; i < bodies.size(); i++) {
+
+		Physics2DServer::MoveAndSlideParameters &p = params[i];
+		p.body = bodies[i];
+		p.from = ps->body_get_state(bodies[i], Physics2DServer::BODY_STATE_TRANSFORM);
+		p.linear_velocity = Vector2(300, 500);
+		p.motion = p.linear_velocity * BENCH_STEP;
+		p.floor_direction = Vector2(0, -1);
+	}
+
+	OS::get_singleton()->print("Physics2DServer move and slide, %d bodies:\n", BENCH_BODY_COUNT);
+
+	Vector<Physics2DServer::MoveAndSlideResult> batch;
+	batch.resize(bodies.size());
+	Vector<Physics2DServer::MoveAndSlideResult> single;
+	single.resize(bodies.size());
+	bool ok = true;
+
+	uint64_t batch_usec = 0;
+	uint64_t single_usec = 0;
+	uint64_t test_motion_usec = 0;
+
+	for (int i = 0; i < BENCH_CYCLES; i++) {
+
+		uint64_t t = OS::get_singleton()->get_ticks_usec();
+		ps->body_move_and_slide(params.ptr(), batch.ptrw(), params.size());
+		batch_usec += OS::get_singleton()->get_ticks_usec() - t;
+
+		t = OS::get_singleton()->get_ticks_usec();
+		for (int j = 0; j < params.size(); j++)
+			ps->body_move_and_slide(&params[j], &single[j], 1);
+		single_usec += OS::get_singleton()->get_ticks_usec() - t;
+
+		// what a slide costs when every iteration is a separate motion test
+		t = OS::get_singleton()->get_ticks_usec();
+		for (int j = 0; j < params.size(); j++) {
+
+			Transform2D xform = params[j].from;
+			Vector2 motion = params[j].motion;
+			for (int k = 0; k < params[j].max_slides; k++) {
+
+				Physics2DServer::MotionResult mr;
+				bool collided = ps->body_test_motion(params[j].body, xform, motion, params[j].margin, &mr);
+				xform.elements[2] += mr.motion;
+				if (!collided)
+					break;
+				motion = mr.remainder.slide(mr.collision_normal);
+				if (motion == Vector2())
+					break;
+			}
+		}
+		test_motion_usec += OS::get_singleton()->get_ticks_usec() - t;
+	}
+
+	// threads must not change the outcome, and the characters must have stopped on the floor at the crates
+	for (int i = 0; i < bodies.size(); i++) {
+
+		const Physics2DServer::MoveAndSlideResult &a = batch[i];
+		const Physics2DServer::MoveAndSlideResult &b = single[i];
+		if (a.transform != b.transform || a.linear_velocity != b.linear_velocity || a.collision_count != b.collision_count || a.on_floor != b.on_floor || a.on_wall != b.on_wall) {
+			OS::get_singleton()->print("\tbody %d differs between batched and single slides\n", i);
+			ok = false;
+			break;
+		}
+		if (!a.on_floor || a.transform.get_origin().y > -8 + 0.1) {
+			OS::get_singleton()->print("\tbody %d is not resting on the floor\n", i);
+			ok = false;
+			break;
+		}
+	}
+
+	_print_time("batched", batch_usec, BENCH_CYCLES);
+	_print_time("one call per body", single_usec, BENCH_CYCLES);
+	_print_time("body_test_motion per slide", test_motion_usec, BENCH_CYCLES);
+
+	for (int i = 0; i < bodies.size(); i++) {
+		ps->free(bodies[i]);
+		ps->free(crates[i]);
+	}
+	ps->free(floor);
+	ps->free(box);
+	ps->free(floor_shape);
+	ps->free(space);
+
+	return ok;
+}
+
+static int _bp_pair_count = 0;
+
+static void *_bp_pair(CollisionObject2DSW *p_object_A, int p_subindex_A, CollisionObject2DSW *p_object_B, int p_subindex_B, void *p_userdata) {
+
+	_bp_pair_count++;
+	return NULL;
+}
+
+static void _bp_unpair(CollisionObject2DSW *p_object_A, int p_subindex_A, CollisionObject2DSW *p_object_B, int p_subindex_B, void *p_data, void *p_userdata) {
+
+	_bp_pair_count--;
+}
+
+static bool test_broad_phase_2d() {
+
+	BroadPhase2DSW *bp = BroadPhase2DHashGrid::_create();
+	bp->set_pair_callback(_bp_pair, NULL);
+	bp->set_unpair_callback(_bp_unpair, NULL);
+	_bp_pair_count = 0;
+
+	// the broadphase only compares owners, so fake ones are enough here
+	Vector<uint8_t> owners;
+	owners.resize(BENCH_BROAD_PHASE_ELEMENTS);
+
+	uint64_t seed = 1;
+	Vector<BroadPhase2DSW::ID> ids;
+	Vector<Rect2> rects;
+	for (int i = 0; i < BENCH_BROAD_PHASE_ELEMENTS; i++) {
+
+		Rect2 r(Math::rand_from_seed(&seed) % 20000, Math::rand_from_seed(&seed) % 20000, 16 + Math::rand_from_seed(&seed) % 64, 16 + Math::rand_from_seed(&seed) % 64);
+		BroadPhase2DSW::ID id = bp->create((CollisionObject2DSW *)&owners[i]);
+		bp->move(id, r);
+		ids.push_back(id);
+		rects.push_back(r);
+	}
+
+	OS::get_singleton()->print("BroadPhase2DHashGrid, %d moving elements:\n", BENCH_BROAD_PHASE_ELEMENTS);
+
+	uint64_t move_usec = 0;
+	for (int i = 0; i < BENCH_CYCLES; i++) {
+
+		uint64_t t = OS::get_singleton()->get_ticks_usec();
+		for (int j = 0; j < ids.size(); j++) {
+			Rect2 r = rects[j];
+			r.position += Vector2(int(Math::rand_from_seed(&seed) % 17) - 8, int(Math::rand_from_seed(&seed) % 17) - 8);
+			bp->move(ids[j], r);
+			rects[j] = r;
+		}
+		move_usec += OS::get_singleton()->get_ticks_usec() - t;
+	}
+
+	// the pairs reported must match a brute force check
+	int expected = 0;
+	for (int i = 0; i < rects.size(); i++) {
+		for (int j = i + 1; j < rects.size(); j++) {
+			if (rects[i].intersects(rects[j]))
+				expected++;
+		}
+	}
+
+	OS::get_singleton()->print("\tpairs: %d, expected %d\n", _bp_pair_count, expected);
+	_print_time("move all", move_usec, BENCH_CYCLES);
+	bool ok = _bp_pair_count == expected;
+
+	uint64_t t = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < ids.size(); i++)
+		bp->remove(ids[i]);
+	_print_time("remove", OS::get_singleton()->get_ticks_usec() - t, ids.size());
+
+	// removing everything must report every unpair
+	ok = ok && _bp_pair_count == 0;
+	memdelete(bp);
+
+	return ok;
+}
+
+struct _MonitoredObject : public RID_Data {
+};
+
+static bool test_area_monitor_events() {
+
+	PhysicsAreaMonitorEvents events;
+	RID_Owner<_MonitoredObject> owner;
+	Vector<_MonitoredObject *> objects;
+	Vector<RID> rids;
+	for (int i = 0; i < BENCH_AREA_MONITOR_EVENTS; i++) {
+		objects.push_back(memnew(_MonitoredObject));
+		rids.push_back(owner.make_rid(objects[i]));
+	}
+
+	OS::get_singleton()->print("PhysicsAreaMonitorEvents, %d overlaps per step:\n", BENCH_AREA_MONITOR_EVENTS);
+
+	bool ok = true;
+	uint64_t add_usec = 0;
+	uint64_t pack_usec = 0;
+	PoolVector<int> packed;
+
+	for (int i = 0; i < BENCH_CYCLES; i++) {
+
+		uint64_t t = OS::get_singleton()->get_ticks_usec();
+		// every object enters on two shapes, odd ones leave one of them again within the same step
+		for (int j = 0; j < BENCH_AREA_MONITOR_EVENTS; j++) {
+			RID rid = rids[j];
+			events.add(rid, j, 0, 1, 1);
+			events.add(rid, j, 1, 1, 1);
+			if (j & 1)
+				events.add(rid, j, 1, 1, -1);
+		}
+		add_usec += OS::get_singleton()->get_ticks_usec() - t;
+
+		t = OS::get_singleton()->get_ticks_usec();
+		int count = events.pack(packed, 0, 1);
+		pack_usec += OS::get_singleton()->get_ticks_usec() - t;
+
+		ok = ok && events.size() == BENCH_AREA_MONITOR_EVENTS * 2;
+		ok = ok && count == BENCH_AREA_MONITOR_EVENTS + BENCH_AREA_MONITOR_EVENTS / 2;
+
+		// rows keep the order the overlaps were reported in
+		PoolVector<int>::Read r = packed.read();
+		int row = 0;
+		for (int j = 0; j < BENCH_AREA_MONITOR_EVENTS && ok; j++) {
+			const int *e = &r[row * PhysicsAreaMonitorEvents::EVENT_STRIDE];
+			ok = e[0] == 0 && e[1] == j && e[2] == 0 && e[3] == 1;
+			row += (j & 1) ? 1 : 2;
+		}
+
+		events.clear();
+		ok = ok && events.empty();
+	}
+
+	_print_time("add", add_usec, BENCH_CYCLES);
+	_print_time("pack", pack_usec, BENCH_CYCLES);
+
+	for (int i = 0; i < rids.size(); i++) {
+		owner.free(rids[i]);
+		memdelete(objects[i]);
+	}
+
+	return ok;
+}
+
+struct _SATContacts {
+
+	int count;
+	Vector2 points[4];
+};
+
+static void _sat_contact(const Vector2 &p_point_A, const Vector2 &p_point_B, void *p_userdata) {
+
+	_SATContacts *contacts = (_SATContacts *)p_userdata;
+	if (contacts->count < 2) {
+		contacts->points[contacts->count * 2 + 0] = p_point_A;
+		contacts->points[contacts->count * 2 + 1] = p_point_B;
+	}
+	contacts->count++;
+}
+
+static bool test_sat_batch_2d() {
+
+	CircleShape2DSW circle;
+	circle.set_data(10.0);
+	RectangleShape2DSW rectangle;
+	rectangle.set_data(Vector2(12, 7));
+	CapsuleShape2DSW capsule;
+	capsule.set_data(Vector2(5, 20)); // radius, height
+
+	const Shape2DSW *combinations[][2] = {
+		{ &circle, &circle },
+		{ &circle, &rectangle },
+		{ &rectangle, &rectangle },
+		{ &capsule, &rectangle },
+	};
+	const char *names[] = { "circle/circle", "circle/rectangle", "rectangle/rectangle", "capsule/rectangle" };
+
+	OS::get_singleton()->print("Batched SAT, %d pairs per shape combination:\n", BENCH_SAT_PAIRS);
+
+	bool ok = true;
+	uint64_t seed = 1;
+
+	Vector<Transform2D> xforms_A, xforms_B;
+	Vector<Vector2> sep_axes_scalar, sep_axes_batch;
+	Vector<_SATContacts> contacts_scalar, contacts_batch;
+	Vector<CollisionSolver2DSW::BatchPair> pairs;
+	Vector<uint8_t> collided_scalar;
+	bool *collided_batch = memnew_arr(bool, BENCH_SAT_PAIRS);
+
+	xforms_A.resize(BENCH_SAT_PAIRS);
+	xforms_B.resize(BENCH_SAT_PAIRS);
+	sep_axes_scalar.resize(BENCH_SAT_PAIRS);
+	sep_axes_batch.resize(BENCH_SAT_PAIRS);
+	contacts_scalar.resize(BENCH_SAT_PAIRS);
+	contacts_batch.resize(BENCH_SAT_PAIRS);
+	pairs.resize(BENCH_SAT_PAIRS);
+	collided_scalar.resize(BENCH_SAT_PAIRS);
+
+	for (int c = 0; c < 4; c++) {
+
+		const Shape2DSW *shape_A = combinations[c][0];
+		const Shape2DSW *shape_B = combinations[c][1];
+
+		// about half of the pairs touch, half of them start with a cached separating axis
+		for (int i = 0; i < BENCH_SAT_PAIRS; i++) {
+			xforms_A[i] = Transform2D((Math::rand_from_seed(&seed) % 628) * 0.01, Vector2(Math::rand_from_seed(&seed) % 40, Math::rand_from_seed(&seed) % 40));
+			xforms_B[i] = Transform2D((Math::rand_from_seed(&seed) % 628) * 0.01, Vector2(Math::rand_from_seed(&seed) % 40, Math::rand_from_seed(&seed) % 40));
+			sep_axes_scalar[i] = (i & 1) ? Vector2(1, 0).rotated((Math::rand_from_seed(&seed) % 628) * 0.01) : Vector2();
+			sep_axes_batch[i] = sep_axes_scalar[i];
+		}
+
+		uint64_t t = OS::get_singleton()->get_ticks_usec();
+		for (int i = 0; i < BENCH_SAT_PAIRS; i++) {
+			contacts_scalar[i].count = 0;
+			collided_scalar[i] = CollisionSolver2DSW::solve(shape_A, xforms_A[i], Vector2(), shape_B, xforms_B[i], Vector2(), _sat_contact, &contacts_scalar[i], &sep_axes_scalar[i]);
+		}
+		uint64_t scalar_usec = OS::get_singleton()->get_ticks_usec() - t;
+
+		t = OS::get_singleton()->get_ticks_usec();
+		CollisionSolver2DSW::BatchType type = CollisionSolver2DSW::BATCH_NONE;
+		for (int i = 0; i < BENCH_SAT_PAIRS; i++) {
+			contacts_batch[i].count = 0;
+			type = CollisionSolver2DSW::make_batch_pair(pairs[i], shape_A, xforms_A[i], shape_B, xforms_B[i], _sat_contact, &contacts_batch[i], &sep_axes_batch[i], &collided_batch[i]);
+		}
+		CollisionSolver2DSW::solve_batch(type, pairs.ptrw(), BENCH_SAT_PAIRS);
+		uint64_t batch_usec = OS::get_singleton()->get_ticks_usec() - t;
+
+		// the batched kernels must report the same collisions, contacts and separating axes
+		int collided = 0;
+		int mismatches = 0;
+		for (int i = 0; i < BENCH_SAT_PAIRS; i++) {
+
+			const _SATContacts &a = contacts_scalar[i];
+			const _SATContacts &b = contacts_batch[i];
+			bool match = bool(collided_scalar[i]) == collided_batch[i] && a.count == b.count && sep_axes_scalar[i].distance_to(sep_axes_batch[i]) < 0.001;
+			for (int j = 0; match && j < MIN(a.count, 2) * 2; j++)
+				match = a.points[j].distance_to(b.points[j]) < 0.01;
+
+			collided += collided_scalar[i];
+			if (!match)
+				mismatches++;
+		}
+
+		OS::get_singleton()->print("\t%s: %d collided, %d mismatches\n", names[c], collided, mismatches);
+		_print_time("scalar", scalar_usec, BENCH_SAT_PAIRS);
+		_print_time("batched", batch_usec, BENCH_SAT_PAIRS);
+
+		ok = ok && type != CollisionSolver2DSW::BATCH_NONE && mismatches == 0;
+	}
+
+	memdelete_arr(collided_batch);
+
+	return ok;
+}
+
+// Every body hangs from the same static body through a pin, groove or spring joint. Islands don't walk
+// through static bodies, so each one is its own island sharing the anchor, and they are solved in parallel.
+static bool test_shared_static_joints_2d() {
+
+	Physics2DServer *ps = Physics2DServer::get_singleton();
+	Variant worker_threads = ProjectSettings::get_singleton()->get("physics/common/worker_threads");
+
+	Vector<Vector2> positions[2];
+	bool ok = true;
+
+	for (int pass = 0; pass < 2; pass++) {
+
+		// restart the server so it picks up the thread count
+		ps->finish();
+		ProjectSettings::get_singleton()->set("physics/common/worker_threads", pass == 0 ? 1 : 4);
+		ps->init();
+
+		int threads = PhysicsWorkPool::acquire()->get_thread_count();
+		PhysicsWorkPool::release();
+
+		RID space = ps->space_create();
+		ps->space_set_active(space, true);
+
+		RID anchor = ps->body_create();
+		ps->body_set_mode(anchor, Physics2DServer::BODY_MODE_STATIC);
+		ps->body_set_space(anchor, space);
+
+		RID circle = ps->circle_shape_create();
+		ps->shape_set_data(circle, 8);
+
+		Vector<RID> bodies;
+		Vector<RID> joints;
+		for (int i = 0; i < BENCH_JOINT_ISLANDS; i++) {
+
+			Vector2 pivot(i * 100, 0);
+			RID body = ps->body_create();
+			ps->body_set_space(body, space);
+			ps->body_add_shape(body, circle);
+			ps->body_set_state(body, Physics2DServer::BODY_STATE_TRANSFORM, Transform2D(0, pivot + Vector2(30, 40)));
+			bodies.push_back(body);
+
+			switch (i % 3) {
+				case 0: {
+					joints.push_back(ps->pin_joint_create(pivot, anchor, body));
+				} break;
+				case 1: {
+					joints.push_back(ps->groove_joint_create(pivot, pivot + Vector2(0, 80), pivot + Vector2(30, 40), anchor, body));
+				} break;
+				case 2: {
+					joints.push_back(ps->damped_spring_joint_create(pivot + Vector2(30, 40), pivot, body, anchor));
+				} break;
+			}
+		}
+
+		for (int i = 0; i < 120; i++) {
+			ps->flush_queries();
+			ps->step(BENCH_STEP);
+			ps->end_sync();
+		}
+
+		for (int i = 0; i < bodies.size(); i++)
+			positions[pass].push_back(Transform2D(ps->body_get_state(bodies[i], Physics2DServer::BODY_STATE_TRANSFORM)).get_origin());
+
+		Vector2 anchor_velocity = ps->body_get_state(anchor, Physics2DServer::BODY_STATE_LINEAR_VELOCITY);
+		ok = ok && anchor_velocity == Vector2() && ps->get_process_info(Physics2DServer::INFO_ISLAND_COUNT) == BENCH_JOINT_ISLANDS;
+
+		OS::get_singleton()->print("Physics2DServer joints on a shared static body, %d islands, %d threads\n", BENCH_JOINT_ISLANDS, threads);
+
+		for (int i = 0; i < joints.size(); i++)
+			ps->free(joints[i]);
+		for (int i = 0; i < bodies.size(); i++)
+			ps->free(bodies[i]);
+		ps->free(anchor);
+		ps->free(circle);
+		ps->free(space);
+	}
+
+	ps->finish();
+	ProjectSettings::get_singleton()->set("physics/common/worker_threads", worker_threads);
+	ps->init();
+
+	// islands are solved independently, so the thread count must not change the result
+	int mismatches = 0;
+	for (int i = 0; i < BENCH_JOINT_ISLANDS; i++) {
+		if (positions[0][i] != positions[1][i])
+			mismatches++;
+	}
+	OS::get_singleton()->print("\tmismatches: %d\n", mismatches);
+
+	return ok && mismatches == 0;
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+
+	test_space_state,
+	test_active_transforms,
+	test_persistent_manifolds,
+	test_heightmap_edit,
+	test_octree,
+	test_space_state_2d,
+	test_space_queries_2d,
+	test_move_and_slide_2d,
+	test_broad_phase_2d,
+	test_area_monitor_events,
+	test_sat_batch_2d,
+	test_shared_static_joints_2d,
+	0
+};
+
+MainLoop *test() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+} // namespace TestPhysicsBench
@@ -0,0 +1,1557 @@
+/*************************************************************************/
+/*  test_render_bench.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_render_bench.h"
+
+#include "drivers/dummy/rasterizer_dummy.h"
+#include "map.h"
+#include "os/os.h"
+#include "print_string.h"
+#include "project_settings.h"
+#include "set.h"
+#include "sort.h"
+#include "servers/visual/rasterizer_canvas_batcher.h"
+#include "servers/visual/visual_server_canvas.h"
+#include "servers/visual/visual_server_global.h"
+#include "servers/visual/visual_server_scene.h"
+
+#ifndef SERVER_ENABLED
+#include "drivers/gles3/shader_compiler_gles3.h"
+#endif
+
+namespace TestRenderBench {
+
+#define BENCH_GRID_WIDTH 100
+#define BENCH_GRID_DEPTH 200
+#define BENCH_OMNI_LIGHTS 32
+#define BENCH_FRAMES 20
+#define BENCH_LOD_LEVELS 3
+#define BENCH_LOD_DISTANCE 40
+#define BENCH_LOD_MARGIN 2
+#define BENCH_ROOMS 4
+#define BENCH_ROOM_DEPTH 40
+#define BENCH_DOOR_SIZE 8
+#define BENCH_WALL_DISTANCE 20
+#define BENCH_WALL_WIDTH 60
+#define BENCH_WALL_HEIGHT 32
+#define BENCH_SHADER_MATERIALS 256
+#define BENCH_SHADER_VARIANTS 8
+
+static void _print_time(const char *p_what, uint64_t p_usec, int p_count) {
+
+	OS::get_singleton()->print("\t%s: %d usec total, %.2f usec avg\n", p_what, (int)p_usec, (double)p_usec / p_count);
+}
+
+// The dummy rasterizer drops everything, these keep just enough state for
+// VisualServerScene to cull meshes and render shadows.
+class BenchStorage : public RasterizerStorageDummy {
+public:
+	struct BenchLight : public RID_Data {
+		VS::LightType type;
+		float param[VS::LIGHT_PARAM_MAX];
+		bool shadow;
+	};
+
+	mutable RID_Owner<BenchLight> light_owner;
+
+	Map<RID, AABB> mesh_aabbs; // meshes without one are a 2x2x2 box
+
+	AABB mesh_get_aabb(RID p_mesh, RID p_skeleton) const {
+
+		const Map<RID, AABB>::Element *E = mesh_aabbs.find(p_mesh);
+		return E ? E->get() : AABB(Vector3(-1, -1, -1), Vector3(2, 2, 2));
+	}
+	int mesh_get_surface_count(RID p_mesh) const { return 1; }
+
+	RID light_create(VS::LightType p_type) {
+
+		BenchLight *light = memnew(BenchLight);
+		light->type = p_type;
+		for (int i = 0; i < VS::LIGHT_PARAM_MAX; i++)
+			light->param[i] = 0;
+		light->shadow = false;
+		return light_owner.make_rid(light);
+	}
+
+	void light_set_param(RID p_light, VS::LightParam p_param, float p_value) { light_owner.get(p_light)->param[p_param] = p_value; }
+	void light_set_shadow(RID p_light, bool p_enabled) { light_owner.get(p_light)->shadow = p_enabled; }
+	bool light_has_shadow(RID p_light) const { return light_owner.get(p_light)->shadow; }
+	VS::LightType light_get_type(RID p_light) const { return light_owner.get(p_light)->type; }
+	float light_get_param(RID p_light, VS::LightParam p_param) { return light_owner.get(p_light)->param[p_param]; }
+
+	AABB light_get_aabb(RID p_light) const {
+
+		const BenchLight *light = light_owner.get(p_light);
+		if (light->type == VS::LIGHT_DIRECTIONAL)
+			return AABB();
+		float r = light->param[VS::LIGHT_PARAM_RANGE];
+		return AABB(-Vector3(r, r, r), Vector3(r, r, r) * 2);
+	}
+
+	VS::LightDirectionalShadowMode light_directional_get_shadow_mode(RID p_light) { return VS::LIGHT_DIRECTIONAL_SHADOW_PARALLEL_4_SPLITS; }
+	VS::LightOmniShadowMode light_omni_get_shadow_mode(RID p_light) { return VS::LIGHT_OMNI_SHADOW_CUBE; }
+
+	VS::InstanceType get_base_type(RID p_rid) const {
+
+		if (light_owner.owns(p_rid))
+			return VS::INSTANCE_LIGHT;
+		return RasterizerStorageDummy::get_base_type(p_rid);
+	}
+
+	bool free(RID p_rid) {
+
+		if (light_owner.owns(p_rid)) {
+			BenchLight *light = light_owner.get(p_rid);
+			light_owner.free(p_rid);
+			memdelete(light);
+		} else if (mesh_owner.owns(p_rid)) {
+			DummyMesh *mesh = mesh_owner.get(p_rid);
+			mesh_owner.free(p_rid);
+			memdelete(mesh);
+			mesh_aabbs.erase(p_rid);
+		} else {
+			return RasterizerStorageDummy::free(p_rid);
+		}
+		return true;
+	}
+};
+
+class BenchSceneRender : public RasterizerSceneDummy {
+public:
+	struct BenchAtlas : public RID_Data {
+	};
+
+	RID_Owner<BenchAtlas> atlas_owner;
+
+	int frames;
+	int instances_drawn;
+	int lights_drawn;
+	int shadow_passes;
+	int shadow_casters;
+
+	bool record_drawn;
+	Set<Vector3> drawn_origins; // of the last frame, when recorded
+
+	bool record_levels;
+	Map<Vector3, RID> drawn_levels; // mesh drawn at each origin in the last frame, an empty RID if more than one, when recorded
+
+	RID shadow_atlas_create() { return atlas_owner.make_rid(memnew(BenchAtlas)); }
+	bool shadow_atlas_update_light(RID p_atlas, RID p_light_intance, float p_coverage, uint64_t p_light_version) { return true; }
+	int get_directional_light_shadow_size(RID p_light_intance) { return 2048; }
+
+	void render_scene(const Transform &p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_ortogonal, InstanceBase **p_cull_result, int p_cull_count, RID *p_light_cull_result, int p_light_cull_count, RID *p_reflection_probe_cull_result, int p_reflection_probe_cull_count, RID p_environment, RID p_shadow_atlas, RID p_reflection_atlas, RID p_reflection_probe, int p_reflection_probe_pass) {
+
+		frames++;
+		instances_drawn += p_cull_count;
+		lights_drawn += p_light_cull_count;
+
+		if (record_drawn) {
+			drawn_origins.clear();
+			for (int i = 0; i < p_cull_count; i++) {
+				drawn_origins.insert(p_cull_result[i]->transform.origin);
+			}
+		}
+
+		if (record_levels) {
+			drawn_levels.clear();
+			for (int i = 0; i < p_cull_count; i++) {
+				const Vector3 &origin = p_cull_result[i]->transform.origin;
+				RID level = drawn_levels.has(origin) ? RID() : p_cull_result[i]->base;
+				drawn_levels[origin] = level;
+			}
+		}
+	}
+
+	void render_shadow(RID p_light, RID p_shadow_atlas, int p_pass, InstanceBase **p_cull_result, int p_cull_count) {
+
+		shadow_passes++;
+		shadow_casters += p_cull_count;
+	}
+
+	bool free(RID p_rid) {
+
+		if (atlas_owner.owns(p_rid)) {
+			BenchAtlas *atlas = atlas_owner.get(p_rid);
+			atlas_owner.free(p_rid);
+			memdelete(atlas);
+		}
+		return true;
+	}
+
+	BenchSceneRender() {
+		frames = 0;
+		instances_drawn = 0;
+		lights_drawn = 0;
+		shadow_passes = 0;
+		shadow_casters = 0;
+		record_drawn = false;
+		record_levels = false;
+	}
+};
+
+// Swaps the bench rasterizer in and builds a scene of a few thousand boxes,
+// a directional light and moving omni lights, all casting shadows. Each box
+// can be split into levels of detail, one per BENCH_LOD_DISTANCE, which can
+// also use meshes of their own with bounds growing along z.
+class BenchScene {
+
+	RasterizerStorage *prev_storage;
+	RasterizerScene *prev_scene_render;
+	VisualServerScene *prev_scene;
+	VisualServerScene *prev_singleton;
+
+	Vector<RID> instances;
+	Vector<RID> lights;
+	Vector<RID> bases;
+	Vector<RID> boxes;
+	Vector<Vector3> box_origins;
+
+public:
+	BenchStorage storage;
+	BenchSceneRender scene_render;
+	VisualServerScene *scene;
+
+	RID scenario;
+	RID camera;
+	RID shadow_atlas;
+	Vector<RID> level_meshes;
+
+	const Vector<Vector3> &get_box_origins() const { return box_origins; }
+
+	void move_lights(int p_frame) {
+
+		for (int i = 0; i < lights.size(); i++) {
+			real_t angle = (p_frame + i * 7) * 0.05;
+			Vector3 pos((i % 8) * 24 - 84 + Math::cos(angle) * 6, 3, -(i / 8) * 24 - 10 + Math::sin(angle) * 6);
+			scene->instance_set_transform(lights[i], Transform(Basis(), pos));
+		}
+	}
+
+	void move_boxes(const Vector3 &p_offset) {
+
+		for (int i = 0; i < boxes.size(); i++) {
+			scene->instance_set_transform(boxes[i], Transform(Basis(), box_origins[i] + p_offset));
+		}
+	}
+
+	void draw(int p_frame, RID p_camera) {
+
+		move_lights(p_frame);
+		scene->update_dirty_instances();
+		scene->render_camera(p_camera, scenario, Size2(1280, 720), shadow_atlas);
+	}
+
+	void draw(int p_frame) {
+
+		draw(p_frame, camera);
+	}
+
+	BenchScene(int p_threads, int p_lod_levels = 1, bool p_level_bounds = false) {
+
+		ProjectSettings::get_singleton()->set("rendering/threads/culling_threads", p_threads);
+
+		prev_storage = VSG::storage;
+		prev_scene_render = VSG::scene_render;
+		prev_scene = VSG::scene;
+		prev_singleton = VisualServerScene::singleton;
+		VSG::storage = &storage;
+		VSG::scene_render = &scene_render;
+
+		scene = memnew(VisualServerScene);
+		VSG::scene = scene;
+
+		scenario = scene->scenario_create();
+		shadow_atlas = scene_render.shadow_atlas_create();
+
+		RID mesh = storage.mesh_create();
+		bases.push_back(mesh);
+
+		for (int k = 0; k < p_lod_levels; k++) {
+
+			if (p_level_bounds) {
+				RID level_mesh = storage.mesh_create();
+				storage.mesh_aabbs[level_mesh] = AABB(Vector3(-1, -1, -1 - k * 4), Vector3(2, 2, 2 + k * 4));
+				bases.push_back(level_mesh);
+				level_meshes.push_back(level_mesh);
+			} else {
+				level_meshes.push_back(mesh);
+			}
+		}
+
+		for (int i = 0; i < BENCH_GRID_WIDTH; i++) {
+			for (int j = 0; j < BENCH_GRID_DEPTH; j++) {
+
+				for (int k = 0; k < p_lod_levels; k++) {
+
+					Vector3 origin(i * 4 - BENCH_GRID_WIDTH * 2, (i + j) % 3, -j * 4);
+
+					RID instance = scene->instance_create();
+					scene->instance_set_base(instance, level_meshes[k]);
+					scene->instance_set_scenario(instance, scenario);
+					scene->instance_set_transform(instance, Transform(Basis(), origin));
+					if (p_lod_levels > 1) {
+						float end = k < p_lod_levels - 1 ? (k + 1) * BENCH_LOD_DISTANCE : 0;
+						scene->instance_geometry_set_draw_range(instance, k * BENCH_LOD_DISTANCE, end, BENCH_LOD_MARGIN, BENCH_LOD_MARGIN);
+					}
+					instances.push_back(instance);
+					boxes.push_back(instance);
+					box_origins.push_back(origin);
+				}
+			}
+		}
+
+		RID sun = storage.light_create(VS::LIGHT_DIRECTIONAL);
+		storage.light_set_shadow(sun, true);
+		storage.light_set_param(sun, VS::LIGHT_PARAM_SHADOW_MAX_DISTANCE, 100);
+		storage.light_set_param(sun, VS::LIGHT_PARAM_SHADOW_SPLIT_1_OFFSET, 0.1);
+		storage.light_set_param(sun, VS::LIGHT_PARAM_SHADOW_SPLIT_2_OFFSET, 0.2);
+		storage.light_set_param(sun, VS::LIGHT_PARAM_SHADOW_SPLIT_3_OFFSET, 0.5);
+		bases.push_back(sun);
+
+		RID sun_instance = scene->instance_create();
+		scene->instance_set_base(sun_instance, sun);
+		scene->instance_set_scenario(sun_instance, scenario);
+		scene->instance_set_transform(sun_instance, Transform(Basis(Vector3(1, 0, 0), -Math_PI * 0.3), Vector3()));
+		instances.push_back(sun_instance);
+
+		for (int i = 0; i < BENCH_OMNI_LIGHTS; i++) {
+
+			RID omni = storage.light_create(VS::LIGHT_OMNI);
+			storage.light_set_shadow(omni, true);
+			storage.light_set_param(omni, VS::LIGHT_PARAM_RANGE, 12);
+			bases.push_back(omni);
+
+			RID light = scene->instance_create();
+			scene->instance_set_base(light, omni);
+			scene->instance_set_scenario(light, scenario);
+			lights.push_back(light);
+			instances.push_back(light);
+		}
+
+		camera = scene->camera_create();
+		scene->camera_set_perspective(camera, 70, 0.05, 300);
+		scene->camera_set_transform(camera, Transform(Basis(Vector3(1, 0, 0), -0.2), Vector3(0, 12, 10)));
+
+		move_lights(0);
+		scene->update_dirty_instances();
+	}
+
+	~BenchScene() {
+
+		for (int i = 0; i < instances.size(); i++)
+			scene->free(instances[i]);
+		scene->free(camera);
+		scene->free(scenario);
+		memdelete(scene);
+
+		for (int i = 0; i < bases.size(); i++)
+			storage.free(bases[i]);
+		scene_render.free(shadow_atlas);
+
+		VSG::storage = prev_storage;
+		VSG::scene_render = prev_scene_render;
+		VSG::scene = prev_scene;
+		VisualServerScene::singleton = prev_singleton;
+	}
+};
+
+static bool test_render_scene_cull() {
+
+	OS::get_singleton()->print("VisualServerScene render cull, %d instances, %d shadowed omni lights:\n", BENCH_GRID_WIDTH * BENCH_GRID_DEPTH, BENCH_OMNI_LIGHTS);
+
+	// one thread first, the results of every other thread count must match it
+	int thread_counts[2] = { 1, 0 };
+	int drawn[2];
+	int casters[2];
+
+	for (int i = 0; i < 2; i++) {
+
+		BenchScene bench(thread_counts[i]);
+
+		uint64_t t = OS::get_singleton()->get_ticks_usec();
+		for (int j = 0; j < BENCH_FRAMES; j++)
+			bench.draw(j);
+		uint64_t usec = OS::get_singleton()->get_ticks_usec() - t;
+
+		drawn[i] = bench.scene_render.instances_drawn;
+		casters[i] = bench.scene_render.shadow_casters;
+
+		OS::get_singleton()->print("\t%s: %d instances, %d lights, %d shadow passes, %d shadow casters\n", i == 0 ? "serial" : "threaded", drawn[i], bench.scene_render.lights_drawn, bench.scene_render.shadow_passes, casters[i]);
+		_print_time("frame", usec, BENCH_FRAMES);
+	}
+
+	return drawn[0] > 0 && casters[0] > 0 && drawn[0] == drawn[1] && casters[0] == casters[1];
+}
+
+static bool test_render_scene_dirty() {
+
+	OS::get_singleton()->print("VisualServerScene dirty instances, %d moving instances:\n", BENCH_GRID_WIDTH * BENCH_GRID_DEPTH);
+
+	// the whole grid slides towards the camera, so the octree is really updated
+	int thread_counts[2] = { 1, 0 };
+	int dirty[2];
+	int drawn[2];
+	Set<Vector3> origins[2];
+	Vector3 offset;
+
+	for (int i = 0; i < 2; i++) {
+
+		BenchScene bench(thread_counts[i]);
+		bench.scene_render.record_drawn = true;
+		bench.scene->info.reset();
+
+		uint64_t usec = 0;
+		for (int frame = 0; frame < BENCH_FRAMES; frame++) {
+
+			offset = Vector3(0, 0, (frame + 1) * 3);
+			bench.move_boxes(offset);
+			bench.move_lights(frame + 1);
+
+			uint64_t t = OS::get_singleton()->get_ticks_usec();
+			bench.scene->update_dirty_instances();
+			usec += OS::get_singleton()->get_ticks_usec() - t;
+
+			bench.draw(frame + 1);
+		}
+
+		dirty[i] = bench.scene->info.dirty_instance_count;
+		drawn[i] = bench.scene_render.instances_drawn;
+		origins[i] = bench.scene_render.drawn_origins;
+
+		OS::get_singleton()->print("\t%s: %d dirty instances, %d instances drawn\n", i == 0 ? "serial" : "threaded", dirty[i], drawn[i]);
+		_print_time("update", usec, BENCH_FRAMES);
+	}
+
+	// brute force, the boxes of the last frame must be culled where they moved to
+	CameraMatrix projection;
+	projection.set_perspective(70, 1280.0 / 720.0, 0.05, 300, false);
+	Vector<Plane> frustum = projection.get_projection_planes(Transform(Basis(Vector3(1, 0, 0), -0.2), Vector3(0, 12, 10)).orthonormalized());
+
+	Set<Vector3> expected;
+	for (int i = 0; i < BENCH_GRID_WIDTH; i++) {
+		for (int j = 0; j < BENCH_GRID_DEPTH; j++) {
+
+			Vector3 origin = Vector3(i * 4 - BENCH_GRID_WIDTH * 2, (i + j) % 3, -j * 4) + offset;
+			AABB aabb(origin - Vector3(1, 1, 1), Vector3(2, 2, 2));
+			if (aabb.intersects_convex_shape(frustum.ptr(), frustum.size())) {
+				expected.insert(origin);
+			}
+		}
+	}
+
+	bool pass = true;
+
+	int moved = BENCH_FRAMES * (BENCH_GRID_WIDTH * BENCH_GRID_DEPTH + BENCH_OMNI_LIGHTS);
+	if (dirty[0] != moved || dirty[1] != moved) {
+		OS::get_singleton()->print("\tupdated %d and %d instances, expected %d\n", dirty[0], dirty[1], moved);
+		pass = false;
+	}
+
+	for (int i = 0; i < 2; i++) {
+
+		bool same = origins[i].size() == expected.size();
+		for (Set<Vector3>::Element *E = expected.front(); same && E; E = E->next()) {
+			same = origins[i].has(E->get());
+		}
+
+		if (!same) {
+			OS::get_singleton()->print("\t%s: drew %d instances in the last frame, expected %d\n", i == 0 ? "serial" : "threaded", origins[i].size(), expected.size());
+			pass = false;
+		}
+	}
+
+	return pass && drawn[0] == drawn[1];
+}
+
+static bool test_render_scene_lod() {
+
+	OS::get_singleton()->print("VisualServerScene draw ranges, %d instances, %d levels of detail each:\n", BENCH_GRID_WIDTH * BENCH_GRID_DEPTH, BENCH_LOD_LEVELS);
+
+	// the levels tile the distance, so exactly one of them is drawn wherever a single box would be,
+	// also when the camera jumps over several limits or stops inside a margin
+	int frame_count = BENCH_FRAMES * 4;
+	Vector<int> drawn[2];
+	Vector<int> casters[2];
+
+	for (int i = 0; i < 2; i++) {
+
+		BenchScene bench(0, i == 0 ? 1 : BENCH_LOD_LEVELS);
+		uint64_t usec = 0;
+
+		for (int frame = 0; frame < frame_count; frame++) {
+
+			float z = (frame % BENCH_FRAMES) * (frame < BENCH_FRAMES * 2 ? -9.0 : -37.0) + (frame & 1);
+			Basis basis = Basis(Vector3(1, 0, 0), -0.2).rotated(Vector3(0, 1, 0), frame * 0.1);
+			bench.scene->camera_set_transform(bench.camera, Transform(basis, Vector3(0, 12, z + 10)));
+
+			int prev_drawn = bench.scene_render.instances_drawn;
+			int prev_casters = bench.scene_render.shadow_casters;
+
+			uint64_t t = OS::get_singleton()->get_ticks_usec();
+			bench.draw(frame);
+			usec += OS::get_singleton()->get_ticks_usec() - t;
+
+			drawn[i].push_back(bench.scene_render.instances_drawn - prev_drawn);
+			casters[i].push_back(bench.scene_render.shadow_casters - prev_casters);
+		}
+
+		OS::get_singleton()->print("\t%s: %d instances, %d shadow casters\n", i == 0 ? "one level" : "draw ranges", bench.scene_render.instances_drawn, bench.scene_render.shadow_casters);
+		_print_time("frame", usec, frame_count);
+	}
+
+	bool pass = true;
+
+	for (int frame = 0; frame < frame_count; frame++) {
+
+		if (drawn[0][frame] != drawn[1][frame] || casters[0][frame] != casters[1][frame]) {
+			OS::get_singleton()->print("\tframe %d: drew %d instances and %d shadow casters, expected %d and %d\n", frame, drawn[1][frame], casters[1][frame], drawn[0][frame], casters[0][frame]);
+			pass = false;
+		}
+	}
+
+	return pass && drawn[0][0] > 0;
+}
+
+// 1 if the box is inside all the planes, -1 if it is outside one of them, 0 if it crosses them
+// or is too close to tell apart from the culling precision far from the origin
+static int _bench_aabb_side(const AABB &p_aabb, const Vector<Plane> &p_planes) {
+
+	const real_t tolerance = 0.1;
+	int side = 1;
+	for (int i = 0; i < p_planes.size(); i++) {
+
+		int over = 0;
+		int under = 0;
+		for (int j = 0; j < 8; j++) {
+			Vector3 corner = p_aabb.position + Vector3(j & 1 ? p_aabb.size.x : 0, j & 2 ? p_aabb.size.y : 0, j & 4 ? p_aabb.size.z : 0);
+			real_t distance = p_planes[i].distance_to(corner);
+			over += distance > tolerance;
+			under += distance < -tolerance;
+		}
+		if (over == 8)
+			return -1;
+		if (under < 8)
+			side = 0;
+	}
+	return side;
+}
+
+// Checks the levels drawn in the last frame of one camera against the distance from its origin to the boxes.
+// Only boxes whose levels are all inside or all outside the frustum are checked, as the culling of the others
+// depends on which level is tested. Inside a margin, a box checked in the previous frame must stay on the
+// side of that limit this camera drew it from.
+static int _bench_lod_errors(BenchScene &p_bench, const Transform &p_camera, const Vector<Plane> &p_planes, Map<Vector3, int> &r_levels) {
+
+	const Vector<Vector3> &origins = p_bench.get_box_origins();
+	Map<Vector3, int> levels;
+	int errors = 0;
+
+	for (int i = 0; i < origins.size(); i += BENCH_LOD_LEVELS) {
+
+		int inside = 0;
+		int outside = 0;
+		for (int k = 0; k < BENCH_LOD_LEVELS; k++) {
+			AABB aabb = p_bench.storage.mesh_get_aabb(p_bench.level_meshes[k], RID());
+			aabb.position += origins[i];
+			int side = _bench_aabb_side(aabb, p_planes);
+			inside += side > 0;
+			outside += side < 0;
+		}
+
+		const Map<Vector3, RID>::Element *drawn = p_bench.scene_render.drawn_levels.find(origins[i]);
+
+		if (outside == BENCH_LOD_LEVELS) {
+			errors += drawn != NULL;
+			continue;
+		}
+		if (inside < BENCH_LOD_LEVELS)
+			continue;
+
+		float distance = p_camera.origin.distance_to(origins[i]);
+		int limit = CLAMP(int(Math::round(distance / BENCH_LOD_DISTANCE)), 1, BENCH_LOD_LEVELS - 1); //first level beyond the closest limit
+		bool in_margin = distance >= limit * BENCH_LOD_DISTANCE - BENCH_LOD_MARGIN && distance < limit * BENCH_LOD_DISTANCE + BENCH_LOD_MARGIN;
+		const Map<Vector3, int>::Element *last = r_levels.find(origins[i]);
+
+		if (in_margin && !last)
+			continue; //its levels may have been culled from different sides, nothing says which one is right
+
+		if (!drawn || !drawn->get().is_valid()) {
+			errors++;
+			continue;
+		}
+
+		int level = p_bench.level_meshes.find(drawn->get());
+
+		if (in_margin) {
+			errors += level != (last->get() < limit ? limit - 1 : limit);
+		} else {
+			errors += level != MIN(int(distance / BENCH_LOD_DISTANCE), BENCH_LOD_LEVELS - 1);
+		}
+
+		levels[origins[i]] = level;
+	}
+
+	r_levels = levels;
+	return errors;
+}
+
+static bool test_render_scene_lod_views() {
+
+	OS::get_singleton()->print("VisualServerScene draw ranges, %d levels with their own bounds, two cameras:\n", BENCH_LOD_LEVELS);
+
+	// the levels grow along z, so the center of their bounds is up to twice the margin away from the origin they share,
+	// and the second camera stays half a level behind the first one, so it would flip the sides of the first one's boxes
+	BenchScene bench(0, BENCH_LOD_LEVELS, true);
+	bench.scene_render.record_levels = true;
+
+	RID cameras[2] = { bench.camera, bench.scene->camera_create() };
+	bench.scene->camera_set_perspective(cameras[1], 70, 0.05, 300);
+
+	CameraMatrix projection;
+	projection.set_perspective(70, 1280.0 / 720.0, 0.05, 300);
+
+	Map<Vector3, int> levels[2];
+	int errors[2] = { 0, 0 };
+	int frame_count = BENCH_FRAMES * 2;
+
+	for (int frame = 0; frame < frame_count; frame++) {
+
+		for (int i = 0; i < 2; i++) {
+
+			float z = (frame % BENCH_FRAMES) * (frame < BENCH_FRAMES ? -3.0 : -37.0) + (frame & 1) + i * BENCH_LOD_DISTANCE / 2;
+			Basis basis = Basis(Vector3(1, 0, 0), -0.2).rotated(Vector3(0, 1, 0), (i ? -0.05 : 0.05) * frame);
+			Transform xform(basis, Vector3(0, 12, z + 10));
+
+			bench.scene->camera_set_transform(cameras[i], xform);
+			bench.draw(frame, cameras[i]);
+			errors[i] += _bench_lod_errors(bench, xform, projection.get_projection_planes(xform), levels[i]);
+		}
+	}
+
+	OS::get_singleton()->print("\t%d frames, wrong levels: %d (first camera), %d (second camera)\n", frame_count, errors[0], errors[1]);
+
+	bench.scene->free(cameras[1]);
+
+	return errors[0] == 0 && errors[1] == 0 && bench.scene_render.instances_drawn > 0;
+}
+
+// Rooms in a row along the grid, each one opening into the next through a
+// doorway in the middle of their wall, the last one into the exterior.
+static Vector<Plane> _bench_room_planes(int p_room) {
+
+	Vector<Plane> planes;
+	planes.push_back(Plane(Vector3(1, 0, 0), BENCH_GRID_WIDTH * 2 + 10));
+	planes.push_back(Plane(Vector3(-1, 0, 0), BENCH_GRID_WIDTH * 2 + 10));
+	planes.push_back(Plane(Vector3(0, 1, 0), 20));
+	planes.push_back(Plane(Vector3(0, -1, 0), 10));
+	planes.push_back(Plane(Vector3(0, 0, 1), -p_room * BENCH_ROOM_DEPTH));
+	planes.push_back(Plane(Vector3(0, 0, -1), (p_room + 1) * BENCH_ROOM_DEPTH));
+	return planes;
+}
+
+static Vector<Vector3> _bench_door_points(int p_door) {
+
+	float z = -p_door * BENCH_ROOM_DEPTH;
+	float half = BENCH_DOOR_SIZE / 2;
+
+	Vector<Vector3> points;
+	points.push_back(Vector3(-half, 0, z));
+	points.push_back(Vector3(half, 0, z));
+	points.push_back(Vector3(half, BENCH_DOOR_SIZE, z));
+	points.push_back(Vector3(-half, BENCH_DOOR_SIZE, z));
+	return points;
+}
+
+static bool test_render_scene_rooms() {
+
+	OS::get_singleton()->print("VisualServerScene rooms, %d rooms in a row, %d instances:\n", BENCH_ROOMS, BENCH_GRID_WIDTH * BENCH_GRID_DEPTH);
+
+	Transform cam_transform(Basis(), Vector3(0, 4, -BENCH_ROOM_DEPTH / 2));
+	CameraMatrix projection;
+	projection.set_perspective(70, 1280.0 / 720.0, 0.05, 300, false);
+	Vector<Plane> frustum = projection.get_projection_planes(cam_transform);
+
+	// brute force, the doorways are in line and shrink with distance, so the
+	// rooms behind each one are seen through it alone
+	Vector<Plane> rooms[BENCH_ROOMS];
+	Vector<Plane> doors[BENCH_ROOMS + 1];
+
+	for (int k = 0; k < BENCH_ROOMS; k++) {
+		rooms[k] = _bench_room_planes(k);
+	}
+
+	for (int k = 1; k <= BENCH_ROOMS; k++) {
+
+		Vector<Vector3> points = _bench_door_points(k);
+		Vector3 center = (points[0] + points[2]) * 0.5;
+
+		doors[k].push_back(Plane(Vector3(0, 0, 1), -k * BENCH_ROOM_DEPTH));
+		for (int i = 0; i < points.size(); i++) {
+			Plane edge(cam_transform.origin, points[i], points[(i + 1) % points.size()]);
+			doors[k].push_back(edge.is_point_over(center) ? -edge : edge);
+		}
+		doors[k].push_back(frustum[CameraMatrix::PLANE_FAR]);
+	}
+
+	int expected_open = 0;
+	int expected_closed = 0;
+
+	for (int i = 0; i < BENCH_GRID_WIDTH; i++) {
+		for (int j = 0; j < BENCH_GRID_DEPTH; j++) {
+
+			AABB aabb(Vector3(i * 4 - BENCH_GRID_WIDTH * 2, (i + j) % 3, -j * 4) - Vector3(1, 1, 1), Vector3(2, 2, 2));
+			if (!aabb.intersects_convex_shape(frustum.ptr(), frustum.size()))
+				continue;
+
+			bool inside_room = false;
+			bool seen = false;
+			bool seen_closed = false;
+
+			for (int k = 0; k < BENCH_ROOMS; k++) {
+
+				if (!aabb.intersects_convex_shape(rooms[k].ptr(), rooms[k].size()))
+					continue;
+
+				bool inside = true;
+				for (int p = 0; p < rooms[k].size(); p++) {
+					inside = inside && rooms[k][p].distance_to(aabb.get_support(rooms[k][p].normal)) <= 0;
+				}
+
+				inside_room = inside_room || inside;
+				seen = seen || k == 0 || aabb.intersects_convex_shape(doors[k].ptr(), doors[k].size());
+				seen_closed = seen_closed || k == 0;
+			}
+
+			if (!inside_room) {
+				seen = seen || aabb.intersects_convex_shape(doors[BENCH_ROOMS].ptr(), doors[BENCH_ROOMS].size());
+			}
+
+			expected_open += seen;
+			expected_closed += seen_closed;
+		}
+	}
+
+	// no rooms, rooms culled serially and threaded, then with the first doorway closed
+	const char *names[4] = { "no rooms", "serial", "threaded", "door closed" };
+	int drawn[4];
+	int casters[4];
+
+	for (int pass = 0; pass < 4; pass++) {
+
+		BenchScene bench(pass == 2 ? 0 : 1);
+		bench.scene->camera_set_transform(bench.camera, cam_transform);
+
+		Vector<RID> room_rids;
+		Vector<RID> portal_rids;
+
+		if (pass > 0) {
+
+			for (int k = 0; k < BENCH_ROOMS; k++) {
+
+				RID room = bench.scene->room_create();
+				bench.scene->room_set_scenario(room, bench.scenario);
+				bench.scene->room_set_bounds(room, rooms[k]);
+				room_rids.push_back(room);
+			}
+
+			for (int k = 1; k <= BENCH_ROOMS; k++) {
+
+				RID portal = bench.scene->portal_create();
+				bench.scene->portal_set_rooms(portal, room_rids[k - 1], k < BENCH_ROOMS ? room_rids[k] : RID());
+				bench.scene->portal_set_points(portal, _bench_door_points(k));
+				bench.scene->portal_set_enabled(portal, pass != 3 || k != 1);
+				portal_rids.push_back(portal);
+			}
+		}
+
+		uint64_t t = OS::get_singleton()->get_ticks_usec();
+		for (int frame = 0; frame < BENCH_FRAMES; frame++)
+			bench.draw(frame);
+		uint64_t usec = OS::get_singleton()->get_ticks_usec() - t;
+
+		drawn[pass] = bench.scene_render.instances_drawn;
+		casters[pass] = bench.scene_render.shadow_casters;
+
+		OS::get_singleton()->print("\t%s: %d instances, %d shadow casters\n", names[pass], drawn[pass], casters[pass]);
+		_print_time("frame", usec, BENCH_FRAMES);
+
+		for (int i = 0; i < portal_rids.size(); i++)
+			bench.scene->free(portal_rids[i]);
+		for (int i = 0; i < room_rids.size(); i++)
+			bench.scene->free(room_rids[i]);
+	}
+
+	bool pass = true;
+
+	if (drawn[1] != expected_open * BENCH_FRAMES || drawn[3] != expected_closed * BENCH_FRAMES) {
+		OS::get_singleton()->print("\tdrew %d and %d instances, expected %d and %d\n", drawn[1], drawn[3], expected_open * BENCH_FRAMES, expected_closed * BENCH_FRAMES);
+		pass = false;
+	}
+
+	if (drawn[1] != drawn[2] || casters[1] != casters[2]) {
+		OS::get_singleton()->print("\tthreaded cull differs from serial\n");
+		pass = false;
+	}
+
+	// with the doors open every room is in sight, shadows are only spared once one closes
+	return pass && expected_closed > 0 && drawn[1] < drawn[0] && casters[1] <= casters[0] && casters[3] < casters[1];
+}
+
+// Whether the box at p_origin lies wholly in the shadow the wall casts from the camera.
+static bool _bench_behind_wall(const Vector3 &p_camera, const Vector3 &p_origin) {
+
+	AABB aabb(p_origin - Vector3(1, 1, 1), Vector3(2, 2, 2));
+
+	for (int i = 0; i < 8; i++) {
+
+		Vector3 p = aabb.get_endpoint(i);
+		if (p.z >= -BENCH_WALL_DISTANCE)
+			return false;
+
+		Vector3 hit = p_camera + (p - p_camera) * ((-BENCH_WALL_DISTANCE - p_camera.z) / (p.z - p_camera.z));
+		if (Math::abs(hit.x) > BENCH_WALL_WIDTH / 2 || hit.y < -2 || hit.y > BENCH_WALL_HEIGHT - 2)
+			return false;
+	}
+
+	return true;
+}
+
+static bool test_render_scene_occlusion() {
+
+	OS::get_singleton()->print("VisualServerScene occlusion, one wall, %d instances:\n", BENCH_GRID_WIDTH * BENCH_GRID_DEPTH);
+
+	PoolVector<Vector3> faces;
+	float x = BENCH_WALL_WIDTH / 2;
+	float y_from = -2;
+	float y_to = BENCH_WALL_HEIGHT - 2;
+	float z = -BENCH_WALL_DISTANCE;
+	faces.push_back(Vector3(-x, y_from, z));
+	faces.push_back(Vector3(x, y_from, z));
+	faces.push_back(Vector3(x, y_to, z));
+	faces.push_back(Vector3(-x, y_from, z));
+	faces.push_back(Vector3(x, y_to, z));
+	faces.push_back(Vector3(-x, y_to, z));
+
+	// no occluder, occluders rasterized serially and threaded
+	const char *names[3] = { "no occluder", "serial", "threaded" };
+	int drawn[3];
+	int casters[3];
+	int occluded[3];
+	Set<Vector3> origins[3];
+	Vector3 camera_origin(0, 12, 10); // where BenchScene puts the camera
+
+	for (int pass = 0; pass < 3; pass++) {
+
+		BenchScene bench(pass == 2 ? 0 : 1);
+		bench.scene_render.record_drawn = true;
+
+		RID occluder;
+		if (pass > 0) {
+			occluder = bench.scene->occluder_create();
+			bench.scene->occluder_set_scenario(occluder, bench.scenario);
+			bench.scene->occluder_set_faces(occluder, faces);
+			bench.scene->occluder_set_transform(occluder, Transform());
+			bench.scene->occluder_set_enabled(occluder, true);
+		}
+
+		uint64_t t = OS::get_singleton()->get_ticks_usec();
+		for (int frame = 0; frame < BENCH_FRAMES; frame++)
+			bench.draw(frame);
+		uint64_t usec = OS::get_singleton()->get_ticks_usec() - t;
+
+		drawn[pass] = bench.scene_render.instances_drawn;
+		casters[pass] = bench.scene_render.shadow_casters;
+		occluded[pass] = bench.scene->info.occluded_object_count;
+		origins[pass] = bench.scene_render.drawn_origins;
+
+		OS::get_singleton()->print("\t%s: %d instances, %d occluded, %d shadow casters\n", names[pass], drawn[pass], occluded[pass], casters[pass]);
+		_print_time("frame", usec, BENCH_FRAMES);
+
+		if (occluder.is_valid())
+			bench.scene->free(occluder);
+	}
+
+	// brute force, nothing in sight may be occluded, and most of what the wall hides should be
+	int hidden = 0;
+	int wrongly_occluded = 0;
+
+	for (Set<Vector3>::Element *E = origins[0].front(); E; E = E->next()) {
+
+		if (_bench_behind_wall(camera_origin, E->get())) {
+			hidden++;
+		} else if (!origins[1].has(E->get())) {
+			wrongly_occluded++;
+		}
+	}
+
+	int occluded_frame = occluded[1] / BENCH_FRAMES;
+	OS::get_singleton()->print("\t%d of %d instances behind the wall occluded\n", occluded_frame, hidden);
+
+	bool pass = true;
+
+	if (wrongly_occluded) {
+		OS::get_singleton()->print("\t%d visible instances occluded\n", wrongly_occluded);
+		pass = false;
+	}
+
+	if (drawn[1] + occluded[1] != drawn[0] || casters[1] != casters[0]) {
+		OS::get_singleton()->print("\toccluded instances were not only removed from the camera\n");
+		pass = false;
+	}
+
+	if (drawn[1] != drawn[2] || occluded[1] != occluded[2] || origins[1].size() != origins[2].size()) {
+		OS::get_singleton()->print("\tthreaded cull differs from serial\n");
+		pass = false;
+	}
+
+	return pass && hidden > 0 && occluded_frame * 2 >= hidden;
+}
+
+class BenchCanvasRender : public RasterizerCanvasDummy {
+public:
+	int items_drawn;
+
+	void canvas_render_items(Item *p_item_list, int p_z, const Color &p_modulate, Light *p_light) {
+
+		for (Item *item = p_item_list; item; item = item->next) {
+			items_drawn++;
+		}
+	}
+
+	BenchCanvasRender() {
+		items_drawn = 0;
+	}
+};
+
+#define BENCH_CANVAS_ITEMS 100000
+#define BENCH_CANVAS_WORLD 20000
+#define BENCH_CANVAS_MOVING 1000
+
+static bool test_render_canvas_cull() {
+
+	OS::get_singleton()->print("VisualServerCanvas cull, %d items, %d moving:\n", BENCH_CANVAS_ITEMS, BENCH_CANVAS_MOVING);
+
+	RasterizerCanvas *prev_canvas_render = VSG::canvas_render;
+	BenchCanvasRender canvas_render;
+	VSG::canvas_render = &canvas_render;
+
+	VisualServerCanvas *canvas_server = memnew(VisualServerCanvas);
+
+	RID canvas = canvas_server->canvas_create();
+	RID root = canvas_server->canvas_item_create();
+	canvas_server->canvas_item_set_parent(root, canvas);
+
+	uint64_t seed = 1;
+	Vector<RID> items;
+	Vector<Point2> positions;
+	Rect2 rect(-16, -16, 32, 32);
+
+	for (int i = 0; i < BENCH_CANVAS_ITEMS; i++) {
+
+		RID item = canvas_server->canvas_item_create();
+		canvas_server->canvas_item_set_parent(item, root);
+		canvas_server->canvas_item_set_draw_index(item, i);
+		canvas_server->canvas_item_add_rect(item, rect, Color(1, 1, 1));
+
+		Point2 pos(Math::rand_from_seed(&seed) % BENCH_CANVAS_WORLD, Math::rand_from_seed(&seed) % BENCH_CANVAS_WORLD);
+		canvas_server->canvas_item_set_transform(item, Transform2D(0, pos));
+		items.push_back(item);
+		positions.push_back(pos);
+	}
+
+	VisualServerCanvas::Canvas *canvas_ptr = canvas_server->canvas_owner.get(canvas);
+	Rect2 clip_rect(0, 0, 1280, 720);
+
+	// the first render builds the index for every item
+	uint64_t usec = OS::get_singleton()->get_ticks_usec();
+	canvas_server->render_canvas(canvas_ptr, Transform2D(), NULL, NULL, clip_rect);
+	_print_time("first render_canvas", OS::get_singleton()->get_ticks_usec() - usec, 1);
+
+	bool pass = true;
+	int total_drawn = 0;
+	usec = 0;
+
+	for (int frame = 0; frame < BENCH_FRAMES; frame++) {
+
+		for (int i = 0; i < BENCH_CANVAS_MOVING; i++) {
+			int idx = (frame * BENCH_CANVAS_MOVING + i * 97) % BENCH_CANVAS_ITEMS;
+			positions[idx] += Vector2(int(Math::rand_from_seed(&seed) % 201) - 100, int(Math::rand_from_seed(&seed) % 201) - 100);
+			canvas_server->canvas_item_set_transform(items[idx], Transform2D(0, positions[idx]));
+		}
+
+		// scroll and zoom the view over the world
+		Transform2D view = Transform2D(0, -Vector2(frame * 500, frame * 400)).scaled(Size2(1, 1) * (1.0 - frame * 0.02));
+
+		canvas_render.items_drawn = 0;
+		uint64_t t = OS::get_singleton()->get_ticks_usec();
+		canvas_server->render_canvas(canvas_ptr, view, NULL, NULL, clip_rect);
+		usec += OS::get_singleton()->get_ticks_usec() - t;
+
+		// brute force, with the transforms composed the way the renderer does
+		int expected = 0;
+		Transform2D root_xform = view * Transform2D();
+		for (int i = 0; i < BENCH_CANVAS_ITEMS; i++) {
+			if (clip_rect.intersects((root_xform * Transform2D(0, positions[i])).xform(rect)))
+				expected++;
+		}
+
+		total_drawn += canvas_render.items_drawn;
+		if (canvas_render.items_drawn != expected) {
+			OS::get_singleton()->print("\tframe %d: drew %d items, expected %d\n", frame, canvas_render.items_drawn, expected);
+			pass = false;
+		}
+	}
+
+	OS::get_singleton()->print("\t%d items drawn\n", total_drawn);
+	_print_time("render_canvas", usec, BENCH_FRAMES);
+
+	// a single point primitive has a zero size rect, it must still be indexed and drawn
+	RID point_canvas = canvas_server->canvas_create();
+	RID point = canvas_server->canvas_item_create();
+	canvas_server->canvas_item_set_parent(point, point_canvas);
+	Vector<Point2> point_pos;
+	point_pos.push_back(Point2(100, 100));
+	Vector<Color> point_color;
+	point_color.push_back(Color(1, 1, 1));
+	canvas_server->canvas_item_add_primitive(point, point_pos, point_color, Vector<Point2>(), RID());
+
+	canvas_render.items_drawn = 0;
+	canvas_server->render_canvas(canvas_server->canvas_owner.get(point_canvas), Transform2D(), NULL, NULL, clip_rect);
+	if (canvas_render.items_drawn != 1) {
+		OS::get_singleton()->print("\tpoint sized item was culled\n");
+		pass = false;
+	}
+
+	canvas_server->free(point);
+	canvas_server->free(point_canvas);
+	for (int i = 0; i < items.size(); i++)
+		canvas_server->free(items[i]);
+	canvas_server->free(root);
+	canvas_server->free(canvas);
+	memdelete(canvas_server);
+
+	VSG::canvas_render = prev_canvas_render;
+
+	return pass && total_drawn > 0;
+}
+
+// Resolves textures the way a renderer would, so the batcher can run without one.
+class BenchCanvasBatcher : public RasterizerCanvasBatcher {
+public:
+	struct BenchTexture : public RID_Data {
+		Size2 size;
+		bool repeat;
+	};
+
+	RID_Owner<BenchTexture> texture_owner;
+
+protected:
+	virtual bool _get_texture_info(const RID &p_texture, Size2 &r_size, bool &r_repeat) {
+
+		BenchTexture *texture = texture_owner.getornull(p_texture);
+		if (!texture)
+			return false;
+
+		r_size = texture->size;
+		r_repeat = texture->repeat;
+		return true;
+	}
+};
+
+class BenchCanvasBatchRender : public RasterizerCanvasDummy {
+public:
+	BenchCanvasBatcher batcher;
+	int items_drawn;
+	int draw_calls;
+	int bad_vertices;
+	uint64_t build_usec;
+
+	void canvas_render_items(Item *p_item_list, int p_z, const Color &p_modulate, Light *p_light) {
+
+		uint64_t t = OS::get_singleton()->get_ticks_usec();
+		batcher.build(p_item_list, p_z, p_modulate, p_light);
+		build_usec += OS::get_singleton()->get_ticks_usec() - t;
+
+		const RasterizerCanvasBatcher::Vertex *vertices = batcher.get_vertices();
+		const uint16_t *indices = batcher.get_indices();
+
+		for (int i = 0; i < batcher.get_batch_count(); i++) {
+
+			const RasterizerCanvasBatcher::Batch &batch = batcher.get_batches()[i];
+
+			if (batch.type == RasterizerCanvasBatcher::BATCH_ITEM) {
+				draw_calls += batch.item->commands.size();
+				items_drawn++;
+				continue;
+			}
+
+			draw_calls++;
+			items_drawn += batch.item_count;
+
+			// every batched item in the scene is a single texture region rect
+			Item *ci = batch.item;
+			for (int j = 0; j < batch.item_count; j++, ci = ci->next) {
+
+				const Item::CommandRect *rect = static_cast<const Item::CommandRect *>(ci->commands[0]);
+				const BenchCanvasBatcher::BenchTexture *texture = batcher.texture_owner.get(rect->texture);
+
+				for (int k = 0; k < 4; k++) {
+
+					Vector2 corner(k >= 2 ? 1 : 0, k == 1 || k == 2 ? 1 : 0);
+					Vector2 pos = ci->final_transform.xform(rect->rect.position + corner * rect->rect.size);
+					Vector2 uv = (rect->source.position + corner * rect->source.size) / texture->size;
+
+					const RasterizerCanvasBatcher::Vertex &v = vertices[batch.first_vertex + j * 4 + k];
+					if (Vector2(v.position[0], v.position[1]).distance_to(pos) > 0.001 || Vector2(v.uv[0], v.uv[1]).distance_to(uv) > 0.0001)
+						bad_vertices++;
+				}
+
+				static const int quad_indices[6] = { 0, 1, 2, 0, 2, 3 };
+				for (int k = 0; k < 6; k++) {
+					if (indices[batch.first_index + j * 6 + k] != j * 4 + quad_indices[k])
+						bad_vertices++;
+				}
+			}
+		}
+	}
+
+	BenchCanvasBatchRender() {
+		items_drawn = 0;
+		draw_calls = 0;
+		bad_vertices = 0;
+		build_usec = 0;
+	}
+};
+
+#define BENCH_BATCH_ITEMS 20000
+#define BENCH_BATCH_TEXTURES 4
+#define BENCH_BATCH_RUN 100
+#define BENCH_BATCH_MATERIAL_EVERY 1000
+
+static bool test_render_canvas_batching() {
+
+	OS::get_singleton()->print("RasterizerCanvasBatcher, %d sprites, %d textures:\n", BENCH_BATCH_ITEMS, BENCH_BATCH_TEXTURES);
+
+	RasterizerCanvas *prev_canvas_render = VSG::canvas_render;
+	BenchCanvasBatchRender canvas_render;
+	VSG::canvas_render = &canvas_render;
+
+	VisualServerCanvas *canvas_server = memnew(VisualServerCanvas);
+
+	RID canvas = canvas_server->canvas_create();
+	RID root = canvas_server->canvas_item_create();
+	canvas_server->canvas_item_set_parent(root, canvas);
+
+	// sprite sheets of four 16x16 frames
+	RID textures[BENCH_BATCH_TEXTURES];
+	for (int i = 0; i < BENCH_BATCH_TEXTURES; i++) {
+		BenchCanvasBatcher::BenchTexture *texture = memnew(BenchCanvasBatcher::BenchTexture);
+		texture->size = Size2(64, 16);
+		texture->repeat = false;
+		textures[i] = canvas_render.batcher.texture_owner.make_rid(texture);
+	}
+
+	// only the material RID is looked at, any valid one will do
+	RID material = canvas_render.batcher.texture_owner.make_rid(memnew(BenchCanvasBatcher::BenchTexture));
+
+	// sprites share a texture in runs, a custom material breaks the run it is in
+	Vector<RID> items;
+	int expected_draw_calls = 0;
+	RID last_texture;
+
+	for (int i = 0; i < BENCH_BATCH_ITEMS; i++) {
+
+		RID texture = textures[(i / BENCH_BATCH_RUN) % BENCH_BATCH_TEXTURES];
+		bool custom = i % BENCH_BATCH_MATERIAL_EVERY == BENCH_BATCH_MATERIAL_EVERY / 2;
+
+		RID item = canvas_server->canvas_item_create();
+		canvas_server->canvas_item_set_parent(item, root);
+		canvas_server->canvas_item_set_draw_index(item, i);
+		canvas_server->canvas_item_add_texture_rect_region(item, Rect2(0, 0, 16, 16), texture, Rect2((i % 4) * 16, 0, 16, 16));
+		canvas_server->canvas_item_set_transform(item, Transform2D(0, Point2((i % 200) * 6, (i / 200) * 7)));
+		if (custom)
+			canvas_server->canvas_item_set_material(item, material);
+		items.push_back(item);
+
+		if (custom) {
+			expected_draw_calls++;
+			last_texture = RID();
+		} else if (texture != last_texture) {
+			expected_draw_calls++;
+			last_texture = texture;
+		}
+	}
+
+	VisualServerCanvas::Canvas *canvas_ptr = canvas_server->canvas_owner.get(canvas);
+	Rect2 clip_rect(0, 0, 1280, 720);
+	bool pass = true;
+
+	for (int batching = 0; batching < 2; batching++) {
+
+		canvas_render.batcher.set_enabled(batching);
+		canvas_render.build_usec = 0;
+		canvas_render.bad_vertices = 0;
+
+		for (int frame = 0; frame < BENCH_FRAMES; frame++) {
+
+			canvas_render.items_drawn = 0;
+			canvas_render.draw_calls = 0;
+			canvas_server->render_canvas(canvas_ptr, Transform2D(), NULL, NULL, clip_rect);
+		}
+
+		int expected = batching ? expected_draw_calls : BENCH_BATCH_ITEMS;
+
+		OS::get_singleton()->print("\tbatching %s: %d items, %d draw calls per frame\n", batching ? "on" : "off", canvas_render.items_drawn, canvas_render.draw_calls);
+		_print_time("build", canvas_render.build_usec, BENCH_FRAMES);
+
+		if (canvas_render.items_drawn != BENCH_BATCH_ITEMS || canvas_render.draw_calls != expected || canvas_render.bad_vertices) {
+			OS::get_singleton()->print("\texpected %d items, %d draw calls, got %d bad vertices\n", BENCH_BATCH_ITEMS, expected, canvas_render.bad_vertices);
+			pass = false;
+		}
+	}
+
+	for (int i = 0; i < items.size(); i++)
+		canvas_server->free(items[i]);
+	canvas_server->free(root);
+	canvas_server->free(canvas);
+	memdelete(canvas_server);
+
+	for (int i = 0; i < BENCH_BATCH_TEXTURES; i++) {
+		BenchCanvasBatcher::BenchTexture *texture = canvas_render.batcher.texture_owner.get(textures[i]);
+		canvas_render.batcher.texture_owner.free(textures[i]);
+		memdelete(texture);
+	}
+	BenchCanvasBatcher::BenchTexture *material_ptr = canvas_render.batcher.texture_owner.get(material);
+	canvas_render.batcher.texture_owner.free(material);
+	memdelete(material_ptr);
+
+	VSG::canvas_render = prev_canvas_render;
+
+	return pass;
+}
+
+// Same layout and sort keys as the GLES3 render list, which can not be used without a GL context.
+struct SortElement {
+	float depth;
+	uint64_t sort_key;
+};
+
+struct SortElementByKey {
+
+	_FORCE_INLINE_ bool operator()(const SortElement *A, const SortElement *B) const {
+		return A->sort_key < B->sort_key;
+	}
+};
+
+struct SortElementByDepth {
+
+	_FORCE_INLINE_ bool operator()(const SortElement *A, const SortElement *B) const {
+		return A->depth < B->depth;
+	}
+};
+
+#define BENCH_SORT_ELEMENTS 20000
+#define BENCH_SORT_ROUNDS 50
+
+static bool test_render_list_sort() {
+
+	OS::get_singleton()->print("Render list sort, %d elements:\n", BENCH_SORT_ELEMENTS);
+
+	uint64_t seed = 1;
+
+	Vector<SortElement> base_elements;
+	base_elements.resize(BENCH_SORT_ELEMENTS);
+	Vector<SortElement *> unsorted;
+	unsorted.resize(BENCH_SORT_ELEMENTS);
+
+	for (int i = 0; i < BENCH_SORT_ELEMENTS; i++) {
+
+		// priority, depth layer, material and geometry index, like RasterizerSceneGLES3::_add_geometry_with_material
+		SortElement &e = base_elements[i];
+		e.depth = (Math::rand_from_seed(&seed) % 100000) * 0.01 - 10.0;
+		e.sort_key = uint64_t(128) << 56;
+		e.sort_key |= uint64_t(Math::rand_from_seed(&seed) % 16) << 52;
+		e.sort_key |= uint64_t(Math::rand_from_seed(&seed) % 64) << 28;
+		e.sort_key |= uint64_t(Math::rand_from_seed(&seed) % 2048) << 8;
+		e.sort_key |= Math::rand_from_seed(&seed) % 4;
+		unsorted[i] = &e;
+	}
+
+	Vector<SortElement *> compare_sorted;
+	compare_sorted.resize(BENCH_SORT_ELEMENTS);
+	Vector<SortElement *> radix_sorted;
+	radix_sorted.resize(BENCH_SORT_ELEMENTS);
+
+	typedef RadixSort<SortElement *> ElementSort;
+	Vector<ElementSort::Item> items;
+	items.resize(BENCH_SORT_ELEMENTS);
+	Vector<ElementSort::Item> scratch;
+	scratch.resize(BENCH_SORT_ELEMENTS);
+
+	bool pass = true;
+
+	for (int by_depth = 0; by_depth < 2; by_depth++) {
+
+		uint64_t compare_usec = 0;
+		uint64_t radix_usec = 0;
+
+		for (int r = 0; r < BENCH_SORT_ROUNDS; r++) {
+
+			for (int i = 0; i < BENCH_SORT_ELEMENTS; i++) {
+				compare_sorted[i] = unsorted[i];
+			}
+
+			uint64_t t = OS::get_singleton()->get_ticks_usec();
+			if (by_depth) {
+				SortArray<SortElement *, SortElementByDepth> sorter;
+				sorter.sort(compare_sorted.ptrw(), BENCH_SORT_ELEMENTS);
+			} else {
+				SortArray<SortElement *, SortElementByKey> sorter;
+				sorter.sort(compare_sorted.ptrw(), BENCH_SORT_ELEMENTS);
+			}
+			compare_usec += OS::get_singleton()->get_ticks_usec() - t;
+
+			for (int i = 0; i < BENCH_SORT_ELEMENTS; i++) {
+				radix_sorted[i] = unsorted[i];
+			}
+
+			t = OS::get_singleton()->get_ticks_usec();
+			{
+				SortElement **elements = radix_sorted.ptrw();
+				ElementSort::Item *item_ptr = items.ptrw();
+				for (int i = 0; i < BENCH_SORT_ELEMENTS; i++) {
+					item_ptr[i].key = by_depth ? ElementSort::float_key(elements[i]->depth) : elements[i]->sort_key;
+					item_ptr[i].value = elements[i];
+				}
+				ElementSort sorter;
+				sorter.sort(item_ptr, scratch.ptrw(), BENCH_SORT_ELEMENTS);
+				for (int i = 0; i < BENCH_SORT_ELEMENTS; i++) {
+					elements[i] = item_ptr[i].value;
+				}
+			}
+			radix_usec += OS::get_singleton()->get_ticks_usec() - t;
+		}
+
+		// both sorts must give the same order of keys, the radix sort is also stable
+		for (int i = 0; i < BENCH_SORT_ELEMENTS; i++) {
+
+			if (by_depth ? compare_sorted[i]->depth != radix_sorted[i]->depth : compare_sorted[i]->sort_key != radix_sorted[i]->sort_key) {
+				OS::get_singleton()->print("\tsort mismatch at %d\n", i);
+				pass = false;
+				break;
+			}
+
+			if (i > 0 && (by_depth ? radix_sorted[i - 1]->depth == radix_sorted[i]->depth : radix_sorted[i - 1]->sort_key == radix_sorted[i]->sort_key) && radix_sorted[i - 1] > radix_sorted[i]) {
+				OS::get_singleton()->print("\tradix sort not stable at %d\n", i);
+				pass = false;
+				break;
+			}
+		}
+
+		_print_time(by_depth ? "SortArray by depth" : "SortArray by key", compare_usec, BENCH_SORT_ROUNDS);
+		_print_time(by_depth ? "RadixSort by depth" : "RadixSort by key", radix_usec, BENCH_SORT_ROUNDS);
+	}
+
+	return pass;
+}
+
+#ifndef SERVER_ENABLED //gles3 is not built for the server platform
+
+// What RasterizerStorageGLES3::_update_shader keeps from a spatial shader.
+struct BenchShader {
+
+	int blend_mode;
+	int cull_mode;
+	bool unshaded;
+	bool uses_alpha;
+	bool uses_vertex;
+	Map<StringName, ShaderLanguage::ShaderNode::Uniform> uniforms;
+	ShaderCompilerGLES3::GeneratedCode gen_code;
+
+	bool compile(ShaderCompilerGLES3 &p_compiler, const String &p_code) {
+
+		ShaderCompilerGLES3::IdentifierActions actions;
+		actions.render_mode_values["blend_mix"] = Pair<int *, int>(&blend_mode, 0);
+		actions.render_mode_values["blend_add"] = Pair<int *, int>(&blend_mode, 1);
+		actions.render_mode_values["cull_disabled"] = Pair<int *, int>(&cull_mode, 2);
+		actions.render_mode_flags["unshaded"] = &unshaded;
+		actions.usage_flag_pointers["ALPHA"] = &uses_alpha;
+		actions.write_flag_pointers["VERTEX"] = &uses_vertex;
+		actions.uniforms = &uniforms;
+
+		return p_compiler.compile(VS::SHADER_SPATIAL, p_code, &actions, "res://bench.shader", gen_code) == OK;
+	}
+
+	bool matches(const BenchShader &p_other) const {
+
+		if (blend_mode != p_other.blend_mode || cull_mode != p_other.cull_mode || unshaded != p_other.unshaded || uses_alpha != p_other.uses_alpha || uses_vertex != p_other.uses_vertex)
+			return false;
+		if (uniforms.size() != p_other.uniforms.size() || gen_code.texture_uniforms.size() != p_other.gen_code.texture_uniforms.size() || gen_code.defines.size() != p_other.gen_code.defines.size())
+			return false;
+		if (gen_code.uniform_total_size != p_other.gen_code.uniform_total_size || gen_code.uniforms != p_other.gen_code.uniforms)
+			return false;
+		return gen_code.vertex == p_other.gen_code.vertex && gen_code.fragment == p_other.gen_code.fragment && gen_code.fragment_global == p_other.gen_code.fragment_global;
+	}
+
+	BenchShader() {
+
+		blend_mode = -1;
+		cull_mode = 0;
+		unshaded = false;
+		uses_alpha = false;
+		uses_vertex = false;
+	}
+};
+
+static String _bench_shader_code(int p_variant) {
+
+	String code = "shader_type spatial;\n";
+	code += String("render_mode ") + (p_variant & 1 ? "blend_add" : "blend_mix") + (p_variant & 2 ? ", unshaded" : "") + (p_variant & 4 ? ", cull_disabled" : "") + ";\n";
+	code += "uniform vec4 tint : hint_color;\n";
+	code += "uniform float amount = " + itos(p_variant) + ".0;\n";
+	code += "uniform sampler2D albedo_tex : hint_albedo;\n";
+	code += "void vertex() {\n\tVERTEX += NORMAL * amount * 0.01;\n}\n";
+	code += "void fragment() {\n\tvec4 c = texture(albedo_tex, UV) * tint;\n\tALBEDO = c.rgb;\n";
+	if (p_variant & 1) {
+		code += "\tALPHA = c.a;\n";
+	}
+	code += "}\n";
+	return code;
+}
+
+static bool test_render_shader_cache() {
+
+	OS::get_singleton()->print("ShaderCompilerGLES3 compile cache, %d materials, %d distinct shaders:\n", BENCH_SHADER_MATERIALS, BENCH_SHADER_VARIANTS);
+
+	// every material compiles its own shader, most of them sharing the code of another
+	BenchShader expected[BENCH_SHADER_VARIANTS];
+	bool pass = true;
+
+	ShaderCompilerGLES3 uncached_compiler;
+	uint64_t uncached_usec = 0;
+
+	for (int i = 0; i < BENCH_SHADER_MATERIALS; i++) {
+
+		int variant = i % BENCH_SHADER_VARIANTS;
+		String code = _bench_shader_code(variant);
+		BenchShader shader;
+
+		uint64_t t = OS::get_singleton()->get_ticks_usec();
+		uncached_compiler.clear_cache();
+		bool ok = shader.compile(uncached_compiler, code);
+		uncached_usec += OS::get_singleton()->get_ticks_usec() - t;
+
+		if (!ok) {
+			OS::get_singleton()->print("\tshader variant %d failed to compile\n", variant);
+			return false;
+		}
+
+		if (i < BENCH_SHADER_VARIANTS) {
+			expected[variant] = shader;
+		}
+	}
+
+	ShaderCompilerGLES3 compiler;
+	uint64_t cached_usec = 0;
+
+	for (int i = 0; i < BENCH_SHADER_MATERIALS; i++) {
+
+		int variant = i % BENCH_SHADER_VARIANTS;
+		String code = _bench_shader_code(variant);
+		BenchShader shader;
+
+		uint64_t t = OS::get_singleton()->get_ticks_usec();
+		bool ok = shader.compile(compiler, code);
+		cached_usec += OS::get_singleton()->get_ticks_usec() - t;
+
+		if (!ok || !shader.matches(expected[variant])) {
+			OS::get_singleton()->print("\tmaterial %d: shader variant %d differs from a fresh compile\n", i, variant);
+			pass = false;
+		}
+	}
+
+	OS::get_singleton()->print("\t%d cache hits, %d cache misses\n", (int)compiler.get_cache_hits(), (int)compiler.get_cache_misses());
+	_print_time("compile without cache", uncached_usec, BENCH_SHADER_MATERIALS);
+	_print_time("compile with cache", cached_usec, BENCH_SHADER_MATERIALS);
+
+	if (compiler.get_cache_misses() != BENCH_SHADER_VARIANTS || compiler.get_cache_hits() != BENCH_SHADER_MATERIALS - BENCH_SHADER_VARIANTS) {
+		pass = false;
+	}
+
+	return pass && expected[1].blend_mode == 1 && expected[1].uses_alpha && expected[2].unshaded && expected[4].cull_mode == 2 && expected[0].uses_vertex;
+}
+
+#endif
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+
+	test_render_scene_cull,
+	test_render_scene_dirty,
+	test_render_scene_lod,
+	test_render_scene_lod_views,
+	test_render_scene_rooms,
+	test_render_scene_occlusion,
+	test_render_list_sort,
+	test_render_canvas_cull,
+	test_render_canvas_batching,
+#ifndef SERVER_ENABLED
+	test_render_shader_cache,
+#endif
+	0
+};
+
+MainLoop *test() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+} // namespace TestRenderBench
@@ -46,6 +46,8 @@ AreaBullet::AreaBullet() :
 		RigidCollisionObjectBullet(CollisionObjectBullet::TYPE_AREA),
 		monitorable(true),
 		isScratched(false),
+		monitorBatching(false),
+		isDispatching(false),
 		spOv_mode(PhysicsServer::AREA_SPACE_OVERRIDE_DISABLED),
 		spOv_gravityPoint(false),
 		spOv_gravityPointDistanceScale(0),
@@ -77,6 +79,7 @@ void AreaBullet::dispatch_callbacks() {
 	if (!isScratched)
 		return;
 	isScratched = false;
+	isDispatching = true;
 
 	// Reverse order because I've to remove EXIT objects
 	for (int i = overlappingObjects.size() - 1; 0 <= i; --i) {
@@ -95,11 +98,33 @@ void AreaBullet::dispatch_callbacks() {
 				break;
 		}
 	}
+
+	isDispatching = false;
+
+	if (monitorBatching) {
+		send_batched_events(0);
+		send_batched_events(1);
+	}
 }
 
 void AreaBullet::call_event(CollisionObjectBullet *p_otherObject, PhysicsServer::AreaBodyStatus p_status) {
 
-	InOutEventCallback &event = eventsCallbacks[static_cast<int>(p_otherObject->getType())];
+	int callback = static_cast<int>(p_otherObject->getType());
+
+	if (monitorBatching) {
+
+		Vector<int> &events = batchedEvents[callback];
+		events.push_back(p_status);
+		events.push_back(p_otherObject->get_instance_id());
+		events.push_back(0); // other_body_shape ID
+		events.push_back(0); // self_shape ID
+
+		if (!isDispatching)
+			send_batched_events(callback);
+		return;
+	}
+
+	InOutEventCallback &event = eventsCallbacks[callback];
 	Object *areaGodoObject = ObjectDB::get_instance(event.event_callback_id);
 
 	if (!areaGodoObject) {
@@ -117,6 +142,35 @@ void AreaBullet::call_event(CollisionObjectBullet *p_otherObject, PhysicsServer:
 	areaGodoObject->call(event.event_callback_method, (const Variant **)call_event_res_ptr, 5, outResp);
 }
 
+void AreaBullet::send_batched_events(int p_callback) {
+
+	Vector<int> &events = batchedEvents[p_callback];
+	if (events.empty())
+		return;
+
+	InOutEventCallback &event = eventsCallbacks[p_callback];
+	Object *areaGodoObject = ObjectDB::get_instance(event.event_callback_id);
+
+	if (!areaGodoObject) {
+		event.event_callback_id = 0;
+		events.clear();
+		return;
+	}
+
+	PoolVector<int> packed;
+	packed.resize(events.size());
+	{
+		PoolVector<int>::Write w = packed.write();
+		copymem(w.ptr(), events.ptr(), events.size() * sizeof(int));
+	}
+	events.clear();
+
+	Variant arg = packed;
+	const Variant *argptr = &arg;
+	Variant::CallError outResp;
+	areaGodoObject->call(event.event_callback_method, &argptr, 1, outResp);
+}
+
 void AreaBullet::scratch() {
 	if (isScratched)
 		return;
@@ -281,6 +335,12 @@ bool AreaBullet::has_event_callback(Type p_callbackObjectType) {
 	return eventsCallbacks[static_cast<int>(p_callbackObjectType)].event_callback_id;
 }
 
+void AreaBullet::set_monitor_batching(bool p_enable) {
+	monitorBatching = p_enable;
+	batchedEvents[0].clear();
+	batchedEvents[1].clear();
+}
+
 void AreaBullet::on_enter_area(AreaBullet *p_area) {
 }
 
@@ -103,6 +103,13 @@ private:
 
 	InOutEventCallback eventsCallbacks[2];
 
+	// With batching the events of a dispatch are collected per callback and sent as one PoolIntArray
+	bool monitorBatching;
+	bool isDispatching;
+	Vector<int> batchedEvents[2];
+
+	void send_batched_events(int p_callback);
+
 public:
 	AreaBullet();
 	~AreaBullet();
@@ -167,6 +174,8 @@ public:
 	void set_event_callback(Type p_callbackObjectType, ObjectID p_id, const StringName &p_method);
 	bool has_event_callback(Type p_callbackObjectType);
 
+	void set_monitor_batching(bool p_enable);
+
 	virtual void on_enter_area(AreaBullet *p_area);
 	virtual void on_exit_area(AreaBullet *p_area);
 };
@@ -36,8 +36,10 @@
 #include "core/error_macros.h"
 #include "core/ustring.h"
 #include "generic_6dof_joint_bullet.h"
+#include "godot_task_scheduler.h"
 #include "hinge_joint_bullet.h"
 #include "pin_joint_bullet.h"
+#include "servers/physics_work_pool.h"
 #include "shape_bullet.h"
 #include "slider_joint_bullet.h"
 
@@ -87,7 +89,8 @@ void BulletPhysicsServer::_bind_methods() {
 BulletPhysicsServer::BulletPhysicsServer() :
 		PhysicsServer(),
 		active(true),
-		active_spaces_count(0) {}
+		active_spaces_count(0),
+		task_scheduler(NULL) {}
 
 BulletPhysicsServer::~BulletPhysicsServer() {
 	bulletdelete(emptyShape);
@@ -234,6 +237,24 @@ int BulletPhysicsServer::space_get_contact_count(RID p_space) const {
 	return space->get_debug_contact_count();
 }
 
+int BulletPhysicsServer::space_get_active_transforms(RID p_space, const ActiveTransform **r_transforms) const {
+	SpaceBullet *space = space_owner.get(p_space);
+	ERR_FAIL_COND_V(!space, 0);
+
+	*r_transforms = space->get_active_transforms().ptr();
+	return space->get_active_transform_count();
+}
+
+PoolVector<uint8_t> BulletPhysicsServer::space_save_state(RID p_space) const {
+	WARN_PRINT("Not supported by bullet");
+	return PoolVector<uint8_t>();
+}
+
+Error BulletPhysicsServer::space_restore_state(RID p_space, const PoolVector<uint8_t> &p_state) {
+	WARN_PRINT("Not supported by bullet");
+	return ERR_UNAVAILABLE;
+}
+
 RID BulletPhysicsServer::area_create() {
 	AreaBullet *area = bulletnew(AreaBullet);
 	area->set_collision_layer(1);
@@ -430,6 +451,13 @@ void BulletPhysicsServer::area_set_area_monitor_callback(RID p_area, Object *p_r
 	area->set_event_callback(CollisionObjectBullet::TYPE_AREA, p_receiver ? p_receiver->get_instance_id() : 0, p_method);
 }
 
+void BulletPhysicsServer::area_set_monitor_batching(RID p_area, bool p_enable) {
+	AreaBullet *area = area_owner.get(p_area);
+	ERR_FAIL_COND(!area);
+
+	area->set_monitor_batching(p_enable);
+}
+
 void BulletPhysicsServer::area_set_ray_pickable(RID p_area, bool p_enable) {
 	AreaBullet *area = area_owner.get(p_area);
 	ERR_FAIL_COND(!area);
@@ -1320,6 +1348,17 @@ void BulletPhysicsServer::free(RID p_rid) {
 
 void BulletPhysicsServer::init() {
 	BulletPhysicsDirectBodyState::initSingleton();
+
+#if BT_THREADSAFE
+	// the multithreaded world runs on the physics pool, a single thread keeps the single threaded world
+	ThreadWorkPool *work_pool = PhysicsWorkPool::acquire();
+	if (work_pool->get_thread_count() > 1) {
+		task_scheduler = memnew(GodotTaskScheduler(work_pool));
+		btSetTaskScheduler(task_scheduler);
+	} else {
+		PhysicsWorkPool::release();
+	}
+#endif
 }
 
 void BulletPhysicsServer::step(float p_deltaTime) {
@@ -1340,8 +1379,18 @@ void BulletPhysicsServer::sync() {
 void BulletPhysicsServer::flush_queries() {
 }
 
+void BulletPhysicsServer::end_sync() {
+}
+
 void BulletPhysicsServer::finish() {
 	BulletPhysicsDirectBodyState::destroySingleton();
+
+	if (task_scheduler) {
+		btSetTaskScheduler(NULL);
+		memdelete(task_scheduler);
+		task_scheduler = NULL;
+		PhysicsWorkPool::release();
+	}
 }
 
 int BulletPhysicsServer::get_process_info(ProcessInfo p_info) {
@@ -40,6 +40,8 @@
 #include "soft_body_bullet.h"
 #include "space_bullet.h"
 
+class GodotTaskScheduler;
+
 /**
 	@author AndreaCatania
 */
@@ -53,6 +55,8 @@ class BulletPhysicsServer : public PhysicsServer {
 	char active_spaces_count;
 	Vector<SpaceBullet *> active_spaces;
 
+	GodotTaskScheduler *task_scheduler;
+
 	mutable RID_Owner<SpaceBullet> space_owner;
 	mutable RID_Owner<ShapeBullet> shape_owner;
 	mutable RID_Owner<AreaBullet> area_owner;
@@ -120,6 +124,10 @@ public:
 	virtual void space_set_debug_contacts(RID p_space, int p_max_contacts);
 	virtual Vector<Vector3> space_get_contacts(RID p_space) const;
 	virtual int space_get_contact_count(RID p_space) const;
+	virtual int space_get_active_transforms(RID p_space, const ActiveTransform **r_transforms) const;
+
+	virtual PoolVector<uint8_t> space_save_state(RID p_space) const;
+	virtual Error space_restore_state(RID p_space, const PoolVector<uint8_t> &p_state);
 
 	/* AREA API */
 
@@ -165,6 +173,7 @@ public:
 	virtual void area_set_monitorable(RID p_area, bool p_monitorable);
 	virtual void area_set_monitor_callback(RID p_area, Object *p_receiver, const StringName &p_method);
 	virtual void area_set_area_monitor_callback(RID p_area, Object *p_receiver, const StringName &p_method);
+	virtual void area_set_monitor_batching(RID p_area, bool p_enable);
 	virtual void area_set_ray_pickable(RID p_area, bool p_enable);
 	virtual bool area_is_ray_pickable(RID p_area) const;
 
@@ -351,6 +360,7 @@ public:
 	virtual void step(float p_deltaTime);
 	virtual void sync();
 	virtual void flush_queries();
+	virtual void end_sync();
 	virtual void finish();
 
 	virtual int get_process_info(ProcessInfo p_info);
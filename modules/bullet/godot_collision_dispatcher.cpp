@@ -38,8 +38,9 @@
 
 const int GodotCollisionDispatcher::CASTED_TYPE_AREA = static_cast<int>(CollisionObjectBullet::TYPE_AREA);
 
-GodotCollisionDispatcher::GodotCollisionDispatcher(btCollisionConfiguration *collisionConfiguration) :
-		btCollisionDispatcher(collisionConfiguration) {}
+GodotCollisionDispatcher::GodotCollisionDispatcher(btCollisionConfiguration *collisionConfiguration, bool p_multithreaded) :
+		btCollisionDispatcherMt(collisionConfiguration),
+		multithreaded(p_multithreaded) {}
 
 bool GodotCollisionDispatcher::needsCollision(const btCollisionObject *body0, const btCollisionObject *body1) {
 	if (body0->getUserIndex() == CASTED_TYPE_AREA || body1->getUserIndex() == CASTED_TYPE_AREA) {
@@ -56,3 +57,11 @@ bool GodotCollisionDispatcher::needsResponse(const btCollisionObject *body0, con
 	}
 	return btCollisionDispatcher::needsResponse(body0, body1);
 }
+
+void GodotCollisionDispatcher::dispatchAllCollisionPairs(btOverlappingPairCache *pairCache, const btDispatcherInfo &dispatchInfo, btDispatcher *dispatcher) {
+	if (multithreaded) {
+		btCollisionDispatcherMt::dispatchAllCollisionPairs(pairCache, dispatchInfo, dispatcher);
+	} else {
+		btCollisionDispatcher::dispatchAllCollisionPairs(pairCache, dispatchInfo, dispatcher);
+	}
+}
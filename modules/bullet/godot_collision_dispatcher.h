@@ -33,6 +33,7 @@
 
 #include "int_types.h"
 
+#include <BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
 #include <btBulletDynamicsCommon.h>
 
 /**
@@ -40,13 +41,17 @@
 */
 
 /// This class is required to implement custom collision behaviour in the narrowphase
-class GodotCollisionDispatcher : public btCollisionDispatcher {
+/// When multithreaded, the narrowphase pairs are dispatched on the Bullet task scheduler
+class GodotCollisionDispatcher : public btCollisionDispatcherMt {
 private:
 	static const int CASTED_TYPE_AREA;
 
+	bool multithreaded;
+
 public:
-	GodotCollisionDispatcher(btCollisionConfiguration *collisionConfiguration);
+	GodotCollisionDispatcher(btCollisionConfiguration *collisionConfiguration, bool p_multithreaded = false);
 	virtual bool needsCollision(const btCollisionObject *body0, const btCollisionObject *body1);
 	virtual bool needsResponse(const btCollisionObject *body0, const btCollisionObject *body1);
+	virtual void dispatchAllCollisionPairs(btOverlappingPairCache *pairCache, const btDispatcherInfo &dispatchInfo, btDispatcher *dispatcher);
 };
 #endif
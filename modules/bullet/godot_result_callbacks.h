@@ -52,12 +52,12 @@ struct GodotFilterCallback : public btOverlapFilterCallback {
 
 /// It performs an additional check allow exclusions.
 struct GodotClosestRayResultCallback : public btCollisionWorld::ClosestRayResultCallback {
-	const Set<RID> *m_exclude;
+	const PhysicsQueryExclude *m_exclude;
 	bool m_pickRay;
 	int m_shapeId;
 
 public:
-	GodotClosestRayResultCallback(const btVector3 &rayFromWorld, const btVector3 &rayToWorld, const Set<RID> *p_exclude) :
+	GodotClosestRayResultCallback(const btVector3 &rayFromWorld, const btVector3 &rayToWorld, const PhysicsQueryExclude *p_exclude) :
 			btCollisionWorld::ClosestRayResultCallback(rayFromWorld, rayToWorld),
 			m_exclude(p_exclude),
 			m_pickRay(false),
@@ -77,9 +77,9 @@ public:
 	PhysicsDirectSpaceState::ShapeResult *m_results;
 	int m_resultMax;
 	int count;
-	const Set<RID> *m_exclude;
+	const PhysicsQueryExclude *m_exclude;
 
-	GodotAllConvexResultCallback(PhysicsDirectSpaceState::ShapeResult *p_results, int p_resultMax, const Set<RID> *p_exclude) :
+	GodotAllConvexResultCallback(PhysicsDirectSpaceState::ShapeResult *p_results, int p_resultMax, const PhysicsQueryExclude *p_exclude) :
 			m_results(p_results),
 			m_exclude(p_exclude),
 			m_resultMax(p_resultMax),
@@ -105,10 +105,10 @@ public:
 
 struct GodotClosestConvexResultCallback : public btCollisionWorld::ClosestConvexResultCallback {
 public:
-	const Set<RID> *m_exclude;
+	const PhysicsQueryExclude *m_exclude;
 	int m_shapeId;
 
-	GodotClosestConvexResultCallback(const btVector3 &convexFromWorld, const btVector3 &convexToWorld, const Set<RID> *p_exclude) :
+	GodotClosestConvexResultCallback(const btVector3 &convexFromWorld, const btVector3 &convexToWorld, const PhysicsQueryExclude *p_exclude) :
 			btCollisionWorld::ClosestConvexResultCallback(convexFromWorld, convexToWorld),
 			m_exclude(p_exclude) {}
 
@@ -123,9 +123,9 @@ public:
 	PhysicsDirectSpaceState::ShapeResult *m_results;
 	int m_resultMax;
 	int m_count;
-	const Set<RID> *m_exclude;
+	const PhysicsQueryExclude *m_exclude;
 
-	GodotAllContactResultCallback(btCollisionObject *p_self_object, PhysicsDirectSpaceState::ShapeResult *p_results, int p_resultMax, const Set<RID> *p_exclude) :
+	GodotAllContactResultCallback(btCollisionObject *p_self_object, PhysicsDirectSpaceState::ShapeResult *p_results, int p_resultMax, const PhysicsQueryExclude *p_exclude) :
 			m_self_object(p_self_object),
 			m_results(p_results),
 			m_exclude(p_exclude),
@@ -144,9 +144,9 @@ public:
 	Vector3 *m_results;
 	int m_resultMax;
 	int m_count;
-	const Set<RID> *m_exclude;
+	const PhysicsQueryExclude *m_exclude;
 
-	GodotContactPairContactResultCallback(btCollisionObject *p_self_object, Vector3 *p_results, int p_resultMax, const Set<RID> *p_exclude) :
+	GodotContactPairContactResultCallback(btCollisionObject *p_self_object, Vector3 *p_results, int p_resultMax, const PhysicsQueryExclude *p_exclude) :
 			m_self_object(p_self_object),
 			m_results(p_results),
 			m_exclude(p_exclude),
@@ -166,9 +166,9 @@ public:
 	real_t m_min_distance;
 	const btCollisionObject *m_rest_info_collision_object;
 	btVector3 m_rest_info_bt_point;
-	const Set<RID> *m_exclude;
+	const PhysicsQueryExclude *m_exclude;
 
-	GodotRestInfoContactResultCallback(btCollisionObject *p_self_object, PhysicsDirectSpaceState::ShapeRestInfo *p_result, const Set<RID> *p_exclude) :
+	GodotRestInfoContactResultCallback(btCollisionObject *p_self_object, PhysicsDirectSpaceState::ShapeRestInfo *p_result, const PhysicsQueryExclude *p_exclude) :
 			m_self_object(p_self_object),
 			m_result(p_result),
 			m_exclude(p_exclude),
@@ -0,0 +1,78 @@
+/*************************************************************************/
+/*  godot_task_scheduler.cpp                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "godot_task_scheduler.h"
+
+void GodotTaskScheduler::_run_chunk(uint32_t p_index, Job *p_job) {
+
+	int begin = p_job->begin + int(p_index) * p_job->grain_size;
+	p_job->body->forLoop(begin, MIN(begin + p_job->grain_size, p_job->end));
+}
+
+int GodotTaskScheduler::getMaxNumThreads() const {
+
+	return BT_MAX_THREAD_COUNT;
+}
+
+int GodotTaskScheduler::getNumThreads() const {
+
+	return MIN(work_pool->get_thread_count(), (int)BT_MAX_THREAD_COUNT);
+}
+
+void GodotTaskScheduler::setNumThreads(int p_num_threads) {
+
+	// the pool is shared with the other physics servers, it can't be resized from here
+}
+
+void GodotTaskScheduler::parallelFor(int p_begin, int p_end, int p_grain_size, const btIParallelForBody &p_body) {
+
+	p_grain_size = MAX(p_grain_size, 1);
+
+	int chunks = (p_end - p_begin + p_grain_size - 1) / p_grain_size;
+	if (chunks < 2) {
+		p_body.forLoop(p_begin, p_end);
+		return;
+	}
+
+	Job job;
+	job.body = &p_body;
+	job.begin = p_begin;
+	job.end = p_end;
+	job.grain_size = p_grain_size;
+
+	// nested calls run serially on the caller, ThreadWorkPool handles that
+	work_pool->do_work(chunks, this, &GodotTaskScheduler::_run_chunk, &job);
+}
+
+GodotTaskScheduler::GodotTaskScheduler(ThreadWorkPool *p_work_pool) :
+		btITaskScheduler("Godot") {
+
+	work_pool = p_work_pool;
+}
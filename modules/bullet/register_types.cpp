@@ -32,13 +32,14 @@
 
 #include "bullet_physics_server.h"
 #include "class_db.h"
+#include "servers/physics/physics_server_wrap_mt.h"
 
 /**
 	@author AndreaCatania
 */
 
 PhysicsServer *_createBulletPhysicsCallback() {
-	return memnew(BulletPhysicsServer);
+	return PhysicsServerWrapMT::init_server<BulletPhysicsServer>();
 }
 
 void register_bullet_types() {
@@ -255,7 +255,8 @@ RigidBodyBullet::RigidBodyBullet() :
 		maxAreasWhereIam(10),
 		areaWhereIamCount(0),
 		countGravityPointSpaces(0),
-		isScratchedSpaceOverrideModificator(false) {
+		isScratchedSpaceOverrideModificator(false),
+		active_list(this) {
 
 	godotMotionState = bulletnew(GodotMotionState(this));
 
@@ -307,6 +308,7 @@ void RigidBodyBullet::set_space(SpaceBullet *p_space) {
 	// Clear the old space if there is one
 	if (space) {
 		isTransformChanged = false;
+		active_list.remove_from_list();
 
 		// Remove all eventual constraints
 		assert_no_constraints();
@@ -372,10 +374,14 @@ void RigidBodyBullet::set_force_integration_callback(ObjectID p_id, const String
 
 void RigidBodyBullet::scratch() {
 	isTransformChanged = true;
+	if (space)
+		space->body_add_to_active_list(&active_list);
 }
 
 void RigidBodyBullet::scratch_space_override_modificator() {
 	isScratchedSpaceOverrideModificator = true;
+	if (space)
+		space->body_add_to_active_list(&active_list);
 }
 
 void RigidBodyBullet::on_collision_filters_change() {
@@ -213,6 +213,8 @@ private:
 	bool isTransformChanged;
 	bool previousActiveState; // Last check state
 
+	SelfList<RigidBodyBullet> active_list;
+
 	ForceIntegrationCallback *force_integration_callback;
 
 public:
@@ -232,6 +234,8 @@ public:
 	void set_force_integration_callback(ObjectID p_id, const StringName &p_method, const Variant &p_udata = Variant());
 	void scratch();
 	void scratch_space_override_modificator();
+	/// True while the body has to be dispatched every flush, even if it didn't move
+	_FORCE_INLINE_ bool needs_dispatch() const { return btBody->isActive() || 0 < countGravityPointSpaces; }
 
 	virtual void on_collision_filters_change();
 	virtual void on_collision_checker_start();
@@ -46,6 +46,7 @@
 #include <BulletCollision/NarrowPhaseCollision/btGjkEpaPenetrationDepthSolver.h>
 #include <BulletCollision/NarrowPhaseCollision/btGjkPairDetector.h>
 #include <BulletCollision/NarrowPhaseCollision/btPointCollector.h>
+#include <BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
 #include <BulletSoftBody/btSoftBodyRigidBodyCollisionConfiguration.h>
 #include <BulletSoftBody/btSoftRigidDynamicsWorld.h>
 #include <btBulletDynamicsCommon.h>
@@ -60,7 +61,7 @@ BulletPhysicsDirectSpaceState::BulletPhysicsDirectSpaceState(SpaceBullet *p_spac
 		PhysicsDirectSpaceState(),
 		space(p_space) {}
 
-int BulletPhysicsDirectSpaceState::intersect_point(const Vector3 &p_point, ShapeResult *r_results, int p_result_max, const Set<RID> &p_exclude, uint32_t p_collision_mask) {
+int BulletPhysicsDirectSpaceState::intersect_point(const Vector3 &p_point, ShapeResult *r_results, int p_result_max, const PhysicsQueryExclude &p_exclude, uint32_t p_collision_mask) {
 
 	if (p_result_max <= 0)
 		return 0;
@@ -83,7 +84,7 @@ int BulletPhysicsDirectSpaceState::intersect_point(const Vector3 &p_point, Shape
 	return btResult.m_count;
 }
 
-bool BulletPhysicsDirectSpaceState::intersect_ray(const Vector3 &p_from, const Vector3 &p_to, RayResult &r_result, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_pick_ray) {
+bool BulletPhysicsDirectSpaceState::intersect_ray(const Vector3 &p_from, const Vector3 &p_to, RayResult &r_result, const PhysicsQueryExclude &p_exclude, uint32_t p_collision_mask, bool p_pick_ray) {
 
 	btVector3 btVec_from;
 	btVector3 btVec_to;
@@ -116,7 +117,7 @@ bool BulletPhysicsDirectSpaceState::intersect_ray(const Vector3 &p_from, const V
 	}
 }
 
-int BulletPhysicsDirectSpaceState::intersect_shape(const RID &p_shape, const Transform &p_xform, float p_margin, ShapeResult *r_results, int p_result_max, const Set<RID> &p_exclude, uint32_t p_collision_mask) {
+int BulletPhysicsDirectSpaceState::intersect_shape(const RID &p_shape, const Transform &p_xform, float p_margin, ShapeResult *r_results, int p_result_max, const PhysicsQueryExclude &p_exclude, uint32_t p_collision_mask) {
 	if (p_result_max <= 0)
 		return 0;
 
@@ -149,7 +150,7 @@ int BulletPhysicsDirectSpaceState::intersect_shape(const RID &p_shape, const Tra
 	return btQuery.m_count;
 }
 
-bool BulletPhysicsDirectSpaceState::cast_motion(const RID &p_shape, const Transform &p_xform, const Vector3 &p_motion, float p_margin, float &p_closest_safe, float &p_closest_unsafe, const Set<RID> &p_exclude, uint32_t p_collision_mask, ShapeRestInfo *r_info) {
+bool BulletPhysicsDirectSpaceState::cast_motion(const RID &p_shape, const Transform &p_xform, const Vector3 &p_motion, float p_margin, float &p_closest_safe, float &p_closest_unsafe, const PhysicsQueryExclude &p_exclude, uint32_t p_collision_mask, ShapeRestInfo *r_info) {
 	ShapeBullet *shape = space->get_physics_server()->get_shape_owner()->get(p_shape);
 
 	btCollisionShape *btShape = shape->create_bt_shape(p_xform.basis.get_scale(), p_margin);
@@ -196,7 +197,7 @@ bool BulletPhysicsDirectSpaceState::cast_motion(const RID &p_shape, const Transf
 }
 
 /// Returns the list of contacts pairs in this order: Local contact, other body contact
-bool BulletPhysicsDirectSpaceState::collide_shape(RID p_shape, const Transform &p_shape_xform, float p_margin, Vector3 *r_results, int p_result_max, int &r_result_count, const Set<RID> &p_exclude, uint32_t p_collision_mask) {
+bool BulletPhysicsDirectSpaceState::collide_shape(RID p_shape, const Transform &p_shape_xform, float p_margin, Vector3 *r_results, int p_result_max, int &r_result_count, const PhysicsQueryExclude &p_exclude, uint32_t p_collision_mask) {
 	if (p_result_max <= 0)
 		return 0;
 
@@ -230,7 +231,7 @@ bool BulletPhysicsDirectSpaceState::collide_shape(RID p_shape, const Transform &
 	return btQuery.m_count;
 }
 
-bool BulletPhysicsDirectSpaceState::rest_info(RID p_shape, const Transform &p_shape_xform, float p_margin, ShapeRestInfo *r_info, const Set<RID> &p_exclude, uint32_t p_collision_mask) {
+bool BulletPhysicsDirectSpaceState::rest_info(RID p_shape, const Transform &p_shape_xform, float p_margin, ShapeRestInfo *r_info, const PhysicsQueryExclude &p_exclude, uint32_t p_collision_mask) {
 
 	ShapeBullet *shape = space->get_physics_server()->get_shape_owner()->get(p_shape);
 
@@ -336,21 +337,71 @@ SpaceBullet::SpaceBullet(bool p_create_soft_world) :
 		godotFilterCallback(NULL),
 		gravityDirection(0, -1, 0),
 		gravityMagnitude(10),
-		contactDebugCount(0) {
+		contactDebugCount(0),
+		active_transform_count(0) {
 
 	create_empty_world(p_create_soft_world);
 	direct_access = memnew(BulletPhysicsDirectSpaceState(this));
 }
 
 SpaceBullet::~SpaceBullet() {
+	while (active_body_list.first()) {
+		active_body_list.remove(active_body_list.first());
+	}
+
 	memdelete(direct_access);
 	destroy_world();
 }
 
 void SpaceBullet::flush_queries() {
-	const btCollisionObjectArray &colObjArray = dynamicsWorld->getCollisionObjectArray();
-	for (int i = colObjArray.size() - 1; 0 <= i; --i) {
-		static_cast<CollisionObjectBullet *>(colObjArray[i]->getUserPointer())->dispatch_callbacks();
+	active_transform_count = 0;
+
+	// Areas first, entering or leaving them can queue bodies for the space override update
+	for (int i = areas.size() - 1; 0 <= i; --i) {
+		areas[i]->dispatch_callbacks();
+	}
+
+	if (soft_body_world_info) {
+		btSoftBodyArray &softBodies = static_cast<btSoftRigidDynamicsWorld *>(dynamicsWorld)->getSoftBodyArray();
+		for (int i = softBodies.size() - 1; 0 <= i; --i) {
+			static_cast<CollisionObjectBullet *>(softBodies[i]->getUserPointer())->dispatch_callbacks();
+		}
+	}
+
+	// Sleeping bodies are never touched, the callbacks may free or queue bodies so the list is drained first
+	while (active_body_list.first()) {
+		SelfList<RigidBodyBullet> *e = active_body_list.first();
+		active_body_list.remove(e);
+		dispatch_body_list.add(e);
+	}
+
+	while (dispatch_body_list.first()) {
+		SelfList<RigidBodyBullet> *e = dispatch_body_list.first();
+		dispatch_body_list.remove(e);
+		RigidBodyBullet *body = e->self();
+
+		if (active_transform_count == active_transforms.size())
+			active_transforms.resize(MAX(active_transform_count * 2, 64));
+
+		PhysicsServer::ActiveTransform &at = active_transforms[active_transform_count++];
+		at.instance_id = body->get_instance_id();
+		at.body = body->get_self();
+		at.transform = body->get_transform();
+
+		// Keep awake bodies queued, so the step they fall asleep is reported too.
+		// This is decided before the callback: it runs script code that may free the body or move it
+		// to another space, which takes the element off the list again, so neither is touched afterwards
+		if (body->needs_dispatch()) {
+			active_body_list.add(e);
+		}
+
+		body->dispatch_callbacks();
+	}
+}
+
+void SpaceBullet::body_add_to_active_list(SelfList<RigidBodyBullet> *p_body) {
+	if (!p_body->in_list()) {
+		active_body_list.add(p_body);
 	}
 }
 
@@ -558,9 +609,18 @@ void SpaceBullet::create_empty_world(bool p_create_soft_world) {
 	gjk_simplex_solver = bulletnew(btVoronoiSimplexSolver);
 	gjk_simplex_solver->setEqualVertexThreshold(0.f);
 
+	// The multithreaded world needs a task scheduler, see BulletPhysicsServer::init
+	// Soft bodies have no multithreaded world, so they always use the single threaded one
+	bool use_mt_world = false;
+#if BT_THREADSAFE
+	use_mt_world = !p_create_soft_world && btGetTaskScheduler() && btGetTaskScheduler()->getNumThreads() > 1;
+#endif
+
 	void *world_mem;
 	if (p_create_soft_world) {
 		world_mem = malloc(sizeof(btSoftRigidDynamicsWorld));
+	} else if (use_mt_world) {
+		world_mem = malloc(sizeof(btDiscreteDynamicsWorldMt));
 	} else {
 		world_mem = malloc(sizeof(btDiscreteDynamicsWorld));
 	}
@@ -571,14 +631,22 @@ void SpaceBullet::create_empty_world(bool p_create_soft_world) {
 		collisionConfiguration = bulletnew(GodotCollisionConfiguration(static_cast<btDiscreteDynamicsWorld *>(world_mem)));
 	}
 
-	dispatcher = bulletnew(GodotCollisionDispatcher(collisionConfiguration));
 	broadphase = bulletnew(btDbvtBroadphase);
-	solver = bulletnew(btSequentialImpulseConstraintSolver);
+
+	dispatcher = bulletnew(GodotCollisionDispatcher(collisionConfiguration, use_mt_world));
+
+	if (use_mt_world) {
+		btConstraintSolverPoolMt *solver_pool = bulletnew(btConstraintSolverPoolMt(btGetTaskScheduler()->getNumThreads()));
+		solver = solver_pool;
+		dynamicsWorld = new (world_mem) btDiscreteDynamicsWorldMt(dispatcher, broadphase, solver_pool, collisionConfiguration);
+	} else {
+		solver = bulletnew(btSequentialImpulseConstraintSolver);
+	}
 
 	if (p_create_soft_world) {
 		dynamicsWorld = new (world_mem) btSoftRigidDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
 		soft_body_world_info = bulletnew(btSoftBodyWorldInfo);
-	} else {
+	} else if (!use_mt_world) {
 		dynamicsWorld = new (world_mem) btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
 	}
 
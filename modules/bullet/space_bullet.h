@@ -31,6 +31,7 @@
 #ifndef SPACE_BULLET_H
 #define SPACE_BULLET_H
 
+#include "core/self_list.h"
 #include "core/variant.h"
 #include "core/vector.h"
 #include "godot_result_callbacks.h"
@@ -73,13 +74,13 @@ private:
 public:
 	BulletPhysicsDirectSpaceState(SpaceBullet *p_space);
 
-	virtual int intersect_point(const Vector3 &p_point, ShapeResult *r_results, int p_result_max, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF);
-	virtual bool intersect_ray(const Vector3 &p_from, const Vector3 &p_to, RayResult &r_result, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF, bool p_pick_ray = false);
-	virtual int intersect_shape(const RID &p_shape, const Transform &p_xform, float p_margin, ShapeResult *r_results, int p_result_max, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF);
-	virtual bool cast_motion(const RID &p_shape, const Transform &p_xform, const Vector3 &p_motion, float p_margin, float &p_closest_safe, float &p_closest_unsafe, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF, ShapeRestInfo *r_info = NULL);
+	virtual int intersect_point(const Vector3 &p_point, ShapeResult *r_results, int p_result_max, const PhysicsQueryExclude &p_exclude = PhysicsQueryExclude(), uint32_t p_collision_mask = 0xFFFFFFFF);
+	virtual bool intersect_ray(const Vector3 &p_from, const Vector3 &p_to, RayResult &r_result, const PhysicsQueryExclude &p_exclude = PhysicsQueryExclude(), uint32_t p_collision_mask = 0xFFFFFFFF, bool p_pick_ray = false);
+	virtual int intersect_shape(const RID &p_shape, const Transform &p_xform, float p_margin, ShapeResult *r_results, int p_result_max, const PhysicsQueryExclude &p_exclude = PhysicsQueryExclude(), uint32_t p_collision_mask = 0xFFFFFFFF);
+	virtual bool cast_motion(const RID &p_shape, const Transform &p_xform, const Vector3 &p_motion, float p_margin, float &p_closest_safe, float &p_closest_unsafe, const PhysicsQueryExclude &p_exclude = PhysicsQueryExclude(), uint32_t p_collision_mask = 0xFFFFFFFF, ShapeRestInfo *r_info = NULL);
 	/// Returns the list of contacts pairs in this order: Local contact, other body contact
-	virtual bool collide_shape(RID p_shape, const Transform &p_shape_xform, float p_margin, Vector3 *r_results, int p_result_max, int &r_result_count, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF);
-	virtual bool rest_info(RID p_shape, const Transform &p_shape_xform, float p_margin, ShapeRestInfo *r_info, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF);
+	virtual bool collide_shape(RID p_shape, const Transform &p_shape_xform, float p_margin, Vector3 *r_results, int p_result_max, int &r_result_count, const PhysicsQueryExclude &p_exclude = PhysicsQueryExclude(), uint32_t p_collision_mask = 0xFFFFFFFF);
+	virtual bool rest_info(RID p_shape, const Transform &p_shape_xform, float p_margin, ShapeRestInfo *r_info, const PhysicsQueryExclude &p_exclude = PhysicsQueryExclude(), uint32_t p_collision_mask = 0xFFFFFFFF);
 	virtual Vector3 get_closest_point_to_object_volume(RID p_object, const Vector3 p_point) const;
 };
 
@@ -110,6 +111,14 @@ private:
 	Vector<Vector3> contactDebug;
 	int contactDebugCount;
 
+	/// Rigid bodies that moved during the last step or are still awake, only these are dispatched by flush_queries
+	SelfList<RigidBodyBullet>::List active_body_list;
+	SelfList<RigidBodyBullet>::List dispatch_body_list;
+
+	/// Grows only, so flushing does not reallocate every frame
+	Vector<PhysicsServer::ActiveTransform> active_transforms;
+	int active_transform_count;
+
 public:
 	SpaceBullet(bool p_create_soft_world);
 	virtual ~SpaceBullet();
@@ -167,6 +176,10 @@ public:
 	_FORCE_INLINE_ Vector<Vector3> get_debug_contacts() { return contactDebug; }
 	_FORCE_INLINE_ int get_debug_contact_count() { return contactDebugCount; }
 
+	void body_add_to_active_list(SelfList<RigidBodyBullet> *p_body);
+	_FORCE_INLINE_ const Vector<PhysicsServer::ActiveTransform> &get_active_transforms() const { return active_transforms; }
+	_FORCE_INLINE_ int get_active_transform_count() const { return active_transform_count; }
+
 	const Vector3 &get_gravity_direction() const { return gravityDirection; }
 	real_t get_gravity_magnitude() const { return gravityMagnitude; }
 
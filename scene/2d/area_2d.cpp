@@ -31,6 +31,7 @@
 #include "area_2d.h"
 #include "scene/scene_string_names.h"
 #include "servers/audio_server.h"
+#include "servers/physics_area_monitor_events.h"
 #include "servers/physics_2d_server.h"
 
 void Area2D::set_space_override_mode(SpaceOverride p_mode) {
@@ -249,6 +250,18 @@ void Area2D::_area_exit_tree(ObjectID p_id) {
 	}
 }
 
+void Area2D::_body_inout_batch(const PoolVector<int> &p_events) {
+
+	int count = p_events.size() / PhysicsAreaMonitorEvents::EVENT_STRIDE;
+	PoolVector<int>::Read r = p_events.read();
+
+	for (int i = 0; i < count; i++) {
+
+		const int *e = &r[i * PhysicsAreaMonitorEvents::EVENT_STRIDE];
+		_body_inout(e[0], RID(), e[1], e[2], e[3]);
+	}
+}
+
 void Area2D::_area_inout(int p_status, const RID &p_area, int p_instance, int p_area_shape, int p_self_shape) {
 
 	bool area_in = p_status == Physics2DServer::AREA_BODY_ADDED;
@@ -316,6 +329,18 @@ void Area2D::_area_inout(int p_status, const RID &p_area, int p_instance, int p_
 	locked = false;
 }
 
+void Area2D::_area_inout_batch(const PoolVector<int> &p_events) {
+
+	int count = p_events.size() / PhysicsAreaMonitorEvents::EVENT_STRIDE;
+	PoolVector<int>::Read r = p_events.read();
+
+	for (int i = 0; i < count; i++) {
+
+		const int *e = &r[i * PhysicsAreaMonitorEvents::EVENT_STRIDE];
+		_area_inout(e[0], RID(), e[1], e[2], e[3]);
+	}
+}
+
 void Area2D::_clear_monitoring() {
 
 	if (locked) {
@@ -407,8 +432,9 @@ void Area2D::set_monitoring(bool p_enable) {
 
 	if (monitoring) {
 
-		Physics2DServer::get_singleton()->area_set_monitor_callback(get_rid(), this, SceneStringNames::get_singleton()->_body_inout);
-		Physics2DServer::get_singleton()->area_set_area_monitor_callback(get_rid(), this, SceneStringNames::get_singleton()->_area_inout);
+		Physics2DServer::get_singleton()->area_set_monitor_batching(get_rid(), true);
+		Physics2DServer::get_singleton()->area_set_monitor_callback(get_rid(), this, SceneStringNames::get_singleton()->_body_inout_batch);
+		Physics2DServer::get_singleton()->area_set_area_monitor_callback(get_rid(), this, SceneStringNames::get_singleton()->_area_inout_batch);
 
 	} else {
 		Physics2DServer::get_singleton()->area_set_monitor_callback(get_rid(), NULL, StringName());
@@ -653,6 +679,8 @@ void Area2D::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("_body_inout"), &Area2D::_body_inout);
 	ClassDB::bind_method(D_METHOD("_area_inout"), &Area2D::_area_inout);
+	ClassDB::bind_method(D_METHOD("_body_inout_batch"), &Area2D::_body_inout_batch);
+	ClassDB::bind_method(D_METHOD("_area_inout_batch"), &Area2D::_area_inout_batch);
 
 	ADD_SIGNAL(MethodInfo("body_shape_entered", PropertyInfo(Variant::INT, "body_id"), PropertyInfo(Variant::OBJECT, "body", PROPERTY_HINT_RESOURCE_TYPE, "PhysicsBody2D"), PropertyInfo(Variant::INT, "body_shape"), PropertyInfo(Variant::INT, "area_shape")));
 	ADD_SIGNAL(MethodInfo("body_shape_exited", PropertyInfo(Variant::INT, "body_id"), PropertyInfo(Variant::OBJECT, "body", PROPERTY_HINT_RESOURCE_TYPE, "PhysicsBody2D"), PropertyInfo(Variant::INT, "body_shape"), PropertyInfo(Variant::INT, "area_shape")));
@@ -163,7 +163,7 @@ void AudioStreamPlayer2D::_notification(int p_what) {
 
 			Physics2DDirectSpaceState::ShapeResult sr[MAX_INTERSECT_AREAS];
 
-			int areas = space_state->intersect_point(global_pos, sr, MAX_INTERSECT_AREAS, Set<RID>(), area_mask);
+			int areas = space_state->intersect_point(global_pos, sr, MAX_INTERSECT_AREAS, PhysicsQueryExclude(), area_mask);
 
 			for (int i = 0; i < areas; i++) {
 
@@ -1014,8 +1014,15 @@ bool KinematicBody2D::move_and_collide(const Vector2 &p_motion, Collision &r_col
 
 Vector2 KinematicBody2D::move_and_slide(const Vector2 &p_linear_velocity, const Vector2 &p_floor_direction, float p_slope_stop_min_velocity, int p_max_slides, float p_floor_max_angle) {
 
-	Vector2 motion = (floor_velocity + p_linear_velocity) * get_physics_process_delta_time();
-	Vector2 lv = p_linear_velocity;
+	Physics2DServer::MoveAndSlideParameters params;
+	params.body = get_rid();
+	params.from = get_global_transform();
+	params.motion = (floor_velocity + p_linear_velocity) * get_physics_process_delta_time();
+	params.linear_velocity = p_linear_velocity;
+	params.floor_direction = p_floor_direction;
+	params.slope_stop_min_velocity = p_slope_stop_min_velocity;
+	params.floor_max_angle = p_floor_max_angle;
+	params.margin = margin;
 
 	on_floor = false;
 	on_ceiling = false;
@@ -1023,57 +1030,51 @@ Vector2 KinematicBody2D::move_and_slide(const Vector2 &p_linear_velocity, const
 	colliders.clear();
 	floor_velocity = Vector2();
 
-	while (p_max_slides) {
+	// the server slides without moving the body, so the transform is only applied once at the end
+	Physics2DServer::MoveAndSlideResult result;
+	result.transform = params.from;
+	result.linear_velocity = p_linear_velocity;
 
-		Collision collision;
+	while (p_max_slides > 0) {
 
-		bool collided = move_and_collide(motion, collision);
+		params.max_slides = MIN(p_max_slides, (int)Physics2DServer::MOVE_AND_SLIDE_MAX_SLIDES);
+		Physics2DServer::get_singleton()->body_move_and_slide(&params, &result, 1);
 
-		if (collided) {
+		on_floor = on_floor || result.on_floor;
+		on_wall = on_wall || result.on_wall;
+		on_ceiling = on_ceiling || result.on_ceiling;
+		if (result.on_floor)
+			floor_velocity = result.floor_velocity;
 
-			motion = collision.remainder;
+		for (int i = 0; i < result.collision_count; i++) {
 
-			if (p_floor_direction == Vector2()) {
-				//all is a wall
-				on_wall = true;
-			} else {
-				if (collision.normal.dot(p_floor_direction) >= Math::cos(p_floor_max_angle)) { //floor
-
-					on_floor = true;
-					floor_velocity = collision.collider_vel;
-
-					Vector2 rel_v = lv - floor_velocity;
-					Vector2 hv = rel_v - p_floor_direction * p_floor_direction.dot(rel_v);
-
-					if (collision.travel.length() < 1 && hv.length() < p_slope_stop_min_velocity) {
-						Transform2D gt = get_global_transform();
-						gt.elements[2] -= collision.travel;
-						set_global_transform(gt);
-						return Vector2();
-					}
-				} else if (collision.normal.dot(-p_floor_direction) >= Math::cos(p_floor_max_angle)) { //ceiling
-					on_ceiling = true;
-				} else {
-					on_wall = true;
-				}
-			}
-
-			Vector2 n = collision.normal;
-			motion = motion.slide(n);
-			lv = lv.slide(n);
+			const Physics2DServer::MotionResult &mr = result.collisions[i];
 
+			Collision collision;
+			collision.collider_metadata = mr.collider_metadata;
+			collision.collider_shape = mr.collider_shape;
+			collision.collider_vel = mr.collider_velocity;
+			collision.collision = mr.collision_point;
+			collision.normal = mr.collision_normal;
+			collision.collider = mr.collider_id;
+			collision.travel = mr.motion;
+			collision.remainder = mr.remainder;
+			collision.local_shape = mr.collision_local_shape;
 			colliders.push_back(collision);
-
-		} else {
-			break;
 		}
 
-		p_max_slides--;
-		if (motion == Vector2())
+		p_max_slides -= params.max_slides;
+		if (result.motion == Vector2())
 			break;
+
+		params.from = result.transform;
+		params.motion = result.motion;
+		params.linear_velocity = result.linear_velocity;
 	}
 
-	return lv;
+	set_global_transform(result.transform);
+
+	return result.linear_velocity;
 }
 
 bool KinematicBody2D::is_on_floor() const {
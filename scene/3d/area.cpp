@@ -31,6 +31,7 @@
 #include "area.h"
 #include "scene/scene_string_names.h"
 #include "servers/audio_server.h"
+#include "servers/physics_area_monitor_events.h"
 #include "servers/physics_server.h"
 
 void Area::set_space_override_mode(SpaceOverride p_mode) {
@@ -301,8 +302,9 @@ void Area::set_monitoring(bool p_enable) {
 
 	if (monitoring) {
 
-		PhysicsServer::get_singleton()->area_set_monitor_callback(get_rid(), this, SceneStringNames::get_singleton()->_body_inout);
-		PhysicsServer::get_singleton()->area_set_area_monitor_callback(get_rid(), this, SceneStringNames::get_singleton()->_area_inout);
+		PhysicsServer::get_singleton()->area_set_monitor_batching(get_rid(), true);
+		PhysicsServer::get_singleton()->area_set_monitor_callback(get_rid(), this, SceneStringNames::get_singleton()->_body_inout_batch);
+		PhysicsServer::get_singleton()->area_set_area_monitor_callback(get_rid(), this, SceneStringNames::get_singleton()->_area_inout_batch);
 	} else {
 		PhysicsServer::get_singleton()->area_set_monitor_callback(get_rid(), NULL, StringName());
 		PhysicsServer::get_singleton()->area_set_area_monitor_callback(get_rid(), NULL, StringName());
@@ -344,6 +346,18 @@ void Area::_area_exit_tree(ObjectID p_id) {
 	}
 }
 
+void Area::_body_inout_batch(const PoolVector<int> &p_events) {
+
+	int count = p_events.size() / PhysicsAreaMonitorEvents::EVENT_STRIDE;
+	PoolVector<int>::Read r = p_events.read();
+
+	for (int i = 0; i < count; i++) {
+
+		const int *e = &r[i * PhysicsAreaMonitorEvents::EVENT_STRIDE];
+		_body_inout(e[0], RID(), e[1], e[2], e[3]);
+	}
+}
+
 void Area::_area_inout(int p_status, const RID &p_area, int p_instance, int p_area_shape, int p_self_shape) {
 
 	bool area_in = p_status == PhysicsServer::AREA_BODY_ADDED;
@@ -412,6 +426,18 @@ void Area::_area_inout(int p_status, const RID &p_area, int p_instance, int p_ar
 	locked = false;
 }
 
+void Area::_area_inout_batch(const PoolVector<int> &p_events) {
+
+	int count = p_events.size() / PhysicsAreaMonitorEvents::EVENT_STRIDE;
+	PoolVector<int>::Read r = p_events.read();
+
+	for (int i = 0; i < count; i++) {
+
+		const int *e = &r[i * PhysicsAreaMonitorEvents::EVENT_STRIDE];
+		_area_inout(e[0], RID(), e[1], e[2], e[3]);
+	}
+}
+
 bool Area::is_monitoring() const {
 
 	return monitoring;
@@ -680,6 +706,8 @@ void Area::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("_body_inout"), &Area::_body_inout);
 	ClassDB::bind_method(D_METHOD("_area_inout"), &Area::_area_inout);
+	ClassDB::bind_method(D_METHOD("_body_inout_batch"), &Area::_body_inout_batch);
+	ClassDB::bind_method(D_METHOD("_area_inout_batch"), &Area::_area_inout_batch);
 
 	ClassDB::bind_method(D_METHOD("set_audio_bus_override", "enable"), &Area::set_audio_bus_override);
 	ClassDB::bind_method(D_METHOD("is_overriding_audio_bus"), &Area::is_overriding_audio_bus);
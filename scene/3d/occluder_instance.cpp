@@ -0,0 +1,119 @@
+/*************************************************************************/
+/*  occluder_instance.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "occluder_instance.h"
+
+#include "servers/visual_server.h"
+
+void OccluderInstance::_update_faces() {
+
+	PoolVector<Vector3> faces;
+
+	if (mesh.is_valid()) {
+
+		PoolVector<Face3> mesh_faces = mesh->get_faces();
+		faces.resize(mesh_faces.size() * 3);
+
+		PoolVector<Face3>::Read r = mesh_faces.read();
+		PoolVector<Vector3>::Write w = faces.write();
+		for (int i = 0; i < mesh_faces.size(); i++) {
+			w[i * 3 + 0] = r[i].vertex[0];
+			w[i * 3 + 1] = r[i].vertex[1];
+			w[i * 3 + 2] = r[i].vertex[2];
+		}
+	}
+
+	VisualServer::get_singleton()->occluder_set_faces(occluder, faces);
+}
+
+void OccluderInstance::_notification(int p_what) {
+
+	switch (p_what) {
+
+		case NOTIFICATION_ENTER_WORLD: {
+
+			VisualServer::get_singleton()->occluder_set_scenario(occluder, get_world()->get_scenario());
+			VisualServer::get_singleton()->occluder_set_transform(occluder, get_global_transform());
+			VisualServer::get_singleton()->occluder_set_enabled(occluder, is_visible_in_tree());
+		} break;
+		case NOTIFICATION_TRANSFORM_CHANGED: {
+
+			VisualServer::get_singleton()->occluder_set_transform(occluder, get_global_transform());
+		} break;
+		case NOTIFICATION_VISIBILITY_CHANGED: {
+
+			VisualServer::get_singleton()->occluder_set_enabled(occluder, is_visible_in_tree());
+		} break;
+		case NOTIFICATION_EXIT_WORLD: {
+
+			VisualServer::get_singleton()->occluder_set_scenario(occluder, RID());
+		} break;
+	}
+}
+
+void OccluderInstance::set_mesh(const Ref<Mesh> &p_mesh) {
+
+	mesh = p_mesh;
+	_update_faces();
+	update_configuration_warning();
+}
+
+Ref<Mesh> OccluderInstance::get_mesh() const {
+
+	return mesh;
+}
+
+String OccluderInstance::get_configuration_warning() const {
+
+	if (mesh.is_null()) {
+		return TTR("A mesh must be set for OccluderInstance to hide anything.");
+	}
+
+	return String();
+}
+
+void OccluderInstance::_bind_methods() {
+
+	ClassDB::bind_method(D_METHOD("set_mesh", "mesh"), &OccluderInstance::set_mesh);
+	ClassDB::bind_method(D_METHOD("get_mesh"), &OccluderInstance::get_mesh);
+
+	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "mesh", PROPERTY_HINT_RESOURCE_TYPE, "Mesh"), "set_mesh", "get_mesh");
+}
+
+OccluderInstance::OccluderInstance() {
+
+	occluder = VisualServer::get_singleton()->occluder_create();
+	set_notify_transform(true);
+}
+
+OccluderInstance::~OccluderInstance() {
+
+	VisualServer::get_singleton()->free(occluder);
+}
@@ -29,135 +29,86 @@
 /*************************************************************************/
 
 #include "portal.h"
-#include "project_settings.h"
-#include "scene/resources/surface_tool.h"
+
+#include "scene/3d/room_instance.h"
 #include "servers/visual_server.h"
 
-// FIXME: This will be removed, kept as reference for new implementation
-#if 0
-bool Portal::_set(const StringName &p_name, const Variant &p_value) {
-
-	if (p_name == "shape") {
-		PoolVector<float> src_coords = p_value;
-		Vector<Point2> points;
-		int src_coords_size = src_coords.size();
-		ERR_FAIL_COND_V(src_coords_size % 2, false);
-		points.resize(src_coords_size / 2);
-		for (int i = 0; i < points.size(); i++) {
-
-			points[i].x = src_coords[i * 2 + 0];
-			points[i].y = src_coords[i * 2 + 1];
-			set_shape(points);
-		}
-	} else if (p_name == "enabled") {
-		set_enabled(p_value);
-	} else if (p_name == "disable_distance") {
-		set_disable_distance(p_value);
-	} else if (p_name == "disabled_color") {
-		set_disabled_color(p_value);
-	} else if (p_name == "connect_range") {
-		set_connect_range(p_value);
-	} else
-		return false;
-
-	return true;
-}
+void Portal::_update_rooms() {
 
-bool Portal::_get(const StringName &p_name, Variant &r_ret) const {
+	if (!is_inside_world())
+		return;
 
-	if (p_name == "shape") {
-		Vector<Point2> points = get_shape();
-		PoolVector<float> dst_coords;
-		dst_coords.resize(points.size() * 2);
+	RID room;
+	RID linked;
 
-		for (int i = 0; i < points.size(); i++) {
+	Room *parent = Object::cast_to<Room>(get_parent());
+	if (parent && parent->is_inside_world()) {
 
-			dst_coords.set(i * 2 + 0, points[i].x);
-			dst_coords.set(i * 2 + 1, points[i].y);
-		}
+		room = parent->get_room_rid();
 
-		r_ret = dst_coords;
-	} else if (p_name == "enabled") {
-		r_ret = is_enabled();
-	} else if (p_name == "disable_distance") {
-		r_ret = get_disable_distance();
-	} else if (p_name == "disabled_color") {
-		r_ret = get_disabled_color();
-	} else if (p_name == "connect_range") {
-		r_ret = get_connect_range();
-	} else
-		return false;
-	return true;
-}
+		if (!linked_room.is_empty()) {
 
-void Portal::_get_property_list(List<PropertyInfo> *p_list) const {
+			Room *other = has_node(linked_room) ? Object::cast_to<Room>(get_node(linked_room)) : NULL;
+			if (!other || other == parent || !other->is_inside_world() || other->get_world() != get_world()) {
+				room = RID(); //not there yet, connected again when it enters
+			} else {
+				linked = other->get_room_rid();
+			}
+		}
+	}
 
-	p_list->push_back(PropertyInfo(Variant::POOL_REAL_ARRAY, "shape"));
-	p_list->push_back(PropertyInfo(Variant::BOOL, "enabled"));
-	p_list->push_back(PropertyInfo(Variant::REAL, "disable_distance", PROPERTY_HINT_RANGE, "0,4096,0.01"));
-	p_list->push_back(PropertyInfo(Variant::COLOR, "disabled_color"));
-	p_list->push_back(PropertyInfo(Variant::REAL, "connect_range", PROPERTY_HINT_RANGE, "0.1,4096,0.01"));
+	VisualServer::get_singleton()->portal_set_rooms(portal, room, linked);
 }
 
-AABB Portal::get_aabb() const {
-
-	return aabb;
-}
-PoolVector<Face3> Portal::get_faces(uint32_t p_usage_flags) const {
+void Portal::_update_points() {
 
-	if (!(p_usage_flags & FACES_ENCLOSING))
-		return PoolVector<Face3>();
+	Transform xform = get_global_transform();
 
-	Vector<Point2> shape = get_shape();
-	if (shape.size() == 0)
-		return PoolVector<Face3>();
+	Vector<Vector3> points;
+	points.resize(shape.size());
 
-	Vector2 center;
+	PoolVector<Vector2>::Read r = shape.read();
 	for (int i = 0; i < shape.size(); i++) {
-
-		center += shape[i];
+		points[i] = xform.xform(Vector3(r[i].x, r[i].y, 0));
 	}
 
-	PoolVector<Face3> ret;
-	center /= shape.size();
+	VisualServer::get_singleton()->portal_set_points(portal, points);
+}
 
-	for (int i = 0; i < shape.size(); i++) {
+void Portal::_notification(int p_what) {
 
-		int n = (i + 1) % shape.size();
+	switch (p_what) {
 
-		Face3 f;
-		f.vertex[0] = Vector3(center.x, center.y, 0);
-		f.vertex[1] = Vector3(shape[i].x, shape[i].y, 0);
-		f.vertex[2] = Vector3(shape[n].x, shape[n].y, 0);
-		ret.push_back(f);
-	}
+		case NOTIFICATION_ENTER_WORLD: {
+
+			_update_points();
+			_update_rooms();
+		} break;
+		case NOTIFICATION_TRANSFORM_CHANGED: {
 
-	return ret;
+			_update_points();
+		} break;
+		case NOTIFICATION_EXIT_WORLD: {
+
+			VisualServer::get_singleton()->portal_set_rooms(portal, RID(), RID());
+		} break;
+	}
 }
 
-void Portal::set_shape(const Vector<Point2> &p_shape) {
+void Portal::set_shape(const PoolVector<Vector2> &p_shape) {
 
-	VisualServer::get_singleton()->portal_set_shape(portal, p_shape);
 	shape = p_shape;
+	if (is_inside_world()) {
+		_update_points();
+	}
 	update_gizmo();
 }
 
-Vector<Point2> Portal::get_shape() const {
+PoolVector<Vector2> Portal::get_shape() const {
 
 	return shape;
 }
 
-void Portal::set_connect_range(float p_range) {
-
-	connect_range = p_range;
-	//VisualServer::get_singleton()->portal_set_connect_range(portal,p_range);
-}
-
-float Portal::get_connect_range() const {
-
-	return connect_range;
-}
-
 void Portal::set_enabled(bool p_enabled) {
 
 	enabled = p_enabled;
@@ -169,64 +120,59 @@ bool Portal::is_enabled() const {
 	return enabled;
 }
 
-void Portal::set_disable_distance(float p_distance) {
+void Portal::set_linked_room(const NodePath &p_room) {
 
-	disable_distance = p_distance;
-	VisualServer::get_singleton()->portal_set_disable_distance(portal, disable_distance);
+	linked_room = p_room;
+	_update_rooms();
 }
-float Portal::get_disable_distance() const {
 
-	return disable_distance;
-}
+NodePath Portal::get_linked_room() const {
 
-void Portal::set_disabled_color(const Color &p_disabled_color) {
-
-	disabled_color = p_disabled_color;
-	VisualServer::get_singleton()->portal_set_disabled_color(portal, disabled_color);
+	return linked_room;
 }
 
-Color Portal::get_disabled_color() const {
+String Portal::get_configuration_warning() const {
+
+	if (!Object::cast_to<Room>(get_parent())) {
+		return TTR("Portal only works when it is the child of a Room node.");
+	}
 
-	return disabled_color;
+	return String();
 }
 
 void Portal::_bind_methods() {
 
-	ClassDB::bind_method(D_METHOD("set_shape", "points"), &Portal::set_shape);
+	ClassDB::bind_method(D_METHOD("_update_rooms"), &Portal::_update_rooms);
+
+	ClassDB::bind_method(D_METHOD("set_shape", "shape"), &Portal::set_shape);
 	ClassDB::bind_method(D_METHOD("get_shape"), &Portal::get_shape);
 
-	ClassDB::bind_method(D_METHOD("set_enabled", "enable"), &Portal::set_enabled);
+	ClassDB::bind_method(D_METHOD("set_enabled", "enabled"), &Portal::set_enabled);
 	ClassDB::bind_method(D_METHOD("is_enabled"), &Portal::is_enabled);
 
-	ClassDB::bind_method(D_METHOD("set_disable_distance", "distance"), &Portal::set_disable_distance);
-	ClassDB::bind_method(D_METHOD("get_disable_distance"), &Portal::get_disable_distance);
+	ClassDB::bind_method(D_METHOD("set_linked_room", "room"), &Portal::set_linked_room);
+	ClassDB::bind_method(D_METHOD("get_linked_room"), &Portal::get_linked_room);
 
-	ClassDB::bind_method(D_METHOD("set_disabled_color", "color"), &Portal::set_disabled_color);
-	ClassDB::bind_method(D_METHOD("get_disabled_color"), &Portal::get_disabled_color);
-
-	ClassDB::bind_method(D_METHOD("set_connect_range", "range"), &Portal::set_connect_range);
-	ClassDB::bind_method(D_METHOD("get_connect_range"), &Portal::get_connect_range);
+	ADD_PROPERTY(PropertyInfo(Variant::POOL_VECTOR2_ARRAY, "shape"), "set_shape", "get_shape");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "enabled"), "set_enabled", "is_enabled");
+	ADD_PROPERTY(PropertyInfo(Variant::NODE_PATH, "linked_room"), "set_linked_room", "get_linked_room");
 }
 
 Portal::Portal() {
 
 	portal = VisualServer::get_singleton()->portal_create();
-	Vector<Point2> points;
-	points.push_back(Point2(-1, 1));
-	points.push_back(Point2(1, 1));
-	points.push_back(Point2(1, -1));
-	points.push_back(Point2(-1, -1));
-	set_shape(points); // default shape
-
-	set_connect_range(0.8);
-	set_disable_distance(50);
-	set_enabled(true);
-
-	set_base(portal);
+	enabled = true;
+
+	shape.push_back(Vector2(-1, -1));
+	shape.push_back(Vector2(1, -1));
+	shape.push_back(Vector2(1, 1));
+	shape.push_back(Vector2(-1, 1));
+
+	add_to_group("_portals");
+	set_notify_transform(true);
 }
 
 Portal::~Portal() {
 
 	VisualServer::get_singleton()->free(portal);
 }
-#endif
@@ -46,7 +46,7 @@ class RayCast : public Spatial {
 
 	Vector3 cast_to;
 
-	Set<RID> exclude;
+	PhysicsQueryExclude exclude;
 
 	uint32_t collision_mask;
 	bool exclude_parent_body;
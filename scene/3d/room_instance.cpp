@@ -30,135 +30,84 @@
 
 #include "room_instance.h"
 
+#include "scene/main/viewport.h"
 #include "servers/visual_server.h"
 
-// FIXME: Will be removed, kept as reference for new implementation
-#if 0
-#include "geometry.h"
-#include "project_settings.h"
-#include "scene/resources/surface_tool.h"
+void Room::_update_bounds() {
 
-void Room::_notification(int p_what) {
+	Transform xform = get_global_transform();
 
-	switch (p_what) {
-		case NOTIFICATION_ENTER_WORLD: {
-			// go find parent level
-			Node *parent_room = get_parent();
-			level = 0;
+	Vector<Plane> planes;
+	for (int i = 0; i < 3; i++) {
 
-			while (parent_room) {
+		Vector3 normal;
+		normal[i] = 1;
+		planes.push_back(xform.xform(Plane(normal, extents[i])));
+		planes.push_back(xform.xform(Plane(-normal, extents[i])));
+	}
 
-				Room *r = Object::cast_to<Room>(parent_room);
-				if (r) {
+	VisualServer::get_singleton()->room_set_bounds(room, planes);
+}
 
-					level = r->level + 1;
-					break;
-				}
+void Room::_notification(int p_what) {
 
-				parent_room = parent_room->get_parent();
-			}
+	switch (p_what) {
+
+		case NOTIFICATION_ENTER_WORLD: {
 
+			VisualServer::get_singleton()->room_set_scenario(room, get_world()->get_scenario());
+			_update_bounds();
+
+			//portals leading here may have entered before this room did
+			get_tree()->call_group_flags(SceneTree::GROUP_CALL_UNIQUE, "_portals", "_update_rooms");
 		} break;
 		case NOTIFICATION_TRANSFORM_CHANGED: {
+
+			_update_bounds();
 		} break;
 		case NOTIFICATION_EXIT_WORLD: {
 
+			//disconnects the portals too
+			VisualServer::get_singleton()->room_set_scenario(room, RID());
 		} break;
 	}
 }
 
-AABB Room::get_aabb() const {
-
-	if (room.is_null())
-		return AABB();
-
-	return AABB();
-}
-
-PoolVector<Face3> Room::get_faces(uint32_t p_usage_flags) const {
-
-	return PoolVector<Face3>();
-}
-
-void Room::set_room(const Ref<RoomBounds> &p_room) {
-
-	room = p_room;
-	update_gizmo();
-
-	if (room.is_valid()) {
+void Room::set_extents(const Vector3 &p_extents) {
 
-		set_base(room->get_rid());
-	} else {
-		set_base(RID());
+	extents = p_extents;
+	if (is_inside_world()) {
+		_update_bounds();
 	}
-
-	if (!is_inside_tree())
-		return;
-
-	propagate_notification(NOTIFICATION_AREA_CHANGED);
 	update_gizmo();
 }
 
-Ref<RoomBounds> Room::get_room() const {
-
-	return room;
-}
-
-void Room::_parse_node_faces(PoolVector<Face3> &all_faces, const Node *p_node) const {
-
-	const VisualInstance *vi = Object::cast_to<VisualInstance>(p_node);
-
-	if (vi) {
-		PoolVector<Face3> faces = vi->get_faces(FACES_ENCLOSING);
-
-		if (faces.size()) {
-			int old_len = all_faces.size();
-			all_faces.resize(all_faces.size() + faces.size());
-			int new_len = all_faces.size();
-			PoolVector<Face3>::Write all_facesw = all_faces.write();
-			Face3 *all_facesptr = all_facesw.ptr();
-
-			PoolVector<Face3>::Read facesr = faces.read();
-			const Face3 *facesptr = facesr.ptr();
+Vector3 Room::get_extents() const {
 
-			Transform tr = vi->get_relative_transform(this);
-
-			for (int i = old_len; i < new_len; i++) {
-
-				Face3 f = facesptr[i - old_len];
-				for (int j = 0; j < 3; j++)
-					f.vertex[j] = tr.xform(f.vertex[j]);
-				all_facesptr[i] = f;
-			}
-		}
-	}
-
-	for (int i = 0; i < p_node->get_child_count(); i++) {
-
-		_parse_node_faces(all_faces, p_node->get_child(i));
-	}
+	return extents;
 }
 
-void Room::_bounds_changed() {
+RID Room::get_room_rid() const {
 
-	update_gizmo();
+	return room;
 }
 
 void Room::_bind_methods() {
 
-	ClassDB::bind_method(D_METHOD("set_room", "room"), &Room::set_room);
-	ClassDB::bind_method(D_METHOD("get_room"), &Room::get_room);
+	ClassDB::bind_method(D_METHOD("set_extents", "extents"), &Room::set_extents);
+	ClassDB::bind_method(D_METHOD("get_extents"), &Room::get_extents);
 
-	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "room/room", PROPERTY_HINT_RESOURCE_TYPE, "Area"), "set_room", "get_room");
+	ADD_PROPERTY(PropertyInfo(Variant::VECTOR3, "extents"), "set_extents", "get_extents");
 }
 
 Room::Room() {
 
-	//	sound_enabled=false;
-
-	level = 0;
+	room = VisualServer::get_singleton()->room_create();
+	extents = Vector3(1, 1, 1);
+	set_notify_transform(true);
 }
 
 Room::~Room() {
+
+	VisualServer::get_singleton()->free(room);
 }
-#endif
@@ -31,35 +31,23 @@
 #ifndef ROOM_INSTANCE_H
 #define ROOM_INSTANCE_H
 
-#include "scene/3d/visual_instance.h"
-#include "scene/resources/room.h"
+#include "scene/3d/spatial.h"
 
-/**
-	@author Juan Linietsky <reduzio@gmail.com>
+/* Room Logic:
+   a) A room is a convex box, everything it touches is drawn only when the room is seen,
+      because the camera is inside or looking through the portals leading to it.
+   b) Whatever is outside of every room belongs to the exterior, which portals can also lead to.
+   c) Instances are assigned to the rooms their AABB touch, so moving ones need no extra work.
 */
 
-/* RoomInstance Logic:
-   a) Instances that belong to the room are drawn only if the room is visible (seen through portal, or player inside)
-   b) Instances that don't belong to any room are considered to belong to the root room (RID empty)
-   c) "dynamic" Instances are assigned to the rooms their AABB touch
+class Room : public Spatial {
 
-*/
-
-// FIXME: this will be removed, left for reference
-#if 0
-
-class Room : public VisualInstance {
-
-	GDCLASS(Room, VisualInstance);
+	GDCLASS(Room, Spatial);
 
-public:
-private:
-	Ref<RoomBounds> room;
-
-	int level;
-	void _parse_node_faces(PoolVector<Face3> &all_faces, const Node *p_node) const;
+	RID room;
+	Vector3 extents;
 
-	void _bounds_changed();
+	void _update_bounds();
 
 protected:
 	void _notification(int p_what);
@@ -67,19 +55,13 @@ protected:
 	static void _bind_methods();
 
 public:
-	enum {
-		// used to notify portals that the room in which they are has changed.
-		NOTIFICATION_AREA_CHANGED = 60
-	};
+	void set_extents(const Vector3 &p_extents);
+	Vector3 get_extents() const;
 
-	virtual AABB get_aabb() const;
-	virtual PoolVector<Face3> get_faces(uint32_t p_usage_flags) const;
-
-	void set_room(const Ref<RoomBounds> &p_room);
-	Ref<RoomBounds> get_room() const;
+	RID get_room_rid() const;
 
 	Room();
 	~Room();
 };
-#endif
+
 #endif // ROOM_INSTANCE_H
@@ -150,7 +150,7 @@ class VehicleBody : public RigidBody {
 	real_t m_steeringValue;
 	real_t m_currentVehicleSpeedKmHour;
 
-	Set<RID> exclude;
+	PhysicsQueryExclude exclude;
 
 	Vector<Vector3> m_forwardWS;
 	Vector<Vector3> m_axle;
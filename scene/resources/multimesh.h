@@ -85,6 +85,8 @@ public:
 	void set_instance_color(int p_instance, const Color &p_color);
 	Color get_instance_color(int p_instance) const;
 
+	void set_instance_range(int p_from, const PoolVector<float> &p_data);
+
 	virtual AABB get_aabb() const;
 
 	virtual RID get_rid() const;
@@ -104,6 +104,8 @@ public:
 
 	StringName _body_inout;
 	StringName _area_inout;
+	StringName _body_inout_batch;
+	StringName _area_inout_batch;
 
 	StringName _get_gizmo_geometry;
 	StringName _can_gizmo_scale;
@@ -30,54 +30,75 @@
 
 #include "area_pair_sw.h"
 #include "collision_solver_sw.h"
+#include "space_sw.h"
 
-bool AreaPairSW::setup(real_t p_step) {
+void AreaPairSW::_set_colliding(bool p_colliding) {
 
-	bool result = false;
+	if (p_colliding == colliding)
+		return;
 
-	if (area->is_shape_set_as_disabled(area_shape) || body->is_shape_set_as_disabled(body_shape)) {
-		result = false;
-	} else if (area->test_collision_mask(body) && CollisionSolverSW::solve_static(body->get_shape(body_shape), body->get_transform() * body->get_shape_transform(body_shape), area->get_shape(area_shape), area->get_transform() * area->get_shape_transform(area_shape), NULL, this)) {
-		result = true;
+	if (p_colliding) {
+
+		if (area->get_space_override_mode() != PhysicsServer::AREA_SPACE_OVERRIDE_DISABLED)
+			body->add_area(area);
+		if (area->has_monitor_callback())
+			area->add_body_to_query(body, body_shape, area_shape);
+
+	} else {
+
+		if (area->get_space_override_mode() != PhysicsServer::AREA_SPACE_OVERRIDE_DISABLED)
+			body->remove_area(area);
+		if (area->has_monitor_callback())
+			area->remove_body_from_query(body, body_shape, area_shape);
 	}
 
-	if (result != colliding) {
+	colliding = p_colliding;
+}
+
+void AreaPairSW::save_state(State &r_state) const {
 
-		if (result) {
+	get_state_key(r_state.key);
+	r_state.colliding = colliding;
+}
 
-			if (area->get_space_override_mode() != PhysicsServer::AREA_SPACE_OVERRIDE_DISABLED)
-				body->add_area(area);
-			if (area->has_monitor_callback())
-				area->add_body_to_query(body, body_shape, area_shape);
+void AreaPairSW::restore_state(const State *p_state) {
 
-		} else {
+	// changes are queued as regular enter/exit events, so monitors stay in sync with the restored state
+	_set_colliding(p_state ? bool(p_state->colliding) : false);
+}
+
+bool AreaPairSW::setup(real_t p_step) {
 
-			if (area->get_space_override_mode() != PhysicsServer::AREA_SPACE_OVERRIDE_DISABLED)
-				body->remove_area(area);
-			if (area->has_monitor_callback())
-				area->remove_body_from_query(body, body_shape, area_shape);
-		}
+	bool result = false;
 
-		colliding = result;
+	if (area->is_shape_set_as_disabled(area_shape) || body->is_shape_set_as_disabled(body_shape)) {
+		result = false;
+	} else if (area->test_collision_mask(body) && CollisionSolverSW::solve_static(body->get_shape(body_shape), body->get_transform() * body->get_shape_transform(body_shape), area->get_shape(area_shape), area->get_transform() * area->get_shape_transform(area_shape), NULL, this)) {
+		result = true;
 	}
 
+	_set_colliding(result);
+
 	return false; //never do any post solving
 }
 
 void AreaPairSW::solve(real_t p_step) {
 }
 
-AreaPairSW::AreaPairSW(BodySW *p_body, int p_body_shape, AreaSW *p_area, int p_area_shape) {
+AreaPairSW::AreaPairSW(BodySW *p_body, int p_body_shape, AreaSW *p_area, int p_area_shape) :
+		area_pair_list(this) {
 
 	body = p_body;
 	area = p_area;
 	body_shape = p_body_shape;
 	area_shape = p_area_shape;
 	colliding = false;
+	space = area->get_space();
 	body->add_constraint(this, 0);
 	area->add_constraint(this);
 	if (p_body->get_mode() == PhysicsServer::BODY_MODE_KINEMATIC)
 		p_body->set_active(true);
+	space->area_pair_add_to_list(&area_pair_list);
 }
 
 AreaPairSW::~AreaPairSW() {
@@ -91,56 +112,76 @@ AreaPairSW::~AreaPairSW() {
 	}
 	body->remove_constraint(this);
 	area->remove_constraint(this);
+	space->area_pair_remove_from_list(&area_pair_list);
 }
 
 ////////////////////////////////////////////////////
 
-bool Area2PairSW::setup(real_t p_step) {
+void Area2PairSW::_set_colliding(bool p_colliding) {
 
-	bool result = false;
-	if (area_a->is_shape_set_as_disabled(shape_a) || area_b->is_shape_set_as_disabled(shape_b)) {
-		result = false;
-	} else if (area_a->test_collision_mask(area_b) && CollisionSolverSW::solve_static(area_a->get_shape(shape_a), area_a->get_transform() * area_a->get_shape_transform(shape_a), area_b->get_shape(shape_b), area_b->get_transform() * area_b->get_shape_transform(shape_b), NULL, this)) {
-		result = true;
-	}
+	if (p_colliding == colliding)
+		return;
+
+	if (p_colliding) {
+
+		if (area_b->has_area_monitor_callback() && area_a->is_monitorable())
+			area_b->add_area_to_query(area_a, shape_a, shape_b);
+
+		if (area_a->has_area_monitor_callback() && area_b->is_monitorable())
+			area_a->add_area_to_query(area_b, shape_b, shape_a);
+
+	} else {
+
+		if (area_b->has_area_monitor_callback() && area_a->is_monitorable())
+			area_b->remove_area_from_query(area_a, shape_a, shape_b);
 
-	if (result != colliding) {
+		if (area_a->has_area_monitor_callback() && area_b->is_monitorable())
+			area_a->remove_area_from_query(area_b, shape_b, shape_a);
+	}
 
-		if (result) {
+	colliding = p_colliding;
+}
 
-			if (area_b->has_area_monitor_callback() && area_a->is_monitorable())
-				area_b->add_area_to_query(area_a, shape_a, shape_b);
+void Area2PairSW::save_state(State &r_state) const {
 
-			if (area_a->has_area_monitor_callback() && area_b->is_monitorable())
-				area_a->add_area_to_query(area_b, shape_b, shape_a);
+	get_state_key(r_state.key);
+	r_state.colliding = colliding;
+}
 
-		} else {
+void Area2PairSW::restore_state(const State *p_state) {
 
-			if (area_b->has_area_monitor_callback() && area_a->is_monitorable())
-				area_b->remove_area_from_query(area_a, shape_a, shape_b);
+	_set_colliding(p_state ? bool(p_state->colliding) : false);
+}
 
-			if (area_a->has_area_monitor_callback() && area_b->is_monitorable())
-				area_a->remove_area_from_query(area_b, shape_b, shape_a);
-		}
+bool Area2PairSW::setup(real_t p_step) {
 
-		colliding = result;
+	bool result = false;
+	if (area_a->is_shape_set_as_disabled(shape_a) || area_b->is_shape_set_as_disabled(shape_b)) {
+		result = false;
+	} else if (area_a->test_collision_mask(area_b) && CollisionSolverSW::solve_static(area_a->get_shape(shape_a), area_a->get_transform() * area_a->get_shape_transform(shape_a), area_b->get_shape(shape_b), area_b->get_transform() * area_b->get_shape_transform(shape_b), NULL, this)) {
+		result = true;
 	}
 
+	_set_colliding(result);
+
 	return false; //never do any post solving
 }
 
 void Area2PairSW::solve(real_t p_step) {
 }
 
-Area2PairSW::Area2PairSW(AreaSW *p_area_a, int p_shape_a, AreaSW *p_area_b, int p_shape_b) {
+Area2PairSW::Area2PairSW(AreaSW *p_area_a, int p_shape_a, AreaSW *p_area_b, int p_shape_b) :
+		area2_pair_list(this) {
 
 	area_a = p_area_a;
 	area_b = p_area_b;
 	shape_a = p_shape_a;
 	shape_b = p_shape_b;
 	colliding = false;
+	space = area_a->get_space();
 	area_a->add_constraint(this);
 	area_b->add_constraint(this);
+	space->area2_pair_add_to_list(&area2_pair_list);
 }
 
 Area2PairSW::~Area2PairSW() {
@@ -156,4 +197,5 @@ Area2PairSW::~Area2PairSW() {
 
 	area_a->remove_constraint(this);
 	area_b->remove_constraint(this);
+	space->area2_pair_remove_from_list(&area2_pair_list);
 }
@@ -42,8 +42,32 @@ class AreaPairSW : public ConstraintSW {
 	int body_shape;
 	int area_shape;
 	bool colliding;
+	SpaceSW *space;
+	SelfList<AreaPairSW> area_pair_list;
+
+	void _set_colliding(bool p_colliding);
 
 public:
+	// overlap state saved and restored by space snapshots
+	struct State {
+
+		PairStateKeySW key;
+		uint32_t colliding;
+
+		_FORCE_INLINE_ bool operator<(const State &p_state) const { return key < p_state.key; }
+	};
+
+	_FORCE_INLINE_ void get_state_key(PairStateKeySW &r_key) const {
+
+		r_key.id_A = body->get_self().get_id();
+		r_key.shape_A = body_shape;
+		r_key.id_B = area->get_self().get_id();
+		r_key.shape_B = area_shape;
+	}
+
+	void save_state(State &r_state) const;
+	void restore_state(const State *p_state);
+
 	bool setup(real_t p_step);
 	void solve(real_t p_step);
 
@@ -58,8 +82,32 @@ class Area2PairSW : public ConstraintSW {
 	int shape_a;
 	int shape_b;
 	bool colliding;
+	SpaceSW *space;
+	SelfList<Area2PairSW> area2_pair_list;
+
+	void _set_colliding(bool p_colliding);
 
 public:
+	// overlap state saved and restored by space snapshots
+	struct State {
+
+		PairStateKeySW key;
+		uint32_t colliding;
+
+		_FORCE_INLINE_ bool operator<(const State &p_state) const { return key < p_state.key; }
+	};
+
+	_FORCE_INLINE_ void get_state_key(PairStateKeySW &r_key) const {
+
+		r_key.id_A = area_a->get_self().get_id();
+		r_key.shape_A = shape_a;
+		r_key.id_B = area_b->get_self().get_id();
+		r_key.shape_B = shape_b;
+	}
+
+	void save_state(State &r_state) const;
+	void restore_state(const State *p_state);
+
 	bool setup(real_t p_step);
 	void solve(real_t p_step);
 
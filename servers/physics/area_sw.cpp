@@ -32,17 +32,30 @@
 #include "body_sw.h"
 #include "space_sw.h"
 
-AreaSW::BodyKey::BodyKey(BodySW *p_body, uint32_t p_body_shape, uint32_t p_area_shape) {
-	rid = p_body->get_self();
-	instance_id = p_body->get_instance_id();
-	body_shape = p_body_shape;
-	area_shape = p_area_shape;
+void AreaSW::add_body_to_query(BodySW *p_body, uint32_t p_body_shape, uint32_t p_area_shape) {
+
+	monitored_bodies.add(p_body->get_self(), p_body->get_instance_id(), p_body_shape, p_area_shape, 1);
+	if (!monitor_query_list.in_list())
+		_queue_monitor_update();
+}
+void AreaSW::remove_body_from_query(BodySW *p_body, uint32_t p_body_shape, uint32_t p_area_shape) {
+
+	monitored_bodies.add(p_body->get_self(), p_body->get_instance_id(), p_body_shape, p_area_shape, -1);
+	if (!monitor_query_list.in_list())
+		_queue_monitor_update();
+}
+
+void AreaSW::add_area_to_query(AreaSW *p_area, uint32_t p_area_shape, uint32_t p_self_shape) {
+
+	monitored_areas.add(p_area->get_self(), p_area->get_instance_id(), p_area_shape, p_self_shape, 1);
+	if (!monitor_query_list.in_list())
+		_queue_monitor_update();
 }
-AreaSW::BodyKey::BodyKey(AreaSW *p_body, uint32_t p_body_shape, uint32_t p_area_shape) {
-	rid = p_body->get_self();
-	instance_id = p_body->get_instance_id();
-	body_shape = p_body_shape;
-	area_shape = p_area_shape;
+void AreaSW::remove_area_from_query(AreaSW *p_area, uint32_t p_area_shape, uint32_t p_self_shape) {
+
+	monitored_areas.add(p_area->get_self(), p_area->get_instance_id(), p_area_shape, p_self_shape, -1);
+	if (!monitor_query_list.in_list())
+		_queue_monitor_update();
 }
 
 void AreaSW::_shapes_changed() {
@@ -170,15 +183,47 @@ void AreaSW::set_monitorable(bool p_monitorable) {
 	_set_static(!monitorable);
 }
 
+void AreaSW::_send_monitor_events(Object *p_receiver, const StringName &p_method, const PhysicsAreaMonitorEvents &p_events) {
+
+	if (monitor_batching) {
+
+		// one call with every change of the step
+		if (p_events.pack(monitor_event_buffer, PhysicsServer::AREA_BODY_ADDED, PhysicsServer::AREA_BODY_REMOVED) == 0)
+			return;
+
+		Variant arg = monitor_event_buffer;
+		const Variant *argptr = &arg;
+		Variant::CallError ce;
+		p_receiver->call(p_method, &argptr, 1, ce);
+		return;
+	}
+
+	Variant res[5];
+	Variant *resptr[5];
+	for (int i = 0; i < 5; i++)
+		resptr[i] = &res[i];
+
+	for (int i = 0; i < p_events.size(); i++) {
+
+		const PhysicsAreaMonitorEvents::Event &e = p_events.get(i);
+		if (e.state == 0)
+			continue; //nothing happened
+
+		res[0] = e.state > 0 ? PhysicsServer::AREA_BODY_ADDED : PhysicsServer::AREA_BODY_REMOVED;
+		res[1] = e.rid;
+		res[2] = e.instance_id;
+		res[3] = e.body_shape;
+		res[4] = e.area_shape;
+
+		Variant::CallError ce;
+		p_receiver->call(p_method, (const Variant **)resptr, 5, ce);
+	}
+}
+
 void AreaSW::call_queries() {
 
 	if (monitor_callback_id && !monitored_bodies.empty()) {
 
-		Variant res[5];
-		Variant *resptr[5];
-		for (int i = 0; i < 5; i++)
-			resptr[i] = &res[i];
-
 		Object *obj = ObjectDB::get_instance(monitor_callback_id);
 		if (!obj) {
 			monitored_bodies.clear();
@@ -186,31 +231,13 @@ void AreaSW::call_queries() {
 			return;
 		}
 
-		for (Map<BodyKey, BodyState>::Element *E = monitored_bodies.front(); E; E = E->next()) {
-
-			if (E->get().state == 0)
-				continue; //nothing happened
-
-			res[0] = E->get().state > 0 ? PhysicsServer::AREA_BODY_ADDED : PhysicsServer::AREA_BODY_REMOVED;
-			res[1] = E->key().rid;
-			res[2] = E->key().instance_id;
-			res[3] = E->key().body_shape;
-			res[4] = E->key().area_shape;
-
-			Variant::CallError ce;
-			obj->call(monitor_callback_method, (const Variant **)resptr, 5, ce);
-		}
+		_send_monitor_events(obj, monitor_callback_method, monitored_bodies);
 	}
 
 	monitored_bodies.clear();
 
 	if (area_monitor_callback_id && !monitored_areas.empty()) {
 
-		Variant res[5];
-		Variant *resptr[5];
-		for (int i = 0; i < 5; i++)
-			resptr[i] = &res[i];
-
 		Object *obj = ObjectDB::get_instance(area_monitor_callback_id);
 		if (!obj) {
 			monitored_areas.clear();
@@ -218,23 +245,11 @@ void AreaSW::call_queries() {
 			return;
 		}
 
-		for (Map<BodyKey, BodyState>::Element *E = monitored_areas.front(); E; E = E->next()) {
-
-			if (E->get().state == 0)
-				continue; //nothing happened
-
-			res[0] = E->get().state > 0 ? PhysicsServer::AREA_BODY_ADDED : PhysicsServer::AREA_BODY_REMOVED;
-			res[1] = E->key().rid;
-			res[2] = E->key().instance_id;
-			res[3] = E->key().body_shape;
-			res[4] = E->key().area_shape;
-
-			Variant::CallError ce;
-			obj->call(area_monitor_callback_method, (const Variant **)resptr, 5, ce);
-		}
+		_send_monitor_events(obj, area_monitor_callback_method, monitored_areas);
 	}
 
 	monitored_areas.clear();
+
 	//get_space()->area_remove_from_monitor_query_list(&monitor_query_list);
 }
 
@@ -256,6 +271,7 @@ AreaSW::AreaSW() :
 	set_ray_pickable(false);
 	monitor_callback_id = 0;
 	area_monitor_callback_id = 0;
+	monitor_batching = false;
 	monitorable = false;
 }
 
@@ -33,6 +33,7 @@
 
 #include "collision_object_sw.h"
 #include "self_list.h"
+#include "servers/physics_area_monitor_events.h"
 #include "servers/physics_server.h"
 //#include "servers/physics/query_sw.h"
 
@@ -62,41 +63,13 @@ class AreaSW : public CollisionObjectSW {
 	SelfList<AreaSW> monitor_query_list;
 	SelfList<AreaSW> moved_list;
 
-	struct BodyKey {
+	PhysicsAreaMonitorEvents monitored_bodies;
+	PhysicsAreaMonitorEvents monitored_areas;
 
-		RID rid;
-		ObjectID instance_id;
-		uint32_t body_shape;
-		uint32_t area_shape;
+	bool monitor_batching;
+	PoolVector<int> monitor_event_buffer;
 
-		_FORCE_INLINE_ bool operator<(const BodyKey &p_key) const {
-
-			if (rid == p_key.rid) {
-
-				if (body_shape == p_key.body_shape) {
-
-					return area_shape < p_key.area_shape;
-				} else
-					return body_shape < p_key.body_shape;
-			} else
-				return rid < p_key.rid;
-		}
-
-		_FORCE_INLINE_ BodyKey() {}
-		BodyKey(BodySW *p_body, uint32_t p_body_shape, uint32_t p_area_shape);
-		BodyKey(AreaSW *p_body, uint32_t p_body_shape, uint32_t p_area_shape);
-	};
-
-	struct BodyState {
-
-		int state;
-		_FORCE_INLINE_ void inc() { state++; }
-		_FORCE_INLINE_ void dec() { state--; }
-		_FORCE_INLINE_ BodyState() { state = 0; }
-	};
-
-	Map<BodyKey, BodyState> monitored_bodies;
-	Map<BodyKey, BodyState> monitored_areas;
+	void _send_monitor_events(Object *p_receiver, const StringName &p_method, const PhysicsAreaMonitorEvents &p_events);
 
 	//virtual void shape_changed_notify(ShapeSW *p_shape);
 	//virtual void shape_deleted_notify(ShapeSW *p_shape);
@@ -116,11 +89,14 @@ public:
 	void set_area_monitor_callback(ObjectID p_id, const StringName &p_method);
 	_FORCE_INLINE_ bool has_area_monitor_callback() const { return area_monitor_callback_id; }
 
-	_FORCE_INLINE_ void add_body_to_query(BodySW *p_body, uint32_t p_body_shape, uint32_t p_area_shape);
-	_FORCE_INLINE_ void remove_body_from_query(BodySW *p_body, uint32_t p_body_shape, uint32_t p_area_shape);
+	void set_monitor_batching(bool p_enable) { monitor_batching = p_enable; }
+	_FORCE_INLINE_ bool is_monitor_batching() const { return monitor_batching; }
 
-	_FORCE_INLINE_ void add_area_to_query(AreaSW *p_area, uint32_t p_area_shape, uint32_t p_self_shape);
-	_FORCE_INLINE_ void remove_area_from_query(AreaSW *p_area, uint32_t p_area_shape, uint32_t p_self_shape);
+	void add_body_to_query(BodySW *p_body, uint32_t p_body_shape, uint32_t p_area_shape);
+	void remove_body_from_query(BodySW *p_body, uint32_t p_body_shape, uint32_t p_area_shape);
+
+	void add_area_to_query(AreaSW *p_area, uint32_t p_area_shape, uint32_t p_self_shape);
+	void remove_area_from_query(AreaSW *p_area, uint32_t p_area_shape, uint32_t p_self_shape);
 
 	void set_param(PhysicsServer::AreaParameter p_param, const Variant &p_value);
 	Variant get_param(PhysicsServer::AreaParameter p_param) const;
@@ -170,34 +146,4 @@ public:
 	~AreaSW();
 };
 
-void AreaSW::add_body_to_query(BodySW *p_body, uint32_t p_body_shape, uint32_t p_area_shape) {
-
-	BodyKey bk(p_body, p_body_shape, p_area_shape);
-	monitored_bodies[bk].inc();
-	if (!monitor_query_list.in_list())
-		_queue_monitor_update();
-}
-void AreaSW::remove_body_from_query(BodySW *p_body, uint32_t p_body_shape, uint32_t p_area_shape) {
-
-	BodyKey bk(p_body, p_body_shape, p_area_shape);
-	monitored_bodies[bk].dec();
-	if (!monitor_query_list.in_list())
-		_queue_monitor_update();
-}
-
-void AreaSW::add_area_to_query(AreaSW *p_area, uint32_t p_area_shape, uint32_t p_self_shape) {
-
-	BodyKey bk(p_area, p_area_shape, p_self_shape);
-	monitored_areas[bk].inc();
-	if (!monitor_query_list.in_list())
-		_queue_monitor_update();
-}
-void AreaSW::remove_area_from_query(AreaSW *p_area, uint32_t p_area_shape, uint32_t p_self_shape) {
-
-	BodyKey bk(p_area, p_area_shape, p_self_shape);
-	monitored_areas[bk].dec();
-	if (!monitor_query_list.in_list())
-		_queue_monitor_update();
-}
-
 #endif // AREA__SW_H
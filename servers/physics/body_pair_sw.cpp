@@ -48,6 +48,8 @@
 #define RELAXATION_TIMESTEPS 3
 #define MIN_VELOCITY 0.0001
 #define MAX_BIAS_ROTATION (Math_PI / 8)
+// fraction of the contact recycle radius the shapes may drift relative to each other before the narrow phase runs again
+#define MANIFOLD_REUSE_RATIO 0.25
 
 void BodyPairSW::_contact_added_callback(const Vector3 &p_point_A, const Vector3 &p_point_B, void *p_userdata) {
 
@@ -79,24 +81,32 @@ void BodyPairSW::contact_added_callback(const Vector3 &p_point_A, const Vector3
 	contact.local_B = local_B;
 	contact.normal = (p_point_A - p_point_B).normalized();
 
-	// attempt to determine if the contact will be reused
+	// attempt to determine if the contact will be reused, pick the closest previous contact
+	// so neighbouring points do not steal each other's accumulated impulses
 	real_t contact_recycle_radius = space->get_contact_recycle_radius();
+	real_t closest_dist = contact_recycle_radius * contact_recycle_radius;
 
 	for (int i = 0; i < contact_count; i++) {
 
 		Contact &c = contacts[i];
-		if (c.local_A.distance_squared_to(local_A) < (contact_recycle_radius * contact_recycle_radius) &&
-				c.local_B.distance_squared_to(local_B) < (contact_recycle_radius * contact_recycle_radius)) {
+		real_t dist_A = c.local_A.distance_squared_to(local_A);
+		real_t dist_B = c.local_B.distance_squared_to(local_B);
+		if (dist_A < (contact_recycle_radius * contact_recycle_radius) && dist_B < (contact_recycle_radius * contact_recycle_radius) && dist_A + dist_B < closest_dist) {
 
-			contact.acc_normal_impulse = c.acc_normal_impulse;
-			contact.acc_bias_impulse = c.acc_bias_impulse;
-			contact.acc_bias_impulse_center_of_mass = c.acc_bias_impulse_center_of_mass;
-			contact.acc_tangent_impulse = c.acc_tangent_impulse;
+			closest_dist = dist_A + dist_B;
 			new_index = i;
-			break;
 		}
 	}
 
+	if (new_index < contact_count) {
+
+		Contact &c = contacts[new_index];
+		contact.acc_normal_impulse = c.acc_normal_impulse;
+		contact.acc_bias_impulse = c.acc_bias_impulse;
+		contact.acc_bias_impulse_center_of_mass = c.acc_bias_impulse_center_of_mass;
+		contact.acc_tangent_impulse = c.acc_tangent_impulse;
+	}
+
 	// figure out if the contact amount must be reduced to fit the new contact
 
 	if (new_index == MAX_CONTACTS) {
@@ -185,6 +195,8 @@ bool BodyPairSW::_test_ccd(real_t p_step, BodySW *p_A, int p_shape_A, const Tran
 		return false;
 	}
 
+	space->add_step_counter(SpaceSW::STEP_COUNTER_CCD_SWEEPS);
+
 	//cast a segment from support in motion normal, in the same direction of motion by motion length
 	//support is the worst case collision point, so real collision happened before
 	Vector3 s = p_A->get_shape(p_shape_A)->get_support(p_xform_A.basis.xform(mnormal).normalized());
@@ -210,16 +222,55 @@ bool BodyPairSW::_test_ccd(real_t p_step, BodySW *p_A, int p_shape_A, const Tran
 	return true;
 }
 
+static _FORCE_INLINE_ real_t _get_shape_radius(const ShapeSW *p_shape) {
+
+	// distance from the shape origin to the farthest corner of its bounds
+	AABB aabb = p_shape->get_aabb();
+	Vector3 end = aabb.position + aabb.size;
+	Vector3 extent(MAX(Math::abs(aabb.position.x), Math::abs(end.x)), MAX(Math::abs(aabb.position.y), Math::abs(end.y)), MAX(Math::abs(aabb.position.z), Math::abs(end.z)));
+	return extent.length();
+}
+
+bool BodyPairSW::_is_manifold_reusable(const ShapeSW *p_shape_A, const Transform &p_xform_A, const ShapeSW *p_shape_B, const Transform &p_xform_B, Transform &r_rel_xform) const {
+
+	// express the smaller shape in the frame of the larger one, so how far its points
+	// can have moved is bounded by its own size
+	real_t radius_A = _get_shape_radius(p_shape_A);
+	real_t radius_B = _get_shape_radius(p_shape_B);
+	real_t radius;
+
+	if (radius_A < radius_B) {
+		r_rel_xform = p_xform_B.affine_inverse() * p_xform_A;
+		radius = radius_A;
+	} else {
+		r_rel_xform = p_xform_A.affine_inverse() * p_xform_B;
+		radius = radius_B;
+	}
+
+	if (!manifold_valid || manifold_version_A != p_shape_A->get_version() || manifold_version_B != p_shape_B->get_version())
+		return false;
+
+	real_t basis_diff = 0;
+	for (int i = 0; i < 3; i++) {
+		basis_diff += r_rel_xform.basis.elements[i].distance_squared_to(manifold_xform.basis.elements[i]);
+	}
+
+	real_t max_motion = space->get_contact_recycle_radius() * MANIFOLD_REUSE_RATIO;
+	return r_rel_xform.origin.distance_to(manifold_xform.origin) + Math::sqrt(basis_diff) * radius < max_motion;
+}
+
 bool BodyPairSW::setup(real_t p_step) {
 
 	//cannot collide
 	if (!A->test_collision_mask(B) || A->has_exception(B->get_self()) || B->has_exception(A->get_self()) || (A->get_mode() <= PhysicsServer::BODY_MODE_KINEMATIC && B->get_mode() <= PhysicsServer::BODY_MODE_KINEMATIC && A->get_max_contacts_reported() == 0 && B->get_max_contacts_reported() == 0)) {
 		collided = false;
+		manifold_valid = false;
 		return false;
 	}
 
 	if (A->is_shape_set_as_disabled(shape_A) || B->is_shape_set_as_disabled(shape_B)) {
 		collided = false;
+		manifold_valid = false;
 		return false;
 	}
 
@@ -238,8 +289,19 @@ bool BodyPairSW::setup(real_t p_step) {
 	ShapeSW *shape_A_ptr = A->get_shape(shape_A);
 	ShapeSW *shape_B_ptr = B->get_shape(shape_B);
 
-	bool collided = CollisionSolverSW::solve_static(shape_A_ptr, xform_A, shape_B_ptr, xform_B, _contact_added_callback, this, &sep_axis);
-	this->collided = collided;
+	Transform rel_xform;
+
+	if (!_is_manifold_reusable(shape_A_ptr, xform_A, shape_B_ptr, xform_B, rel_xform)) {
+
+		space->add_step_counter(SpaceSW::STEP_COUNTER_PAIRS_TESTED);
+
+		collided = CollisionSolverSW::solve_static(shape_A_ptr, xform_A, shape_B_ptr, xform_B, _contact_added_callback, this, &sep_axis);
+
+		manifold_xform = rel_xform;
+		manifold_version_A = shape_A_ptr->get_version();
+		manifold_version_B = shape_B_ptr->get_version();
+		manifold_valid = true;
+	}
 
 	if (!collided) {
 
@@ -256,6 +318,8 @@ bool BodyPairSW::setup(real_t p_step) {
 		return false;
 	}
 
+	space->add_step_counter(SpaceSW::STEP_COUNTER_CONTACTS, contact_count);
+
 	real_t max_penetration = space->get_contact_max_allowed_penetration();
 
 	real_t bias = (real_t)0.3;
@@ -465,8 +529,47 @@ void BodyPairSW::solve(real_t p_step) {
 	}
 }
 
+void BodyPairSW::save_state(State &r_state) const {
+
+	get_state_key(r_state.key);
+	r_state.sep_axis = sep_axis;
+	r_state.contact_count = contact_count;
+	for (int i = 0; i < MAX_CONTACTS; i++) {
+		r_state.contacts[i] = contacts[i];
+	}
+	r_state.manifold_xform = manifold_xform;
+	r_state.manifold_version_A = manifold_version_A;
+	r_state.manifold_version_B = manifold_version_B;
+	r_state.manifold_valid = manifold_valid;
+	r_state.collided = collided;
+}
+
+void BodyPairSW::restore_state(const State *p_state) {
+
+	if (!p_state) {
+		// pair did not exist when the snapshot was taken
+		sep_axis = Vector3();
+		contact_count = 0;
+		collided = false;
+		manifold_valid = false;
+		return;
+	}
+
+	sep_axis = p_state->sep_axis;
+	contact_count = p_state->contact_count;
+	for (int i = 0; i < MAX_CONTACTS; i++) {
+		contacts[i] = p_state->contacts[i];
+	}
+	manifold_xform = p_state->manifold_xform;
+	manifold_version_A = p_state->manifold_version_A;
+	manifold_version_B = p_state->manifold_version_B;
+	manifold_valid = p_state->manifold_valid;
+	collided = p_state->collided;
+}
+
 BodyPairSW::BodyPairSW(BodySW *p_A, int p_shape_A, BodySW *p_B, int p_shape_B) :
-		ConstraintSW(_arr, 2) {
+		ConstraintSW(_arr, 2),
+		body_pair_list(this) {
 
 	A = p_A;
 	B = p_B;
@@ -477,10 +580,15 @@ BodyPairSW::BodyPairSW(BodySW *p_A, int p_shape_A, BodySW *p_B, int p_shape_B) :
 	B->add_constraint(this, 1);
 	contact_count = 0;
 	collided = false;
+	manifold_version_A = 0;
+	manifold_version_B = 0;
+	manifold_valid = false;
+	space->body_pair_add_to_list(&body_pair_list);
 }
 
 BodyPairSW::~BodyPairSW() {
 
 	A->remove_constraint(this);
 	B->remove_constraint(this);
+	space->body_pair_remove_from_list(&body_pair_list);
 }
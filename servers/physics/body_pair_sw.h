@@ -78,6 +78,15 @@ class BodyPairSW : public ConstraintSW {
 	bool collided;
 	int cc;
 
+	// relative transform of the smaller shape in the frame of the larger one when the narrow phase last ran,
+	// the manifold is kept as is while it barely changes
+	Transform manifold_xform;
+	uint32_t manifold_version_A;
+	uint32_t manifold_version_B;
+	bool manifold_valid;
+
+	bool _is_manifold_reusable(const ShapeSW *p_shape_A, const Transform &p_xform_A, const ShapeSW *p_shape_B, const Transform &p_xform_B, Transform &r_rel_xform) const;
+
 	static void _contact_added_callback(const Vector3 &p_point_A, const Vector3 &p_point_B, void *p_userdata);
 
 	void contact_added_callback(const Vector3 &p_point_A, const Vector3 &p_point_B);
@@ -86,8 +95,39 @@ class BodyPairSW : public ConstraintSW {
 	bool _test_ccd(real_t p_step, BodySW *p_A, int p_shape_A, const Transform &p_xform_A, BodySW *p_B, int p_shape_B, const Transform &p_xform_B);
 
 	SpaceSW *space;
+	SelfList<BodyPairSW> body_pair_list;
 
 public:
+	// contact cache saved and restored by space snapshots
+	struct State {
+
+		PairStateKeySW key;
+		Vector3 sep_axis;
+		uint32_t contact_count;
+		Contact contacts[MAX_CONTACTS];
+		Transform manifold_xform;
+		uint32_t manifold_version_A;
+		uint32_t manifold_version_B;
+		bool manifold_valid;
+		bool collided;
+
+		_FORCE_INLINE_ bool operator<(const State &p_state) const { return key < p_state.key; }
+	};
+
+	// a state record is restored from user data, its contact count must fit the contacts array
+	static _FORCE_INLINE_ bool is_state_valid(const State &p_state) { return p_state.contact_count <= MAX_CONTACTS; }
+
+	_FORCE_INLINE_ void get_state_key(PairStateKeySW &r_key) const {
+
+		r_key.id_A = A->get_self().get_id();
+		r_key.shape_A = shape_A;
+		r_key.id_B = B->get_self().get_id();
+		r_key.shape_B = shape_B;
+	}
+
+	void save_state(State &r_state) const;
+	void restore_state(const State *p_state);
+
 	bool setup(real_t p_step);
 	void solve(real_t p_step);
 
@@ -279,6 +279,13 @@ void BodySW::_shapes_changed() {
 	_update_inertia();
 }
 
+void BodySW::_shape_data_changed() {
+
+	_shapes_changed();
+	// bodies resting on the old data may have fallen asleep on it
+	wakeup_neighbours();
+}
+
 void BodySW::set_state(PhysicsServer::BodyState p_state, const Variant &p_variant) {
 
 	switch (p_state) {
@@ -569,7 +576,8 @@ void BodySW::integrate_velocities(real_t p_step) {
 	if (mode == PhysicsServer::BODY_MODE_STATIC)
 		return;
 
-	if (fi_callback)
+	// queued even without a callback, so the body is reported in the space's active transforms
+	if (!direct_state_query_list.in_list())
 		get_space()->body_add_to_state_query_list(&direct_state_query_list);
 
 	//apply axis lock linear
@@ -732,6 +740,42 @@ bool BodySW::sleep_test(real_t p_step) {
 	}
 }
 
+void BodySW::save_state(State &r_state) const {
+
+	r_state.transform = get_transform();
+	r_state.new_transform = new_transform;
+	r_state.linear_velocity = linear_velocity;
+	r_state.angular_velocity = angular_velocity;
+	r_state.applied_force = applied_force;
+	r_state.applied_torque = applied_torque;
+	r_state.still_time = still_time;
+	r_state.active = active;
+}
+
+void BodySW::restore_state(const State &p_state) {
+
+	// most bodies of a snapshot are usually sleeping, avoid touching the broadphase for them
+	if (get_transform() != p_state.transform) {
+		_set_transform(p_state.transform);
+		_set_inv_transform(get_transform().affine_inverse());
+		_update_transform_dependant();
+
+		// let the owner know about the new transform on the next query flush
+		if (get_space() && !direct_state_query_list.in_list())
+			get_space()->body_add_to_state_query_list(&direct_state_query_list);
+	}
+
+	new_transform = p_state.new_transform;
+	linear_velocity = p_state.linear_velocity;
+	angular_velocity = p_state.angular_velocity;
+	biased_linear_velocity = Vector3();
+	biased_angular_velocity = Vector3();
+	applied_force = p_state.applied_force;
+	applied_torque = p_state.applied_torque;
+	still_time = p_state.still_time;
+	set_active(p_state.active);
+}
+
 void BodySW::set_force_integration_callback(ObjectID p_id, const StringName &p_method, const Variant &p_udata) {
 
 	if (fi_callback) {
@@ -94,6 +94,7 @@ class BodySW : public CollisionObjectSW {
 	bool first_time_kinematic;
 	void _update_inertia();
 	virtual void _shapes_changed();
+	virtual void _shape_data_changed();
 	Transform new_transform;
 
 	Map<ConstraintSW *, int> constraint_map;
@@ -149,6 +150,22 @@ class BodySW : public CollisionObjectSW {
 	friend class PhysicsDirectBodyStateSW; // i give up, too many functions to expose
 
 public:
+	// simulation state saved and restored by space snapshots
+	struct State {
+
+		Transform transform;
+		Transform new_transform;
+		Vector3 linear_velocity;
+		Vector3 angular_velocity;
+		Vector3 applied_force;
+		Vector3 applied_torque;
+		real_t still_time;
+		uint32_t active;
+	};
+
+	void save_state(State &r_state) const;
+	void restore_state(const State &p_state);
+
 	void set_force_integration_callback(ObjectID p_id, const StringName &p_method, const Variant &p_udata = Variant());
 
 	void set_kinematic_margin(real_t p_margin);
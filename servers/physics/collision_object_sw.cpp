@@ -218,6 +218,11 @@ void CollisionObjectSW::_shape_changed() {
 	_shapes_changed();
 }
 
+void CollisionObjectSW::_shape_data_changed() {
+
+	_shapes_changed();
+}
+
 CollisionObjectSW::CollisionObjectSW(Type p_type) :
 		pending_shape_update_list(this) {
 
@@ -116,6 +116,7 @@ public:
 	_FORCE_INLINE_ ObjectID get_instance_id() const { return instance_id; }
 
 	void _shape_changed();
+	virtual void _shape_data_changed();
 
 	_FORCE_INLINE_ Type get_type() const { return type; }
 	void add_shape(ShapeSW *p_shape, const Transform &p_transform = Transform());
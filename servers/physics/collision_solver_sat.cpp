@@ -346,6 +346,8 @@ public:
 
 		if (min_B > 0.0 || max_B < 0.0) {
 			separator_axis = axis;
+			if (callback && callback->prev_axis)
+				*callback->prev_axis = axis; // test it first on the next step, most pairs stay separated along it
 			return false; // doesn't contain 0
 		}
 
@@ -33,6 +33,31 @@
 
 #include "body_sw.h"
 
+// identifies a broadphase pair constraint inside a space state snapshot
+struct PairStateKeySW {
+
+	uint32_t id_A;
+	uint32_t shape_A;
+	uint32_t id_B;
+	uint32_t shape_B;
+
+	_FORCE_INLINE_ bool operator<(const PairStateKeySW &p_key) const {
+
+		if (id_A != p_key.id_A)
+			return id_A < p_key.id_A;
+		if (shape_A != p_key.shape_A)
+			return shape_A < p_key.shape_A;
+		if (id_B != p_key.id_B)
+			return id_B < p_key.id_B;
+		return shape_B < p_key.shape_B;
+	}
+
+	_FORCE_INLINE_ bool operator==(const PairStateKeySW &p_key) const {
+
+		return id_A == p_key.id_A && shape_A == p_key.shape_A && id_B == p_key.id_B && shape_B == p_key.shape_B;
+	}
+};
+
 class ConstraintSW : public RID_Data {
 
 	BodySW **_body_ptr;
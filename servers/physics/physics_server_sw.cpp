@@ -212,6 +212,32 @@ int PhysicsServerSW::space_get_contact_count(RID p_space) const {
 	return space->get_debug_contact_count();
 }
 
+int PhysicsServerSW::space_get_active_transforms(RID p_space, const ActiveTransform **r_transforms) const {
+
+	SpaceSW *space = space_owner.get(p_space);
+	ERR_FAIL_COND_V(!space, 0);
+	*r_transforms = space->get_active_transforms().ptr();
+	return space->get_active_transform_count();
+}
+
+PoolVector<uint8_t> PhysicsServerSW::space_save_state(RID p_space) const {
+
+	const SpaceSW *space = space_owner.get(p_space);
+	ERR_FAIL_COND_V(!space, PoolVector<uint8_t>());
+
+	PoolVector<uint8_t> state;
+	space->save_state(state);
+	return state;
+}
+
+Error PhysicsServerSW::space_restore_state(RID p_space, const PoolVector<uint8_t> &p_state) {
+
+	SpaceSW *space = space_owner.get(p_space);
+	ERR_FAIL_COND_V(!space, ERR_INVALID_PARAMETER);
+
+	return space->restore_state(p_state);
+}
+
 RID PhysicsServerSW::area_create() {
 
 	AreaSW *area = memnew(AreaSW);
@@ -460,6 +486,14 @@ void PhysicsServerSW::area_set_area_monitor_callback(RID p_area, Object *p_recei
 	area->set_area_monitor_callback(p_receiver ? p_receiver->get_instance_id() : 0, p_method);
 }
 
+void PhysicsServerSW::area_set_monitor_batching(RID p_area, bool p_enable) {
+
+	AreaSW *area = area_owner.get(p_area);
+	ERR_FAIL_COND(!area);
+
+	area->set_monitor_batching(p_enable);
+}
+
 /* BODY API */
 
 RID PhysicsServerSW::body_create(BodyMode p_mode, bool p_init_sleeping) {
@@ -1348,12 +1382,21 @@ void PhysicsServerSW::step(real_t p_step) {
 	island_count = 0;
 	active_objects = 0;
 	collision_pairs = 0;
+	for (int i = 0; i < SpaceSW::ELAPSED_TIME_MAX; i++)
+		elapsed_time[i] = 0;
+	for (int i = 0; i < SpaceSW::STEP_COUNTER_MAX; i++)
+		step_counter[i] = 0;
 	for (Set<const SpaceSW *>::Element *E = active_spaces.front(); E; E = E->next()) {
 
 		stepper->step((SpaceSW *)E->get(), p_step, iterations);
 		island_count += E->get()->get_island_count();
 		active_objects += E->get()->get_active_objects();
 		collision_pairs += E->get()->get_collision_pairs();
+
+		for (int i = 0; i < SpaceSW::ELAPSED_TIME_MAX; i++)
+			elapsed_time[i] += E->get()->get_elapsed_time(SpaceSW::ElapsedTime(i));
+		for (int i = 0; i < SpaceSW::STEP_COUNTER_MAX; i++)
+			step_counter[i] += E->get()->get_step_counter(SpaceSW::StepCounter(i));
 	}
 }
 
@@ -1370,39 +1413,32 @@ void PhysicsServerSW::flush_queries() {
 
 	uint64_t time_beg = OS::get_singleton()->get_ticks_usec();
 
+	elapsed_time[SpaceSW::ELAPSED_TIME_AREA_QUERIES] = 0;
+
 	for (Set<const SpaceSW *>::Element *E = active_spaces.front(); E; E = E->next()) {
 
 		SpaceSW *space = (SpaceSW *)E->get();
 		space->call_queries();
+		elapsed_time[SpaceSW::ELAPSED_TIME_AREA_QUERIES] += space->get_elapsed_time(SpaceSW::ELAPSED_TIME_AREA_QUERIES);
 	}
 
 	if (ScriptDebugger::get_singleton() && ScriptDebugger::get_singleton()->is_profiling()) {
 
-		uint64_t total_time[SpaceSW::ELAPSED_TIME_MAX];
 		static const char *time_name[SpaceSW::ELAPSED_TIME_MAX] = {
 			"integrate_forces",
 			"generate_islands",
 			"setup_constraints",
 			"solve_constraints",
-			"integrate_velocities"
+			"integrate_velocities",
+			"broad_phase",
+			"area_queries"
 		};
 
-		for (int i = 0; i < SpaceSW::ELAPSED_TIME_MAX; i++) {
-			total_time[i] = 0;
-		}
-
-		for (Set<const SpaceSW *>::Element *E = active_spaces.front(); E; E = E->next()) {
-
-			for (int i = 0; i < SpaceSW::ELAPSED_TIME_MAX; i++) {
-				total_time[i] += E->get()->get_elapsed_time(SpaceSW::ElapsedTime(i));
-			}
-		}
-
 		Array values;
 		values.resize(SpaceSW::ELAPSED_TIME_MAX * 2);
 		for (int i = 0; i < SpaceSW::ELAPSED_TIME_MAX; i++) {
 			values[i * 2 + 0] = time_name[i];
-			values[i * 2 + 1] = USEC_TO_SEC(total_time[i]);
+			values[i * 2 + 1] = USEC_TO_SEC(elapsed_time[i]);
 		}
 		values.push_back("flush_queries");
 		values.push_back(USEC_TO_SEC(OS::get_singleton()->get_ticks_usec() - time_beg));
@@ -1411,6 +1447,11 @@ void PhysicsServerSW::flush_queries() {
 	}
 };
 
+void PhysicsServerSW::end_sync() {
+
+	doing_sync = false;
+}
+
 void PhysicsServerSW::finish() {
 
 	memdelete(stepper);
@@ -1432,6 +1473,41 @@ int PhysicsServerSW::get_process_info(ProcessInfo p_info) {
 
 			return island_count;
 		} break;
+		case INFO_STEP_TIME: {
+
+			uint64_t total = 0;
+			for (int i = 0; i < SpaceSW::ELAPSED_TIME_AREA_QUERIES; i++)
+				total += elapsed_time[i];
+			return total;
+		} break;
+		case INFO_BROAD_PHASE_TIME: {
+			return elapsed_time[SpaceSW::ELAPSED_TIME_BROAD_PHASE];
+		} break;
+		case INFO_ISLAND_TIME: {
+			return elapsed_time[SpaceSW::ELAPSED_TIME_GENERATE_ISLANDS];
+		} break;
+		case INFO_NARROW_PHASE_TIME: {
+			// contacts are generated while setting up the constraints
+			return elapsed_time[SpaceSW::ELAPSED_TIME_SETUP_CONSTRAINTS];
+		} break;
+		case INFO_SOLVER_TIME: {
+			return elapsed_time[SpaceSW::ELAPSED_TIME_SOLVE_CONSTRAINTS];
+		} break;
+		case INFO_INTEGRATION_TIME: {
+			return elapsed_time[SpaceSW::ELAPSED_TIME_INTEGRATE_FORCES] + elapsed_time[SpaceSW::ELAPSED_TIME_INTEGRATE_VELOCITIES];
+		} break;
+		case INFO_AREA_QUERY_TIME: {
+			return elapsed_time[SpaceSW::ELAPSED_TIME_AREA_QUERIES];
+		} break;
+		case INFO_PAIRS_TESTED: {
+			return step_counter[SpaceSW::STEP_COUNTER_PAIRS_TESTED];
+		} break;
+		case INFO_CONTACT_COUNT: {
+			return step_counter[SpaceSW::STEP_COUNTER_CONTACTS];
+		} break;
+		case INFO_CCD_SWEEPS: {
+			return step_counter[SpaceSW::STEP_COUNTER_CCD_SWEEPS];
+		} break;
 	}
 
 	return 0;
@@ -1486,6 +1562,10 @@ PhysicsServerSW::PhysicsServerSW() {
 	island_count = 0;
 	active_objects = 0;
 	collision_pairs = 0;
+	for (int i = 0; i < SpaceSW::ELAPSED_TIME_MAX; i++)
+		elapsed_time[i] = 0;
+	for (int i = 0; i < SpaceSW::STEP_COUNTER_MAX; i++)
+		step_counter[i] = 0;
 
 	active = true;
 };
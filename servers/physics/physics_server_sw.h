@@ -50,6 +50,8 @@ class PhysicsServerSW : public PhysicsServer {
 	int island_count;
 	int active_objects;
 	int collision_pairs;
+	uint64_t elapsed_time[SpaceSW::ELAPSED_TIME_MAX];
+	int step_counter[SpaceSW::STEP_COUNTER_MAX];
 
 	StepSW *stepper;
 	Set<const SpaceSW *> active_spaces;
@@ -102,6 +104,10 @@ public:
 	virtual void space_set_debug_contacts(RID p_space, int p_max_contacts);
 	virtual Vector<Vector3> space_get_contacts(RID p_space) const;
 	virtual int space_get_contact_count(RID p_space) const;
+	virtual int space_get_active_transforms(RID p_space, const ActiveTransform **r_transforms) const;
+
+	virtual PoolVector<uint8_t> space_save_state(RID p_space) const;
+	virtual Error space_restore_state(RID p_space, const PoolVector<uint8_t> &p_state);
 
 	/* AREA API */
 
@@ -145,6 +151,7 @@ public:
 
 	virtual void area_set_monitor_callback(RID p_area, Object *p_receiver, const StringName &p_method);
 	virtual void area_set_area_monitor_callback(RID p_area, Object *p_receiver, const StringName &p_method);
+	virtual void area_set_monitor_batching(RID p_area, bool p_enable);
 
 	/* BODY API */
 
@@ -284,6 +291,7 @@ public:
 	virtual void step(real_t p_step);
 	virtual void sync();
 	virtual void flush_queries();
+	virtual void end_sync();
 	virtual void finish();
 
 	int get_process_info(ProcessInfo p_info);
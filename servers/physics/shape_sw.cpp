@@ -38,15 +38,27 @@
 #define _EDGE_IS_VALID_SUPPORT_THRESHOLD 0.0002
 #define _FACE_IS_VALID_SUPPORT_THRESHOLD 0.9998
 
+uint32_t ShapeSW::last_version = 0;
+
 void ShapeSW::configure(const AABB &p_aabb) {
 	aabb = p_aabb;
 	configured = true;
+	version = ++last_version;
 	for (Map<ShapeOwnerSW *, int>::Element *E = owners.front(); E; E = E->next()) {
 		ShapeOwnerSW *co = (ShapeOwnerSW *)E->key();
 		co->_shape_changed();
 	}
 }
 
+void ShapeSW::data_changed() {
+
+	version = ++last_version;
+	for (Map<ShapeOwnerSW *, int>::Element *E = owners.front(); E; E = E->next()) {
+		ShapeOwnerSW *co = (ShapeOwnerSW *)E->key();
+		co->_shape_data_changed();
+	}
+}
+
 Vector3 ShapeSW::get_support(const Vector3 &p_normal) const {
 
 	Vector3 res;
@@ -88,6 +100,7 @@ ShapeSW::ShapeSW() {
 
 	custom_bias = 0;
 	configured = false;
+	version = 0;
 }
 
 ShapeSW::~ShapeSW() {
@@ -1575,8 +1588,137 @@ Vector3 HeightMapShapeSW::get_support(const Vector3 &p_normal) const {
 	return get_aabb().get_support(p_normal);
 }
 
+void HeightMapShapeSW::_get_cell_triangle(const real_t *p_heights, int p_x, int p_z, int p_idx, Vector3 *r_vertices) const {
+
+	// both triangles are wound so their normal points up (+Y)
+	if (p_idx == 0) {
+		r_vertices[0] = _get_vertex(p_heights, p_x, p_z);
+		r_vertices[1] = _get_vertex(p_heights, p_x + 1, p_z);
+		r_vertices[2] = _get_vertex(p_heights, p_x, p_z + 1);
+	} else {
+		r_vertices[0] = _get_vertex(p_heights, p_x + 1, p_z);
+		r_vertices[1] = _get_vertex(p_heights, p_x + 1, p_z + 1);
+		r_vertices[2] = _get_vertex(p_heights, p_x, p_z + 1);
+	}
+}
+
+bool HeightMapShapeSW::_intersect_cell(const real_t *p_heights, int p_x, int p_z, const Vector3 &p_begin, const Vector3 &p_end, Vector3 &r_point, Vector3 &r_normal) const {
+
+	bool collided = false;
+	real_t min_d = 1e20;
+	Vector3 dir = p_end - p_begin;
+
+	for (int i = 0; i < 2; i++) {
+
+		Vector3 vertices[3];
+		_get_cell_triangle(p_heights, p_x, p_z, i, vertices);
+
+		Vector3 res;
+		if (!Geometry::segment_intersects_triangle(p_begin, p_end, vertices[0], vertices[1], vertices[2], &res))
+			continue;
+
+		real_t d = dir.dot(res - p_begin);
+		if (d < min_d) {
+			min_d = d;
+			r_point = res;
+			r_normal = Plane(vertices[0], vertices[1], vertices[2]).normal;
+			collided = true;
+		}
+	}
+
+	return collided;
+}
+
 bool HeightMapShapeSW::intersect_segment(const Vector3 &p_begin, const Vector3 &p_end, Vector3 &r_point, Vector3 &r_normal) const {
 
+	if (mip_levels.empty())
+		return false;
+
+	// clip the segment against the shape bounds, working in segment parameter space
+
+	AABB bounds = get_aabb().grow(CMP_EPSILON);
+	Vector3 dir = p_end - p_begin;
+	real_t t_min = 0;
+	real_t t_max = 1;
+
+	for (int i = 0; i < 3; i++) {
+
+		real_t from = bounds.position[i];
+		real_t to = bounds.position[i] + bounds.size[i];
+
+		if (Math::abs(dir[i]) < CMP_EPSILON) {
+			if (p_begin[i] < from || p_begin[i] > to)
+				return false;
+			continue;
+		}
+
+		real_t t0 = (from - p_begin[i]) / dir[i];
+		real_t t1 = (to - p_begin[i]) / dir[i];
+		if (t0 > t1)
+			SWAP(t0, t1);
+
+		t_min = MAX(t_min, t0);
+		t_max = MIN(t_max, t1);
+		if (t_min > t_max)
+			return false;
+	}
+
+	// walk the cells crossed by the segment in order (DDA), so the first hit found is the closest one
+
+	const MipLevel &cells = mip_levels[0];
+
+	PoolVector<real_t>::Read hr = heights.read();
+	PoolVector<Range>::Read rr = mip_ranges.read();
+	const real_t *h = hr.ptr();
+	const Range *ranges = rr.ptr();
+
+	Vector3 from = p_begin + dir * t_min;
+	int x = CLAMP(int(Math::floor(from.x / cell_size)), 0, cells.width - 1);
+	int z = CLAMP(int(Math::floor(from.z / cell_size)), 0, cells.depth - 1);
+
+	int step_x = dir.x > CMP_EPSILON ? 1 : (dir.x < -CMP_EPSILON ? -1 : 0);
+	int step_z = dir.z > CMP_EPSILON ? 1 : (dir.z < -CMP_EPSILON ? -1 : 0);
+
+	real_t t_delta_x = step_x ? cell_size / Math::abs(dir.x) : 1e20;
+	real_t t_delta_z = step_z ? cell_size / Math::abs(dir.z) : 1e20;
+	real_t t_next_x = step_x ? ((x + (step_x > 0 ? 1 : 0)) * cell_size - p_begin.x) / dir.x : 1e20;
+	real_t t_next_z = step_z ? ((z + (step_z > 0 ? 1 : 0)) * cell_size - p_begin.z) / dir.z : 1e20;
+
+	real_t t = t_min;
+
+	while (true) {
+
+		real_t t_exit = MIN(MIN(t_next_x, t_next_z), t_max);
+
+		// reject cells whose height range the segment does not cross
+		real_t y0 = p_begin.y + dir.y * t;
+		real_t y1 = p_begin.y + dir.y * t_exit;
+		const Range &r = ranges[z * cells.width + x];
+
+		if (MIN(y0, y1) <= r.max + CMP_EPSILON && MAX(y0, y1) >= r.min - CMP_EPSILON) {
+
+			if (_intersect_cell(h, x, z, p_begin, p_end, r_point, r_normal))
+				return true;
+		}
+
+		if (t_exit >= t_max)
+			break;
+
+		if (t_next_x < t_next_z) {
+			x += step_x;
+			if (x < 0 || x >= cells.width)
+				break;
+			t = t_next_x;
+			t_next_x += t_delta_x;
+		} else {
+			z += step_z;
+			if (z < 0 || z >= cells.depth)
+				break;
+			t = t_next_z;
+			t_next_z += t_delta_z;
+		}
+	}
+
 	return false;
 }
 
@@ -1589,7 +1731,76 @@ Vector3 HeightMapShapeSW::get_closest_point_to(const Vector3 &p_point) const {
 	return Vector3();
 }
 
+void HeightMapShapeSW::_cull(int p_level, int p_x, int p_z, _CullParams *p_params) const {
+
+	const MipLevel &level = mip_levels[p_level];
+	const Range &r = p_params->ranges[level.offset + p_z * level.width + p_x];
+
+	int cells_w = mip_levels[0].width;
+	int cells_d = mip_levels[0].depth;
+
+	int from_x = p_x << p_level;
+	int from_z = p_z << p_level;
+	int to_x = MIN((p_x + 1) << p_level, cells_w);
+	int to_z = MIN((p_z + 1) << p_level, cells_d);
+
+	AABB aabb(Vector3(from_x * cell_size, r.min, from_z * cell_size), Vector3((to_x - from_x) * cell_size, r.max - r.min, (to_z - from_z) * cell_size));
+
+	if (!p_params->aabb.intersects(aabb))
+		return;
+
+	if (p_level == 0) {
+
+		FaceShapeSW *face = p_params->face;
+
+		for (int i = 0; i < 2; i++) {
+
+			_get_cell_triangle(p_params->heights, p_x, p_z, i, face->vertex);
+			face->normal = Plane(face->vertex[0], face->vertex[1], face->vertex[2]).normal;
+			p_params->callback(p_params->userdata, face);
+		}
+
+		return;
+	}
+
+	const MipLevel &child = mip_levels[p_level - 1];
+
+	for (int i = 0; i < 2; i++) {
+
+		int cz = p_z * 2 + i;
+		if (cz >= child.depth)
+			break;
+
+		for (int j = 0; j < 2; j++) {
+
+			int cx = p_x * 2 + j;
+			if (cx >= child.width)
+				break;
+
+			_cull(p_level - 1, cx, cz, p_params);
+		}
+	}
+}
+
 void HeightMapShapeSW::cull(const AABB &p_local_aabb, Callback p_callback, void *p_userdata) const {
+
+	if (mip_levels.empty())
+		return;
+
+	PoolVector<real_t>::Read hr = heights.read();
+	PoolVector<Range>::Read rr = mip_ranges.read();
+
+	FaceShapeSW face; // use this to send in the callback
+
+	_CullParams params;
+	params.aabb = p_local_aabb;
+	params.callback = p_callback;
+	params.userdata = p_userdata;
+	params.heights = hr.ptr();
+	params.ranges = rr.ptr();
+	params.face = &face;
+
+	_cull(mip_levels.size() - 1, 0, 0, &params);
 }
 
 Vector3 HeightMapShapeSW::get_moment_of_inertia(real_t p_mass) const {
@@ -1603,6 +1814,85 @@ Vector3 HeightMapShapeSW::get_moment_of_inertia(real_t p_mass) const {
 			(p_mass / 3.0) * (extents.y * extents.y + extents.y * extents.y));
 }
 
+void HeightMapShapeSW::_update_mips(int p_from_x, int p_from_z, int p_to_x, int p_to_z) {
+
+	PoolVector<real_t>::Read hr = heights.read();
+	PoolVector<Range>::Write rw = mip_ranges.write();
+	const real_t *h = hr.ptr();
+	Range *ranges = rw.ptr();
+
+	// level 0, one range per cell from its four corners
+
+	const MipLevel &cells = mip_levels[0];
+
+	for (int i = p_from_z; i < p_to_z; i++) {
+
+		for (int j = p_from_x; j < p_to_x; j++) {
+
+			real_t h00 = h[i * width + j];
+			real_t h10 = h[i * width + j + 1];
+			real_t h01 = h[(i + 1) * width + j];
+			real_t h11 = h[(i + 1) * width + j + 1];
+
+			Range &r = ranges[cells.offset + i * cells.width + j];
+			r.min = MIN(MIN(h00, h10), MIN(h01, h11));
+			r.max = MAX(MAX(h00, h10), MAX(h01, h11));
+		}
+	}
+
+	// propagate the touched area up the pyramid
+
+	for (int l = 1; l < mip_levels.size(); l++) {
+
+		const MipLevel &level = mip_levels[l];
+		const MipLevel &child = mip_levels[l - 1];
+
+		p_from_x >>= 1;
+		p_from_z >>= 1;
+		p_to_x = MIN((p_to_x + 1) >> 1, level.width);
+		p_to_z = MIN((p_to_z + 1) >> 1, level.depth);
+
+		for (int i = p_from_z; i < p_to_z; i++) {
+
+			for (int j = p_from_x; j < p_to_x; j++) {
+
+				Range r = ranges[child.offset + (i * 2) * child.width + j * 2];
+
+				for (int k = 0; k < 4; k++) {
+
+					int cx = j * 2 + (k & 1);
+					int cz = i * 2 + (k >> 1);
+					if (cx >= child.width || cz >= child.depth)
+						continue;
+
+					const Range &c = ranges[child.offset + cz * child.width + cx];
+					r.min = MIN(r.min, c.min);
+					r.max = MAX(r.max, c.max);
+				}
+
+				ranges[level.offset + i * level.width + j] = r;
+			}
+		}
+	}
+}
+
+AABB HeightMapShapeSW::_compute_aabb() const {
+
+	AABB aabb;
+
+	if (!mip_levels.empty()) {
+
+		// the top of the pyramid already holds the height range of the whole map
+		PoolVector<Range>::Read rr = mip_ranges.read();
+		const Range &r = rr[mip_levels[mip_levels.size() - 1].offset];
+
+		aabb.position = Vector3(0, r.min, 0);
+		aabb.size = Vector3((width - 1) * cell_size, r.max - r.min, (depth - 1) * cell_size);
+	}
+
+	return aabb;
+}
+
 void HeightMapShapeSW::_setup(PoolVector<real_t> p_heights, int p_width, int p_depth, real_t p_cell_size) {
 
 	heights = p_heights;
@@ -1610,35 +1900,95 @@ void HeightMapShapeSW::_setup(PoolVector<real_t> p_heights, int p_width, int p_d
 	depth = p_depth;
 	cell_size = p_cell_size;
 
-	PoolVector<real_t>::Read r = heights.read();
+	mip_levels.clear();
 
-	AABB aabb;
+	int w = width - 1;
+	int d = depth - 1;
+
+	if (w <= 0 || d <= 0) {
+		mip_ranges.resize(0);
+		configure(AABB());
+		return;
+	}
+
+	int total = 0;
+
+	while (true) {
+
+		MipLevel level;
+		level.width = w;
+		level.depth = d;
+		level.offset = total;
+		mip_levels.push_back(level);
+		total += w * d;
+
+		if (w == 1 && d == 1)
+			break;
+
+		w = (w + 1) >> 1;
+		d = (d + 1) >> 1;
+	}
 
-	for (int i = 0; i < depth; i++) {
+	mip_ranges.resize(total);
+	_update_mips(0, 0, width - 1, depth - 1);
 
-		for (int j = 0; j < width; j++) {
+	configure(_compute_aabb());
+}
+
+void HeightMapShapeSW::update_region(int p_x, int p_z, int p_width, int p_depth, const PoolVector<real_t> &p_heights) {
+
+	ERR_FAIL_COND(p_width <= 0 || p_depth <= 0);
+	ERR_FAIL_COND(p_x < 0 || p_z < 0 || p_x + p_width > width || p_z + p_depth > depth);
+	ERR_FAIL_COND(p_heights.size() != p_width * p_depth);
 
-			real_t h = r[i * width + j];
+	{
+		PoolVector<real_t>::Read r = p_heights.read();
+		PoolVector<real_t>::Write w = heights.write();
 
-			Vector3 pos(j * cell_size, h, i * cell_size);
-			if (i == 0 || j == 0)
-				aabb.position = pos;
-			else
-				aabb.expand_to(pos);
+		for (int i = 0; i < p_depth; i++) {
+
+			copymem(&w[(p_z + i) * width + p_x], &r[i * p_width], sizeof(real_t) * p_width);
 		}
 	}
 
-	configure(aabb);
+	if (!mip_levels.empty()) {
+
+		// a vertex is shared by the cells on both of its sides
+		int from_x = MAX(p_x - 1, 0);
+		int from_z = MAX(p_z - 1, 0);
+		int to_x = MIN(p_x + p_width, width - 1);
+		int to_z = MIN(p_z + p_depth, depth - 1);
+
+		_update_mips(from_x, from_z, to_x, to_z);
+	}
+
+	// contacts against the old heights are stale either way, the bounds only decide whether the broadphase must know
+	AABB aabb = _compute_aabb();
+	if (aabb != get_aabb())
+		configure(aabb);
+	else
+		data_changed();
 }
 
 void HeightMapShapeSW::set_data(const Variant &p_data) {
 
 	ERR_FAIL_COND(p_data.get_type() != Variant::DICTIONARY);
 	Dictionary d = p_data;
+	ERR_FAIL_COND(!d.has("heights"));
+
+	if (d.has("region")) {
+
+		// partial update, only the heights inside the region (in vertex coordinates) are replaced
+		Rect2 region = d["region"];
+		PoolVector<real_t> heights = d["heights"];
+
+		update_region(region.position.x, region.position.y, region.size.x, region.size.y, heights);
+		return;
+	}
+
 	ERR_FAIL_COND(!d.has("width"));
 	ERR_FAIL_COND(!d.has("depth"));
 	ERR_FAIL_COND(!d.has("cell_size"));
-	ERR_FAIL_COND(!d.has("heights"));
 
 	int width = d["width"];
 	int depth = d["depth"];
@@ -1654,7 +2004,13 @@ void HeightMapShapeSW::set_data(const Variant &p_data) {
 
 Variant HeightMapShapeSW::get_data() const {
 
-	ERR_FAIL_V(Variant());
+	Dictionary d;
+	d["width"] = width;
+	d["depth"] = depth;
+	d["cell_size"] = cell_size;
+	d["heights"] = heights;
+
+	return d;
 }
 
 HeightMapShapeSW::HeightMapShapeSW() {
@@ -51,6 +51,7 @@ class ShapeSW;
 class ShapeOwnerSW : public RID_Data {
 public:
 	virtual void _shape_changed() = 0;
+	virtual void _shape_data_changed() = 0;
 	virtual void remove_shape(ShapeSW *p_shape) = 0;
 
 	virtual ~ShapeOwnerSW() {}
@@ -62,11 +63,15 @@ class ShapeSW : public RID_Data {
 	AABB aabb;
 	bool configured;
 	real_t custom_bias;
+	uint32_t version; // unique across all shapes, changes every time the shape is configured or its data changes
+
+	static uint32_t last_version;
 
 	Map<ShapeOwnerSW *, int> owners;
 
 protected:
 	void configure(const AABB &p_aabb);
+	void data_changed(); // for edits that keep the bounds, owners don't need to update the broadphase
 
 public:
 	enum {
@@ -82,6 +87,7 @@ public:
 
 	_FORCE_INLINE_ AABB get_aabb() const { return aabb; }
 	_FORCE_INLINE_ bool is_configured() const { return configured; }
+	_FORCE_INLINE_ uint32_t get_version() const { return version; }
 
 	virtual bool is_concave() const { return false; }
 
@@ -371,8 +377,46 @@ struct HeightMapShapeSW : public ConcaveShapeSW {
 	int depth;
 	real_t cell_size;
 
-	//void _cull_segment(int p_idx,_SegmentCullParams *p_params) const;
-	//void _cull(int p_idx,_CullParams *p_params) const;
+	// min/max height pyramid over the cell grid, level 0 holds one range per
+	// cell and every following level merges 2x2 ranges of the previous one.
+	struct Range {
+
+		real_t min;
+		real_t max;
+	};
+
+	struct MipLevel {
+
+		int width;
+		int depth;
+		int offset;
+	};
+
+	Vector<MipLevel> mip_levels;
+	PoolVector<Range> mip_ranges;
+
+	struct _CullParams {
+
+		AABB aabb;
+		Callback callback;
+		void *userdata;
+		const real_t *heights;
+		const Range *ranges;
+		FaceShapeSW *face;
+	};
+
+	_FORCE_INLINE_ Vector3 _get_vertex(const real_t *p_heights, int p_x, int p_z) const {
+
+		return Vector3(p_x * cell_size, p_heights[p_z * width + p_x], p_z * cell_size);
+	}
+
+	_FORCE_INLINE_ void _get_cell_triangle(const real_t *p_heights, int p_x, int p_z, int p_idx, Vector3 *r_vertices) const;
+	bool _intersect_cell(const real_t *p_heights, int p_x, int p_z, const Vector3 &p_begin, const Vector3 &p_end, Vector3 &r_point, Vector3 &r_normal) const;
+
+	void _cull(int p_level, int p_x, int p_z, _CullParams *p_params) const;
+
+	void _update_mips(int p_from_x, int p_from_z, int p_to_x, int p_to_z);
+	AABB _compute_aabb() const;
 
 	void _setup(PoolVector<real_t> p_heights, int p_width, int p_depth, real_t p_cell_size);
 
@@ -382,6 +426,8 @@ public:
 	int get_depth() const;
 	real_t get_cell_size() const;
 
+	void update_region(int p_x, int p_z, int p_width, int p_depth, const PoolVector<real_t> &p_heights);
+
 	virtual PhysicsServer::ShapeType get_type() const { return PhysicsServer::SHAPE_HEIGHTMAP; }
 
 	virtual void project_range(const Vector3 &p_normal, const Transform &p_transform, real_t &r_min, real_t &r_max) const;
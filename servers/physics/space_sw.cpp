@@ -31,6 +31,7 @@
 #include "space_sw.h"
 
 #include "collision_solver_sw.h"
+#include "os/os.h"
 #include "physics_server_sw.h"
 #include "project_settings.h"
 
@@ -39,7 +40,7 @@ _FORCE_INLINE_ static bool _can_collide_with(CollisionObjectSW *p_object, uint32
 	return p_object->get_collision_layer() & p_collision_mask;
 }
 
-int PhysicsDirectSpaceStateSW::intersect_point(const Vector3 &p_point, ShapeResult *r_results, int p_result_max, const Set<RID> &p_exclude, uint32_t p_collision_mask) {
+int PhysicsDirectSpaceStateSW::intersect_point(const Vector3 &p_point, ShapeResult *r_results, int p_result_max, const PhysicsQueryExclude &p_exclude, uint32_t p_collision_mask) {
 
 	ERR_FAIL_COND_V(space->locked, false);
 	int amount = space->broadphase->cull_point(p_point, space->intersection_query_results, SpaceSW::INTERSECTION_QUERY_MAX, space->intersection_query_subindex_results);
@@ -83,7 +84,7 @@ int PhysicsDirectSpaceStateSW::intersect_point(const Vector3 &p_point, ShapeResu
 	return cc;
 }
 
-bool PhysicsDirectSpaceStateSW::intersect_ray(const Vector3 &p_from, const Vector3 &p_to, RayResult &r_result, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_pick_ray) {
+bool PhysicsDirectSpaceStateSW::intersect_ray(const Vector3 &p_from, const Vector3 &p_to, RayResult &r_result, const PhysicsQueryExclude &p_exclude, uint32_t p_collision_mask, bool p_pick_ray) {
 
 	ERR_FAIL_COND_V(space->locked, false);
 
@@ -161,7 +162,7 @@ bool PhysicsDirectSpaceStateSW::intersect_ray(const Vector3 &p_from, const Vecto
 	return true;
 }
 
-int PhysicsDirectSpaceStateSW::intersect_shape(const RID &p_shape, const Transform &p_xform, real_t p_margin, ShapeResult *r_results, int p_result_max, const Set<RID> &p_exclude, uint32_t p_collision_mask) {
+int PhysicsDirectSpaceStateSW::intersect_shape(const RID &p_shape, const Transform &p_xform, real_t p_margin, ShapeResult *r_results, int p_result_max, const PhysicsQueryExclude &p_exclude, uint32_t p_collision_mask) {
 
 	if (p_result_max <= 0)
 		return 0;
@@ -212,7 +213,7 @@ int PhysicsDirectSpaceStateSW::intersect_shape(const RID &p_shape, const Transfo
 	return cc;
 }
 
-bool PhysicsDirectSpaceStateSW::cast_motion(const RID &p_shape, const Transform &p_xform, const Vector3 &p_motion, real_t p_margin, real_t &p_closest_safe, real_t &p_closest_unsafe, const Set<RID> &p_exclude, uint32_t p_collision_mask, ShapeRestInfo *r_info) {
+bool PhysicsDirectSpaceStateSW::cast_motion(const RID &p_shape, const Transform &p_xform, const Vector3 &p_motion, real_t p_margin, real_t &p_closest_safe, real_t &p_closest_unsafe, const PhysicsQueryExclude &p_exclude, uint32_t p_collision_mask, ShapeRestInfo *r_info) {
 
 	ShapeSW *shape = static_cast<PhysicsServerSW *>(PhysicsServer::get_singleton())->shape_owner.get(p_shape);
 	ERR_FAIL_COND_V(!shape, false);
@@ -326,7 +327,7 @@ bool PhysicsDirectSpaceStateSW::cast_motion(const RID &p_shape, const Transform
 	return true;
 }
 
-bool PhysicsDirectSpaceStateSW::collide_shape(RID p_shape, const Transform &p_shape_xform, real_t p_margin, Vector3 *r_results, int p_result_max, int &r_result_count, const Set<RID> &p_exclude, uint32_t p_collision_mask) {
+bool PhysicsDirectSpaceStateSW::collide_shape(RID p_shape, const Transform &p_shape_xform, real_t p_margin, Vector3 *r_results, int p_result_max, int &r_result_count, const PhysicsQueryExclude &p_exclude, uint32_t p_collision_mask) {
 
 	if (p_result_max <= 0)
 		return 0;
@@ -405,7 +406,7 @@ static void _rest_cbk_result(const Vector3 &p_point_A, const Vector3 &p_point_B,
 	rd->best_object = rd->object;
 	rd->best_shape = rd->shape;
 }
-bool PhysicsDirectSpaceStateSW::rest_info(RID p_shape, const Transform &p_shape_xform, real_t p_margin, ShapeRestInfo *r_info, const Set<RID> &p_exclude, uint32_t p_collision_mask) {
+bool PhysicsDirectSpaceStateSW::rest_info(RID p_shape, const Transform &p_shape_xform, real_t p_margin, ShapeRestInfo *r_info, const PhysicsQueryExclude &p_exclude, uint32_t p_collision_mask) {
 
 	ShapeSW *shape = static_cast<PhysicsServerSW *>(PhysicsServer::get_singleton())->shape_owner.get(p_shape);
 	ERR_FAIL_COND_V(!shape, 0);
@@ -944,26 +945,304 @@ const SelfList<AreaSW>::List &SpaceSW::get_moved_area_list() const {
 	return area_moved_list;
 }
 
+void SpaceSW::body_pair_add_to_list(SelfList<BodyPairSW> *p_pair) {
+
+	body_pair_list.add(p_pair);
+}
+
+void SpaceSW::body_pair_remove_from_list(SelfList<BodyPairSW> *p_pair) {
+
+	body_pair_list.remove(p_pair);
+}
+
+void SpaceSW::area_pair_add_to_list(SelfList<AreaPairSW> *p_pair) {
+
+	area_pair_list.add(p_pair);
+}
+
+void SpaceSW::area_pair_remove_from_list(SelfList<AreaPairSW> *p_pair) {
+
+	area_pair_list.remove(p_pair);
+}
+
+void SpaceSW::area2_pair_add_to_list(SelfList<Area2PairSW> *p_pair) {
+
+	area2_pair_list.add(p_pair);
+}
+
+void SpaceSW::area2_pair_remove_from_list(SelfList<Area2PairSW> *p_pair) {
+
+	area2_pair_list.remove(p_pair);
+}
+
+template <class T>
+static int _count_state_list(const typename SelfList<T>::List &p_list) {
+
+	int count = 0;
+	for (const SelfList<T> *E = p_list.first(); E; E = E->next()) {
+		count++;
+	}
+	return count;
+}
+
+template <class T, class S>
+static S *_save_pair_states(const typename SelfList<T>::List &p_list, S *p_states, int p_count) {
+
+	int idx = 0;
+	for (const SelfList<T> *E = p_list.first(); E; E = E->next()) {
+		E->self()->save_state(p_states[idx++]);
+	}
+
+	// sorted by key, so the blob does not depend on pair creation order and can be searched on restore
+	SortArray<S> sorter;
+	sorter.sort(p_states, p_count);
+
+	return p_states + p_count;
+}
+
+template <class T, class S>
+static const S *_restore_pair_states(typename SelfList<T>::List &p_list, const S *p_states, int p_count) {
+
+	for (SelfList<T> *E = p_list.first(); E; E = E->next()) {
+
+		PairStateKeySW key;
+		E->self()->get_state_key(key);
+
+		const S *state = NULL;
+		int low = 0;
+		int high = p_count - 1;
+
+		while (low <= high) {
+
+			int middle = (low + high) / 2;
+			if (key < p_states[middle].key) {
+				high = middle - 1;
+			} else if (p_states[middle].key < key) {
+				low = middle + 1;
+			} else {
+				state = &p_states[middle];
+				break;
+			}
+		}
+
+		E->self()->restore_state(state);
+	}
+
+	return p_states + p_count;
+}
+
+void SpaceSW::save_state(PoolVector<uint8_t> &r_state) const {
+
+	StateHeader header;
+	header.version = STATE_VERSION;
+	header.padding = 0;
+	header.body_count = 0;
+	header.area_count = 0;
+
+	for (Set<CollisionObjectSW *>::Element *E = objects.front(); E; E = E->next()) {
+
+		if (E->get()->get_type() == CollisionObjectSW::TYPE_BODY)
+			header.body_count++;
+		else
+			header.area_count++;
+	}
+
+	header.body_pair_count = _count_state_list<BodyPairSW>(body_pair_list);
+	header.area_pair_count = _count_state_list<AreaPairSW>(area_pair_list);
+	header.area2_pair_count = _count_state_list<Area2PairSW>(area2_pair_list);
+	header.active_count = _count_state_list<BodySW>(active_list);
+
+	uint64_t size = header.get_state_size(sizeof(BodyStateRecord), sizeof(AreaStateRecord), sizeof(BodyPairSW::State), sizeof(AreaPairSW::State), sizeof(Area2PairSW::State));
+	ERR_FAIL_COND(size > 0x7FFFFFFF); // PoolVector sizes are int
+
+	if (r_state.size() != int(size))
+		r_state.resize(int(size));
+
+	PoolVector<uint8_t>::Write w = r_state.write();
+
+	*(StateHeader *)w.ptr() = header;
+
+	BodyStateRecord *bodies = (BodyStateRecord *)(w.ptr() + sizeof(StateHeader));
+	AreaStateRecord *areas = (AreaStateRecord *)(bodies + header.body_count);
+
+	for (Set<CollisionObjectSW *>::Element *E = objects.front(); E; E = E->next()) {
+
+		if (E->get()->get_type() == CollisionObjectSW::TYPE_BODY) {
+
+			const BodySW *body = static_cast<const BodySW *>(E->get());
+			bodies->id = body->get_self().get_id();
+			body->save_state(bodies->state);
+			bodies++;
+		} else {
+
+			areas->id = E->get()->get_self().get_id();
+			areas->transform = E->get()->get_transform();
+			areas++;
+		}
+	}
+
+	BodyPairSW::State *body_pairs = (BodyPairSW::State *)areas;
+	AreaPairSW::State *area_pairs = (AreaPairSW::State *)_save_pair_states<BodyPairSW>(body_pair_list, body_pairs, header.body_pair_count);
+	Area2PairSW::State *area2_pairs = (Area2PairSW::State *)_save_pair_states<AreaPairSW>(area_pair_list, area_pairs, header.area_pair_count);
+	uint32_t *active = (uint32_t *)_save_pair_states<Area2PairSW>(area2_pair_list, area2_pairs, header.area2_pair_count);
+
+	// the active list order decides the island and solver order, keep it so stepping after a restore is repeatable
+	for (const SelfList<BodySW> *E = active_list.first(); E; E = E->next()) {
+		*active++ = E->self()->get_self().get_id();
+	}
+}
+
+Error SpaceSW::restore_state(const PoolVector<uint8_t> &p_state) {
+
+	ERR_FAIL_COND_V(locked, ERR_LOCKED);
+
+	PoolVector<uint8_t>::Read r = p_state.read();
+	const StateHeader *header_ptr = StateHeader::validate(r.ptr(), uint64_t(p_state.size()), STATE_VERSION, sizeof(BodyStateRecord), sizeof(AreaStateRecord), sizeof(BodyPairSW::State), sizeof(AreaPairSW::State), sizeof(Area2PairSW::State));
+	ERR_FAIL_COND_V(!header_ptr, ERR_INVALID_DATA);
+	const StateHeader &header = *header_ptr;
+
+	const BodyStateRecord *bodies = (const BodyStateRecord *)(r.ptr() + sizeof(StateHeader));
+	const AreaStateRecord *areas = (const AreaStateRecord *)(bodies + header.body_count);
+
+	// validate first, a snapshot can only be restored into the same set of objects it was taken from
+
+	state_bodies.resize(header.body_count);
+	{
+		int body_idx = 0;
+		int area_idx = 0;
+
+		for (Set<CollisionObjectSW *>::Element *E = objects.front(); E; E = E->next()) {
+
+			uint32_t id = E->get()->get_self().get_id();
+
+			if (E->get()->get_type() == CollisionObjectSW::TYPE_BODY) {
+
+				if (body_idx >= (int)header.body_count || bodies[body_idx].id != id) {
+					ERR_EXPLAIN("Space state does not match the bodies in this space.");
+					ERR_FAIL_V(ERR_INVALID_DATA);
+				}
+				state_bodies[body_idx++] = static_cast<BodySW *>(E->get());
+			} else {
+
+				if (area_idx >= (int)header.area_count || areas[area_idx].id != id) {
+					ERR_EXPLAIN("Space state does not match the areas in this space.");
+					ERR_FAIL_V(ERR_INVALID_DATA);
+				}
+				area_idx++;
+			}
+		}
+
+		ERR_FAIL_COND_V(body_idx != (int)header.body_count || area_idx != (int)header.area_count, ERR_INVALID_DATA);
+	}
+
+	// the pair records come from user data as well
+	const BodyPairSW::State *body_pairs = (const BodyPairSW::State *)(areas + header.area_count);
+	for (uint32_t i = 0; i < header.body_pair_count; i++) {
+		ERR_FAIL_COND_V(!BodyPairSW::is_state_valid(body_pairs[i]), ERR_INVALID_DATA);
+	}
+
+	// objects first, so the broadphase pairs match the snapshot before their caches are restored
+
+	{
+		int area_idx = 0;
+
+		for (Set<CollisionObjectSW *>::Element *E = objects.front(); E; E = E->next()) {
+
+			if (E->get()->get_type() != CollisionObjectSW::TYPE_AREA)
+				continue;
+
+			AreaSW *area = static_cast<AreaSW *>(E->get());
+			const Transform &xform = areas[area_idx++].transform;
+			if (area->get_transform() != xform)
+				area->set_transform(xform);
+		}
+	}
+
+	for (uint32_t i = 0; i < header.body_count; i++) {
+		state_bodies[i]->restore_state(bodies[i].state);
+	}
+
+	const AreaPairSW::State *area_pairs = (const AreaPairSW::State *)_restore_pair_states<BodyPairSW>(body_pair_list, body_pairs, header.body_pair_count);
+	const Area2PairSW::State *area2_pairs = (const Area2PairSW::State *)_restore_pair_states<AreaPairSW>(area_pair_list, area_pairs, header.area_pair_count);
+	const uint32_t *active = (const uint32_t *)_restore_pair_states<Area2PairSW>(area2_pair_list, area2_pairs, header.area2_pair_count);
+
+	// rebuild the active list in snapshot order, adding to the front so walk it backwards
+
+	state_body_sort.resize(header.body_count);
+	for (uint32_t i = 0; i < header.body_count; i++) {
+		state_body_sort[i].id = bodies[i].id;
+		state_body_sort[i].body = state_bodies[i];
+	}
+
+	SortArray<StateBodySort> sorter;
+	sorter.sort(state_body_sort.ptrw(), state_body_sort.size());
+
+	for (int i = header.active_count - 1; i >= 0; i--) {
+
+		BodySW *body = NULL;
+		int low = 0;
+		int high = state_body_sort.size() - 1;
+
+		while (low <= high) {
+
+			int middle = (low + high) / 2;
+			if (active[i] < state_body_sort[middle].id) {
+				high = middle - 1;
+			} else if (state_body_sort[middle].id < active[i]) {
+				low = middle + 1;
+			} else {
+				body = state_body_sort[middle].body;
+				break;
+			}
+		}
+
+		ERR_CONTINUE(!body);
+
+		// moves the body to the front of the active list
+		body->set_active(false);
+		body->set_active(true);
+	}
+
+	return OK;
+}
+
 void SpaceSW::call_queries() {
 
+	active_transform_count = 0;
+
 	while (state_query_list.first()) {
 
 		BodySW *b = state_query_list.first()->self();
 		state_query_list.remove(state_query_list.first());
+
+		if (active_transform_count == active_transforms.size())
+			active_transforms.resize(MAX(active_transform_count * 2, 64));
+
+		PhysicsServer::ActiveTransform &at = active_transforms[active_transform_count++];
+		at.instance_id = b->get_instance_id();
+		at.body = b->get_self();
+		at.transform = b->get_transform();
+
 		b->call_queries();
 	}
 
+	uint64_t area_begtime = OS::get_singleton()->get_ticks_usec();
+
 	while (monitor_query_list.first()) {
 
 		AreaSW *a = monitor_query_list.first()->self();
 		monitor_query_list.remove(monitor_query_list.first());
 		a->call_queries();
 	}
+
+	elapsed_time[ELAPSED_TIME_AREA_QUERIES] = OS::get_singleton()->get_ticks_usec() - area_begtime;
 }
 
 void SpaceSW::setup() {
 
 	contact_debug_count = 0;
+	for (int i = 0; i < STEP_COUNTER_MAX; i++)
+		step_counter[i] = 0;
 	while (inertia_update_list.first()) {
 		inertia_update_list.first()->self()->update_inertias();
 		inertia_update_list.remove(inertia_update_list.first());
@@ -1032,6 +1311,7 @@ SpaceSW::SpaceSW() {
 	active_objects = 0;
 	island_count = 0;
 	contact_debug_count = 0;
+	active_transform_count = 0;
 
 	locked = false;
 	contact_recycle_radius = 0.01;
@@ -1054,6 +1334,8 @@ SpaceSW::SpaceSW() {
 
 	for (int i = 0; i < ELAPSED_TIME_MAX; i++)
 		elapsed_time[i] = 0;
+	for (int i = 0; i < STEP_COUNTER_MAX; i++)
+		step_counter[i] = 0;
 }
 
 SpaceSW::~SpaceSW() {
@@ -39,6 +39,7 @@
 #include "collision_object_sw.h"
 #include "hash_map.h"
 #include "project_settings.h"
+#include "servers/physics_state_header.h"
 #include "typedefs.h"
 
 class PhysicsDirectSpaceStateSW : public PhysicsDirectSpaceState {
@@ -48,12 +49,12 @@ class PhysicsDirectSpaceStateSW : public PhysicsDirectSpaceState {
 public:
 	SpaceSW *space;
 
-	virtual int intersect_point(const Vector3 &p_point, ShapeResult *r_results, int p_result_max, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF);
-	virtual bool intersect_ray(const Vector3 &p_from, const Vector3 &p_to, RayResult &r_result, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF, bool p_pick_ray = false);
-	virtual int intersect_shape(const RID &p_shape, const Transform &p_xform, real_t p_margin, ShapeResult *r_results, int p_result_max, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF);
-	virtual bool cast_motion(const RID &p_shape, const Transform &p_xform, const Vector3 &p_motion, real_t p_margin, real_t &p_closest_safe, real_t &p_closest_unsafe, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF, ShapeRestInfo *r_info = NULL);
-	virtual bool collide_shape(RID p_shape, const Transform &p_shape_xform, real_t p_margin, Vector3 *r_results, int p_result_max, int &r_result_count, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF);
-	virtual bool rest_info(RID p_shape, const Transform &p_shape_xform, real_t p_margin, ShapeRestInfo *r_info, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF);
+	virtual int intersect_point(const Vector3 &p_point, ShapeResult *r_results, int p_result_max, const PhysicsQueryExclude &p_exclude = PhysicsQueryExclude(), uint32_t p_collision_mask = 0xFFFFFFFF);
+	virtual bool intersect_ray(const Vector3 &p_from, const Vector3 &p_to, RayResult &r_result, const PhysicsQueryExclude &p_exclude = PhysicsQueryExclude(), uint32_t p_collision_mask = 0xFFFFFFFF, bool p_pick_ray = false);
+	virtual int intersect_shape(const RID &p_shape, const Transform &p_xform, real_t p_margin, ShapeResult *r_results, int p_result_max, const PhysicsQueryExclude &p_exclude = PhysicsQueryExclude(), uint32_t p_collision_mask = 0xFFFFFFFF);
+	virtual bool cast_motion(const RID &p_shape, const Transform &p_xform, const Vector3 &p_motion, real_t p_margin, real_t &p_closest_safe, real_t &p_closest_unsafe, const PhysicsQueryExclude &p_exclude = PhysicsQueryExclude(), uint32_t p_collision_mask = 0xFFFFFFFF, ShapeRestInfo *r_info = NULL);
+	virtual bool collide_shape(RID p_shape, const Transform &p_shape_xform, real_t p_margin, Vector3 *r_results, int p_result_max, int &r_result_count, const PhysicsQueryExclude &p_exclude = PhysicsQueryExclude(), uint32_t p_collision_mask = 0xFFFFFFFF);
+	virtual bool rest_info(RID p_shape, const Transform &p_shape_xform, real_t p_margin, ShapeRestInfo *r_info, const PhysicsQueryExclude &p_exclude = PhysicsQueryExclude(), uint32_t p_collision_mask = 0xFFFFFFFF);
 	virtual Vector3 get_closest_point_to_object_volume(RID p_object, const Vector3 p_point) const;
 
 	PhysicsDirectSpaceStateSW();
@@ -68,12 +69,22 @@ public:
 		ELAPSED_TIME_SETUP_CONSTRAINTS,
 		ELAPSED_TIME_SOLVE_CONSTRAINTS,
 		ELAPSED_TIME_INTEGRATE_VELOCITIES,
+		ELAPSED_TIME_BROAD_PHASE,
+		ELAPSED_TIME_AREA_QUERIES,
 		ELAPSED_TIME_MAX
 
 	};
 
+	enum StepCounter {
+		STEP_COUNTER_PAIRS_TESTED,
+		STEP_COUNTER_CONTACTS,
+		STEP_COUNTER_CCD_SWEEPS,
+		STEP_COUNTER_MAX
+	};
+
 private:
 	uint64_t elapsed_time[ELAPSED_TIME_MAX];
+	uint32_t step_counter[STEP_COUNTER_MAX];
 
 	PhysicsDirectSpaceStateSW *direct_access;
 	RID self;
@@ -84,6 +95,9 @@ private:
 	SelfList<BodySW>::List state_query_list;
 	SelfList<AreaSW>::List monitor_query_list;
 	SelfList<AreaSW>::List area_moved_list;
+	SelfList<BodyPairSW>::List body_pair_list;
+	SelfList<AreaPairSW>::List area_pair_list;
+	SelfList<Area2PairSW>::List area2_pair_list;
 
 	static void *_broadphase_pair(CollisionObjectSW *A, int p_subindex_A, CollisionObjectSW *B, int p_subindex_B, void *p_self);
 	static void _broadphase_unpair(CollisionObjectSW *A, int p_subindex_A, CollisionObjectSW *B, int p_subindex_B, void *p_data, void *p_self);
@@ -121,10 +135,45 @@ private:
 	Vector<Vector3> contact_debug;
 	int contact_debug_count;
 
+	// grows only, so flushing does not reallocate every frame
+	Vector<PhysicsServer::ActiveTransform> active_transforms;
+	int active_transform_count;
+
 	friend class PhysicsDirectSpaceStateSW;
 
 	int _cull_aabb_for_body(BodySW *p_body, const AABB &p_aabb);
 
+	// state snapshot layout: header, body records, area records and the pair records sorted by key
+	enum {
+		STATE_VERSION = 2
+	};
+
+	typedef PhysicsStateHeader StateHeader;
+
+	struct BodyStateRecord {
+
+		uint32_t id;
+		BodySW::State state;
+	};
+
+	struct AreaStateRecord {
+
+		uint32_t id;
+		Transform transform;
+	};
+
+	struct StateBodySort {
+
+		uint32_t id;
+		BodySW *body;
+
+		_FORCE_INLINE_ bool operator<(const StateBodySort &p_other) const { return id < p_other.id; }
+	};
+
+	// scratch, avoids allocating on every restore
+	Vector<BodySW *> state_bodies;
+	Vector<StateBodySort> state_body_sort;
+
 public:
 	_FORCE_INLINE_ void set_self(const RID &p_self) { self = p_self; }
 	_FORCE_INLINE_ RID get_self() const { return self; }
@@ -141,6 +190,13 @@ public:
 	void body_add_to_state_query_list(SelfList<BodySW> *p_body);
 	void body_remove_from_state_query_list(SelfList<BodySW> *p_body);
 
+	void body_pair_add_to_list(SelfList<BodyPairSW> *p_pair);
+	void body_pair_remove_from_list(SelfList<BodyPairSW> *p_pair);
+	void area_pair_add_to_list(SelfList<AreaPairSW> *p_pair);
+	void area_pair_remove_from_list(SelfList<AreaPairSW> *p_pair);
+	void area2_pair_add_to_list(SelfList<Area2PairSW> *p_pair);
+	void area2_pair_remove_from_list(SelfList<Area2PairSW> *p_pair);
+
 	void area_add_to_monitor_query_list(SelfList<AreaSW> *p_area);
 	void area_remove_from_monitor_query_list(SelfList<AreaSW> *p_area);
 	void area_add_to_moved_list(SelfList<AreaSW> *p_area);
@@ -191,14 +247,23 @@ public:
 	_FORCE_INLINE_ Vector<Vector3> get_debug_contacts() { return contact_debug; }
 	_FORCE_INLINE_ int get_debug_contact_count() { return contact_debug_count; }
 
+	_FORCE_INLINE_ const Vector<PhysicsServer::ActiveTransform> &get_active_transforms() const { return active_transforms; }
+	_FORCE_INLINE_ int get_active_transform_count() const { return active_transform_count; }
+
 	void set_static_global_body(RID p_body) { static_global_body = p_body; }
 	RID get_static_global_body() { return static_global_body; }
 
 	void set_elapsed_time(ElapsedTime p_time, uint64_t p_msec) { elapsed_time[p_time] = p_msec; }
 	uint64_t get_elapsed_time(ElapsedTime p_time) const { return elapsed_time[p_time]; }
 
+	_FORCE_INLINE_ void add_step_counter(StepCounter p_counter, uint32_t p_amount = 1) { step_counter[p_counter] += p_amount; }
+	uint32_t get_step_counter(StepCounter p_counter) const { return step_counter[p_counter]; }
+
 	bool test_body_motion(BodySW *p_body, const Transform &p_from, const Vector3 &p_motion, real_t p_margin, PhysicsServer::MotionResult *r_result);
 
+	void save_state(PoolVector<uint8_t> &r_state) const;
+	Error restore_state(const PoolVector<uint8_t> &p_state);
+
 	SpaceSW();
 	~SpaceSW();
 };
@@ -289,7 +289,14 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 		profile_begtime = profile_endtime;
 	}
 
+	/* BROAD PHASE */
+
 	p_space->update();
+
+	{ //profile
+		profile_endtime = OS::get_singleton()->get_ticks_usec();
+		p_space->set_elapsed_time(SpaceSW::ELAPSED_TIME_BROAD_PHASE, profile_endtime - profile_begtime);
+	}
 	p_space->unlock();
 	_step++;
 }
@@ -30,8 +30,44 @@
 
 #include "area_pair_2d_sw.h"
 #include "collision_solver_2d_sw.h"
+#include "space_2d_sw.h"
 
-bool AreaPair2DSW::setup(real_t p_step) {
+void AreaPair2DSW::_set_colliding(bool p_colliding) {
+
+	if (p_colliding == colliding)
+		return;
+
+	if (p_colliding) {
+
+		if (area->get_space_override_mode() != Physics2DServer::AREA_SPACE_OVERRIDE_DISABLED)
+			body->add_area(area);
+		if (area->has_monitor_callback())
+			area->add_body_to_query(body, body_shape, area_shape);
+
+	} else {
+
+		if (area->get_space_override_mode() != Physics2DServer::AREA_SPACE_OVERRIDE_DISABLED)
+			body->remove_area(area);
+		if (area->has_monitor_callback())
+			area->remove_body_from_query(body, body_shape, area_shape);
+	}
+
+	colliding = p_colliding;
+}
+
+void AreaPair2DSW::save_state(State &r_state) const {
+
+	get_state_key(r_state.key);
+	r_state.colliding = colliding;
+}
+
+void AreaPair2DSW::restore_state(const State *p_state) {
+
+	// changes are queued as regular enter/exit events, so monitors stay in sync with the restored state
+	_set_colliding(p_state ? bool(p_state->colliding) : false);
+}
+
+void AreaPair2DSW::test_overlap() {
 
 	bool result = false;
 
@@ -41,25 +77,18 @@ bool AreaPair2DSW::setup(real_t p_step) {
 		result = true;
 	}
 
-	if (result != colliding) {
+	overlap = result;
+}
 
-		if (result) {
+void AreaPair2DSW::apply_overlap() {
 
-			if (area->get_space_override_mode() != Physics2DServer::AREA_SPACE_OVERRIDE_DISABLED)
-				body->add_area(area);
-			if (area->has_monitor_callback())
-				area->add_body_to_query(body, body_shape, area_shape);
+	_set_colliding(overlap);
+}
 
-		} else {
+bool AreaPair2DSW::setup(real_t p_step) {
 
-			if (area->get_space_override_mode() != Physics2DServer::AREA_SPACE_OVERRIDE_DISABLED)
-				body->remove_area(area);
-			if (area->has_monitor_callback())
-				area->remove_body_from_query(body, body_shape, area_shape);
-		}
-
-		colliding = result;
-	}
+	test_overlap();
+	apply_overlap();
 
 	return false; //never do any post solving
 }
@@ -67,17 +96,21 @@ bool AreaPair2DSW::setup(real_t p_step) {
 void AreaPair2DSW::solve(real_t p_step) {
 }
 
-AreaPair2DSW::AreaPair2DSW(Body2DSW *p_body, int p_body_shape, Area2DSW *p_area, int p_area_shape) {
+AreaPair2DSW::AreaPair2DSW(Body2DSW *p_body, int p_body_shape, Area2DSW *p_area, int p_area_shape) :
+		area_pair_list(this) {
 
 	body = p_body;
 	area = p_area;
 	body_shape = p_body_shape;
 	area_shape = p_area_shape;
 	colliding = false;
+	overlap = false;
+	space = area->get_space();
 	body->add_constraint(this, 0);
 	area->add_constraint(this);
 	if (p_body->get_mode() == Physics2DServer::BODY_MODE_KINEMATIC) //need to be active to process pair
 		p_body->set_active(true);
+	space->area_pair_add_to_list(&area_pair_list);
 }
 
 AreaPair2DSW::~AreaPair2DSW() {
@@ -91,11 +124,48 @@ AreaPair2DSW::~AreaPair2DSW() {
 	}
 	body->remove_constraint(this);
 	area->remove_constraint(this);
+	space->area_pair_remove_from_list(&area_pair_list);
 }
 
 //////////////////////////////////
 
-bool Area2Pair2DSW::setup(real_t p_step) {
+void Area2Pair2DSW::_set_colliding(bool p_colliding) {
+
+	if (p_colliding == colliding)
+		return;
+
+	if (p_colliding) {
+
+		if (area_b->has_area_monitor_callback() && area_a->is_monitorable())
+			area_b->add_area_to_query(area_a, shape_a, shape_b);
+
+		if (area_a->has_area_monitor_callback() && area_b->is_monitorable())
+			area_a->add_area_to_query(area_b, shape_b, shape_a);
+
+	} else {
+
+		if (area_b->has_area_monitor_callback() && area_a->is_monitorable())
+			area_b->remove_area_from_query(area_a, shape_a, shape_b);
+
+		if (area_a->has_area_monitor_callback() && area_b->is_monitorable())
+			area_a->remove_area_from_query(area_b, shape_b, shape_a);
+	}
+
+	colliding = p_colliding;
+}
+
+void Area2Pair2DSW::save_state(State &r_state) const {
+
+	get_state_key(r_state.key);
+	r_state.colliding = colliding;
+}
+
+void Area2Pair2DSW::restore_state(const State *p_state) {
+
+	_set_colliding(p_state ? bool(p_state->colliding) : false);
+}
+
+void Area2Pair2DSW::test_overlap() {
 
 	bool result = false;
 	if (area_a->is_shape_set_as_disabled(shape_a) || area_b->is_shape_set_as_disabled(shape_b)) {
@@ -104,27 +174,18 @@ bool Area2Pair2DSW::setup(real_t p_step) {
 		result = true;
 	}
 
-	if (result != colliding) {
-
-		if (result) {
-
-			if (area_b->has_area_monitor_callback() && area_a->is_monitorable())
-				area_b->add_area_to_query(area_a, shape_a, shape_b);
-
-			if (area_a->has_area_monitor_callback() && area_b->is_monitorable())
-				area_a->add_area_to_query(area_b, shape_b, shape_a);
+	overlap = result;
+}
 
-		} else {
+void Area2Pair2DSW::apply_overlap() {
 
-			if (area_b->has_area_monitor_callback() && area_a->is_monitorable())
-				area_b->remove_area_from_query(area_a, shape_a, shape_b);
+	_set_colliding(overlap);
+}
 
-			if (area_a->has_area_monitor_callback() && area_b->is_monitorable())
-				area_a->remove_area_from_query(area_b, shape_b, shape_a);
-		}
+bool Area2Pair2DSW::setup(real_t p_step) {
 
-		colliding = result;
-	}
+	test_overlap();
+	apply_overlap();
 
 	return false; //never do any post solving
 }
@@ -132,15 +193,19 @@ bool Area2Pair2DSW::setup(real_t p_step) {
 void Area2Pair2DSW::solve(real_t p_step) {
 }
 
-Area2Pair2DSW::Area2Pair2DSW(Area2DSW *p_area_a, int p_shape_a, Area2DSW *p_area_b, int p_shape_b) {
+Area2Pair2DSW::Area2Pair2DSW(Area2DSW *p_area_a, int p_shape_a, Area2DSW *p_area_b, int p_shape_b) :
+		area2_pair_list(this) {
 
 	area_a = p_area_a;
 	area_b = p_area_b;
 	shape_a = p_shape_a;
 	shape_b = p_shape_b;
 	colliding = false;
+	overlap = false;
+	space = area_a->get_space();
 	area_a->add_constraint(this);
 	area_b->add_constraint(this);
+	space->area2_pair_add_to_list(&area2_pair_list);
 }
 
 Area2Pair2DSW::~Area2Pair2DSW() {
@@ -156,4 +221,5 @@ Area2Pair2DSW::~Area2Pair2DSW() {
 
 	area_a->remove_constraint(this);
 	area_b->remove_constraint(this);
+	space->area2_pair_remove_from_list(&area2_pair_list);
 }
@@ -42,8 +42,37 @@ class AreaPair2DSW : public Constraint2DSW {
 	int body_shape;
 	int area_shape;
 	bool colliding;
+	bool overlap;
+	Space2DSW *space;
+	SelfList<AreaPair2DSW> area_pair_list;
+
+	void _set_colliding(bool p_colliding);
 
 public:
+	// overlap state saved and restored by space snapshots
+	struct State {
+
+		PairStateKey2DSW key;
+		uint32_t colliding;
+
+		_FORCE_INLINE_ bool operator<(const State &p_state) const { return key < p_state.key; }
+	};
+
+	_FORCE_INLINE_ void get_state_key(PairStateKey2DSW &r_key) const {
+
+		r_key.id_A = body->get_self().get_id();
+		r_key.shape_A = body_shape;
+		r_key.id_B = area->get_self().get_id();
+		r_key.shape_B = area_shape;
+	}
+
+	void save_state(State &r_state) const;
+	void restore_state(const State *p_state);
+
+	bool is_area_pair() const { return true; }
+	void test_overlap();
+	void apply_overlap();
+
 	bool setup(real_t p_step);
 	void solve(real_t p_step);
 
@@ -58,8 +87,37 @@ class Area2Pair2DSW : public Constraint2DSW {
 	int shape_a;
 	int shape_b;
 	bool colliding;
+	bool overlap;
+	Space2DSW *space;
+	SelfList<Area2Pair2DSW> area2_pair_list;
+
+	void _set_colliding(bool p_colliding);
 
 public:
+	// overlap state saved and restored by space snapshots
+	struct State {
+
+		PairStateKey2DSW key;
+		uint32_t colliding;
+
+		_FORCE_INLINE_ bool operator<(const State &p_state) const { return key < p_state.key; }
+	};
+
+	_FORCE_INLINE_ void get_state_key(PairStateKey2DSW &r_key) const {
+
+		r_key.id_A = area_a->get_self().get_id();
+		r_key.shape_A = shape_a;
+		r_key.id_B = area_b->get_self().get_id();
+		r_key.shape_B = shape_b;
+	}
+
+	void save_state(State &r_state) const;
+	void restore_state(const State *p_state);
+
+	bool is_area_pair() const { return true; }
+	void test_overlap();
+	void apply_overlap();
+
 	bool setup(real_t p_step);
 	void solve(real_t p_step);
 
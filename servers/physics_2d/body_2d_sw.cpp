@@ -634,6 +634,41 @@ bool Body2DSW::sleep_test(real_t p_step) {
 	}
 }
 
+void Body2DSW::save_state(State &r_state) const {
+
+	r_state.transform = get_transform();
+	r_state.new_transform = new_transform;
+	r_state.linear_velocity = linear_velocity;
+	r_state.angular_velocity = angular_velocity;
+	r_state.applied_force = applied_force;
+	r_state.applied_torque = applied_torque;
+	r_state.still_time = still_time;
+	r_state.active = active;
+}
+
+void Body2DSW::restore_state(const State &p_state) {
+
+	// most bodies of a snapshot are usually sleeping, avoid touching the broadphase for them
+	if (get_transform() != p_state.transform) {
+		_set_transform(p_state.transform);
+		_set_inv_transform(get_transform().affine_inverse());
+
+		// let the owner know about the new transform on the next query flush
+		if (get_space() && !direct_state_query_list.in_list())
+			get_space()->body_add_to_state_query_list(&direct_state_query_list);
+	}
+
+	new_transform = p_state.new_transform;
+	linear_velocity = p_state.linear_velocity;
+	angular_velocity = p_state.angular_velocity;
+	biased_linear_velocity = Vector2();
+	biased_angular_velocity = 0;
+	applied_force = p_state.applied_force;
+	applied_torque = p_state.applied_torque;
+	still_time = p_state.still_time;
+	set_active(p_state.active);
+}
+
 void Body2DSW::set_force_integration_callback(ObjectID p_id, const StringName &p_method, const Variant &p_udata) {
 
 	if (fi_callback) {
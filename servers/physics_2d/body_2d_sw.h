@@ -134,6 +134,22 @@ class Body2DSW : public CollisionObject2DSW {
 	friend class Physics2DDirectBodyStateSW; // i give up, too many functions to expose
 
 public:
+	// simulation state saved and restored by space snapshots
+	struct State {
+
+		Transform2D transform;
+		Transform2D new_transform;
+		Vector2 linear_velocity;
+		real_t angular_velocity;
+		Vector2 applied_force;
+		real_t applied_torque;
+		real_t still_time;
+		uint32_t active;
+	};
+
+	void save_state(State &r_state) const;
+	void restore_state(const State &p_state);
+
 	void set_force_integration_callback(ObjectID p_id, const StringName &p_method, const Variant &p_udata = Variant());
 
 	_FORCE_INLINE_ void add_area(Area2DSW *p_area) {
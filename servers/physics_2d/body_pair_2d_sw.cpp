@@ -184,6 +184,8 @@ bool BodyPair2DSW::_test_ccd(real_t p_step, Body2DSW *p_A, int p_shape_A, const
 		return false;
 	}
 
+	space->add_step_counter(Space2DSW::STEP_COUNTER_CCD_SWEEPS);
+
 	//cast a segment from support in motion normal, in the same direction of motion by motion length
 	//support is the worst case collision point, so real collision happened before
 	int a;
@@ -218,24 +220,63 @@ bool BodyPair2DSW::_test_ccd(real_t p_step, Body2DSW *p_A, int p_shape_A, const
 	return true;
 }
 
-bool BodyPair2DSW::setup(real_t p_step) {
+bool BodyPair2DSW::_can_collide() const {
 
 	//cannot collide
 	if (!A->test_collision_mask(B) || A->has_exception(B->get_self()) || B->has_exception(A->get_self()) || (A->get_mode() <= Physics2DServer::BODY_MODE_KINEMATIC && B->get_mode() <= Physics2DServer::BODY_MODE_KINEMATIC && A->get_max_contacts_reported() == 0 && B->get_max_contacts_reported() == 0)) {
-		collided = false;
 		return false;
 	}
 
 	if (A->is_shape_set_as_disabled(shape_A) || B->is_shape_set_as_disabled(shape_B)) {
-		collided = false;
 		return false;
 	}
 
+	return true;
+}
+
+CollisionSolver2DSW::BatchType BodyPair2DSW::setup_batch(CollisionSolver2DSW::BatchPair &r_pair) {
+
+	batched = false;
+
+	if (!_can_collide())
+		return CollisionSolver2DSW::BATCH_NONE;
+
+	// the batched kernels only handle shapes at rest
+	if (A->get_continuous_collision_detection_mode() == Physics2DServer::CCD_MODE_CAST_SHAPE || B->get_continuous_collision_detection_mode() == Physics2DServer::CCD_MODE_CAST_SHAPE)
+		return CollisionSolver2DSW::BATCH_NONE;
+
+	Transform2D xform_A = A->get_transform().untranslated() * A->get_shape_transform(shape_A);
+
+	Transform2D xform_B = B->get_transform();
+	xform_B.elements[2] -= A->get_transform().get_origin();
+	xform_B = xform_B * B->get_shape_transform(shape_B);
+
+	CollisionSolver2DSW::BatchType type = CollisionSolver2DSW::make_batch_pair(r_pair, A->get_shape(shape_A), xform_A, B->get_shape(shape_B), xform_B, _add_contact, this, &sep_axis, &batch_collided);
+	if (type == CollisionSolver2DSW::BATCH_NONE)
+		return CollisionSolver2DSW::BATCH_NONE;
+
 	//use local A coordinates to avoid numerical issues on collision detection
 	offset_B = B->get_transform().get_origin() - A->get_transform().get_origin();
 
 	_validate_contacts();
 
+	space->add_step_counter(Space2DSW::STEP_COUNTER_PAIRS_TESTED);
+
+	batched = true;
+	return type;
+}
+
+bool BodyPair2DSW::setup(real_t p_step) {
+
+	if (!_can_collide()) {
+		batched = false;
+		collided = false;
+		return false;
+	}
+
+	dynamic_A = A->get_mode() > Physics2DServer::BODY_MODE_KINEMATIC;
+	dynamic_B = B->get_mode() > Physics2DServer::BODY_MODE_KINEMATIC;
+
 	Vector2 offset_A = A->get_transform().get_origin();
 	Transform2D xform_Au = A->get_transform().untranslated();
 	Transform2D xform_A = xform_Au * A->get_shape_transform(shape_A);
@@ -247,19 +288,35 @@ bool BodyPair2DSW::setup(real_t p_step) {
 	Shape2DSW *shape_A_ptr = A->get_shape(shape_A);
 	Shape2DSW *shape_B_ptr = B->get_shape(shape_B);
 
-	Vector2 motion_A, motion_B;
+	if (batched) {
 
-	if (A->get_continuous_collision_detection_mode() == Physics2DServer::CCD_MODE_CAST_SHAPE) {
-		motion_A = A->get_motion();
-	}
-	if (B->get_continuous_collision_detection_mode() == Physics2DServer::CCD_MODE_CAST_SHAPE) {
-		motion_B = B->get_motion();
-	}
-	//faster to set than to check..
+		// Step2DSW already ran the narrow phase for this pair, contacts are in place
+		batched = false;
+		collided = batch_collided;
+	} else {
+
+		//use local A coordinates to avoid numerical issues on collision detection
+		offset_B = B->get_transform().get_origin() - A->get_transform().get_origin();
+
+		_validate_contacts();
+
+		Vector2 motion_A, motion_B;
+
+		if (A->get_continuous_collision_detection_mode() == Physics2DServer::CCD_MODE_CAST_SHAPE) {
+			motion_A = A->get_motion();
+		}
+		if (B->get_continuous_collision_detection_mode() == Physics2DServer::CCD_MODE_CAST_SHAPE) {
+			motion_B = B->get_motion();
+		}
+		//faster to set than to check..
+
+		//bool prev_collided=collided;
 
-	//bool prev_collided=collided;
+		space->add_step_counter(Space2DSW::STEP_COUNTER_PAIRS_TESTED);
+
+		collided = CollisionSolver2DSW::solve(shape_A_ptr, xform_A, motion_A, shape_B_ptr, xform_B, motion_B, _add_contact, this, &sep_axis);
+	}
 
-	collided = CollisionSolver2DSW::solve(shape_A_ptr, xform_A, motion_A, shape_B_ptr, xform_B, motion_B, _add_contact, this, &sep_axis);
 	if (!collided) {
 
 		//test ccd (currently just a raycast)
@@ -280,6 +337,8 @@ bool BodyPair2DSW::setup(real_t p_step) {
 		}
 	}
 
+	space->add_step_counter(Space2DSW::STEP_COUNTER_CONTACTS, contact_count);
+
 	if (oneway_disabled)
 		return false;
 
@@ -425,8 +484,10 @@ bool BodyPair2DSW::setup(real_t p_step) {
 			// Apply normal + friction impulse
 			Vector2 P = c.acc_normal_impulse * c.normal + c.acc_tangent_impulse * tangent;
 
-			A->apply_impulse(c.rA, -P);
-			B->apply_impulse(c.rB, P);
+			if (dynamic_A)
+				A->apply_impulse(c.rA, -P);
+			if (dynamic_B)
+				B->apply_impulse(c.rB, P);
 		}
 
 #endif
@@ -480,8 +541,10 @@ void BodyPair2DSW::solve(real_t p_step) {
 
 		Vector2 jb = c.normal * (c.acc_bias_impulse - jbnOld);
 
-		A->apply_bias_impulse(c.rA, -jb);
-		B->apply_bias_impulse(c.rB, jb);
+		if (dynamic_A)
+			A->apply_bias_impulse(c.rA, -jb);
+		if (dynamic_B)
+			B->apply_bias_impulse(c.rB, jb);
 
 		real_t jn = -(c.bounce + vn) * c.mass_normal;
 		real_t jnOld = c.acc_normal_impulse;
@@ -496,13 +559,45 @@ void BodyPair2DSW::solve(real_t p_step) {
 
 		Vector2 j = c.normal * (c.acc_normal_impulse - jnOld) + tangent * (c.acc_tangent_impulse - jtOld);
 
-		A->apply_impulse(c.rA, -j);
-		B->apply_impulse(c.rB, j);
+		if (dynamic_A)
+			A->apply_impulse(c.rA, -j);
+		if (dynamic_B)
+			B->apply_impulse(c.rB, j);
+	}
+}
+
+void BodyPair2DSW::save_state(State &r_state) const {
+
+	get_state_key(r_state.key);
+	r_state.sep_axis = sep_axis;
+	r_state.contact_count = contact_count;
+	r_state.oneway_disabled = oneway_disabled;
+	for (int i = 0; i < MAX_CONTACTS; i++) {
+		r_state.contacts[i] = contacts[i];
+	}
+}
+
+void BodyPair2DSW::restore_state(const State *p_state) {
+
+	if (!p_state) {
+		// pair did not exist when the snapshot was taken
+		sep_axis = Vector2();
+		contact_count = 0;
+		oneway_disabled = false;
+		return;
+	}
+
+	sep_axis = p_state->sep_axis;
+	contact_count = p_state->contact_count;
+	oneway_disabled = p_state->oneway_disabled;
+	for (int i = 0; i < MAX_CONTACTS; i++) {
+		contacts[i] = p_state->contacts[i];
 	}
 }
 
 BodyPair2DSW::BodyPair2DSW(Body2DSW *p_A, int p_shape_A, Body2DSW *p_B, int p_shape_B) :
-		Constraint2DSW(_arr, 2) {
+		Constraint2DSW(_arr, 2),
+		body_pair_list(this) {
 
 	A = p_A;
 	B = p_B;
@@ -514,10 +609,16 @@ BodyPair2DSW::BodyPair2DSW(Body2DSW *p_A, int p_shape_A, Body2DSW *p_B, int p_sh
 	contact_count = 0;
 	collided = false;
 	oneway_disabled = false;
+	batched = false;
+	batch_collided = false;
+	dynamic_A = false;
+	dynamic_B = false;
+	space->body_pair_add_to_list(&body_pair_list);
 }
 
 BodyPair2DSW::~BodyPair2DSW() {
 
 	A->remove_constraint(this);
 	B->remove_constraint(this);
+	space->body_pair_remove_from_list(&body_pair_list);
 }
@@ -78,14 +78,49 @@ class BodyPair2DSW : public Constraint2DSW {
 	int contact_count;
 	bool collided;
 	bool oneway_disabled;
+	bool batched;
+	bool batch_collided;
+	// static and kinematic bodies can be shared by islands solved on other threads, so impulses are only applied to dynamic ones
+	bool dynamic_A;
+	bool dynamic_B;
 	int cc;
 
+	_FORCE_INLINE_ bool _can_collide() const;
 	bool _test_ccd(real_t p_step, Body2DSW *p_A, int p_shape_A, const Transform2D &p_xform_A, Body2DSW *p_B, int p_shape_B, const Transform2D &p_xform_B, bool p_swap_result = false);
 	void _validate_contacts();
 	static void _add_contact(const Vector2 &p_point_A, const Vector2 &p_point_B, void *p_self);
 	_FORCE_INLINE_ void _contact_added_callback(const Vector2 &p_point_A, const Vector2 &p_point_B);
 
+	SelfList<BodyPair2DSW> body_pair_list;
+
 public:
+	// contact cache saved and restored by space snapshots
+	struct State {
+
+		PairStateKey2DSW key;
+		Vector2 sep_axis;
+		uint32_t contact_count;
+		uint32_t oneway_disabled;
+		Contact contacts[MAX_CONTACTS];
+
+		_FORCE_INLINE_ bool operator<(const State &p_state) const { return key < p_state.key; }
+	};
+
+	// a state record is restored from user data, its contact count must fit the contacts array
+	static _FORCE_INLINE_ bool is_state_valid(const State &p_state) { return p_state.contact_count <= MAX_CONTACTS; }
+
+	_FORCE_INLINE_ void get_state_key(PairStateKey2DSW &r_key) const {
+
+		r_key.id_A = A->get_self().get_id();
+		r_key.shape_A = shape_A;
+		r_key.id_B = B->get_self().get_id();
+		r_key.shape_B = shape_B;
+	}
+
+	void save_state(State &r_state) const;
+	void restore_state(const State *p_state);
+
+	virtual CollisionSolver2DSW::BatchType setup_batch(CollisionSolver2DSW::BatchPair &r_pair);
 	bool setup(real_t p_step);
 	void solve(real_t p_step);
 
@@ -33,381 +33,536 @@
 
 #define LARGE_ELEMENT_FI 1.01239812
 
-void BroadPhase2DHashGrid::_pair_attempt(Element *p_elem, Element *p_with) {
+bool BroadPhase2DHashGrid::_is_large(const Rect2 &p_rect) const {
+
+	Vector2 sz = (p_rect.size / cell_size * LARGE_ELEMENT_FI); //use magic number to avoid floating point issues
+	return sz.width * sz.height > large_object_min_surface;
+}
+
+void BroadPhase2DHashGrid::_get_cells(const Rect2 &p_rect, Point2i &r_from, Point2i &r_to) const {
+
+	r_from = (p_rect.position / cell_size).floor();
+	r_to = ((p_rect.position + p_rect.size) / cell_size).floor();
+}
+
+/* PAIRS */
+
+// OAHashMap only clears the slots of erased entries when it grows, so rebuild
+// it once they pile up, or lookups of missing keys end up scanning all of it
+template <class M>
+static void _compact_map(M *&r_map, uint32_t &r_erased, uint32_t p_min_capacity) {
+
+	if (r_erased < r_map->get_capacity() / 2)
+		return;
+
+	M *map = memnew(M(MAX(p_min_capacity, r_map->get_num_elements() * 2)));
+	for (typename M::Iterator it = r_map->iter(); it.valid; it = r_map->next_iter(it)) {
+		map->set(*it.key, *it.data);
+	}
+
+	memdelete(r_map);
+	r_map = map;
+	r_erased = 0;
+}
+
+uint32_t BroadPhase2DHashGrid::_pair_find(const PairKey &p_key) const {
+
+	uint32_t idx;
+	if (!pair_map->lookup(p_key, &idx))
+		return INVALID_INDEX;
+	return idx;
+}
 
-	Map<Element *, PairData *>::Element *E = p_elem->paired.find(p_with);
+uint32_t BroadPhase2DHashGrid::_pair_create(Element *p_elem, Element *p_with) {
+
+	if (pair_free == INVALID_INDEX) {
+
+		uint32_t old_capacity = pair_capacity;
+		pair_capacity = pair_capacity ? pair_capacity * 2 : 256;
+		pairs = (PairData *)memrealloc(pairs, sizeof(PairData) * pair_capacity);
+
+		for (uint32_t i = old_capacity; i < pair_capacity; i++) {
+			pairs[i].next[0] = (i + 1 < pair_capacity) ? i + 1 : INVALID_INDEX;
+		}
+		pair_free = old_capacity;
+	}
+
+	uint32_t idx = pair_free;
+	PairData &pd = pairs[idx];
+	pair_free = pd.next[0];
+
+	pd.key = PairKey(p_elem->self, p_with->self);
+	pd.colliding = false;
+	pd.rc = 1;
+	pd.ud = NULL;
+
+	// link at the head of the pair lists of both elements
+	Element *elems[2] = { p_elem, p_with };
+	for (int i = 0; i < 2; i++) {
+
+		Element *e = elems[i];
+		pd.elem[i] = e;
+		pd.prev[i] = INVALID_INDEX;
+		pd.next[i] = e->pair_head;
+		if (e->pair_head != INVALID_INDEX) {
+			PairData &head = pairs[e->pair_head];
+			head.prev[head.elem[0] == e ? 0 : 1] = idx;
+		}
+		e->pair_head = idx;
+	}
+
+	pair_map->set(pd.key, idx);
+
+	return idx;
+}
+
+void BroadPhase2DHashGrid::_pair_free(uint32_t p_pair) {
+
+	PairData &pd = pairs[p_pair];
+
+	for (int i = 0; i < 2; i++) {
+
+		Element *e = pd.elem[i];
+
+		if (pd.prev[i] != INVALID_INDEX) {
+			PairData &prev = pairs[pd.prev[i]];
+			prev.next[prev.elem[0] == e ? 0 : 1] = pd.next[i];
+		} else {
+			e->pair_head = pd.next[i];
+		}
+
+		if (pd.next[i] != INVALID_INDEX) {
+			PairData &next = pairs[pd.next[i]];
+			next.prev[next.elem[0] == e ? 0 : 1] = pd.prev[i];
+		}
+	}
+
+	pair_map->remove(pd.key);
+	pair_map_erased++;
+	_compact_map(pair_map, pair_map_erased, 64);
+
+	pd.next[0] = pair_free;
+	pair_free = p_pair;
+}
+
+void BroadPhase2DHashGrid::_pair_attempt(Element *p_elem, Element *p_with) {
 
 	ERR_FAIL_COND(p_elem->_static && p_with->_static);
 
-	if (!E) {
+	uint32_t idx = _pair_find(PairKey(p_elem->self, p_with->self));
+
+	if (idx == INVALID_INDEX) {
 
-		PairData *pd = memnew(PairData);
-		p_elem->paired[p_with] = pd;
-		p_with->paired[p_elem] = pd;
+		_pair_create(p_elem, p_with);
 	} else {
-		E->get()->rc++;
+		pairs[idx].rc++;
 	}
 }
 
 void BroadPhase2DHashGrid::_unpair_attempt(Element *p_elem, Element *p_with) {
 
-	Map<Element *, PairData *>::Element *E = p_elem->paired.find(p_with);
+	uint32_t idx = _pair_find(PairKey(p_elem->self, p_with->self));
 
-	ERR_FAIL_COND(!E); //this should really be paired..
+	ERR_FAIL_COND(idx == INVALID_INDEX); //this should really be paired..
 
-	E->get()->rc--;
+	PairData &pd = pairs[idx];
+	pd.rc--;
 
-	if (E->get()->rc == 0) {
+	if (pd.rc == 0) {
 
-		if (E->get()->colliding) {
+		if (pd.colliding) {
 			//uncollide
 			if (unpair_callback) {
-				unpair_callback(p_elem->owner, p_elem->subindex, p_with->owner, p_with->subindex, E->get()->ud, unpair_userdata);
+				unpair_callback(p_elem->owner, p_elem->subindex, p_with->owner, p_with->subindex, pd.ud, unpair_userdata);
 			}
 		}
 
-		memdelete(E->get());
-		p_elem->paired.erase(E);
-		p_with->paired.erase(p_elem);
+		_pair_free(idx);
 	}
 }
 
 void BroadPhase2DHashGrid::_check_motion(Element *p_elem) {
 
-	for (Map<Element *, PairData *>::Element *E = p_elem->paired.front(); E; E = E->next()) {
+	uint32_t idx = p_elem->pair_head;
+
+	while (idx != INVALID_INDEX) {
+
+		PairData &pd = pairs[idx];
+		int side = pd.elem[0] == p_elem ? 0 : 1;
+		Element *other = pd.elem[side ^ 1];
 
-		bool pairing = p_elem->aabb.intersects(E->key()->aabb);
+		bool pairing = p_elem->aabb.intersects(other->aabb);
 
-		if (pairing != E->get()->colliding) {
+		if (pairing != pd.colliding) {
 
 			if (pairing) {
 
 				if (pair_callback) {
-					E->get()->ud = pair_callback(p_elem->owner, p_elem->subindex, E->key()->owner, E->key()->subindex, pair_userdata);
+					pd.ud = pair_callback(p_elem->owner, p_elem->subindex, other->owner, other->subindex, pair_userdata);
 				}
 			} else {
 
 				if (unpair_callback) {
-					unpair_callback(p_elem->owner, p_elem->subindex, E->key()->owner, E->key()->subindex, E->get()->ud, unpair_userdata);
+					unpair_callback(p_elem->owner, p_elem->subindex, other->owner, other->subindex, pd.ud, unpair_userdata);
 				}
 			}
 
-			E->get()->colliding = pairing;
+			pd.colliding = pairing;
 		}
+
+		idx = pd.next[side];
 	}
 }
 
-void BroadPhase2DHashGrid::_enter_grid(Element *p_elem, const Rect2 &p_rect, bool p_static) {
+/* CELLS */
 
-	Vector2 sz = (p_rect.size / cell_size * LARGE_ELEMENT_FI); //use magic number to avoid floating point issues
-	if (sz.width * sz.height > large_object_min_surface) {
-		//large object, do not use grid, must check against all elements
-		for (Map<ID, Element>::Element *E = element_map.front(); E; E = E->next()) {
-			if (E->key() == p_elem->self)
-				continue; // do not pair against itself
-			if (E->get().owner == p_elem->owner)
-				continue;
-			if (E->get()._static && p_static)
-				continue;
+BroadPhase2DHashGrid::PosBin *BroadPhase2DHashGrid::_find_bin(const PosKey &p_key) const {
 
-			_pair_attempt(p_elem, &E->get());
-		}
+	PosBin *pb;
+	if (!bin_map->lookup(p_key, &pb))
+		return NULL;
+	return pb;
+}
 
-		large_elements[p_elem].inc();
-		return;
+BroadPhase2DHashGrid::PosBin *BroadPhase2DHashGrid::_create_bin(const PosKey &p_key) {
+
+	PosBin *pb;
+	if (free_bins) {
+		// recycled bins keep their list storage
+		pb = free_bins;
+		free_bins = pb->next_free;
+	} else {
+		pb = memnew(PosBin);
 	}
 
-	Point2i from = (p_rect.position / cell_size).floor();
-	Point2i to = ((p_rect.position + p_rect.size) / cell_size).floor();
+	pb->key = p_key;
+	pb->next_free = NULL;
 
-	for (int i = from.x; i <= to.x; i++) {
+	bin_map->set(p_key, pb);
 
-		for (int j = from.y; j <= to.y; j++) {
+	return pb;
+}
 
-			PosKey pk;
-			pk.x = i;
-			pk.y = j;
+void BroadPhase2DHashGrid::_erase_bin(PosBin *p_bin) {
 
-			uint32_t idx = pk.hash() % hash_table_size;
-			PosBin *pb = hash_table[idx];
+	bin_map->remove(p_bin->key);
+	bin_map_erased++;
+	_compact_map(bin_map, bin_map_erased, bin_map_min_capacity);
 
-			while (pb) {
+	p_bin->next_free = free_bins;
+	free_bins = p_bin;
+}
 
-				if (pb->key == pk) {
-					break;
-				}
+void BroadPhase2DHashGrid::_enter_cells(Element *p_elem, const Point2i &p_from, const Point2i &p_to, const Point2i &p_skip_from, const Point2i &p_skip_to, bool p_static) {
 
-				pb = pb->next;
-			}
+	for (int i = p_from.x; i <= p_to.x; i++) {
+
+		bool skip_column = i >= p_skip_from.x && i <= p_skip_to.x;
+
+		for (int j = p_from.y; j <= p_to.y; j++) {
 
-			bool entered = false;
+			if (skip_column && j >= p_skip_from.y && j <= p_skip_to.y)
+				continue; // already in this cell
+
+			PosKey pk;
+			pk.x = i;
+			pk.y = j;
+
+			PosBin *pb = _find_bin(pk);
 
 			if (!pb) {
 				//does not exist, create!
-				pb = memnew(PosBin);
-				pb->key = pk;
-				pb->next = hash_table[idx];
-				hash_table[idx] = pb;
+				pb = _create_bin(pk);
 			}
 
-			if (p_static) {
-				if (pb->static_object_set[p_elem].inc() == 1) {
-					entered = true;
-				}
-			} else {
-				if (pb->object_set[p_elem].inc() == 1) {
+			for (uint32_t k = 0; k < pb->object_set.size; k++) {
 
-					entered = true;
-				}
+				Element *e = pb->object_set.data[k];
+				if (e->owner == p_elem->owner)
+					continue;
+				_pair_attempt(p_elem, e);
 			}
 
-			if (entered) {
+			if (!p_static) {
 
-				for (Map<Element *, RC>::Element *E = pb->object_set.front(); E; E = E->next()) {
+				for (uint32_t k = 0; k < pb->static_object_set.size; k++) {
 
-					if (E->key()->owner == p_elem->owner)
+					Element *e = pb->static_object_set.data[k];
+					if (e->owner == p_elem->owner)
 						continue;
-					_pair_attempt(p_elem, E->key());
+					_pair_attempt(p_elem, e);
 				}
 
-				if (!p_static) {
-
-					for (Map<Element *, RC>::Element *E = pb->static_object_set.front(); E; E = E->next()) {
-
-						if (E->key()->owner == p_elem->owner)
-							continue;
-						_pair_attempt(p_elem, E->key());
-					}
-				}
+				pb->object_set.push_back(p_elem);
+			} else {
+				pb->static_object_set.push_back(p_elem);
 			}
 		}
 	}
-
-	//pair separatedly with large elements
-
-	for (Map<Element *, RC>::Element *E = large_elements.front(); E; E = E->next()) {
-
-		if (E->key() == p_elem)
-			continue; // do not pair against itself
-		if (E->key()->owner == p_elem->owner)
-			continue;
-		if (E->key()->_static && p_static)
-			continue;
-
-		_pair_attempt(E->key(), p_elem);
-	}
 }
 
-void BroadPhase2DHashGrid::_exit_grid(Element *p_elem, const Rect2 &p_rect, bool p_static) {
-
-	Vector2 sz = (p_rect.size / cell_size * LARGE_ELEMENT_FI);
-	if (sz.width * sz.height > large_object_min_surface) {
-
-		//unpair all elements, instead of checking all, just check what is already paired, so we at least save from checking static vs static
-		Map<Element *, PairData *>::Element *E = p_elem->paired.front();
-		while (E) {
-			Map<Element *, PairData *>::Element *next = E->next();
-			_unpair_attempt(p_elem, E->key());
-			E = next;
-		}
+void BroadPhase2DHashGrid::_exit_cells(Element *p_elem, const Point2i &p_from, const Point2i &p_to, const Point2i &p_skip_from, const Point2i &p_skip_to, bool p_static) {
 
-		if (large_elements[p_elem].dec() == 0) {
-			large_elements.erase(p_elem);
-		}
-		return;
-	}
+	for (int i = p_from.x; i <= p_to.x; i++) {
 
-	Point2i from = (p_rect.position / cell_size).floor();
-	Point2i to = ((p_rect.position + p_rect.size) / cell_size).floor();
+		bool skip_column = i >= p_skip_from.x && i <= p_skip_to.x;
 
-	for (int i = from.x; i <= to.x; i++) {
+		for (int j = p_from.y; j <= p_to.y; j++) {
 
-		for (int j = from.y; j <= to.y; j++) {
+			if (skip_column && j >= p_skip_from.y && j <= p_skip_to.y)
+				continue; // still in this cell
 
 			PosKey pk;
 			pk.x = i;
 			pk.y = j;
 
-			uint32_t idx = pk.hash() % hash_table_size;
-			PosBin *pb = hash_table[idx];
+			PosBin *pb = _find_bin(pk);
 
-			while (pb) {
-
-				if (pb->key == pk) {
-					break;
-				}
+			ERR_CONTINUE(!pb); //should exist!!
 
-				pb = pb->next;
+			if (p_static) {
+				ERR_CONTINUE(!pb->static_object_set.erase(p_elem));
+			} else {
+				ERR_CONTINUE(!pb->object_set.erase(p_elem));
 			}
 
-			ERR_CONTINUE(!pb); //should exist!!
+			for (uint32_t k = 0; k < pb->object_set.size; k++) {
 
-			bool exited = false;
+				Element *e = pb->object_set.data[k];
+				if (e->owner == p_elem->owner)
+					continue;
+				_unpair_attempt(p_elem, e);
+			}
 
-			if (p_static) {
-				if (pb->static_object_set[p_elem].dec() == 0) {
+			if (!p_static) {
 
-					pb->static_object_set.erase(p_elem);
-					exited = true;
-				}
-			} else {
-				if (pb->object_set[p_elem].dec() == 0) {
+				for (uint32_t k = 0; k < pb->static_object_set.size; k++) {
 
-					pb->object_set.erase(p_elem);
-					exited = true;
+					Element *e = pb->static_object_set.data[k];
+					if (e->owner == p_elem->owner)
+						continue;
+					_unpair_attempt(p_elem, e);
 				}
 			}
 
-			if (exited) {
+			if (pb->object_set.size == 0 && pb->static_object_set.size == 0) {
+				_erase_bin(pb);
+			}
+		}
+	}
+}
 
-				for (Map<Element *, RC>::Element *E = pb->object_set.front(); E; E = E->next()) {
+void BroadPhase2DHashGrid::_enter_grid(Element *p_elem, const Rect2 &p_rect, bool p_static) {
 
-					if (E->key()->owner == p_elem->owner)
-						continue;
-					_unpair_attempt(p_elem, E->key());
-				}
+	if (_is_large(p_rect)) {
+		//large object, do not use grid, must check against all elements
+		for (int i = 0; i < elements.size(); i++) {
 
-				if (!p_static) {
+			Element *e = elements[i];
+			if (!e->owner)
+				continue; // free slot
+			if (e == p_elem)
+				continue; // do not pair against itself
+			if (e->owner == p_elem->owner)
+				continue;
+			if (e->_static && p_static)
+				continue;
 
-					for (Map<Element *, RC>::Element *E = pb->static_object_set.front(); E; E = E->next()) {
+			_pair_attempt(p_elem, e);
+		}
 
-						if (E->key()->owner == p_elem->owner)
-							continue;
-						_unpair_attempt(p_elem, E->key());
-					}
-				}
-			}
+		if (p_elem->large_index == INVALID_INDEX) {
+			p_elem->large_index = large_elements.size();
+			large_elements.push_back(p_elem);
+		}
+		return;
+	}
 
-			if (pb->object_set.empty() && pb->static_object_set.empty()) {
+	Point2i from, to;
+	_get_cells(p_rect, from, to);
+	_enter_cells(p_elem, from, to, Point2i(1, 1), Point2i(0, 0), p_static);
 
-				if (hash_table[idx] == pb) {
-					hash_table[idx] = pb->next;
-				} else {
+	//pair separatedly with large elements
 
-					PosBin *px = hash_table[idx];
+	for (int i = 0; i < large_elements.size(); i++) {
 
-					while (px) {
+		Element *e = large_elements[i];
+		if (e == p_elem)
+			continue; // do not pair against itself
+		if (e->owner == p_elem->owner)
+			continue;
+		if (e->_static && p_static)
+			continue;
 
-						if (px->next == pb) {
-							px->next = pb->next;
-							break;
-						}
+		_pair_attempt(e, p_elem);
+	}
+}
 
-						px = px->next;
-					}
+void BroadPhase2DHashGrid::_exit_grid(Element *p_elem, const Rect2 &p_rect, bool p_static) {
 
-					ERR_CONTINUE(!px);
-				}
+	if (_is_large(p_rect)) {
 
-				memdelete(pb);
-			}
+		//unpair all elements, instead of checking all, just check what is already paired, so we at least save from checking static vs static
+		uint32_t idx = p_elem->pair_head;
+		while (idx != INVALID_INDEX) {
+			PairData &pd = pairs[idx];
+			int side = pd.elem[0] == p_elem ? 0 : 1;
+			uint32_t next = pd.next[side];
+			_unpair_attempt(p_elem, pd.elem[side ^ 1]);
+			idx = next;
 		}
+
+		if (p_elem->large_index != INVALID_INDEX) {
+			Element *last = large_elements[large_elements.size() - 1];
+			large_elements.set(p_elem->large_index, last);
+			last->large_index = p_elem->large_index;
+			large_elements.resize(large_elements.size() - 1);
+			p_elem->large_index = INVALID_INDEX;
+		}
+		return;
 	}
 
-	for (Map<Element *, RC>::Element *E = large_elements.front(); E; E = E->next()) {
-		if (E->key() == p_elem)
+	Point2i from, to;
+	_get_cells(p_rect, from, to);
+	_exit_cells(p_elem, from, to, Point2i(1, 1), Point2i(0, 0), p_static);
+
+	for (int i = 0; i < large_elements.size(); i++) {
+
+		Element *e = large_elements[i];
+		if (e == p_elem)
 			continue; // do not pair against itself
-		if (E->key()->owner == p_elem->owner)
+		if (e->owner == p_elem->owner)
 			continue;
-		if (E->key()->_static && p_static)
+		if (e->_static && p_static)
 			continue;
 
 		//unpair from large elements
-		_unpair_attempt(p_elem, E->key());
+		_unpair_attempt(p_elem, e);
 	}
 }
 
 BroadPhase2DHashGrid::ID BroadPhase2DHashGrid::create(CollisionObject2DSW *p_object, int p_subindex) {
 
-	current++;
+	ERR_FAIL_COND_V(!p_object, 0);
+
+	Element *e;
+	ID id;
 
-	Element e;
-	e.owner = p_object;
-	e._static = false;
-	e.subindex = p_subindex;
-	e.self = current;
-	e.pass = 0;
+	if (free_ids.size()) {
+		id = free_ids[free_ids.size() - 1];
+		free_ids.resize(free_ids.size() - 1);
+		e = elements[id - 1];
+	} else {
+		e = memnew(Element);
+		elements.push_back(e);
+		id = elements.size();
+	}
+
+	e->owner = p_object;
+	e->_static = false;
+	e->aabb = Rect2();
+	e->subindex = p_subindex;
+	e->self = id;
+	e->pass = 0;
+	e->pair_head = INVALID_INDEX;
+	e->large_index = INVALID_INDEX;
 
-	element_map[current] = e;
-	return current;
+	return id;
 }
 
 void BroadPhase2DHashGrid::move(ID p_id, const Rect2 &p_aabb) {
 
-	Map<ID, Element>::Element *E = element_map.find(p_id);
-	ERR_FAIL_COND(!E);
+	Element *e = _get_element(p_id);
+	ERR_FAIL_COND(!e || !e->owner);
 
-	Element &e = E->get();
-
-	if (p_aabb == e.aabb)
+	if (p_aabb == e->aabb)
 		return;
 
-	if (p_aabb != Rect2()) {
+	if (p_aabb != Rect2() && e->aabb != Rect2()) {
 
-		_enter_grid(&e, p_aabb, e._static);
-	}
+		bool large = _is_large(p_aabb);
 
-	if (e.aabb != Rect2()) {
+		if (large != _is_large(e->aabb)) {
 
-		_exit_grid(&e, e.aabb, e._static);
-	}
+			_enter_grid(e, p_aabb, e->_static);
+			_exit_grid(e, e->aabb, e->_static);
 
-	e.aabb = p_aabb;
+		} else if (!large) {
+
+			// only enter and exit the cells that changed, pairs with large elements stay as they are
+			Point2i old_from, old_to, from, to;
+			_get_cells(e->aabb, old_from, old_to);
+			_get_cells(p_aabb, from, to);
+
+			if (from != old_from || to != old_to) {
+				_enter_cells(e, from, to, old_from, old_to, e->_static);
+				_exit_cells(e, old_from, old_to, from, to, e->_static);
+			}
+		}
+	} else {
+
+		if (p_aabb != Rect2()) {
+
+			_enter_grid(e, p_aabb, e->_static);
+		}
+
+		if (e->aabb != Rect2()) {
+
+			_exit_grid(e, e->aabb, e->_static);
+		}
+	}
 
-	_check_motion(&e);
+	e->aabb = p_aabb;
 
-	e.aabb = p_aabb;
+	_check_motion(e);
 }
 void BroadPhase2DHashGrid::set_static(ID p_id, bool p_static) {
 
-	Map<ID, Element>::Element *E = element_map.find(p_id);
-	ERR_FAIL_COND(!E);
-
-	Element &e = E->get();
+	Element *e = _get_element(p_id);
+	ERR_FAIL_COND(!e || !e->owner);
 
-	if (e._static == p_static)
+	if (e->_static == p_static)
 		return;
 
-	if (e.aabb != Rect2())
-		_exit_grid(&e, e.aabb, e._static);
+	if (e->aabb != Rect2())
+		_exit_grid(e, e->aabb, e->_static);
 
-	e._static = p_static;
+	e->_static = p_static;
 
-	if (e.aabb != Rect2()) {
-		_enter_grid(&e, e.aabb, e._static);
-		_check_motion(&e);
+	if (e->aabb != Rect2()) {
+		_enter_grid(e, e->aabb, e->_static);
+		_check_motion(e);
 	}
 }
 void BroadPhase2DHashGrid::remove(ID p_id) {
 
-	Map<ID, Element>::Element *E = element_map.find(p_id);
-	ERR_FAIL_COND(!E);
-
-	Element &e = E->get();
+	Element *e = _get_element(p_id);
+	ERR_FAIL_COND(!e || !e->owner);
 
-	if (e.aabb != Rect2())
-		_exit_grid(&e, e.aabb, e._static);
+	if (e->aabb != Rect2())
+		_exit_grid(e, e->aabb, e->_static);
 
-	element_map.erase(p_id);
+	e->owner = NULL;
+	free_ids.push_back(p_id);
 }
 
 CollisionObject2DSW *BroadPhase2DHashGrid::get_object(ID p_id) const {
 
-	const Map<ID, Element>::Element *E = element_map.find(p_id);
-	ERR_FAIL_COND_V(!E, NULL);
-	return E->get().owner;
+	const Element *e = _get_element(p_id);
+	ERR_FAIL_COND_V(!e || !e->owner, NULL);
+	return e->owner;
 }
 bool BroadPhase2DHashGrid::is_static(ID p_id) const {
 
-	const Map<ID, Element>::Element *E = element_map.find(p_id);
-	ERR_FAIL_COND_V(!E, false);
-	return E->get()._static;
+	const Element *e = _get_element(p_id);
+	ERR_FAIL_COND_V(!e || !e->owner, false);
+	return e->_static;
 }
 int BroadPhase2DHashGrid::get_subindex(ID p_id) const {
 
-	const Map<ID, Element>::Element *E = element_map.find(p_id);
-	ERR_FAIL_COND_V(!E, -1);
-	return E->get().subindex;
+	const Element *e = _get_element(p_id);
+	ERR_FAIL_COND_V(!e || !e->owner, -1);
+	return e->subindex;
 }
 
 template <bool use_aabb, bool use_segment>
@@ -417,58 +572,52 @@ void BroadPhase2DHashGrid::_cull(const Point2i p_cell, const Rect2 &p_aabb, cons
 	pk.x = p_cell.x;
 	pk.y = p_cell.y;
 
-	uint32_t idx = pk.hash() % hash_table_size;
-	PosBin *pb = hash_table[idx];
-
-	while (pb) {
-
-		if (pb->key == pk) {
-			break;
-		}
-
-		pb = pb->next;
-	}
+	PosBin *pb = _find_bin(pk);
 
 	if (!pb)
 		return;
 
-	for (Map<Element *, RC>::Element *E = pb->object_set.front(); E; E = E->next()) {
+	for (uint32_t i = 0; i < pb->object_set.size; i++) {
+
+		Element *e = pb->object_set.data[i];
 
 		if (index >= p_max_results)
 			break;
-		if (E->key()->pass == pass)
+		if (e->pass == pass)
 			continue;
 
-		E->key()->pass = pass;
+		e->pass = pass;
 
-		if (use_aabb && !p_aabb.intersects(E->key()->aabb))
+		if (use_aabb && !p_aabb.intersects(e->aabb))
 			continue;
 
-		if (use_segment && !E->key()->aabb.intersects_segment(p_from, p_to))
+		if (use_segment && !e->aabb.intersects_segment(p_from, p_to))
 			continue;
 
-		p_results[index] = E->key()->owner;
-		p_result_indices[index] = E->key()->subindex;
+		p_results[index] = e->owner;
+		p_result_indices[index] = e->subindex;
 		index++;
 	}
 
-	for (Map<Element *, RC>::Element *E = pb->static_object_set.front(); E; E = E->next()) {
+	for (uint32_t i = 0; i < pb->static_object_set.size; i++) {
+
+		Element *e = pb->static_object_set.data[i];
 
 		if (index >= p_max_results)
 			break;
-		if (E->key()->pass == pass)
+		if (e->pass == pass)
 			continue;
 
-		if (use_aabb && !p_aabb.intersects(E->key()->aabb)) {
+		if (use_aabb && !p_aabb.intersects(e->aabb)) {
 			continue;
 		}
 
-		if (use_segment && !E->key()->aabb.intersects_segment(p_from, p_to))
+		if (use_segment && !e->aabb.intersects_segment(p_from, p_to))
 			continue;
 
-		E->key()->pass = pass;
-		p_results[index] = E->key()->owner;
-		p_result_indices[index] = E->key()->subindex;
+		e->pass = pass;
+		p_results[index] = e->owner;
+		p_result_indices[index] = e->subindex;
 		index++;
 	}
 }
@@ -548,25 +697,22 @@ int BroadPhase2DHashGrid::cull_segment(const Vector2 &p_from, const Vector2 &p_t
 			break;
 	}
 
-	for (Map<Element *, RC>::Element *E = large_elements.front(); E; E = E->next()) {
+	for (int i = 0; i < large_elements.size(); i++) {
+
+		Element *e = large_elements[i];
 
 		if (cullcount >= p_max_results)
 			break;
-		if (E->key()->pass == pass)
+		if (e->pass == pass)
 			continue;
 
-		E->key()->pass = pass;
+		e->pass = pass;
 
-		/*
-		if (use_aabb && !p_aabb.intersects(E->key()->aabb))
+		if (!e->aabb.intersects_segment(p_from, p_to))
 			continue;
-		*/
 
-		if (!E->key()->aabb.intersects_segment(p_from, p_to))
-			continue;
-
-		p_results[cullcount] = E->key()->owner;
-		p_result_indices[cullcount] = E->key()->subindex;
+		p_results[cullcount] = e->owner;
+		p_result_indices[cullcount] = e->subindex;
 		cullcount++;
 	}
 
@@ -577,8 +723,8 @@ int BroadPhase2DHashGrid::cull_aabb(const Rect2 &p_aabb, CollisionObject2DSW **p
 
 	pass++;
 
-	Point2i from = (p_aabb.position / cell_size).floor();
-	Point2i to = ((p_aabb.position + p_aabb.size) / cell_size).floor();
+	Point2i from, to;
+	_get_cells(p_aabb, from, to);
 	int cullcount = 0;
 
 	for (int i = from.x; i <= to.x; i++) {
@@ -589,25 +735,22 @@ int BroadPhase2DHashGrid::cull_aabb(const Rect2 &p_aabb, CollisionObject2DSW **p
 		}
 	}
 
-	for (Map<Element *, RC>::Element *E = large_elements.front(); E; E = E->next()) {
+	for (int i = 0; i < large_elements.size(); i++) {
+
+		Element *e = large_elements[i];
 
 		if (cullcount >= p_max_results)
 			break;
-		if (E->key()->pass == pass)
+		if (e->pass == pass)
 			continue;
 
-		E->key()->pass = pass;
+		e->pass = pass;
 
-		if (!p_aabb.intersects(E->key()->aabb))
+		if (!p_aabb.intersects(e->aabb))
 			continue;
 
-		/*
-		if (!E->key()->aabb.intersects_segment(p_from,p_to))
-			continue;
-		*/
-
-		p_results[cullcount] = E->key()->owner;
-		p_result_indices[cullcount] = E->key()->subindex;
+		p_results[cullcount] = e->owner;
+		p_result_indices[cullcount] = e->subindex;
 		cullcount++;
 	}
 	return cullcount;
@@ -634,31 +777,48 @@ BroadPhase2DSW *BroadPhase2DHashGrid::_create() {
 
 BroadPhase2DHashGrid::BroadPhase2DHashGrid() {
 
-	hash_table_size = GLOBAL_DEF("physics/2d/bp_hash_table_size", 4096);
-	hash_table_size = Math::larger_prime(hash_table_size);
-	hash_table = memnew_arr(PosBin *, hash_table_size);
+	bin_map_min_capacity = MAX((int)GLOBAL_DEF("physics/2d/bp_hash_table_size", 4096), 64);
+	bin_map = memnew(BinMap(bin_map_min_capacity));
+	bin_map_erased = 0;
+	free_bins = NULL;
 
 	cell_size = GLOBAL_DEF("physics/2d/cell_size", 128);
 	large_object_min_surface = GLOBAL_DEF("physics/2d/large_object_surface_threshold_in_cells", 512);
 
-	for (uint32_t i = 0; i < hash_table_size; i++)
-		hash_table[i] = NULL;
+	pairs = NULL;
+	pair_capacity = 0;
+	pair_free = INVALID_INDEX;
+	pair_map = memnew(PairMap);
+	pair_map_erased = 0;
+
 	pass = 1;
 
-	current = 0;
+	pair_callback = NULL;
+	pair_userdata = NULL;
+	unpair_callback = NULL;
+	unpair_userdata = NULL;
 }
 
 BroadPhase2DHashGrid::~BroadPhase2DHashGrid() {
 
-	for (uint32_t i = 0; i < hash_table_size; i++) {
-		while (hash_table[i]) {
-			PosBin *pb = hash_table[i];
-			hash_table[i] = pb->next;
-			memdelete(pb);
-		}
+	for (BinMap::Iterator it = bin_map->iter(); it.valid; it = bin_map->next_iter(it)) {
+		memdelete(*it.data);
+	}
+
+	while (free_bins) {
+		PosBin *pb = free_bins;
+		free_bins = pb->next_free;
+		memdelete(pb);
 	}
 
-	memdelete_arr(hash_table);
+	memdelete(bin_map);
+
+	for (int i = 0; i < elements.size(); i++)
+		memdelete(elements[i]);
+
+	if (pairs)
+		memfree(pairs);
+	memdelete(pair_map);
 }
 
 /* 3D version of voxel traversal:
@@ -32,58 +32,54 @@
 #define BROAD_PHASE_2D_HASH_GRID_H
 
 #include "broad_phase_2d_sw.h"
-#include "map.h"
+#include "oa_hash_map.h"
+#include "vector.h"
 
 class BroadPhase2DHashGrid : public BroadPhase2DSW {
 
-	struct PairData {
-
-		bool colliding;
-		int rc;
-		void *ud;
-		PairData() {
-			colliding = false;
-			rc = 1;
-			ud = NULL;
-		}
+	enum {
+		INVALID_INDEX = 0xFFFFFFFF
 	};
 
-	struct Element {
+	struct Element;
 
-		ID self;
-		CollisionObject2DSW *owner;
-		bool _static;
-		Rect2 aabb;
-		int subindex;
-		uint64_t pass;
-		Map<Element *, PairData *> paired;
-	};
+	// flat array of elements, entries are removed by swapping with the last one
+	struct ElementList {
 
-	struct RC {
+		Element **data;
+		uint32_t size;
+		uint32_t capacity;
 
-		int ref;
+		_FORCE_INLINE_ void push_back(Element *p_elem) {
+			if (size == capacity) {
+				capacity = capacity ? capacity * 2 : 8;
+				data = (Element **)memrealloc(data, sizeof(Element *) * capacity);
+			}
+			data[size++] = p_elem;
+		}
 
-		_FORCE_INLINE_ int inc() {
-			ref++;
-			return ref;
+		_FORCE_INLINE_ bool erase(Element *p_elem) {
+			for (uint32_t i = 0; i < size; i++) {
+				if (data[i] == p_elem) {
+					data[i] = data[--size];
+					return true;
+				}
+			}
+			return false;
 		}
-		_FORCE_INLINE_ int dec() {
-			ref--;
-			return ref;
+
+		ElementList() {
+			data = NULL;
+			size = 0;
+			capacity = 0;
 		}
 
-		_FORCE_INLINE_ RC() {
-			ref = 0;
+		~ElementList() {
+			if (data)
+				memfree(data);
 		}
 	};
 
-	Map<ID, Element> element_map;
-	Map<Element *, RC> large_elements;
-
-	ID current;
-
-	uint64_t pass;
-
 	struct PairKey {
 
 		union {
@@ -94,6 +90,21 @@ class BroadPhase2DHashGrid : public BroadPhase2DSW {
 			uint64_t key;
 		};
 
+		_FORCE_INLINE_ uint32_t hash() const {
+			uint64_t k = key;
+			k = (~k) + (k << 18);
+			k = k ^ (k >> 31);
+			k = k * 21;
+			k = k ^ (k >> 11);
+			k = k + (k << 6);
+			k = k ^ (k >> 22);
+			return k;
+		}
+
+		_FORCE_INLINE_ bool operator==(const PairKey &p_key) const {
+			return key == p_key.key;
+		}
+
 		_FORCE_INLINE_ bool operator<(const PairKey &p_key) const {
 			return key < p_key.key;
 		}
@@ -110,7 +121,48 @@ class BroadPhase2DHashGrid : public BroadPhase2DSW {
 		}
 	};
 
-	Map<PairKey, PairData> pair_map;
+	// pooled pair record, linked into the pair lists of both of its elements
+	struct PairData {
+
+		PairKey key;
+		Element *elem[2];
+		uint32_t next[2];
+		uint32_t prev[2];
+		bool colliding;
+		int rc;
+		void *ud;
+	};
+
+	struct Element {
+
+		ID self;
+		CollisionObject2DSW *owner;
+		bool _static;
+		Rect2 aabb;
+		int subindex;
+		uint64_t pass;
+		uint32_t pair_head;
+		uint32_t large_index;
+	};
+
+	Vector<Element *> elements; // indexed by ID - 1
+	Vector<ID> free_ids;
+	Vector<Element *> large_elements;
+
+	PairData *pairs;
+	uint32_t pair_capacity;
+	uint32_t pair_free;
+
+	struct PairKeyHasher {
+		static _FORCE_INLINE_ uint32_t hash(const PairKey &p_key) { return p_key.hash(); }
+	};
+
+	typedef OAHashMap<PairKey, uint32_t, 64, PairKeyHasher> PairMap;
+
+	PairMap *pair_map; // pair index by key
+	uint32_t pair_map_erased;
+
+	uint64_t pass;
 
 	int cell_size;
 	int large_object_min_surface;
@@ -120,6 +172,20 @@ class BroadPhase2DHashGrid : public BroadPhase2DSW {
 	UnpairCallback unpair_callback;
 	void *unpair_userdata;
 
+	_FORCE_INLINE_ Element *_get_element(ID p_id) const {
+		return (p_id > 0 && p_id <= (ID)elements.size()) ? elements[p_id - 1] : NULL;
+	}
+
+	_FORCE_INLINE_ bool _is_large(const Rect2 &p_rect) const;
+	_FORCE_INLINE_ void _get_cells(const Rect2 &p_rect, Point2i &r_from, Point2i &r_to) const;
+
+	uint32_t _pair_find(const PairKey &p_key) const;
+	uint32_t _pair_create(Element *p_elem, Element *p_with);
+	void _pair_free(uint32_t p_pair);
+
+	void _enter_cells(Element *p_elem, const Point2i &p_from, const Point2i &p_to, const Point2i &p_skip_from, const Point2i &p_skip_to, bool p_static);
+	void _exit_cells(Element *p_elem, const Point2i &p_from, const Point2i &p_to, const Point2i &p_skip_from, const Point2i &p_skip_to, bool p_static);
+
 	void _enter_grid(Element *p_elem, const Rect2 &p_rect, bool p_static);
 	void _exit_grid(Element *p_elem, const Rect2 &p_rect, bool p_static);
 	template <bool use_aabb, bool use_segment>
@@ -155,13 +221,25 @@ class BroadPhase2DHashGrid : public BroadPhase2DSW {
 	struct PosBin {
 
 		PosKey key;
-		Map<Element *, RC> object_set;
-		Map<Element *, RC> static_object_set;
-		PosBin *next;
+		ElementList object_set;
+		ElementList static_object_set;
+		PosBin *next_free;
 	};
 
-	uint32_t hash_table_size;
-	PosBin **hash_table;
+	struct PosKeyHasher {
+		static _FORCE_INLINE_ uint32_t hash(const PosKey &p_key) { return p_key.hash(); }
+	};
+
+	typedef OAHashMap<PosKey, PosBin *, 64, PosKeyHasher> BinMap;
+
+	BinMap *bin_map;
+	uint32_t bin_map_erased;
+	uint32_t bin_map_min_capacity;
+	PosBin *free_bins;
+
+	_FORCE_INLINE_ PosBin *_find_bin(const PosKey &p_key) const;
+	PosBin *_create_bin(const PosKey &p_key);
+	void _erase_bin(PosBin *p_bin);
 
 	void _pair_attempt(Element *p_elem, Element *p_with);
 	void _unpair_attempt(Element *p_elem, Element *p_with);
@@ -308,6 +308,9 @@ public:
 		return true;
 	}
 
+	// used by the batched kernels, which find the axis themselves
+	_FORCE_INLINE_ void set_best_axis(const Vector2 &p_axis) { best_axis = p_axis; }
+
 	_FORCE_INLINE_ void generate_contacts() {
 
 		// nothing to do, don't generate
@@ -1339,3 +1342,402 @@ bool sat_2d_calculate_penetration(const Shape2DSW *p_shape_A, const Transform2D
 
 	return callback.collided;
 }
+
+/****** BATCHED SAT TESTS *******/
+
+// Pairs are tested in chunks laid out as structure of arrays. Each kernel loop handles one pair per
+// iteration and keeps its state in registers, with selects instead of branches, so the compiler can
+// run several pairs side by side in SSE/NEON lanes. Separation is only decided once all axes are done,
+// which gives the same result as the early outs of the scalar path.
+
+#define SAT_BATCH_CHUNK 64
+
+struct _SATBatchSide2D {
+
+	real_t origin_x[SAT_BATCH_CHUNK];
+	real_t origin_y[SAT_BATCH_CHUNK];
+	real_t axis0_x[SAT_BATCH_CHUNK];
+	real_t axis0_y[SAT_BATCH_CHUNK];
+	real_t axis1_x[SAT_BATCH_CHUNK];
+	real_t axis1_y[SAT_BATCH_CHUNK];
+	real_t extent_x[SAT_BATCH_CHUNK]; // circle and capsule radius, rectangle half extents
+	real_t extent_y[SAT_BATCH_CHUNK]; // capsule height
+
+	_FORCE_INLINE_ void load(int i, const Transform2D &p_xform) {
+
+		axis0_x[i] = p_xform.elements[0].x;
+		axis0_y[i] = p_xform.elements[0].y;
+		axis1_x[i] = p_xform.elements[1].x;
+		axis1_y[i] = p_xform.elements[1].y;
+		origin_x[i] = p_xform.elements[2].x;
+		origin_y[i] = p_xform.elements[2].y;
+	}
+};
+
+struct _SATBatch2D {
+
+	_SATBatchSide2D A;
+	_SATBatchSide2D B;
+
+	// axis that separated the pair last time, tested first like test_previous_axis()
+	real_t prev_x[SAT_BATCH_CHUNK];
+	real_t prev_y[SAT_BATCH_CHUNK];
+	uint8_t prev_valid[SAT_BATCH_CHUNK];
+
+	real_t best_x[SAT_BATCH_CHUNK];
+	real_t best_y[SAT_BATCH_CHUNK];
+	uint8_t separated[SAT_BATCH_CHUNK];
+	real_t sep_x[SAT_BATCH_CHUNK];
+	real_t sep_y[SAT_BATCH_CHUNK];
+};
+
+struct _SATBatchLane2D {
+
+	real_t best_depth;
+	real_t best_x, best_y;
+	real_t sep_x, sep_y;
+	bool separated;
+
+	_FORCE_INLINE_ _SATBatchLane2D() {
+
+		best_depth = 1e15;
+		best_x = 0;
+		best_y = 0;
+		sep_x = 0;
+		sep_y = 0;
+		separated = false;
+	}
+
+	_FORCE_INLINE_ void store(_SATBatch2D &r_batch, int i) const {
+
+		r_batch.best_x[i] = best_x;
+		r_batch.best_y[i] = best_y;
+		r_batch.separated[i] = separated;
+		r_batch.sep_x[i] = sep_x;
+		r_batch.sep_y[i] = sep_y;
+	}
+};
+
+struct _SATBatchCircle2D {
+
+	static _FORCE_INLINE_ void load(_SATBatchSide2D &r_side, int i, const Shape2DSW *p_shape) {
+
+		r_side.extent_x[i] = static_cast<const CircleShape2DSW *>(p_shape)->get_radius();
+		r_side.extent_y[i] = 0;
+	}
+
+	static _FORCE_INLINE_ void project(const _SATBatchSide2D &p_side, int i, real_t nx, real_t ny, real_t &r_min, real_t &r_max) {
+
+		real_t d = nx * p_side.origin_x[i] + ny * p_side.origin_y[i];
+		real_t lx = p_side.axis0_x[i] * nx + p_side.axis0_y[i] * ny;
+		real_t ly = p_side.axis1_x[i] * nx + p_side.axis1_y[i] * ny;
+		real_t r = p_side.extent_x[i] * Math::sqrt(lx * lx + ly * ly);
+		r_min = d - r;
+		r_max = d + r;
+	}
+};
+
+struct _SATBatchRectangle2D {
+
+	static _FORCE_INLINE_ void load(_SATBatchSide2D &r_side, int i, const Shape2DSW *p_shape) {
+
+		const Vector2 &he = static_cast<const RectangleShape2DSW *>(p_shape)->get_half_extents();
+		r_side.extent_x[i] = he.x;
+		r_side.extent_y[i] = he.y;
+	}
+
+	// projects the corners in the same order and with the same operations as RectangleShape2DSW::project_range(),
+	// so deep pairs with two equally good axes pick the same one on both paths
+	static _FORCE_INLINE_ void project(const _SATBatchSide2D &p_side, int i, real_t nx, real_t ny, real_t &r_min, real_t &r_max) {
+
+		real_t a0x = p_side.axis0_x[i], a0y = p_side.axis0_y[i];
+		real_t a1x = p_side.axis1_x[i], a1y = p_side.axis1_y[i];
+		real_t hx = p_side.extent_x[i], hy = p_side.extent_y[i];
+
+		r_max = -1e20;
+		r_min = 1e20;
+		for (int c = 0; c < 4; c++) {
+
+			real_t vx = (c & 1) ? hx : -hx;
+			real_t vy = (c >> 1) ? hy : -hy;
+			real_t d = nx * ((a0x * vx + a1x * vy) + p_side.origin_x[i]) + ny * ((a0y * vx + a1y * vy) + p_side.origin_y[i]);
+			r_max = d > r_max ? d : r_max;
+			r_min = d < r_min ? d : r_min;
+		}
+	}
+
+	// same as RectangleShape2DSW::get_circle_axis(), from the closest corner towards a point
+	static _FORCE_INLINE_ void circle_axis(const _SATBatchSide2D &p_side, int i, real_t px, real_t py, real_t &r_x, real_t &r_y) {
+
+		real_t a0x = p_side.axis0_x[i], a0y = p_side.axis0_y[i];
+		real_t a1x = p_side.axis1_x[i], a1y = p_side.axis1_y[i];
+		real_t dx = px - p_side.origin_x[i];
+		real_t dy = py - p_side.origin_y[i];
+
+		// only the signs of the local coordinates matter, so scale by the determinant instead of dividing
+		real_t det = a0x * a1y - a0y * a1x;
+		real_t lx = (a1y * dx - a1x * dy) * det;
+		real_t ly = (a0x * dy - a0y * dx) * det;
+
+		real_t hx = lx < 0 ? -p_side.extent_x[i] : p_side.extent_x[i];
+		real_t hy = ly < 0 ? -p_side.extent_y[i] : p_side.extent_y[i];
+
+		r_x = ((a0x * hx + a1x * hy) + p_side.origin_x[i]) - px;
+		r_y = ((a0y * hx + a1y * hy) + p_side.origin_y[i]) - py;
+	}
+};
+
+struct _SATBatchCapsule2D {
+
+	static _FORCE_INLINE_ void load(_SATBatchSide2D &r_side, int i, const Shape2DSW *p_shape) {
+
+		const CapsuleShape2DSW *capsule = static_cast<const CapsuleShape2DSW *>(p_shape);
+		r_side.extent_x[i] = capsule->get_radius();
+		r_side.extent_y[i] = capsule->get_height();
+	}
+
+	static _FORCE_INLINE_ void project(const _SATBatchSide2D &p_side, int i, real_t nx, real_t ny, real_t &r_min, real_t &r_max) {
+
+		real_t a0x = p_side.axis0_x[i], a0y = p_side.axis0_y[i];
+		real_t a1x = p_side.axis1_x[i], a1y = p_side.axis1_y[i];
+
+		real_t lx = a0x * nx + a0y * ny;
+		real_t ly = a1x * nx + a1y * ny;
+		real_t l = Math::sqrt(lx * lx + ly * ly);
+		l += real_t(l == 0);
+		lx /= l;
+		ly /= l;
+
+		real_t h = ly > 0 ? p_side.extent_y[i] : -p_side.extent_y[i];
+		lx *= p_side.extent_x[i];
+		ly = ly * p_side.extent_x[i] + h * 0.5;
+
+		// both ends computed like CapsuleShape2DSW::project_range()
+		real_t px = a0x * lx + a1x * ly;
+		real_t py = a0y * lx + a1y * ly;
+		real_t d_pos = nx * (px + p_side.origin_x[i]) + ny * (py + p_side.origin_y[i]);
+		real_t d_neg = nx * (-px + p_side.origin_x[i]) + ny * (-py + p_side.origin_y[i]);
+		r_min = d_pos < d_neg ? d_pos : d_neg;
+		r_max = d_pos < d_neg ? d_neg : d_pos;
+	}
+};
+
+static _FORCE_INLINE_ void _sat_batch_normalize(real_t &r_x, real_t &r_y) {
+
+	real_t l = Math::sqrt(r_x * r_x + r_y * r_y);
+	l += real_t(l == 0); // zero axes stay zero, like Vector2::normalize()
+	r_x /= l;
+	r_y /= l;
+}
+
+// mirrors SeparatorAxisTest2D::test_axis(), without the early out
+template <class ShapeA, class ShapeB>
+static _FORCE_INLINE_ void _sat_batch_test_axis(_SATBatchLane2D &r_lane, const _SATBatch2D &p_batch, int i, real_t nx, real_t ny, bool p_valid = true) {
+
+	// strange case, try an upwards separator
+	bool degenerate = (Math::abs(nx) < CMP_EPSILON) & (Math::abs(ny) < CMP_EPSILON);
+	nx = degenerate ? 0 : nx;
+	ny = degenerate ? 1 : ny;
+
+	real_t min_A, max_A, min_B, max_B;
+	ShapeA::project(p_batch.A, i, nx, ny, min_A, max_A);
+	ShapeB::project(p_batch.B, i, nx, ny, min_B, max_B);
+
+	real_t half_A = (max_A - min_A) * 0.5;
+	real_t center_A = (min_A + max_A) * 0.5;
+	real_t dmin = (min_B - half_A) - center_A;
+	real_t dmax = (max_B + half_A) - center_A;
+
+	// no short circuits, they would put branches in the loop
+	bool separates = p_valid & ((dmin > 0.0) | (dmax < 0.0));
+	bool first = separates & !r_lane.separated;
+	r_lane.sep_x = first ? nx : r_lane.sep_x;
+	r_lane.sep_y = first ? ny : r_lane.sep_y;
+	r_lane.separated |= separates;
+
+	// use the smallest depth, keeping the axis pointing out of A
+	dmin = Math::abs(dmin);
+	bool use_max = dmax < dmin;
+	real_t depth = use_max ? dmax : dmin;
+	real_t sign = use_max ? 1.0 : -1.0;
+	bool better = p_valid & !separates & (depth < r_lane.best_depth);
+	r_lane.best_depth = better ? depth : r_lane.best_depth;
+	r_lane.best_x = better ? nx * sign : r_lane.best_x;
+	r_lane.best_y = better ? ny * sign : r_lane.best_y;
+}
+
+template <class ShapeA, class ShapeB>
+static _FORCE_INLINE_ void _sat_batch_test_basis(_SATBatchLane2D &r_lane, const _SATBatch2D &p_batch, const _SATBatchSide2D &p_side, int i) {
+
+	real_t x = p_side.axis0_x[i];
+	real_t y = p_side.axis0_y[i];
+	_sat_batch_normalize(x, y);
+	_sat_batch_test_axis<ShapeA, ShapeB>(r_lane, p_batch, i, x, y);
+
+	x = p_side.axis1_x[i];
+	y = p_side.axis1_y[i];
+	_sat_batch_normalize(x, y);
+	_sat_batch_test_axis<ShapeA, ShapeB>(r_lane, p_batch, i, x, y);
+}
+
+template <class ShapeA, class ShapeB>
+static void _sat_batch_load(_SATBatch2D &r_batch, const CollisionSolver2DSW::BatchPair *p_pairs, int p_count) {
+
+	for (int i = 0; i < p_count; i++) {
+
+		const CollisionSolver2DSW::BatchPair &pair = p_pairs[i];
+		r_batch.A.load(i, pair.transform_A);
+		r_batch.B.load(i, pair.transform_B);
+		ShapeA::load(r_batch.A, i, pair.shape_A);
+		ShapeB::load(r_batch.B, i, pair.shape_B);
+
+		Vector2 prev = pair.sep_axis ? *pair.sep_axis : Vector2();
+		r_batch.prev_x[i] = prev.x;
+		r_batch.prev_y[i] = prev.y;
+		r_batch.prev_valid[i] = prev != Vector2();
+	}
+}
+
+static void _sat_batch_circle_circle(_SATBatch2D &r_batch, int p_count) {
+
+	for (int i = 0; i < p_count; i++) {
+
+		_SATBatchLane2D lane;
+		_sat_batch_test_axis<_SATBatchCircle2D, _SATBatchCircle2D>(lane, r_batch, i, r_batch.prev_x[i], r_batch.prev_y[i], r_batch.prev_valid[i] != 0);
+
+		real_t x = r_batch.A.origin_x[i] - r_batch.B.origin_x[i];
+		real_t y = r_batch.A.origin_y[i] - r_batch.B.origin_y[i];
+		_sat_batch_normalize(x, y);
+		_sat_batch_test_axis<_SATBatchCircle2D, _SATBatchCircle2D>(lane, r_batch, i, x, y);
+
+		lane.store(r_batch, i);
+	}
+}
+
+static void _sat_batch_circle_rectangle(_SATBatch2D &r_batch, int p_count) {
+
+	for (int i = 0; i < p_count; i++) {
+
+		_SATBatchLane2D lane;
+		_sat_batch_test_axis<_SATBatchCircle2D, _SATBatchRectangle2D>(lane, r_batch, i, r_batch.prev_x[i], r_batch.prev_y[i], r_batch.prev_valid[i] != 0);
+		_sat_batch_test_basis<_SATBatchCircle2D, _SATBatchRectangle2D>(lane, r_batch, r_batch.B, i);
+
+		real_t x, y;
+		_SATBatchRectangle2D::circle_axis(r_batch.B, i, r_batch.A.origin_x[i], r_batch.A.origin_y[i], x, y);
+		_sat_batch_normalize(x, y);
+		_sat_batch_test_axis<_SATBatchCircle2D, _SATBatchRectangle2D>(lane, r_batch, i, x, y);
+
+		lane.store(r_batch, i);
+	}
+}
+
+static void _sat_batch_rectangle_rectangle(_SATBatch2D &r_batch, int p_count) {
+
+	for (int i = 0; i < p_count; i++) {
+
+		_SATBatchLane2D lane;
+		_sat_batch_test_axis<_SATBatchRectangle2D, _SATBatchRectangle2D>(lane, r_batch, i, r_batch.prev_x[i], r_batch.prev_y[i], r_batch.prev_valid[i] != 0);
+		_sat_batch_test_basis<_SATBatchRectangle2D, _SATBatchRectangle2D>(lane, r_batch, r_batch.A, i);
+		_sat_batch_test_basis<_SATBatchRectangle2D, _SATBatchRectangle2D>(lane, r_batch, r_batch.B, i);
+
+		lane.store(r_batch, i);
+	}
+}
+
+static void _sat_batch_rectangle_capsule(_SATBatch2D &r_batch, int p_count) {
+
+	for (int i = 0; i < p_count; i++) {
+
+		_SATBatchLane2D lane;
+		_sat_batch_test_axis<_SATBatchRectangle2D, _SATBatchCapsule2D>(lane, r_batch, i, r_batch.prev_x[i], r_batch.prev_y[i], r_batch.prev_valid[i] != 0);
+		_sat_batch_test_basis<_SATBatchRectangle2D, _SATBatchCapsule2D>(lane, r_batch, r_batch.A, i);
+
+		//capsule axis
+		real_t x = r_batch.B.axis0_x[i];
+		real_t y = r_batch.B.axis0_y[i];
+		_sat_batch_normalize(x, y);
+		_sat_batch_test_axis<_SATBatchRectangle2D, _SATBatchCapsule2D>(lane, r_batch, i, x, y);
+
+		//box corners towards both capsule circles
+		real_t h = r_batch.B.extent_y[i] * 0.5;
+		real_t ex = r_batch.B.axis1_x[i] * h;
+		real_t ey = r_batch.B.axis1_y[i] * h;
+
+		_SATBatchRectangle2D::circle_axis(r_batch.A, i, r_batch.B.origin_x[i] + ex, r_batch.B.origin_y[i] + ey, x, y);
+		_sat_batch_normalize(x, y);
+		_sat_batch_test_axis<_SATBatchRectangle2D, _SATBatchCapsule2D>(lane, r_batch, i, x, y);
+
+		_SATBatchRectangle2D::circle_axis(r_batch.A, i, r_batch.B.origin_x[i] - ex, r_batch.B.origin_y[i] - ey, x, y);
+		_sat_batch_normalize(x, y);
+		_sat_batch_test_axis<_SATBatchRectangle2D, _SATBatchCapsule2D>(lane, r_batch, i, x, y);
+
+		lane.store(r_batch, i);
+	}
+}
+
+template <class ShapeA, class ShapeB>
+static void _sat_batch_finish(const _SATBatch2D &p_batch, CollisionSolver2DSW::BatchPair *p_pairs, int p_count) {
+
+	for (int i = 0; i < p_count; i++) {
+
+		CollisionSolver2DSW::BatchPair &pair = p_pairs[i];
+
+		if (p_batch.separated[i]) {
+			if (pair.sep_axis)
+				*pair.sep_axis = Vector2(p_batch.sep_x[i], p_batch.sep_y[i]);
+			*pair.r_collided = false;
+			continue;
+		}
+
+		_CollectorCallback2D callback;
+		callback.callback = pair.result_callback;
+		callback.swap = pair.swap;
+		callback.userdata = pair.userdata;
+		callback.collided = false;
+		callback.sep_axis = pair.sep_axis;
+
+		// contacts come from the same code as the scalar path
+		SeparatorAxisTest2D<ShapeA, ShapeB> separator(static_cast<const ShapeA *>(pair.shape_A), pair.transform_A, static_cast<const ShapeB *>(pair.shape_B), pair.transform_B, &callback);
+		separator.set_best_axis(Vector2(p_batch.best_x[i], p_batch.best_y[i]));
+		separator.generate_contacts();
+
+		*pair.r_collided = callback.collided;
+	}
+}
+
+void sat_2d_calculate_penetration_batch(CollisionSolver2DSW::BatchType p_type, CollisionSolver2DSW::BatchPair *p_pairs, int p_count) {
+
+	_SATBatch2D batch;
+
+	for (int from = 0; from < p_count; from += SAT_BATCH_CHUNK) {
+
+		CollisionSolver2DSW::BatchPair *pairs = &p_pairs[from];
+		int count = MIN(p_count - from, SAT_BATCH_CHUNK);
+
+		switch (p_type) {
+			case CollisionSolver2DSW::BATCH_CIRCLE_CIRCLE: {
+				_sat_batch_load<_SATBatchCircle2D, _SATBatchCircle2D>(batch, pairs, count);
+				_sat_batch_circle_circle(batch, count);
+				_sat_batch_finish<CircleShape2DSW, CircleShape2DSW>(batch, pairs, count);
+			} break;
+			case CollisionSolver2DSW::BATCH_CIRCLE_RECTANGLE: {
+				_sat_batch_load<_SATBatchCircle2D, _SATBatchRectangle2D>(batch, pairs, count);
+				_sat_batch_circle_rectangle(batch, count);
+				_sat_batch_finish<CircleShape2DSW, RectangleShape2DSW>(batch, pairs, count);
+			} break;
+			case CollisionSolver2DSW::BATCH_RECTANGLE_RECTANGLE: {
+				_sat_batch_load<_SATBatchRectangle2D, _SATBatchRectangle2D>(batch, pairs, count);
+				_sat_batch_rectangle_rectangle(batch, count);
+				_sat_batch_finish<RectangleShape2DSW, RectangleShape2DSW>(batch, pairs, count);
+			} break;
+			case CollisionSolver2DSW::BATCH_RECTANGLE_CAPSULE: {
+				_sat_batch_load<_SATBatchRectangle2D, _SATBatchCapsule2D>(batch, pairs, count);
+				_sat_batch_rectangle_capsule(batch, count);
+				_sat_batch_finish<RectangleShape2DSW, CapsuleShape2DSW>(batch, pairs, count);
+			} break;
+			default: {
+				ERR_FAIL();
+			}
+		}
+	}
+}
@@ -34,5 +34,6 @@
 #include "collision_solver_2d_sw.h"
 
 bool sat_2d_calculate_penetration(const Shape2DSW *p_shape_A, const Transform2D &p_transform_A, const Vector2 &p_motion_A, const Shape2DSW *p_shape_B, const Transform2D &p_transform_B, const Vector2 &p_motion_B, CollisionSolver2DSW::CallbackResult p_result_callback, void *p_userdata, bool p_swap = false, Vector2 *sep_axis = NULL, real_t p_margin_A = 0, real_t p_margin_B = 0);
+void sat_2d_calculate_penetration_batch(CollisionSolver2DSW::BatchType p_type, CollisionSolver2DSW::BatchPair *p_pairs, int p_count);
 
 #endif // COLLISION_SOLVER_2D_SAT_H
@@ -288,3 +288,59 @@ bool CollisionSolver2DSW::solve(const Shape2DSW *p_shape_A, const Transform2D &p
 
 	return false;
 }
+
+CollisionSolver2DSW::BatchType CollisionSolver2DSW::make_batch_pair(BatchPair &r_pair, const Shape2DSW *p_shape_A, const Transform2D &p_transform_A, const Shape2DSW *p_shape_B, const Transform2D &p_transform_B, CallbackResult p_result_callback, void *p_userdata, Vector2 *sep_axis, bool *r_collided) {
+
+	Physics2DServer::ShapeType type_A = p_shape_A->get_type();
+	Physics2DServer::ShapeType type_B = p_shape_B->get_type();
+	bool swap = false;
+
+	if (type_A > type_B) {
+		SWAP(type_A, type_B);
+		swap = true;
+	}
+
+	BatchType type = BATCH_NONE;
+
+	if (type_A == Physics2DServer::SHAPE_CIRCLE) {
+		if (type_B == Physics2DServer::SHAPE_CIRCLE)
+			type = BATCH_CIRCLE_CIRCLE;
+		else if (type_B == Physics2DServer::SHAPE_RECTANGLE)
+			type = BATCH_CIRCLE_RECTANGLE;
+	} else if (type_A == Physics2DServer::SHAPE_RECTANGLE) {
+		if (type_B == Physics2DServer::SHAPE_RECTANGLE)
+			type = BATCH_RECTANGLE_RECTANGLE;
+		else if (type_B == Physics2DServer::SHAPE_CAPSULE)
+			type = BATCH_RECTANGLE_CAPSULE;
+	}
+
+	if (type == BATCH_NONE)
+		return BATCH_NONE;
+
+	if (swap) {
+		r_pair.shape_A = p_shape_B;
+		r_pair.transform_A = p_transform_B;
+		r_pair.shape_B = p_shape_A;
+		r_pair.transform_B = p_transform_A;
+	} else {
+		r_pair.shape_A = p_shape_A;
+		r_pair.transform_A = p_transform_A;
+		r_pair.shape_B = p_shape_B;
+		r_pair.transform_B = p_transform_B;
+	}
+
+	r_pair.swap = swap;
+	r_pair.sep_axis = sep_axis;
+	r_pair.result_callback = p_result_callback;
+	r_pair.userdata = p_userdata;
+	r_pair.r_collided = r_collided;
+
+	return type;
+}
+
+void CollisionSolver2DSW::solve_batch(BatchType p_type, BatchPair *p_pairs, int p_count) {
+
+	ERR_FAIL_INDEX(p_type, BATCH_MAX);
+
+	sat_2d_calculate_penetration_batch(p_type, p_pairs, p_count);
+}
@@ -37,6 +37,30 @@ class CollisionSolver2DSW {
 public:
 	typedef void (*CallbackResult)(const Vector2 &p_point_A, const Vector2 &p_point_B, void *p_userdata);
 
+	// shape type combinations that solve_batch() can test many pairs of at once
+	enum BatchType {
+		BATCH_NONE = -1,
+		BATCH_CIRCLE_CIRCLE,
+		BATCH_CIRCLE_RECTANGLE,
+		BATCH_RECTANGLE_RECTANGLE,
+		BATCH_RECTANGLE_CAPSULE,
+		BATCH_MAX
+	};
+
+	// a pair of resting shapes (no motion, no margin), shape_A always has the lower shape type
+	struct BatchPair {
+
+		const Shape2DSW *shape_A;
+		const Shape2DSW *shape_B;
+		Transform2D transform_A;
+		Transform2D transform_B;
+		bool swap;
+		Vector2 *sep_axis;
+		CallbackResult result_callback;
+		void *userdata;
+		bool *r_collided;
+	};
+
 private:
 	static bool solve_static_line(const Shape2DSW *p_shape_A, const Transform2D &p_transform_A, const Shape2DSW *p_shape_B, const Transform2D &p_transform_B, CallbackResult p_result_callback, void *p_userdata, bool p_swap_result);
 	static void concave_callback(void *p_userdata, Shape2DSW *p_convex);
@@ -45,6 +69,10 @@ private:
 
 public:
 	static bool solve(const Shape2DSW *p_shape_A, const Transform2D &p_transform_A, const Vector2 &p_motion_A, const Shape2DSW *p_shape_B, const Transform2D &p_transform_B, const Vector2 &p_motion_B, CallbackResult p_result_callback, void *p_userdata, Vector2 *sep_axis = NULL, real_t p_margin_A = 0, real_t p_margin_B = 0);
+
+	static BatchType make_batch_pair(BatchPair &r_pair, const Shape2DSW *p_shape_A, const Transform2D &p_transform_A, const Shape2DSW *p_shape_B, const Transform2D &p_transform_B, CallbackResult p_result_callback, void *p_userdata, Vector2 *sep_axis, bool *r_collided);
+	/// Same results as calling solve() on each pair without motion or margin, all pairs must be of p_type.
+	static void solve_batch(BatchType p_type, BatchPair *p_pairs, int p_count);
 };
 
 #endif // COLLISION_SOLVER_2D_SW_H
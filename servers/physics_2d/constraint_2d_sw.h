@@ -32,6 +32,32 @@
 #define CONSTRAINT_2D_SW_H
 
 #include "body_2d_sw.h"
+#include "collision_solver_2d_sw.h"
+
+// identifies a broadphase pair constraint inside a space state snapshot
+struct PairStateKey2DSW {
+
+	uint32_t id_A;
+	uint32_t shape_A;
+	uint32_t id_B;
+	uint32_t shape_B;
+
+	_FORCE_INLINE_ bool operator<(const PairStateKey2DSW &p_key) const {
+
+		if (id_A != p_key.id_A)
+			return id_A < p_key.id_A;
+		if (shape_A != p_key.shape_A)
+			return shape_A < p_key.shape_A;
+		if (id_B != p_key.id_B)
+			return id_B < p_key.id_B;
+		return shape_B < p_key.shape_B;
+	}
+
+	_FORCE_INLINE_ bool operator==(const PairStateKey2DSW &p_key) const {
+
+		return id_A == p_key.id_A && shape_A == p_key.shape_A && id_B == p_key.id_B && shape_B == p_key.shape_B;
+	}
+};
 
 class Constraint2DSW : public RID_Data {
 
@@ -66,6 +92,12 @@ public:
 	_FORCE_INLINE_ Body2DSW **get_body_ptr() const { return _body_ptr; }
 	_FORCE_INLINE_ int get_body_count() const { return _body_count; }
 
+	// lets Step2DSW run the narrow phase of many constraints at once before setup(), returns BATCH_NONE to test in setup() instead
+	virtual CollisionSolver2DSW::BatchType setup_batch(CollisionSolver2DSW::BatchPair &r_pair) { return CollisionSolver2DSW::BATCH_NONE; }
+	// area pairs only test for overlap, Step2DSW runs the tests in parallel outside the islands and applies the results in order
+	virtual bool is_area_pair() const { return false; }
+	virtual void test_overlap() {}
+	virtual void apply_overlap() {}
 	virtual bool setup(real_t p_step) = 0;
 	virtual void solve(real_t p_step) = 0;
 
@@ -96,6 +96,10 @@ bool PinJoint2DSW::setup(real_t p_step) {
 	rA = A->get_transform().basis_xform(anchor_A);
 	rB = B ? B->get_transform().basis_xform(anchor_B) : anchor_B;
 
+	// static and kinematic bodies can be shared by islands solved on other threads, so they are never written
+	dynamic_A = A->get_mode() > Physics2DServer::BODY_MODE_KINEMATIC;
+	dynamic_B = B && B->get_mode() > Physics2DServer::BODY_MODE_KINEMATIC;
+
 	real_t B_inv_mass = B ? B->get_inv_mass() : 0.0;
 
 	Transform2D K1;
@@ -139,8 +143,9 @@ bool PinJoint2DSW::setup(real_t p_step) {
 	bias = delta * -(get_bias() == 0 ? space->get_constraint_bias() : get_bias()) * (1.0 / p_step);
 
 	// apply accumulated impulse
-	A->apply_impulse(rA, -P);
-	if (B)
+	if (dynamic_A)
+		A->apply_impulse(rA, -P);
+	if (dynamic_B)
 		B->apply_impulse(rB, P);
 
 	return true;
@@ -159,8 +164,9 @@ void PinJoint2DSW::solve(real_t p_step) {
 
 	Vector2 impulse = M.basis_xform(bias - rel_vel - Vector2(softness, softness) * P);
 
-	A->apply_impulse(rA, -impulse);
-	if (B)
+	if (dynamic_A)
+		A->apply_impulse(rA, -impulse);
+	if (dynamic_B)
 		B->apply_impulse(rB, impulse);
 
 	P += impulse;
@@ -188,6 +194,8 @@ PinJoint2DSW::PinJoint2DSW(const Vector2 &p_pos, Body2DSW *p_body_a, Body2DSW *p
 	anchor_B = p_body_b ? p_body_b->get_inv_transform().xform(p_pos) : p_pos;
 
 	softness = 0;
+	dynamic_A = false;
+	dynamic_B = false;
 
 	p_body_a->add_constraint(this, 0);
 	if (p_body_b)
@@ -267,6 +275,9 @@ bool GrooveJoint2DSW::setup(real_t p_step) {
 	xf_normal = n;
 	rB = B->get_transform().basis_xform(B_anchor);
 
+	dynamic_A = A->get_mode() > Physics2DServer::BODY_MODE_KINEMATIC;
+	dynamic_B = B->get_mode() > Physics2DServer::BODY_MODE_KINEMATIC;
+
 	// calculate tangential distance along the axis of rB
 	real_t td = (B->get_transform().get_origin() + rB).cross(n);
 	// calculate clamping factor and rB
@@ -300,8 +311,10 @@ bool GrooveJoint2DSW::setup(real_t p_step) {
 	gbias = (delta * -(_b == 0 ? space->get_constraint_bias() : _b) * (1.0 / p_step)).clamped(get_max_bias());
 
 	// apply accumulated impulse
-	A->apply_impulse(rA, -jn_acc);
-	B->apply_impulse(rB, jn_acc);
+	if (dynamic_A)
+		A->apply_impulse(rA, -jn_acc);
+	if (dynamic_B)
+		B->apply_impulse(rB, jn_acc);
 
 	correct = true;
 	return true;
@@ -320,8 +333,10 @@ void GrooveJoint2DSW::solve(real_t p_step) {
 
 	j = jn_acc - jOld;
 
-	A->apply_impulse(rA, -j);
-	B->apply_impulse(rB, j);
+	if (dynamic_A)
+		A->apply_impulse(rA, -j);
+	if (dynamic_B)
+		B->apply_impulse(rB, j);
 }
 
 GrooveJoint2DSW::GrooveJoint2DSW(const Vector2 &p_a_groove1, const Vector2 &p_a_groove2, const Vector2 &p_b_anchor, Body2DSW *p_body_a, Body2DSW *p_body_b) :
@@ -334,6 +349,8 @@ GrooveJoint2DSW::GrooveJoint2DSW(const Vector2 &p_a_groove1, const Vector2 &p_a_
 	A_groove_2 = A->get_inv_transform().xform(p_a_groove2);
 	B_anchor = B->get_inv_transform().xform(p_b_anchor);
 	A_groove_normal = -(A_groove_2 - A_groove_1).normalized().tangent();
+	dynamic_A = false;
+	dynamic_B = false;
 
 	A->add_constraint(this, 0);
 	B->add_constraint(this, 1);
@@ -354,6 +371,9 @@ bool DampedSpringJoint2DSW::setup(real_t p_step) {
 	rA = A->get_transform().basis_xform(anchor_A);
 	rB = B->get_transform().basis_xform(anchor_B);
 
+	dynamic_A = A->get_mode() > Physics2DServer::BODY_MODE_KINEMATIC;
+	dynamic_B = B->get_mode() > Physics2DServer::BODY_MODE_KINEMATIC;
+
 	Vector2 delta = (B->get_transform().get_origin() + rB) - (A->get_transform().get_origin() + rA);
 	real_t dist = delta.length();
 
@@ -372,8 +392,10 @@ bool DampedSpringJoint2DSW::setup(real_t p_step) {
 	real_t f_spring = (rest_length - dist) * stiffness;
 	Vector2 j = n * f_spring * (p_step);
 
-	A->apply_impulse(rA, -j);
-	B->apply_impulse(rB, j);
+	if (dynamic_A)
+		A->apply_impulse(rA, -j);
+	if (dynamic_B)
+		B->apply_impulse(rB, j);
 
 	return true;
 }
@@ -389,8 +411,10 @@ void DampedSpringJoint2DSW::solve(real_t p_step) {
 	target_vrn = vrn + v_damp;
 	Vector2 j = n * v_damp * n_mass;
 
-	A->apply_impulse(rA, -j);
-	B->apply_impulse(rB, j);
+	if (dynamic_A)
+		A->apply_impulse(rA, -j);
+	if (dynamic_B)
+		B->apply_impulse(rB, j);
 }
 
 void DampedSpringJoint2DSW::set_param(Physics2DServer::DampedStringParam p_param, real_t p_value) {
@@ -444,6 +468,8 @@ DampedSpringJoint2DSW::DampedSpringJoint2DSW(const Vector2 &p_anchor_a, const Ve
 	rest_length = p_anchor_a.distance_to(p_anchor_b);
 	stiffness = 20;
 	damping = 1.5;
+	dynamic_A = false;
+	dynamic_B = false;
 
 	A->add_constraint(this, 0);
 	B->add_constraint(this, 1);
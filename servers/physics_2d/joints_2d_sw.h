@@ -76,6 +76,8 @@ class PinJoint2DSW : public Joint2DSW {
 	Vector2 bias;
 	Vector2 P;
 	real_t softness;
+	bool dynamic_A;
+	bool dynamic_B;
 
 public:
 	virtual Physics2DServer::JointType get_type() const { return Physics2DServer::JOINT_PIN; }
@@ -114,6 +116,8 @@ class GrooveJoint2DSW : public Joint2DSW {
 	Vector2 k1, k2;
 
 	bool correct;
+	bool dynamic_A;
+	bool dynamic_B;
 
 public:
 	virtual Physics2DServer::JointType get_type() const { return Physics2DServer::JOINT_GROOVE; }
@@ -148,6 +152,8 @@ class DampedSpringJoint2DSW : public Joint2DSW {
 	real_t n_mass;
 	real_t target_vrn;
 	real_t v_coef;
+	bool dynamic_A;
+	bool dynamic_B;
 
 public:
 	virtual Physics2DServer::JointType get_type() const { return Physics2DServer::JOINT_DAMPED_SPRING; }
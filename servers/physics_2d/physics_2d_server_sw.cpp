@@ -300,6 +300,24 @@ int Physics2DServerSW::space_get_contact_count(RID p_space) const {
 	return space->get_debug_contact_count();
 }
 
+PoolVector<uint8_t> Physics2DServerSW::space_save_state(RID p_space) const {
+
+	const Space2DSW *space = space_owner.get(p_space);
+	ERR_FAIL_COND_V(!space, PoolVector<uint8_t>());
+
+	PoolVector<uint8_t> state;
+	space->save_state(state);
+	return state;
+}
+
+Error Physics2DServerSW::space_restore_state(RID p_space, const PoolVector<uint8_t> &p_state) {
+
+	Space2DSW *space = space_owner.get(p_space);
+	ERR_FAIL_COND_V(!space, ERR_INVALID_PARAMETER);
+
+	return space->restore_state(p_state);
+}
+
 Physics2DDirectSpaceState *Physics2DServerSW::space_get_direct_state(RID p_space) {
 
 	Space2DSW *space = space_owner.get(p_space);
@@ -553,6 +571,14 @@ void Physics2DServerSW::area_set_area_monitor_callback(RID p_area, Object *p_rec
 	area->set_area_monitor_callback(p_receiver ? p_receiver->get_instance_id() : 0, p_method);
 }
 
+void Physics2DServerSW::area_set_monitor_batching(RID p_area, bool p_enable) {
+
+	Area2DSW *area = area_owner.get(p_area);
+	ERR_FAIL_COND(!area);
+
+	area->set_monitor_batching(p_enable);
+}
+
 /* BODY API */
 
 RID Physics2DServerSW::body_create() {
@@ -972,6 +998,58 @@ bool Physics2DServerSW::body_test_motion(RID p_body, const Transform2D &p_from,
 	return body->get_space()->test_body_motion(body, p_from, p_motion, p_margin, r_result);
 }
 
+void Physics2DServerSW::_body_move_and_slide(uint32_t p_index, void *p_userdata) {
+
+	Body2DSW *body = slide_bodies[p_index];
+	const MoveAndSlideParameters &params = slide_params[p_index];
+	MoveAndSlideResult &result = slide_results[p_index];
+
+	if (!body) {
+		// invalid body, it just stays where it is
+		result.transform = params.from;
+		result.motion = params.motion;
+		result.linear_velocity = params.linear_velocity;
+		result.floor_velocity = Vector2();
+		result.on_floor = false;
+		result.on_wall = false;
+		result.on_ceiling = false;
+		result.stopped_on_slope = false;
+		result.collision_count = 0;
+		return;
+	}
+
+	body->get_space()->body_move_and_slide(body, params, result, slide_candidates[p_index]);
+}
+
+void Physics2DServerSW::body_move_and_slide(const MoveAndSlideParameters *p_params, MoveAndSlideResult *r_results, int p_count) {
+
+	ERR_FAIL_COND(p_count < 0);
+
+	if (slide_bodies.size() < p_count) {
+		slide_bodies.resize(p_count);
+		slide_candidates.resize(p_count);
+	}
+
+	for (int i = 0; i < p_count; i++) {
+
+		Body2DSW *body = body_owner.get(p_params[i].body);
+		if (!body || !body->get_space() || body->get_space()->is_locked()) {
+			ERR_PRINT("Invalid body, or its space is missing or being stepped.");
+			body = NULL;
+		}
+		slide_bodies[i] = body;
+	}
+
+	slide_params = p_params;
+	slide_results = r_results;
+
+	// the bodies only read the spaces, so they can be processed in any order
+	work_pool->do_work(p_count, this, &Physics2DServerSW::_body_move_and_slide, (void *)NULL);
+
+	slide_params = NULL;
+	slide_results = NULL;
+}
+
 Physics2DDirectBodyState *Physics2DServerSW::body_get_direct_state(RID p_body) {
 
 	Body2DSW *body = body_owner.get(p_body);
@@ -1197,7 +1275,9 @@ void Physics2DServerSW::init() {
 	doing_sync = false;
 	last_step = 0.001;
 	iterations = 8; // 8?
-	stepper = memnew(Step2DSW);
+	// threads used for stepping and batched work such as body_move_and_slide
+	work_pool = PhysicsWorkPool::acquire();
+	stepper = memnew(Step2DSW(work_pool));
 	direct_state = memnew(Physics2DDirectBodyStateSW);
 };
 
@@ -1213,12 +1293,21 @@ void Physics2DServerSW::step(real_t p_step) {
 	island_count = 0;
 	active_objects = 0;
 	collision_pairs = 0;
+	for (int i = 0; i < Space2DSW::ELAPSED_TIME_MAX; i++)
+		elapsed_time[i] = 0;
+	for (int i = 0; i < Space2DSW::STEP_COUNTER_MAX; i++)
+		step_counter[i] = 0;
 	for (Set<const Space2DSW *>::Element *E = active_spaces.front(); E; E = E->next()) {
 
 		stepper->step((Space2DSW *)E->get(), p_step, iterations);
 		island_count += E->get()->get_island_count();
 		active_objects += E->get()->get_active_objects();
 		collision_pairs += E->get()->get_collision_pairs();
+
+		for (int i = 0; i < Space2DSW::ELAPSED_TIME_MAX; i++)
+			elapsed_time[i] += E->get()->get_elapsed_time(Space2DSW::ElapsedTime(i));
+		for (int i = 0; i < Space2DSW::STEP_COUNTER_MAX; i++)
+			step_counter[i] += E->get()->get_step_counter(Space2DSW::StepCounter(i));
 	}
 };
 
@@ -1234,39 +1323,32 @@ void Physics2DServerSW::flush_queries() {
 
 	uint64_t time_beg = OS::get_singleton()->get_ticks_usec();
 
+	elapsed_time[Space2DSW::ELAPSED_TIME_AREA_QUERIES] = 0;
+
 	for (Set<const Space2DSW *>::Element *E = active_spaces.front(); E; E = E->next()) {
 
 		Space2DSW *space = (Space2DSW *)E->get();
 		space->call_queries();
+		elapsed_time[Space2DSW::ELAPSED_TIME_AREA_QUERIES] += space->get_elapsed_time(Space2DSW::ELAPSED_TIME_AREA_QUERIES);
 	}
 
 	if (ScriptDebugger::get_singleton() && ScriptDebugger::get_singleton()->is_profiling()) {
 
-		uint64_t total_time[Space2DSW::ELAPSED_TIME_MAX];
 		static const char *time_name[Space2DSW::ELAPSED_TIME_MAX] = {
 			"integrate_forces",
 			"generate_islands",
 			"setup_constraints",
 			"solve_constraints",
-			"integrate_velocities"
+			"integrate_velocities",
+			"broad_phase",
+			"area_queries"
 		};
 
-		for (int i = 0; i < Space2DSW::ELAPSED_TIME_MAX; i++) {
-			total_time[i] = 0;
-		}
-
-		for (Set<const Space2DSW *>::Element *E = active_spaces.front(); E; E = E->next()) {
-
-			for (int i = 0; i < Space2DSW::ELAPSED_TIME_MAX; i++) {
-				total_time[i] += E->get()->get_elapsed_time(Space2DSW::ElapsedTime(i));
-			}
-		}
-
 		Array values;
 		values.resize(Space2DSW::ELAPSED_TIME_MAX * 2);
 		for (int i = 0; i < Space2DSW::ELAPSED_TIME_MAX; i++) {
 			values[i * 2 + 0] = time_name[i];
-			values[i * 2 + 1] = USEC_TO_SEC(total_time[i]);
+			values[i * 2 + 1] = USEC_TO_SEC(elapsed_time[i]);
 		}
 		values.push_back("flush_queries");
 		values.push_back(USEC_TO_SEC(OS::get_singleton()->get_ticks_usec() - time_beg));
@@ -1283,6 +1365,8 @@ void Physics2DServerSW::finish() {
 
 	memdelete(stepper);
 	memdelete(direct_state);
+	PhysicsWorkPool::release();
+	work_pool = NULL;
 };
 
 int Physics2DServerSW::get_process_info(ProcessInfo p_info) {
@@ -1300,6 +1384,41 @@ int Physics2DServerSW::get_process_info(ProcessInfo p_info) {
 
 			return island_count;
 		} break;
+		case INFO_STEP_TIME: {
+
+			uint64_t total = 0;
+			for (int i = 0; i < Space2DSW::ELAPSED_TIME_AREA_QUERIES; i++)
+				total += elapsed_time[i];
+			return total;
+		} break;
+		case INFO_BROAD_PHASE_TIME: {
+			return elapsed_time[Space2DSW::ELAPSED_TIME_BROAD_PHASE];
+		} break;
+		case INFO_ISLAND_TIME: {
+			return elapsed_time[Space2DSW::ELAPSED_TIME_GENERATE_ISLANDS];
+		} break;
+		case INFO_NARROW_PHASE_TIME: {
+			// contacts are generated while setting up the constraints
+			return elapsed_time[Space2DSW::ELAPSED_TIME_SETUP_CONSTRAINTS];
+		} break;
+		case INFO_SOLVER_TIME: {
+			return elapsed_time[Space2DSW::ELAPSED_TIME_SOLVE_CONSTRAINTS];
+		} break;
+		case INFO_INTEGRATION_TIME: {
+			return elapsed_time[Space2DSW::ELAPSED_TIME_INTEGRATE_FORCES] + elapsed_time[Space2DSW::ELAPSED_TIME_INTEGRATE_VELOCITIES];
+		} break;
+		case INFO_AREA_QUERY_TIME: {
+			return elapsed_time[Space2DSW::ELAPSED_TIME_AREA_QUERIES];
+		} break;
+		case INFO_PAIRS_TESTED: {
+			return step_counter[Space2DSW::STEP_COUNTER_PAIRS_TESTED];
+		} break;
+		case INFO_CONTACT_COUNT: {
+			return step_counter[Space2DSW::STEP_COUNTER_CONTACTS];
+		} break;
+		case INFO_CCD_SWEEPS: {
+			return step_counter[Space2DSW::STEP_COUNTER_CCD_SWEEPS];
+		} break;
 	}
 
 	return 0;
@@ -1317,7 +1436,14 @@ Physics2DServerSW::Physics2DServerSW() {
 	island_count = 0;
 	active_objects = 0;
 	collision_pairs = 0;
+	for (int i = 0; i < Space2DSW::ELAPSED_TIME_MAX; i++)
+		elapsed_time[i] = 0;
+	for (int i = 0; i < Space2DSW::STEP_COUNTER_MAX; i++)
+		step_counter[i] = 0;
 	using_threads = int(ProjectSettings::get_singleton()->get("physics/2d/thread_model")) == 2;
+	work_pool = NULL;
+	slide_params = NULL;
+	slide_results = NULL;
 };
 
 Physics2DServerSW::~Physics2DServerSW(){
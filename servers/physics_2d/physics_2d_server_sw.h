@@ -33,6 +33,7 @@
 
 #include "joints_2d_sw.h"
 #include "servers/physics_2d_server.h"
+#include "servers/physics_work_pool.h"
 #include "shape_2d_sw.h"
 #include "space_2d_sw.h"
 #include "step_2d_sw.h"
@@ -51,6 +52,8 @@ class Physics2DServerSW : public Physics2DServer {
 	int island_count;
 	int active_objects;
 	int collision_pairs;
+	uint64_t elapsed_time[Space2DSW::ELAPSED_TIME_MAX];
+	int step_counter[Space2DSW::STEP_COUNTER_MAX];
 
 	bool using_threads;
 
@@ -59,6 +62,16 @@ class Physics2DServerSW : public Physics2DServer {
 
 	Physics2DDirectBodyStateSW *direct_state;
 
+	ThreadWorkPool *work_pool; // shared with the other physics servers
+
+	// state of the running body_move_and_slide batch
+	const MoveAndSlideParameters *slide_params;
+	MoveAndSlideResult *slide_results;
+	Vector<Body2DSW *> slide_bodies;
+	Vector<Space2DSW::MotionCandidates> slide_candidates;
+
+	void _body_move_and_slide(uint32_t p_index, void *p_userdata);
+
 	mutable RID_Owner<Shape2DSW> shape_owner;
 	mutable RID_Owner<Space2DSW> space_owner;
 	mutable RID_Owner<Area2DSW> area_owner;
@@ -115,6 +128,9 @@ public:
 	virtual Vector<Vector2> space_get_contacts(RID p_space) const;
 	virtual int space_get_contact_count(RID p_space) const;
 
+	virtual PoolVector<uint8_t> space_save_state(RID p_space) const;
+	virtual Error space_restore_state(RID p_space, const PoolVector<uint8_t> &p_state);
+
 	// this function only works on physics process, errors and returns null otherwise
 	virtual Physics2DDirectSpaceState *space_get_direct_state(RID p_space);
 
@@ -155,6 +171,7 @@ public:
 
 	virtual void area_set_monitor_callback(RID p_area, Object *p_receiver, const StringName &p_method);
 	virtual void area_set_area_monitor_callback(RID p_area, Object *p_receiver, const StringName &p_method);
+	virtual void area_set_monitor_batching(RID p_area, bool p_enable);
 
 	virtual void area_set_pickable(RID p_area, bool p_pickable);
 
@@ -233,6 +250,7 @@ public:
 	virtual void body_set_pickable(RID p_body, bool p_pickable);
 
 	virtual bool body_test_motion(RID p_body, const Transform2D &p_from, const Vector2 &p_motion, real_t p_margin = 0.001, MotionResult *r_result = NULL);
+	virtual void body_move_and_slide(const MoveAndSlideParameters *p_params, MoveAndSlideResult *r_results, int p_count);
 
 	// this function only works on physics process, errors and returns null otherwise
 	virtual Physics2DDirectBodyState *body_get_direct_state(RID p_body);
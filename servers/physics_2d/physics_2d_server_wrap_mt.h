@@ -129,6 +129,9 @@ public:
 		return physics_2d_server->space_get_contact_count(p_space);
 	}
 
+	FUNC1RC(PoolVector<uint8_t>, space_save_state, RID);
+	FUNC2R(Error, space_restore_state, RID, const PoolVector<uint8_t> &);
+
 	/* AREA API */
 
 	//FUNC0RID(area);
@@ -168,6 +171,7 @@ public:
 
 	FUNC3(area_set_monitor_callback, RID, Object *, const StringName &);
 	FUNC3(area_set_area_monitor_callback, RID, Object *, const StringName &);
+	FUNC2(area_set_monitor_batching, RID, bool);
 
 	/* BODY API */
 
@@ -251,6 +255,12 @@ public:
 		return physics_2d_server->body_test_motion(p_body, p_from, p_motion, p_margin, r_result);
 	}
 
+	void body_move_and_slide(const MoveAndSlideParameters *p_params, MoveAndSlideResult *r_results, int p_count) {
+
+		ERR_FAIL_COND(main_thread != Thread::get_caller_id());
+		physics_2d_server->body_move_and_slide(p_params, r_results, p_count);
+	}
+
 	// this function only works on physics process, errors and returns null otherwise
 	Physics2DDirectBodyState *body_get_direct_state(RID p_body) {
 
@@ -32,13 +32,14 @@
 
 #include "collision_solver_2d_sw.h"
 #include "pair.h"
+#include "os/os.h"
 #include "physics_2d_server_sw.h"
 _FORCE_INLINE_ static bool _can_collide_with(CollisionObject2DSW *p_object, uint32_t p_collision_mask) {
 
 	return p_object->get_collision_layer() & p_collision_mask;
 }
 
-int Physics2DDirectSpaceStateSW::intersect_point(const Vector2 &p_point, ShapeResult *r_results, int p_result_max, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_pick_point) {
+int Physics2DDirectSpaceStateSW::intersect_point(const Vector2 &p_point, ShapeResult *r_results, int p_result_max, const PhysicsQueryExclude &p_exclude, uint32_t p_collision_mask, bool p_pick_point) {
 
 	if (p_result_max <= 0)
 		return 0;
@@ -89,7 +90,7 @@ int Physics2DDirectSpaceStateSW::intersect_point(const Vector2 &p_point, ShapeRe
 	return cc;
 }
 
-bool Physics2DDirectSpaceStateSW::intersect_ray(const Vector2 &p_from, const Vector2 &p_to, RayResult &r_result, const Set<RID> &p_exclude, uint32_t p_collision_mask) {
+bool Physics2DDirectSpaceStateSW::intersect_ray(const Vector2 &p_from, const Vector2 &p_to, RayResult &r_result, const PhysicsQueryExclude &p_exclude, uint32_t p_collision_mask) {
 
 	ERR_FAIL_COND_V(space->locked, false);
 
@@ -169,7 +170,7 @@ bool Physics2DDirectSpaceStateSW::intersect_ray(const Vector2 &p_from, const Vec
 	return true;
 }
 
-int Physics2DDirectSpaceStateSW::intersect_shape(const RID &p_shape, const Transform2D &p_xform, const Vector2 &p_motion, real_t p_margin, ShapeResult *r_results, int p_result_max, const Set<RID> &p_exclude, uint32_t p_collision_mask) {
+int Physics2DDirectSpaceStateSW::intersect_shape(const RID &p_shape, const Transform2D &p_xform, const Vector2 &p_motion, real_t p_margin, ShapeResult *r_results, int p_result_max, const PhysicsQueryExclude &p_exclude, uint32_t p_collision_mask) {
 
 	if (p_result_max <= 0)
 		return 0;
@@ -214,7 +215,7 @@ int Physics2DDirectSpaceStateSW::intersect_shape(const RID &p_shape, const Trans
 	return cc;
 }
 
-bool Physics2DDirectSpaceStateSW::cast_motion(const RID &p_shape, const Transform2D &p_xform, const Vector2 &p_motion, real_t p_margin, real_t &p_closest_safe, real_t &p_closest_unsafe, const Set<RID> &p_exclude, uint32_t p_collision_mask) {
+bool Physics2DDirectSpaceStateSW::cast_motion(const RID &p_shape, const Transform2D &p_xform, const Vector2 &p_motion, real_t p_margin, real_t &p_closest_safe, real_t &p_closest_unsafe, const PhysicsQueryExclude &p_exclude, uint32_t p_collision_mask) {
 
 	Shape2DSW *shape = Physics2DServerSW::singletonsw->shape_owner.get(p_shape);
 	ERR_FAIL_COND_V(!shape, false);
@@ -298,7 +299,7 @@ bool Physics2DDirectSpaceStateSW::cast_motion(const RID &p_shape, const Transfor
 	return true;
 }
 
-bool Physics2DDirectSpaceStateSW::collide_shape(RID p_shape, const Transform2D &p_shape_xform, const Vector2 &p_motion, real_t p_margin, Vector2 *r_results, int p_result_max, int &r_result_count, const Set<RID> &p_exclude, uint32_t p_collision_mask) {
+bool Physics2DDirectSpaceStateSW::collide_shape(RID p_shape, const Transform2D &p_shape_xform, const Vector2 &p_motion, real_t p_margin, Vector2 *r_results, int p_result_max, int &r_result_count, const PhysicsQueryExclude &p_exclude, uint32_t p_collision_mask) {
 
 	if (p_result_max <= 0)
 		return 0;
@@ -387,7 +388,7 @@ static void _rest_cbk_result(const Vector2 &p_point_A, const Vector2 &p_point_B,
 	rd->best_shape = rd->shape;
 }
 
-bool Physics2DDirectSpaceStateSW::rest_info(RID p_shape, const Transform2D &p_shape_xform, const Vector2 &p_motion, real_t p_margin, ShapeRestInfo *r_info, const Set<RID> &p_exclude, uint32_t p_collision_mask) {
+bool Physics2DDirectSpaceStateSW::rest_info(RID p_shape, const Transform2D &p_shape_xform, const Vector2 &p_motion, real_t p_margin, ShapeRestInfo *r_info, const PhysicsQueryExclude &p_exclude, uint32_t p_collision_mask) {
 
 	Shape2DSW *shape = Physics2DServerSW::singletonsw->shape_owner.get(p_shape);
 	ERR_FAIL_COND_V(!shape, 0);
@@ -452,41 +453,85 @@ Physics2DDirectSpaceStateSW::Physics2DDirectSpaceStateSW() {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-int Space2DSW::_cull_aabb_for_body(Body2DSW *p_body, const Rect2 &p_aabb) {
+int Space2DSW::_cull_aabb_for_body(Body2DSW *p_body, const Rect2 &p_aabb, real_t p_slack, MotionCandidates &r_candidates) {
 
-	int amount = broadphase->cull_aabb(p_aabb, intersection_query_results, INTERSECTION_QUERY_MAX, intersection_query_subindex_results);
+	if (!r_candidates.valid || !r_candidates.bounds.encloses(p_aabb)) {
 
-	for (int i = 0; i < amount; i++) {
+		// gather a bit more than asked for, so the next queries of this motion can reuse the list
+		Rect2 bounds = p_aabb.grow(p_slack);
 
-		bool keep = true;
+		if (motion_cull_mutex)
+			motion_cull_mutex->lock();
 
-		if (intersection_query_results[i] == p_body)
-			keep = false;
-		else if (intersection_query_results[i]->get_type() == CollisionObject2DSW::TYPE_AREA)
-			keep = false;
-		else if ((static_cast<Body2DSW *>(intersection_query_results[i])->test_collision_mask(p_body)) == 0)
-			keep = false;
-		else if (static_cast<Body2DSW *>(intersection_query_results[i])->has_exception(p_body->get_self()) || p_body->has_exception(intersection_query_results[i]->get_self()))
-			keep = false;
-		else if (static_cast<Body2DSW *>(intersection_query_results[i])->is_shape_set_as_disabled(intersection_query_subindex_results[i]))
-			keep = false;
+		int amount = broadphase->cull_aabb(bounds, intersection_query_results, INTERSECTION_QUERY_MAX, intersection_query_subindex_results);
 
-		if (!keep) {
+		if (r_candidates.objects.size() < amount) {
+			r_candidates.objects.resize(amount);
+			r_candidates.shapes.resize(amount);
+		}
 
-			if (i < amount - 1) {
-				SWAP(intersection_query_results[i], intersection_query_results[amount - 1]);
-				SWAP(intersection_query_subindex_results[i], intersection_query_subindex_results[amount - 1]);
-			}
+		CollisionObject2DSW **objects = r_candidates.objects.ptrw();
+		int *shapes = r_candidates.shapes.ptrw();
+		int count = 0;
+
+		for (int i = 0; i < amount; i++) {
+
+			CollisionObject2DSW *col_obj = intersection_query_results[i];
+			int shape_idx = intersection_query_subindex_results[i];
+
+			if (col_obj == p_body)
+				continue;
+			if (col_obj->get_type() == CollisionObject2DSW::TYPE_AREA)
+				continue;
+
+			Body2DSW *body = static_cast<Body2DSW *>(col_obj);
+			if (body->test_collision_mask(p_body) == 0)
+				continue;
+			if (body->has_exception(p_body->get_self()) || p_body->has_exception(body->get_self()))
+				continue;
+			if (body->is_shape_set_as_disabled(shape_idx))
+				continue;
 
-			amount--;
-			i--;
+			objects[count] = col_obj;
+			shapes[count] = shape_idx;
+			count++;
 		}
+
+		if (motion_cull_mutex)
+			motion_cull_mutex->unlock();
+
+		r_candidates.bounds = bounds;
+		r_candidates.count = count;
+		r_candidates.valid = true;
+	}
+
+	if (r_candidates.culled_objects.size() < r_candidates.count) {
+		r_candidates.culled_objects.resize(r_candidates.count);
+		r_candidates.culled_shapes.resize(r_candidates.count);
+	}
+
+	CollisionObject2DSW *const *objects = r_candidates.objects.ptr();
+	const int *shapes = r_candidates.shapes.ptr();
+	CollisionObject2DSW **culled_objects = r_candidates.culled_objects.ptrw();
+	int *culled_shapes = r_candidates.culled_shapes.ptrw();
+	int amount = 0;
+
+	for (int i = 0; i < r_candidates.count; i++) {
+
+		// same test the broadphase does
+		if (!objects[i]->get_shape_aabb(shapes[i]).intersects(p_aabb))
+			continue;
+
+		culled_objects[amount] = objects[i];
+		culled_shapes[amount] = shapes[i];
+		amount++;
 	}
 
+	r_candidates.culled_count = amount;
 	return amount;
 }
 
-bool Space2DSW::test_body_motion(Body2DSW *p_body, const Transform2D &p_from, const Vector2 &p_motion, real_t p_margin, Physics2DServer::MotionResult *r_result) {
+bool Space2DSW::test_body_motion(Body2DSW *p_body, const Transform2D &p_from, const Vector2 &p_motion, real_t p_margin, Physics2DServer::MotionResult *r_result, MotionCandidates *r_candidates) {
 
 	//give me back regular physics engine logic
 	//this is madness
@@ -513,6 +558,30 @@ bool Space2DSW::test_body_motion(Body2DSW *p_body, const Transform2D &p_from, co
 	body_aabb = p_from.xform(p_body->get_inv_transform().xform(body_aabb));
 	body_aabb = body_aabb.grow(p_margin);
 
+	if (!r_candidates) {
+		r_candidates = &motion_candidates;
+		r_candidates->valid = false;
+	}
+
+	// candidates are gathered with room for the whole motion, so the steps below and later slides reuse them
+	real_t cull_slack = p_motion.length();
+
+	{
+		// one swept query first, most motions don't touch anything
+		Rect2 motion_aabb = body_aabb;
+		motion_aabb.position += p_motion;
+		motion_aabb = motion_aabb.merge(body_aabb);
+
+		if (_cull_aabb_for_body(p_body, motion_aabb, cull_slack, *r_candidates) == 0) {
+
+			if (r_result) {
+				r_result->motion = p_motion;
+				r_result->remainder = Vector2();
+			}
+			return false;
+		}
+	}
+
 	static const int max_excluded_shape_pairs = 32;
 	ExcludedShapeSW excluded_shape_pairs[max_excluded_shape_pairs];
 	int excluded_shape_pair_count = 0;
@@ -540,7 +609,9 @@ bool Space2DSW::test_body_motion(Body2DSW *p_body, const Transform2D &p_from, co
 
 			bool collided = false;
 
-			int amount = _cull_aabb_for_body(p_body, body_aabb);
+			int amount = _cull_aabb_for_body(p_body, body_aabb, cull_slack, *r_candidates);
+			CollisionObject2DSW *const *culled_objects = r_candidates->culled_objects.ptr();
+			const int *culled_shapes = r_candidates->culled_shapes.ptr();
 
 			for (int j = 0; j < p_body->get_shape_count(); j++) {
 				if (p_body->is_shape_set_as_disabled(j))
@@ -550,8 +621,8 @@ bool Space2DSW::test_body_motion(Body2DSW *p_body, const Transform2D &p_from, co
 				Shape2DSW *body_shape = p_body->get_shape(j);
 				for (int i = 0; i < amount; i++) {
 
-					const CollisionObject2DSW *col_obj = intersection_query_results[i];
-					int shape_idx = intersection_query_subindex_results[i];
+					const CollisionObject2DSW *col_obj = culled_objects[i];
+					int shape_idx = culled_shapes[i];
 
 					if (col_obj->is_shape_set_as_one_way_collision(shape_idx)) {
 
@@ -620,7 +691,9 @@ bool Space2DSW::test_body_motion(Body2DSW *p_body, const Transform2D &p_from, co
 		motion_aabb.position += p_motion;
 		motion_aabb = motion_aabb.merge(body_aabb);
 
-		int amount = _cull_aabb_for_body(p_body, motion_aabb);
+		int amount = _cull_aabb_for_body(p_body, motion_aabb, cull_slack, *r_candidates);
+		CollisionObject2DSW *const *culled_objects = r_candidates->culled_objects.ptr();
+		const int *culled_shapes = r_candidates->culled_shapes.ptr();
 
 		for (int body_shape_idx = 0; body_shape_idx < p_body->get_shape_count(); body_shape_idx++) {
 
@@ -637,8 +710,8 @@ bool Space2DSW::test_body_motion(Body2DSW *p_body, const Transform2D &p_from, co
 
 			for (int i = 0; i < amount; i++) {
 
-				const CollisionObject2DSW *col_obj = intersection_query_results[i];
-				int col_shape_idx = intersection_query_subindex_results[i];
+				const CollisionObject2DSW *col_obj = culled_objects[i];
+				int col_shape_idx = culled_shapes[i];
 				Shape2DSW *against_shape = col_obj->get_shape(col_shape_idx);
 
 				bool excluded = false;
@@ -764,12 +837,14 @@ bool Space2DSW::test_body_motion(Body2DSW *p_body, const Transform2D &p_from, co
 
 		body_aabb.position += p_motion * unsafe;
 
-		int amount = _cull_aabb_for_body(p_body, body_aabb);
+		int amount = _cull_aabb_for_body(p_body, body_aabb, cull_slack, *r_candidates);
+		CollisionObject2DSW *const *culled_objects = r_candidates->culled_objects.ptr();
+		const int *culled_shapes = r_candidates->culled_shapes.ptr();
 
 		for (int i = 0; i < amount; i++) {
 
-			const CollisionObject2DSW *col_obj = intersection_query_results[i];
-			int shape_idx = intersection_query_subindex_results[i];
+			const CollisionObject2DSW *col_obj = culled_objects[i];
+			int shape_idx = culled_shapes[i];
 
 			Shape2DSW *against_shape = col_obj->get_shape(shape_idx);
 
@@ -836,6 +911,82 @@ bool Space2DSW::test_body_motion(Body2DSW *p_body, const Transform2D &p_from, co
 	return collided;
 }
 
+void Space2DSW::body_move_and_slide(Body2DSW *p_body, const Physics2DServer::MoveAndSlideParameters &p_params, Physics2DServer::MoveAndSlideResult &r_result, MotionCandidates &r_candidates) {
+
+	// same logic as KinematicBody2D used to run around body_test_motion, the body is only moved
+	// locally so the candidates stay valid for every slide
+	Transform2D xform = p_params.from;
+	Vector2 motion = p_params.motion;
+	Vector2 lv = p_params.linear_velocity;
+	int slides = CLAMP(p_params.max_slides, 0, (int)Physics2DServer::MOVE_AND_SLIDE_MAX_SLIDES);
+
+	r_result.on_floor = false;
+	r_result.on_wall = false;
+	r_result.on_ceiling = false;
+	r_result.stopped_on_slope = false;
+	r_result.floor_velocity = Vector2();
+	r_result.collision_count = 0;
+
+	r_candidates.valid = false;
+
+	real_t floor_max_cos = Math::cos(p_params.floor_max_angle);
+
+	while (slides) {
+
+		Physics2DServer::MotionResult &collision = r_result.collisions[r_result.collision_count];
+
+		bool collided = test_body_motion(p_body, xform, motion, p_params.margin, &collision, &r_candidates);
+		xform.elements[2] += collision.motion;
+
+		if (!collided) {
+			motion = Vector2();
+			break;
+		}
+
+		motion = collision.remainder;
+
+		if (p_params.floor_direction == Vector2()) {
+			//all is a wall
+			r_result.on_wall = true;
+		} else {
+			if (collision.collision_normal.dot(p_params.floor_direction) >= floor_max_cos) { //floor
+
+				r_result.on_floor = true;
+				r_result.floor_velocity = collision.collider_velocity;
+
+				Vector2 rel_v = lv - r_result.floor_velocity;
+				Vector2 hv = rel_v - p_params.floor_direction * p_params.floor_direction.dot(rel_v);
+
+				if (collision.motion.length() < 1 && hv.length() < p_params.slope_stop_min_velocity) {
+					xform.elements[2] -= collision.motion;
+					motion = Vector2();
+					lv = Vector2();
+					r_result.stopped_on_slope = true;
+					break;
+				}
+			} else if (collision.collision_normal.dot(-p_params.floor_direction) >= floor_max_cos) { //ceiling
+				r_result.on_ceiling = true;
+			} else {
+				r_result.on_wall = true;
+			}
+		}
+
+		Vector2 n = collision.collision_normal;
+		motion = motion.slide(n);
+		lv = lv.slide(n);
+
+		r_result.collision_count++;
+
+		slides--;
+		if (motion == Vector2())
+			break;
+	}
+
+	r_result.transform = xform;
+	r_result.motion = motion;
+	r_result.linear_velocity = lv;
+}
+
 void *Space2DSW::_broadphase_pair(CollisionObject2DSW *A, int p_subindex_A, CollisionObject2DSW *B, int p_subindex_B, void *p_self) {
 
 	CollisionObject2DSW::Type type_A = A->get_type();
@@ -960,6 +1111,267 @@ const SelfList<Area2DSW>::List &Space2DSW::get_moved_area_list() const {
 	return area_moved_list;
 }
 
+void Space2DSW::body_pair_add_to_list(SelfList<BodyPair2DSW> *p_pair) {
+
+	body_pair_list.add(p_pair);
+}
+
+void Space2DSW::body_pair_remove_from_list(SelfList<BodyPair2DSW> *p_pair) {
+
+	body_pair_list.remove(p_pair);
+}
+
+void Space2DSW::area_pair_add_to_list(SelfList<AreaPair2DSW> *p_pair) {
+
+	area_pair_list.add(p_pair);
+}
+
+void Space2DSW::area_pair_remove_from_list(SelfList<AreaPair2DSW> *p_pair) {
+
+	area_pair_list.remove(p_pair);
+}
+
+void Space2DSW::area2_pair_add_to_list(SelfList<Area2Pair2DSW> *p_pair) {
+
+	area2_pair_list.add(p_pair);
+}
+
+void Space2DSW::area2_pair_remove_from_list(SelfList<Area2Pair2DSW> *p_pair) {
+
+	area2_pair_list.remove(p_pair);
+}
+
+template <class T>
+static int _count_state_list(const typename SelfList<T>::List &p_list) {
+
+	int count = 0;
+	for (const SelfList<T> *E = p_list.first(); E; E = E->next()) {
+		count++;
+	}
+	return count;
+}
+
+template <class T, class S>
+static S *_save_pair_states(const typename SelfList<T>::List &p_list, S *p_states, int p_count) {
+
+	int idx = 0;
+	for (const SelfList<T> *E = p_list.first(); E; E = E->next()) {
+		E->self()->save_state(p_states[idx++]);
+	}
+
+	// sorted by key, so the blob does not depend on pair creation order and can be searched on restore
+	SortArray<S> sorter;
+	sorter.sort(p_states, p_count);
+
+	return p_states + p_count;
+}
+
+template <class T, class S>
+static const S *_restore_pair_states(typename SelfList<T>::List &p_list, const S *p_states, int p_count) {
+
+	for (SelfList<T> *E = p_list.first(); E; E = E->next()) {
+
+		PairStateKey2DSW key;
+		E->self()->get_state_key(key);
+
+		const S *state = NULL;
+		int low = 0;
+		int high = p_count - 1;
+
+		while (low <= high) {
+
+			int middle = (low + high) / 2;
+			if (key < p_states[middle].key) {
+				high = middle - 1;
+			} else if (p_states[middle].key < key) {
+				low = middle + 1;
+			} else {
+				state = &p_states[middle];
+				break;
+			}
+		}
+
+		E->self()->restore_state(state);
+	}
+
+	return p_states + p_count;
+}
+
+void Space2DSW::save_state(PoolVector<uint8_t> &r_state) const {
+
+	StateHeader header;
+	header.version = STATE_VERSION;
+	header.padding = 0;
+	header.body_count = 0;
+	header.area_count = 0;
+
+	for (Set<CollisionObject2DSW *>::Element *E = objects.front(); E; E = E->next()) {
+
+		if (E->get()->get_type() == CollisionObject2DSW::TYPE_BODY)
+			header.body_count++;
+		else
+			header.area_count++;
+	}
+
+	header.body_pair_count = _count_state_list<BodyPair2DSW>(body_pair_list);
+	header.area_pair_count = _count_state_list<AreaPair2DSW>(area_pair_list);
+	header.area2_pair_count = _count_state_list<Area2Pair2DSW>(area2_pair_list);
+	header.active_count = _count_state_list<Body2DSW>(active_list);
+
+	uint64_t size = header.get_state_size(sizeof(BodyStateRecord), sizeof(AreaStateRecord), sizeof(BodyPair2DSW::State), sizeof(AreaPair2DSW::State), sizeof(Area2Pair2DSW::State));
+	ERR_FAIL_COND(size > 0x7FFFFFFF); // PoolVector sizes are int
+
+	if (r_state.size() != int(size))
+		r_state.resize(int(size));
+
+	PoolVector<uint8_t>::Write w = r_state.write();
+
+	*(StateHeader *)w.ptr() = header;
+
+	BodyStateRecord *bodies = (BodyStateRecord *)(w.ptr() + sizeof(StateHeader));
+	AreaStateRecord *areas = (AreaStateRecord *)(bodies + header.body_count);
+
+	for (Set<CollisionObject2DSW *>::Element *E = objects.front(); E; E = E->next()) {
+
+		if (E->get()->get_type() == CollisionObject2DSW::TYPE_BODY) {
+
+			const Body2DSW *body = static_cast<const Body2DSW *>(E->get());
+			bodies->id = body->get_self().get_id();
+			body->save_state(bodies->state);
+			bodies++;
+		} else {
+
+			areas->id = E->get()->get_self().get_id();
+			areas->transform = E->get()->get_transform();
+			areas++;
+		}
+	}
+
+	BodyPair2DSW::State *body_pairs = (BodyPair2DSW::State *)areas;
+	AreaPair2DSW::State *area_pairs = (AreaPair2DSW::State *)_save_pair_states<BodyPair2DSW>(body_pair_list, body_pairs, header.body_pair_count);
+	Area2Pair2DSW::State *area2_pairs = (Area2Pair2DSW::State *)_save_pair_states<AreaPair2DSW>(area_pair_list, area_pairs, header.area_pair_count);
+	uint32_t *active = (uint32_t *)_save_pair_states<Area2Pair2DSW>(area2_pair_list, area2_pairs, header.area2_pair_count);
+
+	// the active list order decides the island and solver order, keep it so stepping after a restore is repeatable
+	for (const SelfList<Body2DSW> *E = active_list.first(); E; E = E->next()) {
+		*active++ = E->self()->get_self().get_id();
+	}
+}
+
+Error Space2DSW::restore_state(const PoolVector<uint8_t> &p_state) {
+
+	ERR_FAIL_COND_V(locked, ERR_LOCKED);
+
+	PoolVector<uint8_t>::Read r = p_state.read();
+	const StateHeader *header_ptr = StateHeader::validate(r.ptr(), uint64_t(p_state.size()), STATE_VERSION, sizeof(BodyStateRecord), sizeof(AreaStateRecord), sizeof(BodyPair2DSW::State), sizeof(AreaPair2DSW::State), sizeof(Area2Pair2DSW::State));
+	ERR_FAIL_COND_V(!header_ptr, ERR_INVALID_DATA);
+	const StateHeader &header = *header_ptr;
+
+	const BodyStateRecord *bodies = (const BodyStateRecord *)(r.ptr() + sizeof(StateHeader));
+	const AreaStateRecord *areas = (const AreaStateRecord *)(bodies + header.body_count);
+
+	// validate first, a snapshot can only be restored into the same set of objects it was taken from
+
+	state_bodies.resize(header.body_count);
+	{
+		int body_idx = 0;
+		int area_idx = 0;
+
+		for (Set<CollisionObject2DSW *>::Element *E = objects.front(); E; E = E->next()) {
+
+			uint32_t id = E->get()->get_self().get_id();
+
+			if (E->get()->get_type() == CollisionObject2DSW::TYPE_BODY) {
+
+				if (body_idx >= (int)header.body_count || bodies[body_idx].id != id) {
+					ERR_EXPLAIN("Space state does not match the bodies in this space.");
+					ERR_FAIL_V(ERR_INVALID_DATA);
+				}
+				state_bodies[body_idx++] = static_cast<Body2DSW *>(E->get());
+			} else {
+
+				if (area_idx >= (int)header.area_count || areas[area_idx].id != id) {
+					ERR_EXPLAIN("Space state does not match the areas in this space.");
+					ERR_FAIL_V(ERR_INVALID_DATA);
+				}
+				area_idx++;
+			}
+		}
+
+		ERR_FAIL_COND_V(body_idx != (int)header.body_count || area_idx != (int)header.area_count, ERR_INVALID_DATA);
+	}
+
+	// the pair records come from user data as well
+	const BodyPair2DSW::State *body_pairs = (const BodyPair2DSW::State *)(areas + header.area_count);
+	for (uint32_t i = 0; i < header.body_pair_count; i++) {
+		ERR_FAIL_COND_V(!BodyPair2DSW::is_state_valid(body_pairs[i]), ERR_INVALID_DATA);
+	}
+
+	// objects first, so the broadphase pairs match the snapshot before their caches are restored
+
+	{
+		int area_idx = 0;
+
+		for (Set<CollisionObject2DSW *>::Element *E = objects.front(); E; E = E->next()) {
+
+			if (E->get()->get_type() != CollisionObject2DSW::TYPE_AREA)
+				continue;
+
+			Area2DSW *area = static_cast<Area2DSW *>(E->get());
+			const Transform2D &xform = areas[area_idx++].transform;
+			if (area->get_transform() != xform)
+				area->set_transform(xform);
+		}
+	}
+
+	for (uint32_t i = 0; i < header.body_count; i++) {
+		state_bodies[i]->restore_state(bodies[i].state);
+	}
+
+	const AreaPair2DSW::State *area_pairs = (const AreaPair2DSW::State *)_restore_pair_states<BodyPair2DSW>(body_pair_list, body_pairs, header.body_pair_count);
+	const Area2Pair2DSW::State *area2_pairs = (const Area2Pair2DSW::State *)_restore_pair_states<AreaPair2DSW>(area_pair_list, area_pairs, header.area_pair_count);
+	const uint32_t *active = (const uint32_t *)_restore_pair_states<Area2Pair2DSW>(area2_pair_list, area2_pairs, header.area2_pair_count);
+
+	// rebuild the active list in snapshot order, adding to the front so walk it backwards
+
+	state_body_sort.resize(header.body_count);
+	for (uint32_t i = 0; i < header.body_count; i++) {
+		state_body_sort[i].id = bodies[i].id;
+		state_body_sort[i].body = state_bodies[i];
+	}
+
+	SortArray<StateBodySort> sorter;
+	sorter.sort(state_body_sort.ptrw(), state_body_sort.size());
+
+	for (int i = header.active_count - 1; i >= 0; i--) {
+
+		Body2DSW *body = NULL;
+		int low = 0;
+		int high = state_body_sort.size() - 1;
+
+		while (low <= high) {
+
+			int middle = (low + high) / 2;
+			if (active[i] < state_body_sort[middle].id) {
+				high = middle - 1;
+			} else if (state_body_sort[middle].id < active[i]) {
+				low = middle + 1;
+			} else {
+				body = state_body_sort[middle].body;
+				break;
+			}
+		}
+
+		ERR_CONTINUE(!body);
+
+		// moves the body to the front of the active list
+		body->set_active(false);
+		body->set_active(true);
+	}
+
+	return OK;
+}
+
 void Space2DSW::call_queries() {
 
 	while (state_query_list.first()) {
@@ -969,17 +1381,23 @@ void Space2DSW::call_queries() {
 		b->call_queries();
 	}
 
+	uint64_t area_begtime = OS::get_singleton()->get_ticks_usec();
+
 	while (monitor_query_list.first()) {
 
 		Area2DSW *a = monitor_query_list.first()->self();
 		monitor_query_list.remove(monitor_query_list.first());
 		a->call_queries();
 	}
+
+	elapsed_time[ELAPSED_TIME_AREA_QUERIES] = OS::get_singleton()->get_ticks_usec() - area_begtime;
 }
 
 void Space2DSW::setup() {
 
 	contact_debug_count = 0;
+	for (int i = 0; i < STEP_COUNTER_MAX; i++)
+		step_counter[i] = 0;
 
 	while (inertia_update_list.first()) {
 		inertia_update_list.first()->self()->update_inertias();
@@ -1067,12 +1485,18 @@ Space2DSW::Space2DSW() {
 	direct_access = memnew(Physics2DDirectSpaceStateSW);
 	direct_access->space = this;
 
+	motion_cull_mutex = Mutex::create();
+
 	for (int i = 0; i < ELAPSED_TIME_MAX; i++)
 		elapsed_time[i] = 0;
+	for (int i = 0; i < STEP_COUNTER_MAX; i++)
+		step_counter[i] = 0;
 }
 
 Space2DSW::~Space2DSW() {
 
 	memdelete(broadphase);
 	memdelete(direct_access);
+	if (motion_cull_mutex)
+		memdelete(motion_cull_mutex);
 }
@@ -38,7 +38,10 @@
 #include "broad_phase_2d_sw.h"
 #include "collision_object_2d_sw.h"
 #include "hash_map.h"
+#include "os/mutex.h"
 #include "project_settings.h"
+#include "safe_refcount.h"
+#include "servers/physics_state_header.h"
 #include "typedefs.h"
 
 class Physics2DDirectSpaceStateSW : public Physics2DDirectSpaceState {
@@ -48,12 +51,12 @@ class Physics2DDirectSpaceStateSW : public Physics2DDirectSpaceState {
 public:
 	Space2DSW *space;
 
-	virtual int intersect_point(const Vector2 &p_point, ShapeResult *r_results, int p_result_max, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF, bool p_pick_point = false);
-	virtual bool intersect_ray(const Vector2 &p_from, const Vector2 &p_to, RayResult &r_result, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF);
-	virtual int intersect_shape(const RID &p_shape, const Transform2D &p_xform, const Vector2 &p_motion, real_t p_margin, ShapeResult *r_results, int p_result_max, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF);
-	virtual bool cast_motion(const RID &p_shape, const Transform2D &p_xform, const Vector2 &p_motion, real_t p_margin, real_t &p_closest_safe, real_t &p_closest_unsafe, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF);
-	virtual bool collide_shape(RID p_shape, const Transform2D &p_shape_xform, const Vector2 &p_motion, real_t p_margin, Vector2 *r_results, int p_result_max, int &r_result_count, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF);
-	virtual bool rest_info(RID p_shape, const Transform2D &p_shape_xform, const Vector2 &p_motion, real_t p_margin, ShapeRestInfo *r_info, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF);
+	virtual int intersect_point(const Vector2 &p_point, ShapeResult *r_results, int p_result_max, const PhysicsQueryExclude &p_exclude = PhysicsQueryExclude(), uint32_t p_collision_mask = 0xFFFFFFFF, bool p_pick_point = false);
+	virtual bool intersect_ray(const Vector2 &p_from, const Vector2 &p_to, RayResult &r_result, const PhysicsQueryExclude &p_exclude = PhysicsQueryExclude(), uint32_t p_collision_mask = 0xFFFFFFFF);
+	virtual int intersect_shape(const RID &p_shape, const Transform2D &p_xform, const Vector2 &p_motion, real_t p_margin, ShapeResult *r_results, int p_result_max, const PhysicsQueryExclude &p_exclude = PhysicsQueryExclude(), uint32_t p_collision_mask = 0xFFFFFFFF);
+	virtual bool cast_motion(const RID &p_shape, const Transform2D &p_xform, const Vector2 &p_motion, real_t p_margin, real_t &p_closest_safe, real_t &p_closest_unsafe, const PhysicsQueryExclude &p_exclude = PhysicsQueryExclude(), uint32_t p_collision_mask = 0xFFFFFFFF);
+	virtual bool collide_shape(RID p_shape, const Transform2D &p_shape_xform, const Vector2 &p_motion, real_t p_margin, Vector2 *r_results, int p_result_max, int &r_result_count, const PhysicsQueryExclude &p_exclude = PhysicsQueryExclude(), uint32_t p_collision_mask = 0xFFFFFFFF);
+	virtual bool rest_info(RID p_shape, const Transform2D &p_shape_xform, const Vector2 &p_motion, real_t p_margin, ShapeRestInfo *r_info, const PhysicsQueryExclude &p_exclude = PhysicsQueryExclude(), uint32_t p_collision_mask = 0xFFFFFFFF);
 
 	Physics2DDirectSpaceStateSW();
 };
@@ -67,10 +70,41 @@ public:
 		ELAPSED_TIME_SETUP_CONSTRAINTS,
 		ELAPSED_TIME_SOLVE_CONSTRAINTS,
 		ELAPSED_TIME_INTEGRATE_VELOCITIES,
+		ELAPSED_TIME_BROAD_PHASE,
+		ELAPSED_TIME_AREA_QUERIES,
 		ELAPSED_TIME_MAX
 
 	};
 
+	enum StepCounter {
+		STEP_COUNTER_PAIRS_TESTED,
+		STEP_COUNTER_CONTACTS,
+		STEP_COUNTER_CCD_SWEEPS,
+		STEP_COUNTER_MAX
+	};
+
+	// Broadphase candidates for the motion tests of one body. They stay valid while the world does not
+	// change, so the iterations of a slide only query the broadphase again once the body leaves the
+	// region they were gathered for. Also holds the per query scratch, so one instance per thread.
+	struct MotionCandidates {
+
+		Rect2 bounds;
+		bool valid;
+		int count;
+		Vector<CollisionObject2DSW *> objects;
+		Vector<int> shapes;
+
+		int culled_count;
+		Vector<CollisionObject2DSW *> culled_objects;
+		Vector<int> culled_shapes;
+
+		MotionCandidates() {
+			valid = false;
+			count = 0;
+			culled_count = 0;
+		}
+	};
+
 private:
 	struct ExcludedShapeSW {
 		Shape2DSW *local_shape;
@@ -79,6 +113,7 @@ private:
 	};
 
 	uint64_t elapsed_time[ELAPSED_TIME_MAX];
+	uint32_t step_counter[STEP_COUNTER_MAX];
 
 	Physics2DDirectSpaceStateSW *direct_access;
 	RID self;
@@ -89,6 +124,9 @@ private:
 	SelfList<Body2DSW>::List state_query_list;
 	SelfList<Area2DSW>::List monitor_query_list;
 	SelfList<Area2DSW>::List area_moved_list;
+	SelfList<BodyPair2DSW>::List body_pair_list;
+	SelfList<AreaPair2DSW>::List area_pair_list;
+	SelfList<Area2Pair2DSW>::List area2_pair_list;
 
 	static void *_broadphase_pair(CollisionObject2DSW *A, int p_subindex_A, CollisionObject2DSW *B, int p_subindex_B, void *p_self);
 	static void _broadphase_unpair(CollisionObject2DSW *A, int p_subindex_A, CollisionObject2DSW *B, int p_subindex_B, void *p_data, void *p_self);
@@ -120,7 +158,43 @@ private:
 	int active_objects;
 	int collision_pairs;
 
-	int _cull_aabb_for_body(Body2DSW *p_body, const Rect2 &p_aabb);
+	// scratch for single body_test_motion calls
+	MotionCandidates motion_candidates;
+	// serializes broadphase culls from motion tests running on several threads
+	Mutex *motion_cull_mutex;
+
+	int _cull_aabb_for_body(Body2DSW *p_body, const Rect2 &p_aabb, real_t p_slack, MotionCandidates &r_candidates);
+
+	// state snapshot layout: header, body records, area records and the pair records sorted by key
+	enum {
+		STATE_VERSION = 1
+	};
+
+	typedef PhysicsStateHeader StateHeader;
+
+	struct BodyStateRecord {
+
+		uint32_t id;
+		Body2DSW::State state;
+	};
+
+	struct AreaStateRecord {
+
+		uint32_t id;
+		Transform2D transform;
+	};
+
+	struct StateBodySort {
+
+		uint32_t id;
+		Body2DSW *body;
+
+		_FORCE_INLINE_ bool operator<(const StateBodySort &p_other) const { return id < p_other.id; }
+	};
+
+	// scratch, avoids allocating on every restore
+	Vector<Body2DSW *> state_bodies;
+	Vector<StateBodySort> state_body_sort;
 
 	Vector<Vector2> contact_debug;
 	int contact_debug_count;
@@ -146,6 +220,13 @@ public:
 	void body_add_to_state_query_list(SelfList<Body2DSW> *p_body);
 	void body_remove_from_state_query_list(SelfList<Body2DSW> *p_body);
 
+	void body_pair_add_to_list(SelfList<BodyPair2DSW> *p_pair);
+	void body_pair_remove_from_list(SelfList<BodyPair2DSW> *p_pair);
+	void area_pair_add_to_list(SelfList<AreaPair2DSW> *p_pair);
+	void area_pair_remove_from_list(SelfList<AreaPair2DSW> *p_pair);
+	void area2_pair_add_to_list(SelfList<Area2Pair2DSW> *p_pair);
+	void area2_pair_remove_from_list(SelfList<Area2Pair2DSW> *p_pair);
+
 	void area_add_to_monitor_query_list(SelfList<Area2DSW> *p_area);
 	void area_remove_from_monitor_query_list(SelfList<Area2DSW> *p_area);
 
@@ -182,7 +263,12 @@ public:
 
 	int get_collision_pairs() const { return collision_pairs; }
 
-	bool test_body_motion(Body2DSW *p_body, const Transform2D &p_from, const Vector2 &p_motion, real_t p_margin, Physics2DServer::MotionResult *r_result);
+	bool test_body_motion(Body2DSW *p_body, const Transform2D &p_from, const Vector2 &p_motion, real_t p_margin, Physics2DServer::MotionResult *r_result, MotionCandidates *r_candidates = NULL);
+	// does not modify the body or the space, so several bodies can be moved concurrently with their own candidates
+	void body_move_and_slide(Body2DSW *p_body, const Physics2DServer::MoveAndSlideParameters &p_params, Physics2DServer::MoveAndSlideResult &r_result, MotionCandidates &r_candidates);
+
+	void save_state(PoolVector<uint8_t> &r_state) const;
+	Error restore_state(const PoolVector<uint8_t> &p_state);
 
 	void set_debug_contacts(int p_amount) { contact_debug.resize(p_amount); }
 	_FORCE_INLINE_ bool is_debugging_contacts() const { return !contact_debug.empty(); }
@@ -197,6 +283,10 @@ public:
 	void set_elapsed_time(ElapsedTime p_time, uint64_t p_msec) { elapsed_time[p_time] = p_msec; }
 	uint64_t get_elapsed_time(ElapsedTime p_time) const { return elapsed_time[p_time]; }
 
+	// constraints are set up from several threads during a step
+	_FORCE_INLINE_ void add_step_counter(StepCounter p_counter, uint32_t p_amount = 1) { atomic_add(&step_counter[p_counter], p_amount); }
+	uint32_t get_step_counter(StepCounter p_counter) const { return step_counter[p_counter]; }
+
 	Space2DSW();
 	~Space2DSW();
 };
@@ -31,6 +31,22 @@
 #include "step_2d_sw.h"
 #include "os/os.h"
 
+#define BATCH_CHUNK_SIZE 256
+
+// appends to a buffer kept across steps, so it only reallocates when the scene grows
+template <class T>
+static _FORCE_INLINE_ void _push_reused(Vector<T> &r_buffer, int &r_count, const T &p_value) {
+
+	if (r_buffer.size() <= r_count)
+		r_buffer.resize(MAX(64, r_count * 2));
+	r_buffer[r_count++] = p_value;
+}
+
+void Step2DSW::_add_area_pair(Constraint2DSW *p_pair) {
+
+	_push_reused(area_pairs, area_pair_count, p_pair);
+}
+
 void Step2DSW::_populate_island(Body2DSW *p_body, Body2DSW **p_island, Constraint2DSW **p_constraint_island) {
 
 	p_body->set_island_step(_step);
@@ -43,6 +59,10 @@ void Step2DSW::_populate_island(Body2DSW *p_body, Body2DSW **p_island, Constrain
 		if (c->get_island_step() == _step)
 			continue; //already processed
 		c->set_island_step(_step);
+		if (c->is_area_pair()) {
+			_add_area_pair(c);
+			continue; //no bodies to follow, overlap is tested apart from the islands
+		}
 		c->set_island_next(*p_constraint_island);
 		*p_constraint_island = c;
 
@@ -57,6 +77,37 @@ void Step2DSW::_populate_island(Body2DSW *p_body, Body2DSW **p_island, Constrain
 	}
 }
 
+void Step2DSW::_solve_narrow_phase_batches(Constraint2DSW *p_constraint_island_list) {
+
+	int counts[CollisionSolver2DSW::BATCH_MAX] = {};
+	CollisionSolver2DSW::BatchPair pair;
+
+	for (Constraint2DSW *island = p_constraint_island_list; island; island = island->get_island_list_next()) {
+		for (Constraint2DSW *ci = island; ci; ci = ci->get_island_next()) {
+
+			CollisionSolver2DSW::BatchType type = ci->setup_batch(pair);
+			if (type == CollisionSolver2DSW::BATCH_NONE)
+				continue;
+
+			_push_reused(batch_pairs[type], counts[type], pair);
+		}
+	}
+
+	int chunk_count = 0;
+	for (int i = 0; i < CollisionSolver2DSW::BATCH_MAX; i++) {
+		for (int from = 0; from < counts[i]; from += BATCH_CHUNK_SIZE) {
+
+			BatchChunk chunk;
+			chunk.type = CollisionSolver2DSW::BatchType(i);
+			chunk.from = from;
+			chunk.count = MIN(BATCH_CHUNK_SIZE, counts[i] - from);
+			_push_reused(batch_chunks, chunk_count, chunk);
+		}
+	}
+
+	work_pool->do_work(chunk_count, this, &Step2DSW::_solve_batch_chunk_work, (void *)NULL);
+}
+
 bool Step2DSW::_setup_island(Constraint2DSW *p_island, real_t p_delta) {
 
 	Constraint2DSW *ci = p_island;
@@ -94,6 +145,56 @@ void Step2DSW::_solve_island(Constraint2DSW *p_island, int p_iterations, real_t
 	}
 }
 
+bool Step2DSW::_is_island_serial(Constraint2DSW *p_island) const {
+
+	// static and kinematic bodies are not followed when building islands, so several islands can add contacts to them
+	for (Constraint2DSW *ci = p_island; ci; ci = ci->get_island_next()) {
+		for (int i = 0; i < ci->get_body_count(); i++) {
+
+			const Body2DSW *b = ci->get_body_ptr()[i];
+			if (b && b->get_mode() <= Physics2DServer::BODY_MODE_KINEMATIC && b->can_report_contacts())
+				return true;
+		}
+	}
+
+	return false;
+}
+
+void Step2DSW::_integrate_forces_work(uint32_t p_index, void *p_userdata) {
+
+	parallel_bodies[p_index]->integrate_forces(delta);
+}
+
+void Step2DSW::_test_area_pair_work(uint32_t p_index, void *p_userdata) {
+
+	area_pairs[p_index]->test_overlap();
+}
+
+void Step2DSW::_solve_batch_chunk_work(uint32_t p_index, void *p_userdata) {
+
+	const BatchChunk &chunk = batch_chunks[p_index];
+	CollisionSolver2DSW::solve_batch(chunk.type, batch_pairs[chunk.type].ptrw() + chunk.from, chunk.count);
+}
+
+void Step2DSW::_setup_island_work(uint32_t p_index, void *p_userdata) {
+
+	Island &island = islands.ptrw()[p_index];
+	if (island.serial)
+		return; //set up afterwards on the calling thread
+
+	if (_setup_island(island.root, delta)) {
+		//removed the root from the island graph because it is not to be processed, next one takes its place
+		island.root = island.root->get_island_next();
+	}
+}
+
+void Step2DSW::_solve_island_work(uint32_t p_index, void *p_userdata) {
+
+	Constraint2DSW *root = islands[p_index].root;
+	if (root)
+		_solve_island(root, iterations, delta);
+}
+
 void Step2DSW::_check_suspend(Body2DSW *p_island, real_t p_delta) {
 
 	bool can_sleep = true;
@@ -137,6 +238,9 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 
 	p_space->setup(); //update inertias, etc
 
+	delta = p_delta;
+	iterations = p_iterations;
+
 	const SelfList<Body2DSW>::List *body_list = &p_space->get_active_body_list();
 
 	/* INTEGRATE FORCES */
@@ -145,15 +249,25 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 	uint64_t profile_endtime = 0;
 
 	int active_count = 0;
+	parallel_body_count = 0;
 
 	const SelfList<Body2DSW> *b = body_list->first();
 	while (b) {
 
-		b->self()->integrate_forces(p_delta);
+		Body2DSW *body = b->self();
+
+		// kinematic and continuous collision bodies extend their shapes in the broadphase, which can't be done concurrently
+		if (body->get_mode() > Physics2DServer::BODY_MODE_KINEMATIC && body->get_continuous_collision_detection_mode() == Physics2DServer::CCD_MODE_DISABLED) {
+			_push_reused(parallel_bodies, parallel_body_count, body);
+		} else {
+			body->integrate_forces(p_delta);
+		}
 		b = b->next();
 		active_count++;
 	}
 
+	work_pool->do_work(parallel_body_count, this, &Step2DSW::_integrate_forces_work, (void *)NULL);
+
 	p_space->set_active_objects(active_count);
 
 	{ //profile
@@ -168,7 +282,8 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 	Constraint2DSW *constraint_island_list = NULL;
 	b = body_list->first();
 
-	int island_count = 0;
+	island_count = 0;
+	area_pair_count = 0;
 
 	while (b) {
 		Body2DSW *body = b->self();
@@ -185,7 +300,11 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 			if (constraint_island) {
 				constraint_island->set_island_list_next(constraint_island_list);
 				constraint_island_list = constraint_island;
-				island_count++;
+
+				Island ci;
+				ci.root = constraint_island;
+				ci.serial = false;
+				_push_reused(islands, island_count, ci);
 			}
 		}
 		b = b->next();
@@ -202,9 +321,7 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 			if (c->get_island_step() == _step)
 				continue;
 			c->set_island_step(_step);
-			c->set_island_next(NULL);
-			c->set_island_list_next(constraint_island_list);
-			constraint_island_list = c;
+			_add_area_pair(c);
 		}
 		p_space->area_remove_from_moved_list((SelfList<Area2DSW> *)aml.first()); //faster to remove here
 	}
@@ -219,42 +336,31 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* SETUP CONSTRAINT ISLANDS */
 
-	{
-		Constraint2DSW *ci = constraint_island_list;
-		Constraint2DSW *prev_ci = NULL;
-		while (ci) {
+	_solve_narrow_phase_batches(constraint_island_list);
 
-			if (_setup_island(ci, p_delta) == true) {
+	work_pool->do_work(area_pair_count, this, &Step2DSW::_test_area_pair_work, (void *)NULL);
 
-				//removed the root from the island graph because it is not to be processed
+	// applied in a fixed order, so monitors get their events in the same order regardless of the thread count
+	for (int i = 0; i < area_pair_count; i++) {
+		area_pairs[i]->apply_overlap();
+	}
 
-				Constraint2DSW *next = ci->get_island_next();
+	// debug contacts go to a single list in the space
+	bool debug_contacts = p_space->is_debugging_contacts();
+	for (int i = 0; i < island_count; i++) {
+		islands[i].serial = debug_contacts || _is_island_serial(islands[i].root);
+	}
 
-				if (next) {
-					//root from list being deleted no longer exists, replace by next
-					next->set_island_list_next(ci->get_island_list_next());
-					if (prev_ci) {
-						prev_ci->set_island_list_next(next);
-					} else {
-						constraint_island_list = next;
-					}
-					prev_ci = next;
-				} else {
+	work_pool->do_work(island_count, this, &Step2DSW::_setup_island_work, (void *)NULL);
 
-					//list is empty, just skip
-					if (prev_ci) {
-						prev_ci->set_island_list_next(ci->get_island_list_next());
+	for (int i = 0; i < island_count; i++) {
 
-					} else {
-						constraint_island_list = ci->get_island_list_next();
-					}
-				}
-			} else {
-				prev_ci = ci;
-			}
+		Island &island = islands[i];
+		if (!island.serial)
+			continue;
 
-			ci = ci->get_island_list_next();
-		}
+		island.serial = false;
+		_setup_island_work(i, NULL);
 	}
 
 	{ //profile
@@ -265,14 +371,8 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* SOLVE CONSTRAINT ISLANDS */
 
-	{
-		Constraint2DSW *ci = constraint_island_list;
-		while (ci) {
-			//iterating each island separatedly improves cache efficiency
-			_solve_island(ci, p_iterations, p_delta);
-			ci = ci->get_island_list_next();
-		}
-	}
+	//iterating each island separatedly improves cache efficiency, and islands share no dynamic bodies so they can be solved at once
+	work_pool->do_work(island_count, this, &Step2DSW::_solve_island_work, (void *)NULL);
 
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
@@ -304,15 +404,28 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
 		p_space->set_elapsed_time(Space2DSW::ELAPSED_TIME_INTEGRATE_VELOCITIES, profile_endtime - profile_begtime);
-		//profile_begtime=profile_endtime;
+		profile_begtime = profile_endtime;
 	}
 
+	/* BROAD PHASE */
+
 	p_space->update();
+
+	{ //profile
+		profile_endtime = OS::get_singleton()->get_ticks_usec();
+		p_space->set_elapsed_time(Space2DSW::ELAPSED_TIME_BROAD_PHASE, profile_endtime - profile_begtime);
+	}
 	p_space->unlock();
 	_step++;
 }
 
-Step2DSW::Step2DSW() {
+Step2DSW::Step2DSW(ThreadWorkPool *p_work_pool) {
 
 	_step = 1;
+	work_pool = p_work_pool;
+	delta = 0;
+	iterations = 0;
+	parallel_body_count = 0;
+	island_count = 0;
+	area_pair_count = 0;
 }
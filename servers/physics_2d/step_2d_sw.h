@@ -31,20 +31,66 @@
 #ifndef STEP_2D_SW_H
 #define STEP_2D_SW_H
 
+#include "os/thread_work_pool.h"
 #include "space_2d_sw.h"
 
 class Step2DSW {
 
 	uint64_t _step;
 
+	ThreadWorkPool *work_pool;
+
+	// state of the step being run, read by the work pool callbacks
+	real_t delta;
+	int iterations;
+
+	// active bodies whose forces can be integrated from any thread
+	Vector<Body2DSW *> parallel_bodies;
+	int parallel_body_count;
+
+	struct Island {
+
+		Constraint2DSW *root;
+		bool serial; // reports contacts to a static or kinematic body that other islands share
+	};
+
+	Vector<Island> islands;
+	int island_count;
+
+	Vector<Constraint2DSW *> area_pairs;
+	int area_pair_count;
+
+	// narrow phase pairs collected from all islands, grouped by shape type combination
+	Vector<CollisionSolver2DSW::BatchPair> batch_pairs[CollisionSolver2DSW::BATCH_MAX];
+
+	struct BatchChunk {
+
+		CollisionSolver2DSW::BatchType type;
+		int from;
+		int count;
+	};
+
+	Vector<BatchChunk> batch_chunks;
+
 	void _populate_island(Body2DSW *p_body, Body2DSW **p_island, Constraint2DSW **p_constraint_island);
+	void _solve_narrow_phase_batches(Constraint2DSW *p_constraint_island_list);
 	bool _setup_island(Constraint2DSW *p_island, real_t p_delta);
 	void _solve_island(Constraint2DSW *p_island, int p_iterations, real_t p_delta);
 	void _check_suspend(Body2DSW *p_island, real_t p_delta);
+	void _add_area_pair(Constraint2DSW *p_pair);
+	bool _is_island_serial(Constraint2DSW *p_island) const;
+
+	void _integrate_forces_work(uint32_t p_index, void *p_userdata);
+	void _test_area_pair_work(uint32_t p_index, void *p_userdata);
+	void _solve_batch_chunk_work(uint32_t p_index, void *p_userdata);
+	void _setup_island_work(uint32_t p_index, void *p_userdata);
+	void _solve_island_work(uint32_t p_index, void *p_userdata);
 
 public:
 	void step(Space2DSW *p_space, real_t p_delta, int p_iterations);
-	Step2DSW();
+
+	// bodies, islands and area pairs are spread over p_work_pool, results do not depend on its thread count
+	Step2DSW(ThreadWorkPool *p_work_pool);
 };
 
 #endif // STEP_2D_SW_H
@@ -179,20 +179,12 @@ int Physics2DShapeQueryParameters::get_collision_mask() const {
 
 void Physics2DShapeQueryParameters::set_exclude(const Vector<RID> &p_exclude) {
 
-	exclude.clear();
-	for (int i = 0; i < p_exclude.size(); i++)
-		exclude.insert(p_exclude[i]);
+	exclude.set(p_exclude);
 }
 
 Vector<RID> Physics2DShapeQueryParameters::get_exclude() const {
 
-	Vector<RID> ret;
-	ret.resize(exclude.size());
-	int idx = 0;
-	for (Set<RID>::Element *E = exclude.front(); E; E = E->next()) {
-		ret[idx] = E->get();
-	}
-	return ret;
+	return exclude.to_vector();
 }
 
 void Physics2DShapeQueryParameters::_bind_methods() {
@@ -234,9 +226,7 @@ Physics2DShapeQueryParameters::Physics2DShapeQueryParameters() {
 Dictionary Physics2DDirectSpaceState::_intersect_ray(const Vector2 &p_from, const Vector2 &p_to, const Vector<RID> &p_exclude, uint32_t p_layers) {
 
 	RayResult inters;
-	Set<RID> exclude;
-	for (int i = 0; i < p_exclude.size(); i++)
-		exclude.insert(p_exclude[i]);
+	PhysicsQueryExclude exclude(p_exclude);
 
 	bool res = intersect_ray(p_from, p_to, inters, exclude, p_layers);
 
@@ -257,9 +247,16 @@ Dictionary Physics2DDirectSpaceState::_intersect_ray(const Vector2 &p_from, cons
 
 Array Physics2DDirectSpaceState::_intersect_shape(const Ref<Physics2DShapeQueryParameters> &p_shape_query, int p_max_results) {
 
-	Vector<ShapeResult> sr;
-	sr.resize(p_max_results);
-	int rc = intersect_shape(p_shape_query->shape, p_shape_query->transform, p_shape_query->motion, p_shape_query->margin, sr.ptrw(), sr.size(), p_shape_query->exclude, p_shape_query->collision_mask);
+	ERR_FAIL_COND_V(p_max_results < 0, Array());
+
+	ShapeResult stack_results[STACK_RESULT_MAX];
+	Vector<ShapeResult> heap_results;
+	ShapeResult *sr = stack_results;
+	if (p_max_results > STACK_RESULT_MAX) {
+		heap_results.resize(p_max_results);
+		sr = heap_results.ptrw();
+	}
+	int rc = intersect_shape(p_shape_query->shape, p_shape_query->transform, p_shape_query->motion, p_shape_query->margin, sr, p_max_results, p_shape_query->exclude, p_shape_query->collision_mask);
 	Array ret;
 	ret.resize(rc);
 	for (int i = 0; i < rc; i++) {
@@ -291,14 +288,19 @@ Array Physics2DDirectSpaceState::_cast_motion(const Ref<Physics2DShapeQueryParam
 
 Array Physics2DDirectSpaceState::_intersect_point(const Vector2 &p_point, int p_max_results, const Vector<RID> &p_exclude, uint32_t p_layers) {
 
-	Set<RID> exclude;
-	for (int i = 0; i < p_exclude.size(); i++)
-		exclude.insert(p_exclude[i]);
+	ERR_FAIL_COND_V(p_max_results < 0, Array());
 
-	Vector<ShapeResult> ret;
-	ret.resize(p_max_results);
+	PhysicsQueryExclude exclude(p_exclude);
 
-	int rc = intersect_point(p_point, ret.ptrw(), ret.size(), exclude, p_layers);
+	ShapeResult stack_results[STACK_RESULT_MAX];
+	Vector<ShapeResult> heap_results;
+	ShapeResult *ret = stack_results;
+	if (p_max_results > STACK_RESULT_MAX) {
+		heap_results.resize(p_max_results);
+		ret = heap_results.ptrw();
+	}
+
+	int rc = intersect_point(p_point, ret, p_max_results, exclude, p_layers);
 	if (rc == 0)
 		return Array();
 
@@ -319,10 +321,17 @@ Array Physics2DDirectSpaceState::_intersect_point(const Vector2 &p_point, int p_
 
 Array Physics2DDirectSpaceState::_collide_shape(const Ref<Physics2DShapeQueryParameters> &p_shape_query, int p_max_results) {
 
-	Vector<Vector2> ret;
-	ret.resize(p_max_results * 2);
+	ERR_FAIL_COND_V(p_max_results < 0, Array());
+
+	Vector2 stack_results[STACK_RESULT_MAX * 2];
+	Vector<Vector2> heap_results;
+	Vector2 *ret = stack_results;
+	if (p_max_results > STACK_RESULT_MAX) {
+		heap_results.resize(p_max_results * 2);
+		ret = heap_results.ptrw();
+	}
 	int rc = 0;
-	bool res = collide_shape(p_shape_query->shape, p_shape_query->transform, p_shape_query->motion, p_shape_query->margin, ret.ptrw(), p_max_results, rc, p_shape_query->exclude, p_shape_query->collision_mask);
+	bool res = collide_shape(p_shape_query->shape, p_shape_query->transform, p_shape_query->motion, p_shape_query->margin, ret, p_max_results, rc, p_shape_query->exclude, p_shape_query->collision_mask);
 	if (!res)
 		return Array();
 	Array r;
@@ -506,6 +515,8 @@ void Physics2DServer::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("space_set_param", "space", "param", "value"), &Physics2DServer::space_set_param);
 	ClassDB::bind_method(D_METHOD("space_get_param", "space", "param"), &Physics2DServer::space_get_param);
 	ClassDB::bind_method(D_METHOD("space_get_direct_state", "space"), &Physics2DServer::space_get_direct_state);
+	ClassDB::bind_method(D_METHOD("space_save_state", "space"), &Physics2DServer::space_save_state);
+	ClassDB::bind_method(D_METHOD("space_restore_state", "space", "state"), &Physics2DServer::space_restore_state);
 
 	ClassDB::bind_method(D_METHOD("area_create"), &Physics2DServer::area_create);
 	ClassDB::bind_method(D_METHOD("area_set_space", "area", "space"), &Physics2DServer::area_set_space);
@@ -539,6 +550,7 @@ void Physics2DServer::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("area_get_object_instance_id", "area"), &Physics2DServer::area_get_object_instance_id);
 
 	ClassDB::bind_method(D_METHOD("area_set_monitor_callback", "area", "receiver", "method"), &Physics2DServer::area_set_monitor_callback);
+	ClassDB::bind_method(D_METHOD("area_set_monitor_batching", "area", "enable"), &Physics2DServer::area_set_monitor_batching);
 
 	ClassDB::bind_method(D_METHOD("body_create"), &Physics2DServer::body_create);
 
@@ -705,6 +717,16 @@ void Physics2DServer::_bind_methods() {
 	BIND_ENUM_CONSTANT(INFO_ACTIVE_OBJECTS);
 	BIND_ENUM_CONSTANT(INFO_COLLISION_PAIRS);
 	BIND_ENUM_CONSTANT(INFO_ISLAND_COUNT);
+	BIND_ENUM_CONSTANT(INFO_STEP_TIME);
+	BIND_ENUM_CONSTANT(INFO_BROAD_PHASE_TIME);
+	BIND_ENUM_CONSTANT(INFO_ISLAND_TIME);
+	BIND_ENUM_CONSTANT(INFO_NARROW_PHASE_TIME);
+	BIND_ENUM_CONSTANT(INFO_SOLVER_TIME);
+	BIND_ENUM_CONSTANT(INFO_INTEGRATION_TIME);
+	BIND_ENUM_CONSTANT(INFO_AREA_QUERY_TIME);
+	BIND_ENUM_CONSTANT(INFO_PAIRS_TESTED);
+	BIND_ENUM_CONSTANT(INFO_CONTACT_COUNT);
+	BIND_ENUM_CONSTANT(INFO_CCD_SWEEPS);
 }
 
 Physics2DServer::Physics2DServer() {
@@ -32,6 +32,7 @@
 #define PHYSICS_2D_SERVER_H
 
 #include "object.h"
+#include "physics_query_exclude.h"
 #include "reference.h"
 #include "resource.h"
 
@@ -97,7 +98,7 @@ class Physics2DShapeQueryParameters : public Reference {
 	Transform2D transform;
 	Vector2 motion;
 	float margin;
-	Set<RID> exclude;
+	PhysicsQueryExclude exclude;
 	uint32_t collision_mask;
 
 protected:
@@ -130,6 +131,11 @@ class Physics2DDirectSpaceState : public Object {
 
 	GDCLASS(Physics2DDirectSpaceState, Object);
 
+	// the script query wrappers keep up to this many results on the stack (the default max_results), larger requests use the heap
+	enum {
+		STACK_RESULT_MAX = 32
+	};
+
 	Dictionary _intersect_ray(const Vector2 &p_from, const Vector2 &p_to, const Vector<RID> &p_exclude = Vector<RID>(), uint32_t p_layers = 0);
 
 	Array _intersect_point(const Vector2 &p_point, int p_max_results = 32, const Vector<RID> &p_exclude = Vector<RID>(), uint32_t p_layers = 0);
@@ -153,7 +159,7 @@ public:
 		Variant metadata;
 	};
 
-	virtual bool intersect_ray(const Vector2 &p_from, const Vector2 &p_to, RayResult &r_result, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_layer = 0xFFFFFFFF) = 0;
+	virtual bool intersect_ray(const Vector2 &p_from, const Vector2 &p_to, RayResult &r_result, const PhysicsQueryExclude &p_exclude = PhysicsQueryExclude(), uint32_t p_collision_layer = 0xFFFFFFFF) = 0;
 
 	struct ShapeResult {
 
@@ -164,13 +170,13 @@ public:
 		Variant metadata;
 	};
 
-	virtual int intersect_point(const Vector2 &p_point, ShapeResult *r_results, int p_result_max, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_layer = 0xFFFFFFFF, bool p_pick_point = false) = 0;
+	virtual int intersect_point(const Vector2 &p_point, ShapeResult *r_results, int p_result_max, const PhysicsQueryExclude &p_exclude = PhysicsQueryExclude(), uint32_t p_collision_layer = 0xFFFFFFFF, bool p_pick_point = false) = 0;
 
-	virtual int intersect_shape(const RID &p_shape, const Transform2D &p_xform, const Vector2 &p_motion, float p_margin, ShapeResult *r_results, int p_result_max, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_layer = 0xFFFFFFFF) = 0;
+	virtual int intersect_shape(const RID &p_shape, const Transform2D &p_xform, const Vector2 &p_motion, float p_margin, ShapeResult *r_results, int p_result_max, const PhysicsQueryExclude &p_exclude = PhysicsQueryExclude(), uint32_t p_collision_layer = 0xFFFFFFFF) = 0;
 
-	virtual bool cast_motion(const RID &p_shape, const Transform2D &p_xform, const Vector2 &p_motion, float p_margin, float &p_closest_safe, float &p_closest_unsafe, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_layer = 0xFFFFFFFF) = 0;
+	virtual bool cast_motion(const RID &p_shape, const Transform2D &p_xform, const Vector2 &p_motion, float p_margin, float &p_closest_safe, float &p_closest_unsafe, const PhysicsQueryExclude &p_exclude = PhysicsQueryExclude(), uint32_t p_collision_layer = 0xFFFFFFFF) = 0;
 
-	virtual bool collide_shape(RID p_shape, const Transform2D &p_shape_xform, const Vector2 &p_motion, float p_margin, Vector2 *r_results, int p_result_max, int &r_result_count, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_layer = 0xFFFFFFFF) = 0;
+	virtual bool collide_shape(RID p_shape, const Transform2D &p_shape_xform, const Vector2 &p_motion, float p_margin, Vector2 *r_results, int p_result_max, int &r_result_count, const PhysicsQueryExclude &p_exclude = PhysicsQueryExclude(), uint32_t p_collision_layer = 0xFFFFFFFF) = 0;
 
 	struct ShapeRestInfo {
 
@@ -183,7 +189,7 @@ public:
 		Variant metadata;
 	};
 
-	virtual bool rest_info(RID p_shape, const Transform2D &p_shape_xform, const Vector2 &p_motion, float p_margin, ShapeRestInfo *r_info, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_layer = 0xFFFFFFFF) = 0;
+	virtual bool rest_info(RID p_shape, const Transform2D &p_shape_xform, const Vector2 &p_motion, float p_margin, ShapeRestInfo *r_info, const PhysicsQueryExclude &p_exclude = PhysicsQueryExclude(), uint32_t p_collision_layer = 0xFFFFFFFF) = 0;
 
 	Physics2DDirectSpaceState();
 };
@@ -283,6 +289,10 @@ public:
 	virtual Vector<Vector2> space_get_contacts(RID p_space) const = 0;
 	virtual int space_get_contact_count(RID p_space) const = 0;
 
+	// save/restore the simulation state of a space (for rollback), a state can only be restored into the space it was saved from
+	virtual PoolVector<uint8_t> space_save_state(RID p_space) const = 0;
+	virtual Error space_restore_state(RID p_space, const PoolVector<uint8_t> &p_state) = 0;
+
 	//missing space parameters
 
 	/* AREA API */
@@ -346,6 +356,9 @@ public:
 
 	virtual void area_set_monitor_callback(RID p_area, Object *p_receiver, const StringName &p_method) = 0;
 	virtual void area_set_area_monitor_callback(RID p_area, Object *p_receiver, const StringName &p_method) = 0;
+	// when enabled, the monitor callbacks get one PoolIntArray per step instead of one call per event,
+	// with rows of status, instance id, other shape and area shape
+	virtual void area_set_monitor_batching(RID p_area, bool p_enable) = 0;
 
 	/* BODY API */
 
@@ -481,6 +494,48 @@ public:
 
 	virtual bool body_test_motion(RID p_body, const Transform2D &p_from, const Vector2 &p_motion, float p_margin = 0.001, MotionResult *r_result = NULL) = 0;
 
+	enum {
+		MOVE_AND_SLIDE_MAX_SLIDES = 16
+	};
+
+	struct MoveAndSlideParameters {
+
+		RID body;
+		Transform2D from;
+		Vector2 motion;
+		Vector2 linear_velocity;
+		Vector2 floor_direction;
+		real_t slope_stop_min_velocity;
+		real_t floor_max_angle;
+		real_t margin;
+		int max_slides; // clamped to MOVE_AND_SLIDE_MAX_SLIDES
+
+		MoveAndSlideParameters() {
+			slope_stop_min_velocity = 5;
+			floor_max_angle = Math::deg2rad((real_t)45);
+			margin = 0.08;
+			max_slides = 4;
+		}
+	};
+
+	struct MoveAndSlideResult {
+
+		Transform2D transform;
+		Vector2 motion; // motion still left when the slides ran out
+		Vector2 linear_velocity;
+		Vector2 floor_velocity;
+		bool on_floor;
+		bool on_wall;
+		bool on_ceiling;
+		bool stopped_on_slope;
+		int collision_count;
+		MotionResult collisions[MOVE_AND_SLIDE_MAX_SLIDES];
+	};
+
+	// Runs the KinematicBody2D slide loop for p_count bodies, possibly on several threads. Bodies are not
+	// moved, every one is tested against the space as it was before the call and r_results hold where they end up.
+	virtual void body_move_and_slide(const MoveAndSlideParameters *p_params, MoveAndSlideResult *r_results, int p_count) = 0;
+
 	/* JOINT API */
 
 	enum JointType {
@@ -539,13 +594,22 @@ public:
 	virtual void end_sync() = 0;
 	virtual void finish() = 0;
 
+	// times are reported in microseconds for the last step
 	enum ProcessInfo {
 
 		INFO_ACTIVE_OBJECTS,
 		INFO_COLLISION_PAIRS,
 		INFO_ISLAND_COUNT,
 		INFO_STEP_TIME,
-		INFO_BROAD_PHASE_TIME
+		INFO_BROAD_PHASE_TIME,
+		INFO_ISLAND_TIME,
+		INFO_NARROW_PHASE_TIME,
+		INFO_SOLVER_TIME,
+		INFO_INTEGRATION_TIME,
+		INFO_AREA_QUERY_TIME,
+		INFO_PAIRS_TESTED,
+		INFO_CONTACT_COUNT,
+		INFO_CCD_SWEEPS
 	};
 
 	virtual int get_process_info(ProcessInfo p_info) = 0;
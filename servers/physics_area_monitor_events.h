@@ -0,0 +1,207 @@
+/*************************************************************************/
+/*  physics_area_monitor_events.h                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef PHYSICS_AREA_MONITOR_EVENTS_H
+#define PHYSICS_AREA_MONITOR_EVENTS_H
+
+#include "dvector.h"
+#include "hashfuncs.h"
+#include "os/memory.h"
+#include "rid.h"
+#include "vector.h"
+
+/**
+ * Overlap changes an area collected during a step, one event per (object, object shape, area shape).
+ * Lookups go through a flat open addressing table whose slots are stamped with a generation, so
+ * clearing after the callbacks are sent is O(1) and a step with no changes touches no memory.
+ */
+class PhysicsAreaMonitorEvents {
+public:
+	enum {
+		EVENT_STRIDE = 4 // ints per event in pack(): status, instance id, object shape, area shape
+	};
+
+	struct Event {
+
+		RID rid;
+		ObjectID instance_id;
+		uint32_t body_shape;
+		uint32_t area_shape;
+		int state; // > 0 entered, < 0 exited, 0 when it entered and exited during the same step
+	};
+
+private:
+	struct Slot {
+
+		uint32_t generation;
+		int event;
+	};
+
+	Vector<Event> events;
+	int event_count;
+
+	Slot *slots;
+	uint32_t slot_mask;
+	uint32_t generation;
+
+	static _FORCE_INLINE_ uint32_t _hash(const RID &p_rid, uint32_t p_body_shape, uint32_t p_area_shape) {
+
+		uint32_t h = hash_djb2_one_32(p_rid.get_id());
+		h = hash_djb2_one_32(p_body_shape, h);
+		return hash_djb2_one_32(p_area_shape, h);
+	}
+
+	void _grow() {
+
+		uint32_t capacity = slots ? (slot_mask + 1) * 2 : 16;
+
+		if (slots)
+			memfree(slots);
+		slots = (Slot *)memalloc(sizeof(Slot) * capacity);
+		for (uint32_t i = 0; i < capacity; i++)
+			slots[i].generation = 0;
+		slot_mask = capacity - 1;
+
+		if (generation == 0)
+			generation = 1;
+
+		for (int i = 0; i < event_count; i++) {
+
+			const Event &e = events[i];
+			uint32_t pos = _hash(e.rid, e.body_shape, e.area_shape) & slot_mask;
+			while (slots[pos].generation == generation)
+				pos = (pos + 1) & slot_mask;
+			slots[pos].generation = generation;
+			slots[pos].event = i;
+		}
+	}
+
+	PhysicsAreaMonitorEvents(const PhysicsAreaMonitorEvents &);
+	PhysicsAreaMonitorEvents &operator=(const PhysicsAreaMonitorEvents &);
+
+public:
+	void add(const RID &p_rid, ObjectID p_instance_id, uint32_t p_body_shape, uint32_t p_area_shape, int p_delta) {
+
+		// keep the table at most half full
+		if (!slots || uint32_t(event_count + 1) * 2 > slot_mask + 1)
+			_grow();
+
+		uint32_t pos = _hash(p_rid, p_body_shape, p_area_shape) & slot_mask;
+		while (slots[pos].generation == generation) {
+
+			Event &e = events[slots[pos].event];
+			if (e.rid == p_rid && e.body_shape == p_body_shape && e.area_shape == p_area_shape) {
+				e.state += p_delta;
+				return;
+			}
+			pos = (pos + 1) & slot_mask;
+		}
+
+		if (events.size() <= event_count)
+			events.resize(MAX(8, event_count * 2));
+
+		Event &e = events[event_count];
+		e.rid = p_rid;
+		e.instance_id = p_instance_id;
+		e.body_shape = p_body_shape;
+		e.area_shape = p_area_shape;
+		e.state = p_delta;
+
+		slots[pos].generation = generation;
+		slots[pos].event = event_count;
+		event_count++;
+	}
+
+	_FORCE_INLINE_ bool empty() const { return event_count == 0; }
+	_FORCE_INLINE_ int size() const { return event_count; }
+	_FORCE_INLINE_ const Event &get(int p_index) const { return events[p_index]; }
+
+	void clear() {
+
+		if (event_count == 0)
+			return;
+
+		event_count = 0;
+		generation++;
+		if (generation == 0) {
+			// wrapped around, stale stamps could match again
+			for (uint32_t i = 0; i <= slot_mask; i++)
+				slots[i].generation = 0;
+			generation = 1;
+		}
+	}
+
+	/// Writes the events that changed the overlap state as rows of EVENT_STRIDE ints, returns the row count.
+	int pack(PoolVector<int> &r_events, int p_added_status, int p_removed_status) const {
+
+		int count = 0;
+		for (int i = 0; i < event_count; i++) {
+			if (events[i].state != 0)
+				count++;
+		}
+
+		r_events.resize(count * EVENT_STRIDE);
+		if (count == 0)
+			return 0;
+
+		PoolVector<int>::Write w = r_events.write();
+		int *ptr = w.ptr();
+		for (int i = 0; i < event_count; i++) {
+
+			const Event &e = events[i];
+			if (e.state == 0)
+				continue;
+
+			ptr[0] = e.state > 0 ? p_added_status : p_removed_status;
+			ptr[1] = e.instance_id;
+			ptr[2] = e.body_shape;
+			ptr[3] = e.area_shape;
+			ptr += EVENT_STRIDE;
+		}
+
+		return count;
+	}
+
+	PhysicsAreaMonitorEvents() {
+
+		event_count = 0;
+		slots = NULL;
+		slot_mask = 0;
+		generation = 1;
+	}
+
+	~PhysicsAreaMonitorEvents() {
+
+		if (slots)
+			memfree(slots);
+	}
+};
+
+#endif // PHYSICS_AREA_MONITOR_EVENTS_H
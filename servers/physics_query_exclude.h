@@ -0,0 +1,130 @@
+/*************************************************************************/
+/*  physics_query_exclude.h                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef PHYSICS_QUERY_EXCLUDE_H
+#define PHYSICS_QUERY_EXCLUDE_H
+
+#include "rid.h"
+#include "vector.h"
+
+/**
+ * Exclusion list for space queries. Exclude lists are almost always tiny (the querying body and a
+ * handful of exceptions), so the first few RIDs are stored inline and checked linearly, and building
+ * one per query does not allocate. Larger lists spill into a Vector.
+ */
+class PhysicsQueryExclude {
+
+	enum {
+		INLINE_MAX = 8
+	};
+
+	RID inline_rids[INLINE_MAX];
+	int inline_count;
+	Vector<RID> overflow;
+
+public:
+	_FORCE_INLINE_ bool has(const RID &p_rid) const {
+
+		for (int i = 0; i < inline_count; i++) {
+			if (inline_rids[i] == p_rid)
+				return true;
+		}
+		return overflow.size() && overflow.find(p_rid) != -1;
+	}
+
+	_FORCE_INLINE_ bool empty() const { return inline_count == 0; }
+	_FORCE_INLINE_ int size() const { return inline_count + overflow.size(); }
+	_FORCE_INLINE_ RID get(int p_index) const { return p_index < inline_count ? inline_rids[p_index] : overflow[p_index - inline_count]; }
+
+	void insert(const RID &p_rid) {
+
+		if (has(p_rid))
+			return;
+		if (inline_count < INLINE_MAX) {
+			inline_rids[inline_count++] = p_rid;
+		} else {
+			overflow.push_back(p_rid);
+		}
+	}
+
+	void erase(const RID &p_rid) {
+
+		for (int i = 0; i < inline_count; i++) {
+			if (inline_rids[i] == p_rid) {
+				// keep the inline part packed, pulling one from the overflow if needed
+				if (overflow.size()) {
+					inline_rids[i] = overflow[overflow.size() - 1];
+					overflow.resize(overflow.size() - 1);
+				} else {
+					inline_rids[i] = inline_rids[--inline_count];
+					inline_rids[inline_count] = RID();
+				}
+				return;
+			}
+		}
+		overflow.erase(p_rid);
+	}
+
+	void clear() {
+
+		for (int i = 0; i < inline_count; i++)
+			inline_rids[i] = RID();
+		inline_count = 0;
+		overflow.clear();
+	}
+
+	void set(const Vector<RID> &p_rids) {
+
+		clear();
+		for (int i = 0; i < p_rids.size(); i++)
+			insert(p_rids[i]);
+	}
+
+	Vector<RID> to_vector() const {
+
+		Vector<RID> ret;
+		ret.resize(size());
+		for (int i = 0; i < ret.size(); i++)
+			ret[i] = get(i);
+		return ret;
+	}
+
+	PhysicsQueryExclude() { inline_count = 0; }
+	PhysicsQueryExclude(const RID &p_rid) {
+		inline_count = 0;
+		insert(p_rid);
+	}
+	PhysicsQueryExclude(const Vector<RID> &p_rids) {
+		inline_count = 0;
+		set(p_rids);
+	}
+};
+
+#endif // PHYSICS_QUERY_EXCLUDE_H
@@ -180,20 +180,12 @@ int PhysicsShapeQueryParameters::get_collision_mask() const {
 
 void PhysicsShapeQueryParameters::set_exclude(const Vector<RID> &p_exclude) {
 
-	exclude.clear();
-	for (int i = 0; i < p_exclude.size(); i++)
-		exclude.insert(p_exclude[i]);
+	exclude.set(p_exclude);
 }
 
 Vector<RID> PhysicsShapeQueryParameters::get_exclude() const {
 
-	Vector<RID> ret;
-	ret.resize(exclude.size());
-	int idx = 0;
-	for (Set<RID>::Element *E = exclude.front(); E; E = E->next()) {
-		ret[idx] = E->get();
-	}
-	return ret;
+	return exclude.to_vector();
 }
 
 void PhysicsShapeQueryParameters::_bind_methods() {
@@ -263,9 +255,7 @@ Variant PhysicsDirectSpaceState::_intersect_shape(const RID& p_shape, const Tran
 Dictionary PhysicsDirectSpaceState::_intersect_ray(const Vector3 &p_from, const Vector3 &p_to, const Vector<RID> &p_exclude, uint32_t p_collision_mask) {
 
 	RayResult inters;
-	Set<RID> exclude;
-	for (int i = 0; i < p_exclude.size(); i++)
-		exclude.insert(p_exclude[i]);
+	PhysicsQueryExclude exclude(p_exclude);
 
 	bool res = intersect_ray(p_from, p_to, inters, exclude, p_collision_mask);
 
@@ -285,9 +275,16 @@ Dictionary PhysicsDirectSpaceState::_intersect_ray(const Vector3 &p_from, const
 
 Array PhysicsDirectSpaceState::_intersect_shape(const Ref<PhysicsShapeQueryParameters> &p_shape_query, int p_max_results) {
 
-	Vector<ShapeResult> sr;
-	sr.resize(p_max_results);
-	int rc = intersect_shape(p_shape_query->shape, p_shape_query->transform, p_shape_query->margin, sr.ptrw(), sr.size(), p_shape_query->exclude, p_shape_query->collision_mask);
+	ERR_FAIL_COND_V(p_max_results < 0, Array());
+
+	ShapeResult stack_results[STACK_RESULT_MAX];
+	Vector<ShapeResult> heap_results;
+	ShapeResult *sr = stack_results;
+	if (p_max_results > STACK_RESULT_MAX) {
+		heap_results.resize(p_max_results);
+		sr = heap_results.ptrw();
+	}
+	int rc = intersect_shape(p_shape_query->shape, p_shape_query->transform, p_shape_query->margin, sr, p_max_results, p_shape_query->exclude, p_shape_query->collision_mask);
 	Array ret;
 	ret.resize(rc);
 	for (int i = 0; i < rc; i++) {
@@ -317,10 +314,17 @@ Array PhysicsDirectSpaceState::_cast_motion(const Ref<PhysicsShapeQueryParameter
 }
 Array PhysicsDirectSpaceState::_collide_shape(const Ref<PhysicsShapeQueryParameters> &p_shape_query, int p_max_results) {
 
-	Vector<Vector3> ret;
-	ret.resize(p_max_results * 2);
+	ERR_FAIL_COND_V(p_max_results < 0, Array());
+
+	Vector3 stack_results[STACK_RESULT_MAX * 2];
+	Vector<Vector3> heap_results;
+	Vector3 *ret = stack_results;
+	if (p_max_results > STACK_RESULT_MAX) {
+		heap_results.resize(p_max_results * 2);
+		ret = heap_results.ptrw();
+	}
 	int rc = 0;
-	bool res = collide_shape(p_shape_query->shape, p_shape_query->transform, p_shape_query->margin, ret.ptrw(), p_max_results, rc, p_shape_query->exclude, p_shape_query->collision_mask);
+	bool res = collide_shape(p_shape_query->shape, p_shape_query->transform, p_shape_query->margin, ret, p_max_results, rc, p_shape_query->exclude, p_shape_query->collision_mask);
 	if (!res)
 		return Array();
 	Array r;
@@ -398,6 +402,25 @@ void PhysicsShapeQueryResult::_bind_methods() {
 
 ///////////////////////////////////////
 
+Array PhysicsServer::_space_get_active_transforms(RID p_space) const {
+
+	const ActiveTransform *transforms = NULL;
+	int count = space_get_active_transforms(p_space, &transforms);
+
+	Array ret;
+	ret.resize(count);
+	for (int i = 0; i < count; i++) {
+
+		Dictionary d;
+		d["collider_id"] = transforms[i].instance_id;
+		d["rid"] = transforms[i].body;
+		d["transform"] = transforms[i].transform;
+		ret[i] = d;
+	}
+
+	return ret;
+}
+
 void PhysicsServer::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("shape_create", "type"), &PhysicsServer::shape_create);
@@ -412,6 +435,9 @@ void PhysicsServer::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("space_set_param", "space", "param", "value"), &PhysicsServer::space_set_param);
 	ClassDB::bind_method(D_METHOD("space_get_param", "space", "param"), &PhysicsServer::space_get_param);
 	ClassDB::bind_method(D_METHOD("space_get_direct_state", "space"), &PhysicsServer::space_get_direct_state);
+	ClassDB::bind_method(D_METHOD("space_get_active_transforms", "space"), &PhysicsServer::_space_get_active_transforms);
+	ClassDB::bind_method(D_METHOD("space_save_state", "space"), &PhysicsServer::space_save_state);
+	ClassDB::bind_method(D_METHOD("space_restore_state", "space", "state"), &PhysicsServer::space_restore_state);
 
 	ClassDB::bind_method(D_METHOD("area_create"), &PhysicsServer::area_create);
 	ClassDB::bind_method(D_METHOD("area_set_space", "area", "space"), &PhysicsServer::area_set_space);
@@ -444,6 +470,7 @@ void PhysicsServer::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("area_get_object_instance_id", "area"), &PhysicsServer::area_get_object_instance_id);
 
 	ClassDB::bind_method(D_METHOD("area_set_monitor_callback", "area", "receiver", "method"), &PhysicsServer::area_set_monitor_callback);
+	ClassDB::bind_method(D_METHOD("area_set_monitor_batching", "area", "enable"), &PhysicsServer::area_set_monitor_batching);
 
 	ClassDB::bind_method(D_METHOD("area_set_ray_pickable", "area", "enable"), &PhysicsServer::area_set_ray_pickable);
 	ClassDB::bind_method(D_METHOD("area_is_ray_pickable", "area"), &PhysicsServer::area_is_ray_pickable);
@@ -716,6 +743,16 @@ void PhysicsServer::_bind_methods() {
 	BIND_ENUM_CONSTANT(INFO_ACTIVE_OBJECTS);
 	BIND_ENUM_CONSTANT(INFO_COLLISION_PAIRS);
 	BIND_ENUM_CONSTANT(INFO_ISLAND_COUNT);
+	BIND_ENUM_CONSTANT(INFO_STEP_TIME);
+	BIND_ENUM_CONSTANT(INFO_BROAD_PHASE_TIME);
+	BIND_ENUM_CONSTANT(INFO_ISLAND_TIME);
+	BIND_ENUM_CONSTANT(INFO_NARROW_PHASE_TIME);
+	BIND_ENUM_CONSTANT(INFO_SOLVER_TIME);
+	BIND_ENUM_CONSTANT(INFO_INTEGRATION_TIME);
+	BIND_ENUM_CONSTANT(INFO_AREA_QUERY_TIME);
+	BIND_ENUM_CONSTANT(INFO_PAIRS_TESTED);
+	BIND_ENUM_CONSTANT(INFO_CONTACT_COUNT);
+	BIND_ENUM_CONSTANT(INFO_CCD_SWEEPS);
 
 	BIND_ENUM_CONSTANT(SPACE_PARAM_CONTACT_RECYCLE_RADIUS);
 	BIND_ENUM_CONSTANT(SPACE_PARAM_CONTACT_MAX_SEPARATION);
@@ -32,6 +32,7 @@
 #define PHYSICS_SERVER_H
 
 #include "object.h"
+#include "physics_query_exclude.h"
 #include "resource.h"
 
 class PhysicsDirectSpaceState;
@@ -108,7 +109,7 @@ class PhysicsShapeQueryParameters : public Reference {
 	RID shape;
 	Transform transform;
 	float margin;
-	Set<RID> exclude;
+	PhysicsQueryExclude exclude;
 	uint32_t collision_mask;
 
 protected:
@@ -139,6 +140,11 @@ class PhysicsDirectSpaceState : public Object {
 	GDCLASS(PhysicsDirectSpaceState, Object);
 
 private:
+	// the script query wrappers keep up to this many results on the stack (the default max_results), larger requests use the heap
+	enum {
+		STACK_RESULT_MAX = 32
+	};
+
 	Dictionary _intersect_ray(const Vector3 &p_from, const Vector3 &p_to, const Vector<RID> &p_exclude = Vector<RID>(), uint32_t p_collision_mask = 0);
 	Array _intersect_shape(const Ref<PhysicsShapeQueryParameters> &p_shape_query, int p_max_results = 32);
 	Array _cast_motion(const Ref<PhysicsShapeQueryParameters> &p_shape_query, const Vector3 &p_motion);
@@ -157,7 +163,7 @@ public:
 		int shape;
 	};
 
-	virtual int intersect_point(const Vector3 &p_point, ShapeResult *r_results, int p_result_max, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF) = 0;
+	virtual int intersect_point(const Vector3 &p_point, ShapeResult *r_results, int p_result_max, const PhysicsQueryExclude &p_exclude = PhysicsQueryExclude(), uint32_t p_collision_mask = 0xFFFFFFFF) = 0;
 
 	struct RayResult {
 
@@ -169,9 +175,9 @@ public:
 		int shape;
 	};
 
-	virtual bool intersect_ray(const Vector3 &p_from, const Vector3 &p_to, RayResult &r_result, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF, bool p_pick_ray = false) = 0;
+	virtual bool intersect_ray(const Vector3 &p_from, const Vector3 &p_to, RayResult &r_result, const PhysicsQueryExclude &p_exclude = PhysicsQueryExclude(), uint32_t p_collision_mask = 0xFFFFFFFF, bool p_pick_ray = false) = 0;
 
-	virtual int intersect_shape(const RID &p_shape, const Transform &p_xform, float p_margin, ShapeResult *r_results, int p_result_max, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF) = 0;
+	virtual int intersect_shape(const RID &p_shape, const Transform &p_xform, float p_margin, ShapeResult *r_results, int p_result_max, const PhysicsQueryExclude &p_exclude = PhysicsQueryExclude(), uint32_t p_collision_mask = 0xFFFFFFFF) = 0;
 
 	struct ShapeRestInfo {
 
@@ -183,11 +189,11 @@ public:
 		Vector3 linear_velocity; //velocity at contact point
 	};
 
-	virtual bool cast_motion(const RID &p_shape, const Transform &p_xform, const Vector3 &p_motion, float p_margin, float &p_closest_safe, float &p_closest_unsafe, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF, ShapeRestInfo *r_info = NULL) = 0;
+	virtual bool cast_motion(const RID &p_shape, const Transform &p_xform, const Vector3 &p_motion, float p_margin, float &p_closest_safe, float &p_closest_unsafe, const PhysicsQueryExclude &p_exclude = PhysicsQueryExclude(), uint32_t p_collision_mask = 0xFFFFFFFF, ShapeRestInfo *r_info = NULL) = 0;
 
-	virtual bool collide_shape(RID p_shape, const Transform &p_shape_xform, float p_margin, Vector3 *r_results, int p_result_max, int &r_result_count, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF) = 0;
+	virtual bool collide_shape(RID p_shape, const Transform &p_shape_xform, float p_margin, Vector3 *r_results, int p_result_max, int &r_result_count, const PhysicsQueryExclude &p_exclude = PhysicsQueryExclude(), uint32_t p_collision_mask = 0xFFFFFFFF) = 0;
 
-	virtual bool rest_info(RID p_shape, const Transform &p_shape_xform, float p_margin, ShapeRestInfo *r_info, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF) = 0;
+	virtual bool rest_info(RID p_shape, const Transform &p_shape_xform, float p_margin, ShapeRestInfo *r_info, const PhysicsQueryExclude &p_exclude = PhysicsQueryExclude(), uint32_t p_collision_mask = 0xFFFFFFFF) = 0;
 
 	virtual Vector3 get_closest_point_to_object_volume(RID p_object, const Vector3 p_point) const = 0;
 
@@ -221,6 +227,8 @@ class PhysicsServer : public Object {
 
 	static PhysicsServer *singleton;
 
+	Array _space_get_active_transforms(RID p_space) const;
+
 protected:
 	static void _bind_methods();
 
@@ -235,7 +243,7 @@ public:
 		SHAPE_CAPSULE, ///< dict( float:"radius", float:"height"):capsule
 		SHAPE_CONVEX_POLYGON, ///< array of planes:"planes"
 		SHAPE_CONCAVE_POLYGON, ///< vector3 array:"triangles" , or Dictionary with "indices" (int array) and "triangles" (Vector3 array)
-		SHAPE_HEIGHTMAP, ///< dict( int:"width", int:"depth",float:"cell_size", float_array:"heights"
+		SHAPE_HEIGHTMAP, ///< dict( int:"width", int:"depth",float:"cell_size", float_array:"heights" ), or dict( rect2:"region", float_array:"heights" ) to update part of an existing map
 		SHAPE_CUSTOM, ///< Server-Implementation based custom shape, calling shape_create() with this value will result in an error
 	};
 
@@ -275,6 +283,19 @@ public:
 	virtual Vector<Vector3> space_get_contacts(RID p_space) const = 0;
 	virtual int space_get_contact_count(RID p_space) const = 0;
 
+	struct ActiveTransform {
+		ObjectID instance_id;
+		RID body;
+		Transform transform;
+	};
+
+	// bodies that moved or changed sleeping state during the last step, filled by flush_queries and valid until the next one
+	virtual int space_get_active_transforms(RID p_space, const ActiveTransform **r_transforms) const = 0;
+
+	// save/restore the simulation state of a space (for rollback), a state can only be restored into the space it was saved from
+	virtual PoolVector<uint8_t> space_save_state(RID p_space) const = 0;
+	virtual Error space_restore_state(RID p_space, const PoolVector<uint8_t> &p_state) = 0;
+
 	//missing space parameters
 
 	/* AREA API */
@@ -337,6 +358,9 @@ public:
 
 	virtual void area_set_monitor_callback(RID p_area, Object *p_receiver, const StringName &p_method) = 0;
 	virtual void area_set_area_monitor_callback(RID p_area, Object *p_receiver, const StringName &p_method) = 0;
+	// when enabled, the monitor callbacks get one PoolIntArray per step instead of one call per event,
+	// with rows of status, instance id, other shape and area shape
+	virtual void area_set_monitor_batching(RID p_area, bool p_enable) = 0;
 
 	virtual void area_set_ray_pickable(RID p_area, bool p_enable) = 0;
 	virtual bool area_is_ray_pickable(RID p_area) const = 0;
@@ -640,13 +664,25 @@ public:
 	virtual void step(float p_step) = 0;
 	virtual void sync() = 0;
 	virtual void flush_queries() = 0;
+	virtual void end_sync() = 0;
 	virtual void finish() = 0;
 
+	// times are reported in microseconds for the last step
 	enum ProcessInfo {
 
 		INFO_ACTIVE_OBJECTS,
 		INFO_COLLISION_PAIRS,
-		INFO_ISLAND_COUNT
+		INFO_ISLAND_COUNT,
+		INFO_STEP_TIME,
+		INFO_BROAD_PHASE_TIME,
+		INFO_ISLAND_TIME,
+		INFO_NARROW_PHASE_TIME,
+		INFO_SOLVER_TIME,
+		INFO_INTEGRATION_TIME,
+		INFO_AREA_QUERY_TIME,
+		INFO_PAIRS_TESTED,
+		INFO_CONTACT_COUNT,
+		INFO_CCD_SWEEPS
 	};
 
 	virtual int get_process_info(ProcessInfo p_info) = 0;
@@ -0,0 +1,81 @@
+/*************************************************************************/
+/*  physics_state_header.h                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef PHYSICS_STATE_HEADER_H
+#define PHYSICS_STATE_HEADER_H
+
+#include "typedefs.h"
+
+/**
+ * Header of the space state snapshots written by SpaceSW and Space2DSW. It is followed by the
+ * body records, area records, body pair, area pair and area2 pair records, then the active list.
+ * Record sizes differ between the 3D and 2D servers, so they are passed in.
+ */
+struct PhysicsStateHeader {
+
+	uint32_t version;
+	uint32_t body_count;
+	uint32_t area_count;
+	uint32_t body_pair_count;
+	uint32_t area_pair_count;
+	uint32_t area2_pair_count;
+	uint32_t active_count;
+	uint32_t padding; // keeps the records 8 byte aligned
+
+	// summed in 64 bits, the counts of a restored snapshot come from user data and must not wrap around
+	uint64_t get_state_size(size_t p_body_size, size_t p_area_size, size_t p_body_pair_size, size_t p_area_pair_size, size_t p_area2_pair_size) const {
+
+		uint64_t size = sizeof(PhysicsStateHeader);
+		size += uint64_t(body_count) * p_body_size;
+		size += uint64_t(area_count) * p_area_size;
+		size += uint64_t(body_pair_count) * p_body_pair_size;
+		size += uint64_t(area_pair_count) * p_area_pair_size;
+		size += uint64_t(area2_pair_count) * p_area2_pair_size;
+		size += uint64_t(active_count) * sizeof(uint32_t);
+		return size;
+	}
+
+	/// Returns the header of a snapshot if it has the expected version and its records fill exactly p_size bytes, NULL otherwise.
+	static const PhysicsStateHeader *validate(const uint8_t *p_data, uint64_t p_size, uint32_t p_version, size_t p_body_size, size_t p_area_size, size_t p_body_pair_size, size_t p_area_pair_size, size_t p_area2_pair_size) {
+
+		if (p_size < sizeof(PhysicsStateHeader))
+			return NULL;
+
+		const PhysicsStateHeader *header = (const PhysicsStateHeader *)p_data;
+		if (header->version != p_version)
+			return NULL;
+		if (header->get_state_size(p_body_size, p_area_size, p_body_pair_size, p_area_pair_size, p_area2_pair_size) != p_size)
+			return NULL;
+
+		return header;
+	}
+};
+
+#endif // PHYSICS_STATE_HEADER_H
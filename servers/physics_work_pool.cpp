@@ -0,0 +1,78 @@
+/*************************************************************************/
+/*  physics_work_pool.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "physics_work_pool.h"
+
+#include "project_settings.h"
+
+Mutex *PhysicsWorkPool::mutex = NULL;
+ThreadWorkPool *PhysicsWorkPool::pool = NULL;
+int PhysicsWorkPool::users = 0;
+
+ThreadWorkPool *PhysicsWorkPool::acquire() {
+
+	MutexLock lock(mutex);
+
+	if (users++ == 0) {
+		pool = memnew(ThreadWorkPool);
+		// 0 uses one thread per core
+		pool->init(GLOBAL_DEF("physics/common/worker_threads", 0));
+	}
+
+	return pool;
+}
+
+void PhysicsWorkPool::release() {
+
+	MutexLock lock(mutex);
+
+	ERR_FAIL_COND(users == 0);
+
+	if (--users == 0) {
+		pool->finish();
+		memdelete(pool);
+		pool = NULL;
+	}
+}
+
+void PhysicsWorkPool::initialize() {
+
+	ERR_FAIL_COND(mutex != NULL);
+	mutex = Mutex::create();
+}
+
+void PhysicsWorkPool::finalize() {
+
+	ERR_FAIL_COND(users != 0);
+	if (mutex) {
+		memdelete(mutex);
+		mutex = NULL;
+	}
+}
@@ -0,0 +1,58 @@
+/*************************************************************************/
+/*  physics_work_pool.h                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef PHYSICS_WORK_POOL_H
+#define PHYSICS_WORK_POOL_H
+
+#include "os/mutex.h"
+#include "os/thread_work_pool.h"
+
+/**
+ * Worker threads shared by the physics servers, so the 2D server and Bullet do not each start
+ * their own. The pool is started by the first acquire() and stopped by the last release(), which
+ * the servers call from init() and finish(). Its size is set by physics/common/worker_threads.
+ * Wrapped servers init and finish on their own threads, so initialize() and finalize() are called
+ * on the main thread around the physics servers to set up the lock guarding the pool.
+ */
+class PhysicsWorkPool {
+
+	static Mutex *mutex;
+	static ThreadWorkPool *pool;
+	static int users;
+
+public:
+	static ThreadWorkPool *acquire();
+	static void release();
+
+	static void initialize();
+	static void finalize();
+};
+
+#endif // PHYSICS_WORK_POOL_H
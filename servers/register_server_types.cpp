@@ -52,6 +52,7 @@
 #include "audio/effects/audio_effect_stereo_enhance.h"
 #include "audio_server.h"
 #include "physics/physics_server_sw.h"
+#include "physics/physics_server_wrap_mt.h"
 #include "physics_2d/physics_2d_server_sw.h"
 #include "physics_2d/physics_2d_server_wrap_mt.h"
 #include "physics_2d_server.h"
@@ -80,7 +81,7 @@ static void _debugger_get_resource_usage(List<ScriptDebuggerRemote::ResourceUsag
 ShaderTypes *shader_types = NULL;
 
 PhysicsServer *_createGodotPhysicsCallback() {
-	return memnew(PhysicsServerSW);
+	return PhysicsServerWrapMT::init_server<PhysicsServerSW>();
 }
 
 Physics2DServer *_createGodotPhysics2DCallback() {
@@ -0,0 +1,357 @@
+/*************************************************************************/
+/*  occlusion_buffer.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "occlusion_buffer.h"
+
+void OcclusionBuffer::set_size(int p_width, int p_height) {
+
+	if (p_width == width && p_height == height)
+		return;
+
+	for (int i = 0; i < level_count; i++) {
+		memdelete_arr(levels[i]);
+	}
+
+	width = p_width;
+	height = p_height;
+	level_count = 0;
+
+	int w = width;
+	int h = height;
+
+	while (level_count < MAX_LEVELS) {
+
+		levels[level_count] = memnew_arr(float, w * h);
+		level_width[level_count] = w;
+		level_height[level_count] = h;
+		level_count++;
+
+		if (w == 1 && h == 1)
+			break;
+
+		w = (w + 1) / 2;
+		h = (h + 1) / 2;
+	}
+}
+
+void OcclusionBuffer::begin(const CameraMatrix &p_projection, const Transform &p_cam_transform) {
+
+	view_projection = p_projection * CameraMatrix(p_cam_transform.affine_inverse());
+	triangle_count = 0;
+}
+
+void OcclusionBuffer::_setup_triangle(const ClipVertex &p_a, const ClipVertex &p_b, const ClipVertex &p_c) {
+
+	const ClipVertex *v[3] = { &p_a, &p_b, &p_c };
+	float x[3], y[3], z[3];
+
+	for (int i = 0; i < 3; i++) {
+		float inv_w = 1.0 / v[i]->w;
+		x[i] = (v[i]->x * inv_w + 1.0) * 0.5 * width;
+		y[i] = (v[i]->y * inv_w + 1.0) * 0.5 * height;
+		z[i] = v[i]->z * inv_w;
+	}
+
+	float det = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+	if (Math::abs(det) < CMP_EPSILON)
+		return; //seen edge on
+
+	float y_min = MIN(y[0], MIN(y[1], y[2]));
+	float y_max = MAX(y[0], MAX(y[1], y[2]));
+	int row_from = (int)Math::ceil(CLAMP(y_min - 0.5, 0, height));
+	int row_to = (int)Math::floor(CLAMP(y_max - 0.5, -1, height - 1));
+	if (row_from > row_to)
+		return;
+
+	if (triangles.size() == triangle_count) {
+		triangles.resize(MAX(triangle_count * 2, 256));
+	}
+
+	Triangle &t = triangles.ptrw()[triangle_count++];
+
+	float sign = det > 0 ? 1.0 : -1.0;
+
+	for (int i = 0; i < 3; i++) {
+
+		int j = (i + 1) % 3;
+		float a = (y[i] - y[j]) * sign;
+		float b = (x[j] - x[i]) * sign;
+		float c = (x[i] * y[j] - x[j] * y[i]) * sign;
+
+		//move the edge in by half a pixel, so only pixels covered whole are drawn
+		t.edge_a[i] = a;
+		t.edge_b[i] = b;
+		t.edge_c[i] = c - (Math::abs(a) + Math::abs(b)) * 0.5;
+	}
+
+	t.zx = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / det;
+	t.zy = ((x[1] - x[0]) * (z[2] - z[0]) - (x[2] - x[0]) * (z[1] - z[0])) / det;
+	//farthest depth in the pixel rather than the one at its center
+	t.z0 = z[0] - t.zx * x[0] - t.zy * y[0] + (Math::abs(t.zx) + Math::abs(t.zy)) * 0.5;
+	t.z_max = MAX(z[0], MAX(z[1], z[2]));
+
+	t.row_from = row_from;
+	t.row_to = row_to;
+}
+
+void OcclusionBuffer::add_triangles(const Transform &p_transform, const Vector3 *p_vertices, int p_vertex_count) {
+
+	CameraMatrix m = view_projection * CameraMatrix(p_transform);
+
+	for (int i = 0; i + 2 < p_vertex_count; i += 3) {
+
+		ClipVertex v[3];
+		for (int j = 0; j < 3; j++) {
+
+			const Vector3 &p = p_vertices[i + j];
+			v[j].x = m.matrix[0][0] * p.x + m.matrix[1][0] * p.y + m.matrix[2][0] * p.z + m.matrix[3][0];
+			v[j].y = m.matrix[0][1] * p.x + m.matrix[1][1] * p.y + m.matrix[2][1] * p.z + m.matrix[3][1];
+			v[j].z = m.matrix[0][2] * p.x + m.matrix[1][2] * p.y + m.matrix[2][2] * p.z + m.matrix[3][2];
+			v[j].w = m.matrix[0][3] * p.x + m.matrix[1][3] * p.y + m.matrix[2][3] * p.z + m.matrix[3][3];
+		}
+
+		//all of it past one of the sides of the view
+		if ((v[0].x > v[0].w && v[1].x > v[1].w && v[2].x > v[2].w) || (v[0].x < -v[0].w && v[1].x < -v[1].w && v[2].x < -v[2].w))
+			continue;
+		if ((v[0].y > v[0].w && v[1].y > v[1].w && v[2].y > v[2].w) || (v[0].y < -v[0].w && v[1].y < -v[1].w && v[2].y < -v[2].w))
+			continue;
+		if (v[0].z > v[0].w && v[1].z > v[1].w && v[2].z > v[2].w)
+			continue;
+
+		float d[3] = { v[0].z + v[0].w, v[1].z + v[1].w, v[2].z + v[2].w };
+		int in_front = (d[0] >= 0) + (d[1] >= 0) + (d[2] >= 0);
+
+		if (in_front == 3) {
+			_setup_triangle(v[0], v[1], v[2]);
+			continue;
+		} else if (in_front == 0) {
+			continue;
+		}
+
+		//clip against the near plane, which leaves a triangle or a quad
+		ClipVertex polygon[4];
+		int count = 0;
+
+		for (int j = 0; j < 3; j++) {
+
+			int k = (j + 1) % 3;
+			if (d[j] >= 0) {
+				polygon[count++] = v[j];
+			}
+			if ((d[j] >= 0) != (d[k] >= 0)) {
+				float t = d[j] / (d[j] - d[k]);
+				ClipVertex &r = polygon[count++];
+				r.x = v[j].x + (v[k].x - v[j].x) * t;
+				r.y = v[j].y + (v[k].y - v[j].y) * t;
+				r.z = v[j].z + (v[k].z - v[j].z) * t;
+				r.w = v[j].w + (v[k].w - v[j].w) * t;
+			}
+		}
+
+		for (int j = 1; j + 1 < count; j++) {
+			_setup_triangle(polygon[0], polygon[j], polygon[j + 1]);
+		}
+	}
+}
+
+void OcclusionBuffer::_rasterize_band(uint32_t p_band, const Triangle *p_triangles) {
+
+	int band_from = p_band * BAND_HEIGHT;
+	int band_to = MIN(band_from + (int)BAND_HEIGHT, height) - 1;
+	float *depth = levels[0];
+
+	for (int i = band_from * width; i < (band_to + 1) * width; i++) {
+		depth[i] = 1.0;
+	}
+
+	for (int i = 0; i < triangle_count; i++) {
+
+		const Triangle &t = p_triangles[i];
+		if (t.row_to < band_from || t.row_from > band_to)
+			continue;
+
+		int row_from = MAX(t.row_from, band_from);
+		int row_to = MIN(t.row_to, band_to);
+
+		for (int y = row_from; y <= row_to; y++) {
+
+			float cy = y + 0.5;
+
+			//span of the pixel centers inside the three edges
+			float span_from = 0;
+			float span_to = width;
+			bool empty = false;
+
+			for (int e = 0; e < 3; e++) {
+
+				float k = t.edge_b[e] * cy + t.edge_c[e];
+				if (t.edge_a[e] > 0) {
+					span_from = MAX(span_from, -k / t.edge_a[e]);
+				} else if (t.edge_a[e] < 0) {
+					span_to = MIN(span_to, -k / t.edge_a[e]);
+				} else if (k < 0) {
+					empty = true;
+				}
+			}
+
+			if (empty || span_from > span_to)
+				continue;
+
+			int x_from = (int)Math::ceil(span_from - 0.5);
+			int x_to = MIN((int)Math::floor(span_to - 0.5), width - 1);
+
+			//plain loop over the row, left for the compiler to vectorize
+			float *row = depth + y * width;
+			float z_row = t.z0 + t.zy * cy;
+			float z_max = t.z_max;
+			float zx = t.zx;
+
+			for (int x = x_from; x <= x_to; x++) {
+				float z = MIN(z_row + zx * (x + 0.5f), z_max);
+				row[x] = MIN(row[x], z);
+			}
+		}
+	}
+}
+
+void OcclusionBuffer::_build_levels() {
+
+	for (int l = 1; l < level_count; l++) {
+
+		const float *src = levels[l - 1];
+		int src_w = level_width[l - 1];
+		int src_h = level_height[l - 1];
+
+		float *dst = levels[l];
+		int dst_w = level_width[l];
+		int dst_h = level_height[l];
+
+		for (int y = 0; y < dst_h; y++) {
+
+			const float *row_a = src + (y * 2) * src_w;
+			const float *row_b = src + MIN(y * 2 + 1, src_h - 1) * src_w;
+
+			for (int x = 0; x < dst_w; x++) {
+
+				int x_a = x * 2;
+				int x_b = MIN(x_a + 1, src_w - 1);
+				dst[y * dst_w + x] = MAX(MAX(row_a[x_a], row_a[x_b]), MAX(row_b[x_a], row_b[x_b]));
+			}
+		}
+	}
+}
+
+void OcclusionBuffer::rasterize(ThreadWorkPool &p_work_pool) {
+
+	if (triangle_count == 0)
+		return;
+
+	int band_count = (height + BAND_HEIGHT - 1) / BAND_HEIGHT;
+	p_work_pool.do_work(band_count, this, &OcclusionBuffer::_rasterize_band, (const Triangle *)triangles.ptr());
+
+	_build_levels();
+}
+
+bool OcclusionBuffer::is_occluded(const AABB &p_aabb) const {
+
+	if (triangle_count == 0)
+		return false;
+
+	float x_min = 1e20, y_min = 1e20, z_min = 1e20;
+	float x_max = -1e20, y_max = -1e20;
+
+	for (int i = 0; i < 8; i++) {
+
+		Vector3 p = p_aabb.get_endpoint(i);
+		const real_t(*m)[4] = view_projection.matrix;
+
+		float z = m[0][2] * p.x + m[1][2] * p.y + m[2][2] * p.z + m[3][2];
+		float w = m[0][3] * p.x + m[1][3] * p.y + m[2][3] * p.z + m[3][3];
+		if (z < -w)
+			return false; //reaches in front of the near plane
+
+		float inv_w = 1.0 / w;
+		float x = (m[0][0] * p.x + m[1][0] * p.y + m[2][0] * p.z + m[3][0]) * inv_w;
+		float y = (m[0][1] * p.x + m[1][1] * p.y + m[2][1] * p.z + m[3][1]) * inv_w;
+
+		x_min = MIN(x_min, x);
+		x_max = MAX(x_max, x);
+		y_min = MIN(y_min, y);
+		y_max = MAX(y_max, y);
+		z_min = MIN(z_min, z * inv_w);
+	}
+
+	int from_x = (int)Math::floor((CLAMP(x_min, -1, 1) + 1.0) * 0.5 * width);
+	int to_x = (int)Math::floor((CLAMP(x_max, -1, 1) + 1.0) * 0.5 * width);
+	int from_y = (int)Math::floor((CLAMP(y_min, -1, 1) + 1.0) * 0.5 * height);
+	int to_y = (int)Math::floor((CLAMP(y_max, -1, 1) + 1.0) * 0.5 * height);
+
+	from_x = MIN(from_x, width - 1);
+	to_x = MIN(to_x, width - 1);
+	from_y = MIN(from_y, height - 1);
+	to_y = MIN(to_y, height - 1);
+
+	//coarsest level where the box covers a few texels
+	int level = 0;
+	while (level < level_count - 1 && (to_x - from_x > 3 || to_y - from_y > 3)) {
+		from_x >>= 1;
+		to_x >>= 1;
+		from_y >>= 1;
+		to_y >>= 1;
+		level++;
+	}
+
+	const float *depth = levels[level];
+	int w = level_width[level];
+
+	for (int y = from_y; y <= to_y; y++) {
+		for (int x = from_x; x <= to_x; x++) {
+			if (depth[y * w + x] >= z_min)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+OcclusionBuffer::OcclusionBuffer() {
+
+	width = 0;
+	height = 0;
+	level_count = 0;
+	triangle_count = 0;
+}
+
+OcclusionBuffer::~OcclusionBuffer() {
+
+	for (int i = 0; i < level_count; i++) {
+		memdelete_arr(levels[i]);
+	}
+}
@@ -0,0 +1,103 @@
+/*************************************************************************/
+/*  occlusion_buffer.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef OCCLUSION_BUFFER_H
+#define OCCLUSION_BUFFER_H
+
+#include "camera_matrix.h"
+#include "os/thread_work_pool.h"
+#include "vector.h"
+
+/*
+	Low resolution depth buffer, drawn on the CPU from the occluders in view
+	and reduced to a hierarchy of the farthest depth of each block, so boxes
+	are tested against a handful of texels whatever their size.
+
+	Occluders only cover the pixels they cover completely, at the farthest
+	depth they have in them, so a box is never reported hidden when a part
+	of it could be seen.
+*/
+
+class OcclusionBuffer {
+public:
+	enum {
+		BAND_HEIGHT = 16, //rows drawn by each job
+		MAX_LEVELS = 16
+	};
+
+	struct Triangle {
+
+		float edge_a[3], edge_b[3], edge_c[3]; //inside where a * x + b * y + c >= 0 over the whole pixel
+		float z0, zx, zy; //depth of the farthest point in the pixel at x, y
+		float z_max;
+		int row_from, row_to;
+	};
+
+private:
+	struct ClipVertex {
+		float x, y, z, w;
+	};
+
+	int width;
+	int height;
+
+	float *levels[MAX_LEVELS]; //normalized device depth, 1 is nothing
+	int level_width[MAX_LEVELS];
+	int level_height[MAX_LEVELS];
+	int level_count;
+
+	CameraMatrix view_projection;
+
+	Vector<Triangle> triangles; //grow only, kept between frames
+	int triangle_count;
+
+	void _setup_triangle(const ClipVertex &p_a, const ClipVertex &p_b, const ClipVertex &p_c);
+	void _rasterize_band(uint32_t p_band, const Triangle *p_triangles);
+	void _build_levels();
+
+public:
+	void set_size(int p_width, int p_height);
+	_FORCE_INLINE_ int get_width() const { return width; }
+	_FORCE_INLINE_ int get_height() const { return height; }
+
+	void begin(const CameraMatrix &p_projection, const Transform &p_cam_transform);
+	void add_triangles(const Transform &p_transform, const Vector3 *p_vertices, int p_vertex_count);
+	void rasterize(ThreadWorkPool &p_work_pool);
+
+	_FORCE_INLINE_ int get_triangle_count() const { return triangle_count; }
+	_FORCE_INLINE_ const float *get_depth() const { return levels[0]; }
+
+	bool is_occluded(const AABB &p_aabb) const;
+
+	OcclusionBuffer();
+	~OcclusionBuffer();
+};
+
+#endif // OCCLUSION_BUFFER_H
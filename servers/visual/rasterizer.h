@@ -288,6 +288,7 @@ public:
 	virtual void multimesh_instance_set_transform(RID p_multimesh, int p_index, const Transform &p_transform) = 0;
 	virtual void multimesh_instance_set_transform_2d(RID p_multimesh, int p_index, const Transform2D &p_transform) = 0;
 	virtual void multimesh_instance_set_color(RID p_multimesh, int p_index, const Color &p_color) = 0;
+	virtual void multimesh_set_instance_range(RID p_multimesh, int p_from, const PoolVector<float> &p_data) = 0;
 
 	virtual RID multimesh_get_mesh(RID p_multimesh) const = 0;
 
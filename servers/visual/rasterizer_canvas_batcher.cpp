@@ -0,0 +1,512 @@
+/*************************************************************************/
+/*  rasterizer_canvas_batcher.cpp                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "rasterizer_canvas_batcher.h"
+
+bool RasterizerCanvasBatcher::_get_texture(const RID &p_texture, Size2 &r_size, bool &r_repeat) {
+
+	if (!p_texture.is_valid())
+		return false;
+
+	if (p_texture != texture_cache) {
+		texture_cache = p_texture;
+		texture_cache_valid = _get_texture_info(p_texture, texture_cache_size, texture_cache_repeat);
+	}
+
+	r_size = texture_cache_size;
+	r_repeat = texture_cache_repeat;
+	return texture_cache_valid;
+}
+
+bool RasterizerCanvasBatcher::_is_item_batchable(Item *p_item, int p_z, Light *p_light) {
+
+	if (p_item->copy_back_buffer || p_item->distance_field || p_item->light_masked)
+		return false;
+
+	Item *material_owner = p_item->material_owner ? p_item->material_owner : p_item;
+	if (material_owner->material.is_valid())
+		return false; //custom shaders may use the vertex, transforms or modulate
+
+	for (Light *light = p_light; light; light = light->next_ptr) {
+
+		if (p_item->light_mask & light->item_mask && p_z >= light->z_min && p_z <= light->z_max && p_item->global_rect_cache.intersects_transformed(light->xform_cache, light->rect_cache))
+			return false; //drawn again for each light
+	}
+
+	int cc = p_item->commands.size();
+	const Item::Command *const *commands = p_item->commands.ptr();
+
+	for (int i = 0; i < cc; i++) {
+
+		const Item::Command *c = commands[i];
+
+		switch (c->type) {
+
+			case Item::Command::TYPE_RECT: {
+
+				const Item::CommandRect *rect = static_cast<const Item::CommandRect *>(c);
+
+				if (rect->flags & (RasterizerCanvas::CANVAS_RECT_TILE | RasterizerCanvas::CANVAS_RECT_CLIP_UV)) {
+
+					Size2 texture_size;
+					bool repeat;
+
+					if (_get_texture(rect->texture, texture_size, repeat)) {
+
+						if (rect->flags & RasterizerCanvas::CANVAS_RECT_CLIP_UV)
+							return false; //clamped in the shader
+						if (!repeat)
+							return false; //needs the wrap mode changed
+					}
+				}
+			} break;
+			case Item::Command::TYPE_NINEPATCH: {
+
+				const Item::CommandNinePatch *np = static_cast<const Item::CommandNinePatch *>(c);
+
+				if (np->axis_x != VS::NINE_PATCH_STRETCH || np->axis_y != VS::NINE_PATCH_STRETCH)
+					return false;
+			} break;
+			case Item::Command::TYPE_POLYGON: {
+
+				const Item::CommandPolygon *polygon = static_cast<const Item::CommandPolygon *>(c);
+
+				int point_count = polygon->points.size();
+
+				if (polygon->antialiased || point_count > MAX_BATCH_VERTICES || polygon->count > polygon->indices.size())
+					return false;
+				if (polygon->colors.size() > 1 && polygon->colors.size() < point_count)
+					return false;
+				if (polygon->uvs.size() && polygon->uvs.size() < point_count)
+					return false;
+
+				const int *idx = polygon->indices.ptr();
+				for (int j = 0; j < polygon->count; j++) {
+					if (idx[j] < 0 || idx[j] >= point_count)
+						return false;
+				}
+			} break;
+			case Item::Command::TYPE_CIRCLE:
+			case Item::Command::TYPE_TRANSFORM: {
+
+			} break;
+			default: {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+RasterizerCanvasBatcher::Batch *RasterizerCanvasBatcher::_push_batch() {
+
+	if (batch_count == batch_max) {
+		batch_max = batch_max ? batch_max * 2 : 256;
+		batches = (Batch *)memrealloc(batches, sizeof(Batch) * batch_max);
+	}
+
+	return &batches[batch_count++];
+}
+
+int RasterizerCanvasBatcher::_add_geometry(Item *p_item, const RID &p_texture, int p_vertex_count, int p_index_count) {
+
+	Batch *batch = geometry_batch >= 0 ? &batches[geometry_batch] : NULL;
+
+	if (!batch || batch->texture != p_texture || batch->clip_owner != p_item->final_clip_owner || batch->vertex_count + p_vertex_count > MAX_BATCH_VERTICES) {
+
+		batch = _push_batch();
+		batch->type = BATCH_GEOMETRY;
+		batch->item = p_item;
+		batch->clip_owner = p_item->final_clip_owner;
+		batch->texture = p_texture;
+		batch->first_vertex = vertex_count;
+		batch->vertex_count = 0;
+		batch->first_index = index_count;
+		batch->index_count = 0;
+		batch->item_count = 0;
+
+		geometry_batch = batch_count - 1;
+		geometry_item = NULL;
+	}
+
+	if (geometry_item != p_item) {
+		batch->item_count++;
+		geometry_item = p_item;
+	}
+
+	if (vertex_count + p_vertex_count > vertex_max) {
+		vertex_max = MAX(vertex_max * 2, MAX(vertex_count + p_vertex_count, 1024));
+		vertices = (Vertex *)memrealloc(vertices, sizeof(Vertex) * vertex_max);
+	}
+
+	if (index_count + p_index_count > index_max) {
+		index_max = MAX(index_max * 2, MAX(index_count + p_index_count, 1536));
+		indices = (uint16_t *)memrealloc(indices, sizeof(uint16_t) * index_max);
+	}
+
+	int base = batch->vertex_count;
+
+	batch->vertex_count += p_vertex_count;
+	batch->index_count += p_index_count;
+	vertex_count += p_vertex_count;
+	index_count += p_index_count;
+
+	return base;
+}
+
+void RasterizerCanvasBatcher::_set_vertex(Vertex *r_vertex, const Transform2D &p_xform, const Vector2 &p_pos, const Vector2 &p_uv, const Color &p_color) {
+
+	Vector2 pos = p_xform.xform(p_pos);
+
+	r_vertex->position[0] = pos.x;
+	r_vertex->position[1] = pos.y;
+	r_vertex->uv[0] = p_uv.x;
+	r_vertex->uv[1] = p_uv.y;
+	r_vertex->color[0] = p_color.r;
+	r_vertex->color[1] = p_color.g;
+	r_vertex->color[2] = p_color.b;
+	r_vertex->color[3] = p_color.a;
+}
+
+void RasterizerCanvasBatcher::_add_quad(Item *p_item, const RID &p_texture, const Transform2D &p_xform, const Vector2 *p_pos, const Vector2 *p_uv, const Color &p_color) {
+
+	int base = _add_geometry(p_item, p_texture, 4, 6);
+
+	Vertex *v = &vertices[vertex_count - 4];
+	for (int i = 0; i < 4; i++) {
+		_set_vertex(&v[i], p_xform, p_pos[i], p_uv[i], p_color);
+	}
+
+	//same winding as the triangle fan used for single rects
+	uint16_t *idx = &indices[index_count - 6];
+	idx[0] = base;
+	idx[1] = base + 1;
+	idx[2] = base + 2;
+	idx[3] = base;
+	idx[4] = base + 2;
+	idx[5] = base + 3;
+}
+
+void RasterizerCanvasBatcher::_add_rect(Item *p_item, const Item::CommandRect *p_rect, const Transform2D &p_xform, const Color &p_modulate) {
+
+	Rect2 dst_rect = p_rect->rect;
+
+	if (dst_rect.size.width < 0) {
+		dst_rect.position.x += dst_rect.size.width;
+		dst_rect.size.width *= -1;
+	}
+	if (dst_rect.size.height < 0) {
+		dst_rect.position.y += dst_rect.size.height;
+		dst_rect.size.height *= -1;
+	}
+
+	RID texture;
+	Size2 texture_size;
+	bool repeat;
+	Rect2 src_rect(0, 0, 1, 1);
+	bool transpose = false;
+
+	if (_get_texture(p_rect->texture, texture_size, repeat)) {
+
+		texture = p_rect->texture;
+
+		if (p_rect->flags & RasterizerCanvas::CANVAS_RECT_REGION) {
+			Size2 texpixel_size(1.0 / texture_size.width, 1.0 / texture_size.height);
+			src_rect = Rect2(p_rect->source.position * texpixel_size, p_rect->source.size * texpixel_size);
+		}
+
+		if (p_rect->flags & RasterizerCanvas::CANVAS_RECT_FLIP_H) {
+			src_rect.size.x *= -1;
+		}
+		if (p_rect->flags & RasterizerCanvas::CANVAS_RECT_FLIP_V) {
+			src_rect.size.y *= -1;
+		}
+
+		transpose = p_rect->flags & RasterizerCanvas::CANVAS_RECT_TRANSPOSE;
+	}
+
+	//same mapping as the texture rect shader, a negative source size mirrors the geometry
+	Vector2 src_size = src_rect.size.abs();
+	Vector2 pos[4];
+	Vector2 uv[4];
+
+	for (int i = 0; i < 4; i++) {
+
+		Vector2 corner(i >= 2 ? 1 : 0, i == 1 || i == 2 ? 1 : 0);
+
+		uv[i] = src_rect.position + src_size * (transpose ? Vector2(corner.y, corner.x) : corner);
+		pos[i] = dst_rect.position + dst_rect.size * Vector2(src_rect.size.x < 0 ? 1 - corner.x : corner.x, src_rect.size.y < 0 ? 1 - corner.y : corner.y);
+	}
+
+	_add_quad(p_item, texture, p_xform, pos, uv, p_rect->modulate * p_modulate);
+}
+
+static void _nine_patch_axis_spans(float p_draw_size, float p_texpixel_size, float p_margin_begin, float p_margin_end, float *r_pos, float *r_uv_begin, float *r_uv_end) {
+
+	//map_ninepatch_axis() in the canvas shader is linear over these three spans when stretching
+	float tex_size = 1.0 / p_texpixel_size;
+
+	r_pos[0] = 0;
+	r_pos[1] = MIN(p_margin_begin, p_draw_size);
+	r_pos[2] = MAX(p_draw_size - p_margin_end, r_pos[1]);
+	r_pos[3] = p_draw_size;
+
+	r_uv_begin[0] = 0;
+	r_uv_end[0] = r_pos[1] * p_texpixel_size;
+
+	r_uv_begin[1] = p_margin_begin * p_texpixel_size;
+	r_uv_end[1] = (tex_size - p_margin_end) * p_texpixel_size;
+
+	r_uv_begin[2] = (tex_size - (p_draw_size - r_pos[2])) * p_texpixel_size;
+	r_uv_end[2] = tex_size * p_texpixel_size;
+}
+
+void RasterizerCanvasBatcher::_add_nine_patch(Item *p_item, const Item::CommandNinePatch *p_np, const Transform2D &p_xform, const Color &p_modulate) {
+
+	RID texture;
+	Size2 texture_size;
+	bool repeat;
+	Size2 texpixel_size(1, 1);
+	Rect2 src_rect(0, 0, 1, 1);
+
+	if (_get_texture(p_np->texture, texture_size, repeat)) {
+
+		texture = p_np->texture;
+
+		if (p_np->source != Rect2()) {
+			texpixel_size = Size2(1.0 / p_np->source.size.width, 1.0 / p_np->source.size.height);
+			src_rect = Rect2(p_np->source.position.x / texture_size.width, p_np->source.position.y / texture_size.height, p_np->source.size.x / texture_size.width, p_np->source.size.y / texture_size.height);
+		} else {
+			texpixel_size = Size2(1.0 / texture_size.width, 1.0 / texture_size.height);
+		}
+	}
+
+	float x[4], u_begin[3], u_end[3];
+	float y[4], v_begin[3], v_end[3];
+	_nine_patch_axis_spans(ABS(p_np->rect.size.x), texpixel_size.x, p_np->margin[MARGIN_LEFT], p_np->margin[MARGIN_RIGHT], x, u_begin, u_end);
+	_nine_patch_axis_spans(ABS(p_np->rect.size.y), texpixel_size.y, p_np->margin[MARGIN_TOP], p_np->margin[MARGIN_BOTTOM], y, v_begin, v_end);
+
+	Color color = p_np->color * p_modulate;
+
+	for (int j = 0; j < 3; j++) {
+
+		if (y[j + 1] <= y[j])
+			continue;
+
+		for (int i = 0; i < 3; i++) {
+
+			if (x[i + 1] <= x[i])
+				continue;
+			if (i == 1 && j == 1 && !p_np->draw_center)
+				continue;
+
+			Vector2 pos[4] = {
+				p_np->rect.position + Vector2(x[i], y[j]),
+				p_np->rect.position + Vector2(x[i], y[j + 1]),
+				p_np->rect.position + Vector2(x[i + 1], y[j + 1]),
+				p_np->rect.position + Vector2(x[i + 1], y[j])
+			};
+
+			Vector2 uv[4] = {
+				src_rect.position + Vector2(u_begin[i], v_begin[j]) * src_rect.size,
+				src_rect.position + Vector2(u_begin[i], v_end[j]) * src_rect.size,
+				src_rect.position + Vector2(u_end[i], v_end[j]) * src_rect.size,
+				src_rect.position + Vector2(u_end[i], v_begin[j]) * src_rect.size
+			};
+
+			_add_quad(p_item, texture, p_xform, pos, uv, color);
+		}
+	}
+}
+
+void RasterizerCanvasBatcher::_add_polygon(Item *p_item, const Item::CommandPolygon *p_polygon, const Transform2D &p_xform, const Color &p_modulate) {
+
+	int point_count = p_polygon->points.size();
+
+	if (point_count == 0 || p_polygon->count == 0)
+		return;
+
+	RID texture;
+	Size2 texture_size;
+	bool repeat;
+
+	if (_get_texture(p_polygon->texture, texture_size, repeat)) {
+		texture = p_polygon->texture;
+	}
+
+	int base = _add_geometry(p_item, texture, point_count, p_polygon->count);
+
+	const Vector2 *points = p_polygon->points.ptr();
+	const Vector2 *uvs = p_polygon->uvs.size() ? p_polygon->uvs.ptr() : NULL;
+	const Color *colors = p_polygon->colors.size() > 1 ? p_polygon->colors.ptr() : NULL;
+	Color color = p_polygon->colors.size() == 1 ? p_polygon->colors[0] * p_modulate : p_modulate;
+
+	Vertex *v = &vertices[vertex_count - point_count];
+	for (int i = 0; i < point_count; i++) {
+		_set_vertex(&v[i], p_xform, points[i], uvs ? uvs[i] : Vector2(), colors ? colors[i] * p_modulate : color);
+	}
+
+	const int *polygon_indices = p_polygon->indices.ptr();
+	uint16_t *idx = &indices[index_count - p_polygon->count];
+	for (int i = 0; i < p_polygon->count; i++) {
+		idx[i] = base + polygon_indices[i];
+	}
+}
+
+void RasterizerCanvasBatcher::_add_circle(Item *p_item, const Item::CommandCircle *p_circle, const Transform2D &p_xform, const Color &p_modulate) {
+
+	static const int numpoints = 32;
+
+	int base = _add_geometry(p_item, RID(), numpoints + 1, numpoints * 3);
+
+	Color color = p_circle->color * p_modulate;
+	Vertex *v = &vertices[vertex_count - (numpoints + 1)];
+	uint16_t *idx = &indices[index_count - numpoints * 3];
+
+	for (int i = 0; i < numpoints; i++) {
+
+		Vector2 point = p_circle->pos + Vector2(Math::sin(i * Math_PI * 2.0 / numpoints), Math::cos(i * Math_PI * 2.0 / numpoints)) * p_circle->radius;
+		_set_vertex(&v[i], p_xform, point, Vector2(), color);
+
+		idx[i * 3 + 0] = base + i;
+		idx[i * 3 + 1] = base + (i + 1) % numpoints;
+		idx[i * 3 + 2] = base + numpoints;
+	}
+
+	_set_vertex(&v[numpoints], p_xform, p_circle->pos, Vector2(), color);
+}
+
+void RasterizerCanvasBatcher::build(Item *p_item_list, int p_z, const Color &p_modulate, Light *p_light) {
+
+	batch_count = 0;
+	vertex_count = 0;
+	index_count = 0;
+
+	geometry_batch = -1;
+	geometry_item = NULL;
+
+	//resources may have been freed since the last build
+	texture_cache = RID();
+
+	for (Item *ci = p_item_list; ci; ci = ci->next) {
+
+		if (!enabled || !_is_item_batchable(ci, p_z, p_light)) {
+
+			Batch *batch = _push_batch();
+			batch->type = BATCH_ITEM;
+			batch->item = ci;
+			batch->clip_owner = ci->final_clip_owner;
+			batch->texture = RID();
+			batch->first_vertex = 0;
+			batch->vertex_count = 0;
+			batch->first_index = 0;
+			batch->index_count = 0;
+			batch->item_count = 1;
+
+			geometry_batch = -1;
+			continue;
+		}
+
+		Color modulate(ci->final_modulate.r * p_modulate.r, ci->final_modulate.g * p_modulate.g, ci->final_modulate.b * p_modulate.b, ci->final_modulate.a * p_modulate.a);
+
+		if (modulate.a <= 0.001)
+			continue; //would not be drawn
+
+		Transform2D xform = ci->final_transform;
+
+		int cc = ci->commands.size();
+		Item::Command *const *commands = ci->commands.ptr();
+
+		for (int i = 0; i < cc; i++) {
+
+			const Item::Command *c = commands[i];
+
+			switch (c->type) {
+
+				case Item::Command::TYPE_RECT: {
+
+					_add_rect(ci, static_cast<const Item::CommandRect *>(c), xform, modulate);
+				} break;
+				case Item::Command::TYPE_NINEPATCH: {
+
+					_add_nine_patch(ci, static_cast<const Item::CommandNinePatch *>(c), xform, modulate);
+				} break;
+				case Item::Command::TYPE_POLYGON: {
+
+					_add_polygon(ci, static_cast<const Item::CommandPolygon *>(c), xform, modulate);
+				} break;
+				case Item::Command::TYPE_CIRCLE: {
+
+					_add_circle(ci, static_cast<const Item::CommandCircle *>(c), xform, modulate);
+				} break;
+				case Item::Command::TYPE_TRANSFORM: {
+
+					xform = ci->final_transform * static_cast<const Item::CommandTransform *>(c)->xform;
+				} break;
+				default: {
+				}
+			}
+		}
+	}
+}
+
+RasterizerCanvasBatcher::RasterizerCanvasBatcher() {
+
+	enabled = true;
+
+	batches = NULL;
+	batch_count = 0;
+	batch_max = 0;
+
+	vertices = NULL;
+	vertex_count = 0;
+	vertex_max = 0;
+
+	indices = NULL;
+	index_count = 0;
+	index_max = 0;
+
+	geometry_batch = -1;
+	geometry_item = NULL;
+
+	texture_cache_repeat = false;
+	texture_cache_valid = false;
+}
+
+RasterizerCanvasBatcher::~RasterizerCanvasBatcher() {
+
+	if (batches)
+		memfree(batches);
+	if (vertices)
+		memfree(vertices);
+	if (indices)
+		memfree(indices);
+}
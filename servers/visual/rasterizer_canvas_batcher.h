@@ -0,0 +1,138 @@
+/*************************************************************************/
+/*  rasterizer_canvas_batcher.h                                          */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef RASTERIZERCANVASBATCHER_H
+#define RASTERIZERCANVASBATCHER_H
+
+#include "servers/visual/rasterizer.h"
+
+/*
+	Splits a list of canvas items into batches for the renderer.
+
+	Consecutive items drawn with the default shader and made of rects,
+	stretched nine patches, polygons and circles are merged into triangle
+	batches, already transformed to canvas space and modulated, one batch
+	per texture and clip. Every other item is passed through, to be drawn
+	as before.
+*/
+
+class RasterizerCanvasBatcher {
+public:
+	typedef RasterizerCanvas::Item Item;
+	typedef RasterizerCanvas::Light Light;
+
+	enum {
+		MAX_BATCH_VERTICES = 65536 // indices are 16 bits, relative to the batch
+	};
+
+	struct Vertex {
+
+		float position[2];
+		float uv[2];
+		float color[4];
+	};
+
+	enum BatchType {
+		BATCH_ITEM,
+		BATCH_GEOMETRY
+	};
+
+	struct Batch {
+
+		BatchType type;
+		Item *item; //item drawn, or first item in the geometry
+		Item *clip_owner;
+		RID texture;
+		int first_vertex;
+		int vertex_count;
+		int first_index;
+		int index_count;
+		int item_count;
+	};
+
+protected:
+	//textures are owned by the renderer, return false for those drawn as plain white
+	virtual bool _get_texture_info(const RID &p_texture, Size2 &r_size, bool &r_repeat) = 0;
+
+private:
+	bool enabled;
+
+	Batch *batches;
+	int batch_count;
+	int batch_max;
+
+	Vertex *vertices;
+	int vertex_count;
+	int vertex_max;
+
+	uint16_t *indices;
+	int index_count;
+	int index_max;
+
+	int geometry_batch;
+	Item *geometry_item;
+
+	RID texture_cache;
+	Size2 texture_cache_size;
+	bool texture_cache_repeat;
+	bool texture_cache_valid;
+
+	_FORCE_INLINE_ bool _get_texture(const RID &p_texture, Size2 &r_size, bool &r_repeat);
+
+	bool _is_item_batchable(Item *p_item, int p_z, Light *p_light);
+	Batch *_push_batch();
+	int _add_geometry(Item *p_item, const RID &p_texture, int p_vertex_count, int p_index_count);
+
+	_FORCE_INLINE_ void _set_vertex(Vertex *r_vertex, const Transform2D &p_xform, const Vector2 &p_pos, const Vector2 &p_uv, const Color &p_color);
+	void _add_quad(Item *p_item, const RID &p_texture, const Transform2D &p_xform, const Vector2 *p_pos, const Vector2 *p_uv, const Color &p_color);
+
+	void _add_rect(Item *p_item, const Item::CommandRect *p_rect, const Transform2D &p_xform, const Color &p_modulate);
+	void _add_nine_patch(Item *p_item, const Item::CommandNinePatch *p_np, const Transform2D &p_xform, const Color &p_modulate);
+	void _add_polygon(Item *p_item, const Item::CommandPolygon *p_polygon, const Transform2D &p_xform, const Color &p_modulate);
+	void _add_circle(Item *p_item, const Item::CommandCircle *p_circle, const Transform2D &p_xform, const Color &p_modulate);
+
+public:
+	void set_enabled(bool p_enabled) { enabled = p_enabled; }
+	bool is_enabled() const { return enabled; }
+
+	void build(Item *p_item_list, int p_z, const Color &p_modulate, Light *p_light);
+
+	_FORCE_INLINE_ const Batch *get_batches() const { return batches; }
+	_FORCE_INLINE_ int get_batch_count() const { return batch_count; }
+	_FORCE_INLINE_ const Vertex *get_vertices() const { return vertices; }
+	_FORCE_INLINE_ int get_vertex_count() const { return vertex_count; }
+	_FORCE_INLINE_ const uint16_t *get_indices() const { return indices; }
+	_FORCE_INLINE_ int get_index_count() const { return index_count; }
+
+	RasterizerCanvasBatcher();
+	virtual ~RasterizerCanvasBatcher();
+};
+
+#endif // RASTERIZERCANVASBATCHER_H
@@ -59,6 +59,7 @@ void VisualServerCanvas::_render_canvas_item(Item *p_canvas_item, const Transfor
 
 		p_canvas_item->child_items.sort_custom<ItemIndexSort>();
 		p_canvas_item->children_order_dirty = false;
+		p_canvas_item->child_index_dirty = true;
 	}
 
 	Rect2 rect = ci->get_rect();
@@ -79,8 +80,33 @@ void VisualServerCanvas::_render_canvas_item(Item *p_canvas_item, const Transfor
 		return;
 
 	int child_item_count = ci->child_items.size();
-	Item **child_items = (Item **)alloca(child_item_count * sizeof(Item *));
-	copymem(child_items, ci->child_items.ptr(), child_item_count * sizeof(Item *));
+	Item **child_items;
+
+	int visible_child_count = ci->cull_pass == cull_pass ? ci->visible_child_count : 0;
+
+	if (cull_pass && visible_child_count < child_item_count) {
+
+		// only the children leading to potentially visible items, back in child list order
+		if (ci->child_index_dirty) {
+			for (int i = 0; i < child_item_count; i++) {
+				ci->child_items[i]->child_index = i;
+			}
+			ci->child_index_dirty = false;
+		}
+
+		child_item_count = visible_child_count;
+		child_items = (Item **)alloca(child_item_count * sizeof(Item *));
+		copymem(child_items, ci->visible_children.ptr(), child_item_count * sizeof(Item *));
+
+		if (!ci->sort_y) {
+			SortArray<Item *, ItemChildIndexSort> sorter;
+			sorter.sort(child_items, child_item_count);
+		}
+	} else {
+
+		child_items = (Item **)alloca(child_item_count * sizeof(Item *));
+		copymem(child_items, ci->child_items.ptr(), child_item_count * sizeof(Item *));
+	}
 
 	if (ci->clip) {
 		if (p_canvas_clip != NULL) {
@@ -170,6 +196,186 @@ void VisualServerCanvas::_light_mask_canvas_items(int p_z, RasterizerCanvas::Ite
 	}
 }
 
+void VisualServerCanvas::_item_queue_index_update(Item *p_item, bool p_xform_changed) {
+
+	if (p_xform_changed) {
+		p_item->global_xform_dirty = true;
+	}
+
+	if (p_item->index_canvas && !p_item->index_update_item.in_list()) {
+		p_item->index_canvas->index_update_list.add(&p_item->index_update_item);
+	}
+}
+
+void VisualServerCanvas::_item_update_index_bounds(Item *p_item) {
+
+	Canvas *canvas = p_item->index_canvas;
+
+	if (p_item->index_update_item.in_list()) {
+		canvas->index_update_list.remove(&p_item->index_update_item);
+	}
+
+	if (!p_item->commands.empty()) {
+
+		Rect2 rect = p_item->global_xform.xform(p_item->get_rect());
+		// the octree doesn't index boxes without a surface, so point and line sized items get a minimal size
+		AABB aabb(Vector3(rect.position.x, rect.position.y, 0), Vector3(MAX(rect.size.x, CMP_EPSILON), MAX(rect.size.y, CMP_EPSILON), 1));
+
+		if (p_item->octree_id) {
+			canvas->octree.move(p_item->octree_id, aabb);
+		} else {
+			p_item->octree_id = canvas->octree.create(p_item, aabb);
+		}
+	} else if (p_item->octree_id) {
+
+		canvas->octree.erase(p_item->octree_id);
+		p_item->octree_id = 0;
+	}
+
+	if (p_item->copy_back_buffer) {
+		canvas->copy_back_buffer_items.insert(p_item);
+	} else {
+		canvas->copy_back_buffer_items.erase(p_item);
+	}
+}
+
+void VisualServerCanvas::_item_update_index_subtree(Item *p_item) {
+
+	if (p_item->parent_item) {
+		p_item->global_xform = p_item->parent_item->global_xform * p_item->xform;
+	} else {
+		p_item->global_xform = p_item->xform;
+	}
+	p_item->global_xform_dirty = false;
+
+	_item_update_index_bounds(p_item);
+
+	for (int i = 0; i < p_item->child_items.size(); i++) {
+
+		Item *child = p_item->child_items[i];
+		child->index_canvas = p_item->index_canvas;
+		_item_update_index_subtree(child);
+	}
+}
+
+void VisualServerCanvas::_item_remove_from_index(Item *p_item) {
+
+	Canvas *canvas = p_item->index_canvas;
+
+	if (canvas) {
+
+		if (p_item->octree_id) {
+			canvas->octree.erase(p_item->octree_id);
+			p_item->octree_id = 0;
+		}
+
+		if (p_item->index_update_item.in_list()) {
+			canvas->index_update_list.remove(&p_item->index_update_item);
+		}
+
+		canvas->copy_back_buffer_items.erase(p_item);
+		p_item->index_canvas = NULL;
+	}
+
+	p_item->global_xform_dirty = true;
+
+	for (int i = 0; i < p_item->child_items.size(); i++) {
+		_item_remove_from_index(p_item->child_items[i]);
+	}
+}
+
+void VisualServerCanvas::_update_canvas_index(Canvas *p_canvas) {
+
+	while (p_canvas->index_update_list.first()) {
+
+		Item *item = p_canvas->index_update_list.first()->self();
+
+		// a moved ancestor moves the whole subtree, so update from the topmost one
+		Item *top = item->global_xform_dirty ? item : NULL;
+		for (Item *parent = item->parent_item; parent; parent = parent->parent_item) {
+			if (parent->global_xform_dirty) {
+				top = parent;
+			}
+		}
+
+		if (top) {
+			_item_update_index_subtree(top);
+		}
+
+		if (item->index_update_item.in_list()) {
+			_item_update_index_bounds(item);
+		}
+	}
+}
+
+void VisualServerCanvas::_cull_mark_item(Item *p_item) {
+
+	if (p_item->cull_pass == cull_pass)
+		return;
+
+	p_item->cull_pass = cull_pass;
+	p_item->visible_child_count = 0;
+
+	// add to the parent's visible children, up to the first ancestor already reached
+	Item *item = p_item;
+	while (item->parent_item) {
+
+		Item *parent = item->parent_item;
+		bool reached = parent->cull_pass == cull_pass;
+
+		if (!reached) {
+			parent->cull_pass = cull_pass;
+			parent->visible_child_count = 0;
+		}
+
+		if (parent->visible_child_count == parent->visible_children.size()) {
+			parent->visible_children.resize(MAX(4, parent->visible_child_count * 2));
+		}
+		parent->visible_children[parent->visible_child_count++] = item;
+
+		if (reached)
+			break;
+
+		item = parent;
+	}
+}
+
+bool VisualServerCanvas::_cull_canvas_items(Canvas *p_canvas, const Transform2D &p_transform, const Rect2 &p_clip_rect) {
+
+	if (p_transform.basis_determinant() == 0)
+		return false;
+
+	_update_canvas_index(p_canvas);
+
+	// the clip rect in canvas space, grown a bit so rounding never culls what the exact test would draw
+	Rect2 view = p_transform.affine_inverse().xform(Rect2(Point2(), p_clip_rect.size)).grow(1.0);
+	AABB aabb(Vector3(view.position.x, view.position.y, -1), Vector3(view.size.x, view.size.y, 2));
+
+	if (cull_result.size() == 0) {
+		cull_result.resize(1024);
+	}
+
+	int count = p_canvas->octree.cull_aabb(aabb, cull_result.ptrw(), cull_result.size());
+	while (count == cull_result.size()) {
+		//buffer was filled, grow it and cull again
+		cull_result.resize(cull_result.size() * 2);
+		count = p_canvas->octree.cull_aabb(aabb, cull_result.ptrw(), cull_result.size());
+	}
+
+	cull_pass = ++last_cull_pass;
+
+	Item **items = cull_result.ptrw();
+	for (int i = 0; i < count; i++) {
+		_cull_mark_item(items[i]);
+	}
+
+	for (Set<Item *>::Element *E = p_canvas->copy_back_buffer_items.front(); E; E = E->next()) {
+		_cull_mark_item(E->get());
+	}
+
+	return true;
+}
+
 void VisualServerCanvas::render_canvas(Canvas *p_canvas, const Transform2D &p_transform, RasterizerCanvas::Light *p_lights, RasterizerCanvas::Light *p_masked_lights, const Rect2 &p_clip_rect) {
 
 	VSG::canvas_render->canvas_begin();
@@ -200,10 +406,16 @@ void VisualServerCanvas::render_canvas(Canvas *p_canvas, const Transform2D &p_tr
 		memset(z_list, 0, z_range * sizeof(RasterizerCanvas::Item *));
 		memset(z_last_list, 0, z_range * sizeof(RasterizerCanvas::Item *));
 
+		bool culled = _cull_canvas_items(p_canvas, p_transform, p_clip_rect);
+
 		for (int i = 0; i < l; i++) {
+			if (culled && ci[i].item->cull_pass != cull_pass)
+				continue; //nothing potentially visible below
 			_render_canvas_item(ci[i].item, p_transform, p_clip_rect, Color(1, 1, 1, 1), 0, z_list, z_last_list, NULL, NULL);
 		}
 
+		cull_pass = 0;
+
 		for (int i = 0; i < z_range; i++) {
 			if (!z_list[i])
 				continue;
@@ -293,11 +505,15 @@ void VisualServerCanvas::canvas_item_set_parent(RID p_item, RID p_parent) {
 
 			Item *item_owner = canvas_item_owner.get(canvas_item->parent);
 			item_owner->child_items.erase(canvas_item);
+			item_owner->child_index_dirty = true;
 		}
 
 		canvas_item->parent = RID();
 	}
 
+	_item_remove_from_index(canvas_item);
+	canvas_item->parent_item = NULL;
+
 	if (p_parent.is_valid()) {
 		if (canvas_owner.owns(p_parent)) {
 
@@ -306,12 +522,16 @@ void VisualServerCanvas::canvas_item_set_parent(RID p_item, RID p_parent) {
 			ci.item = canvas_item;
 			canvas->child_items.push_back(ci);
 			canvas->children_order_dirty = true;
+
+			canvas_item->index_canvas = canvas;
 		} else if (canvas_item_owner.owns(p_parent)) {
 
 			Item *item_owner = canvas_item_owner.get(p_parent);
 			item_owner->child_items.push_back(canvas_item);
 			item_owner->children_order_dirty = true;
 
+			canvas_item->parent_item = item_owner;
+			canvas_item->index_canvas = item_owner->index_canvas;
 		} else {
 
 			ERR_EXPLAIN("Invalid parent");
@@ -320,6 +540,7 @@ void VisualServerCanvas::canvas_item_set_parent(RID p_item, RID p_parent) {
 	}
 
 	canvas_item->parent = p_parent;
+	_item_queue_index_update(canvas_item, true);
 }
 void VisualServerCanvas::canvas_item_set_visible(RID p_item, bool p_visible) {
 
@@ -342,6 +563,7 @@ void VisualServerCanvas::canvas_item_set_transform(RID p_item, const Transform2D
 	ERR_FAIL_COND(!canvas_item);
 
 	canvas_item->xform = p_transform;
+	_item_queue_index_update(canvas_item, true);
 }
 void VisualServerCanvas::canvas_item_set_clip(RID p_item, bool p_clip) {
 
@@ -364,6 +586,7 @@ void VisualServerCanvas::canvas_item_set_custom_rect(RID p_item, bool p_custom_r
 
 	canvas_item->custom_rect = p_custom_rect;
 	canvas_item->rect = p_rect;
+	_item_queue_index_update(canvas_item, false);
 }
 void VisualServerCanvas::canvas_item_set_modulate(RID p_item, const Color &p_color) {
 
@@ -403,6 +626,7 @@ void VisualServerCanvas::canvas_item_add_line(RID p_item, const Point2 &p_from,
 	canvas_item->rect_dirty = true;
 
 	canvas_item->commands.push_back(line);
+	_item_queue_index_update(canvas_item, false);
 }
 
 void VisualServerCanvas::canvas_item_add_polyline(RID p_item, const Vector<Point2> &p_points, const Vector<Color> &p_colors, float p_width, bool p_antialiased) {
@@ -488,6 +712,7 @@ void VisualServerCanvas::canvas_item_add_polyline(RID p_item, const Vector<Point
 	}
 	canvas_item->rect_dirty = true;
 	canvas_item->commands.push_back(pline);
+	_item_queue_index_update(canvas_item, false);
 }
 
 void VisualServerCanvas::canvas_item_add_multiline(RID p_item, const Vector<Point2> &p_points, const Vector<Color> &p_colors, float p_width, bool p_antialiased) {
@@ -512,6 +737,7 @@ void VisualServerCanvas::canvas_item_add_multiline(RID p_item, const Vector<Poin
 
 	canvas_item->rect_dirty = true;
 	canvas_item->commands.push_back(pline);
+	_item_queue_index_update(canvas_item, false);
 }
 
 void VisualServerCanvas::canvas_item_add_rect(RID p_item, const Rect2 &p_rect, const Color &p_color) {
@@ -526,6 +752,7 @@ void VisualServerCanvas::canvas_item_add_rect(RID p_item, const Rect2 &p_rect, c
 	canvas_item->rect_dirty = true;
 
 	canvas_item->commands.push_back(rect);
+	_item_queue_index_update(canvas_item, false);
 }
 
 void VisualServerCanvas::canvas_item_add_circle(RID p_item, const Point2 &p_pos, float p_radius, const Color &p_color) {
@@ -539,7 +766,9 @@ void VisualServerCanvas::canvas_item_add_circle(RID p_item, const Point2 &p_pos,
 	circle->pos = p_pos;
 	circle->radius = p_radius;
 
+	canvas_item->rect_dirty = true;
 	canvas_item->commands.push_back(circle);
+	_item_queue_index_update(canvas_item, false);
 }
 
 void VisualServerCanvas::canvas_item_add_texture_rect(RID p_item, const Rect2 &p_rect, RID p_texture, bool p_tile, const Color &p_modulate, bool p_transpose, RID p_normal_map) {
@@ -576,6 +805,7 @@ void VisualServerCanvas::canvas_item_add_texture_rect(RID p_item, const Rect2 &p
 	rect->normal_map = p_normal_map;
 	canvas_item->rect_dirty = true;
 	canvas_item->commands.push_back(rect);
+	_item_queue_index_update(canvas_item, false);
 }
 
 void VisualServerCanvas::canvas_item_add_texture_rect_region(RID p_item, const Rect2 &p_rect, RID p_texture, const Rect2 &p_src_rect, const Color &p_modulate, bool p_transpose, RID p_normal_map, bool p_clip_uv) {
@@ -614,6 +844,7 @@ void VisualServerCanvas::canvas_item_add_texture_rect_region(RID p_item, const R
 	canvas_item->rect_dirty = true;
 
 	canvas_item->commands.push_back(rect);
+	_item_queue_index_update(canvas_item, false);
 }
 
 void VisualServerCanvas::canvas_item_add_nine_patch(RID p_item, const Rect2 &p_rect, const Rect2 &p_source, RID p_texture, const Vector2 &p_topleft, const Vector2 &p_bottomright, VS::NinePatchAxisMode p_x_axis_mode, VS::NinePatchAxisMode p_y_axis_mode, bool p_draw_center, const Color &p_modulate, RID p_normal_map) {
@@ -638,6 +869,7 @@ void VisualServerCanvas::canvas_item_add_nine_patch(RID p_item, const Rect2 &p_r
 	canvas_item->rect_dirty = true;
 
 	canvas_item->commands.push_back(style);
+	_item_queue_index_update(canvas_item, false);
 }
 void VisualServerCanvas::canvas_item_add_primitive(RID p_item, const Vector<Point2> &p_points, const Vector<Color> &p_colors, const Vector<Point2> &p_uvs, RID p_texture, float p_width, RID p_normal_map) {
 
@@ -655,6 +887,7 @@ void VisualServerCanvas::canvas_item_add_primitive(RID p_item, const Vector<Poin
 	canvas_item->rect_dirty = true;
 
 	canvas_item->commands.push_back(prim);
+	_item_queue_index_update(canvas_item, false);
 }
 
 void VisualServerCanvas::canvas_item_add_polygon(RID p_item, const Vector<Point2> &p_points, const Vector<Color> &p_colors, const Vector<Point2> &p_uvs, RID p_texture, RID p_normal_map, bool p_antialiased) {
@@ -690,6 +923,7 @@ void VisualServerCanvas::canvas_item_add_polygon(RID p_item, const Vector<Point2
 	canvas_item->rect_dirty = true;
 
 	canvas_item->commands.push_back(polygon);
+	_item_queue_index_update(canvas_item, false);
 }
 
 void VisualServerCanvas::canvas_item_add_triangle_array(RID p_item, const Vector<int> &p_indices, const Vector<Point2> &p_points, const Vector<Color> &p_colors, const Vector<Point2> &p_uvs, RID p_texture, int p_count, RID p_normal_map) {
@@ -730,6 +964,7 @@ void VisualServerCanvas::canvas_item_add_triangle_array(RID p_item, const Vector
 	canvas_item->rect_dirty = true;
 
 	canvas_item->commands.push_back(polygon);
+	_item_queue_index_update(canvas_item, false);
 }
 
 void VisualServerCanvas::canvas_item_add_set_transform(RID p_item, const Transform2D &p_transform) {
@@ -741,7 +976,9 @@ void VisualServerCanvas::canvas_item_add_set_transform(RID p_item, const Transfo
 	ERR_FAIL_COND(!tr);
 	tr->xform = p_transform;
 
+	canvas_item->rect_dirty = true;
 	canvas_item->commands.push_back(tr);
+	_item_queue_index_update(canvas_item, false);
 }
 
 void VisualServerCanvas::canvas_item_add_mesh(RID p_item, const RID &p_mesh, RID p_skeleton) {
@@ -754,7 +991,9 @@ void VisualServerCanvas::canvas_item_add_mesh(RID p_item, const RID &p_mesh, RID
 	m->mesh = p_mesh;
 	m->skeleton = p_skeleton;
 
+	canvas_item->rect_dirty = true;
 	canvas_item->commands.push_back(m);
+	_item_queue_index_update(canvas_item, false);
 }
 void VisualServerCanvas::canvas_item_add_particles(RID p_item, RID p_particles, RID p_texture, RID p_normal, int p_h_frames, int p_v_frames) {
 
@@ -774,6 +1013,7 @@ void VisualServerCanvas::canvas_item_add_particles(RID p_item, RID p_particles,
 
 	canvas_item->rect_dirty = true;
 	canvas_item->commands.push_back(part);
+	_item_queue_index_update(canvas_item, false);
 }
 
 void VisualServerCanvas::canvas_item_add_multimesh(RID p_item, RID p_mesh, RID p_skeleton) {
@@ -788,6 +1028,7 @@ void VisualServerCanvas::canvas_item_add_multimesh(RID p_item, RID p_mesh, RID p
 
 	canvas_item->rect_dirty = true;
 	canvas_item->commands.push_back(mm);
+	_item_queue_index_update(canvas_item, false);
 }
 
 void VisualServerCanvas::canvas_item_add_clip_ignore(RID p_item, bool p_ignore) {
@@ -799,7 +1040,9 @@ void VisualServerCanvas::canvas_item_add_clip_ignore(RID p_item, bool p_ignore)
 	ERR_FAIL_COND(!ci);
 	ci->ignore = p_ignore;
 
+	canvas_item->rect_dirty = true;
 	canvas_item->commands.push_back(ci);
+	_item_queue_index_update(canvas_item, false);
 }
 void VisualServerCanvas::canvas_item_set_sort_children_by_y(RID p_item, bool p_enable) {
 
@@ -841,6 +1084,8 @@ void VisualServerCanvas::canvas_item_set_copy_to_backbuffer(RID p_item, bool p_e
 		canvas_item->copy_back_buffer->rect = p_rect;
 		canvas_item->copy_back_buffer->full = p_rect == Rect2();
 	}
+
+	_item_queue_index_update(canvas_item, false);
 }
 
 void VisualServerCanvas::canvas_item_clear(RID p_item) {
@@ -849,6 +1094,7 @@ void VisualServerCanvas::canvas_item_clear(RID p_item) {
 	ERR_FAIL_COND(!canvas_item);
 
 	canvas_item->clear();
+	_item_queue_index_update(canvas_item, false);
 }
 void VisualServerCanvas::canvas_item_set_draw_index(RID p_item, int p_index) {
 
@@ -1243,6 +1489,7 @@ bool VisualServerCanvas::free(RID p_rid) {
 		for (int i = 0; i < canvas->child_items.size(); i++) {
 
 			canvas->child_items[i].item->parent = RID();
+			_item_remove_from_index(canvas->child_items[i].item);
 		}
 
 		for (Set<RasterizerCanvas::Light *>::Element *E = canvas->lights.front(); E; E = E->next()) {
@@ -1274,12 +1521,16 @@ bool VisualServerCanvas::free(RID p_rid) {
 
 				Item *item_owner = canvas_item_owner.get(canvas_item->parent);
 				item_owner->child_items.erase(canvas_item);
+				item_owner->child_index_dirty = true;
 			}
 		}
 
+		_item_remove_from_index(canvas_item);
+
 		for (int i = 0; i < canvas_item->child_items.size(); i++) {
 
 			canvas_item->child_items[i]->parent = RID();
+			canvas_item->child_items[i]->parent_item = NULL;
 		}
 
 		/*
@@ -1358,6 +1609,9 @@ VisualServerCanvas::VisualServerCanvas() {
 
 	z_list = (RasterizerCanvas::Item **)memalloc(z_range * sizeof(RasterizerCanvas::Item *));
 	z_last_list = (RasterizerCanvas::Item **)memalloc(z_range * sizeof(RasterizerCanvas::Item *));
+
+	cull_pass = 0;
+	last_cull_pass = 0;
 }
 
 VisualServerCanvas::~VisualServerCanvas() {
@@ -31,11 +31,15 @@
 #ifndef VISUALSERVERCANVAS_H
 #define VISUALSERVERCANVAS_H
 
+#include "octree.h"
 #include "rasterizer.h"
+#include "self_list.h"
 #include "visual_server_viewport.h"
 
 class VisualServerCanvas {
 public:
+	struct Canvas;
+
 	struct Item : public RasterizerCanvas::Item {
 
 		RID parent; // canvas it belongs to
@@ -51,7 +55,23 @@ public:
 
 		Vector<Item *> child_items;
 
-		Item() {
+		// spatial index, kept in canvas space (without the canvas transform)
+		Item *parent_item;
+		Canvas *index_canvas;
+		OctreeElementID octree_id;
+		Transform2D global_xform;
+		bool global_xform_dirty;
+		SelfList<Item> index_update_item;
+		int child_index; // position in the parent child list, to restore the draw order of culled children
+		bool child_index_dirty;
+
+		// filled by the cull, children that lead to potentially visible items
+		uint64_t cull_pass;
+		Vector<Item *> visible_children;
+		int visible_child_count;
+
+		Item() :
+				index_update_item(this) {
 			children_order_dirty = true;
 			E = NULL;
 			z_index = 0;
@@ -61,6 +81,14 @@ public:
 			use_parent_material = false;
 			z_relative = true;
 			index = 0;
+			parent_item = NULL;
+			index_canvas = NULL;
+			octree_id = 0;
+			global_xform_dirty = true;
+			child_index = 0;
+			child_index_dirty = true;
+			cull_pass = 0;
+			visible_child_count = 0;
 		}
 	};
 
@@ -72,6 +100,14 @@ public:
 		}
 	};
 
+	struct ItemChildIndexSort {
+
+		_FORCE_INLINE_ bool operator()(const Item *p_left, const Item *p_right) const {
+
+			return p_left->child_index < p_right->child_index;
+		}
+	};
+
 	struct ItemPtrSort {
 
 		_FORCE_INLINE_ bool operator()(const Item *p_left, const Item *p_right) const {
@@ -121,6 +157,10 @@ public:
 		Vector<ChildItem> child_items;
 		Color modulate;
 
+		Octree<Item> octree; //items with something to draw
+		Set<Item *> copy_back_buffer_items; //never culled
+		SelfList<Item>::List index_update_list;
+
 		int find_item(Item *p_item) {
 			for (int i = 0; i < child_items.size(); i++) {
 				if (child_items[i].item == p_item)
@@ -149,9 +189,21 @@ private:
 	void _render_canvas_item(Item *p_canvas_item, const Transform2D &p_transform, const Rect2 &p_clip_rect, const Color &p_modulate, int p_z, RasterizerCanvas::Item **z_list, RasterizerCanvas::Item **z_last_list, Item *p_canvas_clip, Item *p_material_owner);
 	void _light_mask_canvas_items(int p_z, RasterizerCanvas::Item *p_canvas_item, RasterizerCanvas::Light *p_masked_lights);
 
+	_FORCE_INLINE_ void _item_queue_index_update(Item *p_item, bool p_xform_changed);
+	void _item_update_index_bounds(Item *p_item);
+	void _item_update_index_subtree(Item *p_item);
+	void _item_remove_from_index(Item *p_item);
+	void _update_canvas_index(Canvas *p_canvas);
+	_FORCE_INLINE_ void _cull_mark_item(Item *p_item);
+	bool _cull_canvas_items(Canvas *p_canvas, const Transform2D &p_transform, const Rect2 &p_clip_rect);
+
 	RasterizerCanvas::Item **z_list;
 	RasterizerCanvas::Item **z_last_list;
 
+	uint64_t cull_pass; //zero when rendering without the index
+	uint64_t last_cull_pass;
+	Vector<Item *> cull_result;
+
 public:
 	void render_canvas(Canvas *p_canvas, const Transform2D &p_transform, RasterizerCanvas::Light *p_lights, RasterizerCanvas::Light *p_masked_lights, const Rect2 &p_clip_rect);
 
@@ -98,6 +98,7 @@ void VisualServerRaster::draw(bool p_swap_buffers) {
 	changes = 0;
 
 	VSG::rasterizer->begin_frame();
+	VSG::scene->render_info_begin_frame();
 
 	VSG::scene->update_dirty_instances(); //update scene stuff
 
@@ -147,6 +148,9 @@ void VisualServerRaster::finish() {
 
 int VisualServerRaster::get_render_info(RenderInfo p_info) {
 
+	if (p_info == INFO_OCCLUDED_OBJECTS_IN_FRAME || p_info == INFO_DIRTY_INSTANCES_IN_FRAME)
+		return VSG::scene->get_render_info(p_info); //counted by the scene, before reaching the rasterizer
+
 	return VSG::storage->get_render_info(p_info);
 }
 
@@ -250,6 +250,7 @@ public:
 	BIND3(multimesh_instance_set_transform, RID, int, const Transform &)
 	BIND3(multimesh_instance_set_transform_2d, RID, int, const Transform2D &)
 	BIND3(multimesh_instance_set_color, RID, int, const Color &)
+	BIND3(multimesh_set_instance_range, RID, int, const PoolVector<float> &)
 
 	BIND1RC(RID, multimesh_get_mesh, RID)
 	BIND1RC(AABB, multimesh_get_aabb, RID)
@@ -512,6 +513,25 @@ public:
 	BIND3(scenario_set_reflection_atlas_size, RID, int, int)
 	BIND2(scenario_set_fallback_environment, RID, RID)
 
+	/* ROOM API */
+
+	BIND0R(RID, room_create)
+	BIND2(room_set_scenario, RID, RID)
+	BIND2(room_set_bounds, RID, const Vector<Plane> &)
+
+	BIND0R(RID, portal_create)
+	BIND3(portal_set_rooms, RID, RID, RID)
+	BIND2(portal_set_points, RID, const Vector<Vector3> &)
+	BIND2(portal_set_enabled, RID, bool)
+
+	/* OCCLUDER API */
+
+	BIND0R(RID, occluder_create)
+	BIND2(occluder_set_scenario, RID, RID)
+	BIND2(occluder_set_faces, RID, const PoolVector<Vector3> &)
+	BIND2(occluder_set_transform, RID, const Transform &)
+	BIND2(occluder_set_enabled, RID, bool)
+
 	/* INSTANCING API */
 	// from can be mesh, light,  area and portal so far.
 	BIND0R(RID, instance_create)
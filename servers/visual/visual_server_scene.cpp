@@ -30,6 +30,7 @@
 
 #include "visual_server_scene.h"
 #include "os/os.h"
+#include "project_settings.h"
 #include "visual_server_global.h"
 #include "visual_server_raster.h"
 /* CAMERA API */
@@ -37,6 +38,15 @@
 RID VisualServerScene::camera_create() {
 
 	Camera *camera = memnew(Camera);
+
+	for (int i = 0; i < LOD_VIEW_MAX; i++) {
+		if (lod_view_versions[i] == 0) {
+			camera->lod_view = i;
+			lod_view_versions[i] = ++lod_view_last_version; //sides left by a previous camera in the slot no longer match
+			break;
+		}
+	}
+
 	return camera_owner.make_rid(camera);
 }
 
@@ -288,6 +298,214 @@ void VisualServerScene::scenario_set_reflection_atlas_size(RID p_scenario, int p
 	VSG::scene_render->reflection_atlas_set_subdivision(scenario->reflection_atlas, p_subdiv);
 }
 
+/* ROOM API */
+
+RID VisualServerScene::room_create() {
+
+	Room *room = memnew(Room);
+	ERR_FAIL_COND_V(!room, RID());
+	return room_owner.make_rid(room);
+}
+
+void VisualServerScene::_room_set_scenario(Room *p_room, Scenario *p_scenario) {
+
+	if (p_room->scenario == p_scenario)
+		return;
+
+	//portals only connect rooms of the same scenario
+	while (p_room->portals.front()) {
+		_portal_unlink(p_room->portals.front()->get());
+	}
+
+	if (p_room->scenario) {
+		p_room->scenario->rooms.remove(&p_room->scenario_item);
+		p_room->scenario->rooms_dirty = true;
+	}
+
+	p_room->scenario = p_scenario;
+
+	if (p_room->scenario) {
+		p_room->scenario->rooms.add(&p_room->scenario_item);
+		p_room->scenario->rooms_dirty = true;
+	}
+}
+
+void VisualServerScene::room_set_scenario(RID p_room, RID p_scenario) {
+
+	Room *room = room_owner.get(p_room);
+	ERR_FAIL_COND(!room);
+
+	Scenario *scenario = NULL;
+	if (p_scenario.is_valid()) {
+		scenario = scenario_owner.get(p_scenario);
+		ERR_FAIL_COND(!scenario);
+	}
+
+	_room_set_scenario(room, scenario);
+}
+
+void VisualServerScene::room_set_bounds(RID p_room, const Vector<Plane> &p_planes) {
+
+	Room *room = room_owner.get(p_room);
+	ERR_FAIL_COND(!room);
+
+	room->planes = p_planes;
+	if (room->scenario) {
+		room->scenario->rooms_dirty = true;
+	}
+}
+
+RID VisualServerScene::portal_create() {
+
+	Portal *portal = memnew(Portal);
+	ERR_FAIL_COND_V(!portal, RID());
+	return portal_owner.make_rid(portal);
+}
+
+void VisualServerScene::_portal_unlink(Portal *p_portal) {
+
+	for (int i = 0; i < 2; i++) {
+
+		if (p_portal->rooms[i]) {
+			p_portal->rooms[i]->portals.erase(p_portal->room_elements[i]);
+			p_portal->rooms[i] = NULL;
+			p_portal->room_elements[i] = NULL;
+		}
+	}
+}
+
+void VisualServerScene::portal_set_rooms(RID p_portal, RID p_room, RID p_linked_room) {
+
+	Portal *portal = portal_owner.get(p_portal);
+	ERR_FAIL_COND(!portal);
+
+	_portal_unlink(portal);
+
+	if (!p_room.is_valid())
+		return;
+
+	Room *room = room_owner.get(p_room);
+	ERR_FAIL_COND(!room);
+	ERR_FAIL_COND(!room->scenario);
+
+	Room *linked_room = &room->scenario->exterior;
+	if (p_linked_room.is_valid()) {
+		linked_room = room_owner.get(p_linked_room);
+		ERR_FAIL_COND(!linked_room);
+		ERR_FAIL_COND(linked_room->scenario != room->scenario);
+		ERR_FAIL_COND(linked_room == room);
+	}
+
+	portal->rooms[0] = room;
+	portal->rooms[1] = linked_room;
+	portal->room_elements[0] = room->portals.push_back(portal);
+	portal->room_elements[1] = linked_room->portals.push_back(portal);
+}
+
+void VisualServerScene::portal_set_points(RID p_portal, const Vector<Vector3> &p_points) {
+
+	Portal *portal = portal_owner.get(p_portal);
+	ERR_FAIL_COND(!portal);
+
+	portal->points = p_points;
+
+	//newell's method, so any three points being aligned does not matter
+	Vector3 normal;
+	Vector3 center;
+	for (int i = 0; i < p_points.size(); i++) {
+
+		const Vector3 &a = p_points[i];
+		const Vector3 &b = p_points[(i + 1) % p_points.size()];
+		normal.x += (a.y - b.y) * (a.z + b.z);
+		normal.y += (a.z - b.z) * (a.x + b.x);
+		normal.z += (a.x - b.x) * (a.y + b.y);
+		center += a;
+	}
+
+	if (p_points.size() < 3 || normal.length_squared() < CMP_EPSILON2) {
+		portal->points.clear(); //degenerate, nothing can be seen through it
+		return;
+	}
+
+	center /= p_points.size();
+	portal->plane = Plane(center, normal.normalized());
+}
+
+void VisualServerScene::portal_set_enabled(RID p_portal, bool p_enabled) {
+
+	Portal *portal = portal_owner.get(p_portal);
+	ERR_FAIL_COND(!portal);
+
+	portal->enabled = p_enabled;
+}
+
+/* OCCLUDER API */
+
+RID VisualServerScene::occluder_create() {
+
+	Occluder *occluder = memnew(Occluder);
+	ERR_FAIL_COND_V(!occluder, RID());
+	return occluder_owner.make_rid(occluder);
+}
+
+void VisualServerScene::occluder_set_scenario(RID p_occluder, RID p_scenario) {
+
+	Occluder *occluder = occluder_owner.get(p_occluder);
+	ERR_FAIL_COND(!occluder);
+
+	if (occluder->scenario) {
+		occluder->scenario->occluders.remove(&occluder->scenario_item);
+		occluder->scenario = NULL;
+	}
+
+	if (p_scenario.is_valid()) {
+
+		Scenario *scenario = scenario_owner.get(p_scenario);
+		ERR_FAIL_COND(!scenario);
+
+		occluder->scenario = scenario;
+		scenario->occluders.add(&occluder->scenario_item);
+	}
+}
+
+void VisualServerScene::occluder_set_faces(RID p_occluder, const PoolVector<Vector3> &p_faces) {
+
+	Occluder *occluder = occluder_owner.get(p_occluder);
+	ERR_FAIL_COND(!occluder);
+	ERR_FAIL_COND(p_faces.size() % 3);
+
+	occluder->faces = p_faces;
+
+	AABB aabb;
+	PoolVector<Vector3>::Read r = p_faces.read();
+	for (int i = 0; i < p_faces.size(); i++) {
+		if (i == 0)
+			aabb.position = r[i];
+		else
+			aabb.expand_to(r[i]);
+	}
+
+	occluder->aabb = aabb;
+	occluder->transformed_aabb = occluder->transform.xform(aabb);
+}
+
+void VisualServerScene::occluder_set_transform(RID p_occluder, const Transform &p_transform) {
+
+	Occluder *occluder = occluder_owner.get(p_occluder);
+	ERR_FAIL_COND(!occluder);
+
+	occluder->transform = p_transform;
+	occluder->transformed_aabb = p_transform.xform(occluder->aabb);
+}
+
+void VisualServerScene::occluder_set_enabled(RID p_occluder, bool p_enabled) {
+
+	Occluder *occluder = occluder_owner.get(p_occluder);
+	ERR_FAIL_COND(!occluder);
+
+	occluder->enabled = p_enabled;
+}
+
 /* INSTANCING API */
 
 void VisualServerScene::_instance_queue_update(Instance *p_instance, bool p_update_aabb, bool p_update_materials) {
@@ -521,6 +739,7 @@ void VisualServerScene::instance_set_scenario(RID p_instance, RID p_scenario) {
 		}
 
 		instance->scenario = NULL;
+		instance->rooms.clear();
 	}
 
 	if (p_scenario.is_valid()) {
@@ -847,11 +1066,24 @@ void VisualServerScene::instance_geometry_set_material_override(RID p_instance,
 }
 
 void VisualServerScene::instance_geometry_set_draw_range(RID p_instance, float p_min, float p_max, float p_min_margin, float p_max_margin) {
+
+	Instance *instance = instance_owner.get(p_instance);
+	ERR_FAIL_COND(!instance);
+
+	instance->lod_begin = p_min;
+	instance->lod_end = p_max;
+	instance->lod_begin_hysteresis = p_min_margin;
+	instance->lod_end_hysteresis = p_max_margin;
+	for (int i = 0; i < LOD_VIEW_MAX; i++) {
+		instance->lod_view_sides[i].version = 0;
+	}
 }
 void VisualServerScene::instance_geometry_set_as_instance_lod(RID p_instance, RID p_as_lod_of_instance) {
 }
 
-void VisualServerScene::_update_instance(Instance *p_instance) {
+bool VisualServerScene::_update_instance(Instance *p_instance) {
+
+	// touches the storage, the renderer and the lights, must run serially
 
 	p_instance->version++;
 
@@ -877,7 +1109,7 @@ void VisualServerScene::_update_instance(Instance *p_instance) {
 	}
 
 	if (p_instance->aabb.has_no_surface()) {
-		return;
+		return false;
 	}
 
 	if ((1 << p_instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) {
@@ -891,6 +1123,18 @@ void VisualServerScene::_update_instance(Instance *p_instance) {
 				light->shadow_dirty = true;
 			}
 		}
+	}
+
+	return true;
+}
+
+void VisualServerScene::_update_instance_bounds(Instance *p_instance) {
+
+	// only writes to the instance itself, safe to run for many instances at once
+
+	if ((1 << p_instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) {
+
+		InstanceGeometryData *geom = static_cast<InstanceGeometryData *>(p_instance->base_data);
 
 		if (!p_instance->lightmap_capture && geom->lightmap_captures.size()) {
 			//affected by lightmap captures, must update capture info!
@@ -910,11 +1154,20 @@ void VisualServerScene::_update_instance(Instance *p_instance) {
 
 	p_instance->transformed_aabb = new_aabb;
 
+	if (p_instance->scenario) {
+		_update_instance_rooms(p_instance);
+	}
+}
+
+void VisualServerScene::_update_instance_octree(Instance *p_instance) {
+
 	if (!p_instance->scenario) {
 
 		return;
 	}
 
+	const AABB &new_aabb = p_instance->transformed_aabb;
+
 	if (p_instance->octree_id == 0) {
 
 		uint32_t base_type = 1 << p_instance->base_type;
@@ -947,6 +1200,61 @@ void VisualServerScene::_update_instance(Instance *p_instance) {
 	}
 }
 
+void VisualServerScene::_update_instance_rooms(Instance *p_instance) {
+
+	p_instance->rooms.clear();
+
+	Scenario *scenario = p_instance->scenario;
+	if (!scenario || !scenario->rooms.first())
+		return;
+
+	bool geometry = (1 << p_instance->base_type) & VS::INSTANCE_GEOMETRY_MASK;
+	if (!geometry && !(p_instance->base_type == VS::INSTANCE_LIGHT && VSG::storage->light_get_type(p_instance->base) != VS::LIGHT_DIRECTIONAL))
+		return;
+
+	const AABB &aabb = p_instance->transformed_aabb;
+	bool inside_room = false;
+
+	for (SelfList<Room> *E = scenario->rooms.first(); E; E = E->next()) {
+
+		Room *room = E->self();
+		const Plane *planes = room->planes.ptr();
+		int plane_count = room->planes.size();
+
+		if (plane_count == 0 || !aabb.intersects_convex_shape(planes, plane_count))
+			continue;
+
+		p_instance->rooms.push_back(room);
+
+		if (!inside_room) {
+			//whatever sticks out of every room is also in the exterior
+			inside_room = true;
+			for (int i = 0; i < plane_count; i++) {
+				if (planes[i].distance_to(aabb.get_support(planes[i].normal)) > 0) {
+					inside_room = false;
+					break;
+				}
+			}
+		}
+	}
+
+	if (!inside_room) {
+		p_instance->rooms.push_back(&scenario->exterior);
+	}
+}
+
+void VisualServerScene::_update_scenario_rooms(Scenario *p_scenario) {
+
+	if (!p_scenario->rooms_dirty)
+		return;
+
+	for (SelfList<Instance> *E = p_scenario->instances.first(); E; E = E->next()) {
+		_update_instance_rooms(E->self());
+	}
+
+	p_scenario->rooms_dirty = false;
+}
+
 void VisualServerScene::_update_instance_aabb(Instance *p_instance) {
 
 	AABB new_aabb;
@@ -1253,9 +1561,58 @@ void VisualServerScene::_update_instance_lightmap_captures(Instance *p_instance)
 	}
 }
 
-void VisualServerScene::_light_instance_update_shadow(Instance *p_instance, const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_shadow_atlas, Scenario *p_scenario) {
+int VisualServerScene::_shadow_cull_casters(ShadowCullPass &p_pass, const Vector<Plane> &p_planes, Scenario *p_scenario, const Vector3 &p_camera_origin, int p_lod_view, const Instance *p_light) {
 
-	InstanceLightData *light = static_cast<InstanceLightData *>(p_instance->base_data);
+	if (p_pass.casters.size() == 0) {
+		p_pass.casters.resize(INSTANCE_CULL_CHUNK_SIZE);
+	}
+
+	int cull_count = p_scenario->octree.cull_convex(p_planes, p_pass.casters.ptrw(), p_pass.casters.size(), VS::INSTANCE_GEOMETRY_MASK);
+
+	while (cull_count == p_pass.casters.size() && p_pass.casters.size() < MAX_INSTANCE_CULL) {
+		//buffer was filled, grow it and cull again
+		p_pass.casters.resize(MIN(p_pass.casters.size() * 2, (int)MAX_INSTANCE_CULL));
+		cull_count = p_scenario->octree.cull_convex(p_planes, p_pass.casters.ptrw(), p_pass.casters.size(), VS::INSTANCE_GEOMETRY_MASK);
+	}
+
+	Instance **casters = p_pass.casters.ptrw();
+	int caster_count = 0;
+
+	for (int i = 0; i < cull_count; i++) {
+
+		Instance *instance = casters[i];
+		if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
+			continue;
+		}
+
+		//same level of detail as seen from the camera, the sides are only updated by the camera cull
+		Instance::LODViewSides sides;
+		if (!_instance_check_draw_range(instance, p_camera_origin, p_lod_view, sides)) {
+			continue;
+		}
+
+		if (room_cull_data.enabled && !_instance_casts_shadow_in_rooms(instance, p_light)) {
+			continue;
+		}
+
+		casters[caster_count++] = instance;
+	}
+
+	return caster_count;
+}
+
+void VisualServerScene::_light_instance_cull_shadow(ShadowCullJob &p_job, const ShadowCullContext &p_context) {
+
+	// runs on the cull threads, so it must not write to instances or call the rasterizer
+
+	Instance *p_instance = p_job.light;
+	const Transform &p_cam_transform = p_context.cam_transform;
+	const CameraMatrix &p_cam_projection = p_context.cam_projection;
+	bool p_cam_orthogonal = p_context.cam_orthogonal;
+	Scenario *p_scenario = p_context.scenario;
+
+	p_job.pass_count = 0;
+	p_job.restore_transform = false;
 
 	switch (VSG::storage->light_get_type(p_instance->base)) {
 
@@ -1274,7 +1631,9 @@ void VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 			if (depth_range_mode == VS::LIGHT_DIRECTIONAL_SHADOW_DEPTH_RANGE_OPTIMIZED) {
 				//optimize min/max
 				Vector<Plane> planes = p_cam_projection.get_projection_planes(p_cam_transform);
-				int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
+				ShadowCullPass &scratch = p_job.passes[0];
+				int cull_count = _shadow_cull_casters(scratch, planes, p_scenario, p_cam_transform.origin, p_context.lod_view, p_instance);
+				Instance *const *casters = scratch.casters.ptr();
 				Plane base(p_cam_transform.origin, -p_cam_transform.basis.get_axis(2));
 				//check distance max and min
 
@@ -1284,10 +1643,7 @@ void VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 
 				for (int i = 0; i < cull_count; i++) {
 
-					Instance *instance = instance_shadow_cull_result[i];
-					if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
-						continue;
-					}
+					Instance *instance = casters[i];
 
 					float max, min;
 					instance->transformed_aabb.project_range_in_plane(base, min, max);
@@ -1327,7 +1683,7 @@ void VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 
 			distances[splits] = max_distance;
 
-			float texture_size = VSG::scene_render->get_directional_light_shadow_size(light->instance);
+			float texture_size = p_job.texture_size;
 
 			bool overlap = VSG::storage->light_directional_get_blend_splits(p_instance->base);
 
@@ -1465,26 +1821,16 @@ void VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 				light_frustum_planes[4] = Plane(z_vec, z_max + 1e6);
 				light_frustum_planes[5] = Plane(-z_vec, -z_min); // z_min is ok, since casters further than far-light plane are not needed
 
-				int cull_count = p_scenario->octree.cull_convex(light_frustum_planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
+				ShadowCullPass &pass = p_job.passes[p_job.pass_count++];
+				pass.caster_count = _shadow_cull_casters(pass, light_frustum_planes, p_scenario, p_cam_transform.origin, p_context.lod_view, p_instance);
 
 				// a pre pass will need to be needed to determine the actual z-near to be used
 
-				Plane near_plane(p_instance->transform.origin, -p_instance->transform.basis.get_axis(2));
-
-				for (int j = 0; j < cull_count; j++) {
+				Instance *const *casters = pass.casters.ptr();
+				for (int j = 0; j < pass.caster_count; j++) {
 
 					float min, max;
-					Instance *instance = instance_shadow_cull_result[j];
-					if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
-						cull_count--;
-						SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
-						j--;
-						continue;
-					}
-
-					instance->transformed_aabb.project_range_in_plane(Plane(z_vec, 0), min, max);
-					instance->depth = near_plane.distance_to(instance->transform.origin);
-					instance->depth_layer = 0;
+					casters[j]->transformed_aabb.project_range_in_plane(Plane(z_vec, 0), min, max);
 					if (max > z_max)
 						z_max = max;
 				}
@@ -1501,10 +1847,14 @@ void VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 					ortho_transform.basis = transform.basis;
 					ortho_transform.origin = x_vec * (x_min_cam + half_x) + y_vec * (y_min_cam + half_y) + z_vec * z_max;
 
-					VSG::scene_render->light_instance_set_shadow_transform(light->instance, ortho_camera, ortho_transform, 0, distances[i + 1], i, bias_scale);
+					pass.pass = i;
+					pass.projection = ortho_camera;
+					pass.transform = ortho_transform;
+					pass.far = 0;
+					pass.split = distances[i + 1];
+					pass.bias_scale = bias_scale;
+					pass.depth_plane = Plane(p_instance->transform.origin, -p_instance->transform.basis.get_axis(2));
 				}
-
-				VSG::scene_render->render_shadow(light->instance, p_shadow_atlas, i, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, cull_count);
 			}
 
 		} break;
@@ -1530,24 +1880,15 @@ void VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 						planes[3] = p_instance->transform.xform(Plane(Vector3(0, 1, z).normalized(), radius));
 						planes[4] = p_instance->transform.xform(Plane(Vector3(0, -1, z).normalized(), radius));
 
-						int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
-						Plane near_plane(p_instance->transform.origin, p_instance->transform.basis.get_axis(2) * z);
-
-						for (int j = 0; j < cull_count; j++) {
-
-							Instance *instance = instance_shadow_cull_result[j];
-							if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
-								cull_count--;
-								SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
-								j--;
-							} else {
-								instance->depth = near_plane.distance_to(instance->transform.origin);
-								instance->depth_layer = 0;
-							}
-						}
-
-						VSG::scene_render->light_instance_set_shadow_transform(light->instance, CameraMatrix(), p_instance->transform, radius, 0, i);
-						VSG::scene_render->render_shadow(light->instance, p_shadow_atlas, i, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, cull_count);
+						ShadowCullPass &pass = p_job.passes[p_job.pass_count++];
+						pass.caster_count = _shadow_cull_casters(pass, planes, p_scenario, p_cam_transform.origin, p_context.lod_view, p_instance);
+						pass.pass = i;
+						pass.projection = CameraMatrix();
+						pass.transform = p_instance->transform;
+						pass.far = radius;
+						pass.split = 0;
+						pass.bias_scale = 1.0;
+						pass.depth_plane = Plane(p_instance->transform.origin, p_instance->transform.basis.get_axis(2) * z);
 					}
 				} break;
 				case VS::LIGHT_OMNI_SHADOW_CUBE: {
@@ -1581,28 +1922,19 @@ void VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 
 						Vector<Plane> planes = cm.get_projection_planes(xform);
 
-						int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
-
-						Plane near_plane(xform.origin, -xform.basis.get_axis(2));
-						for (int j = 0; j < cull_count; j++) {
-
-							Instance *instance = instance_shadow_cull_result[j];
-							if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
-								cull_count--;
-								SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
-								j--;
-							} else {
-								instance->depth = near_plane.distance_to(instance->transform.origin);
-								instance->depth_layer = 0;
-							}
-						}
-
-						VSG::scene_render->light_instance_set_shadow_transform(light->instance, cm, xform, radius, 0, i);
-						VSG::scene_render->render_shadow(light->instance, p_shadow_atlas, i, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, cull_count);
+						ShadowCullPass &pass = p_job.passes[p_job.pass_count++];
+						pass.caster_count = _shadow_cull_casters(pass, planes, p_scenario, p_cam_transform.origin, p_context.lod_view, p_instance);
+						pass.pass = i;
+						pass.projection = cm;
+						pass.transform = xform;
+						pass.far = radius;
+						pass.split = 0;
+						pass.bias_scale = 1.0;
+						pass.depth_plane = Plane(xform.origin, -xform.basis.get_axis(2));
 					}
 
-					//restore the regular DP matrix
-					VSG::scene_render->light_instance_set_shadow_transform(light->instance, CameraMatrix(), p_instance->transform, radius, 0, 0);
+					//restore the regular DP matrix once rendered
+					p_job.restore_transform = true;
 
 				} break;
 			}
@@ -1617,26 +1949,51 @@ void VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 			cm.set_perspective(angle * 2.0, 1.0, 0.01, radius);
 
 			Vector<Plane> planes = cm.get_projection_planes(p_instance->transform);
-			int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
 
-			Plane near_plane(p_instance->transform.origin, -p_instance->transform.basis.get_axis(2));
-			for (int j = 0; j < cull_count; j++) {
+			ShadowCullPass &pass = p_job.passes[p_job.pass_count++];
+			pass.caster_count = _shadow_cull_casters(pass, planes, p_scenario, p_cam_transform.origin, p_context.lod_view, p_instance);
+			pass.pass = 0;
+			pass.projection = cm;
+			pass.transform = p_instance->transform;
+			pass.far = radius;
+			pass.split = 0;
+			pass.bias_scale = 1.0;
+			pass.depth_plane = Plane(p_instance->transform.origin, -p_instance->transform.basis.get_axis(2));
 
-				Instance *instance = instance_shadow_cull_result[j];
-				if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
-					cull_count--;
-					SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
-					j--;
-				} else {
-					instance->depth = near_plane.distance_to(instance->transform.origin);
-					instance->depth_layer = 0;
-				}
-			}
+		} break;
+	}
+}
 
-			VSG::scene_render->light_instance_set_shadow_transform(light->instance, cm, p_instance->transform, radius, 0, 0);
-			VSG::scene_render->render_shadow(light->instance, p_shadow_atlas, 0, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, cull_count);
+void VisualServerScene::_light_instance_cull_shadow_work(uint32_t p_job, ShadowCullContext *p_context) {
 
-		} break;
+	_light_instance_cull_shadow(p_context->jobs[p_job], *p_context);
+}
+
+void VisualServerScene::_light_instance_render_shadow(ShadowCullJob &p_job, RID p_shadow_atlas) {
+
+	Instance *p_instance = p_job.light;
+	InstanceLightData *light = static_cast<InstanceLightData *>(p_instance->base_data);
+
+	for (int i = 0; i < p_job.pass_count; i++) {
+
+		ShadowCullPass &pass = p_job.passes[i];
+		Instance **casters = pass.casters.ptrw();
+
+		for (int j = 0; j < pass.caster_count; j++) {
+
+			Instance *instance = casters[j];
+			instance->depth = pass.depth_plane.distance_to(instance->transform.origin);
+			instance->depth_layer = 0;
+		}
+
+		VSG::scene_render->light_instance_set_shadow_transform(light->instance, pass.projection, pass.transform, pass.far, pass.split, pass.pass, pass.bias_scale);
+		VSG::scene_render->render_shadow(light->instance, p_shadow_atlas, pass.pass, (RasterizerScene::InstanceBase **)casters, pass.caster_count);
+	}
+
+	if (p_job.restore_transform) {
+		//restore the regular DP matrix
+		float radius = VSG::storage->light_get_param(p_instance->base, VS::LIGHT_PARAM_RANGE);
+		VSG::scene_render->light_instance_set_shadow_transform(light->instance, CameraMatrix(), p_instance->transform, radius, 0, 0);
 	}
 }
 
@@ -1674,7 +2031,7 @@ void VisualServerScene::render_camera(RID p_camera, RID p_scenario, Size2 p_view
 		} break;
 	}
 
-	_render_scene(camera->transform, camera_matrix, ortho, camera->env, camera->visible_layers, p_scenario, p_shadow_atlas, RID(), -1);
+	_render_scene(camera->transform, camera_matrix, ortho, camera->env, camera->visible_layers, p_scenario, p_shadow_atlas, RID(), -1, camera->lod_view);
 }
 
 void VisualServerScene::render_camera(Ref<ARVRInterface> &p_interface, ARVRInterface::Eyes p_eye, RID p_camera, RID p_scenario, Size2 p_viewport_size, RID p_shadow_atlas) {
@@ -1693,117 +2050,243 @@ void VisualServerScene::render_camera(Ref<ARVRInterface> &p_interface, ARVRInter
 	Transform world_origin = ARVRServer::get_singleton()->get_world_origin();
 	Transform cam_transform = p_interface->get_transform_for_eye(p_eye, world_origin);
 
-	_render_scene(cam_transform, camera_matrix, ortho, camera->env, camera->visible_layers, p_scenario, p_shadow_atlas, RID(), -1);
+	_render_scene(cam_transform, camera_matrix, ortho, camera->env, camera->visible_layers, p_scenario, p_shadow_atlas, RID(), -1, camera->lod_view);
 };
 
-void VisualServerScene::_render_scene(const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_force_environment, uint32_t p_visible_layers, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe, int p_reflection_probe_pass) {
+bool VisualServerScene::_cull_room(Room *p_room, const Plane *p_planes, int p_plane_count, int p_depth) {
 
-	Scenario *scenario = scenario_owner.getornull(p_scenario);
+	if (room_cull_data.frustum_count == MAX_ROOM_CULL_FRUSTUMS)
+		return false;
 
-	render_pass++;
-	uint32_t camera_layer_mask = p_visible_layers;
+	//keep the frustum the room is seen through, a room seen through several portals has several
 
-	VSG::scene_render->set_scene_pass(render_pass);
+	if (room_cull_data.frustums.size() == room_cull_data.frustum_count) {
+		room_cull_data.frustums.resize(MAX(room_cull_data.frustum_count * 2, 16));
+	}
+	if (room_cull_data.planes.size() < room_cull_data.plane_count + p_plane_count) {
+		room_cull_data.planes.resize(MAX(room_cull_data.planes.size() * 2, room_cull_data.plane_count + p_plane_count));
+	}
 
-	//rasterizer->set_camera(camera->transform, camera_matrix,ortho);
+	RoomCullFrustum &frustum = room_cull_data.frustums.ptrw()[room_cull_data.frustum_count];
+	frustum.first_plane = room_cull_data.plane_count;
+	frustum.plane_count = p_plane_count;
+	frustum.next = p_room->visible_pass == render_pass ? p_room->first_frustum : -1;
 
-	Vector<Plane> planes = p_cam_projection.get_projection_planes(p_cam_transform);
+	Plane *planes = room_cull_data.planes.ptrw() + room_cull_data.plane_count;
+	for (int i = 0; i < p_plane_count; i++) {
+		planes[i] = p_planes[i];
+	}
 
-	Plane near_plane(p_cam_transform.origin, -p_cam_transform.basis.get_axis(2).normalized());
-	float z_far = p_cam_projection.get_z_far();
+	room_cull_data.plane_count += p_plane_count;
+	p_room->first_frustum = room_cull_data.frustum_count++;
+	p_room->visible_pass = render_pass;
+	p_room->shadow_pass = render_pass;
 
-	/* STEP 2 - CULL */
-	int cull_count = scenario->octree.cull_convex(planes, instance_cull_result, MAX_INSTANCE_CULL);
-	light_cull_count = 0;
+	const Vector3 &origin = room_cull_data.camera_origin;
+	const Vector3 &view_dir = room_cull_data.view_dir;
+	bool orthogonal = room_cull_data.orthogonal;
 
-	reflection_probe_cull_count = 0;
+	p_room->on_cull_path = true;
+	bool complete = true;
 
-	//light_samplers_culled=0;
+	for (List<Portal *>::Element *E = p_room->portals.front(); E && complete; E = E->next()) {
 
-	/*	print_line("OT: "+rtos( (OS::get_singleton()->get_ticks_usec()-t)/1000.0));
-	print_line("OTO: "+itos(p_scenario->octree.get_octant_count()));
-	//print_line("OTE: "+itos(p_scenario->octree.get_elem_count()));
-	print_line("OTP: "+itos(p_scenario->octree.get_pair_count()));
-*/
+		Portal *portal = E->get();
+		if (!portal->enabled || portal->points.size() < 3)
+			continue;
 
-	/* STEP 3 - PROCESS PORTALS, VALIDATE ROOMS */
-	//removed, will replace with culling
+		Room *room = portal->rooms[0] == p_room ? portal->rooms[1] : portal->rooms[0];
+		room->shadow_pass = render_pass;
 
-	/* STEP 4 - REMOVE FURTHER CULLED OBJECTS, ADD LIGHTS */
+		if (room->on_cull_path || p_depth == MAX_PORTAL_DEPTH)
+			continue;
 
-	for (int i = 0; i < cull_count; i++) {
+		//positive when the camera is in front of the portal plane
+		float side = orthogonal ? -portal->plane.normal.dot(view_dir) : portal->plane.distance_to(origin);
 
-		Instance *ins = instance_cull_result[i];
+		if (orthogonal && Math::abs(side) < CMP_EPSILON) {
+			continue; //seen edge on
+		}
 
-		bool keep = false;
+		if (!orthogonal && Math::abs(side) <= room_cull_data.z_near) {
+			//camera standing in the doorway, the portal can't narrow the view
+			complete = _cull_room(room, p_planes, p_plane_count, p_depth + 1);
+			continue;
+		}
 
-		if ((camera_layer_mask & ins->layer_mask) == 0) {
+		Vector<Vector3> polygon = portal->points;
+		for (int i = 0; i < p_plane_count && polygon.size() >= 3; i++) {
+			polygon = Geometry::clip_polygon(polygon, p_planes[i]);
+		}
 
-			//failure
-		} else if (ins->base_type == VS::INSTANCE_LIGHT && ins->visible) {
+		int point_count = polygon.size();
+		if (point_count < 3)
+			continue;
 
-			if (ins->visible && light_cull_count < MAX_LIGHTS_CULLED) {
+		//the part of the portal in view, extruded from the camera
+		Vector<Plane> &portal_plane_buffer = room_cull_data.portal_planes[p_depth];
+		if (portal_plane_buffer.size() < point_count + 2) {
+			portal_plane_buffer.resize(point_count + 2);
+		}
+		Plane *portal_planes = portal_plane_buffer.ptrw();
+		int portal_plane_count = 0;
 
-				InstanceLightData *light = static_cast<InstanceLightData *>(ins->base_data);
+		portal_planes[portal_plane_count++] = side > 0 ? portal->plane : -portal->plane;
 
-				if (!light->geometries.empty()) {
-					//do not add this light if no geometry is affected by it..
-					light_cull_result[light_cull_count] = ins;
-					light_instance_cull_result[light_cull_count] = light->instance;
-					if (p_shadow_atlas.is_valid() && VSG::storage->light_has_shadow(ins->base)) {
-						VSG::scene_render->light_instance_mark_visible(light->instance); //mark it visible for shadow allocation later
-					}
+		Vector3 center;
+		for (int i = 0; i < point_count; i++) {
+			center += polygon[i];
+		}
+		center /= point_count;
 
-					light_cull_count++;
-				}
+		for (int i = 0; i < point_count; i++) {
+
+			const Vector3 &a = polygon[i];
+			const Vector3 &b = polygon[(i + 1) % point_count];
+
+			Plane edge = orthogonal ? Plane(a, b, a + view_dir) : Plane(origin, a, b);
+			if (edge.normal.length_squared() < CMP_EPSILON) {
+				continue; //clipping can leave points too close together
 			}
-		} else if (ins->base_type == VS::INSTANCE_REFLECTION_PROBE && ins->visible) {
+			if (edge.is_point_over(center)) {
+				edge = -edge;
+			}
+			portal_planes[portal_plane_count++] = edge;
+		}
 
-			if (ins->visible && reflection_probe_cull_count < MAX_REFLECTION_PROBES_CULLED) {
+		portal_planes[portal_plane_count++] = room_cull_data.far_plane;
 
-				InstanceReflectionProbeData *reflection_probe = static_cast<InstanceReflectionProbeData *>(ins->base_data);
+		complete = _cull_room(room, portal_planes, portal_plane_count, p_depth + 1);
+	}
 
-				if (p_reflection_probe != reflection_probe->instance) {
-					//avoid entering The Matrix
+	p_room->on_cull_path = false;
 
-					if (!reflection_probe->geometries.empty()) {
-						//do not add this light if no geometry is affected by it..
+	return complete;
+}
 
-						if (reflection_probe->reflection_dirty || VSG::scene_render->reflection_probe_instance_needs_redraw(reflection_probe->instance)) {
-							if (!reflection_probe->update_list.in_list()) {
-								reflection_probe->render_step = 0;
-								reflection_probe_render_list.add_last(&reflection_probe->update_list);
-							}
+void VisualServerScene::_cull_rooms(Scenario *p_scenario, const Transform &p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, const Vector<Plane> &p_planes) {
 
-							reflection_probe->reflection_dirty = false;
-						}
+	_update_scenario_rooms(p_scenario);
 
-						if (VSG::scene_render->reflection_probe_instance_has_reflection(reflection_probe->instance)) {
-							reflection_probe_instance_cull_result[reflection_probe_cull_count] = reflection_probe->instance;
-							reflection_probe_cull_count++;
-						}
-					}
-				}
+	room_cull_data.enabled = p_scenario->rooms.first() != NULL;
+	if (!room_cull_data.enabled)
+		return;
+
+	room_cull_data.orthogonal = p_cam_orthogonal;
+	room_cull_data.camera_origin = p_cam_transform.origin;
+	room_cull_data.view_dir = -p_cam_transform.basis.get_axis(2).normalized();
+	room_cull_data.z_near = p_cam_projection.get_z_near();
+	room_cull_data.far_plane = p_planes[CameraMatrix::PLANE_FAR];
+	room_cull_data.frustum_count = 0;
+	room_cull_data.plane_count = 0;
+
+	Room *camera_room = &p_scenario->exterior;
+
+	for (SelfList<Room> *E = p_scenario->rooms.first(); E; E = E->next()) {
+
+		Room *room = E->self();
+		if (room->planes.empty())
+			continue;
+
+		bool inside = true;
+		for (int i = 0; i < room->planes.size(); i++) {
+			if (room->planes[i].is_point_over(room_cull_data.camera_origin)) {
+				inside = false;
+				break;
 			}
+		}
 
-		} else if (ins->base_type == VS::INSTANCE_GI_PROBE && ins->visible) {
+		if (inside) {
+			camera_room = room;
+			break;
+		}
+	}
+
+	if (!_cull_room(camera_room, p_planes.ptr(), p_planes.size(), 0)) {
+		//too many ways through the portals, better draw too much than hide what is seen
+		room_cull_data.enabled = false;
+	}
+}
+
+bool VisualServerScene::_render_occluders(Scenario *p_scenario, const Transform &p_cam_transform, const CameraMatrix &p_cam_projection, const Vector<Plane> &p_planes) {
+
+	if (!p_scenario->occluders.first())
+		return false;
+
+	int height = CLAMP(int(occlusion_buffer_width / p_cam_projection.get_aspect()), 1, occlusion_buffer_width * 4);
+	occlusion_buffer.set_size(occlusion_buffer_width, height);
+	occlusion_buffer.begin(p_cam_projection, p_cam_transform);
+
+	for (SelfList<Occluder> *E = p_scenario->occluders.first(); E; E = E->next()) {
+
+		Occluder *occluder = E->self();
+		if (!occluder->enabled || occluder->faces.size() == 0 || !occluder->transformed_aabb.intersects_convex_shape(p_planes.ptr(), p_planes.size()))
+			continue;
+
+		PoolVector<Vector3>::Read r = occluder->faces.read();
+		occlusion_buffer.add_triangles(occluder->transform, r.ptr(), occluder->faces.size());
+	}
 
-			InstanceGIProbeData *gi_probe = static_cast<InstanceGIProbeData *>(ins->base_data);
-			if (!gi_probe->update_element.in_list()) {
-				gi_probe_update_list.add(&gi_probe->update_element);
+	if (occlusion_buffer.get_triangle_count() == 0)
+		return false;
+
+	occlusion_buffer.rasterize(cull_work_pool);
+	return true;
+}
+
+void VisualServerScene::_render_scene_cull_chunk(uint32_t p_chunk, RenderCullData *p_data) {
+
+	// runs on the cull threads, each chunk only touches its own range of the cull result and its own instances
+
+	int from = p_chunk * INSTANCE_CULL_CHUNK_SIZE;
+	int to = MIN(from + (int)INSTANCE_CULL_CHUNK_SIZE, p_data->cull_count);
+	int kept = from;
+	int deferred = from;
+	int occluded = 0;
+
+	for (int i = from; i < to; i++) {
+
+		Instance *ins = instance_cull_result[i];
+
+		bool keep = false;
+
+		bool geometry = (1 << ins->base_type) & VS::INSTANCE_GEOMETRY_MASK;
+		bool in_draw_range = true;
+		if (geometry) {
+			Instance::LODViewSides sides;
+			in_draw_range = _instance_check_draw_range(ins, p_data->camera_origin, p_data->lod_view, sides);
+			if (p_data->lod_view >= 0 && (ins->lod_begin > 0 || ins->lod_end > 0)) {
+				ins->lod_view_sides[p_data->lod_view] = sides;
 			}
+		}
 
-		} else if (((1 << ins->base_type) & VS::INSTANCE_GEOMETRY_MASK) && ins->visible && ins->cast_shadows != VS::SHADOW_CASTING_SETTING_SHADOWS_ONLY) {
+		if ((p_data->camera_layer_mask & ins->layer_mask) == 0 || !ins->visible) {
+
+			//failure
+		} else if (!in_draw_range) {
+
+			//outside of its draw range
+		} else if (room_cull_data.enabled && (geometry ? !_instance_in_visible_room(ins) : (ins->base_type == VS::INSTANCE_LIGHT && !_light_in_visible_room(ins)))) {
+
+			//hidden behind the walls of the rooms
+		} else if (p_data->occlusion_cull && geometry && ins->cast_shadows != VS::SHADOW_CASTING_SETTING_SHADOWS_ONLY && occlusion_buffer.is_occluded(ins->transformed_aabb)) {
+
+			//hidden behind the occluders
+			occluded++;
+		} else if (ins->base_type == VS::INSTANCE_LIGHT || ins->base_type == VS::INSTANCE_REFLECTION_PROBE || ins->base_type == VS::INSTANCE_GI_PROBE) {
+
+			//these go to shared lists, processed after the chunks are merged
+			instance_cull_deferred[deferred++] = ins;
+
+		} else if (geometry && ins->cast_shadows != VS::SHADOW_CASTING_SETTING_SHADOWS_ONLY) {
 
 			keep = true;
 
 			InstanceGeometryData *geom = static_cast<InstanceGeometryData *>(ins->base_data);
 
 			if (ins->base_type == VS::INSTANCE_PARTICLES) {
-				//particles visible? process them
-				VSG::storage->particles_request_process(ins->base);
-				//particles visible? request redraw
-				VisualServerRaster::redraw_request();
+				//particles visible? process them after merging
+				instance_cull_deferred[deferred++] = ins;
 			}
 
 			if (geom->lighting_dirty) {
@@ -1851,27 +2334,165 @@ void VisualServerScene::_render_scene(const Transform p_cam_transform, const Cam
 				geom->gi_probes_dirty = false;
 			}
 
-			ins->depth = near_plane.distance_to(ins->transform.origin);
-			ins->depth_layer = CLAMP(int(ins->depth * 16 / z_far), 0, 15);
+			ins->depth = p_data->near_plane.distance_to(ins->transform.origin);
+			ins->depth_layer = CLAMP(int(ins->depth * 16 / p_data->z_far), 0, 15);
 		}
 
 		if (!keep) {
 			// remove, no reason to keep
-			cull_count--;
-			SWAP(instance_cull_result[i], instance_cull_result[cull_count]);
-			i--;
 			ins->last_render_pass = 0; // make invalid
 		} else {
 
+			//compact in place, kept instances never overtake the loop
+			instance_cull_result[kept++] = ins;
 			ins->last_render_pass = render_pass;
 		}
 	}
 
+	p_data->kept_count[p_chunk] = kept - from;
+	p_data->deferred_count[p_chunk] = deferred - from;
+	p_data->occluded_count[p_chunk] = occluded;
+}
+
+void VisualServerScene::_render_scene(const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_force_environment, uint32_t p_visible_layers, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe, int p_reflection_probe_pass, int p_lod_view) {
+
+	Scenario *scenario = scenario_owner.getornull(p_scenario);
+
+	render_pass++;
+	uint32_t camera_layer_mask = p_visible_layers;
+
+	VSG::scene_render->set_scene_pass(render_pass);
+
+	//rasterizer->set_camera(camera->transform, camera_matrix,ortho);
+
+	Vector<Plane> planes = p_cam_projection.get_projection_planes(p_cam_transform);
+
+	Plane near_plane(p_cam_transform.origin, -p_cam_transform.basis.get_axis(2).normalized());
+	float z_far = p_cam_projection.get_z_far();
+
+	/* STEP 2 - CULL */
+	int cull_count = scenario->octree.cull_convex(planes, instance_cull_result, MAX_INSTANCE_CULL);
+	light_cull_count = 0;
+
+	reflection_probe_cull_count = 0;
+
+	//light_samplers_culled=0;
+
+	/*	print_line("OT: "+rtos( (OS::get_singleton()->get_ticks_usec()-t)/1000.0));
+	print_line("OTO: "+itos(p_scenario->octree.get_octant_count()));
+	//print_line("OTE: "+itos(p_scenario->octree.get_elem_count()));
+	print_line("OTP: "+itos(p_scenario->octree.get_pair_count()));
+*/
+
+	/* STEP 3 - PROCESS PORTALS, VALIDATE ROOMS */
+
+	_cull_rooms(scenario, p_cam_transform, p_cam_projection, p_cam_orthogonal, planes);
+
+	bool occlusion_cull = _render_occluders(scenario, p_cam_transform, p_cam_projection, planes);
+
+	/* STEP 4 - REMOVE FURTHER CULLED OBJECTS, ADD LIGHTS */
+
+	int chunk_count = (cull_count + INSTANCE_CULL_CHUNK_SIZE - 1) / INSTANCE_CULL_CHUNK_SIZE;
+
+	render_cull_data.cull_count = cull_count;
+	render_cull_data.camera_layer_mask = camera_layer_mask;
+	render_cull_data.camera_origin = p_cam_transform.origin;
+	render_cull_data.lod_view = p_lod_view;
+	render_cull_data.near_plane = near_plane;
+	render_cull_data.z_far = z_far;
+	render_cull_data.occlusion_cull = occlusion_cull;
+
+	cull_work_pool.do_work(chunk_count, this, &VisualServerScene::_render_scene_cull_chunk, &render_cull_data);
+
+	// merge the chunks in order, then handle what could not be done in parallel
+
+	cull_count = 0;
+
+	for (int c = 0; c < chunk_count; c++) {
+
+		int from = c * INSTANCE_CULL_CHUNK_SIZE;
+
+		info.occluded_object_count += render_cull_data.occluded_count[c];
+
+		for (int i = 0; i < render_cull_data.kept_count[c]; i++) {
+			instance_cull_result[cull_count++] = instance_cull_result[from + i];
+		}
+
+		for (int i = 0; i < render_cull_data.deferred_count[c]; i++) {
+
+			Instance *ins = instance_cull_deferred[from + i];
+
+			if (ins->base_type == VS::INSTANCE_LIGHT) {
+
+				if (light_cull_count < MAX_LIGHTS_CULLED) {
+
+					InstanceLightData *light = static_cast<InstanceLightData *>(ins->base_data);
+
+					if (!light->geometries.empty()) {
+						//do not add this light if no geometry is affected by it..
+						light_cull_result[light_cull_count] = ins;
+						light_instance_cull_result[light_cull_count] = light->instance;
+						if (p_shadow_atlas.is_valid() && VSG::storage->light_has_shadow(ins->base)) {
+							VSG::scene_render->light_instance_mark_visible(light->instance); //mark it visible for shadow allocation later
+						}
+
+						light_cull_count++;
+					}
+				}
+			} else if (ins->base_type == VS::INSTANCE_REFLECTION_PROBE) {
+
+				if (reflection_probe_cull_count < MAX_REFLECTION_PROBES_CULLED) {
+
+					InstanceReflectionProbeData *reflection_probe = static_cast<InstanceReflectionProbeData *>(ins->base_data);
+
+					if (p_reflection_probe != reflection_probe->instance) {
+						//avoid entering The Matrix
+
+						if (!reflection_probe->geometries.empty()) {
+							//do not add this light if no geometry is affected by it..
+
+							if (reflection_probe->reflection_dirty || VSG::scene_render->reflection_probe_instance_needs_redraw(reflection_probe->instance)) {
+								if (!reflection_probe->update_list.in_list()) {
+									reflection_probe->render_step = 0;
+									reflection_probe_render_list.add_last(&reflection_probe->update_list);
+								}
+
+								reflection_probe->reflection_dirty = false;
+							}
+
+							if (VSG::scene_render->reflection_probe_instance_has_reflection(reflection_probe->instance)) {
+								reflection_probe_instance_cull_result[reflection_probe_cull_count] = reflection_probe->instance;
+								reflection_probe_cull_count++;
+							}
+						}
+					}
+				}
+
+			} else if (ins->base_type == VS::INSTANCE_GI_PROBE) {
+
+				InstanceGIProbeData *gi_probe = static_cast<InstanceGIProbeData *>(ins->base_data);
+				if (!gi_probe->update_element.in_list()) {
+					gi_probe_update_list.add(&gi_probe->update_element);
+				}
+
+			} else if (ins->base_type == VS::INSTANCE_PARTICLES) {
+
+				//particles visible? process them
+				VSG::storage->particles_request_process(ins->base);
+				//particles visible? request redraw
+				VisualServerRaster::redraw_request();
+			}
+		}
+	}
+
 	/* STEP 5 - PROCESS LIGHTS */
 
 	RID *directional_light_ptr = &light_instance_cull_result[light_cull_count];
 	int directional_light_count = 0;
 
+	// shadows are culled for all lights at once on the cull threads, then rendered in order
+	int shadow_job_count = 0;
+
 	// directional lights
 	{
 
@@ -1904,7 +2525,15 @@ void VisualServerScene::_render_scene(const Transform p_cam_transform, const Cam
 
 		for (int i = 0; i < directional_shadow_count; i++) {
 
-			_light_instance_update_shadow(lights_with_shadow[i], p_cam_transform, p_cam_projection, p_cam_orthogonal, p_shadow_atlas, scenario);
+			InstanceLightData *light = static_cast<InstanceLightData *>(lights_with_shadow[i]->base_data);
+
+			if (shadow_job_count == shadow_cull_jobs.size()) {
+				shadow_cull_jobs.resize(shadow_job_count + 1);
+			}
+
+			ShadowCullJob &job = shadow_cull_jobs[shadow_job_count++];
+			job.light = lights_with_shadow[i];
+			job.texture_size = VSG::scene_render->get_directional_light_shadow_size(light->instance);
 		}
 	}
 
@@ -2003,11 +2632,35 @@ void VisualServerScene::_render_scene(const Transform p_cam_transform, const Cam
 
 			if (redraw) {
 				//must redraw!
-				_light_instance_update_shadow(ins, p_cam_transform, p_cam_projection, p_cam_orthogonal, p_shadow_atlas, scenario);
+				if (shadow_job_count == shadow_cull_jobs.size()) {
+					shadow_cull_jobs.resize(shadow_job_count + 1);
+				}
+
+				ShadowCullJob &job = shadow_cull_jobs[shadow_job_count++];
+				job.light = ins;
+				job.texture_size = 0;
 			}
 		}
 	}
 
+	if (shadow_job_count) {
+
+		ShadowCullContext context;
+		context.cam_transform = p_cam_transform;
+		context.cam_projection = p_cam_projection;
+		context.cam_orthogonal = p_cam_orthogonal;
+		context.scenario = scenario;
+		context.lod_view = p_lod_view;
+		context.jobs = shadow_cull_jobs.ptrw();
+
+		cull_work_pool.do_work(shadow_job_count, this, &VisualServerScene::_light_instance_cull_shadow_work, &context);
+
+		for (int i = 0; i < shadow_job_count; i++) {
+
+			_light_instance_render_shadow(context.jobs[i], p_shadow_atlas);
+		}
+	}
+
 	/* ENVIRONMENT */
 
 	RID environment;
@@ -2093,7 +2746,7 @@ bool VisualServerScene::_render_reflection_probe_step(Instance *p_instance, int
 			shadow_atlas = scenario->reflection_probe_shadow_atlas;
 		}
 
-		_render_scene(xform, cm, false, RID(), VSG::storage->reflection_probe_get_cull_mask(p_instance->base), p_instance->scenario->self, shadow_atlas, reflection_probe->instance, p_step);
+		_render_scene(xform, cm, false, RID(), VSG::storage->reflection_probe_get_cull_mask(p_instance->base), p_instance->scenario->self, shadow_atlas, reflection_probe->instance, p_step, -1);
 
 	} else {
 		//do roughness postprocess step until it believes it's done
@@ -3108,7 +3761,7 @@ void VisualServerScene::render_probes() {
 	}
 }
 
-void VisualServerScene::_update_dirty_instance(Instance *p_instance) {
+bool VisualServerScene::_update_dirty_instance_data(Instance *p_instance) {
 
 	if (p_instance->update_aabb) {
 		_update_instance_aabb(p_instance);
@@ -3258,19 +3911,82 @@ void VisualServerScene::_update_dirty_instance(Instance *p_instance) {
 
 	_instance_update_list.remove(&p_instance->update_item);
 
-	_update_instance(p_instance);
-
 	p_instance->update_aabb = false;
 	p_instance->update_materials = false;
+
+	return _update_instance(p_instance);
+}
+
+void VisualServerScene::_update_dirty_instance(Instance *p_instance) {
+
+	if (_update_dirty_instance_data(p_instance)) {
+		_update_instance_bounds(p_instance);
+		_update_instance_octree(p_instance);
+	}
+}
+
+void VisualServerScene::_update_dirty_instance_chunk(uint32_t p_chunk, int p_count) {
+
+	int from = p_chunk * DIRTY_INSTANCE_CHUNK_SIZE;
+	int to = MIN(from + (int)DIRTY_INSTANCE_CHUNK_SIZE, p_count);
+
+	Instance **instances = dirty_instances.ptrw();
+
+	for (int i = from; i < to; i++) {
+		_update_instance_bounds(instances[i]);
+	}
+}
+
+void VisualServerScene::render_info_begin_frame() {
+
+	info_final = info;
+	info.reset();
+}
+
+int VisualServerScene::get_render_info(VS::RenderInfo p_info) const {
+
+	switch (p_info) {
+		case VS::INFO_OCCLUDED_OBJECTS_IN_FRAME:
+			return info_final.occluded_object_count;
+		case VS::INFO_DIRTY_INSTANCES_IN_FRAME:
+			return info_final.dirty_instance_count;
+		default:
+			return 0;
+	}
 }
 
 void VisualServerScene::update_dirty_instances() {
 
 	VSG::storage->update_dirty_resources();
 
+	// pairing in the octree may queue instances again, those are handled in another round
 	while (_instance_update_list.first()) {
 
-		_update_dirty_instance(_instance_update_list.first()->self());
+		int count = 0;
+
+		while (_instance_update_list.first()) {
+
+			Instance *instance = _instance_update_list.first()->self();
+			info.dirty_instance_count++;
+
+			if (!_update_dirty_instance_data(instance))
+				continue;
+
+			if (dirty_instances.size() == count) {
+				dirty_instances.resize(MAX(count * 2, (int)DIRTY_INSTANCE_CHUNK_SIZE));
+			}
+			dirty_instances[count++] = instance;
+		}
+
+		// bounds, rooms and lightmap captures in parallel, then the octree in one pass
+
+		int chunk_count = (count + DIRTY_INSTANCE_CHUNK_SIZE - 1) / DIRTY_INSTANCE_CHUNK_SIZE;
+		cull_work_pool.do_work(chunk_count, this, &VisualServerScene::_update_dirty_instance_chunk, count);
+
+		Instance **instances = dirty_instances.ptrw();
+		for (int i = 0; i < count; i++) {
+			_update_instance_octree(instances[i]);
+		}
 	}
 }
 
@@ -3280,6 +3996,10 @@ bool VisualServerScene::free(RID p_rid) {
 
 		Camera *camera = camera_owner.get(p_rid);
 
+		if (camera->lod_view >= 0) {
+			lod_view_versions[camera->lod_view] = 0;
+		}
+
 		camera_owner.free(p_rid);
 		memdelete(camera);
 
@@ -3290,11 +4010,43 @@ bool VisualServerScene::free(RID p_rid) {
 		while (scenario->instances.first()) {
 			instance_set_scenario(scenario->instances.first()->self()->self, RID());
 		}
+		while (scenario->rooms.first()) {
+			_room_set_scenario(scenario->rooms.first()->self(), NULL);
+		}
+		while (scenario->exterior.portals.front()) {
+			_portal_unlink(scenario->exterior.portals.front()->get());
+		}
+		while (scenario->occluders.first()) {
+			Occluder *occluder = scenario->occluders.first()->self();
+			scenario->occluders.remove(&occluder->scenario_item);
+			occluder->scenario = NULL;
+		}
 		VSG::scene_render->free(scenario->reflection_probe_shadow_atlas);
 		VSG::scene_render->free(scenario->reflection_atlas);
 		scenario_owner.free(p_rid);
 		memdelete(scenario);
 
+	} else if (room_owner.owns(p_rid)) {
+
+		Room *room = room_owner.get(p_rid);
+		_room_set_scenario(room, NULL);
+		room_owner.free(p_rid);
+		memdelete(room);
+
+	} else if (occluder_owner.owns(p_rid)) {
+
+		Occluder *occluder = occluder_owner.get(p_rid);
+		occluder_set_scenario(p_rid, RID());
+		occluder_owner.free(p_rid);
+		memdelete(occluder);
+
+	} else if (portal_owner.owns(p_rid)) {
+
+		Portal *portal = portal_owner.get(p_rid);
+		_portal_unlink(portal);
+		portal_owner.free(p_rid);
+		memdelete(portal);
+
 	} else if (instance_owner.owns(p_rid)) {
 		// delete the instance
 
@@ -3332,10 +4084,28 @@ VisualServerScene::VisualServerScene() {
 
 	render_pass = 1;
 	singleton = this;
+
+	room_cull_data.enabled = false;
+	room_cull_data.frustum_count = 0;
+	room_cull_data.plane_count = 0;
+
+	for (int i = 0; i < LOD_VIEW_MAX; i++) {
+		lod_view_versions[i] = 0;
+	}
+	lod_view_last_version = 0;
+
+	occlusion_buffer_width = GLOBAL_DEF("rendering/quality/occlusion/buffer_width", 256);
+	ProjectSettings::get_singleton()->set_custom_property_info("rendering/quality/occlusion/buffer_width", PropertyInfo(Variant::INT, "rendering/quality/occlusion/buffer_width", PROPERTY_HINT_RANGE, "64,1024,1"));
+	info.reset();
+	info_final.reset();
+
+	cull_work_pool.init(GLOBAL_DEF("rendering/threads/culling_threads", 0));
 }
 
 VisualServerScene::~VisualServerScene() {
 
+	cull_work_pool.finish();
+
 #ifndef NO_THREADS
 	probe_bake_thread_exit = true;
 	probe_bake_sem->post();
@@ -38,6 +38,8 @@
 #include "octree.h"
 #include "os/semaphore.h"
 #include "os/thread.h"
+#include "os/thread_work_pool.h"
+#include "servers/visual/occlusion_buffer.h"
 #include "self_list.h"
 #include "servers/arvr/arvr_interface.h"
 
@@ -48,31 +50,22 @@ public:
 		MAX_INSTANCE_CULL = 65536,
 		MAX_LIGHTS_CULLED = 4096,
 		MAX_REFLECTION_PROBES_CULLED = 4096,
-		MAX_ROOM_CULL = 32,
-		MAX_EXTERIOR_PORTALS = 128,
+		MAX_PORTAL_DEPTH = 16,
+		MAX_ROOM_CULL_FRUSTUMS = 1024,
+		INSTANCE_CULL_CHUNK_SIZE = 256,
+		MAX_INSTANCE_CULL_CHUNKS = MAX_INSTANCE_CULL / INSTANCE_CULL_CHUNK_SIZE,
+		DIRTY_INSTANCE_CHUNK_SIZE = 256,
 	};
 
 	uint64_t render_pass;
 
 	static VisualServerScene *singleton;
 
-// FIXME: Kept as reference for future implementation
-#if 0
-	struct Portal {
-
-		bool enabled;
-		float disable_distance;
-		Color disable_color;
-		float connect_range;
-		Vector<Point2> shape;
-		Rect2 bounds;
-
+	/* CAMERA API */
 
-		Portal() { enabled=true; disable_distance=50; disable_color=Color(); connect_range=0.8; }
+	enum {
+		LOD_VIEW_MAX = 8 //cameras keeping their own draw range hysteresis, further cameras use the plain limits
 	};
-#endif
-
-	/* CAMERA API */
 
 	struct Camera : public RID_Data {
 
@@ -90,6 +83,8 @@ public:
 
 		Transform transform;
 
+		int lod_view; //slot of the draw range sides of this camera in each instance, -1 if none was free
+
 		Camera() {
 
 			visible_layers = 0xFFFFFFFF;
@@ -99,6 +94,7 @@ public:
 			zfar = 100;
 			size = 1.0;
 			vaspect = false;
+			lod_view = -1;
 		}
 	};
 
@@ -115,6 +111,71 @@ public:
 	/* SCENARIO API */
 
 	struct Instance;
+	struct Scenario;
+	struct Portal;
+
+	// rooms are convex cells of a scenario, connected by portals
+	struct Room : RID_Data {
+
+		Scenario *scenario;
+		SelfList<Room> scenario_item;
+
+		Vector<Plane> planes; //world space, normals pointing out
+		List<Portal *> portals;
+
+		//cull state, valid for the render pass they were set in
+		uint64_t visible_pass;
+		uint64_t shadow_pass; // visible or next to a visible room
+		int first_frustum;
+		bool on_cull_path;
+
+		Room() :
+				scenario_item(this) {
+
+			scenario = NULL;
+			visible_pass = 0;
+			shadow_pass = 0;
+			first_frustum = -1;
+			on_cull_path = false;
+		}
+	};
+
+	struct Portal : RID_Data {
+
+		Room *rooms[2];
+		List<Portal *>::Element *room_elements[2];
+
+		Vector<Vector3> points; //convex polygon, world space
+		Plane plane;
+		bool enabled;
+
+		Portal() {
+
+			rooms[0] = rooms[1] = NULL;
+			room_elements[0] = room_elements[1] = NULL;
+			enabled = true;
+		}
+	};
+
+	// occluders hide what is behind them from the camera, drawn into a depth buffer on the CPU
+	struct Occluder : RID_Data {
+
+		Scenario *scenario;
+		SelfList<Occluder> scenario_item;
+
+		PoolVector<Vector3> faces; //triangles, local space
+		AABB aabb;
+		Transform transform;
+		AABB transformed_aabb;
+		bool enabled;
+
+		Occluder() :
+				scenario_item(this) {
+
+			scenario = NULL;
+			enabled = true;
+		}
+	};
 
 	struct Scenario : RID_Data {
 
@@ -132,7 +193,16 @@ public:
 
 		SelfList<Instance>::List instances;
 
-		Scenario() { debug = VS::SCENARIO_DEBUG_DISABLED; }
+		SelfList<Room>::List rooms;
+		Room exterior; //what is outside of every room
+		bool rooms_dirty;
+
+		SelfList<Occluder>::List occluders;
+
+		Scenario() {
+			debug = VS::SCENARIO_DEBUG_DISABLED;
+			rooms_dirty = false;
+		}
 	};
 
 	mutable RID_Owner<Scenario> scenario_owner;
@@ -147,6 +217,33 @@ public:
 	virtual void scenario_set_fallback_environment(RID p_scenario, RID p_environment);
 	virtual void scenario_set_reflection_atlas_size(RID p_scenario, int p_size, int p_subdiv);
 
+	/* ROOM API */
+
+	mutable RID_Owner<Room> room_owner;
+	mutable RID_Owner<Portal> portal_owner;
+
+	virtual RID room_create();
+	virtual void room_set_scenario(RID p_room, RID p_scenario);
+	virtual void room_set_bounds(RID p_room, const Vector<Plane> &p_planes);
+
+	virtual RID portal_create();
+	virtual void portal_set_rooms(RID p_portal, RID p_room, RID p_linked_room);
+	virtual void portal_set_points(RID p_portal, const Vector<Vector3> &p_points);
+	virtual void portal_set_enabled(RID p_portal, bool p_enabled);
+
+	void _portal_unlink(Portal *p_portal);
+	void _room_set_scenario(Room *p_room, Scenario *p_scenario);
+
+	/* OCCLUDER API */
+
+	mutable RID_Owner<Occluder> occluder_owner;
+
+	virtual RID occluder_create();
+	virtual void occluder_set_scenario(RID p_occluder, RID p_scenario);
+	virtual void occluder_set_faces(RID p_occluder, const PoolVector<Vector3> &p_faces);
+	virtual void occluder_set_transform(RID p_occluder, const Transform &p_transform);
+	virtual void occluder_set_enabled(RID p_occluder, bool p_enabled);
+
 	/* INSTANCING API */
 
 	struct InstanceBaseData {
@@ -178,8 +275,17 @@ public:
 		float lod_end;
 		float lod_begin_hysteresis;
 		float lod_end_hysteresis;
+		//side of each limit the instance was last culled from by each camera, -1 closer, 1 farther, 0 not yet culled
+		struct LODViewSides {
+			uint32_t version; //valid while it matches the version of the camera holding the slot
+			int8_t begin;
+			int8_t end;
+		};
+		LODViewSides lod_view_sides[LOD_VIEW_MAX];
 		RID lod_instance;
 
+		Vector<Room *> rooms; //rooms touched, including the exterior, when the scenario has rooms
+
 		uint64_t last_render_pass;
 		uint64_t last_frame_pass;
 
@@ -221,6 +327,9 @@ public:
 			lod_end = 0;
 			lod_begin_hysteresis = 0;
 			lod_end_hysteresis = 0;
+			for (int i = 0; i < LOD_VIEW_MAX; i++) {
+				lod_view_sides[i].version = 0;
+			}
 
 			last_render_pass = 0;
 			last_frame_pass = 0;
@@ -435,7 +544,7 @@ public:
 	};
 
 	Instance *instance_cull_result[MAX_INSTANCE_CULL];
-	Instance *instance_shadow_cull_result[MAX_INSTANCE_CULL]; //used for generating shadowmaps
+	Instance *instance_cull_deferred[MAX_INSTANCE_CULL]; //lights, probes and particles found by the cull chunks, processed serially
 	Instance *light_cull_result[MAX_LIGHTS_CULLED];
 	RID light_instance_cull_result[MAX_LIGHTS_CULLED];
 	int light_cull_count;
@@ -476,14 +585,197 @@ public:
 	virtual void instance_geometry_set_draw_range(RID p_instance, float p_min, float p_max, float p_min_margin, float p_max_margin);
 	virtual void instance_geometry_set_as_instance_lod(RID p_instance, RID p_as_lod_of_instance);
 
-	_FORCE_INLINE_ void _update_instance(Instance *p_instance);
+	_FORCE_INLINE_ bool _update_instance(Instance *p_instance);
+	_FORCE_INLINE_ void _update_instance_bounds(Instance *p_instance);
+	_FORCE_INLINE_ void _update_instance_octree(Instance *p_instance);
 	_FORCE_INLINE_ void _update_instance_aabb(Instance *p_instance);
+	_FORCE_INLINE_ bool _update_dirty_instance_data(Instance *p_instance);
 	_FORCE_INLINE_ void _update_dirty_instance(Instance *p_instance);
+	void _update_dirty_instance_chunk(uint32_t p_chunk, int p_count);
 	_FORCE_INLINE_ void _update_instance_lightmap_captures(Instance *p_instance);
+	void _update_instance_rooms(Instance *p_instance);
+	void _update_scenario_rooms(Scenario *p_scenario);
+
+	ThreadWorkPool cull_work_pool;
+
+	Vector<Instance *> dirty_instances;
+
+	struct RenderCullData {
+		int cull_count;
+		uint32_t camera_layer_mask;
+		Vector3 camera_origin;
+		int lod_view;
+		Plane near_plane;
+		float z_far;
+		bool occlusion_cull;
+		int kept_count[MAX_INSTANCE_CULL_CHUNKS];
+		int deferred_count[MAX_INSTANCE_CULL_CHUNKS];
+		int occluded_count[MAX_INSTANCE_CULL_CHUNKS];
+	};
+
+	RenderCullData render_cull_data;
+
+	void _render_scene_cull_chunk(uint32_t p_chunk, RenderCullData *p_data);
+
+	OcclusionBuffer occlusion_buffer;
+	int occlusion_buffer_width;
+
+	bool _render_occluders(Scenario *p_scenario, const Transform &p_cam_transform, const CameraMatrix &p_cam_projection, const Vector<Plane> &p_planes);
+
+	struct Info {
+		uint32_t occluded_object_count;
+		uint32_t dirty_instance_count;
+
+		void reset() {
+			occluded_object_count = 0;
+			dirty_instance_count = 0;
+		}
+	} info, info_final;
+
+	void render_info_begin_frame();
+	int get_render_info(VS::RenderInfo p_info) const;
+
+	struct ShadowCullPass {
+		int pass;
+		CameraMatrix projection;
+		Transform transform;
+		float far;
+		float split;
+		float bias_scale;
+		Plane depth_plane;
+		Vector<Instance *> casters; //grow only, kept between frames
+		int caster_count;
+	};
+
+	struct ShadowCullJob {
+		Instance *light;
+		float texture_size;
+		int pass_count;
+		bool restore_transform;
+		ShadowCullPass passes[6];
+	};
+
+	struct ShadowCullContext {
+		Transform cam_transform;
+		CameraMatrix cam_projection;
+		bool cam_orthogonal;
+		Scenario *scenario;
+		int lod_view;
+		ShadowCullJob *jobs;
+	};
+
+	Vector<ShadowCullJob> shadow_cull_jobs;
+
+	static _FORCE_INLINE_ int8_t _get_lod_side(float p_distance, float p_limit, float p_margin, int8_t p_side) {
+
+		//the margin must be crossed to change sides, so the levels sharing a limit always agree
+		if (p_side < 0)
+			return p_distance >= p_limit + p_margin ? 1 : -1;
+		if (p_side > 0)
+			return p_distance < p_limit - p_margin ? -1 : 1;
+		return p_distance >= p_limit ? 1 : -1;
+	}
+
+	uint32_t lod_view_versions[LOD_VIEW_MAX]; //0 while the slot is free
+	uint32_t lod_view_last_version;
+
+	_FORCE_INLINE_ bool _instance_check_draw_range(const Instance *p_instance, const Vector3 &p_camera_origin, int p_lod_view, Instance::LODViewSides &r_sides) const {
+
+		if (p_instance->lod_begin <= 0 && p_instance->lod_end <= 0)
+			return true;
+
+		//measured from the origin the levels of an object share, their bounds can differ
+		float distance = p_camera_origin.distance_to(p_instance->transform.origin);
+
+		int8_t prev_begin_side = 0;
+		int8_t prev_end_side = 0;
+		if (p_lod_view >= 0 && p_instance->lod_view_sides[p_lod_view].version == lod_view_versions[p_lod_view]) {
+			prev_begin_side = p_instance->lod_view_sides[p_lod_view].begin;
+			prev_end_side = p_instance->lod_view_sides[p_lod_view].end;
+		}
+
+		r_sides.version = p_lod_view >= 0 ? lod_view_versions[p_lod_view] : 0;
+		r_sides.begin = p_instance->lod_begin > 0 ? _get_lod_side(distance, p_instance->lod_begin, p_instance->lod_begin_hysteresis, prev_begin_side) : 1;
+		r_sides.end = p_instance->lod_end > 0 ? _get_lod_side(distance, p_instance->lod_end, p_instance->lod_end_hysteresis, prev_end_side) : -1;
+
+		return r_sides.begin > 0 && r_sides.end < 0;
+	}
+
+	struct RoomCullFrustum {
+		int first_plane;
+		int plane_count;
+		int next; //next frustum the same room is seen through, or -1
+	};
+
+	struct RoomCullData {
+		bool enabled;
+		bool orthogonal;
+		Vector3 camera_origin;
+		Vector3 view_dir;
+		float z_near;
+		Plane far_plane;
+		Vector<RoomCullFrustum> frustums; //grow only, kept between frames
+		int frustum_count;
+		Vector<Plane> planes; //grow only, kept between frames
+		int plane_count;
+		Vector<Plane> portal_planes[MAX_PORTAL_DEPTH]; //grow only, one per depth, as the rooms behind a portal are culled with its planes
+	};
+
+	RoomCullData room_cull_data;
+
+	void _cull_rooms(Scenario *p_scenario, const Transform &p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, const Vector<Plane> &p_planes);
+	bool _cull_room(Room *p_room, const Plane *p_planes, int p_plane_count, int p_depth);
+
+	_FORCE_INLINE_ bool _instance_in_visible_room(const Instance *p_instance) const {
+
+		const Plane *planes = room_cull_data.planes.ptr();
+		const RoomCullFrustum *frustums = room_cull_data.frustums.ptr();
+
+		for (int i = 0; i < p_instance->rooms.size(); i++) {
+
+			const Room *room = p_instance->rooms[i];
+			if (room->visible_pass != render_pass)
+				continue;
+
+			for (int f = room->first_frustum; f >= 0; f = frustums[f].next) {
+				if (p_instance->transformed_aabb.intersects_convex_shape(&planes[frustums[f].first_plane], frustums[f].plane_count))
+					return true;
+			}
+		}
+
+		return false;
+	}
+
+	_FORCE_INLINE_ bool _light_in_visible_room(const Instance *p_light) const {
+
+		for (int i = 0; i < p_light->rooms.size(); i++) {
+			if (p_light->rooms[i]->visible_pass == render_pass)
+				return true;
+		}
+
+		//directional lights have no rooms and reach everywhere
+		return p_light->rooms.empty();
+	}
+
+	_FORCE_INLINE_ bool _instance_casts_shadow_in_rooms(const Instance *p_caster, const Instance *p_light) const {
+
+		//shadows cast from rooms not seen only matter next to a visible room, or inside the rooms of the light
+		for (int i = 0; i < p_caster->rooms.size(); i++) {
+
+			const Room *room = p_caster->rooms[i];
+			if (room->shadow_pass == render_pass || p_light->rooms.find(room) != -1)
+				return true;
+		}
+
+		return false;
+	}
 
-	_FORCE_INLINE_ void _light_instance_update_shadow(Instance *p_instance, const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_shadow_atlas, Scenario *p_scenario);
+	int _shadow_cull_casters(ShadowCullPass &p_pass, const Vector<Plane> &p_planes, Scenario *p_scenario, const Vector3 &p_camera_origin, int p_lod_view, const Instance *p_light);
+	void _light_instance_cull_shadow(ShadowCullJob &p_job, const ShadowCullContext &p_context);
+	void _light_instance_cull_shadow_work(uint32_t p_job, ShadowCullContext *p_context);
+	void _light_instance_render_shadow(ShadowCullJob &p_job, RID p_shadow_atlas);
 
-	void _render_scene(const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_force_environment, uint32_t p_visible_layers, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe, int p_reflection_probe_pass);
+	void _render_scene(const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_force_environment, uint32_t p_visible_layers, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe, int p_reflection_probe_pass, int p_lod_view);
 	void render_empty_scene(RID p_scenario, RID p_shadow_atlas);
 
 	void render_camera(RID p_camera, RID p_scenario, Size2 p_viewport_size, RID p_shadow_atlas);
@@ -153,6 +153,9 @@ void VisualServerWrapMT::finish() {
 	viewport_free_cached_ids();
 	environment_free_cached_ids();
 	scenario_free_cached_ids();
+	room_free_cached_ids();
+	portal_free_cached_ids();
+	occluder_free_cached_ids();
 	instance_free_cached_ids();
 	canvas_free_cached_ids();
 	canvas_item_free_cached_ids();
@@ -186,6 +186,7 @@ public:
 	FUNC3(multimesh_instance_set_transform, RID, int, const Transform &)
 	FUNC3(multimesh_instance_set_transform_2d, RID, int, const Transform2D &)
 	FUNC3(multimesh_instance_set_color, RID, int, const Color &)
+	FUNC3(multimesh_set_instance_range, RID, int, const PoolVector<float> &)
 
 	FUNC1RC(RID, multimesh_get_mesh, RID)
 	FUNC1RC(AABB, multimesh_get_aabb, RID)
@@ -434,6 +435,25 @@ public:
 	FUNC3(scenario_set_reflection_atlas_size, RID, int, int)
 	FUNC2(scenario_set_fallback_environment, RID, RID)
 
+	/* ROOM API */
+
+	FUNCRID(room)
+	FUNC2(room_set_scenario, RID, RID)
+	FUNC2(room_set_bounds, RID, const Vector<Plane> &)
+
+	FUNCRID(portal)
+	FUNC3(portal_set_rooms, RID, RID, RID)
+	FUNC2(portal_set_points, RID, const Vector<Vector3> &)
+	FUNC2(portal_set_enabled, RID, bool)
+
+	/* OCCLUDER API */
+
+	FUNCRID(occluder)
+	FUNC2(occluder_set_scenario, RID, RID)
+	FUNC2(occluder_set_faces, RID, const PoolVector<Vector3> &)
+	FUNC2(occluder_set_transform, RID, const Transform &)
+	FUNC2(occluder_set_enabled, RID, bool)
+
 	/* INSTANCING API */
 	// from can be mesh, light,  area and portal so far.
 	FUNCRID(instance)
@@ -122,6 +122,18 @@ Array VisualServer::_instances_cull_convex_bind(const Array &p_convex, RID p_sce
 	return to_array(ids);
 }
 
+void VisualServer::_room_set_bounds_bind(RID p_room, const Array &p_planes) {
+
+	Vector<Plane> planes;
+	for (int i = 0; i < p_planes.size(); ++i) {
+		Variant v = p_planes[i];
+		ERR_FAIL_COND(v.get_type() != Variant::PLANE);
+		planes.push_back(v);
+	}
+
+	room_set_bounds(p_room, planes);
+}
+
 RID VisualServer::get_test_texture() {
 
 	if (test_texture.is_valid()) {
@@ -1592,6 +1604,7 @@ void VisualServer::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("multimesh_instance_set_transform", "multimesh", "index", "transform"), &VisualServer::multimesh_instance_set_transform);
 	ClassDB::bind_method(D_METHOD("multimesh_instance_set_transform_2d", "multimesh", "index", "transform"), &VisualServer::multimesh_instance_set_transform_2d);
 	ClassDB::bind_method(D_METHOD("multimesh_instance_set_color", "multimesh", "index", "color"), &VisualServer::multimesh_instance_set_color);
+	ClassDB::bind_method(D_METHOD("multimesh_set_instance_range", "multimesh", "from", "data"), &VisualServer::multimesh_set_instance_range);
 	ClassDB::bind_method(D_METHOD("multimesh_get_mesh", "multimesh"), &VisualServer::multimesh_get_mesh);
 	ClassDB::bind_method(D_METHOD("multimesh_get_aabb", "multimesh"), &VisualServer::multimesh_get_aabb);
 	ClassDB::bind_method(D_METHOD("multimesh_instance_get_transform", "multimesh", "index"), &VisualServer::multimesh_instance_get_transform);
@@ -1776,6 +1789,20 @@ void VisualServer::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("scenario_set_debug", "scenario", "debug_mode"), &VisualServer::scenario_set_debug);
 	ClassDB::bind_method(D_METHOD("scenario_set_environment", "scenario", "environment"), &VisualServer::scenario_set_environment);
 	ClassDB::bind_method(D_METHOD("scenario_set_reflection_atlas_size", "scenario", "p_size", "subdiv"), &VisualServer::scenario_set_reflection_atlas_size);
+
+	ClassDB::bind_method(D_METHOD("room_create"), &VisualServer::room_create);
+	ClassDB::bind_method(D_METHOD("room_set_scenario", "room", "scenario"), &VisualServer::room_set_scenario);
+	ClassDB::bind_method(D_METHOD("room_set_bounds", "room", "planes"), &VisualServer::_room_set_bounds_bind);
+	ClassDB::bind_method(D_METHOD("portal_create"), &VisualServer::portal_create);
+	ClassDB::bind_method(D_METHOD("portal_set_rooms", "portal", "room", "linked_room"), &VisualServer::portal_set_rooms);
+	ClassDB::bind_method(D_METHOD("portal_set_points", "portal", "points"), &VisualServer::portal_set_points);
+	ClassDB::bind_method(D_METHOD("portal_set_enabled", "portal", "enabled"), &VisualServer::portal_set_enabled);
+
+	ClassDB::bind_method(D_METHOD("occluder_create"), &VisualServer::occluder_create);
+	ClassDB::bind_method(D_METHOD("occluder_set_scenario", "occluder", "scenario"), &VisualServer::occluder_set_scenario);
+	ClassDB::bind_method(D_METHOD("occluder_set_faces", "occluder", "faces"), &VisualServer::occluder_set_faces);
+	ClassDB::bind_method(D_METHOD("occluder_set_transform", "occluder", "transform"), &VisualServer::occluder_set_transform);
+	ClassDB::bind_method(D_METHOD("occluder_set_enabled", "occluder", "enabled"), &VisualServer::occluder_set_enabled);
 	ClassDB::bind_method(D_METHOD("scenario_set_fallback_environment", "scenario", "environment"), &VisualServer::scenario_set_fallback_environment);
 
 	ClassDB::bind_method(D_METHOD("instance_create2", "base", "scenario"), &VisualServer::instance_create2);
@@ -2094,6 +2121,13 @@ void VisualServer::_bind_methods() {
 	BIND_ENUM_CONSTANT(INFO_VIDEO_MEM_USED);
 	BIND_ENUM_CONSTANT(INFO_TEXTURE_MEM_USED);
 	BIND_ENUM_CONSTANT(INFO_VERTEX_MEM_USED);
+	BIND_ENUM_CONSTANT(INFO_2D_ITEMS_IN_FRAME);
+	BIND_ENUM_CONSTANT(INFO_2D_DRAW_CALLS_IN_FRAME);
+	BIND_ENUM_CONSTANT(INFO_TRIANGLES_IN_FRAME);
+	BIND_ENUM_CONSTANT(INFO_OCCLUDED_OBJECTS_IN_FRAME);
+	BIND_ENUM_CONSTANT(INFO_DIRTY_INSTANCES_IN_FRAME);
+	BIND_ENUM_CONSTANT(INFO_SHADER_COMPILE_CACHE_HITS);
+	BIND_ENUM_CONSTANT(INFO_SHADER_COMPILE_CACHE_MISSES);
 
 	BIND_ENUM_CONSTANT(FEATURE_SHADERS);
 	BIND_ENUM_CONSTANT(FEATURE_MULTITHREADED);
@@ -315,6 +315,7 @@ public:
 	virtual void multimesh_instance_set_transform(RID p_multimesh, int p_index, const Transform &p_transform) = 0;
 	virtual void multimesh_instance_set_transform_2d(RID p_multimesh, int p_index, const Transform2D &p_transform) = 0;
 	virtual void multimesh_instance_set_color(RID p_multimesh, int p_index, const Color &p_color) = 0;
+	virtual void multimesh_set_instance_range(RID p_multimesh, int p_from, const PoolVector<float> &p_data) = 0;
 
 	virtual RID multimesh_get_mesh(RID p_multimesh) const = 0;
 	virtual AABB multimesh_get_aabb(RID p_multimesh) const = 0;
@@ -739,6 +740,25 @@ public:
 	virtual void scenario_set_reflection_atlas_size(RID p_scenario, int p_size, int p_subdiv) = 0;
 	virtual void scenario_set_fallback_environment(RID p_scenario, RID p_environment) = 0;
 
+	/* ROOM API */
+
+	virtual RID room_create() = 0;
+	virtual void room_set_scenario(RID p_room, RID p_scenario) = 0;
+	virtual void room_set_bounds(RID p_room, const Vector<Plane> &p_planes) = 0;
+
+	virtual RID portal_create() = 0;
+	virtual void portal_set_rooms(RID p_portal, RID p_room, RID p_linked_room) = 0;
+	virtual void portal_set_points(RID p_portal, const Vector<Vector3> &p_points) = 0;
+	virtual void portal_set_enabled(RID p_portal, bool p_enabled) = 0;
+
+	/* OCCLUDER API */
+
+	virtual RID occluder_create() = 0;
+	virtual void occluder_set_scenario(RID p_occluder, RID p_scenario) = 0;
+	virtual void occluder_set_faces(RID p_occluder, const PoolVector<Vector3> &p_faces) = 0;
+	virtual void occluder_set_transform(RID p_occluder, const Transform &p_transform) = 0;
+	virtual void occluder_set_enabled(RID p_occluder, bool p_enabled) = 0;
+
 	/* INSTANCING API */
 
 	enum InstanceType {
@@ -788,6 +808,7 @@ public:
 	Array _instances_cull_aabb_bind(const AABB &p_aabb, RID p_scenario = RID()) const;
 	Array _instances_cull_ray_bind(const Vector3 &p_from, const Vector3 &p_to, RID p_scenario = RID()) const;
 	Array _instances_cull_convex_bind(const Array &p_convex, RID p_scenario = RID()) const;
+	void _room_set_bounds_bind(RID p_room, const Array &p_planes);
 
 	enum InstanceFlags {
 		INSTANCE_FLAG_USE_BAKED_LIGHT,
@@ -954,6 +975,13 @@ public:
 		INFO_VIDEO_MEM_USED,
 		INFO_TEXTURE_MEM_USED,
 		INFO_VERTEX_MEM_USED,
+		INFO_2D_ITEMS_IN_FRAME,
+		INFO_2D_DRAW_CALLS_IN_FRAME,
+		INFO_TRIANGLES_IN_FRAME,
+		INFO_OCCLUDED_OBJECTS_IN_FRAME,
+		INFO_DIRTY_INSTANCES_IN_FRAME,
+		INFO_SHADER_COMPILE_CACHE_HITS,
+		INFO_SHADER_COMPILE_CACHE_MISSES,
 	};
 
 	virtual int get_render_info(RenderInfo p_info) = 0;
@@ -7,15 +7,16 @@
     APIs: gl=3.3
     Profile: compatibility
     Extensions:
-        GL_ARB_debug_output
+        GL_ARB_debug_output,
+        GL_ARB_get_program_binary
     Loader: True
     Local files: False
     Omit khrplatform: False
 
     Commandline:
-        --profile="compatibility" --api="gl=3.3" --generator="c" --spec="gl" --extensions="GL_ARB_debug_output"
+        --profile="compatibility" --api="gl=3.3" --generator="c" --spec="gl" --extensions="GL_ARB_debug_output,GL_ARB_get_program_binary"
     Online:
-        http://glad.dav1d.de/#profile=compatibility&language=c&specification=gl&loader=on&api=gl%3D3.3&extensions=GL_ARB_debug_output
+        http://glad.dav1d.de/#profile=compatibility&language=c&specification=gl&loader=on&api=gl%3D3.3&extensions=GL_ARB_debug_output&extensions=GL_ARB_get_program_binary
 */
 
 #include <stdio.h>
@@ -976,6 +977,10 @@ PFNGLDEBUGMESSAGECONTROLARBPROC glad_glDebugMessageControlARB;
 PFNGLDEBUGMESSAGEINSERTARBPROC glad_glDebugMessageInsertARB;
 PFNGLDEBUGMESSAGECALLBACKARBPROC glad_glDebugMessageCallbackARB;
 PFNGLGETDEBUGMESSAGELOGARBPROC glad_glGetDebugMessageLogARB;
+int GLAD_GL_ARB_get_program_binary;
+PFNGLGETPROGRAMBINARYPROC glad_glGetProgramBinary;
+PFNGLPROGRAMBINARYPROC glad_glProgramBinary;
+PFNGLPROGRAMPARAMETERIPROC glad_glProgramParameteri;
 static void load_GL_VERSION_1_0(GLADloadproc load) {
 	if(!GLAD_GL_VERSION_1_0) return;
 	glad_glCullFace = (PFNGLCULLFACEPROC)load("glCullFace");
@@ -1746,9 +1751,16 @@ static void load_GL_ARB_debug_output(GLADloadproc load) {
 	glad_glDebugMessageCallbackARB = (PFNGLDEBUGMESSAGECALLBACKARBPROC)load("glDebugMessageCallbackARB");
 	glad_glGetDebugMessageLogARB = (PFNGLGETDEBUGMESSAGELOGARBPROC)load("glGetDebugMessageLogARB");
 }
+static void load_GL_ARB_get_program_binary(GLADloadproc load) {
+	if(!GLAD_GL_ARB_get_program_binary) return;
+	glad_glGetProgramBinary = (PFNGLGETPROGRAMBINARYPROC)load("glGetProgramBinary");
+	glad_glProgramBinary = (PFNGLPROGRAMBINARYPROC)load("glProgramBinary");
+	glad_glProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC)load("glProgramParameteri");
+}
 static int find_extensionsGL(void) {
 	if (!get_exts()) return 0;
 	GLAD_GL_ARB_debug_output = has_ext("GL_ARB_debug_output");
+	GLAD_GL_ARB_get_program_binary = has_ext("GL_ARB_get_program_binary");
 	free_exts();
 	return 1;
 }
@@ -1828,6 +1840,7 @@ int gladLoadGLLoader(GLADloadproc load) {
 
 	if (!find_extensionsGL()) return 0;
 	load_GL_ARB_debug_output(load);
+	load_GL_ARB_get_program_binary(load);
 	return GLVersion.major != 0 || GLVersion.minor != 0;
 }
 